@@ -0,0 +1,241 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host harness for cores/esp32/base64.cpp, used by test_base64.py.
+ *
+ * Usage:
+ *   base64_host encode <in> <out> <std|url> <pad 0|1> <api> [piece size]
+ *   base64_host decode <in> <out> <api> [piece size]
+ *   base64_host bench [data size] [iterations]
+ *
+ * api selects the entry point: "buffer" (base64::encode/decode into a
+ * buffer), "string" (base64::encode returning a String, encode only),
+ * "print" (base64Encoder/base64Decoder passing on to a Print) or "fixed"
+ * (base64Encoder/base64Decoder filling a fixed buffer). The streaming
+ * classes get their input in writes of piece size bytes.
+ * encode and decode exit 1 and print "error" if the call failed.
+ *
+ * bench encodes and decodes random data with libb64, which the core used
+ * before, with the buffer API and with the streaming classes, checks that
+ * all results match and prints the throughput in MB/s of input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "base64.h"
+extern "C" {
+#include "libb64/cdecode.h"
+#include "libb64/cencode.h"
+}
+
+class VectorPrint : public Print {
+public:
+  size_t write(uint8_t c) override {
+    data.push_back(c);
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    data.insert(data.end(), buffer, buffer + size);
+    return size;
+  }
+  std::vector<uint8_t> data;
+};
+
+static bool readFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(f);
+  return true;
+}
+
+static bool writeFile(const char *path, const uint8_t *data, size_t len) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    return false;
+  }
+  bool ok = fwrite(data, 1, len, f) == len;
+  return fclose(f) == 0 && ok;
+}
+
+template<typename Coder> static void feed(Coder &coder, const std::vector<uint8_t> &in, size_t piece) {
+  for (size_t pos = 0; pos < in.size(); pos += piece) {
+    coder.write(in.data() + pos, in.size() - pos < piece ? in.size() - pos : piece);
+  }
+}
+
+static int encode(const std::vector<uint8_t> &in, const char *out, base64::alphabet_t alphabet, bool padding, const char *api, size_t piece) {
+  size_t len = base64::encodedLength(in.size(), padding);
+  std::vector<char> buf(len + 1);
+  size_t n = 0;
+  bool ok;
+  if (strcmp(api, "buffer") == 0) {
+    n = base64::encode(in.data(), in.size(), buf.data(), buf.size(), alphabet, padding);
+    ok = n == len && base64::encode(in.data(), in.size(), buf.data(), len, alphabet, padding) == 0;
+  } else if (strcmp(api, "string") == 0) {
+    String s = base64::encode(in.data(), in.size(), alphabet, padding);
+    n = s.length();
+    memcpy(buf.data(), s.c_str(), n);
+    ok = n == len;
+  } else if (strcmp(api, "print") == 0) {
+    VectorPrint sink;
+    base64Encoder encoder(sink, alphabet, padding);
+    feed(encoder, in, piece);
+    n = encoder.end();
+    ok = n == len && sink.data.size() == len;
+    memcpy(buf.data(), sink.data.data(), sink.data.size());
+  } else if (strcmp(api, "fixed") == 0) {
+    base64Encoder encoder(buf.data(), buf.size(), alphabet, padding);
+    feed(encoder, in, piece);
+    n = encoder.end();
+    ok = n == len && buf[len] == '\0';
+  } else {
+    fprintf(stderr, "unknown api %s\n", api);
+    return 2;
+  }
+  if (!ok) {
+    printf("error\n");
+    return 1;
+  }
+  return writeFile(out, (const uint8_t *)buf.data(), n) ? 0 : 2;
+}
+
+static int decode(const std::vector<uint8_t> &in, const char *out, const char *api, size_t piece) {
+  std::vector<uint8_t> buf(base64::decodedLength(in.size()));
+  size_t n = 0;
+  bool ok;
+  if (strcmp(api, "buffer") == 0) {
+    int r = base64::decode((const char *)in.data(), in.size(), buf.data(), buf.size());
+    ok = r >= 0;
+    n = ok ? r : 0;
+  } else if (strcmp(api, "print") == 0) {
+    VectorPrint sink;
+    base64Decoder decoder(sink);
+    feed(decoder, in, piece);
+    n = decoder.end();
+    ok = !decoder.hasError() && n == sink.data.size();
+    memcpy(buf.data(), sink.data.data(), sink.data.size());
+  } else if (strcmp(api, "fixed") == 0) {
+    base64Decoder decoder(buf.data(), buf.size());
+    feed(decoder, in, piece);
+    n = decoder.end();
+    ok = !decoder.hasError();
+  } else {
+    fprintf(stderr, "unknown api %s\n", api);
+    return 2;
+  }
+  if (!ok) {
+    printf("error\n");
+    return 1;
+  }
+  return writeFile(out, buf.data(), n) ? 0 : 2;
+}
+
+template<typename F> static double mbPerSecond(size_t bytes, long iterations, F run) {
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    run();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return (double)bytes * iterations / std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static int bench(size_t size, long iterations) {
+  std::vector<uint8_t> data(size);
+  srand(1);
+  for (uint8_t &b : data) {
+    b = rand();
+  }
+  size_t len = base64::encodedLength(size);
+  std::vector<char> libb64(len + 4), core(len + 1);
+  std::vector<uint8_t> decoded(size + 3);
+  VectorPrint sink;
+  sink.data.reserve(len);
+
+  printf("Size: %zu Iterations: %ld\n", size, iterations);
+  double rate = mbPerSecond(size, iterations, [&]() {
+    base64_encodestate state;
+    base64_init_encodestate(&state);
+    int n = base64_encode_block((const char *)data.data(), size, libb64.data(), &state);
+    base64_encode_blockend(libb64.data() + n, &state);
+  });
+  printf("Encode libb64: %.1f MB/s\n", rate);
+  rate = mbPerSecond(size, iterations, [&]() {
+    base64::encode(data.data(), size, core.data(), core.size());
+  });
+  printf("Encode buffer: %.1f MB/s\n", rate);
+  rate = mbPerSecond(size, iterations, [&]() {
+    sink.data.clear();
+    base64::encode(data.data(), size, sink);
+  });
+  printf("Encode stream: %.1f MB/s\n", rate);
+  if (memcmp(libb64.data(), core.data(), len) || sink.data.size() != len || memcmp(sink.data.data(), core.data(), len)) {
+    printf("Error: encodings differ\n");
+    return 1;
+  }
+
+  rate = mbPerSecond(len, iterations, [&]() {
+    base64_decodestate state;
+    base64_init_decodestate(&state);
+    base64_decode_block(core.data(), len, (char *)decoded.data(), &state);
+  });
+  printf("Decode libb64: %.1f MB/s\n", rate);
+  bool same = memcmp(decoded.data(), data.data(), size) == 0;
+  rate = mbPerSecond(len, iterations, [&]() {
+    base64::decode(core.data(), len, decoded.data(), decoded.size());
+  });
+  printf("Decode buffer: %.1f MB/s\n", rate);
+  same = same && memcmp(decoded.data(), data.data(), size) == 0;
+  rate = mbPerSecond(len, iterations, [&]() {
+    sink.data.clear();
+    base64Decoder decoder(sink);
+    decoder.write((const uint8_t *)core.data(), len);
+    decoder.end();
+  });
+  printf("Decode stream: %.1f MB/s\n", rate);
+  if (!same || sink.data != data) {
+    printf("Error: decodings differ\n");
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 7 && strcmp(argv[1], "encode") == 0) {
+    std::vector<uint8_t> in;
+    if (!readFile(argv[2], in)) {
+      fprintf(stderr, "cannot read input\n");
+      return 2;
+    }
+    base64::alphabet_t alphabet = strcmp(argv[4], "url") == 0 ? base64::URL_SAFE : base64::STANDARD;
+    size_t piece = argc > 7 ? strtoul(argv[7], NULL, 0) : 4096;
+    return encode(in, argv[3], alphabet, atoi(argv[5]) != 0, argv[6], piece ? piece : 1);
+  }
+  if (argc >= 5 && strcmp(argv[1], "decode") == 0) {
+    std::vector<uint8_t> in;
+    if (!readFile(argv[2], in)) {
+      fprintf(stderr, "cannot read input\n");
+      return 2;
+    }
+    size_t piece = argc > 5 ? strtoul(argv[5], NULL, 0) : 4096;
+    return decode(in, argv[3], argv[4], piece ? piece : 1);
+  }
+  if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+    return bench(argc > 2 ? strtoul(argv[2], NULL, 0) : 48 * 1024, argc > 3 ? strtol(argv[3], NULL, 0) : 2000);
+  }
+  fprintf(stderr, "usage: %s encode <in> <out> <std|url> <pad> <api> [piece] | decode <in> <out> <api> [piece] | bench [size] [iterations]\n", argv[0]);
+  return 2;
+}
@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Host stub for base64_host.cpp
+#pragma once
+#include <string.h>
+#include "WString.h"
+#include "Print.h"
+
+#define log_d(...)
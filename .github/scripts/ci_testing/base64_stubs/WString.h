@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Host stub for base64_host.cpp, the part of the core String class base64 uses
+#pragma once
+#include <stddef.h>
+#include <string>
+
+class String {
+public:
+  String() {}
+  String(const char *str) : _s(str ? str : "") {}
+
+  bool reserve(size_t size) {
+    _s.reserve(size);
+    return true;
+  }
+  bool concat(const char *str, size_t len) {
+    _s.append(str, len);
+    return true;
+  }
+  const char *c_str() const {
+    return _s.c_str();
+  }
+  size_t length() const {
+    return _s.size();
+  }
+
+private:
+  std::string _s;
+};
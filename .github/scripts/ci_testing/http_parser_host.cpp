@@ -0,0 +1,308 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host harness for HTTPResponseParser of libraries/HTTPClient, used by
+ * test_http_parser.py.
+ *
+ * Usage:
+ *   http_parser_host parse <response> [chunk size] [line size] [sink limit]
+ *   http_parser_host bench [iterations]
+ *
+ * parse feeds the response to the parser the way HTTPClient does (head, then
+ * body) in pieces of chunk size bytes and prints what it found:
+ *   status <code> <minor>
+ *   header <name>|<value>          one line per header field
+ *   truncated <lines>
+ *   body <hex>
+ *   result <done|open|error N> <bytes left unconsumed>
+ * With a sink limit the body sink returns false once that many bytes arrived.
+ *
+ * bench parses captured responses with HTTPResponseParser and with the
+ * line-by-line string approach HTTPClient used before, and prints the
+ * throughput and the heap allocations per response of both.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include "HTTPResponseParser.h"
+
+// allocations made by the code under test, counted while `counting` is set
+static size_t allocations = 0;
+static bool counting = false;
+
+void *operator new(size_t size) {
+  if (counting) {
+    allocations++;
+  }
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+// not inlined, so the compiler does not pair the free() with the new expressions of the standard library
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+static bool readFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(f);
+  return true;
+}
+
+static int parse(const std::vector<uint8_t> &response, size_t chunk, size_t lineSize, long sinkLimit) {
+  std::vector<char> line(lineSize);
+  HTTPResponseParser parser(line.data(), line.size());
+  std::string headers;
+  std::vector<uint8_t> body;
+
+  parser.onHeader([&headers](const HTTPResponseParser::Slice &name, const HTTPResponseParser::Slice &value) {
+    headers += "header ";
+    headers.append(name.data, name.len);
+    headers += "|";
+    headers.append(value.data, value.len);
+    headers += "\n";
+  });
+  parser.onBody([&body, sinkLimit](const uint8_t *data, size_t len) {
+    body.insert(body.end(), data, data + len);
+    return sinkLimit < 0 || body.size() < (size_t)sinkLimit;
+  });
+
+  size_t pos = 0;
+  while (pos < response.size() && !parser.headersComplete()) {
+    size_t len = response.size() - pos < chunk ? response.size() - pos : chunk;
+    pos += parser.parseHeaders(response.data() + pos, len);
+  }
+  if (parser.headersComplete()) {
+    parser.beginBody(parser.contentLength(), parser.chunked());
+    while (pos < response.size() && !parser.done() && !parser.failed()) {
+      size_t len = response.size() - pos < chunk ? response.size() - pos : chunk;
+      size_t used = parser.parseBody(response.data() + pos, len);
+      pos += used;
+      if (used < len) {
+        break;
+      }
+    }
+  }
+
+  printf("status %d %d\n", parser.statusCode(), parser.httpMinorVersion());
+  fputs(headers.c_str(), stdout);
+  printf("truncated %u\n", parser.truncatedLines());
+  printf("body ");
+  for (uint8_t b : body) {
+    printf("%02x", b);
+  }
+  printf("\n");
+  if (parser.failed()) {
+    printf("result error %d %zu\n", parser.error(), response.size() - pos);
+  } else {
+    printf("result %s %zu\n", parser.done() ? "done" : "open", response.size() - pos);
+  }
+  return 0;
+}
+
+/* Captured responses */
+
+static const char resp_small[] = "HTTP/1.1 200 OK\r\n"
+                                 "Date: Mon, 06 Oct 2025 10:12:45 GMT\r\n"
+                                 "Content-Type: application/json\r\n"
+                                 "Content-Length: 27\r\n"
+                                 "Connection: keep-alive\r\n"
+                                 "\r\n"
+                                 "{\"temp\":21.5,\"hum\":48.25}\r\n";
+
+static const char resp_headers[] = "HTTP/1.1 302 Found\r\n"
+                                   "Date: Mon, 06 Oct 2025 10:12:45 GMT\r\n"
+                                   "Server: nginx/1.24.0\r\n"
+                                   "Content-Type: text/html; charset=utf-8\r\n"
+                                   "Content-Length: 0\r\n"
+                                   "Connection: keep-alive\r\n"
+                                   "Location: https://example.com/login?next=%2Fdashboard%2Fdevices%2Fesp32\r\n"
+                                   "Cache-Control: no-cache, no-store, must-revalidate\r\n"
+                                   "Pragma: no-cache\r\n"
+                                   "Expires: 0\r\n"
+                                   "Set-Cookie: session=0123456789abcdef0123456789abcdef; Path=/; HttpOnly; Secure; SameSite=Lax\r\n"
+                                   "Set-Cookie: csrftoken=fedcba9876543210fedcba9876543210; Path=/; Max-Age=31449600\r\n"
+                                   "Strict-Transport-Security: max-age=63072000; includeSubDomains; preload\r\n"
+                                   "X-Content-Type-Options: nosniff\r\n"
+                                   "X-Frame-Options: DENY\r\n"
+                                   "Vary: Accept-Encoding, Cookie\r\n"
+                                   "\r\n";
+
+static const char resp_chunked[] = "HTTP/1.1 200 OK\r\n"
+                                   "Date: Mon, 06 Oct 2025 10:12:45 GMT\r\n"
+                                   "Content-Type: text/plain\r\n"
+                                   "Transfer-Encoding: chunked\r\n"
+                                   "\r\n"
+                                   "40\r\n"
+                                   "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\r\n"
+                                   "40\r\n"
+                                   "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\r\n"
+                                   "40\r\n"
+                                   "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\r\n"
+                                   "40\r\n"
+                                   "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\r\n"
+                                   "10\r\n"
+                                   "0123456789abcdef\r\n"
+                                   "0\r\n"
+                                   "\r\n";
+
+struct TestCase {
+  const char *name;
+  const char *data;
+  size_t len;
+  uint32_t bodyLen;
+};
+
+static const TestCase test_cases[] = {
+  {"small", resp_small, sizeof(resp_small) - 1, 27},
+  {"headers", resp_headers, sizeof(resp_headers) - 1, 0},
+  {"chunked", resp_chunked, sizeof(resp_chunked) - 1, 272},
+};
+
+// the response arrives in pieces like the reads of a 1436 byte TCP segment
+#define BENCH_SEGMENT 1436
+#define BENCH_LINE_SIZE 1024
+
+static uint32_t parse_parser(const TestCase &tc, char *line) {
+  HTTPResponseParser parser(line, BENCH_LINE_SIZE);
+  const uint8_t *data = (const uint8_t *)tc.data;
+  size_t pos = 0;
+  while (pos < tc.len && !parser.headersComplete()) {
+    size_t len = tc.len - pos < BENCH_SEGMENT ? tc.len - pos : BENCH_SEGMENT;
+    pos += parser.parseHeaders(data + pos, len);
+  }
+  parser.beginBody(parser.contentLength(), parser.chunked());
+  while (pos < tc.len && !parser.done()) {
+    size_t len = tc.len - pos < BENCH_SEGMENT ? tc.len - pos : BENCH_SEGMENT;
+    pos += parser.parseBody(data + pos, len);
+  }
+  return parser.bodyBytes();
+}
+
+// former HTTPClient approach: one string per line, substrings for name and value
+static uint32_t parse_string(const TestCase &tc) {
+  std::string in(tc.data, tc.len);
+  size_t pos = 0;
+  auto readLine = [&in, &pos]() {
+    size_t nl = in.find('\n', pos);
+    size_t end = nl == std::string::npos ? in.size() : nl;
+    std::string line = in.substr(pos, end - pos);
+    pos = nl == std::string::npos ? in.size() : nl + 1;
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+      line.pop_back();
+    }
+    return line;
+  };
+
+  long size = -1;
+  bool chunked = false;
+  std::string status = readLine();
+  volatile int code = atoi(status.substr(status.find(' ') + 1).c_str());
+  (void)code;
+  while (pos < in.size()) {
+    std::string headerLine = readLine();
+    if (headerLine.empty()) {
+      break;
+    }
+    size_t colon = headerLine.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    std::string name = headerLine.substr(0, colon);
+    std::string value = headerLine.substr(colon + 1);
+    value.erase(0, value.find_first_not_of(' '));
+    if (strcasecmp(name.c_str(), "Content-Length") == 0) {
+      size = atol(value.c_str());
+    } else if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0) {
+      chunked = strcasecmp(value.c_str(), "chunked") == 0;
+    }
+  }
+
+  uint32_t body = 0;
+  if (!chunked) {
+    body = size >= 0 ? size : in.size() - pos;
+  } else {
+    while (pos < in.size()) {
+      std::string chunkHeader = readLine();
+      long len = strtol(chunkHeader.c_str(), NULL, 16);
+      if (len <= 0) {
+        break;
+      }
+      std::string chunkData = in.substr(pos, len);
+      body += chunkData.size();
+      pos += len;
+      readLine();
+    }
+  }
+  return body;
+}
+
+static int bench(long iterations) {
+  static char line[BENCH_LINE_SIZE];
+  printf("Iterations: %ld\n", iterations);
+  for (const TestCase &tc : test_cases) {
+    for (int impl = 0; impl < 2; impl++) {
+      uint32_t bodyLen = 0;
+      allocations = 0;
+      counting = true;
+      auto start = std::chrono::steady_clock::now();
+      for (long i = 0; i < iterations; i++) {
+        bodyLen = impl ? parse_string(tc) : parse_parser(tc, line);
+      }
+      auto end = std::chrono::steady_clock::now();
+      counting = false;
+      if (bodyLen != tc.bodyLen) {
+        printf("Error: %s body is %u bytes, expected %u\n", tc.name, bodyLen, tc.bodyLen);
+        return 1;
+      }
+      double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+      double allocs = (double)allocations / iterations;
+      printf("%s %s: Rate = %.1f MB/s Time: %.0f ns Allocs: %.1f\n", impl ? "String" : "Parser", tc.name, tc.len * 1000.0 / ns, ns, allocs);
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 3 && strcmp(argv[1], "parse") == 0) {
+    std::vector<uint8_t> response;
+    if (!readFile(argv[2], response)) {
+      fprintf(stderr, "cannot read input\n");
+      return 2;
+    }
+    size_t chunk = argc > 3 ? strtoul(argv[3], NULL, 0) : 4096;
+    size_t lineSize = argc > 4 ? strtoul(argv[4], NULL, 0) : 1024;
+    long sinkLimit = argc > 5 ? strtol(argv[5], NULL, 0) : -1;
+    return parse(response, chunk ? chunk : 1, lineSize ? lineSize : 1, sinkLimit);
+  }
+  if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+    return bench(argc > 2 ? strtol(argv[2], NULL, 0) : 200000);
+  }
+  fprintf(stderr, "usage: %s parse <response> [chunk size] [line size] [sink limit] | bench [iterations]\n", argv[0]);
+  return 2;
+}
@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Host test and benchmark for the base64 coder of the core (cores/esp32/base64.cpp)
+
+Usage:
+    python3 .github/scripts/ci_testing/test_base64.py [--bench]
+
+base64.cpp, base64.h and libb64 are copied into a temporary directory and
+compiled with the host compiler against the Arduino.h, WString.h and Print.h
+stubs in base64_stubs/, then driven by base64_host.cpp. The results are
+compared with the base64 module of Python.
+
+Scenarios covered:
+  01. Encoding             → every API, both alphabets, with and without padding, input split at every position
+  02. Decoding             → both alphabets, missing padding, whitespace and line breaks
+  03. Invalid input        → bad characters, misplaced or incomplete padding, truncated groups rejected
+  04. Benchmark            → libb64 against the buffer API and the streaming classes, same results
+"""
+
+import base64
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+HERE = Path(__file__).parent
+CORE = HERE.parent.parent.parent / 'cores' / 'esp32'
+HARNESS = HERE / 'base64_host.cpp'
+STUBS = HERE / 'base64_stubs'
+
+LENGTHS = (0, 1, 2, 3, 4, 5, 6, 7, 89, 90, 91, 92, 1000, 49153)
+PIECES = (4096, 7, 1)
+
+PASS = '\033[32mPASS\033[0m'
+FAIL = '\033[31mFAIL\033[0m'
+_failures: list[str] = []
+
+
+# ---------------------------------------------------------------------------
+# Helpers
+# ---------------------------------------------------------------------------
+
+def section(title: str) -> None:
+    print(f"\n{'=' * 60}")
+    print(f'  {title}')
+    print('=' * 60)
+
+
+def assert_test(name: str, condition: bool, detail: str = '') -> None:
+    if condition:
+        print(f'  {PASS}  {name}')
+    else:
+        msg = f'  {FAIL}  {name}'
+        if detail:
+            msg += f'\n         detail: {detail}'
+        print(msg)
+        _failures.append(name)
+
+
+def build_harness(out_dir: Path) -> tuple[Path, str]:
+    cxx = os.environ.get('CXX') or shutil.which('g++') or shutil.which('clang++')
+    cc = os.environ.get('CC') or shutil.which('gcc') or shutil.which('clang') or shutil.which('cc')
+    if not cxx or not cc:
+        return None, 'no C++ compiler'
+    # copied, so that the quoted includes of base64.cpp find the stubs instead of the core headers
+    src = out_dir / 'src'
+    (src / 'libb64').mkdir(parents=True)
+    for name in ('base64.cpp', 'base64.h'):
+        shutil.copy(CORE / name, src / name)
+    for name in ('cencode.c', 'cencode.h', 'cdecode.c', 'cdecode.h'):
+        shutil.copy(CORE / 'libb64' / name, src / 'libb64' / name)
+    exe = out_dir / 'base64_host'
+    log = ''
+    for name in ('cencode', 'cdecode'):
+        r = subprocess.run([cc, '-O2', '-Wall', '-c', '-o', str(src / f'{name}.o'), str(src / 'libb64' / f'{name}.c')],
+                           capture_output=True, text=True, timeout=300)
+        log += r.stdout + r.stderr
+        if r.returncode != 0:
+            return None, log
+    r = subprocess.run([cxx, '-std=c++17', '-O2', '-Wall', '-I', str(STUBS), '-I', str(src), '-o', str(exe),
+                        str(HARNESS), str(src / 'base64.cpp'), str(src / 'cencode.o'), str(src / 'cdecode.o')],
+                       capture_output=True, text=True, timeout=300)
+    return (exe if r.returncode == 0 else None), log + r.stdout + r.stderr
+
+
+def run(exe: Path, tmp: Path, args: list, data: bytes) -> tuple[int, bytes, str]:
+    (tmp / 'in.bin').write_bytes(data)
+    if os.path.exists(tmp / 'out.bin'):
+        os.remove(tmp / 'out.bin')
+    r = subprocess.run([str(exe), args[0], str(tmp / 'in.bin'), str(tmp / 'out.bin')] + [str(a) for a in args[1:]],
+                       capture_output=True, text=True, timeout=60)
+    out = (tmp / 'out.bin').read_bytes() if r.returncode == 0 else b''
+    return r.returncode, out, r.stdout + r.stderr
+
+
+def reference_encode(data: bytes, url: bool, padding: bool) -> bytes:
+    encoded = base64.urlsafe_b64encode(data) if url else base64.b64encode(data)
+    return encoded if padding else encoded.rstrip(b'=')
+
+
+def api_pieces(api: str) -> tuple:
+    return PIECES if api in ('print', 'fixed') else (4096,)
+
+
+# ---------------------------------------------------------------------------
+# Tests
+# ---------------------------------------------------------------------------
+
+def test_01_encode(exe: Path, tmp: Path):
+    section('01. Encoding')
+    rng = random.Random(36)
+    inputs = [rng.randbytes(n) for n in LENGTHS] + [bytes(range(256)) * 3, b'\xfb\xff\xbf' * 30]
+    for api in ('buffer', 'string', 'print', 'fixed'):
+        for alphabet in ('std', 'url'):
+            for padding in (1, 0):
+                for piece in api_pieces(api):
+                    bad = []
+                    for data in inputs:
+                        rc, out, log = run(exe, tmp, ['encode', alphabet, padding, api, piece], data)
+                        expected = reference_encode(data, alphabet == 'url', padding == 1)
+                        if rc != 0 or out != expected:
+                            bad.append(f'{len(data)} bytes: {log.strip() or out[:40]}')
+                    name = f'{api}, {alphabet}, {"padded" if padding else "no padding"}'
+                    assert_test(f'{name}, pieces of {piece}' if api in ('print', 'fixed') else name, not bad,
+                                '; '.join(bad[:3]))
+
+
+def test_02_decode(exe: Path, tmp: Path):
+    section('02. Decoding')
+    rng = random.Random(2)
+    data = rng.randbytes(3001)
+    cases = (
+        ('standard', base64.b64encode(data), data),
+        ('url safe', base64.urlsafe_b64encode(data), data),
+        ('no padding', base64.b64encode(data).rstrip(b'='), data),
+        ('one byte tail', base64.b64encode(data[:1000]), data[:1000]),
+        ('two byte tail, no padding', base64.urlsafe_b64encode(data[:1001]).rstrip(b'='), data[:1001]),
+        ('MIME line breaks', base64.encodebytes(data), data),
+        ('CRLF line breaks', base64.encodebytes(data).replace(b'\n', b'\r\n'), data),
+        ('spaces and tabs', b' \t'.join(base64.b64encode(data)[i:i + 5] for i in range(0, 4004, 5)), data),
+        ('whitespace inside padding', b'QQ =\n=', b'A'),
+        ('mixed alphabets', b'+/-_', base64.b64decode(b'+/+/')),
+        ('empty', b'', b''),
+        ('only whitespace', b' \r\n\t', b''),
+    )
+    for name, encoded, expected in cases:
+        for api in ('buffer', 'print', 'fixed'):
+            for piece in api_pieces(api):
+                rc, out, log = run(exe, tmp, ['decode', api, piece], encoded)
+                label = f'{name}, {api}' + (f', pieces of {piece}' if api != 'buffer' else '')
+                assert_test(label, rc == 0 and out == expected, log.strip() or f'{len(out)} bytes differ')
+
+
+def test_03_invalid(exe: Path, tmp: Path):
+    section('03. Invalid input')
+    cases = (
+        ('truncated group', b'QUJDR'),
+        ('invalid character', b'QU*D'),
+        ('NUL byte', b'QUJD\x00'),
+        ('non ASCII byte', b'QUJD\xc3\xa4'),
+        ('padding in first position', b'=QUJ'),
+        ('padding in second position', b'Q==='),
+        ('three padding characters', b'QUJ==='),
+        ('data after padding', b'QQ==QUJD'),
+        ('character between padding', b'QQ=A='),
+        ('incomplete padding', b'QQ='),
+    )
+    for name, encoded in cases:
+        for api in ('buffer', 'print', 'fixed'):
+            for piece in api_pieces(api):
+                rc, out, log = run(exe, tmp, ['decode', api, piece], encoded)
+                label = f'{name} rejected, {api}' + (f', pieces of {piece}' if api != 'buffer' else '')
+                assert_test(label, rc == 1 and log.strip() == 'error', log.strip())
+
+
+def test_04_bench(exe: Path, iterations: int):
+    section('04. Benchmark')
+    r = subprocess.run([str(exe), 'bench', str(48 * 1024), str(iterations)], capture_output=True, text=True,
+                       timeout=600)
+    assert_test('encodings and decodings of all implementations match', r.returncode == 0, r.stdout + r.stderr)
+    rates = {}
+    for m in re.finditer(r'(Encode|Decode) (\w+): ([\d.]+) MB/s', r.stdout):
+        rates[(m.group(1), m.group(2))] = float(m.group(3))
+        print(f'        {m.group(1)} {m.group(2):7} {float(m.group(3)):8.1f} MB/s')
+    assert_test('every implementation benchmarked', len(rates) == 6, r.stdout)
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+_ALL_TESTS = [
+    test_01_encode,
+    test_02_decode,
+    test_03_invalid,
+]
+
+if __name__ == '__main__':
+    print(f'Testing: {CORE / "base64.cpp"}')
+
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp = Path(tmp)
+        exe, out = build_harness(tmp)
+        if exe is None and out == 'no C++ compiler':
+            print('  SKIP  no C++ compiler found')
+            sys.exit(0)
+        section('Build')
+        assert_test('harness builds', exe is not None, out)
+        if exe is not None:
+            for test in _ALL_TESTS:
+                test(exe, tmp)
+            test_04_bench(exe, 2000 if '--bench' in sys.argv else 200)
+
+    total = len(_ALL_TESTS) + 1
+    print(f"\n{'=' * 60}")
+    if _failures:
+        print(f'\n{FAIL} {len(_failures)} assertion(s) failed:')
+        for f in _failures:
+            print(f'  - {f}')
+        print()
+        sys.exit(1)
+    else:
+        print(f'\n{PASS} All {total} test cases passed!')
+        sys.exit(0)
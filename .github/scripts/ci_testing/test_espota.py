@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Local loopback test for the tools/espota.py transfer protocols
+
+Usage:
+    python3 .github/scripts/ci_testing/test_espota.py
+
+Each test starts a mock ArduinoOTA device on 127.0.0.1 that answers the UDP
+invitation and pulls the image over TCP the same way ArduinoOTAClass does.
+The mock delays every ACK by a simulated round trip time, so the stop-and-wait
+legacy protocol and the windowed protocol can be compared on loopback.
+
+Scenarios covered:
+  01. Legacy device (ignores the window line)  → ACK per chunk, image intact
+  02. Windowed device, windowed host           → window negotiated, image intact
+  03. Windowed device, --window 0              → legacy ACKs, image intact
+  04. Window capped by the device              → host uses the smaller window
+  05. Device reports an error mid-transfer     → espota exits non-zero
+  06. Throughput with simulated RTT            → windowed faster than legacy
+"""
+
+import hashlib
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from pathlib import Path
+
+ESPOTA = Path(__file__).parent.parent.parent.parent / 'tools' / 'espota.py'
+
+PASS = '\033[32mPASS\033[0m'
+FAIL = '\033[31mFAIL\033[0m'
+_failures: list[str] = []
+
+PROTOCOL_WINDOWED = 2
+
+
+# ---------------------------------------------------------------------------
+# Helpers
+# ---------------------------------------------------------------------------
+
+def section(title: str) -> None:
+    print(f"\n{'=' * 60}")
+    print(f'  {title}')
+    print('=' * 60)
+
+
+def assert_test(name: str, condition: bool, detail: str = '') -> None:
+    if condition:
+        print(f'  {PASS}  {name}')
+    else:
+        msg = f'  {FAIL}  {name}'
+        if detail:
+            msg += f'\n         detail: {detail}'
+        print(msg)
+        _failures.append(name)
+
+
+def free_port(socktype: int) -> int:
+    s = socket.socket(socket.AF_INET, socktype)
+    s.bind(('127.0.0.1', 0))
+    port = s.getsockname()[1]
+    s.close()
+    return port
+
+
+class MockDevice(threading.Thread):
+    """
+    Minimal ArduinoOTA device: answers one invitation, connects back and
+    receives the image. `window` is the largest window the device accepts
+    (0 behaves like a device without windowed support). ACKs are sent
+    `rtt` seconds after the data they acknowledge arrived.
+    """
+
+    def __init__(self, window: int, rtt: float = 0.0, fail_at: int = 0):
+        super().__init__(daemon=True)
+        self.window = window
+        self.rtt = rtt
+        self.fail_at = fail_at
+        self.negotiated = None
+        self.received = bytearray()
+        self.acks = 0
+        self.transfer_time = 0.0
+        self.error = None
+        self.udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.udp.bind(('127.0.0.1', 0))
+        self.udp.settimeout(15)
+        self.port = self.udp.getsockname()[1]
+        self._lock = threading.Lock()
+
+    def _send_ack(self, conn: socket.socket, payload: bytes) -> None:
+        def send():
+            with self._lock:
+                try:
+                    conn.sendall(payload)
+                except OSError:
+                    pass
+        self.acks += 1
+        if self.rtt:
+            timer = threading.Timer(self.rtt, send)
+            timer.start()
+            self._timers.append(timer)
+        else:
+            send()
+
+    def run(self) -> None:
+        try:
+            self._run()
+        except Exception as e:  # noqa: BLE001
+            self.error = str(e)
+        finally:
+            self.udp.close()
+
+    def _run(self) -> None:
+        self._timers = []
+        data, addr = self.udp.recvfrom(512)
+        lines = data.decode().split('\n')
+        # "<cmd> <port> <size> <md5>" like ArduinoOTAClass::_onRx(), anything after the newline is optional
+        _cmd, host_port, size, md5 = lines[0].split()
+        host_port, size = int(host_port), int(size)
+
+        self.negotiated = 0
+        if self.window and len(lines) > 1 and lines[1].startswith('V'):
+            version, host_window = lines[1][1:].split()
+            if int(version) >= PROTOCOL_WINDOWED and int(host_window) > 0:
+                self.negotiated = min(int(host_window), self.window)
+
+        reply = 'OK'
+        if self.negotiated:
+            reply += ' %d %d' % (PROTOCOL_WINDOWED, self.negotiated)
+        self.udp.sendto(reply.encode(), addr)
+
+        conn = socket.create_connection(('127.0.0.1', host_port), timeout=15)
+        start = time.monotonic()
+        acked = 0
+        while len(self.received) < size:
+            chunk = conn.recv(1460)
+            if not chunk:
+                raise ConnectionError('host closed the connection')
+            self.received += chunk
+            total = len(self.received)
+            if self.fail_at and total >= self.fail_at:
+                # like ArduinoOTAClass: printError() then stop()
+                with self._lock:
+                    conn.sendall(b'Flash Write Failed\r\n')
+                time.sleep(0.2)
+                conn.close()
+                return
+            if self.negotiated:
+                if total - acked >= self.negotiated // 2 or total == size:
+                    self._send_ack(conn, b'%d\n' % total)
+                    acked = total
+            else:
+                self._send_ack(conn, b'%d' % len(chunk))
+
+        for timer in self._timers:
+            timer.join()
+        self.transfer_time = time.monotonic() - start
+        ok = hashlib.md5(self.received).hexdigest() == md5
+        with self._lock:
+            conn.sendall(b'OK' if ok else b'MD5 Check Failed\r\n')
+        time.sleep(0.1)
+        conn.close()
+
+
+def run_espota(device: MockDevice, image: Path, *extra_args: str) -> tuple[int, str]:
+    """Upload image to the mock device, return (returncode, stderr)."""
+    device.start()
+    cmd = [
+        sys.executable, str(ESPOTA),
+        '-i', '127.0.0.1',
+        '-I', '127.0.0.1',
+        '-p', str(device.port),
+        '-P', str(free_port(socket.SOCK_STREAM)),
+        '-f', str(image),
+        '-d',
+        *extra_args,
+    ]
+    r = subprocess.run(cmd, capture_output=True, text=True, timeout=120)
+    device.join(timeout=15)
+    return r.returncode, r.stderr
+
+
+def make_image(path: Path, size: int) -> Path:
+    path.write_bytes(os.urandom(size))
+    return path
+
+
+# ---------------------------------------------------------------------------
+# Tests
+# ---------------------------------------------------------------------------
+
+def test_01_legacy_device():
+    section('01. Legacy device ignores the window line')
+    with tempfile.TemporaryDirectory() as tmp:
+        image = make_image(Path(tmp) / 'sketch.bin', 64 * 1024)
+        device = MockDevice(window=0)
+        rc, err = run_espota(device, image)
+        assert_test('espota exits 0', rc == 0, err)
+        assert_test('no window negotiated', device.negotiated == 0)
+        assert_test('image received intact', bytes(device.received) == image.read_bytes(), device.error or '')
+
+
+def test_02_windowed_device():
+    section('02. Windowed device and host')
+    with tempfile.TemporaryDirectory() as tmp:
+        image = make_image(Path(tmp) / 'sketch.bin', 256 * 1024 + 123)
+        device = MockDevice(window=16384)
+        rc, err = run_espota(device, image)
+        assert_test('espota exits 0', rc == 0, err)
+        assert_test('window negotiated', device.negotiated == 16384, str(device.negotiated))
+        assert_test('image received intact', bytes(device.received) == image.read_bytes(), device.error or '')
+        assert_test('one ACK per half window', device.acks <= (256 * 1024 + 123) // 8192 + 1, str(device.acks))
+
+
+def test_03_host_window_disabled():
+    section('03. --window 0 keeps the legacy protocol')
+    with tempfile.TemporaryDirectory() as tmp:
+        image = make_image(Path(tmp) / 'sketch.bin', 64 * 1024)
+        device = MockDevice(window=16384)
+        rc, err = run_espota(device, image, '--window', '0')
+        assert_test('espota exits 0', rc == 0, err)
+        assert_test('no window negotiated', device.negotiated == 0)
+        assert_test('image received intact', bytes(device.received) == image.read_bytes(), device.error or '')
+
+
+def test_04_device_caps_window():
+    section('04. Device caps the host window')
+    with tempfile.TemporaryDirectory() as tmp:
+        image = make_image(Path(tmp) / 'sketch.bin', 128 * 1024)
+        device = MockDevice(window=4096)
+        rc, err = run_espota(device, image, '--window', '65536')
+        assert_test('espota exits 0', rc == 0, err)
+        assert_test('device window used', device.negotiated == 4096, str(device.negotiated))
+        assert_test('host reports device window', 'window: 4096' in err, err)
+        assert_test('image received intact', bytes(device.received) == image.read_bytes(), device.error or '')
+
+
+def test_05_device_error():
+    section('05. Device error during windowed upload')
+    with tempfile.TemporaryDirectory() as tmp:
+        image = make_image(Path(tmp) / 'sketch.bin', 128 * 1024)
+        device = MockDevice(window=16384, fail_at=32 * 1024)
+        rc, err = run_espota(device, image)
+        assert_test('espota exits non-zero', rc != 0, err)
+        assert_test('device error reported', 'Flash Write Failed' in err, err)
+
+
+def test_06_throughput():
+    section('06. Throughput with 5 ms simulated RTT')
+    size = 256 * 1024
+    with tempfile.TemporaryDirectory() as tmp:
+        image = make_image(Path(tmp) / 'sketch.bin', size)
+
+        legacy = MockDevice(window=0, rtt=0.005)
+        rc, err = run_espota(legacy, image)
+        assert_test('legacy upload exits 0', rc == 0, err)
+
+        windowed = MockDevice(window=16384, rtt=0.005)
+        rc, err = run_espota(windowed, image)
+        assert_test('windowed upload exits 0', rc == 0, err)
+
+        # transfer time measured on the device, without espota start-up and invitation
+        legacy_s, windowed_s = legacy.transfer_time, windowed.transfer_time
+        print(f'  legacy:   {size / 1024 / legacy_s:8.1f} KiB/s ({legacy_s:.2f} s)')
+        print(f'  windowed: {size / 1024 / windowed_s:8.1f} KiB/s ({windowed_s:.2f} s)')
+        print(f'  speed-up: {legacy_s / windowed_s:.1f}x')
+        assert_test('windowed upload is faster', windowed_s < legacy_s, f'{windowed_s:.2f} s >= {legacy_s:.2f} s')
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+_ALL_TESTS = [
+    test_01_legacy_device,
+    test_02_windowed_device,
+    test_03_host_window_disabled,
+    test_04_device_caps_window,
+    test_05_device_error,
+    test_06_throughput,
+]
+
+if __name__ == '__main__':
+    print(f'Testing: {ESPOTA}')
+
+    for test_fn in _ALL_TESTS:
+        test_fn()
+
+    total = len(_ALL_TESTS)
+    print(f"\n{'=' * 60}")
+    if _failures:
+        print(f'\n{FAIL} {len(_failures)} assertion(s) failed:')
+        for f in _failures:
+            print(f'  - {f}')
+        print()
+        sys.exit(1)
+    else:
+        print(f'\n{PASS} All {total} test cases passed!')
+        sys.exit(0)
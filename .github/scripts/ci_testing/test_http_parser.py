@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Host test and benchmark for HTTPResponseParser of libraries/HTTPClient
+
+Usage:
+    python3 .github/scripts/ci_testing/test_http_parser.py [--bench]
+
+HTTPResponseParser.cpp only depends on the C/C++ standard library, so it is
+compiled with the host compiler together with http_parser_host.cpp. Every
+response is fed in 4096 byte, 7 byte and single byte pieces, so each state
+of the parser also sees its input split at every position.
+
+Scenarios covered:
+  01. Response head        → status line, header trimming, lines without colon, truncated lines
+  02. Identity bodies      → Content-Length, zero length, read until close, unconsumed bytes after the body
+  03. Chunked bodies       → hex case, extensions, whitespace after the size, bare LF, trailers
+  04. Malformed chunks     → whitespace or CR between digits, leading whitespace, no digits, overlong sizes
+  05. Body sink            → a sink returning false stops the transfer
+  06. Benchmark            → throughput against the former string approach, no heap allocation
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+HERE = Path(__file__).parent
+HTTPCLIENT_SRC = HERE.parent.parent.parent / 'libraries' / 'HTTPClient' / 'src'
+HARNESS = HERE / 'http_parser_host.cpp'
+
+CHUNKS = (4096, 7, 1)
+
+PARSER_ERROR_CHUNK_FORMAT = 1
+PARSER_ERROR_SINK = 2
+
+PASS = '\033[32mPASS\033[0m'
+FAIL = '\033[31mFAIL\033[0m'
+_failures: list[str] = []
+
+
+# ---------------------------------------------------------------------------
+# Helpers
+# ---------------------------------------------------------------------------
+
+def section(title: str) -> None:
+    print(f"\n{'=' * 60}")
+    print(f'  {title}')
+    print('=' * 60)
+
+
+def assert_test(name: str, condition: bool, detail: str = '') -> None:
+    if condition:
+        print(f'  {PASS}  {name}')
+    else:
+        msg = f'  {FAIL}  {name}'
+        if detail:
+            msg += f'\n         detail: {detail}'
+        print(msg)
+        _failures.append(name)
+
+
+def build_harness(out_dir: Path) -> tuple[Path, str]:
+    cxx = os.environ.get('CXX') or shutil.which('g++') or shutil.which('clang++')
+    if not cxx:
+        return None, 'no C++ compiler'
+    exe = out_dir / 'http_parser_host'
+    r = subprocess.run([cxx, '-std=c++17', '-O2', '-Wall', '-I', str(HTTPCLIENT_SRC), '-o', str(exe),
+                        str(HARNESS), str(HTTPCLIENT_SRC / 'HTTPResponseParser.cpp')],
+                       capture_output=True, text=True, timeout=300)
+    return (exe if r.returncode == 0 else None), r.stdout + r.stderr
+
+
+def run_parser(exe: Path, tmp: Path, response: bytes, chunk: int, line_size: int = 1024,
+               sink_limit: int = -1) -> dict:
+    (tmp / 'response.bin').write_bytes(response)
+    r = subprocess.run([str(exe), 'parse', str(tmp / 'response.bin'), str(chunk), str(line_size), str(sink_limit)],
+                       capture_output=True, text=True, timeout=60)
+    out = {'rc': r.returncode, 'raw': r.stdout + r.stderr, 'headers': []}
+    for line in r.stdout.splitlines():
+        key, _, rest = line.partition(' ')
+        if key == 'status':
+            code, minor = rest.split()
+            out['status'] = (int(code), int(minor))
+        elif key == 'header':
+            out['headers'].append(tuple(rest.split('|', 1)))
+        elif key == 'truncated':
+            out['truncated'] = int(rest)
+        elif key == 'body':
+            out['body'] = bytes.fromhex(rest)
+        elif key == 'result':
+            *state, left = rest.split()
+            out['result'] = ' '.join(state)
+            out['left'] = int(left)
+    return out
+
+
+def check(exe: Path, tmp: Path, name: str, response: bytes, status: tuple = (200, 1), headers: list = None,
+          body: bytes = b'', result: str = 'done', left: int = 0, truncated: int = 0, line_size: int = 1024,
+          sink_limit: int = -1) -> None:
+    for chunk in CHUNKS:
+        out = run_parser(exe, tmp, response, chunk, line_size, sink_limit)
+        expected = {'status': status, 'body': body, 'result': result, 'left': left, 'truncated': truncated}
+        got = {k: out.get(k) for k in expected}
+        ok = out['rc'] == 0 and got == expected and (headers is None or out['headers'] == headers)
+        detail = f'expected {expected}, got {got}' + (f', headers {out["headers"]}' if headers is not None else '')
+        assert_test(f'{name}, chunk {chunk}', ok, detail if out['rc'] == 0 else out['raw'])
+
+
+def chunked_response(body: bytes) -> bytes:
+    return b'HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n' + body
+
+
+# ---------------------------------------------------------------------------
+# Tests
+# ---------------------------------------------------------------------------
+
+def test_01_head(exe: Path, tmp: Path):
+    section('01. Response head')
+    check(exe, tmp, 'status line and trimmed headers',
+          b'HTTP/1.1 404 Not Found\r\nContent-Type :  text/plain \t\r\nX-Empty:\r\nContent-Length: 3\r\n\r\nabc',
+          status=(404, 1), body=b'abc',
+          headers=[('Content-Type', 'text/plain'), ('X-Empty', ''), ('Content-Length', '3')])
+    check(exe, tmp, 'HTTP/1.0 with bare LF line ends',
+          b'HTTP/1.0 200 OK\nContent-Length: 2\n\nok', status=(200, 0), body=b'ok')
+    check(exe, tmp, 'empty lines before the status line',
+          b'\r\n\r\nHTTP/1.1 204 No Content\r\nContent-Length: 0\r\n\r\n', status=(204, 1))
+    check(exe, tmp, 'line without colon is skipped',
+          b'HTTP/1.1 200 OK\r\nnot a header\r\nContent-Length: 1\r\n\r\nx', body=b'x',
+          headers=[('Content-Length', '1')])
+    check(exe, tmp, 'overlong header line is truncated and counted',
+          b'HTTP/1.1 200 OK\r\nX-Long: ' + b'a' * 100 + b'\r\nContent-Length: 1\r\n\r\nx', body=b'x',
+          headers=[('X-Long', 'a' * 24), ('Content-Length', '1')], truncated=1, line_size=32)
+    check(exe, tmp, 'status line without code', b'garbage\r\nContent-Length: 0\r\n\r\n', status=(0, 1))
+
+
+def test_02_identity(exe: Path, tmp: Path):
+    section('02. Identity bodies')
+    body = bytes(range(256)) * 20
+    check(exe, tmp, 'Content-Length body',
+          b'HTTP/1.1 200 OK\r\nContent-Length: 5120\r\n\r\n' + body, body=body)
+    check(exe, tmp, 'bytes after Content-Length are left unconsumed',
+          b'HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nbodyHTTP/1.1 200 OK\r\n', body=b'body', left=17)
+    check(exe, tmp, 'Content-Length 0 is done after the head',
+          b'HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n', body=b'')
+    check(exe, tmp, 'no length reads until the connection closes',
+          b'HTTP/1.1 200 OK\r\nConnection: close\r\n\r\nuntil close', body=b'until close', result='open')
+    check(exe, tmp, 'short body stays open',
+          b'HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort', body=b'short', result='open')
+
+
+def test_03_chunked(exe: Path, tmp: Path):
+    section('03. Chunked bodies')
+    check(exe, tmp, 'chunks of upper and lower case sizes',
+          chunked_response(b'5\r\nhello\r\nA\r\n0123456789\r\nb\r\nabcdefghijk\r\n0\r\n\r\n'),
+          body=b'hello0123456789abcdefghijk')
+    check(exe, tmp, 'chunk extensions are ignored',
+          chunked_response(b'5;name=value\r\nhello\r\n3 ; q="a;b"\r\nabc\r\n0;last\r\n\r\n'), body=b'helloabc')
+    check(exe, tmp, 'whitespace after the last digit',
+          chunked_response(b'5 \t \r\nhello\r\n0  \r\n\r\n'), body=b'hello')
+    check(exe, tmp, 'bare LF after the size',
+          chunked_response(b'5\nhello\r\n0\n\r\n'), body=b'hello')
+    check(exe, tmp, 'Transfer-Encoding with several codings',
+          b'HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n2\r\nhi\r\n0\r\n\r\n', body=b'hi')
+    check(exe, tmp, 'trailer fields are skipped',
+          chunked_response(b'2\r\nhi\r\n0\r\nX-Checksum: 1234\r\nX-Other: 5\r\n\r\n'), body=b'hi')
+    check(exe, tmp, 'bytes after the last chunk are left unconsumed',
+          chunked_response(b'2\r\nhi\r\n0\r\n\r\nHTTP/1.1'), body=b'hi', left=8)
+    check(exe, tmp, 'seven digit size',
+          chunked_response(b'0000003\r\nabc\r\n0\r\n\r\n'), body=b'abc')
+    big = bytes(range(256)) * 300
+    check(exe, tmp, 'large chunk', chunked_response(b'12c00\r\n' + big + b'\r\n0\r\n\r\n'), body=big)
+
+
+def test_04_malformed(exe: Path, tmp: Path):
+    section('04. Malformed chunks')
+    error = f'error {PARSER_ERROR_CHUNK_FORMAT}'
+    cases = (
+        ('space between digits', b'1 2\r\n' + b'x' * 18 + b'\r\n0\r\n\r\n', 0),
+        ('tab between digits', b'1\t2\r\n' + b'x' * 18 + b'\r\n0\r\n\r\n', 0),
+        ('CR between digits', b'1\r2\r\n' + b'x' * 18 + b'\r\n0\r\n\r\n', 0),
+        ('CR followed by whitespace', b'5\r \nhello\r\n0\r\n\r\n', 0),
+        ('leading whitespace', b' 5\r\nhello\r\n0\r\n\r\n', 0),
+        ('no digits', b'\r\nhello\r\n0\r\n\r\n', 0),
+        ('extension without size', b';ext\r\nhello\r\n0\r\n\r\n', 0),
+        ('text after the size', b'5 x\r\nhello\r\n0\r\n\r\n', 0),
+        ('not hex', b'zz\r\nhello\r\n0\r\n\r\n', 0),
+        ('eight digit size', b'10000000\r\n', 0),
+        ('no CRLF after the data', b'5\r\nhelloX\r\n0\r\n\r\n', 5),
+        ('LF without CR after the data', b'5\r\nhello\n0\r\n\r\n', 5),
+    )
+    for name, chunks, body_len in cases:
+        response = chunked_response(chunks)
+        for chunk in CHUNKS:
+            out = run_parser(exe, tmp, response, chunk)
+            ok = out['rc'] == 0 and out.get('result') == error and len(out.get('body', b'')) == body_len
+            assert_test(f'{name}, chunk {chunk}', ok, out['raw'])
+
+
+def test_05_sink(exe: Path, tmp: Path):
+    section('05. Body sink')
+    body = b'x' * 1000
+    for name, response in (('identity', b'HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n' + body),
+                           ('chunked', chunked_response(b'3e8\r\n' + body + b'\r\n0\r\n\r\n'))):
+        for chunk in CHUNKS:
+            out = run_parser(exe, tmp, response, chunk, sink_limit=100)
+            ok = out['rc'] == 0 and out.get('result') == f'error {PARSER_ERROR_SINK}' and \
+                100 <= len(out.get('body', b'')) <= 100 + chunk
+            assert_test(f'{name} sink returning false stops the body, chunk {chunk}', ok, out['raw'])
+
+
+def test_06_bench(exe: Path, iterations: int):
+    section('06. Benchmark')
+    r = subprocess.run([str(exe), 'bench', str(iterations)], capture_output=True, text=True, timeout=600)
+    assert_test('benchmark runs', r.returncode == 0, r.stdout + r.stderr)
+    results = {}
+    for m in re.finditer(r'(String|Parser) (\w+): Rate = ([\d.]+) MB/s Time: (\d+) ns Allocs: ([\d.]+)', r.stdout):
+        impl, case, rate, ns, allocs = m.groups()
+        results[(case, impl)] = (float(rate), int(ns), float(allocs))
+        print(f'        {impl:6} {case:8} {float(rate):8.1f} MB/s {int(ns):6d} ns  {float(allocs):4.1f} allocations')
+    cases = sorted({case for case, _ in results})
+    assert_test('every response benchmarked', len(cases) == 3 and len(results) == 6, r.stdout)
+    for case in cases:
+        assert_test(f'{case}: parser does not allocate', results[(case, 'Parser')][2] == 0)
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+_ALL_TESTS = [
+    test_01_head,
+    test_02_identity,
+    test_03_chunked,
+    test_04_malformed,
+    test_05_sink,
+]
+
+if __name__ == '__main__':
+    print(f'Testing: {HTTPCLIENT_SRC / "HTTPResponseParser.cpp"}')
+
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp = Path(tmp)
+        exe, out = build_harness(tmp)
+        if exe is None and out == 'no C++ compiler':
+            print('  SKIP  no C++ compiler found')
+            sys.exit(0)
+        section('Build')
+        assert_test('harness builds', exe is not None, out)
+        if exe is not None:
+            for test in _ALL_TESTS:
+                test(exe, tmp)
+            test_06_bench(exe, 200000 if '--bench' in sys.argv else 20000)
+
+    total = len(_ALL_TESTS) + 1
+    print(f"\n{'=' * 60}")
+    if _failures:
+        print(f'\n{FAIL} {len(_failures)} assertion(s) failed:')
+        for f in _failures:
+            print(f'  - {f}')
+        print()
+        sys.exit(1)
+    else:
+        print(f'\n{PASS} All {total} test cases passed!')
+        sys.exit(0)
@@ -0,0 +1,493 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Host test for tools/ota_package.py
+
+Usage:
+    python3 .github/scripts/ci_testing/test_ota_package.py
+
+The images are synthetic firmware-like binaries: a code section with repeated
+instruction patterns, a string table and some random data. The "new" image is
+the base with a few patched bytes, an inserted function and shifted pointers,
+which is what a small source change usually does to a real build.
+
+Scenarios covered:
+  01. Full packages (none, gzip, heatshrink)   → header valid, decode round trip
+  02. heatshrink window/lookahead range        → round trip for every setting
+  03. Delta packages (gzip, heatshrink)        → round trip, much smaller than full
+  04. Delta against the wrong base             → rejected
+  05. Corrupt and truncated packages           → rejected
+  06. Command line --out and --verify          → exit codes and messages
+  07. C++ decoder of libraries/Update          → same image from tool packages, corrupt chunk rejected
+  08. Streams of reference encoders            → GNU gzip, zlib block types and header fields, heatshrink
+"""
+
+import base64
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import zlib
+from pathlib import Path
+
+TOOL = Path(__file__).parent.parent.parent.parent / 'tools' / 'ota_package.py'
+UPDATE_SRC = TOOL.parent.parent / 'libraries' / 'Update' / 'src'
+HARNESS = Path(__file__).parent / 'upkg_decode.cpp'
+sys.path.insert(0, str(TOOL.parent))
+
+import ota_package  # noqa: E402
+
+PASS = '\033[32mPASS\033[0m'
+FAIL = '\033[31mFAIL\033[0m'
+_failures: list[str] = []
+
+
+# ---------------------------------------------------------------------------
+# Helpers
+# ---------------------------------------------------------------------------
+
+def section(title: str) -> None:
+    print(f"\n{'=' * 60}")
+    print(f'  {title}')
+    print('=' * 60)
+
+
+def assert_test(name: str, condition: bool, detail: str = '') -> None:
+    if condition:
+        print(f'  {PASS}  {name}')
+    else:
+        msg = f'  {FAIL}  {name}'
+        if detail:
+            msg += f'\n         detail: {detail}'
+        print(msg)
+        _failures.append(name)
+
+
+def make_image(size: int, seed: int = 1) -> bytes:
+    rng = random.Random(seed)
+    image = bytearray(b'\xe9\x03\x02\x20')
+    opcodes = [rng.randbytes(3) for _ in range(64)]
+    while len(image) < size * 6 // 10:
+        image += rng.choice(opcodes)
+    words = [b'WiFi', b'connect', b'error', b'timeout', b'update', b'partition', b'%s: %d\n', b'ok']
+    while len(image) < size * 8 // 10:
+        image += b' '.join(rng.choice(words) for _ in range(4)) + b'\0'
+    image += rng.randbytes(size - len(image))
+    return bytes(image[:size])
+
+
+def modify_image(base: bytes, seed: int = 2) -> bytes:
+    rng = random.Random(seed)
+    image = bytearray(base)
+    for _ in range(32):
+        image[rng.randrange(len(image))] = rng.randrange(256)
+    pos = len(image) // 3
+    image[pos:pos] = rng.randbytes(700)
+    # pointers into the moved code shift by a constant
+    for i in range(pos + 4096, pos + 8192, 16):
+        image[i] = (image[i] + 0x40) & 0xFF
+    return bytes(image)
+
+
+def decodes_to(package: bytes, image: bytes, base: bytes = None) -> tuple[bool, str]:
+    try:
+        return ota_package.unpack_package(package, base) == image, ''
+    except (ValueError, zlib.error) as e:
+        return False, str(e)
+
+
+def rejected(package: bytes, base: bytes = None) -> bool:
+    try:
+        ota_package.unpack_package(package, base)
+    except (ValueError, zlib.error, IndexError):
+        return True
+    return False
+
+
+def run_tool(*args: str) -> tuple[int, str]:
+    r = subprocess.run([sys.executable, str(TOOL), *args], capture_output=True, text=True, timeout=300)
+    return r.returncode, r.stdout + r.stderr
+
+
+def build_decoder(out_dir: Path) -> tuple[Path, str]:
+    cxx = os.environ.get('CXX') or shutil.which('g++') or shutil.which('clang++')
+    if not cxx:
+        return None, 'no C++ compiler'
+    exe = out_dir / 'upkg_decode'
+    r = subprocess.run([cxx, '-std=c++17', '-O2', '-Wall', '-I', str(UPDATE_SRC), '-o', str(exe),
+                        str(HARNESS), str(UPDATE_SRC / 'Updater_Package.cpp')],
+                       capture_output=True, text=True, timeout=300)
+    return (exe if r.returncode == 0 else None), r.stdout + r.stderr
+
+
+def run_decoder(exe: Path, tmp: Path, package: bytes, base: bytes = None, chunk: int = 4096) -> tuple[int, str, bytes]:
+    (tmp / 'in.upkg').write_bytes(package)
+    args = [str(exe), str(tmp / 'in.upkg'), str(tmp / 'out.bin'), '-', str(chunk)]
+    if base is not None:
+        (tmp / 'base.bin').write_bytes(base)
+        args[3] = str(tmp / 'base.bin')
+    if os.path.exists(tmp / 'out.bin'):
+        os.remove(tmp / 'out.bin')
+    r = subprocess.run(args, capture_output=True, text=True, timeout=300)
+    image = (tmp / 'out.bin').read_bytes() if r.returncode == 0 else b''
+    return r.returncode, r.stdout.strip(), image
+
+
+def fixture_text() -> bytes:
+    states = ('valid', 'invalid', 'pending')
+    return ''.join(f'{i:04d} ota_{i % 2} offset 0x{0x10000 + i * 0x1000:06x} state {states[i % 3]}\n'
+                   for i in range(200)).encode()
+
+
+def fixture_mixed() -> bytes:
+    rng = random.Random(7)
+    return fixture_text()[:2000] + rng.randbytes(600) + b'\0' * 3000 + fixture_text()[:1000]
+
+
+def gzip_member(deflate: bytes, data: bytes, extra: bytes = None, name: bytes = None, comment: bytes = None,
+                header_crc: bool = False) -> bytes:
+    """RFC 1952 member around a raw deflate stream, with the optional header fields that are given."""
+    flags = (0x04 if extra is not None else 0) | (0x08 if name is not None else 0) | \
+        (0x10 if comment is not None else 0) | (0x02 if header_crc else 0)
+    header = bytearray(b'\x1f\x8b\x08' + bytes([flags]) + b'\x00\xb9\x55\x69\x02\x03')
+    if extra is not None:
+        header += len(extra).to_bytes(2, 'little') + extra
+    if name is not None:
+        header += name + b'\0'
+    if comment is not None:
+        header += comment + b'\0'
+    if header_crc:
+        header += (zlib.crc32(header) & 0xFFFF).to_bytes(2, 'little')
+    trailer = zlib.crc32(data).to_bytes(4, 'little') + (len(data) & 0xFFFFFFFF).to_bytes(4, 'little')
+    return bytes(header) + deflate + trailer
+
+
+def raw_deflate(data: bytes, level: int = 6, wbits: int = 15, mem_level: int = 8,
+                strategy: int = zlib.Z_DEFAULT_STRATEGY) -> bytes:
+    compressor = zlib.compressobj(level, zlib.DEFLATED, -wbits, mem_level, strategy)
+    return compressor.compress(data) + compressor.flush()
+
+
+def reference_heatshrink(data: bytes, window: int, lookahead: int) -> bytes:
+    """Output of the reference heatshrink encoder (heatshrink2 module or heatshrink CLI), None if not installed."""
+    try:
+        import heatshrink2
+        return heatshrink2.compress(data, window_sz2=window, lookahead_sz2=lookahead)
+    except ImportError:
+        pass
+    exe = shutil.which('heatshrink')
+    if exe:
+        r = subprocess.run([exe, '-e', '-w', str(window), '-l', str(lookahead)], input=data, capture_output=True,
+                           timeout=300)
+        if r.returncode == 0:
+            return r.stdout
+    return None
+
+
+# GNU gzip 1.12 output; its deflate implementation is independent from zlib, which ota_package.py uses.
+# `gzip -9` of fixture_text() with file name and mtime in the header, `gzip -1 -n` of fixture_mixed().
+GNU_GZIP_TEXT_9 = base64.b64decode(
+    'H4sICAC5VWkCA2ZpeHR1cmUudHh0AG3XTarkRhQF4blX0UtQSsq/1ZiUVGUemLahH8bLd7cHbsP5JgUqkhuDGARn27btyx+f'
+    '69fvv+/3t9fnl+3vrWw//v32uT5fX/5av388v3z/Lv8+K/9/Vn4++/j638M97+0/H/75+vp8fP3tx8MjLx4An3nvJLjmvUpw'
+    'y4sN4J73OsEj7w2CZ16cCS4wsgQucHIJXODkBhhGHoLh5EUwnLwBTiP7RnA62QvB6WTfAU4j+yHwnk72U+A9new1wXsa2RvB'
+    '6WTvBKeTfQCcRvZJMJwsguHkAhhGboLh5BH4gJNXgg8YeQt8pJNjIzidHAXgNHLsBKeT4yA4nRwnwGnkqASnk6MRnE6OnuAz'
+    'jRxD4DOdHFPgE04WwDByEQwnN8Fw8gAMIy+C4eRNcDo50eMzjZzscU0nJ3tc08mJHtc0crLHNZ2c7HFNJyd6XNPIyR7XdHKy'
+    'xzWdnOhxhRH2uMIJe9zgBD1uMMIeNzhhjxucoMctjVT2uKWTyh63dFLR45ZGKnvc0kllj1s6qehxTyOVPe7ppLLHPZ1U9Lin'
+    'kcoedzhhjzucoMcdRtjjDifscYcT9LjDCHs80kljj0c6aejxSCONPR7ppLHHI5009HikkcYej3TS2OORThp6PNJIY49HOmns'
+    '8YQT9HjCCHs84YQ9nnCCHk8YYY8nnLDHM5109Himkc4ez3TS2eOZTnr2uGC/d/W4YMF39bhgwfcGcBrpneB00gfB6aRPgGFk'
+    'EQwnF8FwcgMMI+pxwYLv6nHBgu/Z44L9PjaC08koBKeTsQOcRsZBcDoZJ8HpZFSA08hoBKeToR4XLPiRPS7Y70M9LljwYxEM'
+    'JxfAMHITDCcPwXDyAhhG3gSnk7kRnE5m9rhgv0/1uGDBT/W4YMHPE+A0MivB6WQ2gtPJ7ACnkTkITidzEgwnC2AYUY8LFvxU'
+    'jwsW/MweF+z3+SIYTt4Ep5O1AZxGViE4nayd4HSy0GPs98UeY8Ev9hgLfqHH2O+LPcaCX+wxFvxCj7HfF3uMBb/YYyz4hR5j'
+    'vy/2GAt+scdY8As9xn6/2GMs+Is9xoK/0GPs94s9xoK/2GMs+As9xn6/2GMs+Is9xoK/0GPs94s9xoK/2GMs+As9xn6/2GMs'
+    '+Is9xoK/0GPs94s9xoK/2WMs+Bs9xn6/2WMs+Js9xoK/0WPs95s9xoK/2WMs+Bs9xn6/2WMs+Js9xoK/0WPs95s9xoK/2WMs'
+    '+Bs9xn6/2WMs+Js9xoJ/0GPs94c9xoJ/2GMs+Ac9xn5/2GMs+Ic9xoJ/0GPs9wc9/gdL3NHHgh8AAA=='
+)
+
+GNU_GZIP_MIXED_1 = base64.b64decode(
+    'H4sIAAAAAAAEA+2ZW0yTZxjHndjJwdJyGg0uWJWUuQN8hwKFbZI0c7quum6RAAY0VYqphcpogc2pBE08TGY7KMJQcQ6Zgw2w'
+    'oCRjdI64zShVKUycGhQ7goSBrk1xbBi21q3f+yTvd7WrXXxcNIH88/zC8/vfvE8JgiDE243qTd7P/HyDxigm3iNI7x8JscGo'
+    'NmrEpeoCbV6w93fyScz7iWK+3L8xrZ4JUvg8CgWLNPo8rX6rbyKNT6RRkJknxedJUQyAk/B5SSgIwMn4xGQUZMAp+LwUFANg'
+    'GT5PhoIAnIpPTEVBP5hkMaJGMQQmWZxsRkEEJlmcbEFBBsxiJA/FAJjFiQYFAZjFST4KMmDciK8yeLlI3AkFWgjAuBMKtJAB'
+    '40Yo0EH0H1O4Ewq0EIEp3AkFWugHU7gRCnQQgHEnFGghAONOKNBCBowboUAHAZjFCWghALM4AS1kwCxGQAcBmMUJaCEC0yxO'
+    'QAv9YJrFCOggAtO4E18X/C0EYNwJDVrIgHEjNOggAONOaNBCAMad0KCFDBg3QoMOAjDuhAYtBGDcCQ1a6AdLcSM06CACS3En'
+    'NGghAktZnIAWMmAWI6CDAMziBLQQgFmcgBYyYBYjoIMAzOIEtBCAcSc+xf4WMmDciNTbQdnZsXdG1552p/AbJKHxERrVqcbP'
+    '+8tzFtGJh8LjAtMHXjAnHgwbF4lmLh3Pza0ja0oW3Ay15DrHp9fdr7CXPEr+WfVJ0IbGec9s2Bqw/eh6vs4U4gyLiz726s3f'
+    'ZdFX9WEfSRStBV3DSwXtlq8Gr1X1mpfvtC7JFVa6swlJqqyz6OS50hOfutak1zTzj7tdxJDg2gJb9XTwWE3krUrNMad1kf3W'
+    'r3+YHXWyMzcmQ1bWVhzuO/L97dZvo5cdub5cIe9Q6k6NTcVNbtn24Xcn42Oz8uOrZC0z67J4habEL6b6Ld21bYeiXktw3lbH'
+    'fHz+F4vWkFa1+rqp8QeViAgoztg0kOQSrZiVVS4bVXal/BYuvFC0w3yWJxdYtWUNd899LY3jRZWvtya0bXbEHth9prRQVDbz'
+    '40O3TiVsJ8sc6vs1+0/nTxKjAcasZnNO636bssxZlx5vzOmrJ3kJFqWrQzzx2cXZxbtWphs8ke16fnWGeFi5dLVh39Pu87sv'
+    'zg8aucJ7kCme6ulOs48VByq63njcM3pUZpv886rCFi40pcb2LAzdOy4K1v3kSXv+r8eDvQkz5syMknGJs2/iwZ72F3dpCzy6'
+    '2p1BwZ57rz/qJ4Vf7nt4J6JhovvCDv6dw+5Ba9XGiPmXM1VLRi7XlzvsvW+r5PLwTNPInPUDRVP2lRPP1b0ZKSlfHGC0DD/7'
+    'lH3b3UtGR3F92Jw48EbK+HT0UMOQq8IWs2rFno3vr8p+tyPmHq+lY6hRGBJ4QCCQv/RN8qyls69Q/lbFKy1NnWs81SEHX56j'
+    'TZq2pmbtQNHeqOJ53A+3AW4D3Aa4DXAb4DbAbYDbALcBbgP/+w08eTly910SXDX8L2gCf5GT4KaBnu4E/iInwVUDPd0J/E1O'
+    'gquGH8zdd73fMXD33X++V6Hwy9V/ue/+Dczuc6jIGQAA'
+)
+
+BASE = make_image(256 * 1024)
+NEW = modify_image(BASE)
+
+
+# ---------------------------------------------------------------------------
+# Tests
+# ---------------------------------------------------------------------------
+
+def test_01_full_packages():
+    section('01. Full packages')
+    for name, compression in sorted(ota_package.COMPRESSIONS.items()):
+        package = ota_package.build_package(NEW, compression)
+        header = ota_package.parse_header(package)
+        ok, err = decodes_to(package, NEW)
+        assert_test(f'{name}: header magic', package[:4] == ota_package.MAGIC)
+        assert_test(f'{name}: image size in header', header['image_size'] == len(NEW), str(header['image_size']))
+        assert_test(f'{name}: not a delta', not header['flags'] & ota_package.FLAG_DELTA)
+        assert_test(f'{name}: round trip', ok, err)
+        print(f'  {name:10s} {len(NEW):7d} -> {len(package):7d} bytes ({100 * len(package) / len(NEW):.1f}%)')
+
+
+def test_02_heatshrink_parameters():
+    section('02. heatshrink window and lookahead bits')
+    image = NEW[:32 * 1024]
+    for window, lookahead in [(4, 3), (8, 4), (11, 4), (11, 8), (13, 5), (15, 14)]:
+        package = ota_package.build_package(image, ota_package.COMPRESSION_HEATSHRINK, window=window, lookahead=lookahead)
+        header = ota_package.parse_header(package)
+        ok, err = decodes_to(package, image)
+        assert_test(f'w{window} l{lookahead}: parameters in header',
+                    (header['window'], header['lookahead']) == (window, lookahead))
+        assert_test(f'w{window} l{lookahead}: round trip', ok, err)
+
+
+def test_03_delta_packages():
+    section('03. Delta packages')
+    for name in ('gzip', 'heatshrink'):
+        compression = ota_package.COMPRESSIONS[name]
+        full = ota_package.build_package(NEW, compression)
+        delta = ota_package.build_package(NEW, compression, base=BASE)
+        header = ota_package.parse_header(delta)
+        ok, err = decodes_to(delta, NEW, BASE)
+        assert_test(f'{name}: delta flag set', header['flags'] & ota_package.FLAG_DELTA)
+        assert_test(f'{name}: base size in header', header['base_size'] == len(BASE), str(header['base_size']))
+        assert_test(f'{name}: round trip', ok, err)
+        assert_test(f'{name}: delta smaller than a quarter of the full package', len(delta) * 4 < len(full),
+                    f'{len(delta)} vs {len(full)}')
+        print(f'  {name:10s} full {len(full):7d}, delta {len(delta):6d} bytes ({100 * len(delta) / len(NEW):.1f}%)')
+
+    # a base running with trailing flash contents is fine, only base_size bytes are hashed
+    delta = ota_package.build_package(NEW, ota_package.COMPRESSION_GZIP, base=BASE)
+    ok, err = decodes_to(delta, NEW, BASE + b'\xff' * 4096)
+    assert_test('base with trailing erased flash', ok, err)
+
+    identical = ota_package.build_package(BASE, ota_package.COMPRESSION_GZIP, base=BASE)
+    ok, err = decodes_to(identical, BASE, BASE)
+    assert_test('unchanged image round trip', ok, err)
+    assert_test('unchanged image is tiny', len(identical) < ota_package.HEADER_SIZE + 128, str(len(identical)))
+
+
+def test_04_wrong_base():
+    section('04. Delta against the wrong base')
+    delta = ota_package.build_package(NEW, ota_package.COMPRESSION_GZIP, base=BASE)
+    other = bytearray(BASE)
+    other[1000] ^= 1
+    assert_test('modified base rejected', rejected(delta, bytes(other)))
+    assert_test('short base rejected', rejected(delta, BASE[:-1]))
+    assert_test('missing base rejected', rejected(delta))
+
+
+def test_05_corrupt_packages():
+    section('05. Corrupt and truncated packages')
+    package = ota_package.build_package(NEW, ota_package.COMPRESSION_GZIP)
+    bad_magic = b'XPKG' + package[4:]
+    bad_version = package[:4] + b'\x09' + package[5:]
+    flipped = bytearray(package)
+    flipped[len(package) // 2] ^= 0x10
+    assert_test('bad magic rejected', rejected(bad_magic))
+    assert_test('unknown version rejected', rejected(bad_version))
+    assert_test('corrupt gzip payload rejected', rejected(bytes(flipped)))
+    assert_test('truncated gzip payload rejected', rejected(package[:-100]))
+    assert_test('truncated header rejected', rejected(package[:ota_package.HEADER_SIZE - 1]))
+
+    hs = ota_package.build_package(NEW, ota_package.COMPRESSION_HEATSHRINK)
+    assert_test('truncated heatshrink payload rejected', rejected(hs[:len(hs) // 2]))
+
+
+def test_06_command_line():
+    section('06. Command line')
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp = Path(tmp)
+        (tmp / 'base.bin').write_bytes(BASE)
+        (tmp / 'new.bin').write_bytes(NEW)
+
+        rc, out = run_tool('--bin', str(tmp / 'new.bin'), '--out', str(tmp / 'full.upkg'))
+        assert_test('full package exits 0', rc == 0, out)
+        assert_test('full package reported', 'full package' in out, out)
+
+        rc, out = run_tool('--bin', str(tmp / 'new.bin'), '--base', str(tmp / 'base.bin'),
+                           '--compress', 'heatshrink', '--out', str(tmp / 'delta.upkg'))
+        assert_test('delta package exits 0', rc == 0, out)
+        assert_test('delta package reported', 'delta package' in out, out)
+
+        rc, out = run_tool('--verify', str(tmp / 'delta.upkg'), '--bin', str(tmp / 'new.bin'),
+                           '--base', str(tmp / 'base.bin'))
+        assert_test('--verify delta exits 0', rc == 0, out)
+
+        rc, out = run_tool('--verify', str(tmp / 'delta.upkg'), '--bin', str(tmp / 'new.bin'),
+                           '--base', str(tmp / 'new.bin'))
+        assert_test('--verify with wrong base exits 1', rc == 1, out)
+
+        rc, out = run_tool('--verify', str(tmp / 'full.upkg'), '--bin', str(tmp / 'base.bin'))
+        assert_test('--verify against other image exits 1', rc == 1, out)
+
+        rc, out = run_tool('--bin', str(tmp / 'new.bin'), '--out', str(tmp / 'x.upkg'),
+                           '--compress', 'heatshrink', '--window', '16')
+        assert_test('invalid window exits 1', rc == 1, out)
+        assert_test('no output for invalid window', not os.path.exists(tmp / 'x.upkg'))
+
+
+def test_07_cpp_decoder():
+    section('07. C++ decoder (libraries/Update)')
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp = Path(tmp)
+        exe, out = build_decoder(tmp)
+        if exe is None and out == 'no C++ compiler':
+            print('  SKIP  no C++ compiler found')
+            return
+        assert_test('harness builds', exe is not None, out)
+        if exe is None:
+            return
+
+        # odd chunk sizes split headers, codes and patch operations across writes
+        for name, compression in sorted(ota_package.COMPRESSIONS.items()):
+            package = ota_package.build_package(NEW, compression)
+            for chunk in (4096, 1, 333):
+                rc, out, image = run_decoder(exe, tmp, package, chunk=chunk)
+                assert_test(f'{name} chunk {chunk}: same image as the tool', rc == 0 and image == NEW, out)
+
+        for name in ('gzip', 'heatshrink'):
+            delta = ota_package.build_package(NEW, ota_package.COMPRESSIONS[name], base=BASE)
+            rc, out, image = run_decoder(exe, tmp, delta, base=BASE, chunk=777)
+            assert_test(f'{name} delta: same image as the tool', rc == 0 and image == NEW, out)
+
+        hs = ota_package.build_package(NEW[:32 * 1024], ota_package.COMPRESSION_HEATSHRINK, window=8, lookahead=4)
+        rc, out, image = run_decoder(exe, tmp, hs)
+        assert_test('heatshrink w8 l4: same image as the tool', rc == 0 and image == NEW[:32 * 1024], out)
+
+        # PACKAGE_ERROR_DATA for a corrupt chunk, PACKAGE_ERROR_SIZE for a short stream
+        package = ota_package.build_package(NEW, ota_package.COMPRESSION_GZIP)
+        flipped = bytearray(package)
+        flipped[len(package) // 2] ^= 0x10
+        rc, out, _ = run_decoder(exe, tmp, bytes(flipped))
+        assert_test('corrupt gzip chunk rejected with a data error', rc == 1 and out == 'error 2', out)
+        rc, out, _ = run_decoder(exe, tmp, package[:-100])
+        assert_test('truncated gzip payload rejected', rc == 1 and out.startswith('error'), out)
+
+        delta = bytearray(ota_package.build_package(NEW, ota_package.COMPRESSION_NONE, base=BASE))
+        delta[ota_package.HEADER_SIZE] = 0xFF  # not a valid operation
+        delta[ota_package.HEADER_SIZE + 1] = 0xFF
+        rc, out, _ = run_decoder(exe, tmp, bytes(delta), base=BASE)
+        assert_test('corrupt patch chunk rejected', rc == 1 and out.startswith('error'), out)
+
+        rc, out, _ = run_decoder(exe, tmp, b'XPKG' + package[4:])
+        assert_test('bad magic rejected', rc == 1 and out == 'error header', out)
+
+
+def test_08_reference_encoders():
+    section('08. Streams of reference encoders')
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp = Path(tmp)
+        exe, out = build_decoder(tmp)
+        if exe is None and out == 'no C++ compiler':
+            print('  SKIP  no C++ compiler found')
+            return
+        assert_test('harness builds', exe is not None, out)
+        if exe is None:
+            return
+
+        def check(name: str, image: bytes, payload: bytes, compression: int, window: int = 0, lookahead: int = 0,
+                  chunks: tuple = (4096, 333)) -> None:
+            package = ota_package.make_header(compression, len(image), window, lookahead) + payload
+            for chunk in chunks:
+                rc, out, decoded = run_decoder(exe, tmp, package, chunk=chunk)
+                assert_test(f'{name}, chunk {chunk}: C++ decoder', rc == 0 and decoded == image, out)
+            ok, err = decodes_to(package, image)
+            assert_test(f'{name}: ota_package.py decoder', ok, err)
+
+        gzip = ota_package.COMPRESSION_GZIP
+        check('GNU gzip -9 with file name', fixture_text(), GNU_GZIP_TEXT_9, gzip, chunks=(4096, 1))
+        check('GNU gzip -1', fixture_mixed(), GNU_GZIP_MIXED_1, gzip, chunks=(4096, 1))
+
+        images = (('image', NEW), ('random', random.Random(5).randbytes(128 * 1024)), ('zeros', bytes(100000)))
+        gzip_exe = shutil.which('gzip')
+        if gzip_exe:
+            for level in (1, 6, 9):
+                for label, image in images:
+                    r = subprocess.run([gzip_exe, f'-{level}', '-c', '-n'], input=image, capture_output=True,
+                                       timeout=300)
+                    check(f'GNU gzip -{level} {label}', image, r.stdout, gzip)
+        else:
+            print('  SKIP  gzip command not found, only the stored GNU gzip vectors were checked')
+
+        # every block type zlib can produce, small windows, and flushes that insert empty stored blocks
+        image = NEW[:64 * 1024]
+        variants = (
+            ('stored blocks', {'level': 0}),
+            ('fixed Huffman', {'level': 9, 'strategy': zlib.Z_FIXED}),
+            ('Huffman only', {'strategy': zlib.Z_HUFFMAN_ONLY}),
+            ('RLE', {'strategy': zlib.Z_RLE}),
+            ('filtered', {'strategy': zlib.Z_FILTERED}),
+            ('512 byte window', {'level': 9, 'wbits': 9, 'mem_level': 1}),
+        )
+        for label, kwargs in variants:
+            check(f'zlib {label}', image, gzip_member(raw_deflate(image, **kwargs), image), gzip)
+        compressor = zlib.compressobj(6, zlib.DEFLATED, -15)
+        flushed = compressor.compress(image[:1000]) + compressor.flush(zlib.Z_SYNC_FLUSH) + \
+            compressor.compress(image[1000:40000]) + compressor.flush(zlib.Z_FULL_FLUSH) + \
+            compressor.compress(image[40000:]) + compressor.flush()
+        check('zlib sync and full flushes', image, gzip_member(flushed, image), gzip)
+        member = gzip_member(raw_deflate(image), image, extra=b'AP\x04\x00test', name=b'firmware.bin',
+                             comment=b'built by ci', header_crc=True)
+        check('gzip header with extra, name, comment and header CRC', image, member, gzip, chunks=(4096, 1))
+
+        for window, lookahead in ((8, 4), (11, 4), (13, 6), (15, 4)):
+            payload = reference_heatshrink(NEW, window, lookahead)
+            if payload is None:
+                print('  SKIP  reference heatshrink encoder (heatshrink2 module or heatshrink command) not installed')
+                break
+            check(f'heatshrink w{window} l{lookahead}', NEW, payload, ota_package.COMPRESSION_HEATSHRINK, window,
+                  lookahead)
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+_ALL_TESTS = [
+    test_01_full_packages,
+    test_02_heatshrink_parameters,
+    test_03_delta_packages,
+    test_04_wrong_base,
+    test_05_corrupt_packages,
+    test_06_command_line,
+    test_07_cpp_decoder,
+    test_08_reference_encoders,
+]
+
+if __name__ == '__main__':
+    print(f'Testing: {TOOL}')
+
+    for test_fn in _ALL_TESTS:
+        test_fn()
+
+    total = len(_ALL_TESTS)
+    print(f"\n{'=' * 60}")
+    if _failures:
+        print(f'\n{FAIL} {len(_failures)} assertion(s) failed:')
+        for f in _failures:
+            print(f'  - {f}')
+        print()
+        sys.exit(1)
+    else:
+        print(f'\n{PASS} All {total} test cases passed!')
+        sys.exit(0)
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Host test for the timer wheel of libraries/Ticker (TickerWheel.cpp)
+
+Usage:
+    python3 .github/scripts/ci_testing/test_ticker_wheel.py
+
+TickerWheel.cpp is compiled with the host compiler against the stubs in
+ticker_wheel_stubs/ and driven by ticker_wheel_host.cpp through a fake clock,
+so delays of days or weeks run in milliseconds.
+
+Scenarios covered:
+  01. levels      → one-shots across the level 1/2/3 boundaries fire on their tick, in due order
+  02. parking     → delays beyond 2^24 ticks are parked and re-inserted until they fire on their tick
+  03. drift       → periodic callbacks with late wakeups stay within one tick of their ideal time
+  04. catchup     → after a stall one wakeup runs all overdue callbacks in due order, one slot per lock
+  05. long_stall  → a 2^36 tick stall jumps to the occupied slots instead of walking every tick
+  06. reentrant   → callbacks rescheduling themselves and cancelling entries of the same tick
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+HERE = Path(__file__).parent
+TICKER_SRC = HERE.parent.parent.parent / 'libraries' / 'Ticker' / 'src'
+HARNESS = HERE / 'ticker_wheel_host.cpp'
+STUBS = HERE / 'ticker_wheel_stubs'
+
+# a wheel walking a long stall tick by tick never finishes; this bounds the whole run
+RUN_TIMEOUT = 60
+
+SCENARIOS = ['levels', 'parking', 'drift', 'catchup', 'long_stall', 'reentrant']
+
+PASS = '\033[32mPASS\033[0m'
+FAIL = '\033[31mFAIL\033[0m'
+_failures: list[str] = []
+
+
+# ---------------------------------------------------------------------------
+# Helpers
+# ---------------------------------------------------------------------------
+
+def section(title: str) -> None:
+    print(f"\n{'=' * 60}")
+    print(f'  {title}')
+    print('=' * 60)
+
+
+def assert_test(name: str, condition: bool, detail: str = '') -> None:
+    if condition:
+        print(f'  {PASS}  {name}')
+    else:
+        msg = f'  {FAIL}  {name}'
+        if detail:
+            msg += f'\n         detail: {detail}'
+        print(msg)
+        _failures.append(name)
+
+
+def build_harness(out_dir: Path) -> tuple[Path, str]:
+    cxx = os.environ.get('CXX') or shutil.which('g++') or shutil.which('clang++')
+    if not cxx:
+        return None, 'no C++ compiler'
+    exe = out_dir / 'ticker_wheel_host'
+    r = subprocess.run([cxx, '-std=c++17', '-O2', '-Wall', '-I', str(STUBS), '-I', str(TICKER_SRC), '-o', str(exe),
+                        str(HARNESS), str(TICKER_SRC / 'TickerWheel.cpp')],
+                       capture_output=True, text=True, timeout=300)
+    return (exe if r.returncode == 0 else None), r.stdout + r.stderr
+
+
+def run_scenario(exe: Path, name: str) -> tuple[bool, str]:
+    try:
+        r = subprocess.run([str(exe), name], capture_output=True, text=True, timeout=RUN_TIMEOUT)
+    except subprocess.TimeoutExpired:
+        return False, f'no result after {RUN_TIMEOUT} s'
+    out = r.stdout.strip()
+    return r.returncode == 0 and out == f'ok {name}', out + r.stderr.strip()
+
+
+# ---------------------------------------------------------------------------
+# Tests
+# ---------------------------------------------------------------------------
+
+def test_scenarios():
+    section('TickerWheel scenarios (libraries/Ticker)')
+    with tempfile.TemporaryDirectory() as tmp:
+        exe, out = build_harness(Path(tmp))
+        if exe is None and out == 'no C++ compiler':
+            print('  SKIP  no C++ compiler found')
+            return
+        assert_test('harness builds', exe is not None, out)
+        if exe is None:
+            return
+        for number, name in enumerate(SCENARIOS, 1):
+            ok, out = run_scenario(exe, name)
+            assert_test(f'{number:02d}. {name}', ok, out)
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+if __name__ == '__main__':
+    print(f'Testing: {TICKER_SRC / "TickerWheel.cpp"}')
+
+    test_scenarios()
+
+    total = len(SCENARIOS)
+    print(f"\n{'=' * 60}")
+    if _failures:
+        print(f'\n{FAIL} {len(_failures)} assertion(s) failed:')
+        for f in _failures:
+            print(f'  - {f}')
+        print()
+        sys.exit(1)
+    else:
+        print(f'\n{PASS} All {total} test cases passed!')
+        sys.exit(0)
@@ -0,0 +1,382 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host harness for the timer wheel of libraries/Ticker, used by
+ * test_ticker_wheel.py. TickerWheel.cpp is built against the stubs in
+ * ticker_wheel_stubs/ and driven by a fake clock: the one-shot esp_timer
+ * fires exactly when it is due, plus an optional wakeup latency.
+ *
+ * Usage:
+ *   ticker_wheel_host [scenario]
+ *
+ * Prints "ok <scenario>" or "fail <scenario>: <detail>" for each scenario
+ * and exits 1 if one failed.
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "TickerWheel.h"
+
+#define RES TICKER_WHEEL_RESOLUTION_US
+
+// ---------------------------------------------------------------------------
+// Fake esp_timer and spinlock
+// ---------------------------------------------------------------------------
+
+int fake_critical_depth = 0;
+unsigned long fake_critical_taken = 0;
+
+static int64_t now_us = 1000 * RES;
+static int64_t armed_us = -1;
+static void (*timer_callback)(void *) = nullptr;
+static void *timer_arg = nullptr;
+static unsigned long timer_wakeups = 0;
+
+extern "C" int64_t esp_timer_get_time(void) {
+  return now_us;
+}
+
+extern "C" esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle) {
+  timer_callback = args->callback;
+  timer_arg = args->arg;
+  *handle = (esp_timer_handle_t)&timer_callback;
+  return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  armed_us = now_us + (int64_t)timeout_us;
+  return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  armed_us = -1;
+  return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  return ESP_OK;
+}
+
+static void fire_timer() {
+  armed_us = -1;
+  timer_wakeups++;
+  timer_callback(timer_arg);
+}
+
+// run the clock up to target, the timer fires <latency> us after it is due
+static void advance_to(int64_t target, std::mt19937_64 *rng = nullptr, unsigned max_latency_us = 0) {
+  while (armed_us >= 0 && armed_us <= target) {
+    int64_t at = std::max(now_us, armed_us);
+    if (rng && max_latency_us) {
+      at += (*rng)() % (max_latency_us + 1);
+    }
+    now_us = at;
+    fire_timer();
+  }
+  now_us = std::max(now_us, target);
+}
+
+// a stalled timer task: the clock moves on and the timer fires once, late
+static void stall_until(int64_t target) {
+  now_us = target;
+  if (armed_us >= 0 && armed_us <= target) {
+    fire_timer();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Recorded callbacks
+// ---------------------------------------------------------------------------
+
+struct Rec {
+  TickerWheel::Entry entry{};
+  int64_t next_due_us = 0;
+  uint64_t period_us = 0;
+  std::vector<int64_t> fired_us;
+  bool in_critical = false;
+
+  // a failed scenario must not leave entries of its stack in the wheel
+  ~Rec() {
+    TickerWheel::get(false)->remove(&entry);
+  }
+};
+
+struct Fire {
+  int64_t at_us;
+  int64_t due_tick;
+};
+
+static std::vector<Fire> fire_log;
+
+static void on_fire(void *arg) {
+  Rec *rec = static_cast<Rec *>(arg);
+  rec->in_critical |= fake_critical_depth != 0;
+  rec->fired_us.push_back(now_us);
+  fire_log.push_back({now_us, (rec->next_due_us + RES - 1) / RES});
+  rec->next_due_us += rec->period_us;
+}
+
+static void schedule(TickerWheel *wheel, Rec *rec, uint64_t delay_us, uint64_t period_us = 0) {
+  memset(&rec->entry, 0, sizeof(rec->entry));
+  rec->entry.callback = on_fire;
+  rec->entry.arg = rec;
+  rec->next_due_us = now_us + delay_us;
+  rec->period_us = period_us;
+  rec->fired_us.clear();
+  rec->in_critical = false;
+  wheel->add(&rec->entry, delay_us, period_us);
+}
+
+static int64_t tick_time(int64_t due_us) {
+  return (due_us + RES - 1) / RES * RES;
+}
+
+static std::string failure;
+
+static bool check(bool condition, const char *fmt, ...) {
+  if (!condition && failure.empty()) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    failure = buf;
+  }
+  return condition;
+}
+
+static bool due_order(const std::vector<Fire> &log) {
+  for (size_t i = 1; i < log.size(); i++) {
+    if (log[i].due_tick < log[i - 1].due_tick) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Scenarios
+// ---------------------------------------------------------------------------
+
+// one-shots on both sides of every level boundary and at random delays, each fires on its tick
+static void scenario_levels(TickerWheel *wheel) {
+  std::mt19937_64 rng(1);
+  std::vector<uint64_t> ticks = {0, 1, 62, 63, 64, 65, 127, 128, 4095, 4096, 4097, 8191, 262143, 262144, 262145, 524288, (1u << 24) - 2, (1u << 24) - 1};
+  for (int i = 0; i < 600; i++) {
+    ticks.push_back(rng() % (1u << 24));
+  }
+  std::vector<Rec> recs(ticks.size() * 2);
+  for (size_t i = 0; i < ticks.size(); i++) {
+    // on the tick and somewhere inside it, rounded up to the next one
+    schedule(wheel, &recs[i * 2], ticks[i] * RES);
+    schedule(wheel, &recs[i * 2 + 1], ticks[i] * RES + 1 + rng() % (RES - 1));
+  }
+  fire_log.clear();
+  timer_wakeups = 0;
+  int64_t end = now_us + (int64_t)(1u << 24) * RES + RES;
+  advance_to(end);
+
+  std::vector<int64_t> distinct;
+  for (Rec &rec : recs) {
+    int64_t expected = tick_time(rec.next_due_us);
+    check(rec.fired_us.size() == 1, "due at %" PRId64 " fired %zu times", expected, rec.fired_us.size());
+    check(rec.fired_us.empty() || rec.fired_us[0] == expected, "due at %" PRId64 " fired at %" PRId64, expected, rec.fired_us.empty() ? 0 : rec.fired_us[0]);
+    check(!rec.in_critical, "callback ran inside the critical section");
+    distinct.push_back(expected);
+  }
+  std::sort(distinct.begin(), distinct.end());
+  size_t slots = std::unique(distinct.begin(), distinct.end()) - distinct.begin();
+  check(due_order(fire_log), "callbacks out of due order");
+  // one wakeup per tick with callbacks, plus at most one cascade per entry and upper level
+  check(timer_wakeups <= slots + 3 * recs.size(), "%lu wakeups for %zu ticks", timer_wakeups, slots);
+  check(!wheel->scheduled(&recs[0].entry), "one-shot still scheduled");
+}
+
+// delays beyond the 2^24 ticks of the wheel are parked in the last level until they get close
+static void scenario_parking(TickerWheel *wheel) {
+  const uint64_t span = 1ull << 24;
+  std::vector<uint64_t> ticks = {span, span + 1, span + 63, 2 * span - 1, 3 * span + 777, 40 * span + 12345};
+  std::vector<Rec> recs(ticks.size());
+  for (size_t i = 0; i < ticks.size(); i++) {
+    schedule(wheel, &recs[i], ticks[i] * RES + RES / 2);
+  }
+  fire_log.clear();
+  timer_wakeups = 0;
+  advance_to(now_us + (int64_t)(41 * span) * RES);
+
+  for (Rec &rec : recs) {
+    int64_t expected = tick_time(rec.next_due_us);
+    check(rec.fired_us.size() == 1 && rec.fired_us[0] == expected, "parked entry due at %" PRId64 " fired %zu times, first at %" PRId64, expected,
+          rec.fired_us.size(), rec.fired_us.empty() ? 0 : rec.fired_us[0]);
+  }
+  check(due_order(fire_log), "parked callbacks out of due order");
+  // a few wakeups per 2^24 tick hop, not one per tick
+  check(timer_wakeups <= 41 * 8 + ticks.size() * 4, "%lu wakeups", timer_wakeups);
+}
+
+// periodic due times advance by the period from the previous due time, late wakeups do not add up
+static void scenario_drift(TickerWheel *wheel) {
+  std::mt19937_64 rng(2);
+  const uint64_t periods[] = {1000, 10007, 33333, 250001, 1000000};
+  const unsigned latency = RES * 9 / 10;
+  const int64_t duration = 600 * 1000000LL;
+  std::vector<Rec> recs(sizeof(periods) / sizeof(periods[0]));
+  int64_t start = now_us;
+  for (size_t i = 0; i < recs.size(); i++) {
+    schedule(wheel, &recs[i], periods[i], periods[i]);
+  }
+  fire_log.clear();
+  advance_to(start + duration, &rng, latency);
+
+  for (size_t i = 0; i < recs.size(); i++) {
+    Rec &rec = recs[i];
+    uint64_t expected_count = duration / periods[i];
+    check(rec.fired_us.size() >= expected_count - 1 && rec.fired_us.size() <= expected_count,
+          "period %" PRIu64 ": %zu callbacks, expected %" PRIu64, periods[i], rec.fired_us.size(), expected_count);
+    for (size_t k = 0; k < rec.fired_us.size(); k++) {
+      int64_t ideal = start + (int64_t)((k + 1) * periods[i]);
+      int64_t late = rec.fired_us[k] - ideal;
+      if (!check(late >= 0 && late < RES + latency, "period %" PRIu64 ": callback %zu is %" PRId64 " us off", periods[i], k, late)) {
+        break;
+      }
+    }
+    wheel->remove(&rec.entry);
+  }
+  check(due_order(fire_log), "periodic callbacks out of due order");
+  check(armed_us < 0, "timer still armed with nothing scheduled");
+}
+
+// after a stall, one wakeup runs every overdue callback in due order, one slot per lock
+static void scenario_catchup(TickerWheel *wheel) {
+  const uint64_t ticks[] = {3, 70, 5000, 300000, 5000000, (1u << 24) + 10, 3 * (1u << 24)};
+  const uint64_t period = 1000 * RES;
+  const uint64_t stall = 2 * (1ull << 24) * RES;
+  std::vector<Rec> recs(sizeof(ticks) / sizeof(ticks[0]));
+  int64_t start = now_us;
+  for (size_t i = 0; i < recs.size(); i++) {
+    schedule(wheel, &recs[i], ticks[i] * RES);
+  }
+  Rec periodic;
+  schedule(wheel, &periodic, period, period);
+
+  fire_log.clear();
+  timer_wakeups = 0;
+  unsigned long taken = fake_critical_taken;
+  stall_until(start + stall);
+  taken = fake_critical_taken - taken;
+
+  size_t callbacks = fire_log.size();
+  for (size_t i = 0; i < recs.size(); i++) {
+    Rec &rec = recs[i];
+    bool due = ticks[i] * RES <= stall;
+    check(rec.fired_us.size() == (due ? 1u : 0u), "entry due at tick %" PRIu64 " fired %zu times", ticks[i], rec.fired_us.size());
+  }
+  check(periodic.fired_us.size() == stall / period, "periodic caught up %zu times, expected %" PRIu64, periodic.fired_us.size(), stall / period);
+  check(timer_wakeups == 1, "%lu wakeups", timer_wakeups);
+  check(due_order(fire_log), "catch-up callbacks out of due order");
+  // the lock is taken again around each callback and once per visited slot, never per empty tick;
+  // a slot is visited to run callbacks or to cascade, at most once per entry and upper level
+  check(taken <= 1 + callbacks + 4 * (callbacks + recs.size()), "lock taken %lu times for %zu callbacks", taken, callbacks);
+
+  // the wheel is back in step: the last entry and a new one fire on their tick
+  Rec next;
+  schedule(wheel, &next, 5 * RES + 1);
+  int64_t next_expected = tick_time(next.next_due_us);
+  advance_to(start + (int64_t)(3 * (1u << 24) + 1) * RES);
+  check(next.fired_us.size() == 1 && next.fired_us[0] == next_expected, "entry added after the stall fired %zu times", next.fired_us.size());
+  Rec &last = recs.back();
+  check(last.fired_us.size() == 1 && last.fired_us[0] == tick_time(start + ticks[recs.size() - 1] * RES), "entry after the stall did not fire on its tick");
+  wheel->remove(&periodic.entry);
+}
+
+// a stall of 2^36 ticks must not be walked tick by tick
+static void scenario_long_stall(TickerWheel *wheel) {
+  Rec far, beyond;
+  int64_t start = now_us;
+  schedule(wheel, &far, (1ull << 35) * RES);
+  schedule(wheel, &beyond, (1ull << 37) * RES);
+  timer_wakeups = 0;
+  stall_until(start + (int64_t)(1ull << 36) * RES);
+  check(far.fired_us.size() == 1, "overdue entry fired %zu times", far.fired_us.size());
+  check(beyond.fired_us.empty(), "entry not yet due fired");
+  check(armed_us > now_us, "timer not re-armed for the remaining entry");
+
+  // the remaining entry is parked again and fires on its tick
+  advance_to(start + (int64_t)(1ull << 37) * RES + RES);
+  check(beyond.fired_us.size() == 1 && beyond.fired_us[0] == tick_time(start + (int64_t)(1ull << 37) * RES), "far entry did not fire on its tick");
+}
+
+// callbacks may reschedule themselves and cancel entries of the same tick
+static Rec *victim;
+static void reschedule_and_cancel(void *arg) {
+  Rec *rec = static_cast<Rec *>(arg);
+  on_fire(arg);
+  TickerWheel *wheel = TickerWheel::get(false);
+  wheel->remove(&victim->entry);
+  if (rec->fired_us.size() < 3) {
+    rec->next_due_us = now_us + 70 * RES;
+    wheel->add(&rec->entry, 70 * RES, 0);
+  }
+}
+
+static void scenario_reentrant(TickerWheel *wheel) {
+  Rec self, cancelled;
+  victim = &cancelled;
+  schedule(wheel, &self, 10 * RES);
+  self.entry.callback = reschedule_and_cancel;
+  wheel->add(&self.entry, 10 * RES, 0);
+  schedule(wheel, &cancelled, 10 * RES);
+  int64_t start = now_us;
+  advance_to(start + 1000 * RES);
+  check(self.fired_us.size() == 3, "rescheduling callback ran %zu times", self.fired_us.size());
+  check(self.fired_us.size() == 3 && self.fired_us[0] == tick_time(start + 10 * RES) && self.fired_us[2] == self.fired_us[0] + 140 * RES,
+        "rescheduled callback off its tick");
+  // both are due in the same tick; whichever runs first, the cancel comes from the first callback
+  check(cancelled.fired_us.size() <= 1, "cancelled entry fired %zu times", cancelled.fired_us.size());
+  check(!wheel->scheduled(&cancelled.entry) && !wheel->scheduled(&self.entry), "entries still scheduled");
+}
+
+struct Scenario {
+  const char *name;
+  void (*run)(TickerWheel *wheel);
+};
+
+static const Scenario scenarios[] = {
+  {"levels", scenario_levels},     {"parking", scenario_parking},       {"drift", scenario_drift},
+  {"catchup", scenario_catchup},   {"long_stall", scenario_long_stall}, {"reentrant", scenario_reentrant},
+};
+
+int main(int argc, char **argv) {
+  TickerWheel *wheel = TickerWheel::get(false);
+  if (wheel == nullptr) {
+    printf("fail setup: no wheel\n");
+    return 1;
+  }
+  int failed = 0;
+  for (const Scenario &scenario : scenarios) {
+    if (argc > 1 && strcmp(argv[1], scenario.name)) {
+      continue;
+    }
+    failure.clear();
+    scenario.run(wheel);
+    check(fake_critical_depth == 0, "critical section left open");
+    if (failure.empty()) {
+      printf("ok %s\n", scenario.name);
+    } else {
+      printf("fail %s: %s\n", scenario.name, failure.c_str());
+      failed++;
+    }
+    fflush(stdout);
+  }
+  return failed ? 1 : 0;
+}
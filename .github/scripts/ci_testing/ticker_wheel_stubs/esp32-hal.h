@@ -0,0 +1,12 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Host stub for ticker_wheel_host.cpp
+#pragma once
+#include <stdio.h>
+
+#define ARDUINO_ISR_ATTR
+#define log_e(...) fprintf(stderr, __VA_ARGS__)
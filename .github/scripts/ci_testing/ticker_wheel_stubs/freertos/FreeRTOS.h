@@ -0,0 +1,17 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Host stub for ticker_wheel_host.cpp: the spinlock only counts its nesting and how often it was taken
+#pragma once
+
+typedef int portMUX_TYPE;
+
+extern int fake_critical_depth;
+extern unsigned long fake_critical_taken;
+
+#define portMUX_INITIALIZE(mux)      (*(mux) = 0)
+#define portENTER_CRITICAL_SAFE(mux) (fake_critical_depth++, fake_critical_taken++)
+#define portEXIT_CRITICAL_SAFE(mux)  (fake_critical_depth--)
@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host harness for the package decoders of libraries/Update, used by
+ * test_ota_package.py. Decodes a package the same way UpdateClass does and
+ * writes the resulting image.
+ *
+ * Usage:
+ *   upkg_decode <package> <image out> [base image] [chunk size]
+ *
+ * Prints "ok <bytes>" and exits 0, or prints "error <package_error_t>" and
+ * exits 1. A bad header is reported as "error header".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Updater_Package.h"
+
+static bool readFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <package> <image out> [base image] [chunk size]\n", argv[0]);
+    return 2;
+  }
+  std::vector<uint8_t> package, base;
+  if (!readFile(argv[1], package) || (argc > 3 && strcmp(argv[3], "-") && !readFile(argv[3], base))) {
+    fprintf(stderr, "cannot read input\n");
+    return 2;
+  }
+  size_t chunk = argc > 4 ? strtoul(argv[4], NULL, 0) : 4096;
+  if (!chunk) {
+    chunk = 1;
+  }
+
+  UpdaterPackageHeader header;
+  if (package.size() < UPDATE_PACKAGE_HEADER_SIZE || !UpdaterPackageHeader::isPackage(package.data(), package.size()) || !header.parse(package.data())) {
+    printf("error header\n");
+    return 1;
+  }
+
+  std::vector<uint8_t> image;
+  UpdaterPackage decoder(
+    header,
+    [&image](const uint8_t *data, size_t len) {
+      image.insert(image.end(), data, data + len);
+      return true;
+    },
+    [&base](size_t offset, uint8_t *data, size_t len) {
+      if (offset + len > base.size()) {
+        return false;
+      }
+      memcpy(data, base.data() + offset, len);
+      return true;
+    }
+  );
+
+  // fed in chunks like the flash sector sized writes of UpdateClass
+  bool ok = decoder.begin();
+  for (size_t pos = UPDATE_PACKAGE_HEADER_SIZE; ok && pos < package.size(); pos += chunk) {
+    size_t len = package.size() - pos < chunk ? package.size() - pos : chunk;
+    ok = decoder.write(package.data() + pos, len);
+  }
+  ok = ok && decoder.end();
+  if (!ok) {
+    printf("error %d\n", (int)decoder.error());
+    return 1;
+  }
+
+  FILE *f = fopen(argv[2], "wb");
+  if (!f || fwrite(image.data(), 1, image.size(), f) != image.size()) {
+    fprintf(stderr, "cannot write %s\n", argv[2]);
+    return 2;
+  }
+  fclose(f);
+  printf("ok %u\n", (unsigned)image.size());
+  return 0;
+}
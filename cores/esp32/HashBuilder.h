@@ -58,6 +58,23 @@ public:
   virtual void getChars(char *output) = 0;
   virtual String toString() = 0;
   virtual size_t getHashSize() const = 0;
+
+  // Block level access, lets HMAC based code reuse the state after the key block (midstate).
+  // Builders without support keep these defaults.
+
+  // Input block size in bytes, 0 if unknown
+  virtual size_t getBlockSize() const {
+    return 0;
+  }
+  // New builder continuing from the current state (delete it when done), nullptr if not supported
+  virtual HashBuilder *clone() const {
+    return nullptr;
+  }
+  // Continue from the state of other, which must be the same kind of builder, e.g. made by clone()
+  virtual bool copyStateFrom(const HashBuilder &other) {
+    (void)other;
+    return false;
+  }
 };
 
 #endif
@@ -23,12 +23,87 @@
  */
 
 #include "Arduino.h"
-extern "C" {
-#include "libb64/cdecode.h"
-#include "libb64/cencode.h"
-}
 #include "base64.h"
 
+static const char base64_standard[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char base64_url_safe[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Character values of both alphabets; anything else has one of the two upper bits set,
+// so four characters are checked with a single test
+#define BASE64_INVALID 0xFF
+#define BASE64_PAD     0x40
+#define BASE64_SKIP    0x80  // whitespace
+
+#define XX BASE64_INVALID
+#define PD BASE64_PAD
+#define SP BASE64_SKIP
+
+static const uint8_t base64_decoding[256] = {
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, SP, SP, XX, XX, SP, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  SP, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, 62, XX, 62, XX, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, XX, XX, XX, PD, XX, XX,
+  XX, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, XX, XX, XX, XX, 63,
+  XX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+  XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+};
+
+#undef XX
+#undef PD
+#undef SP
+
+static inline const char *base64_table(base64::alphabet_t alphabet) {
+  return (alphabet == base64::URL_SAFE) ? base64_url_safe : base64_standard;
+}
+
+// 3 bytes -> 4 characters, count groups
+static inline void base64_encode_groups(const uint8_t *in, size_t count, char *out, const char *table) {
+  while (count--) {
+    uint32_t v = ((uint32_t)in[0] << 16) | ((uint32_t)in[1] << 8) | in[2];
+    out[0] = table[v >> 18];
+    out[1] = table[(v >> 12) & 0x3F];
+    out[2] = table[(v >> 6) & 0x3F];
+    out[3] = table[v & 0x3F];
+    in += 3;
+    out += 4;
+  }
+}
+
+// the last 1 or 2 bytes, returns the number of characters
+static inline size_t base64_encode_tail(const uint8_t *in, size_t len, char *out, const char *table, bool padding) {
+  if (len == 0) {
+    return 0;
+  }
+  uint32_t v = (uint32_t)in[0] << 16;
+  if (len > 1) {
+    v |= (uint32_t)in[1] << 8;
+  }
+  out[0] = table[v >> 18];
+  out[1] = table[(v >> 12) & 0x3F];
+  if (len > 1) {
+    out[2] = table[(v >> 6) & 0x3F];
+  } else if (padding) {
+    out[2] = '=';
+  }
+  if (padding) {
+    out[3] = '=';
+    return 4;
+  }
+  return len + 1;
+}
+
+size_t base64::encodedLength(size_t length, bool padding) {
+  if (padding) {
+    return (length + 2) / 3 * 4;
+  }
+  return length / 3 * 4 + ((length % 3) ? (length % 3) + 1 : 0);
+}
+
+size_t base64::decodedLength(size_t length) {
+  return length / 4 * 3 + ((length % 4) > 1 ? (length % 4) - 1 : 0);
+}
+
 /**
  * convert input data to base64
  * @param data const uint8_t *
@@ -36,19 +111,7 @@ extern "C" {
  * @return String
  */
 String base64::encode(const uint8_t *data, size_t length) {
-  size_t size = base64_encode_expected_len(length) + 1;
-  char *buffer = (char *)malloc(size);
-  if (buffer) {
-    base64_encodestate _state;
-    base64_init_encodestate(&_state);
-    int len = base64_encode_block((const char *)&data[0], length, &buffer[0], &_state);
-    len = base64_encode_blockend((buffer + len), &_state);
-
-    String base64 = String(buffer);
-    free(buffer);
-    return base64;
-  }
-  return String("-FAIL-");
+  return base64::encode(data, length, STANDARD, true);
 }
 
 /**
@@ -59,3 +122,288 @@ String base64::encode(const uint8_t *data, size_t length) {
 String base64::encode(const String &text) {
   return base64::encode((uint8_t *)text.c_str(), text.length());
 }
+
+/**
+ * convert input data to base64 with the given alphabet
+ * @param data const uint8_t *
+ * @param length size_t
+ * @param alphabet alphabet_t
+ * @param padding bool
+ * @return String
+ */
+String base64::encode(const uint8_t *data, size_t length, alphabet_t alphabet, bool padding) {
+  String result;
+  if (!result.reserve(encodedLength(length, padding))) {
+    return String("-FAIL-");
+  }
+  // whole groups per chunk, so only the last one can have a tail
+  const size_t step = (BASE64_CHUNK_SIZE / 4) * 3;
+  char chunk[BASE64_CHUNK_SIZE + 1];
+  while (length) {
+    size_t n = (length > step) ? step : length;
+    size_t len = encode(data, n, chunk, sizeof(chunk), alphabet, padding);
+    result.concat(chunk, len);
+    data += n;
+    length -= n;
+  }
+  return result;
+}
+
+/**
+ * convert input data to base64 with the given alphabet
+ * @param text const String&
+ * @param alphabet alphabet_t
+ * @param padding bool
+ * @return String
+ */
+String base64::encode(const String &text, alphabet_t alphabet, bool padding) {
+  return base64::encode((uint8_t *)text.c_str(), text.length(), alphabet, padding);
+}
+
+size_t base64::encode(const uint8_t *data, size_t length, char *out, size_t size, alphabet_t alphabet, bool padding) {
+  size_t len = encodedLength(length, padding);
+  if (out == nullptr || len >= size) {
+    return 0;
+  }
+  const char *table = base64_table(alphabet);
+  size_t groups = length / 3;
+  base64_encode_groups(data, groups, out, table);
+  base64_encode_tail(data + groups * 3, length % 3, out + groups * 4, table, padding);
+  out[len] = '\0';
+  return len;
+}
+
+size_t base64::encode(const uint8_t *data, size_t length, Print &out, alphabet_t alphabet, bool padding) {
+  base64Encoder encoder(out, alphabet, padding);
+  encoder.write(data, length);
+  return encoder.end();
+}
+
+int base64::decode(const char *data, size_t length, uint8_t *out, size_t size) {
+  base64Decoder decoder(out, size);
+  decoder.write((const uint8_t *)data, length);
+  size_t len = decoder.end();
+  if (decoder.hasError()) {
+    return -1;
+  }
+  return (int)len;
+}
+
+int base64::decode(const String &text, uint8_t *out, size_t size) {
+  return base64::decode(text.c_str(), text.length(), out, size);
+}
+
+/* base64Output */
+
+bool base64Output::emit(const uint8_t *data, size_t len) {
+  if (_error) {
+    return false;
+  }
+  if (_out) {
+    if (_out->write(data, len) != len) {
+      _error = true;
+      return false;
+    }
+  } else if (_buf && len <= _size - _len) {
+    memcpy(_buf + _len, data, len);
+  } else {
+    _error = true;
+    return false;
+  }
+  _len += len;
+  return true;
+}
+
+/* base64Encoder */
+
+base64Encoder::base64Encoder(Print &out, base64::alphabet_t alphabet, bool padding)
+  : base64Output(out), _table(base64_table(alphabet)), _padding(padding), _pending(0) {}
+
+base64Encoder::base64Encoder(char *buffer, size_t size, base64::alphabet_t alphabet, bool padding)
+  : base64Output((uint8_t *)buffer, size ? size - 1 : 0), _table(base64_table(alphabet)), _padding(padding), _pending(0) {
+  if (size == 0) {
+    _buf = nullptr;
+  }
+}
+
+size_t base64Encoder::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t base64Encoder::write(const uint8_t *data, size_t len) {
+  if (_error) {
+    return 0;
+  }
+  size_t written = len;
+  char chunk[BASE64_CHUNK_SIZE];
+  size_t pos = 0;
+
+  // complete the group left over from the previous write
+  if (_pending) {
+    while (_pending < 3 && len) {
+      _tail[_pending++] = *data++;
+      len--;
+    }
+    if (_pending < 3) {
+      return written;
+    }
+    base64_encode_groups(_tail, 1, chunk, _table);
+    pos = 4;
+    _pending = 0;
+  }
+
+  while (len >= 3) {
+    size_t groups = len / 3;
+    size_t room = (sizeof(chunk) - pos) / 4;
+    if (groups > room) {
+      groups = room;
+    }
+    base64_encode_groups(data, groups, chunk + pos, _table);
+    pos += groups * 4;
+    data += groups * 3;
+    len -= groups * 3;
+    if (pos == sizeof(chunk)) {
+      if (!emit((const uint8_t *)chunk, pos)) {
+        return 0;
+      }
+      pos = 0;
+    }
+  }
+  if (pos && !emit((const uint8_t *)chunk, pos)) {
+    return 0;
+  }
+
+  memcpy(_tail, data, len);
+  _pending = len;
+  return written;
+}
+
+size_t base64Encoder::end() {
+  char chunk[4];
+  size_t n = base64_encode_tail(_tail, _pending, chunk, _table, _padding);
+  _pending = 0;
+  if (n) {
+    emit((const uint8_t *)chunk, n);
+  }
+  if (_buf) {
+    _buf[_len] = '\0';
+  }
+  return _error ? 0 : _len;
+}
+
+/* base64Decoder */
+
+base64Decoder::base64Decoder(Print &out) : base64Output(out), _bits(0), _count(0), _pad(0) {}
+
+base64Decoder::base64Decoder(uint8_t *buffer, size_t size) : base64Output(buffer, size), _bits(0), _count(0), _pad(0) {}
+
+size_t base64Decoder::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t base64Decoder::write(const uint8_t *data, size_t len) {
+  if (_error) {
+    return 0;
+  }
+  const uint8_t *end = data + len;
+  uint8_t chunk[BASE64_CHUNK_SIZE];
+  size_t pos = 0;
+
+  while (data < end) {
+    if (pos + 3 > sizeof(chunk)) {
+      if (!emit(chunk, pos)) {
+        return 0;
+      }
+      pos = 0;
+    }
+
+    // fast path: whole groups of 4 alphabet characters
+    if (_count == 0 && _pad == 0) {
+      while (end - data >= 4 && pos + 3 <= sizeof(chunk)) {
+        uint8_t a = base64_decoding[data[0]];
+        uint8_t b = base64_decoding[data[1]];
+        uint8_t c = base64_decoding[data[2]];
+        uint8_t d = base64_decoding[data[3]];
+        if ((a | b | c | d) & 0xC0) {
+          break;
+        }
+        uint32_t v = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | d;
+        chunk[pos] = v >> 16;
+        chunk[pos + 1] = v >> 8;
+        chunk[pos + 2] = v;
+        pos += 3;
+        data += 4;
+      }
+      if (data == end || pos + 3 > sizeof(chunk)) {
+        continue;
+      }
+    }
+
+    // one character at a time: whitespace, padding and groups split across writes
+    uint8_t v = base64_decoding[*data++];
+    if (v < 64) {
+      if (_pad) {
+        log_d("base64 data after padding");
+        _error = true;
+        return 0;
+      }
+      _bits = (_bits << 6) | v;
+      if (++_count == 4) {
+        chunk[pos] = _bits >> 16;
+        chunk[pos + 1] = _bits >> 8;
+        chunk[pos + 2] = _bits;
+        pos += 3;
+        _bits = 0;
+        _count = 0;
+      }
+    } else if (v == BASE64_PAD) {
+      if (_count < 2 || _count + _pad >= 4) {
+        log_d("base64 padding at invalid position");
+        _error = true;
+        return 0;
+      }
+      if (_pad++ == 0) {
+        // the partial group is complete once padding starts
+        chunk[pos++] = _bits >> ((_count == 2) ? 4 : 10);
+        if (_count == 3) {
+          chunk[pos++] = _bits >> 2;
+        }
+      }
+    } else if (v != BASE64_SKIP) {
+      log_d("invalid base64 character 0x%02x", data[-1]);
+      _error = true;
+      return 0;
+    }
+  }
+
+  if (pos && !emit(chunk, pos)) {
+    return 0;
+  }
+  return len;
+}
+
+size_t base64Decoder::end() {
+  uint8_t chunk[2];
+  size_t n = 0;
+  if (_pad) {
+    if (_count + _pad != 4) {
+      log_d("base64 padding incomplete");
+      _error = true;
+    }
+  } else if (_count == 1) {
+    log_d("base64 data truncated");
+    _error = true;
+  } else if (_count > 1) {
+    chunk[n++] = _bits >> ((_count == 2) ? 4 : 10);
+    if (_count == 3) {
+      chunk[n++] = _bits >> 2;
+    }
+  }
+  if (n && !_error) {
+    emit(chunk, n);
+  }
+  _bits = 0;
+  _count = 0;
+  _pad = 0;
+  return _error ? 0 : _len;
+}
@@ -1,12 +1,134 @@
 #ifndef CORE_BASE64_H_
 #define CORE_BASE64_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+#include "Print.h"
+
+// Size of the stack buffer the streaming coders collect output in before passing it on,
+// multiple of 12 so it holds whole groups of both the encoded and the decoded side
+#ifndef BASE64_CHUNK_SIZE
+#define BASE64_CHUNK_SIZE 120
+#endif
+
 class base64 {
 public:
+  typedef enum {
+    STANDARD,  // RFC 4648 section 4, '+' and '/'
+    URL_SAFE   // RFC 4648 section 5, '-' and '_', usually without padding
+  } alphabet_t;
+
   static String encode(const uint8_t *data, size_t length);
   static String encode(const String &text);
+  static String encode(const uint8_t *data, size_t length, alphabet_t alphabet, bool padding = true);
+  static String encode(const String &text, alphabet_t alphabet, bool padding = true);
+
+  /**
+   * encode into a buffer and terminate it with \0
+   * @return number of characters written, 0 if size is too small
+   */
+  static size_t encode(const uint8_t *data, size_t length, char *out, size_t size, alphabet_t alphabet = STANDARD, bool padding = true);
+  /**
+   * encode to out in chunks without building the whole result in memory
+   * @return number of characters written, 0 on a write error
+   */
+  static size_t encode(const uint8_t *data, size_t length, Print &out, alphabet_t alphabet = STANDARD, bool padding = true);
+
+  /**
+   * decode either alphabet, with or without padding; whitespace is skipped
+   * @return number of bytes written, -1 for invalid input or if size is too small
+   */
+  static int decode(const char *data, size_t length, uint8_t *out, size_t size);
+  static int decode(const String &text, uint8_t *out, size_t size);
+
+  /// number of characters encoding length bytes produces (without the \0)
+  static size_t encodedLength(size_t length, bool padding = true);
+  /// upper bound of the bytes decoding length characters produces
+  static size_t decodedLength(size_t length);
+};
+
+// Common output handling of base64Encoder and base64Decoder: results go either to a Print
+// or into a fixed buffer, nothing is allocated
+class base64Output : public Print {
+public:
+  using Print::write;
+
+  /// number of characters (encoder) or bytes (decoder) produced so far
+  size_t length() const {
+    return _len;
+  }
+  /// set after invalid input, a full buffer or a failed write to the Print
+  bool hasError() const {
+    return _error;
+  }
+
+protected:
+  base64Output(Print &out) : _out(&out), _buf(nullptr), _size(0), _len(0), _error(false) {}
+  base64Output(uint8_t *buffer, size_t size) : _out(nullptr), _buf(buffer), _size(size), _len(0), _error(false) {}
+
+  bool emit(const uint8_t *data, size_t len);
+
+  Print *_out;
+  uint8_t *_buf;
+  size_t _size;
+  size_t _len;
+  bool _error;
+};
+
+/**
+ * Streaming encoder: bytes written or printed to it are encoded and passed on in chunks, e.g.
+ *
+ *   base64Encoder enc(client);
+ *   enc.write(blob, blobLen);
+ *   enc.end();
+ */
+class base64Encoder : public base64Output {
+public:
+  base64Encoder(Print &out, base64::alphabet_t alphabet = base64::STANDARD, bool padding = true);
+  /// the buffer is \0 terminated by end(), so it holds size - 1 characters
+  base64Encoder(char *buffer, size_t size, base64::alphabet_t alphabet = base64::STANDARD, bool padding = true);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t len) override;
+  using base64Output::write;
+
+  /**
+   * encode the remaining bytes with padding and finish the current stream
+   * @return total number of characters, 0 if an error occurred
+   */
+  size_t end();
+
+private:
+  const char *_table;
+  bool _padding;
+  uint8_t _pending;
+  uint8_t _tail[3];
+};
+
+/**
+ * Streaming decoder: base64 text written or printed to it is decoded and passed on in chunks.
+ * Accepts both alphabets, optional padding and whitespace between characters.
+ */
+class base64Decoder : public base64Output {
+public:
+  base64Decoder(Print &out);
+  base64Decoder(uint8_t *buffer, size_t size);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t len) override;
+  using base64Output::write;
+
+  /**
+   * check the end of the input and pass on the last bytes
+   * @return total number of bytes, 0 if an error occurred
+   */
+  size_t end();
 
 private:
+  uint32_t _bits;
+  uint8_t _count;
+  uint8_t _pad;
 };
 
 #endif /* CORE_BASE64_H_ */
@@ -16,6 +16,8 @@
 #include "esp32-hal-periman.h"
 #include "hal/gpio_hal.h"
 #include "soc/soc_caps.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
 
 // RGB_BUILTIN is defined in pins_arduino.h
 // If RGB_BUILTIN is defined, it will be used as a pin number for the RGB LED
@@ -95,6 +97,7 @@ typedef struct {
   voidFuncPtr fn;
   void *arg;
   bool functional;
+  bool deferred;  // fn is a gpio_event_handler_t called by the event task
 } InterruptHandle_t;
 static InterruptHandle_t __pinInterruptHandlers[SOC_GPIO_PIN_COUNT] = {
   0,
@@ -199,6 +202,51 @@ extern int ARDUINO_ISR_ATTR __digitalRead(uint8_t pin) {
   return gpio_get_level((gpio_num_t)pin);
 }
 
+bool fastPortInit(fast_gpio_t *port, const uint8_t *pins, size_t count) {
+  if (port == NULL || pins == NULL || count == 0) {
+    log_e("Invalid fast GPIO arguments");
+    return false;
+  }
+  uint32_t mask = 0;
+  uint8_t bank = pins[0] / 32;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t pin = pins[i];
+    if (pin >= SOC_GPIO_PIN_COUNT) {
+      log_e("Invalid IO %u selected", pin);
+      return false;
+    }
+    if (perimanGetPinBus(pin, ESP32_BUS_TYPE_GPIO) == NULL) {
+      log_e("IO %u is not set as GPIO. Execute pinMode(%u, mode) first.", pin, pin);
+      return false;
+    }
+    if (pin / 32 != bank) {
+      log_e("IO %u is not in the same bank of 32 GPIOs as IO %u", pin, pins[0]);
+      return false;
+    }
+    mask |= 1UL << (pin % 32);
+  }
+#if SOC_GPIO_PIN_COUNT > 32
+  if (bank) {
+    port->set_reg = (volatile uint32_t *)GPIO_OUT1_W1TS_REG;
+    port->clear_reg = (volatile uint32_t *)GPIO_OUT1_W1TC_REG;
+    port->out_reg = (volatile uint32_t *)GPIO_OUT1_REG;
+    port->in_reg = (volatile uint32_t *)GPIO_IN1_REG;
+  } else
+#endif
+  {
+    port->set_reg = (volatile uint32_t *)GPIO_OUT_W1TS_REG;
+    port->clear_reg = (volatile uint32_t *)GPIO_OUT_W1TC_REG;
+    port->out_reg = (volatile uint32_t *)GPIO_OUT_REG;
+    port->in_reg = (volatile uint32_t *)GPIO_IN_REG;
+  }
+  port->mask = mask;
+  return true;
+}
+
+bool fastPinInit(fast_gpio_t *fp, uint8_t pin) {
+  return fastPortInit(fp, &pin, 1);
+}
+
 static void ARDUINO_ISR_ATTR __onPinInterrupt(void *arg) {
   InterruptHandle_t *isr = (InterruptHandle_t *)arg;
   if (isr->fn) {
@@ -212,36 +260,41 @@ static void ARDUINO_ISR_ATTR __onPinInterrupt(void *arg) {
 
 extern void cleanupFunctional(void *arg);
 
-extern void __attachInterruptFunctionalArg(uint8_t pin, voidFuncPtrArg userFunc, void *arg, int intr_type, bool functional) {
-  static bool interrupt_initialized = false;
+// core the GPIO interrupt is allocated on, the one that installed the ISR service
+static BaseType_t __gpioIsrCore = 0;
 
-  // makes sure that pin -1 (255) will never work -- this follows Arduino standard
-  if (pin >= SOC_GPIO_PIN_COUNT) {
-    return;
-  }
+static bool __startIsrService(uint8_t pin) {
+  static bool interrupt_initialized = false;
 
   if (!interrupt_initialized) {
+    BaseType_t core = xPortGetCoreID();
     esp_err_t err = gpio_install_isr_service((int)ARDUINO_ISR_FLAG);
     interrupt_initialized = (err == ESP_OK) || (err == ESP_ERR_INVALID_STATE);
+    if (err == ESP_OK) {
+      __gpioIsrCore = core;
+    }
   }
   if (!interrupt_initialized) {
     log_e("IO %u ISR Service Failed To Start", pin);
-    return;
   }
+  return interrupt_initialized;
+}
 
+static void __setPinInterrupt(uint8_t pin, voidFuncPtr fn, void *arg, bool functional, bool deferred, gpio_isr_t isr, int intr_type) {
   // if new attach without detach remove old info
   if (__pinInterruptHandlers[pin].functional && __pinInterruptHandlers[pin].arg) {
     cleanupFunctional(__pinInterruptHandlers[pin].arg);
   }
-  __pinInterruptHandlers[pin].fn = (voidFuncPtr)userFunc;
+  __pinInterruptHandlers[pin].fn = fn;
   __pinInterruptHandlers[pin].arg = arg;
   __pinInterruptHandlers[pin].functional = functional;
+  __pinInterruptHandlers[pin].deferred = deferred;
 
   gpio_set_intr_type((gpio_num_t)pin, (gpio_int_type_t)(intr_type & 0x7));
   if (intr_type & 0x8) {
     gpio_wakeup_enable((gpio_num_t)pin, (gpio_int_type_t)(intr_type & 0x7));
   }
-  gpio_isr_handler_add((gpio_num_t)pin, __onPinInterrupt, &__pinInterruptHandlers[pin]);
+  gpio_isr_handler_add((gpio_num_t)pin, isr, &__pinInterruptHandlers[pin]);
 
   //FIX interrupts on peripherals outputs (eg. LEDC,...)
   //Enable input in GPIO register
@@ -250,6 +303,133 @@ extern void __attachInterruptFunctionalArg(uint8_t pin, voidFuncPtrArg userFunc,
   gpio_hal_input_enable(&gpiohal, pin);
 }
 
+extern void __attachInterruptFunctionalArg(uint8_t pin, voidFuncPtrArg userFunc, void *arg, int intr_type, bool functional) {
+  // makes sure that pin -1 (255) will never work -- this follows Arduino standard
+  if (pin >= SOC_GPIO_PIN_COUNT) {
+    return;
+  }
+  if (!__startIsrService(pin)) {
+    return;
+  }
+  __setPinInterrupt(pin, (voidFuncPtr)userFunc, arg, functional, false, __onPinInterrupt, intr_type);
+}
+
+/*
+ * Deferred interrupts: the ISR only records (pin, level, cycle count) into a ring per core,
+ * the event task drains the rings and calls the handlers. Each ring has one producer, the GPIO
+ * ISR on its core, and one consumer, the event task, so no lock is needed.
+ */
+typedef struct {
+  gpio_event_t *events;
+  volatile uint32_t head;  // next slot the ISR writes
+  volatile uint32_t tail;  // next slot the event task reads
+  volatile uint32_t overruns;
+} gpio_event_ring_t;
+
+_Static_assert((GPIO_EVENT_QUEUE_LENGTH & (GPIO_EVENT_QUEUE_LENGTH - 1)) == 0, "GPIO_EVENT_QUEUE_LENGTH must be a power of 2");
+
+static gpio_event_ring_t __gpioEventRings[portNUM_PROCESSORS];
+static TaskHandle_t __gpioEventTaskHandle = NULL;
+
+static void ARDUINO_ISR_ATTR __onPinInterruptDeferred(void *arg) {
+  uint32_t cycles = esp_cpu_get_cycle_count();
+  InterruptHandle_t *isr = (InterruptHandle_t *)arg;
+  uint8_t pin = (uint8_t)(isr - __pinInterruptHandlers);
+  gpio_event_ring_t *ring = &__gpioEventRings[xPortGetCoreID()];
+
+  uint32_t head = ring->head;
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (head - tail >= GPIO_EVENT_QUEUE_LENGTH) {
+    ring->overruns++;
+    return;
+  }
+  gpio_event_t *event = &ring->events[head % GPIO_EVENT_QUEUE_LENGTH];
+  event->cycles = cycles;
+  event->pin = pin;
+  event->level = gpio_ll_get_level(GPIO_LL_GET_HW(GPIO_PORT_0), pin);
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+  // notified for every event: the task may be about to sleep after reading the old head
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(__gpioEventTaskHandle, &woken);
+  if (woken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+static void __gpioEventTask(void *arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    bool busy;
+    do {
+      busy = false;
+      for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        gpio_event_ring_t *ring = &__gpioEventRings[core];
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint32_t tail = ring->tail;
+        while (tail != head) {
+          gpio_event_t event = ring->events[tail % GPIO_EVENT_QUEUE_LENGTH];
+          __atomic_store_n(&ring->tail, ++tail, __ATOMIC_RELEASE);
+          InterruptHandle_t *handle = &__pinInterruptHandlers[event.pin];
+          gpio_event_handler_t handler = (gpio_event_handler_t)handle->fn;
+          // events still queued when the pin was detached are dropped
+          if (handle->deferred && handler) {
+            handler(&event, handle->arg);
+          }
+          busy = true;
+        }
+      }
+    } while (busy);
+  }
+}
+
+static bool __startGpioEvents(void) {
+  if (__gpioEventTaskHandle != NULL) {
+    return true;
+  }
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    if (__gpioEventRings[core].events == NULL) {
+      // written from the ISR
+      __gpioEventRings[core].events =
+        (gpio_event_t *)heap_caps_malloc(GPIO_EVENT_QUEUE_LENGTH * sizeof(gpio_event_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+      if (__gpioEventRings[core].events == NULL) {
+        log_e("GPIO event ring allocation failed");
+        return false;
+      }
+    }
+  }
+  // runs on the core of the GPIO interrupt, so it never drains a ring while the ISR fills it
+  if (xTaskCreateUniversal(__gpioEventTask, "gpio_events", GPIO_EVENT_TASK_STACK_SIZE, NULL, GPIO_EVENT_TASK_PRIORITY, &__gpioEventTaskHandle, __gpioIsrCore)
+      != pdPASS) {
+    log_e("GPIO event task creation failed");
+    __gpioEventTaskHandle = NULL;
+    return false;
+  }
+  return true;
+}
+
+extern void attachInterruptDeferred(uint8_t pin, gpio_event_handler_t handler, void *arg, int mode) {
+  if (pin >= SOC_GPIO_PIN_COUNT) {
+    return;
+  }
+  if (!__startIsrService(pin) || !__startGpioEvents()) {
+    return;
+  }
+  __setPinInterrupt(pin, (voidFuncPtr)handler, arg, false, true, __onPinInterruptDeferred, mode);
+}
+
+extern uint32_t gpioGetEventOverruns(bool reset) {
+  uint32_t overruns = 0;
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    if (reset) {
+      overruns += __atomic_exchange_n(&__gpioEventRings[core].overruns, 0, __ATOMIC_RELAXED);
+    } else {
+      overruns += __gpioEventRings[core].overruns;
+    }
+  }
+  return overruns;
+}
+
 extern void __attachInterruptArg(uint8_t pin, voidFuncPtrArg userFunc, void *arg, int intr_type) {
   __attachInterruptFunctionalArg(pin, userFunc, arg, intr_type, false);
 }
@@ -268,6 +448,7 @@ extern void __detachInterrupt(uint8_t pin) {
   __pinInterruptHandlers[pin].fn = NULL;
   __pinInterruptHandlers[pin].arg = NULL;
   __pinInterruptHandlers[pin].functional = false;
+  __pinInterruptHandlers[pin].deferred = false;
 
   gpio_set_intr_type((gpio_num_t)pin, GPIO_INTR_DISABLE);
 }
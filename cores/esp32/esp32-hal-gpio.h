@@ -28,6 +28,7 @@ extern "C" {
 #include "esp32-hal.h"
 #include "soc/soc_caps.h"
 #include "driver/gpio.h"
+#include "soc/gpio_reg.h"
 
 #if (CONFIG_IDF_TARGET_ESP32S2 || CONFIG_IDF_TARGET_ESP32S3)
 #define NUM_OUPUT_PINS 46
@@ -78,9 +79,98 @@ int digitalRead(uint8_t pin);
 void attachInterrupt(uint8_t pin, void (*)(void), int mode);
 void attachInterruptArg(uint8_t pin, void (*)(void *), void *arg, int mode);
 void detachInterrupt(uint8_t pin);
+
+/*
+ * Deferred interrupts
+ *
+ * attachInterruptDeferred() keeps the ISR short and constant: it only records the pin, its level
+ * and the CPU cycle count into a lock-free ring, and a task calls the handlers with the events in
+ * the order they were recorded. Events recorded on different cores have their own ring and
+ * cycle counter. When a ring is full, new events are dropped and counted.
+ */
+// Events each core can hold until the event task handles them, a power of 2
+#ifndef GPIO_EVENT_QUEUE_LENGTH
+#define GPIO_EVENT_QUEUE_LENGTH 256
+#endif
+#ifndef GPIO_EVENT_TASK_STACK_SIZE
+#define GPIO_EVENT_TASK_STACK_SIZE 4096
+#endif
+#ifndef GPIO_EVENT_TASK_PRIORITY
+#define GPIO_EVENT_TASK_PRIORITY (configMAX_PRIORITIES - 2)
+#endif
+
+typedef struct {
+  uint32_t cycles;  // esp_cpu_get_cycle_count() when the ISR ran, wraps around
+  uint8_t pin;
+  uint8_t level;    // pin level read by the ISR, may already differ from the edge for fast pulses
+} gpio_event_t;
+
+typedef void (*gpio_event_handler_t)(const gpio_event_t *event, void *arg);
+
+// detachInterrupt() removes it; events still queued for the pin are dropped
+void attachInterruptDeferred(uint8_t pin, gpio_event_handler_t handler, void *arg, int mode);
+// number of events dropped because a ring was full
+uint32_t gpioGetEventOverruns(bool reset);
 void enableInterrupt(uint8_t pin);
 void disableInterrupt(uint8_t pin);
 
+/*
+ * Fast GPIO access for bit-banged protocols
+ *
+ * digitalWrite() and digitalRead() validate the pin on every call. A fast_gpio_t is validated once by
+ * fastPinInit() or fastPortInit() and then accesses the GPIO registers directly, with no checks.
+ * All pins of a port must be in the same bank of 32 GPIOs; bit n of a port value is GPIO (bank * 32 + n).
+ * The pins must have been set up with pinMode() before.
+ */
+typedef struct {
+  volatile uint32_t *set_reg;    // write 1 to set
+  volatile uint32_t *clear_reg;  // write 1 to clear
+  volatile uint32_t *out_reg;    // output latch
+  volatile uint32_t *in_reg;     // pad levels
+  uint32_t mask;                 // pins of the handle in its bank
+} fast_gpio_t;
+
+bool fastPinInit(fast_gpio_t *fp, uint8_t pin);
+bool fastPortInit(fast_gpio_t *port, const uint8_t *pins, size_t count);
+
+static inline __attribute__((always_inline)) void fastPinSet(const fast_gpio_t *fp) {
+  *fp->set_reg = fp->mask;
+}
+
+static inline __attribute__((always_inline)) void fastPinClear(const fast_gpio_t *fp) {
+  *fp->clear_reg = fp->mask;
+}
+
+static inline __attribute__((always_inline)) void fastPinWrite(const fast_gpio_t *fp, uint8_t val) {
+  if (val) {
+    *fp->set_reg = fp->mask;
+  } else {
+    *fp->clear_reg = fp->mask;
+  }
+}
+
+// not atomic against another context writing the same pins
+static inline __attribute__((always_inline)) void fastPinToggle(const fast_gpio_t *fp) {
+  uint32_t out = *fp->out_reg;
+  *fp->set_reg = ~out & fp->mask;
+  *fp->clear_reg = out & fp->mask;
+}
+
+static inline __attribute__((always_inline)) int fastPinRead(const fast_gpio_t *fp) {
+  return (*fp->in_reg & fp->mask) != 0;
+}
+
+// drive the port pins selected by <mask> to the levels in <value>, all at the same time
+static inline __attribute__((always_inline)) void fastPortWrite(const fast_gpio_t *port, uint32_t mask, uint32_t value) {
+  mask &= port->mask;
+  *port->set_reg = value & mask;
+  *port->clear_reg = ~value & mask;
+}
+
+static inline __attribute__((always_inline)) uint32_t fastPortRead(const fast_gpio_t *port) {
+  return *port->in_reg & port->mask;
+}
+
 int8_t digitalPinToTouchChannel(uint8_t pin);
 int8_t digitalPinToAnalogChannel(uint8_t pin);
 int8_t analogChannelToDigitalPin(uint8_t channel);
@@ -389,6 +389,56 @@ end:
   return ret;
 }
 
+esp_err_t i2cRunOps(uint8_t i2c_num, i2c_op_t *ops, size_t count, uint32_t timeOutMillis) {
+  esp_err_t ret = ESP_FAIL;
+  if (i2c_num >= SOC_I2C_NUM || (!ops && count)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+#if !CONFIG_DISABLE_HAL_LOCKS
+  //acquire lock
+  if (bus[i2c_num].lock == NULL || xSemaphoreTake(bus[i2c_num].lock, portMAX_DELAY) != pdTRUE) {
+    log_e("could not acquire lock");
+    return ret;
+  }
+#endif
+  if (!bus[i2c_num].initialized) {
+    log_e("bus is not initialized");
+    goto end;
+  }
+
+  ret = ESP_OK;
+  for (size_t i = 0; i < count; i++) {
+    i2c_op_t *op = &ops[i];
+    if (op->address >= 128) {
+      op->result = ESP_ERR_INVALID_ARG;
+    } else if (!op->wsize && !op->rsize) {
+      op->result = i2c_master_probe(bus[i2c_num].bus_handle, op->address, timeOutMillis);
+    } else if ((op->result = i2cAddDeviceIfNeeded(i2c_num, op->address)) == ESP_OK) {
+      i2c_master_dev_handle_t dev = bus[i2c_num].dev_handles[op->address];
+      if (!op->rsize) {
+        op->result = i2c_master_transmit(dev, op->wbuff, op->wsize, timeOutMillis);
+      } else if (!op->wsize) {
+        op->result = i2c_master_receive(dev, op->rbuff, op->rsize, timeOutMillis);
+      } else {
+        op->result = i2c_master_transmit_receive(dev, op->wbuff, op->wsize, op->rbuff, op->rsize, timeOutMillis);
+      }
+    }
+    if (op->result != ESP_OK) {
+      log_v("transaction %u to 0x%x failed: [%d] %s", (unsigned)i, op->address, op->result, esp_err_to_name(op->result));
+      if (ret == ESP_OK) {
+        ret = op->result;
+      }
+    }
+  }
+
+end:
+#if !CONFIG_DISABLE_HAL_LOCKS
+  //release lock
+  xSemaphoreGive(bus[i2c_num].lock);
+#endif
+  return ret;
+}
+
 esp_err_t i2cSetClock(uint8_t i2c_num, uint32_t frequency) {
   esp_err_t ret = ESP_FAIL;
   if (i2c_num >= SOC_I2C_NUM) {
@@ -32,6 +32,7 @@
 #include "hal/gpio_types.h"
 #include "driver/gpio.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(6, 0, 0)
 #include "esp_rom_gpio.h"
 #endif
@@ -76,6 +77,20 @@
 
 #define I2C_SLAVE_USE_RX_QUEUE 0  // 1: Queue, 0: RingBuffer
 
+// Events between the interrupt and the slave task. Raise the queue length if the callbacks
+// are slow compared to the transactions and events get lost.
+#ifndef I2C_SLAVE_EVENT_QUEUE_LENGTH
+#define I2C_SLAVE_EVENT_QUEUE_LENGTH 16
+#endif
+
+#ifndef I2C_SLAVE_TASK_STACK_SIZE
+#define I2C_SLAVE_TASK_STACK_SIZE 4096
+#endif
+
+#ifndef I2C_SLAVE_TASK_PRIORITY
+#define I2C_SLAVE_TASK_PRIORITY 20
+#endif
+
 #ifdef CONFIG_IDF_TARGET_ESP32P4
 #define I2C_SCL_IDX(p) ((p == 0) ? I2C0_SCL_PAD_OUT_IDX : ((p == 1) ? I2C1_SCL_PAD_OUT_IDX : 0))
 #define I2C_SDA_IDX(p) ((p == 0) ? I2C0_SDA_PAD_OUT_IDX : ((p == 1) ? I2C1_SDA_PAD_OUT_IDX : 0))
@@ -96,7 +111,8 @@
 
 enum {
   I2C_SLAVE_EVT_RX,
-  I2C_SLAVE_EVT_TX
+  I2C_SLAVE_EVT_TX,
+  I2C_SLAVE_EVT_REG
 };
 
 typedef struct i2c_slave_struct_t {
@@ -120,8 +136,23 @@ typedef struct i2c_slave_struct_t {
 #if !CONFIG_DISABLE_HAL_LOCKS
   SemaphoreHandle_t lock;
 #endif
+  // register map mode
+  uint8_t *reg_map;
+  uint16_t reg_size;
+  uint16_t reg_wr_start;
+  i2c_slave_reg_cb_t reg_callback;
+  void *reg_arg;
+  uint16_t reg_ptr;       // next register read or written
+  uint16_t reg_tx_ptr;    // next register loaded into the TX FIFO
+  uint16_t reg_wr_first;  // register selected by the current write
+  uint16_t reg_wr_count;  // data bytes received by the current write
+  bool reg_select;        // the next received byte selects the register
+  // request latency
+  int64_t request_time;
+  i2c_slave_stats_t stats;
 } i2c_slave_struct_t;
 
+// I2C_SLAVE_EVT_REG carries the first register in the low 8 bits of param and the length above
 typedef union {
   struct {
     uint32_t event : 2;
@@ -162,6 +193,9 @@ static i2c_slave_struct_t _i2c_bus_array[SOC_HP_I2C_NUM] = {
   }
 #endif
 
+// the counters in i2c_slave_stats_t are written by the interrupt and the slave task
+static portMUX_TYPE i2c_slave_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
 //-------------------------------------- HAL_LL (Missing Functions) ------------------------------------------------
 typedef enum {
   I2C_STRETCH_CAUSE_MASTER_READ,
@@ -232,6 +266,12 @@ static bool i2c_slave_set_frequency(i2c_slave_struct_t *i2c, uint32_t clk_speed)
 static bool i2c_slave_send_event(i2c_slave_struct_t *i2c, i2c_slave_queue_event_t *event);
 static bool i2c_slave_handle_tx_fifo_empty(i2c_slave_struct_t *i2c);
 static bool i2c_slave_handle_rx_fifo_full(i2c_slave_struct_t *i2c, uint32_t len);
+static void i2c_slave_reg_fill_tx(i2c_slave_struct_t *i2c);
+static void i2c_slave_reg_load_tx(i2c_slave_struct_t *i2c);
+static void i2c_slave_reg_receive(i2c_slave_struct_t *i2c);
+static bool i2c_slave_reg_write_done(i2c_slave_struct_t *i2c);
+static void i2c_slave_reg_read_done(i2c_slave_struct_t *i2c);
+static void i2c_slave_record_request(i2c_slave_struct_t *i2c, int64_t start, int64_t end);
 static size_t i2c_slave_read_rx(i2c_slave_struct_t *i2c, uint8_t *data, size_t len);
 static void i2c_slave_isr_handler(void *arg);
 static void i2c_slave_task(void *pv_args);
@@ -320,14 +360,14 @@ esp_err_t i2cSlaveInit(uint8_t num, int sda, int scl, uint16_t slaveID, uint32_t
     goto fail;
   }
 
-  i2c->event_queue = xQueueCreate(16, sizeof(i2c_slave_queue_event_t));
+  i2c->event_queue = xQueueCreate(I2C_SLAVE_EVENT_QUEUE_LENGTH, sizeof(i2c_slave_queue_event_t));
   if (i2c->event_queue == NULL) {
     log_e("Event queue create failed");
     ret = ESP_ERR_NO_MEM;
     goto fail;
   }
 
-  xTaskCreate(i2c_slave_task, "i2c_slave_task", 4096, i2c, 20, &i2c->task_handle);
+  xTaskCreate(i2c_slave_task, "i2c_slave_task", I2C_SLAVE_TASK_STACK_SIZE, i2c, I2C_SLAVE_TASK_PRIORITY, &i2c->task_handle);
   if (i2c->task_handle == NULL) {
     log_e("Event thread create failed");
     ret = ESP_ERR_NO_MEM;
@@ -519,6 +559,62 @@ size_t i2cSlaveWrite(uint8_t num, const uint8_t *buf, uint32_t len, uint32_t tim
   return to_queue + to_fifo;
 }
 
+esp_err_t i2cSlaveSetRegisterMap(uint8_t num, uint8_t *map, size_t size, size_t wr_start, i2c_slave_reg_cb_t write_callback, void *arg) {
+  if (num >= SOC_HP_I2C_NUM) {
+    log_e("Invalid port num: %u", num);
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (map && (size == 0 || size > 256)) {
+    log_e("Register map size must be 1 to 256, not %u", (unsigned)size);
+    return ESP_ERR_INVALID_ARG;
+  }
+  i2c_slave_struct_t *i2c = &_i2c_bus_array[num];
+  if (!i2c->intr_handle) {
+    log_e("I2C Slave is not initialized! Did you call i2cSlaveInit()?");
+    return ESP_ERR_INVALID_STATE;
+  }
+  I2C_SLAVE_MUTEX_LOCK();
+  // the interrupt owns the map state, keep it out while switching
+  esp_intr_disable(i2c->intr_handle);
+  i2c->reg_map = map;
+  i2c->reg_size = map ? size : 0;
+  i2c->reg_wr_start = (wr_start < size) ? wr_start : size;
+  i2c->reg_callback = write_callback;
+  i2c->reg_arg = arg;
+  i2c->reg_ptr = 0;
+  i2c->reg_wr_count = 0;
+  i2c->reg_select = true;
+  i2c_ll_slave_disable_tx_it(i2c->dev);
+  i2c_ll_txfifo_rst(i2c->dev);
+#if CONFIG_IDF_TARGET_ESP32
+  if (map) {
+    i2c_slave_reg_load_tx(i2c);
+  }
+#endif
+  esp_intr_enable(i2c->intr_handle);
+  I2C_SLAVE_MUTEX_UNLOCK();
+  return ESP_OK;
+}
+
+esp_err_t i2cSlaveGetStats(uint8_t num, i2c_slave_stats_t *stats, bool reset) {
+  if (num >= SOC_HP_I2C_NUM) {
+    log_e("Invalid port num: %u", num);
+    return ESP_ERR_INVALID_ARG;
+  }
+  i2c_slave_struct_t *i2c = &_i2c_bus_array[num];
+  i2c_slave_stats_t copy;
+  portENTER_CRITICAL(&i2c_slave_stats_mux);
+  copy = i2c->stats;
+  if (reset) {
+    memset(&i2c->stats, 0, sizeof(i2c_slave_stats_t));
+  }
+  portEXIT_CRITICAL(&i2c_slave_stats_mux);
+  if (stats) {
+    *stats = copy;
+  }
+  return ESP_OK;
+}
+
 //=====================================================================================================================
 //-------------------------------------- Private Functions ------------------------------------------------------------
 //=====================================================================================================================
@@ -562,6 +658,9 @@ static void i2c_slave_free_resources(i2c_slave_struct_t *i2c) {
   }
 
   i2c->rx_data_count = 0;
+  i2c->reg_map = NULL;
+  i2c->reg_size = 0;
+  i2c->reg_callback = NULL;
 }
 
 static bool i2c_slave_set_frequency(i2c_slave_struct_t *i2c, uint32_t clk_speed) {
@@ -719,6 +818,10 @@ static bool i2c_slave_send_event(i2c_slave_struct_t *i2c, i2c_slave_queue_event_
 static bool i2c_slave_handle_tx_fifo_empty(i2c_slave_struct_t *i2c) {
   bool pxHigherPriorityTaskWoken = false;
   uint32_t d = 0, moveCnt = 0;
+  if (i2c->reg_map) {
+    i2c_slave_reg_fill_tx(i2c);
+    return false;
+  }
   i2c_ll_get_txfifo_len(i2c->dev, &moveCnt);
   while (moveCnt > 0) {  // read tx queue until Fifo is full or queue is empty
     if (xQueueReceiveFromISR(i2c->tx_queue, &d, (BaseType_t *const)&pxHigherPriorityTaskWoken) == pdTRUE) {
@@ -739,11 +842,18 @@ static bool i2c_slave_handle_rx_fifo_full(i2c_slave_struct_t *i2c, uint32_t len)
   uint8_t data[SOC_I2C_FIFO_LEN];
 #endif
   bool pxHigherPriorityTaskWoken = false;
+  if (i2c->reg_map) {
+    i2c_slave_reg_receive(i2c);
+    return false;
+  }
 #if I2C_SLAVE_USE_RX_QUEUE
   while (len > 0) {
     i2c_ll_read_rxfifo(i2c->dev, (uint8_t *)&d, 1);
     if (xQueueSendFromISR(i2c->rx_queue, &d, (BaseType_t *const)&pxHigherPriorityTaskWoken) != pdTRUE) {
       log_e("rx_queue_full");
+      portENTER_CRITICAL_ISR(&i2c_slave_stats_mux);
+      i2c->stats.rx_dropped++;
+      portEXIT_CRITICAL_ISR(&i2c_slave_stats_mux);
     } else {
       i2c->rx_data_count++;
     }
@@ -755,6 +865,9 @@ static bool i2c_slave_handle_rx_fifo_full(i2c_slave_struct_t *i2c, uint32_t len)
     i2c_ll_read_rxfifo(i2c->dev, data, len);
     if (xRingbufferSendFromISR(i2c->rx_ring_buf, (void *)data, len, (BaseType_t *const)&pxHigherPriorityTaskWoken) != pdTRUE) {
       log_e("rx_ring_buf_full");
+      portENTER_CRITICAL_ISR(&i2c_slave_stats_mux);
+      i2c->stats.rx_dropped += len;
+      portEXIT_CRITICAL_ISR(&i2c_slave_stats_mux);
     } else {
       i2c->rx_data_count += len;
     }
@@ -763,6 +876,105 @@ static bool i2c_slave_handle_rx_fifo_full(i2c_slave_struct_t *i2c, uint32_t len)
   return pxHigherPriorityTaskWoken;
 }
 
+// load the TX FIFO up to full with the registers that follow the ones already in it
+static void i2c_slave_reg_fill_tx(i2c_slave_struct_t *i2c) {
+  uint8_t data[SOC_I2C_FIFO_LEN];
+  uint32_t len = 0;
+  i2c_ll_get_txfifo_len(i2c->dev, &len);
+  if (len > SOC_I2C_FIFO_LEN) {
+    len = SOC_I2C_FIFO_LEN;
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    data[i] = i2c->reg_map[i2c->reg_tx_ptr];
+    if (++i2c->reg_tx_ptr >= i2c->reg_size) {
+      i2c->reg_tx_ptr = 0;
+    }
+  }
+  if (len) {
+    i2c_ll_write_txfifo(i2c->dev, data, len);
+  }
+}
+
+// start a read at the current register
+static void i2c_slave_reg_load_tx(i2c_slave_struct_t *i2c) {
+  i2c_ll_txfifo_rst(i2c->dev);
+  i2c->reg_tx_ptr = i2c->reg_ptr;
+  i2c_slave_reg_fill_tx(i2c);
+  i2c_ll_slave_enable_tx_it(i2c->dev);
+}
+
+// store received bytes, the count is read again since another interrupt cause may have emptied the FIFO already
+static void i2c_slave_reg_receive(i2c_slave_struct_t *i2c) {
+  uint8_t data[SOC_I2C_FIFO_LEN];
+  uint32_t len = 0;
+  i2c_ll_get_rxfifo_cnt(i2c->dev, &len);
+  if (!len) {
+    return;
+  }
+  if (len > SOC_I2C_FIFO_LEN) {
+    len = SOC_I2C_FIFO_LEN;
+  }
+  i2c_ll_read_rxfifo(i2c->dev, data, len);
+  for (uint32_t i = 0; i < len; i++) {
+    if (i2c->reg_select) {
+      i2c->reg_select = false;
+      i2c->reg_ptr = data[i] % i2c->reg_size;
+      i2c->reg_wr_first = i2c->reg_ptr;
+      i2c->reg_wr_count = 0;
+#if CONFIG_IDF_TARGET_ESP32
+      //no stretching: have the selected register ready in case a read follows with repeated start
+      i2c_slave_reg_load_tx(i2c);
+#endif
+      continue;
+    }
+    if (i2c->reg_ptr >= i2c->reg_wr_start) {
+      i2c->reg_map[i2c->reg_ptr] = data[i];
+    }
+    i2c->reg_wr_count++;
+    if (++i2c->reg_ptr >= i2c->reg_size) {
+      i2c->reg_ptr = 0;
+    }
+  }
+}
+
+// end of the write phase, the next write selects a register again
+static bool i2c_slave_reg_write_done(i2c_slave_struct_t *i2c) {
+  bool pxHigherPriorityTaskWoken = false;
+  if (i2c->reg_wr_count) {
+    portENTER_CRITICAL_ISR(&i2c_slave_stats_mux);
+    i2c->stats.reg_writes++;
+    portEXIT_CRITICAL_ISR(&i2c_slave_stats_mux);
+    if (i2c->reg_callback) {
+      i2c_slave_queue_event_t event;
+      event.event = I2C_SLAVE_EVT_REG;
+      event.stop = 1;
+      event.param = i2c->reg_wr_first | ((uint32_t)i2c->reg_wr_count << 8);
+      pxHigherPriorityTaskWoken = i2c_slave_send_event(i2c, &event);
+    }
+    i2c->reg_wr_count = 0;
+  }
+  i2c->reg_select = true;
+  return pxHigherPriorityTaskWoken;
+}
+
+// registers loaded but not clocked out are read again by the next transaction
+static void i2c_slave_reg_read_done(i2c_slave_struct_t *i2c) {
+  uint32_t free_len = 0;
+  i2c_ll_get_txfifo_len(i2c->dev, &free_len);
+  uint32_t unsent = (free_len < SOC_I2C_FIFO_LEN) ? (SOC_I2C_FIFO_LEN - free_len) : 0;
+  i2c->reg_ptr = (i2c->reg_tx_ptr + i2c->reg_size - (unsent % i2c->reg_size)) % i2c->reg_size;
+  portENTER_CRITICAL_ISR(&i2c_slave_stats_mux);
+  i2c->stats.reg_reads++;
+  portEXIT_CRITICAL_ISR(&i2c_slave_stats_mux);
+  i2c->reg_select = true;
+#if CONFIG_IDF_TARGET_ESP32
+  i2c_slave_reg_load_tx(i2c);
+#else
+  i2c_ll_slave_disable_tx_it(i2c->dev);
+  i2c_ll_txfifo_rst(i2c->dev);
+#endif
+}
+
 static void i2c_slave_isr_handler(void *arg) {
   bool pxHigherPriorityTaskWoken = false;
   i2c_slave_struct_t *i2c = (i2c_slave_struct_t *)arg;  // recover data
@@ -779,8 +991,19 @@ static void i2c_slave_isr_handler(void *arg) {
     i2c_ll_slave_enable_rx_it(i2c->dev);  //is this necessary?
   }
 
-  if (activeInt & I2C_TRANS_COMPLETE_INT_ENA) {  // STOP
-    if (rx_fifo_len) {                           //READ RX FIFO
+  if ((activeInt & I2C_TRANS_COMPLETE_INT_ENA) && i2c->reg_map) {  // STOP in register map mode
+    i2c_slave_reg_receive(i2c);
+    if (slave_rw) {
+      i2c_slave_reg_read_done(i2c);
+    } else {
+      pxHigherPriorityTaskWoken |= i2c_slave_reg_write_done(i2c);
+#if CONFIG_IDF_TARGET_ESP32
+      //the write may have changed registers that are already in the FIFO
+      i2c_slave_reg_load_tx(i2c);
+#endif
+    }
+  } else if (activeInt & I2C_TRANS_COMPLETE_INT_ENA) {  // STOP
+    if (rx_fifo_len) {                                 //READ RX FIFO
       pxHigherPriorityTaskWoken |= i2c_slave_handle_rx_fifo_full(i2c, rx_fifo_len);
     }
     if (i2c->rx_data_count) {  //WRITE or RepeatedStart
@@ -797,6 +1020,7 @@ static void i2c_slave_isr_handler(void *arg) {
 #if CONFIG_IDF_TARGET_ESP32
       if (i2c->dev->status_reg.scl_main_state_last == 6) {
         //SEND TX Event
+        i2c->request_time = esp_timer_get_time();
         i2c_slave_queue_event_t event;
         event.event = I2C_SLAVE_EVT_TX;
         pxHigherPriorityTaskWoken |= i2c_slave_send_event(i2c, &event);
@@ -813,12 +1037,19 @@ static void i2c_slave_isr_handler(void *arg) {
 #ifndef CONFIG_IDF_TARGET_ESP32
   if (activeInt & I2C_SLAVE_STRETCH_INT_ENA) {  // STRETCH
     i2c_stretch_cause_t cause = i2c_ll_stretch_cause(i2c->dev);
-    if (cause == I2C_STRETCH_CAUSE_MASTER_READ) {
+    if (cause == I2C_STRETCH_CAUSE_MASTER_READ && i2c->reg_map) {
+      //serve the read right here, the register may have been selected with a repeated start
+      i2c_slave_reg_receive(i2c);
+      pxHigherPriorityTaskWoken |= i2c_slave_reg_write_done(i2c);
+      i2c_slave_reg_load_tx(i2c);
+      i2c_ll_stretch_clr(i2c->dev);
+    } else if (cause == I2C_STRETCH_CAUSE_MASTER_READ) {
       //on C3 RX data disappears with repeated start, so we need to get it here
       if (rx_fifo_len) {
         pxHigherPriorityTaskWoken |= i2c_slave_handle_rx_fifo_full(i2c, rx_fifo_len);
       }
       //SEND TX Event
+      i2c->request_time = esp_timer_get_time();
       i2c_slave_queue_event_t event;
       event.event = I2C_SLAVE_EVT_TX;
       pxHigherPriorityTaskWoken |= i2c_slave_send_event(i2c, &event);
@@ -890,6 +1121,24 @@ static size_t i2c_slave_read_rx(i2c_slave_struct_t *i2c, uint8_t *data, size_t l
 #endif
 }
 
+static void i2c_slave_record_request(i2c_slave_struct_t *i2c, int64_t start, int64_t end) {
+  i2c_slave_stats_t *stats = &i2c->stats;
+  uint32_t dispatch = (uint32_t)(start - i2c->request_time);
+  uint32_t stretch = (uint32_t)(end - i2c->request_time);
+  portENTER_CRITICAL(&i2c_slave_stats_mux);
+  stats->requests++;
+  stats->dispatch_last_us = dispatch;
+  if (dispatch > stats->dispatch_max_us) {
+    stats->dispatch_max_us = dispatch;
+  }
+  stats->stretch_last_us = stretch;
+  if (stretch > stats->stretch_max_us) {
+    stats->stretch_max_us = stretch;
+  }
+  stats->stretch_total_us += stretch;
+  portEXIT_CRITICAL(&i2c_slave_stats_mux);
+}
+
 static void i2c_slave_task(void *pv_args) {
   i2c_slave_struct_t *i2c = (i2c_slave_struct_t *)pv_args;
   i2c_slave_queue_event_t event;
@@ -915,10 +1164,18 @@ static void i2c_slave_task(void *pv_args) {
 
         // Read
       } else if (event.event == I2C_SLAVE_EVT_TX) {
+        int64_t start = esp_timer_get_time();
         if (i2c->request_callback) {
           i2c->request_callback(i2c->num, i2c->arg);
         }
         i2c_ll_stretch_clr(i2c->dev);
+        i2c_slave_record_request(i2c, start, esp_timer_get_time());
+
+        // Registers written in register map mode
+      } else if (event.event == I2C_SLAVE_EVT_REG) {
+        if (i2c->reg_callback) {
+          i2c->reg_callback(i2c->num, event.param & 0xFF, event.param >> 8, i2c->reg_arg);
+        }
       }
     }
   }
@@ -23,6 +23,7 @@ extern "C" {
 
 #include "stdint.h"
 #include "stddef.h"
+#include "stdbool.h"
 #include "esp_err.h"
 
 typedef void (*i2c_slave_request_cb_t)(uint8_t num, void *arg);
@@ -33,6 +34,34 @@ esp_err_t i2cSlaveInit(uint8_t num, int sda, int scl, uint16_t slaveID, uint32_t
 esp_err_t i2cSlaveDeinit(uint8_t num);
 size_t i2cSlaveWrite(uint8_t num, const uint8_t *buf, uint32_t len, uint32_t timeout_ms);
 
+/*
+ * Register map mode: the slave behaves like a typical sensor with up to 256 byte registers.
+ * The first byte of a write selects the register, further bytes are stored starting there and
+ * reads return the registers from the current one on, both with auto-increment that wraps at size.
+ * Everything is served from the interrupt, request and receive callbacks are not called.
+ * Registers below wr_start are read-only, writes to them are dropped.
+ * write_callback runs in the slave task after a master wrote registers (may be NULL).
+ * On ESP32 (no clock stretching) the TX FIFO is loaded ahead of the read, so a read directly
+ * after new register values were stored by the application may still return the previous ones.
+ * Pass map = NULL to return to the callback mode.
+ */
+typedef void (*i2c_slave_reg_cb_t)(uint8_t num, uint8_t reg, size_t len, void *arg);
+esp_err_t i2cSlaveSetRegisterMap(uint8_t num, uint8_t *map, size_t size, size_t wr_start, i2c_slave_reg_cb_t write_callback, void *arg);
+
+typedef struct {
+  uint32_t requests;          // request callbacks run
+  uint32_t dispatch_last_us;  // SCL held from the read request until the callback started
+  uint32_t dispatch_max_us;
+  uint32_t stretch_last_us;   // SCL held from the read request until it was released after the callback
+  uint32_t stretch_max_us;
+  uint64_t stretch_total_us;  // divide by requests for the average
+  uint32_t reg_reads;         // register map transactions served from the interrupt
+  uint32_t reg_writes;
+  uint32_t rx_dropped;        // received bytes lost because the RX buffer was full
+} i2c_slave_stats_t;
+
+esp_err_t i2cSlaveGetStats(uint8_t num, i2c_slave_stats_t *stats, bool reset);
+
 #ifdef __cplusplus
 }
 #endif
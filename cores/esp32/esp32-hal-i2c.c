@@ -314,6 +314,59 @@ esp_err_t i2cWriteReadNonStop(
   return ret;
 }
 
+esp_err_t i2cRunOps(uint8_t i2c_num, i2c_op_t *ops, size_t count, uint32_t timeOutMillis) {
+  esp_err_t ret = ESP_FAIL;
+  if (i2c_num >= SOC_I2C_NUM || (!ops && count)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+#if !CONFIG_DISABLE_HAL_LOCKS
+  //acquire lock
+  if (bus[i2c_num].lock == NULL || xSemaphoreTake(bus[i2c_num].lock, portMAX_DELAY) != pdTRUE) {
+    log_e("could not acquire lock");
+    return ret;
+  }
+#endif
+  if (!bus[i2c_num].initialized) {
+    log_e("bus is not initialized");
+    goto end;
+  }
+
+  ret = ESP_OK;
+  for (size_t i = 0; i < count; i++) {
+    i2c_op_t *op = &ops[i];
+    TickType_t ticks = timeOutMillis / portTICK_PERIOD_MS;
+    if (op->address >= 128) {
+      op->result = ESP_ERR_INVALID_ARG;
+    } else if (!op->rsize) {
+      // also covers zero size writes (probing), which the device functions do not support
+      uint8_t cmd_buff[I2C_LINK_RECOMMENDED_SIZE(1)] = {0};
+      i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(cmd_buff, I2C_LINK_RECOMMENDED_SIZE(1));
+      i2c_master_start(cmd);
+      i2c_master_write_byte(cmd, (op->address << 1) | I2C_MASTER_WRITE, true);
+      if (op->wsize) {
+        i2c_master_write(cmd, op->wbuff, op->wsize, true);
+      }
+      i2c_master_stop(cmd);
+      op->result = i2c_master_cmd_begin((i2c_port_t)i2c_num, cmd, ticks);
+      i2c_cmd_link_delete_static(cmd);
+    } else if (!op->wsize) {
+      op->result = i2c_master_read_from_device((i2c_port_t)i2c_num, op->address, op->rbuff, op->rsize, ticks);
+    } else {
+      op->result = i2c_master_write_read_device((i2c_port_t)i2c_num, op->address, op->wbuff, op->wsize, op->rbuff, op->rsize, ticks);
+    }
+    if (op->result != ESP_OK && ret == ESP_OK) {
+      ret = op->result;
+    }
+  }
+
+end:
+#if !CONFIG_DISABLE_HAL_LOCKS
+  //release lock
+  xSemaphoreGive(bus[i2c_num].lock);
+#endif
+  return ret;
+}
+
 esp_err_t i2cSetClock(uint8_t i2c_num, uint32_t frequency) {
   esp_err_t ret = ESP_FAIL;
   if (i2c_num >= SOC_I2C_NUM) {
@@ -40,6 +40,20 @@ esp_err_t i2cWriteReadNonStop(
 );
 bool i2cIsInit(uint8_t i2c_num);
 
+// One transaction of a list run by i2cRunOps(); rsize 0 writes, wsize 0 reads, both write then read after a repeated start
+typedef struct {
+  uint16_t address;
+  const uint8_t *wbuff;
+  size_t wsize;
+  uint8_t *rbuff;
+  size_t rsize;
+  esp_err_t result;  // set by i2cRunOps()
+} i2c_op_t;
+
+// Run count transactions back to back while holding the bus once. A failing transaction does not stop the
+// others; returns the first error, ESP_OK if all succeeded
+esp_err_t i2cRunOps(uint8_t i2c_num, i2c_op_t *ops, size_t count, uint32_t timeOutMillis);
+
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
 void *i2cBusHandle(uint8_t i2c_num);
 #endif
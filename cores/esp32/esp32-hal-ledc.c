@@ -22,6 +22,7 @@
 #include "soc/gpio_sig_map.h"
 #include "esp_rom_gpio.h"
 #include "hal/ledc_ll.h"
+#include "esp_timer.h"
 #if SOC_LEDC_GAMMA_CURVE_FADE_SUPPORTED
 #include <math.h>
 #endif
@@ -147,6 +148,34 @@ static void remove_channel_from_timer(uint8_t speed_mode, uint8_t timer_num, uin
 
 static bool fade_initialized = false;
 
+// Channels with a duty staged by ledcWriteStage(), waiting for ledcWriteCommit()
+static uint32_t staged_channels = 0;
+static portMUX_TYPE staged_mux = portMUX_INITIALIZER_UNLOCKED;
+
+typedef struct {
+  uint32_t start_duty;
+  uint32_t target_duty;
+  uint32_t duty;  // last duty written by the scheduler
+  int64_t start_us;
+  int64_t duration_us;
+  void (*fn)(void *);
+  void *arg;
+} ledc_scheduled_fade_t;
+
+// Fades run by ledcScheduleFade(), all stepped by the same esp_timer
+static ledc_scheduled_fade_t scheduled_fades[LEDC_CHANNELS];
+static uint32_t fading_channels = 0;
+static esp_timer_handle_t fade_timer = NULL;
+static SemaphoreHandle_t fade_lock = NULL;
+
+// with fade_lock held; the timer only runs while a channel is fading
+static void ledcFadeRemoveChannels(uint32_t channels) {
+  fading_channels &= ~channels;
+  if (fading_channels == 0 && fade_timer != NULL && esp_timer_is_active(fade_timer)) {
+    esp_timer_stop(fade_timer);
+  }
+}
+
 static ledc_clk_cfg_t clock_source = LEDC_DEFAULT_CLK;
 
 ledc_clk_cfg_t ledcGetClockSource(void) {
@@ -184,6 +213,14 @@ static bool ledcDetachBus(void *bus) {
     uint8_t group = (handle->channel / SOC_LEDC_CHANNEL_NUM);
     remove_channel_from_timer(group, handle->timer_num, handle->channel % SOC_LEDC_CHANNEL_NUM);
     ledc_handle.used_channels &= ~(1UL << handle->channel);
+    portENTER_CRITICAL(&staged_mux);
+    staged_channels &= ~(1UL << handle->channel);
+    portEXIT_CRITICAL(&staged_mux);
+    if (fade_lock != NULL) {
+      xSemaphoreTake(fade_lock, portMAX_DELAY);
+      ledcFadeRemoveChannels(1UL << handle->channel);
+      xSemaphoreGive(fade_lock);
+    }
   }
   free(handle);
   if (ledc_handle.used_channels == 0) {
@@ -395,6 +432,86 @@ bool ledcWriteChannel(uint8_t channel, uint32_t duty) {
   return true;
 }
 
+// Write the duty of a channel without latching it, the output keeps its current duty
+static bool ledcStageDuty(uint8_t channel, uint8_t resolution, uint32_t duty) {
+  //Fixing if all bits in resolution is set = LEDC FULL ON
+  uint32_t max_duty = (1 << resolution) - 1;
+
+  if ((duty >= max_duty) && (max_duty != 1)) {
+    duty = max_duty + 1;
+  }
+
+  if (ledc_set_duty(channel / SOC_LEDC_CHANNEL_NUM, channel % SOC_LEDC_CHANNEL_NUM, duty) != ESP_OK) {
+    log_e("ledc_set_duty failed");
+    return false;
+  }
+  return true;
+}
+
+// Latch the staged duties of the channels in the mask back to back. Each channel switches at the end
+// of its current PWM period, so channels running on the same timer usually switch together; a period
+// ending between two ledc_update_duty() calls puts them one cycle apart
+static void ledcLatchChannels(uint32_t channels) {
+  static portMUX_TYPE latch_mux = portMUX_INITIALIZER_UNLOCKED;
+  portENTER_CRITICAL(&latch_mux);
+  while (channels) {
+    uint8_t channel = __builtin_ctz(channels);
+    channels &= channels - 1;
+    ledc_update_duty(channel / SOC_LEDC_CHANNEL_NUM, channel % SOC_LEDC_CHANNEL_NUM);
+  }
+  portEXIT_CRITICAL(&latch_mux);
+}
+
+bool ledcWriteStage(uint8_t pin, uint32_t duty) {
+  ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(pin, ESP32_BUS_TYPE_LEDC);
+  if (bus == NULL) {
+    log_e("Pin %u is not attached to LEDC. Call ledcAttach first!", pin);
+    return false;
+  }
+  if (!ledcStageDuty(bus->channel, bus->channel_resolution, duty)) {
+    return false;
+  }
+  portENTER_CRITICAL(&staged_mux);
+  staged_channels |= 1UL << bus->channel;
+  portEXIT_CRITICAL(&staged_mux);
+  return true;
+}
+
+bool ledcWriteCommit(void) {
+  portENTER_CRITICAL(&staged_mux);
+  uint32_t channels = staged_channels;
+  staged_channels = 0;
+  portEXIT_CRITICAL(&staged_mux);
+  if (channels == 0) {
+    return false;
+  }
+  ledcLatchChannels(channels);
+  return true;
+}
+
+bool ledcWriteMulti(const uint8_t *pins, const uint32_t *duties, size_t count) {
+  if (pins == NULL || duties == NULL || count == 0) {
+    return false;
+  }
+  // check all pins first so that either all or none of the duties change
+  for (size_t i = 0; i < count; i++) {
+    if (perimanGetPinBus(pins[i], ESP32_BUS_TYPE_LEDC) == NULL) {
+      log_e("Pin %u is not attached to LEDC. Call ledcAttach first!", pins[i]);
+      return false;
+    }
+  }
+  uint32_t channels = 0;
+  for (size_t i = 0; i < count; i++) {
+    ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(pins[i], ESP32_BUS_TYPE_LEDC);
+    if (!ledcStageDuty(bus->channel, bus->channel_resolution, duties[i])) {
+      return false;
+    }
+    channels |= 1UL << bus->channel;
+  }
+  ledcLatchChannels(channels);
+  return true;
+}
+
 uint32_t ledcRead(uint8_t pin) {
   ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(pin, ESP32_BUS_TYPE_LEDC);
   if (bus != NULL) {
@@ -667,6 +784,131 @@ bool ledcFadeWithInterruptArg(uint8_t pin, uint32_t start_duty, uint32_t target_
   return ledcFadeConfig(pin, start_duty, target_duty, max_fade_time_ms, userFunc, arg);
 }
 
+static void ledcFadeTick(void *arg) {
+  struct {
+    void (*fn)(void *);
+    void *arg;
+  } done[LEDC_CHANNELS];
+  size_t num_done = 0;
+  uint32_t channels = 0;
+
+  xSemaphoreTake(fade_lock, portMAX_DELAY);
+  int64_t now = esp_timer_get_time();
+  uint32_t fading = fading_channels;
+  uint32_t finished = 0;
+  while (fading) {
+    uint8_t channel = __builtin_ctz(fading);
+    fading &= fading - 1;
+    ledc_scheduled_fade_t *fade = &scheduled_fades[channel];
+
+    uint32_t duty = fade->target_duty;
+    int64_t elapsed = now - fade->start_us;
+    if (elapsed < fade->duration_us) {
+      duty = fade->start_duty + (int32_t)(((int64_t)fade->target_duty - fade->start_duty) * elapsed / fade->duration_us);
+    } else {
+      finished |= 1UL << channel;
+      if (fade->fn) {
+        done[num_done].fn = fade->fn;
+        done[num_done].arg = fade->arg;
+        num_done++;
+      }
+    }
+    // slow fades do not change the duty on every tick
+    if (duty != fade->duty && ledc_set_duty(channel / SOC_LEDC_CHANNEL_NUM, channel % SOC_LEDC_CHANNEL_NUM, duty) == ESP_OK) {
+      fade->duty = duty;
+      channels |= 1UL << channel;
+    }
+  }
+  ledcLatchChannels(channels);
+  ledcFadeRemoveChannels(finished);
+  xSemaphoreGive(fade_lock);
+
+  // without the lock, so that the callbacks can schedule the next fade
+  for (size_t i = 0; i < num_done; i++) {
+    done[i].fn(done[i].arg);
+  }
+}
+
+bool ledcScheduleFade(uint8_t pin, uint32_t start_duty, uint32_t target_duty, uint32_t fade_time_ms, void (*userFunc)(void *), void *arg) {
+  ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(pin, ESP32_BUS_TYPE_LEDC);
+  if (bus == NULL) {
+    log_e("Pin %u is not attached to LEDC. Call ledcAttach first!", pin);
+    return false;
+  }
+  if (fade_lock == NULL) {
+    fade_lock = xSemaphoreCreateMutex();
+    if (fade_lock == NULL) {
+      log_e("xSemaphoreCreateMutex failed");
+      return false;
+    }
+  }
+  if (fade_timer == NULL) {
+    esp_timer_create_args_t timer_args = {
+      .callback = ledcFadeTick,
+      .arg = NULL,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "ledc_fade",
+      .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&timer_args, &fade_timer) != ESP_OK) {
+      log_e("esp_timer_create failed");
+      fade_timer = NULL;
+      return false;
+    }
+  }
+
+  //Fixing if all bits in resolution is set = LEDC FULL ON
+  uint32_t max_duty = (1 << bus->channel_resolution) - 1;
+
+  if ((target_duty >= max_duty) && (max_duty != 1)) {
+    target_duty = max_duty + 1;
+  }
+  if ((start_duty >= max_duty) && (max_duty != 1)) {
+    start_duty = max_duty + 1;
+  }
+
+  xSemaphoreTake(fade_lock, portMAX_DELAY);
+  if (!ledcStageDuty(bus->channel, bus->channel_resolution, start_duty)) {
+    xSemaphoreGive(fade_lock);
+    return false;
+  }
+  ledcLatchChannels(1UL << bus->channel);
+
+  ledc_scheduled_fade_t *fade = &scheduled_fades[bus->channel];
+  fade->start_duty = start_duty;
+  fade->target_duty = target_duty;
+  fade->duty = start_duty;
+  fade->start_us = esp_timer_get_time();
+  fade->duration_us = (int64_t)fade_time_ms * 1000;
+  fade->fn = userFunc;
+  fade->arg = arg;
+  if (!esp_timer_is_active(fade_timer) && esp_timer_start_periodic(fade_timer, LEDC_FADE_SCHEDULER_PERIOD_MS * 1000) != ESP_OK) {
+    log_e("esp_timer_start_periodic failed");
+    xSemaphoreGive(fade_lock);
+    return false;
+  }
+  fading_channels |= 1UL << bus->channel;
+  xSemaphoreGive(fade_lock);
+  return true;
+}
+
+bool ledcCancelScheduledFade(uint8_t pin) {
+  ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(pin, ESP32_BUS_TYPE_LEDC);
+  if (bus == NULL || fade_lock == NULL) {
+    return false;
+  }
+  xSemaphoreTake(fade_lock, portMAX_DELAY);
+  bool fading = fading_channels & (1UL << bus->channel);
+  ledcFadeRemoveChannels(1UL << bus->channel);
+  xSemaphoreGive(fade_lock);
+  return fading;
+}
+
+bool ledcScheduledFadeRunning(uint8_t pin) {
+  ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(pin, ESP32_BUS_TYPE_LEDC);
+  return bus != NULL && (fading_channels & (1UL << bus->channel));
+}
+
 #ifdef SOC_LEDC_GAMMA_CURVE_FADE_SUPPORTED
 // Default gamma factor for gamma correction (common value for LEDs)
 static float ledcGammaFactor = 2.8;
@@ -24,10 +24,16 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "hal/ledc_types.h"
 
+// Interval at which ledcScheduleFade() steps the duty of all running fades
+#ifndef LEDC_FADE_SCHEDULER_PERIOD_MS
+#define LEDC_FADE_SCHEDULER_PERIOD_MS 10
+#endif
+
 typedef enum {
   NOTE_C,
   NOTE_Cs,
@@ -125,6 +131,41 @@ bool ledcWrite(uint8_t pin, uint32_t duty);
  */
 bool ledcWriteChannel(uint8_t channel, uint32_t duty);
 
+/**
+ * @brief Stage the duty cycle of a given pin without applying it.
+ *        The output keeps its current duty until ledcWriteCommit() is called.
+ *
+ * @param pin GPIO pin
+ * @param duty duty cycle to stage
+ *
+ * @return true if duty cycle was successfully staged, false otherwise.
+ */
+bool ledcWriteStage(uint8_t pin, uint32_t duty);
+
+/**
+ * @brief Apply all duty cycles staged with ledcWriteStage() at once.
+ *
+ * Each channel switches to its new duty at the end of its current PWM period. The channels
+ * are latched one after the other, so channels running on the same timer (same group,
+ * frequency and resolution) usually change on the same PWM cycle. This is best effort:
+ * when a period ends while they are latched, some change one cycle later.
+ *
+ * @return true if staged duty cycles were applied, false if none were staged.
+ */
+bool ledcWriteCommit(void);
+
+/**
+ * @brief Set the duty cycle of several pins at once, same as ledcWriteStage() for
+ *        each pin followed by ledcWriteCommit().
+ *
+ * @param pins array of GPIO pins
+ * @param duties array of duty cycles, one per pin
+ * @param count number of pins
+ *
+ * @return true if all duty cycles were set, false otherwise (none are applied if a pin is not attached).
+ */
+bool ledcWriteMulti(const uint8_t *pins, const uint32_t *duties, size_t count);
+
 /**
  * @brief Sets the duty to 50 % PWM tone on selected frequency.
  *
@@ -239,6 +280,44 @@ bool ledcFadeWithInterrupt(uint8_t pin, uint32_t start_duty, uint32_t target_dut
  */
 bool ledcFadeWithInterruptArg(uint8_t pin, uint32_t start_duty, uint32_t target_duty, int max_fade_time_ms, void (*userFunc)(void *), void *arg);
 
+/**
+ * @brief Start a software fade on a given LEDC pin.
+ *
+ * All scheduled fades are stepped together by one timer every LEDC_FADE_SCHEDULER_PERIOD_MS
+ * and the new duties of each step are applied at once, so many channels can fade concurrently
+ * without the per channel fade interrupts of ledcFade(). A new fade on the same pin replaces
+ * the running one. Do not mix it with ledcFade() or ledcWrite() on the same pin while it runs.
+ *
+ * @param pin GPIO pin
+ * @param start_duty initial duty cycle of the fade
+ * @param target_duty target duty cycle of the fade
+ * @param fade_time_ms fade time in milliseconds
+ * @param userFunc function called from the timer task when the fade ends, may be NULL
+ * @param arg argument to be passed to the callback function
+ *
+ * @return true if fade was successfully started, false otherwise.
+ */
+bool ledcScheduleFade(uint8_t pin, uint32_t start_duty, uint32_t target_duty, uint32_t fade_time_ms, void (*userFunc)(void *), void *arg);
+
+/**
+ * @brief Stop the fade started by ledcScheduleFade() on a given LEDC pin.
+ *        The duty stays where the fade was, the callback is not called.
+ *
+ * @param pin GPIO pin
+ *
+ * @return true if a fade was running, false otherwise.
+ */
+bool ledcCancelScheduledFade(uint8_t pin);
+
+/**
+ * @brief Check if a fade started by ledcScheduleFade() is still running on a given LEDC pin.
+ *
+ * @param pin GPIO pin
+ *
+ * @return true if the fade is running, false otherwise.
+ */
+bool ledcScheduledFadeRunning(uint8_t pin);
+
 //Gamma Curve Fade functions - only available on supported chips
 #ifdef SOC_LEDC_GAMMA_CURVE_FADE_SUPPORTED
 
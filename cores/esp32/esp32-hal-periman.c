@@ -50,6 +50,9 @@ const char *perimanGetTypeName(peripheral_bus_type_t type) {
     case ESP32_BUS_TYPE_RMT_TX: return "RMT_TX";
     case ESP32_BUS_TYPE_RMT_RX: return "RMT_RX";
 #endif
+#if SOC_MCPWM_SUPPORTED
+    case ESP32_BUS_TYPE_MCPWM_CAP: return "MCPWM_CAP";
+#endif
 #if SOC_I2S_SUPPORTED
     case ESP32_BUS_TYPE_I2S_STD_MCLK:     return "I2S_STD_MCLK";
     case ESP32_BUS_TYPE_I2S_STD_BCLK:     return "I2S_STD_BCLK";
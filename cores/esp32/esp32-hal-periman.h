@@ -44,6 +44,9 @@ typedef enum {
   ESP32_BUS_TYPE_RMT_TX,  // IO is used as RMT output
   ESP32_BUS_TYPE_RMT_RX,  // IO is used as RMT input
 #endif
+#if SOC_MCPWM_SUPPORTED
+  ESP32_BUS_TYPE_MCPWM_CAP,  // IO is used as MCPWM capture input
+#endif
 #if SOC_I2S_SUPPORTED
   ESP32_BUS_TYPE_I2S_STD_MCLK,  // IO is used as I2S STD MCLK pin
   ESP32_BUS_TYPE_I2S_STD_BCLK,  // IO is used as I2S STD BCLK pin
@@ -0,0 +1,300 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp32-hal-pulse.h"
+
+#if SOC_MCPWM_SUPPORTED || SOC_RMT_SUPPORTED
+#include "esp32-hal.h"
+#include "esp32-hal-periman.h"
+#include "esp_heap_caps.h"
+
+#if SOC_MCPWM_SUPPORTED
+#include "driver/mcpwm_cap.h"
+#else
+#include "hal/rmt_ll.h"
+
+// 1 us RMT ticks. Pulses longer than the RX idle threshold (32767 or 65535 ticks) end the burst
+// and are not measured; without RX ping-pong a burst is limited to the channel memory
+#define PULSE_RMT_FREQ    1000000
+#define PULSE_RMT_SYMBOLS RMT_SYMBOLS_PER_CHANNEL_BLOCK
+#endif
+
+typedef struct {
+  uint8_t pin;
+  pulse_cb_t cb;
+  void *arg;
+  portMUX_TYPE mux;
+  pulse_info_t info;
+  uint8_t last_level;  // level of the last measured pulse, 0xFF if the next one is not adjacent
+#if SOC_MCPWM_SUPPORTED
+  int group;
+  bool have_edge;
+  uint32_t last_edge;
+  mcpwm_cap_channel_handle_t channel;
+#endif
+} pulse_obj_t;
+
+static pulse_obj_t *pulse_objs[SOC_GPIO_PIN_COUNT] = {NULL};
+
+static void ARDUINO_ISR_ATTR pulseDone(pulse_obj_t *obj, uint8_t level, uint32_t width, uint32_t end) {
+  portENTER_CRITICAL_ISR(&obj->mux);
+  if (level) {
+    obj->info.high = width;
+  } else {
+    obj->info.low = width;
+  }
+  if (obj->last_level == !level) {
+    obj->info.period = obj->info.high + obj->info.low;
+  }
+  obj->last_level = level;
+  obj->info.count++;
+  portEXIT_CRITICAL_ISR(&obj->mux);
+
+  if (obj->cb) {
+    pulse_event_t pulse = {.pin = obj->pin, .level = level, .width = width, .end = end};
+    obj->cb(&pulse, obj->arg);
+  }
+}
+
+#if SOC_MCPWM_SUPPORTED
+
+// one capture timer per MCPWM group, shared by its capture channels
+static mcpwm_cap_timer_handle_t pulse_timers[SOC_MCPWM_GROUPS] = {NULL};
+static uint8_t pulse_timer_users[SOC_MCPWM_GROUPS] = {0};
+static uint32_t pulse_resolution = 0;
+
+static bool ARDUINO_ISR_ATTR pulseOnCapture(mcpwm_cap_channel_handle_t channel, const mcpwm_capture_event_data_t *edata, void *user_ctx) {
+  pulse_obj_t *obj = (pulse_obj_t *)user_ctx;
+  uint32_t edge = edata->cap_value;
+  if (obj->have_edge) {
+    // a rising edge ends a low pulse
+    pulseDone(obj, edata->cap_edge == MCPWM_CAP_EDGE_NEG, edge - obj->last_edge, edge);
+  }
+  obj->have_edge = true;
+  obj->last_edge = edge;
+  return false;
+}
+
+static void pulseReleaseTimer(int group) {
+  if (--pulse_timer_users[group] == 0 && pulse_timers[group] != NULL) {
+    mcpwm_capture_timer_stop(pulse_timers[group]);
+    mcpwm_capture_timer_disable(pulse_timers[group]);
+    mcpwm_del_capture_timer(pulse_timers[group]);
+    pulse_timers[group] = NULL;
+  }
+}
+
+static bool pulseDetachBus(void *bus) {
+  pulse_obj_t *obj = (pulse_obj_t *)bus;
+  bool retCode = true;
+  if (obj->channel != NULL) {
+    mcpwm_capture_channel_disable(obj->channel);
+    if (mcpwm_del_capture_channel(obj->channel) != ESP_OK) {
+      log_e("Pin %u - mcpwm_del_capture_channel failed", obj->pin);
+      retCode = false;
+    }
+    pulseReleaseTimer(obj->group);
+  }
+  pulse_objs[obj->pin] = NULL;
+  free(obj);
+  return retCode;
+}
+
+static bool pulseStart(pulse_obj_t *obj) {
+  perimanSetBusDeinit(ESP32_BUS_TYPE_MCPWM_CAP, pulseDetachBus);
+  if (perimanGetPinBusType(obj->pin) != ESP32_BUS_TYPE_INIT && !perimanClearPinBus(obj->pin)) {
+    log_e("Pin %u could not be detached.", obj->pin);
+    return false;
+  }
+
+  // take the first group with a free capture channel
+  for (int group = 0; group < SOC_MCPWM_GROUPS; group++) {
+    if (pulse_timer_users[group] >= SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER) {
+      continue;
+    }
+    if (pulse_timers[group] == NULL) {
+      mcpwm_capture_timer_config_t timer_config = {
+        .group_id = group,
+        .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT,
+      };
+      if (mcpwm_new_capture_timer(&timer_config, &pulse_timers[group]) != ESP_OK) {
+        pulse_timers[group] = NULL;
+        continue;
+      }
+      mcpwm_capture_timer_get_resolution(pulse_timers[group], &pulse_resolution);
+      mcpwm_capture_timer_enable(pulse_timers[group]);
+      mcpwm_capture_timer_start(pulse_timers[group]);
+    }
+    pulse_timer_users[group]++;
+    obj->group = group;
+
+    mcpwm_capture_channel_config_t channel_config = {
+      .gpio_num = obj->pin,
+      .prescale = 1,
+      .flags = {.pos_edge = true, .neg_edge = true},
+    };
+    mcpwm_capture_event_callbacks_t callbacks = {.on_cap = pulseOnCapture};
+    if (mcpwm_new_capture_channel(pulse_timers[group], &channel_config, &obj->channel) != ESP_OK) {
+      obj->channel = NULL;
+      pulseReleaseTimer(group);
+      continue;
+    }
+    if (mcpwm_capture_channel_register_event_callbacks(obj->channel, &callbacks, obj) != ESP_OK
+        || mcpwm_capture_channel_enable(obj->channel) != ESP_OK) {
+      log_e("Pin %u - MCPWM capture channel setup failed", obj->pin);
+      mcpwm_del_capture_channel(obj->channel);
+      obj->channel = NULL;
+      pulseReleaseTimer(group);
+      return false;
+    }
+    if (!perimanSetPinBus(obj->pin, ESP32_BUS_TYPE_MCPWM_CAP, (void *)obj, group, -1)) {
+      pulseDetachBus((void *)obj);
+      return false;
+    }
+    return true;
+  }
+  log_e("Pin %u - No free MCPWM capture channel", obj->pin);
+  return false;
+}
+
+static pulse_obj_t *pulseGetObj(uint8_t pin) {
+  if (pin >= SOC_GPIO_PIN_COUNT) {
+    return NULL;
+  }
+  return (pulse_obj_t *)perimanGetPinBus(pin, ESP32_BUS_TYPE_MCPWM_CAP);
+}
+
+static void pulseStop(pulse_obj_t *obj) {
+  // frees obj through pulseDetachBus()
+  perimanClearPinBus(obj->pin);
+}
+
+uint32_t pulseMeasureResolution(uint8_t pin) {
+  return pulseGetObj(pin) != NULL ? pulse_resolution : 0;
+}
+
+#else /* RMT */
+
+static void ARDUINO_ISR_ATTR pulseOnFrame(const rmt_frame_t *frame, void *arg) {
+  pulse_obj_t *obj = (pulse_obj_t *)arg;
+  // the burst ended one idle threshold after its last edge, count back from there
+  uint32_t total = 0;
+  for (size_t i = 0; i < frame->num_symbols; i++) {
+    total += frame->symbols[i].duration0 + frame->symbols[i].duration1;
+  }
+  uint32_t end = (uint32_t)frame->timestamp_us - RMT_LL_MAX_IDLE_VALUE - total;
+
+  // the first pulse of a burst follows the idle line, not a measured pulse
+  obj->last_level = 0xFF;
+  for (size_t i = 0; i < frame->num_symbols; i++) {
+    const rmt_data_t *s = &frame->symbols[i];
+    // a zero duration is the idle time after the last edge
+    if (s->duration0 == 0) {
+      break;
+    }
+    end += s->duration0;
+    pulseDone(obj, s->level0, s->duration0, end);
+    if (s->duration1 == 0) {
+      break;
+    }
+    end += s->duration1;
+    pulseDone(obj, s->level1, s->duration1, end);
+  }
+}
+
+static bool pulseStart(pulse_obj_t *obj) {
+  if (!rmtInit(obj->pin, RMT_RX_MODE, RMT_MEM_NUM_BLOCKS_1, PULSE_RMT_FREQ)) {
+    return false;
+  }
+  if (!rmtBeginCapture(obj->pin, 2, PULSE_RMT_SYMBOLS, pulseOnFrame, obj)) {
+    rmtDeinit(obj->pin);
+    return false;
+  }
+  return true;
+}
+
+static void pulseStop(pulse_obj_t *obj) {
+  // also stops the capture
+  rmtDeinit(obj->pin);
+  pulse_objs[obj->pin] = NULL;
+  free(obj);
+}
+
+static pulse_obj_t *pulseGetObj(uint8_t pin) {
+  if (pin >= SOC_GPIO_PIN_COUNT || pulse_objs[pin] == NULL) {
+    return NULL;
+  }
+  // the RMT channel was released when the pin was attached to another peripheral
+  if (perimanGetPinBusType(pin) != ESP32_BUS_TYPE_RMT_RX) {
+    free(pulse_objs[pin]);
+    pulse_objs[pin] = NULL;
+    return NULL;
+  }
+  return pulse_objs[pin];
+}
+
+uint32_t pulseMeasureResolution(uint8_t pin) {
+  return pulseGetObj(pin) != NULL ? PULSE_RMT_FREQ : 0;
+}
+
+#endif /* SOC_MCPWM_SUPPORTED */
+
+bool pulseMeasureBegin(uint8_t pin, pulse_cb_t callback, void *arg) {
+  if (pin >= SOC_GPIO_PIN_COUNT) {
+    log_e("Invalid pin %u", pin);
+    return false;
+  }
+  pulseMeasureEnd(pin);
+
+  // the interrupt updates it
+  pulse_obj_t *obj = (pulse_obj_t *)heap_caps_calloc(1, sizeof(pulse_obj_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (obj == NULL) {
+    log_e("Pin %u - Memory allocation failed", pin);
+    return false;
+  }
+  obj->pin = pin;
+  obj->cb = callback;
+  obj->arg = arg;
+  obj->last_level = 0xFF;
+  portMUX_INITIALIZE(&obj->mux);
+  pulse_objs[pin] = obj;
+  if (!pulseStart(obj)) {
+    // pulseDetachBus() may have freed it already
+    if (pulse_objs[pin] != NULL) {
+      pulse_objs[pin] = NULL;
+      free(obj);
+    }
+    return false;
+  }
+  return true;
+}
+
+bool pulseMeasureRead(uint8_t pin, pulse_info_t *info, bool reset) {
+  pulse_obj_t *obj = pulseGetObj(pin);
+  if (obj == NULL || info == NULL) {
+    log_e("Pin %u is not measuring pulses", pin);
+    return false;
+  }
+  portENTER_CRITICAL(&obj->mux);
+  *info = obj->info;
+  if (reset) {
+    memset(&obj->info, 0, sizeof(pulse_info_t));
+    obj->last_level = 0xFF;
+  }
+  portEXIT_CRITICAL(&obj->mux);
+  return true;
+}
+
+bool pulseMeasureEnd(uint8_t pin) {
+  pulse_obj_t *obj = pulseGetObj(pin);
+  if (obj == NULL) {
+    return false;
+  }
+  pulseStop(obj);
+  return true;
+}
+
+#endif /* SOC_MCPWM_SUPPORTED || SOC_RMT_SUPPORTED */
@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "soc/soc_caps.h"
+#if SOC_MCPWM_SUPPORTED || SOC_RMT_SUPPORTED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Pulse measurement
+ *
+ * Unlike pulseIn(), which polls the pin until the pulse ends, the edges are timestamped by a
+ * peripheral and the widths are computed in its interrupt. Each measured pin uses a MCPWM
+ * capture channel, or a RMT RX channel on SoCs without MCPWM (ESP32-S2, ESP32-C3).
+ * Widths and timestamps are in ticks of pulseMeasureResolution(); with RMT the timestamps are
+ * derived from the end of each burst and only accurate to a few microseconds.
+ */
+
+typedef struct {
+  uint8_t pin;
+  uint8_t level;   // HIGH for a high pulse, which ended with a falling edge
+  uint32_t width;  // ticks
+  uint32_t end;    // timestamp of the edge that ended the pulse, wraps around
+} pulse_event_t;
+
+// called from the interrupt for every pulse, it shall be short and not block
+typedef void (*pulse_cb_t)(const pulse_event_t *pulse, void *arg);
+
+typedef struct {
+  uint32_t high;    // width of the last high pulse, ticks
+  uint32_t low;     // width of the last low pulse, ticks
+  uint32_t period;  // last high pulse plus the low pulse next to it, 0 until both were seen in a row
+  uint32_t count;   // pulses measured since pulseMeasureBegin()
+} pulse_info_t;
+
+// <callback> may be NULL when the results are polled with pulseMeasureRead()
+bool pulseMeasureBegin(uint8_t pin, pulse_cb_t callback, void *arg);
+bool pulseMeasureRead(uint8_t pin, pulse_info_t *info, bool reset);
+// ticks per second of the widths and timestamps, 0 if the pin is not measured
+uint32_t pulseMeasureResolution(uint8_t pin);
+bool pulseMeasureEnd(uint8_t pin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOC_MCPWM_SUPPORTED || SOC_RMT_SUPPORTED */
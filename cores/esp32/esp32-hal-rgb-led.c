@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "soc/soc_caps.h"
+#include <math.h>
+#include <string.h>
 
+#include "esp_heap_caps.h"
 #include "esp32-hal-rgb-led.h"
 
 // Backward compatibility - Deprecated. It will be removed in future releases.
@@ -96,3 +99,199 @@ void rgbLedWriteOrdered(uint8_t pin, rgb_led_color_order_t order, uint8_t red_va
   log_e("RMT is not supported on " CONFIG_IDF_TARGET);
 #endif /* SOC_RMT_SUPPORTED */
 }
+
+#if SOC_RMT_SUPPORTED
+
+// 10MHz RMT resolution, 0.1us per tick
+#define RGB_LED_STRIP_RMT_FREQ  10000000
+#define RGB_LED_STRIP_T0H       4     // 0.4us
+#define RGB_LED_STRIP_T0L       8     // 0.8us
+#define RGB_LED_STRIP_T1H       8     // 0.8us
+#define RGB_LED_STRIP_T1L       4     // 0.4us
+#define RGB_LED_STRIP_RESET_US  300   // newer WS2812B latch with more than 280us low
+#define RGB_LED_STRIP_BIT_NS    1200  // T0H + T0L
+
+struct rgb_led_strip_s {
+  uint8_t pin;
+  uint8_t bpp;           // bytes per LED, 3 or 4
+  uint8_t ofs[3];        // byte offset of red, green and blue within a LED
+  size_t num_leds;
+  size_t len;            // bytes of a frame
+  uint8_t *pixels;       // drawn by the sketch
+  uint8_t *frame;        // being sent, in internal RAM for the RMT interrupt
+  uint32_t timeout_ms;   // generous time to send one frame
+  uint8_t brightness;
+  float gamma;
+  bool linear;           // lut is the identity
+  uint8_t lut[256];      // gamma and brightness
+};
+
+static void _rgbLedStripUpdateLut(rgb_led_strip_t strip) {
+  strip->linear = (strip->brightness == 255 && strip->gamma == 1.0f);
+  for (int i = 0; i < 256; i++) {
+    float v = (strip->gamma == 1.0f) ? (float)i / 255.0f : powf((float)i / 255.0f, strip->gamma);
+    strip->lut[i] = (uint8_t)(v * strip->brightness + 0.5f);
+  }
+}
+
+rgb_led_strip_t rgbLedStripBegin(uint8_t pin, size_t num_leds, rgb_led_color_order_t order, bool rgbw) {
+  if (num_leds == 0) {
+    log_e("LED strip needs at least one LED");
+    return NULL;
+  }
+  // Verify if the pin used is RGB_BUILTIN and fix GPIO number
+#ifdef RGB_BUILTIN
+  pin = pin == RGB_BUILTIN ? pin - SOC_GPIO_PIN_COUNT : pin;
+#endif
+
+  rgb_led_strip_t strip = (rgb_led_strip_t)calloc(1, sizeof(struct rgb_led_strip_s));
+  if (strip == NULL) {
+    log_e("LED strip memory allocation failed");
+    return NULL;
+  }
+  strip->pin = pin;
+  strip->bpp = rgbw ? 4 : 3;
+  strip->num_leds = num_leds;
+  strip->len = num_leds * strip->bpp;
+  strip->brightness = 255;
+  strip->gamma = 1.0f;
+  _rgbLedStripUpdateLut(strip);
+
+  // position of red, green and blue within the bytes sent for a LED
+  static const uint8_t offsets[][3] = {
+    [LED_COLOR_ORDER_RGB] = {0, 1, 2}, [LED_COLOR_ORDER_BGR] = {2, 1, 0}, [LED_COLOR_ORDER_BRG] = {1, 2, 0},
+    [LED_COLOR_ORDER_RBG] = {0, 2, 1}, [LED_COLOR_ORDER_GBR] = {2, 0, 1}, [LED_COLOR_ORDER_GRB] = {1, 0, 2},
+  };
+  memcpy(strip->ofs, offsets[(order <= LED_COLOR_ORDER_GRB) ? order : LED_COLOR_ORDER_GRB], 3);
+
+  // bits of the frame plus reset time, doubled, at least 10ms
+  strip->timeout_ms = 10 + (uint32_t)(((uint64_t)strip->len * 8 * RGB_LED_STRIP_BIT_NS / 1000 + RGB_LED_STRIP_RESET_US) * 2 / 1000);
+
+  strip->pixels = (uint8_t *)calloc(1, strip->len);
+  strip->frame = (uint8_t *)heap_caps_calloc(1, strip->len, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (strip->pixels == NULL || strip->frame == NULL) {
+    log_e("LED strip frame buffers allocation failed (%u bytes)", (unsigned)strip->len);
+    goto fail;
+  }
+
+  if (!rmtInitDMA(pin, RGB_LED_STRIP_DMA_SYMBOLS, RGB_LED_STRIP_RMT_FREQ)) {
+    log_e("LED strip driver initialization failed for GPIO%u", pin);
+    goto fail;
+  }
+  rmt_data_t bit0 = {{RGB_LED_STRIP_T0H, 1, RGB_LED_STRIP_T0L, 0}};
+  rmt_data_t bit1 = {{RGB_LED_STRIP_T1H, 1, RGB_LED_STRIP_T1L, 0}};
+  rmt_data_t reset = {{RGB_LED_STRIP_RESET_US * 5, 0, RGB_LED_STRIP_RESET_US * 5, 0}};
+  if (!rmtSetBytesEncoder(pin, bit0, bit1, reset)) {
+    rmtDeinit(pin);
+    goto fail;
+  }
+  return strip;
+
+fail:
+  free(strip->pixels);
+  heap_caps_free(strip->frame);
+  free(strip);
+  return NULL;
+}
+
+void rgbLedStripEnd(rgb_led_strip_t strip) {
+  if (strip == NULL) {
+    return;
+  }
+  rmtWaitTransmitCompleted(strip->pin, strip->timeout_ms);
+  rmtDeinit(strip->pin);
+  free(strip->pixels);
+  heap_caps_free(strip->frame);
+  free(strip);
+}
+
+size_t rgbLedStripLength(rgb_led_strip_t strip) {
+  return strip ? strip->num_leds : 0;
+}
+
+void rgbLedStripSetPixel(rgb_led_strip_t strip, size_t index, uint8_t red_val, uint8_t green_val, uint8_t blue_val) {
+  if (strip == NULL || index >= strip->num_leds) {
+    return;
+  }
+  uint8_t *p = strip->pixels + index * strip->bpp;
+  p[strip->ofs[0]] = red_val;
+  p[strip->ofs[1]] = green_val;
+  p[strip->ofs[2]] = blue_val;
+}
+
+void rgbLedStripSetPixelW(rgb_led_strip_t strip, size_t index, uint8_t red_val, uint8_t green_val, uint8_t blue_val, uint8_t white_val) {
+  rgbLedStripSetPixel(strip, index, red_val, green_val, blue_val);
+  if (strip != NULL && strip->bpp == 4 && index < strip->num_leds) {
+    strip->pixels[index * 4 + 3] = white_val;
+  }
+}
+
+void rgbLedStripFill(rgb_led_strip_t strip, uint8_t red_val, uint8_t green_val, uint8_t blue_val) {
+  if (strip == NULL) {
+    return;
+  }
+  rgbLedStripSetPixel(strip, 0, red_val, green_val, blue_val);
+  // double the filled part until the buffer is full
+  size_t done = strip->bpp;
+  while (done < strip->len) {
+    size_t n = (done < strip->len - done) ? done : strip->len - done;
+    memcpy(strip->pixels + done, strip->pixels, n);
+    done += n;
+  }
+}
+
+void rgbLedStripClear(rgb_led_strip_t strip) {
+  if (strip != NULL) {
+    memset(strip->pixels, 0, strip->len);
+  }
+}
+
+uint8_t *rgbLedStripPixels(rgb_led_strip_t strip) {
+  return strip ? strip->pixels : NULL;
+}
+
+void rgbLedStripSetBrightness(rgb_led_strip_t strip, uint8_t brightness) {
+  if (strip != NULL && strip->brightness != brightness) {
+    strip->brightness = brightness;
+    _rgbLedStripUpdateLut(strip);
+  }
+}
+
+void rgbLedStripSetGamma(rgb_led_strip_t strip, float gamma) {
+  if (strip == NULL || gamma <= 0) {
+    return;
+  }
+  if (strip->gamma != gamma) {
+    strip->gamma = gamma;
+    _rgbLedStripUpdateLut(strip);
+  }
+}
+
+bool rgbLedStripShow(rgb_led_strip_t strip) {
+  if (strip == NULL) {
+    return false;
+  }
+  // the frame buffer is read by the RMT interrupt until the previous frame is out
+  if (!rmtWaitTransmitCompleted(strip->pin, strip->timeout_ms)) {
+    log_e("LED strip GPIO%u - previous frame not sent", strip->pin);
+    return false;
+  }
+  if (strip->linear) {
+    memcpy(strip->frame, strip->pixels, strip->len);
+  } else {
+    const uint8_t *lut = strip->lut;
+    for (size_t i = 0; i < strip->len; i++) {
+      strip->frame[i] = lut[strip->pixels[i]];
+    }
+  }
+  return rmtWriteBytesAsync(strip->pin, strip->frame, strip->len);
+}
+
+bool rgbLedStripWait(rgb_led_strip_t strip, uint32_t timeout_ms) {
+  if (strip == NULL) {
+    return false;
+  }
+  return rmtWaitTransmitCompleted(strip->pin, timeout_ms);
+}
+
+#endif /* SOC_RMT_SUPPORTED */
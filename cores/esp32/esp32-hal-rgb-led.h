@@ -29,6 +29,49 @@ void rgbLedWriteOrdered(uint8_t pin, rgb_led_color_order_t order, uint8_t red_va
 // Will use RGB_BUILTIN_LED_COLOR_ORDER
 void rgbLedWrite(uint8_t pin, uint8_t red_val, uint8_t green_val, uint8_t blue_val);
 
+/*
+ * LED strips (WS2812B and compatible)
+ *
+ * The strip keeps a frame buffer of 3 (GRB) or 4 (GRBW) bytes per LED and sends it with the
+ * bytes encoder of its RMT channel, with DMA where the SoC supports it. The symbols are generated
+ * while sending, so a strip of 600 LEDs needs 2 * 1800 bytes instead of 57 KB of RMT symbols.
+ *
+ * rgbLedStripShow() copies the pixels into the second buffer, applying brightness and gamma,
+ * and returns while the frame is sent, so the next frame can be drawn in the meantime.
+ * Every strip uses its own RMT TX channel, so several strips are sent in parallel.
+ */
+#if SOC_RMT_SUPPORTED
+
+// Size of the RMT DMA buffer of a strip in symbols (one per bit), where DMA is available
+#ifndef RGB_LED_STRIP_DMA_SYMBOLS
+#define RGB_LED_STRIP_DMA_SYMBOLS 1024
+#endif
+
+typedef struct rgb_led_strip_s *rgb_led_strip_t;
+
+// returns NULL on failure; rgbw adds a white byte after the three colors of each LED
+rgb_led_strip_t rgbLedStripBegin(uint8_t pin, size_t num_leds, rgb_led_color_order_t order, bool rgbw);
+void rgbLedStripEnd(rgb_led_strip_t strip);
+
+size_t rgbLedStripLength(rgb_led_strip_t strip);
+void rgbLedStripSetPixel(rgb_led_strip_t strip, size_t index, uint8_t red_val, uint8_t green_val, uint8_t blue_val);
+void rgbLedStripSetPixelW(rgb_led_strip_t strip, size_t index, uint8_t red_val, uint8_t green_val, uint8_t blue_val, uint8_t white_val);
+void rgbLedStripFill(rgb_led_strip_t strip, uint8_t red_val, uint8_t green_val, uint8_t blue_val);
+void rgbLedStripClear(rgb_led_strip_t strip);
+// the pixels in the color order of the strip, 3 or 4 bytes per LED, for drawing without the setters
+uint8_t *rgbLedStripPixels(rgb_led_strip_t strip);
+
+// applied by rgbLedStripShow() through a lookup table; 255 and 1.0 send the pixels unchanged
+void rgbLedStripSetBrightness(rgb_led_strip_t strip, uint8_t brightness);
+void rgbLedStripSetGamma(rgb_led_strip_t strip, float gamma);
+
+// waits for the previous frame, then starts sending the pixels and returns
+bool rgbLedStripShow(rgb_led_strip_t strip);
+// waits until the last frame is sent, including the reset time
+bool rgbLedStripWait(rgb_led_strip_t strip, uint32_t timeout_ms);
+
+#endif /* SOC_RMT_SUPPORTED */
+
 // Backward compatibility - Deprecated. It will be removed in future releases.
 [[deprecated("Use rgbLedWrite() instead.")]]
 void neopixelWrite(uint8_t p, uint8_t r, uint8_t g, uint8_t b);
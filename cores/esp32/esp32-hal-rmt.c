@@ -25,6 +25,7 @@
 #include "esp32-hal-rmt.h"
 #include "esp32-hal-periman.h"
 #include "esp_idf_version.h"
+#include "esp_timer.h"
 
 // Arduino Task Handle indicates if the Arduino Task has been started already
 extern TaskHandle_t loopTaskHandle;
@@ -33,6 +34,13 @@ extern TaskHandle_t loopTaskHandle;
 #define RMT_FLAG_RX_DONE (1)
 #define RMT_FLAG_TX_DONE (2)
 
+// Encoder used by _rmtWrite()
+typedef enum {
+  RMT_ENCODE_SYMBOLS,  // copy encoder, data is an array of rmt_data_t
+  RMT_ENCODE_BYTES,    // bytes encoder set by rmtSetBytesEncoder()
+  RMT_ENCODE_USER      // callback encoder set by rmtSetEncoder()
+} rmt_encode_type_t;
+
 /**
    Internal macros
 */
@@ -55,6 +63,10 @@ struct rmt_obj_s {
   // general RMT information
   rmt_channel_handle_t rmt_channel_h;       // IDF RMT channel handler
   rmt_encoder_handle_t rmt_copy_encoder_h;  // RMT simple copy encoder handle
+  rmt_encoder_handle_t rmt_bytes_encoder_h;  // RMT bytes encoder handle, set by rmtSetBytesEncoder()
+  rmt_encoder_handle_t rmt_user_encoder_h;   // RMT simple encoder handle, set by rmtSetEncoder()
+  rmt_encoder_cb_t user_encoder_cb;          // callback of the simple encoder
+  void *user_encoder_arg;
 
   uint32_t signal_range_min_ns;  // RX Filter data - Low Pass pulse width
   uint32_t signal_range_max_ns;  // RX idle time that defines end of reading
@@ -65,6 +77,21 @@ struct rmt_obj_s {
   rmt_reserve_memsize_t mem_size;  // RMT Memory size
   uint32_t frequency_Hz;           // RMT Frequency
   uint8_t rmt_EOT_Level;           // RMT End of Transmission Level - default is LOW
+  size_t dma_symbols;              // DMA buffer size requested by rmtInitDMA(), 0 for rmtInit()
+  uint32_t tx_pending;             // transmissions queued or running, RMT_FLAG_TX_DONE is set when it drops to zero
+  portMUX_TYPE tx_mux;             // protects tx_pending against the TX done callback
+
+  // continuous capture, see rmtBeginCapture()
+  rmt_data_t *capture_buf;              // capture_count buffers of capture_symbols each
+  size_t capture_symbols;
+  uint32_t capture_count;
+  int32_t capture_index;                // buffer being filled, -1 when not capturing
+  QueueHandle_t capture_frames;         // completed frames (rmt_frame_t) for rmtGetFrame()
+  QueueHandle_t capture_free;           // indices of the buffers free for receiving
+  rmt_frame_cb_t capture_cb;            // instead of capture_frames, called from the ISR
+  void *capture_arg;
+  uint32_t capture_overruns;            // frames dropped because no buffer was free
+  rmt_receive_config_t capture_config;  // to re-arm from the ISR
 
 #if !CONFIG_DISABLE_HAL_LOCKS
   SemaphoreHandle_t g_rmt_objlocks;  // Channel Semaphore Lock
@@ -78,14 +105,55 @@ typedef struct rmt_obj_s *rmt_bus_handle_t;
 */
 static SemaphoreHandle_t g_rmt_block_lock = NULL;
 
+// Bytes encoder followed by an optional reset symbol, e.g. the latch time of LED strips
+typedef struct {
+  rmt_encoder_t base;
+  rmt_encoder_handle_t bytes_encoder;
+  rmt_encoder_handle_t copy_encoder;
+  int state;
+  rmt_symbol_word_t reset_code;
+} rmt_bytes_reset_encoder_t;
+
 /**
    Internal method (private) declarations
 */
 
 // This is called from an IDF ISR code, therefore this code is part of an ISR
+static bool _rmt_capture_done(rmt_bus_handle_t bus, const rmt_rx_done_event_data_t *data) {
+  BaseType_t high_task_wakeup = pdFALSE;
+  uint32_t index = (uint32_t)bus->capture_index;
+  rmt_frame_t frame = {
+    .symbols = bus->capture_buf + index * bus->capture_symbols,
+    .num_symbols = data->num_symbols,
+    .timestamp_us = esp_timer_get_time(),
+    .index = index,
+  };
+  uint32_t next = index;
+  if (bus->capture_cb != NULL) {
+    // the buffer is handed back as soon as the callback returns
+    bus->capture_cb(&frame, bus->capture_arg);
+  } else if (xQueueReceiveFromISR(bus->capture_free, &next, &high_task_wakeup) == pdTRUE) {
+    xQueueSendFromISR(bus->capture_frames, &frame, &high_task_wakeup);
+  } else {
+    // no free buffer: drop the oldest waiting frame and reuse its buffer, or else this one
+    rmt_frame_t oldest;
+    if (xQueueReceiveFromISR(bus->capture_frames, &oldest, &high_task_wakeup) == pdTRUE) {
+      next = oldest.index;
+      xQueueSendFromISR(bus->capture_frames, &frame, &high_task_wakeup);
+    }
+    bus->capture_overruns++;
+  }
+  bus->capture_index = (int32_t)next;
+  rmt_receive(bus->rmt_channel_h, bus->capture_buf + next * bus->capture_symbols, bus->capture_symbols * sizeof(rmt_data_t), &bus->capture_config);
+  return high_task_wakeup == pdTRUE;
+}
+
 static bool _rmt_rx_done_callback(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *data, void *args) {
   BaseType_t high_task_wakeup = pdFALSE;
   rmt_bus_handle_t bus = (rmt_bus_handle_t)args;
+  if (bus->capture_index >= 0) {
+    return _rmt_capture_done(bus, data);
+  }
   // sets the returning number of RMT symbols (32 bits) effectively read
   *bus->num_symbols_read = data->num_symbols;
   // set RX event group and signal the received RMT symbols of that channel
@@ -98,12 +166,88 @@ static bool _rmt_rx_done_callback(rmt_channel_handle_t channel, const rmt_rx_don
 static bool _rmt_tx_done_callback(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *data, void *args) {
   BaseType_t high_task_wakeup = pdFALSE;
   rmt_bus_handle_t bus = (rmt_bus_handle_t)args;
-  // set RX event group and signal the received RMT symbols of that channel
+  bool idle;
+  portENTER_CRITICAL_ISR(&bus->tx_mux);
+  if (bus->tx_pending > 0) {
+    bus->tx_pending--;
+  }
+  idle = bus->tx_pending == 0;
+  portEXIT_CRITICAL_ISR(&bus->tx_mux);
+  if (!idle) {
+    // more queued transmissions follow
+    return false;
+  }
+  // set TX event group and signal that all transmissions of that channel are done
   xEventGroupSetBitsFromISR(bus->rmt_events, RMT_FLAG_TX_DONE, &high_task_wakeup);
   // A "need to yield" is returned in order to execute portYIELD_FROM_ISR() in the main IDF RX ISR
   return high_task_wakeup == pdTRUE;
 }
 
+// This is called from an IDF ISR code whenever the channel memory needs more symbols
+static size_t _rmt_encode_bytes_reset(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *data, size_t data_size, rmt_encode_state_t *ret_state) {
+  rmt_bytes_reset_encoder_t *enc = __containerof(encoder, rmt_bytes_reset_encoder_t, base);
+  rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+  int state = RMT_ENCODING_RESET;
+  size_t encoded_symbols = 0;
+  switch (enc->state) {
+    case 0:  // payload
+      encoded_symbols += enc->bytes_encoder->encode(enc->bytes_encoder, channel, data, data_size, &session_state);
+      if (session_state & RMT_ENCODING_COMPLETE) {
+        enc->state = 1;
+      }
+      if (session_state & RMT_ENCODING_MEM_FULL) {
+        state |= RMT_ENCODING_MEM_FULL;
+        goto out;
+      }
+    // fall through
+    case 1:  // reset symbol, if any
+      if (enc->reset_code.val == 0) {
+        enc->state = RMT_ENCODING_RESET;
+        state |= RMT_ENCODING_COMPLETE;
+        goto out;
+      }
+      encoded_symbols += enc->copy_encoder->encode(enc->copy_encoder, channel, &enc->reset_code, sizeof(enc->reset_code), &session_state);
+      if (session_state & RMT_ENCODING_COMPLETE) {
+        enc->state = RMT_ENCODING_RESET;
+        state |= RMT_ENCODING_COMPLETE;
+      }
+      if (session_state & RMT_ENCODING_MEM_FULL) {
+        state |= RMT_ENCODING_MEM_FULL;
+      }
+  }
+out:
+  *ret_state = (rmt_encode_state_t)state;
+  return encoded_symbols;
+}
+
+static esp_err_t _rmt_reset_bytes_reset(rmt_encoder_t *encoder) {
+  rmt_bytes_reset_encoder_t *enc = __containerof(encoder, rmt_bytes_reset_encoder_t, base);
+  rmt_encoder_reset(enc->bytes_encoder);
+  rmt_encoder_reset(enc->copy_encoder);
+  enc->state = RMT_ENCODING_RESET;
+  return ESP_OK;
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+// This is called from an IDF ISR code, it passes the channel memory on to the user callback
+static size_t _rmt_encode_user(const void *data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_symbol_word_t *symbols, bool *done, void *arg) {
+  rmt_bus_handle_t bus = (rmt_bus_handle_t)arg;
+  return bus->user_encoder_cb(data, data_size, symbols_written, symbols_free, (rmt_data_t *)symbols, done, bus->user_encoder_arg);
+}
+#endif
+
+static esp_err_t _rmt_del_bytes_reset(rmt_encoder_t *encoder) {
+  rmt_bytes_reset_encoder_t *enc = __containerof(encoder, rmt_bytes_reset_encoder_t, base);
+  if (enc->bytes_encoder) {
+    rmt_del_encoder(enc->bytes_encoder);
+  }
+  if (enc->copy_encoder) {
+    rmt_del_encoder(enc->copy_encoder);
+  }
+  free(enc);
+  return ESP_OK;
+}
+
 // This function must be called only after checking the pin and its bus with _rmtGetBus()
 static bool _rmtCheckDirection(uint8_t gpio_num, rmt_ch_dir_t rmt_dir, const char *labelFunc) {
   // gets bus RMT direction from the Peripheral Manager information
@@ -134,6 +278,25 @@ static rmt_bus_handle_t _rmtGetBus(int pin, const char *labelFunc) {
 }
 
 // Peripheral Manager detach callback
+// releases the buffers and queues of rmtBeginCapture(), the channel must not be receiving
+static void _rmtCaptureFree(rmt_bus_handle_t bus) {
+  bus->capture_index = -1;
+  if (bus->capture_frames != NULL) {
+    vQueueDelete(bus->capture_frames);
+    bus->capture_frames = NULL;
+  }
+  if (bus->capture_free != NULL) {
+    vQueueDelete(bus->capture_free);
+    bus->capture_free = NULL;
+  }
+  if (bus->capture_buf != NULL) {
+    heap_caps_free(bus->capture_buf);
+    bus->capture_buf = NULL;
+  }
+  bus->capture_cb = NULL;
+  bus->capture_arg = NULL;
+}
+
 static bool _rmtDetachBus(void *busptr) {
   // sanity check - it should never happen
   assert(busptr && "_rmtDetachBus bus NULL pointer.");
@@ -150,13 +313,25 @@ static bool _rmtDetachBus(void *busptr) {
     vEventGroupDelete(bus->rmt_events);
     bus->rmt_events = NULL;
   }
-  // deallocate the channel encoder
+  // deallocate the channel encoders
   if (bus->rmt_copy_encoder_h != NULL) {
     if (ESP_OK != rmt_del_encoder(bus->rmt_copy_encoder_h)) {
       log_w("RMT Encoder Deletion has failed.");
       retCode = false;
     }
   }
+  if (bus->rmt_bytes_encoder_h != NULL) {
+    if (ESP_OK != rmt_del_encoder(bus->rmt_bytes_encoder_h)) {
+      log_w("RMT Bytes Encoder Deletion has failed.");
+      retCode = false;
+    }
+  }
+  if (bus->rmt_user_encoder_h != NULL) {
+    if (ESP_OK != rmt_del_encoder(bus->rmt_user_encoder_h)) {
+      log_w("RMT User Encoder Deletion has failed.");
+      retCode = false;
+    }
+  }
   // disable and deallocate RMT channel
   if (bus->rmt_channel_h != NULL) {
     // force stopping rmt TX/RX processing and unlock Power Management (APB Freq)
@@ -166,6 +341,7 @@ static bool _rmtDetachBus(void *busptr) {
       retCode = false;
     }
   }
+  _rmtCaptureFree(bus);
 #if !CONFIG_DISABLE_HAL_LOCKS
   // deallocate channel semaphore
   if (bus->g_rmt_objlocks != NULL) {
@@ -286,7 +462,9 @@ bool rmtDeinit(int pin) {
   return false;
 }
 
-static bool _rmtWrite(int pin, rmt_data_t *data, size_t num_rmt_symbols, bool blocking, uint32_t loop, uint32_t timeout_ms) {
+// <encode> selects the encoder, with RMT_ENCODE_BYTES and RMT_ENCODE_USER <num_rmt_symbols> is the size of <data> in bytes
+// <queued> adds the transmission behind the ones still running instead of failing, up to RMT_TX_QUEUE_DEPTH
+static bool _rmtWrite(int pin, const void *data, size_t num_rmt_symbols, rmt_encode_type_t encode, bool blocking, bool queued, uint32_t loop, uint32_t timeout_ms) {
   rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
   if (bus == NULL) {
     return false;
@@ -294,6 +472,23 @@ static bool _rmtWrite(int pin, rmt_data_t *data, size_t num_rmt_symbols, bool bl
   if (!_rmtCheckDirection(pin, RMT_TX_MODE, __FUNCTION__)) {
     return false;
   }
+  rmt_encoder_handle_t encoder = bus->rmt_copy_encoder_h;
+  size_t data_size = num_rmt_symbols;
+  if (encode == RMT_ENCODE_BYTES) {
+    encoder = bus->rmt_bytes_encoder_h;
+    if (encoder == NULL) {
+      log_e("GPIO %d - No bytes encoder, call rmtSetBytesEncoder() first.", pin);
+      return false;
+    }
+  } else if (encode == RMT_ENCODE_USER) {
+    encoder = bus->rmt_user_encoder_h;
+    if (encoder == NULL) {
+      log_e("GPIO %d - No encoder, call rmtSetEncoder() first.", pin);
+      return false;
+    }
+  } else {
+    data_size = num_rmt_symbols * sizeof(rmt_data_t);
+  }
   bool loopCancel = false;  // user wants to cancel the writing loop mode
   if (data == NULL || num_rmt_symbols == 0) {
     if (!loop) {
@@ -322,10 +517,14 @@ static bool _rmtWrite(int pin, rmt_data_t *data, size_t num_rmt_symbols, bool bl
   }
 #endif
 
-  if ((xEventGroupGetBits(bus->rmt_events) & RMT_FLAG_TX_DONE) == 0) {
+  if (!queued && (xEventGroupGetBits(bus->rmt_events) & RMT_FLAG_TX_DONE) == 0) {
     log_v("GPIO %d - RMT Write still pending to be completed.", pin);
     return false;
   }
+  if (queued && bus->tx_pending >= RMT_TX_QUEUE_DEPTH) {
+    log_v("GPIO %d - RMT Write queue is full.", pin);
+    return false;
+  }
 
   rmt_transmit_config_t transmit_cfg;  // loop mode disabled
   memset((void *)&transmit_cfg, 0, sizeof(rmt_transmit_config_t));
@@ -339,6 +538,11 @@ static bool _rmtWrite(int pin, rmt_data_t *data, size_t num_rmt_symbols, bool bl
     // enable it again for looping or writing
     rmt_enable(bus->rmt_channel_h);
     bus->rmt_ch_is_looping = false;  // not looping anymore
+    // queued transmissions were dropped with the loop
+    portENTER_CRITICAL(&bus->tx_mux);
+    bus->tx_pending = 0;
+    portEXIT_CRITICAL(&bus->tx_mux);
+    xEventGroupSetBits(bus->rmt_events, RMT_FLAG_TX_DONE);
   }
   // sets the End of Transmission level to HIGH if the user has requested so
   if (bus->rmt_EOT_Level) {
@@ -354,12 +558,25 @@ static bool _rmtWrite(int pin, rmt_data_t *data, size_t num_rmt_symbols, bool bl
       // keeps RMT_FLAG_TX_DONE set - it never changes
     } else {
       // looping mode never sets this flag (IDF 5.1) in the callback
+      portENTER_CRITICAL(&bus->tx_mux);
+      bus->tx_pending++;
+      portEXIT_CRITICAL(&bus->tx_mux);
       xEventGroupClearBits(bus->rmt_events, RMT_FLAG_TX_DONE);
     }
     // transmits just once or looping data
-    if (ESP_OK != rmt_transmit(bus->rmt_channel_h, bus->rmt_copy_encoder_h, (const void *)data, num_rmt_symbols * sizeof(rmt_data_t), &transmit_cfg)) {
+    if (ESP_OK != rmt_transmit(bus->rmt_channel_h, encoder, data, data_size, &transmit_cfg)) {
       retCode = false;
       log_w("GPIO %d - RMT Transmission failed.", pin);
+      if (loop == 0) {
+        bool idle;
+        portENTER_CRITICAL(&bus->tx_mux);
+        bus->tx_pending--;
+        idle = bus->tx_pending == 0;
+        portEXIT_CRITICAL(&bus->tx_mux);
+        if (idle) {
+          xEventGroupSetBits(bus->rmt_events, RMT_FLAG_TX_DONE);
+        }
+      }
     } else {  // transmit OK
       if (loop > 0) {
         // rmt_ch_is_looping is used as a flag to indicate that RMT is in looping execution in order to
@@ -396,6 +613,11 @@ static bool _rmtRead(int pin, rmt_data_t *data, size_t *num_rmt_symbols, bool wa
   );
   bool retCode = true;
   RMT_MUTEX_LOCK(bus);
+  if (bus->capture_index >= 0) {
+    log_w("GPIO %d - RMT is capturing continuously, use rmtGetFrame() or call rmtEndCapture() first.", pin);
+    RMT_MUTEX_UNLOCK(bus);
+    return false;
+  }
 
   // request reading RMT Channel Data
   rmt_receive_config_t receive_config;
@@ -429,15 +651,15 @@ static bool _rmtRead(int pin, rmt_data_t *data, size_t *num_rmt_symbols, bool wa
 }
 
 bool rmtWrite(int pin, rmt_data_t *data, size_t num_rmt_symbols, uint32_t timeout_ms) {
-  return _rmtWrite(pin, data, num_rmt_symbols, true /*blocks*/, 0 /*looping*/, timeout_ms);
+  return _rmtWrite(pin, data, num_rmt_symbols, RMT_ENCODE_SYMBOLS, true /*blocks*/, false /*queued*/, 0 /*looping*/, timeout_ms);
 }
 
 bool rmtWriteAsync(int pin, rmt_data_t *data, size_t num_rmt_symbols) {
-  return _rmtWrite(pin, data, num_rmt_symbols, false /*blocks*/, 0 /*looping*/, 0 /*N/A*/);
+  return _rmtWrite(pin, data, num_rmt_symbols, RMT_ENCODE_SYMBOLS, false /*blocks*/, false /*queued*/, 0 /*looping*/, 0 /*N/A*/);
 }
 
 bool rmtWriteLooping(int pin, rmt_data_t *data, size_t num_rmt_symbols) {
-  return _rmtWrite(pin, data, num_rmt_symbols, false /*blocks*/, 1 /*looping*/, 0 /*N/A*/);
+  return _rmtWrite(pin, data, num_rmt_symbols, RMT_ENCODE_SYMBOLS, false /*blocks*/, false /*queued*/, 1 /*looping*/, 0 /*N/A*/);
 }
 
 // Same as rmtWriteLooping(...) but it transmits the data a fixed number of times ("loop_count").
@@ -449,11 +671,11 @@ bool rmtWriteRepeated(int pin, rmt_data_t *data, size_t num_rmt_symbols, uint32_
   }
   if (loop_count == 1) {
     // send the RMT symbols once using non-blocking write (single non-looping transmission)
-    return _rmtWrite(pin, data, num_rmt_symbols, false /*blocks*/, 0 /*looping*/, 0 /*N/A*/);
+    return _rmtWrite(pin, data, num_rmt_symbols, RMT_ENCODE_SYMBOLS, false /*blocks*/, false /*queued*/, 0 /*looping*/, 0 /*N/A*/);
   } else {
     // write the RMT symbols for loop_count times
 #if SOC_RMT_SUPPORT_TX_LOOP_COUNT
-    return _rmtWrite(pin, data, num_rmt_symbols, false /*blocks*/, loop_count /*looping*/, 0 /*N/A*/);
+    return _rmtWrite(pin, data, num_rmt_symbols, RMT_ENCODE_SYMBOLS, false /*blocks*/, false /*queued*/, loop_count /*looping*/, 0 /*N/A*/);
 #else
     log_e("RMT TX GPIO %d : Loop Count is not supported. Writing failed.", pin);
     return false;
@@ -461,6 +683,130 @@ bool rmtWriteRepeated(int pin, rmt_data_t *data, size_t num_rmt_symbols, uint32_
   }
 }
 
+bool rmtWriteBytes(int pin, const uint8_t *data, size_t len, uint32_t timeout_ms) {
+  return _rmtWrite(pin, data, len, RMT_ENCODE_BYTES, true /*blocks*/, false /*queued*/, 0 /*looping*/, timeout_ms);
+}
+
+bool rmtWriteBytesAsync(int pin, const uint8_t *data, size_t len) {
+  return _rmtWrite(pin, data, len, RMT_ENCODE_BYTES, false /*blocks*/, false /*queued*/, 0 /*looping*/, 0 /*N/A*/);
+}
+
+bool rmtWriteQueued(int pin, rmt_data_t *data, size_t num_rmt_symbols) {
+  return _rmtWrite(pin, data, num_rmt_symbols, RMT_ENCODE_SYMBOLS, false /*blocks*/, true /*queued*/, 0 /*looping*/, 0 /*N/A*/);
+}
+
+bool rmtWriteEncoded(int pin, const void *data, size_t size, uint32_t timeout_ms) {
+  return _rmtWrite(pin, data, size, RMT_ENCODE_USER, true /*blocks*/, false /*queued*/, 0 /*looping*/, timeout_ms);
+}
+
+bool rmtWriteEncodedQueued(int pin, const void *data, size_t size) {
+  return _rmtWrite(pin, data, size, RMT_ENCODE_USER, false /*blocks*/, true /*queued*/, 0 /*looping*/, 0 /*N/A*/);
+}
+
+bool rmtSetEncoder(int pin, rmt_encoder_cb_t callback, void *arg, size_t min_chunk_size) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return false;
+  }
+  if (!_rmtCheckDirection(pin, RMT_TX_MODE, __FUNCTION__)) {
+    return false;
+  }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+  bool retCode = true;
+  RMT_MUTEX_LOCK(bus);
+  if ((xEventGroupGetBits(bus->rmt_events) & RMT_FLAG_TX_DONE) == 0) {
+    log_w("GPIO %d - RMT Write still pending, can't change the encoder.", pin);
+    retCode = false;
+    goto end;
+  }
+  if (bus->rmt_user_encoder_h != NULL) {
+    rmt_del_encoder(bus->rmt_user_encoder_h);
+    bus->rmt_user_encoder_h = NULL;
+  }
+  bus->user_encoder_cb = callback;
+  bus->user_encoder_arg = arg;
+  if (callback != NULL) {
+    rmt_simple_encoder_config_t simple_cfg;
+    memset((void *)&simple_cfg, 0, sizeof(rmt_simple_encoder_config_t));
+    simple_cfg.callback = _rmt_encode_user;
+    simple_cfg.arg = bus;
+    simple_cfg.min_chunk_size = min_chunk_size;
+    if (rmt_new_simple_encoder(&simple_cfg, &bus->rmt_user_encoder_h) != ESP_OK) {
+      log_e("GPIO %d - RMT Encoder Memory Allocation error.", pin);
+      bus->rmt_user_encoder_h = NULL;
+      retCode = false;
+    }
+  }
+end:
+  RMT_MUTEX_UNLOCK(bus);
+  return retCode;
+#else
+  log_e("GPIO %d - RMT callback encoder requires ESP-IDF 5.3 or newer.", pin);
+  return false;
+#endif
+}
+
+bool rmtSetBytesEncoder(int pin, rmt_data_t bit0, rmt_data_t bit1, rmt_data_t reset) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return false;
+  }
+  if (!_rmtCheckDirection(pin, RMT_TX_MODE, __FUNCTION__)) {
+    return false;
+  }
+
+  rmt_bytes_reset_encoder_t *enc = (rmt_bytes_reset_encoder_t *)heap_caps_calloc(1, sizeof(rmt_bytes_reset_encoder_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (enc == NULL) {
+    log_e("GPIO %d - RMT Bytes Encoder Memory Allocation error.", pin);
+    return false;
+  }
+  enc->base.encode = _rmt_encode_bytes_reset;
+  enc->base.reset = _rmt_reset_bytes_reset;
+  enc->base.del = _rmt_del_bytes_reset;
+  enc->reset_code.val = reset.val;
+
+  rmt_bytes_encoder_config_t bytes_cfg;
+  memset((void *)&bytes_cfg, 0, sizeof(rmt_bytes_encoder_config_t));
+  bytes_cfg.bit0.val = bit0.val;
+  bytes_cfg.bit1.val = bit1.val;
+  bytes_cfg.flags.msb_first = 1;
+  rmt_copy_encoder_config_t copy_cfg;
+  memset((void *)&copy_cfg, 0, sizeof(rmt_copy_encoder_config_t));
+  if (rmt_new_bytes_encoder(&bytes_cfg, &enc->bytes_encoder) != ESP_OK || rmt_new_copy_encoder(&copy_cfg, &enc->copy_encoder) != ESP_OK) {
+    log_e("GPIO %d - RMT Bytes Encoder Memory Allocation error.", pin);
+    _rmt_del_bytes_reset(&enc->base);
+    return false;
+  }
+
+  bool retCode = true;
+  RMT_MUTEX_LOCK(bus);
+  if ((xEventGroupGetBits(bus->rmt_events) & RMT_FLAG_TX_DONE) == 0) {
+    log_w("GPIO %d - RMT Write still pending, can't change the encoder.", pin);
+    _rmt_del_bytes_reset(&enc->base);
+    retCode = false;
+  } else {
+    if (bus->rmt_bytes_encoder_h != NULL) {
+      rmt_del_encoder(bus->rmt_bytes_encoder_h);
+    }
+    bus->rmt_bytes_encoder_h = &enc->base;
+  }
+  RMT_MUTEX_UNLOCK(bus);
+  return retCode;
+}
+
+bool rmtWaitTransmitCompleted(int pin, uint32_t timeout_ms) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return false;
+  }
+  if (!_rmtCheckDirection(pin, RMT_TX_MODE, __FUNCTION__)) {
+    return false;
+  }
+  // no lock: the flag is only set by the TX done callback while waiting
+  return (xEventGroupWaitBits(bus->rmt_events, RMT_FLAG_TX_DONE, pdFALSE /* do not clear on exit */, pdFALSE /* wait for all bits */, timeout_ms) & RMT_FLAG_TX_DONE)
+         != 0;
+}
+
 bool rmtTransmitCompleted(int pin) {
   rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
   if (bus == NULL) {
@@ -501,10 +847,141 @@ bool rmtReceiveCompleted(int pin) {
   return retCode;
 }
 
-bool rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t mem_size, uint32_t frequency_Hz) {
+bool rmtBeginCapture(int pin, size_t num_buffers, size_t num_rmt_symbols, rmt_frame_cb_t callback, void *arg) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return false;
+  }
+  if (!_rmtCheckDirection(pin, RMT_RX_MODE, __FUNCTION__)) {
+    return false;
+  }
+  if (num_rmt_symbols == 0 || num_buffers < 2 || num_buffers > RMT_CAPTURE_MAX_BUFFERS) {
+    log_e("GPIO %d - RMT Capture needs 2 to %d buffers of at least one RMT Symbol.", pin, RMT_CAPTURE_MAX_BUFFERS);
+    return false;
+  }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+  if (!rmtEndCapture(pin)) {
+    return false;
+  }
+
+  bool retCode = false;
+  RMT_MUTEX_LOCK(bus);
+  // the ISR writes into the buffers and re-arms the channel, keep everything in internal RAM
+  bus->capture_buf = (rmt_data_t *)heap_caps_malloc(num_buffers * num_rmt_symbols * sizeof(rmt_data_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (bus->capture_buf == NULL) {
+    log_e("GPIO %d - RMT Capture buffer allocation fault.", pin);
+    goto out;
+  }
+  if (callback == NULL) {
+    bus->capture_frames = xQueueCreate(num_buffers, sizeof(rmt_frame_t));
+    bus->capture_free = xQueueCreate(num_buffers, sizeof(uint32_t));
+    if (bus->capture_frames == NULL || bus->capture_free == NULL) {
+      log_e("GPIO %d - RMT Capture queue allocation fault.", pin);
+      goto out;
+    }
+    // buffer 0 receives first, the others wait in the free queue
+    for (uint32_t i = 1; i < num_buffers; i++) {
+      xQueueSend(bus->capture_free, &i, 0);
+    }
+  }
+  bus->capture_symbols = num_rmt_symbols;
+  bus->capture_count = num_buffers;
+  bus->capture_cb = callback;
+  bus->capture_arg = arg;
+  bus->capture_overruns = 0;
+  memset((void *)&bus->capture_config, 0, sizeof(rmt_receive_config_t));
+  bus->capture_config.signal_range_min_ns = bus->signal_range_min_ns;
+  bus->capture_config.signal_range_max_ns = bus->signal_range_max_ns;
+
+  // resets the reading channel to start fresh
+  rmt_disable(bus->rmt_channel_h);
+  rmt_enable(bus->rmt_channel_h);
+  bus->capture_index = 0;
+  if (rmt_receive(bus->rmt_channel_h, bus->capture_buf, num_rmt_symbols * sizeof(rmt_data_t), &bus->capture_config) != ESP_OK) {
+    log_e("GPIO %d - rmt_receive failed.", pin);
+    goto out;
+  }
+  retCode = true;
+
+out:
+  if (!retCode) {
+    _rmtCaptureFree(bus);
+  }
+  RMT_MUTEX_UNLOCK(bus);
+  return retCode;
+#else
+  // older RMT drivers can't re-arm the receiver from the RX done callback
+  log_e("GPIO %d - RMT continuous capture requires ESP-IDF 5.3 or newer.", pin);
+  return false;
+#endif
+}
+
+bool rmtGetFrame(int pin, rmt_frame_t *frame, uint32_t timeout_ms) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return false;
+  }
+  if (frame == NULL) {
+    log_w("GPIO %d - RMT Frame NULL pointer.", pin);
+    return false;
+  }
+  // no mutex while waiting, so rmtReleaseFrame() can run from another task
+  QueueHandle_t frames = bus->capture_frames;
+  if (bus->capture_index < 0 || frames == NULL) {
+    log_w("GPIO %d - RMT is not capturing into the frame queue.", pin);
+    return false;
+  }
+  return xQueueReceive(frames, frame, timeout_ms) == pdTRUE;
+}
+
+bool rmtReleaseFrame(int pin, rmt_frame_t *frame) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return false;
+  }
+  if (frame == NULL || bus->capture_free == NULL || frame->index >= bus->capture_count) {
+    log_w("GPIO %d - RMT Frame is not part of the current capture.", pin);
+    return false;
+  }
+  // the free queue holds all buffers, so this never blocks
+  return xQueueSend(bus->capture_free, &frame->index, 0) == pdTRUE;
+}
+
+uint32_t rmtGetCaptureOverruns(int pin, bool reset) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return 0;
+  }
+  RMT_MUTEX_LOCK(bus);
+  uint32_t overruns = bus->capture_overruns;
+  if (reset) {
+    bus->capture_overruns = 0;
+  }
+  RMT_MUTEX_UNLOCK(bus);
+  return overruns;
+}
+
+bool rmtEndCapture(int pin) {
+  rmt_bus_handle_t bus = _rmtGetBus(pin, __FUNCTION__);
+  if (bus == NULL) {
+    return false;
+  }
+  RMT_MUTEX_LOCK(bus);
+  if (bus->capture_index >= 0) {
+    // stops the pending reception, so the ISR no longer touches the buffers
+    rmt_disable(bus->rmt_channel_h);
+    _rmtCaptureFree(bus);
+    rmt_enable(bus->rmt_channel_h);
+  }
+  RMT_MUTEX_UNLOCK(bus);
+  return true;
+}
+
+// <dma_symbols> > 0 requests a TX channel with DMA, <mem_size> is used when the SoC has no DMA for it
+static bool _rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t mem_size, size_t dma_symbols, uint32_t frequency_Hz) {
   log_v(
-    "GPIO %d - %s - MemSize[%u] - Freq=%" PRIu32 "Hz", pin, channel_direction == RMT_RX_MODE ? "RX MODE" : "TX MODE", mem_size * RMT_SYMBOLS_PER_CHANNEL_BLOCK,
-    frequency_Hz
+    "GPIO %d - %s - MemSize[%u] - DMA[%u] - Freq=%" PRIu32 "Hz", pin, channel_direction == RMT_RX_MODE ? "RX MODE" : "TX MODE",
+    mem_size * RMT_SYMBOLS_PER_CHANNEL_BLOCK, (unsigned)dma_symbols, frequency_Hz
   );
 
   // create common block mutex for protecting allocs from multiple threads allocating RMT channels
@@ -522,7 +999,7 @@ bool rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t mem_
   if (rmt_bus_type == ESP32_BUS_TYPE_RMT_TX || rmt_bus_type == ESP32_BUS_TYPE_RMT_RX) {
     rmt_ch_dir_t bus_rmt_dir = rmt_bus_type == ESP32_BUS_TYPE_RMT_TX ? RMT_TX_MODE : RMT_RX_MODE;
     bus = (rmt_bus_handle_t)perimanGetPinBus(pin, rmt_bus_type);
-    if (bus->frequency_Hz == frequency_Hz && bus_rmt_dir == channel_direction && bus->mem_size == mem_size) {
+    if (bus->frequency_Hz == frequency_Hz && bus_rmt_dir == channel_direction && bus->mem_size == mem_size && bus->dma_symbols == dma_symbols) {
       return true;  // already initialized with the same parameters
     }
   }
@@ -563,6 +1040,9 @@ bool rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t mem_
   // store the RMT Freq and mem_size to check Initialization, Filter and Idle valid values in the RMT API
   bus->frequency_Hz = frequency_Hz;
   bus->mem_size = mem_size;
+  bus->dma_symbols = dma_symbols;
+  portMUX_INITIALIZE(&bus->tx_mux);
+  bus->capture_index = -1;
   // pulses with width smaller than min_ns will be ignored (as a glitch)
   //bus->signal_range_min_ns = 0; // disabled  --> not necessary CALLOC set all to ZERO.
   // RMT stops reading if the input stays idle for longer than max_ns
@@ -587,7 +1067,7 @@ bool rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t mem_
     tx_cfg.clk_src = RMT_CLK_SRC_DEFAULT;
     tx_cfg.resolution_hz = frequency_Hz;
     tx_cfg.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL * mem_size;
-    tx_cfg.trans_queue_depth = 10;  // maximum allowed
+    tx_cfg.trans_queue_depth = RMT_TX_QUEUE_DEPTH;
     tx_cfg.flags.invert_out = 0;
     tx_cfg.flags.with_dma = 0;
 #if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(6, 0, 0)
@@ -598,7 +1078,21 @@ bool rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t mem_
     tx_cfg.intr_priority = 0;
 #endif
 
-    if (rmt_new_tx_channel(&tx_cfg, &bus->rmt_channel_h) != ESP_OK) {
+#if SOC_RMT_SUPPORT_DMA
+    if (dma_symbols > 0) {
+      // the DMA channel may be taken by another RMT channel, then use the channel memory
+      tx_cfg.mem_block_symbols = dma_symbols;
+      tx_cfg.flags.with_dma = 1;
+      if (rmt_new_tx_channel(&tx_cfg, &bus->rmt_channel_h) != ESP_OK) {
+        log_w("GPIO %d - RMT TX DMA not available, using %u symbols of channel memory.", pin, SOC_RMT_MEM_WORDS_PER_CHANNEL * mem_size);
+        bus->rmt_channel_h = NULL;
+        tx_cfg.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL * mem_size;
+        tx_cfg.flags.with_dma = 0;
+      }
+    }
+#endif
+
+    if (bus->rmt_channel_h == NULL && rmt_new_tx_channel(&tx_cfg, &bus->rmt_channel_h) != ESP_OK) {
       log_e("GPIO %d - RMT TX Initialization error.", pin);
       goto Err;
     }
@@ -685,4 +1179,16 @@ Err:
   return false;
 }
 
+bool rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t mem_size, uint32_t frequency_Hz) {
+  return _rmtInit(pin, channel_direction, mem_size, 0, frequency_Hz);
+}
+
+bool rmtInitDMA(int pin, size_t dma_symbols, uint32_t frequency_Hz) {
+  if (dma_symbols == 0) {
+    log_e("GPIO %d - DMA buffer size must not be zero.", pin);
+    return false;
+  }
+  return _rmtInit(pin, RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, dma_symbols, frequency_Hz);
+}
+
 #endif /* SOC_RMT_SUPPORTED */
@@ -72,6 +72,41 @@ typedef union {
 // Helper macro to calculate the number of RTM symbols in a array or type
 #define RMT_SYMBOLS_OF(x) (sizeof(x) / sizeof(rmt_data_t))
 
+// Number of transmissions rmtWriteQueued() and rmtWriteEncodedQueued() can hold per TX channel
+#define RMT_TX_QUEUE_DEPTH 10
+
+/**
+    Encoder callback, see rmtSetEncoder().
+    It is called from the RMT interrupt whenever the channel memory has room, with the <data> of the
+    transmission and the number of symbols produced for it so far. It writes up to <symbols_free>
+    symbols to <symbols>, returns their number and sets <*done> after the last one.
+    Returning 0 without setting <*done> means <symbols_free> is too small for the next chunk.
+*/
+typedef size_t (*rmt_encoder_cb_t)(const void *data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_data_t *symbols, bool *done, void *arg);
+
+// Maximum number of buffers rmtBeginCapture() can cycle through
+#define RMT_CAPTURE_MAX_BUFFERS 32
+
+/**
+    Frame received by the continuous capture, see rmtBeginCapture().
+    <symbols> points into the capture buffers and stays valid until the frame is handed back
+    with rmtReleaseFrame(). <timestamp_us> is the esp_timer time when the receiver detected
+    the end of the frame, so it lags the last edge by the RX idle threshold.
+*/
+typedef struct {
+  rmt_data_t *symbols;
+  size_t num_symbols;
+  int64_t timestamp_us;
+  uint32_t index;  // capture buffer holding the frame, used by rmtReleaseFrame()
+} rmt_frame_t;
+
+/**
+    Frame callback of rmtBeginCapture(), called from the RMT interrupt.
+    The buffer is received into again as soon as the callback returns, so it must copy or
+    decode what it needs from <frame> and be short. It shall not block.
+*/
+typedef void (*rmt_frame_cb_t)(const rmt_frame_t *frame, void *arg);
+
 /**
     Initialize the object
 
@@ -81,6 +116,15 @@ typedef union {
 */
 bool rmtInit(int pin, rmt_ch_dir_t channel_direction, rmt_reserve_memsize_t memsize, uint32_t frequency_Hz);
 
+/**
+    Initialize <pin> as TX channel that streams its symbols with DMA, using a buffer of <dma_symbols> symbols.
+    Long transmissions then need much less interrupt service to refill the channel memory.
+    When the SoC has no RMT DMA or it is used by another channel, the channel falls back to
+    RMT_MEM_NUM_BLOCKS_1 of channel memory.
+    Returns <true> on execution success, <false> otherwise
+*/
+bool rmtInitDMA(int pin, size_t dma_symbols, uint32_t frequency_Hz);
+
 /**
      Sets the End of Transmission level to be set for the <pin> when the RMT transmission ends.
      This function affects how rmtWrite(), rmtWriteAsync() or rmtWriteLooping() will set the pin after writing the data.
@@ -146,6 +190,56 @@ bool rmtWriteAsync(int pin, rmt_data_t *data, size_t num_rmt_symbols);
 bool rmtWriteLooping(int pin, rmt_data_t *data, size_t num_rmt_symbols);
 bool rmtWriteRepeated(int pin, rmt_data_t *data, size_t num_rmt_symbols, uint32_t loop_count);
 
+/**
+     Sending symbols in Queued Mode: same as rmtWriteAsync(), but if previous transmissions are
+     still running, this one is queued and follows them without a gap, up to RMT_TX_QUEUE_DEPTH.
+     Returns <false> when the queue is full. <data> must stay valid until it has been sent.
+     rmtTransmitCompleted() returns <true> once all queued transmissions are done.
+*/
+bool rmtWriteQueued(int pin, rmt_data_t *data, size_t num_rmt_symbols);
+
+/**
+     Sets an encoder callback for a TX <pin>: instead of a symbol array, rmtWriteEncoded() and
+     rmtWriteEncodedQueued() take the application's compact data (e.g. an IR command) and the
+     callback produces the symbols while sending, directly into the channel memory.
+     <min_chunk_size> is the smallest number of free symbols the callback is called with.
+     The callback runs in interrupt context: keep it short, and place it in IRAM (IRAM_ATTR) when
+     CONFIG_RMT_ISR_IRAM_SAFE is set. <callback> NULL removes the encoder.
+     Requires ESP-IDF 5.3 or newer.
+     Returns <true> on execution success, <false> otherwise, also while a transmission is running.
+*/
+bool rmtSetEncoder(int pin, rmt_encoder_cb_t callback, void *arg, size_t min_chunk_size);
+
+/**
+     Sending <size> bytes of <data> through the encoder callback, blocking up to <timeout_ms> like
+     rmtWrite(), or queued like rmtWriteQueued(). <data> must stay valid until it has been sent.
+*/
+bool rmtWriteEncoded(int pin, const void *data, size_t size, uint32_t timeout_ms);
+bool rmtWriteEncodedQueued(int pin, const void *data, size_t size);
+
+/**
+     Sets the bytes encoder of a TX <pin>, used by rmtWriteBytes() and rmtWriteBytesAsync().
+     Each bit of the data, MSB first, is sent as the symbol <bit0> or <bit1>, with no need to
+     build a symbol array in memory. <reset> is sent once after the data, e.g. the latch time
+     of LED strips; a <reset> with all fields zero sends nothing.
+     Returns <true> on execution success, <false> otherwise, also while a transmission is running.
+*/
+bool rmtSetBytesEncoder(int pin, rmt_data_t bit0, rmt_data_t bit1, rmt_data_t reset);
+
+/**
+     Sending <len> bytes of <data> through the bytes encoder, blocking up to <timeout_ms> or
+     Non-Blocking. Same behavior as rmtWrite() and rmtWriteAsync(); <data> must stay valid
+     until rmtTransmitCompleted() returns <true>.
+*/
+bool rmtWriteBytes(int pin, const uint8_t *data, size_t len, uint32_t timeout_ms);
+bool rmtWriteBytesAsync(int pin, const uint8_t *data, size_t len);
+
+/**
+     Waits up to <timeout_ms> for previous non-blocking or queued transmissions to finish.
+     Returns <true> when the channel is ready for new data, <false> on timeout.
+*/
+bool rmtWaitTransmitCompleted(int pin, uint32_t timeout_ms);
+
 /**
      Checks if transmission is completed and the rmtChannel ready for transmitting new data.
      To be ready for a new transmission, means that the previous transmission is completed.
@@ -199,6 +293,48 @@ bool rmtReadAsync(int pin, rmt_data_t *data, size_t *num_rmt_symbols);
 */
 bool rmtReceiveCompleted(int pin);
 
+/**
+     Starts receiving continuously on the RX channel <pin>: the receiver is re-armed from the interrupt
+     right after each frame, cycling through <num_buffers> (2 to RMT_CAPTURE_MAX_BUFFERS) buffers of
+     <num_rmt_symbols> RMT Symbols, so frames that arrive while the application processes the previous
+     one are not lost. The RX thresholds and filter in use when this is called apply to the whole capture.
+
+     When <callback> is NULL, completed frames wait in a queue for rmtGetFrame() and every frame must be
+     handed back with rmtReleaseFrame(). When all buffers are taken, the oldest frame waiting in the queue
+     is dropped, or the new one if the application holds all of them, and the overrun counter increments.
+     Otherwise <callback> gets each frame from the interrupt, together with <arg>.
+     rmtRead() and rmtReadAsync() fail while the capture runs.
+     Requires ESP-IDF 5.3 or newer.
+     Returns <true> when the capture has started, <false> otherwise.
+*/
+bool rmtBeginCapture(int pin, size_t num_buffers, size_t num_rmt_symbols, rmt_frame_cb_t callback, void *arg);
+
+/**
+     Waits up to <timeout_ms> for the next frame of the capture started by rmtBeginCapture() and
+     fills <*frame>. Frames are returned in the order they were received.
+     Returns <true> when a frame was received, <false> on time out or when no capture runs into the queue.
+*/
+bool rmtGetFrame(int pin, rmt_frame_t *frame, uint32_t timeout_ms);
+
+/**
+     Hands the buffer of a frame returned by rmtGetFrame() back to the capture.
+     Returns <true> on success, <false> if the frame does not belong to the running capture.
+*/
+bool rmtReleaseFrame(int pin, rmt_frame_t *frame);
+
+/**
+     Returns the number of frames dropped by the capture because no buffer was free, and sets the
+     counter to zero when <reset> is <true>.
+*/
+uint32_t rmtGetCaptureOverruns(int pin, bool reset);
+
+/**
+     Stops the capture started by rmtBeginCapture() and frees its buffers. Frames not yet released
+     become invalid. It shall not be called while another task waits in rmtGetFrame().
+     Returns <true> on success, <false> otherwise.
+*/
+bool rmtEndCapture(int pin);
+
 /**
    Function used to set a threshold (in ticks) used to consider that a data reception has ended.
    In receive mode, when no edge is detected on the input signal for longer than idle_thres_ticks
@@ -37,6 +37,8 @@
 
 #include "esp_system.h"
 #include "esp_intr_alloc.h"
+#include "esp_heap_caps.h"
+#include "driver/spi_master.h"
 
 #if CONFIG_IDF_TARGET_ESP32  // ESP32/PICO-D4
 #include "soc/dport_reg.h"
@@ -80,6 +82,9 @@
 #error Target CONFIG_IDF_TARGET is not supported
 #endif
 
+typedef struct spi_dma_struct_t spi_dma_t;
+typedef struct spi_waiter_struct_t spi_waiter_t;
+
 struct spi_struct_t {
   volatile spi_dev_t *dev;
 #if !CONFIG_DISABLE_HAL_LOCKS
@@ -96,6 +101,17 @@ struct spi_struct_t {
   uint32_t last_clock_div;  // Last clock divider calculated
   uint8_t last_clk_src;     // Last clock source selected (0=XTAL, 1=SPLL)
 #endif
+  spi_dma_t *dma;  // set by spiDmaBegin()
+  // settings last written by _spiApplySettings(), valid until something else touches the registers
+  bool cfg_valid;
+  uint8_t cfg_mode;
+  uint8_t cfg_order;
+  uint32_t cfg_clock;
+  // device arbitration, see spiDeviceAcquire()
+  portMUX_TYPE dev_mux;
+  spi_bus_device_t *dev_owner;
+  uint8_t dev_streak;
+  spi_waiter_t *waiters;
 };
 
 #if CONFIG_IDF_TARGET_ESP32S2
@@ -597,6 +613,7 @@ void spiSetClockDiv(spi_t *spi, uint32_t clockDiv) {
   }
   SPI_MUTEX_LOCK();
   _spiSetClockDivInternal(spi, clockDiv);
+  spi->cfg_valid = false;
   SPI_MUTEX_UNLOCK();
 }
 
@@ -622,11 +639,7 @@ uint8_t spiGetDataMode(spi_t *spi) {
   return SPI_MODE0;
 }
 
-void spiSetDataMode(spi_t *spi, uint8_t dataMode) {
-  if (!spi) {
-    return;
-  }
-  SPI_MUTEX_LOCK();
+static void _spiSetDataModeInternal(spi_t *spi, uint8_t dataMode) {
   switch (dataMode) {
     case SPI_MODE1:
 #if CONFIG_IDF_TARGET_ESP32
@@ -662,6 +675,15 @@ void spiSetDataMode(spi_t *spi, uint8_t dataMode) {
       spi->dev->user.ck_out_edge = 0;
       break;
   }
+}
+
+void spiSetDataMode(spi_t *spi, uint8_t dataMode) {
+  if (!spi) {
+    return;
+  }
+  SPI_MUTEX_LOCK();
+  _spiSetDataModeInternal(spi, dataMode);
+  spi->cfg_valid = false;
   SPI_MUTEX_UNLOCK();
 }
 
@@ -672,11 +694,7 @@ uint8_t spiGetBitOrder(spi_t *spi) {
   return (spi->dev->ctrl.wr_bit_order | spi->dev->ctrl.rd_bit_order) == 0;
 }
 
-void spiSetBitOrder(spi_t *spi, uint8_t bitOrder) {
-  if (!spi) {
-    return;
-  }
-  SPI_MUTEX_LOCK();
+static void _spiSetBitOrderInternal(spi_t *spi, uint8_t bitOrder) {
   if (SPI_MSBFIRST == bitOrder) {
     spi->dev->ctrl.wr_bit_order = 0;
     spi->dev->ctrl.rd_bit_order = 0;
@@ -684,6 +702,15 @@ void spiSetBitOrder(spi_t *spi, uint8_t bitOrder) {
     spi->dev->ctrl.wr_bit_order = 1;
     spi->dev->ctrl.rd_bit_order = 1;
   }
+}
+
+void spiSetBitOrder(spi_t *spi, uint8_t bitOrder) {
+  if (!spi) {
+    return;
+  }
+  SPI_MUTEX_LOCK();
+  _spiSetBitOrderInternal(spi, bitOrder);
+  spi->cfg_valid = false;
   SPI_MUTEX_UNLOCK();
 }
 
@@ -703,6 +730,7 @@ static void _on_apb_change(void *arg, apb_change_ev_t ev_type, uint32_t old_apb,
 #else
     spi->dev->clock.val = spiFrequencyToClockDiv(spi, old_apb / ((spi->dev->clock.clkdiv_pre + 1) * (spi->dev->clock.clkcnt_n + 1)));
 #endif
+    spi->cfg_valid = false;
     SPI_MUTEX_UNLOCK();
   }
 }
@@ -730,12 +758,16 @@ static void spiInitBus(spi_t *spi) {
   spi->dev->dma_conf.buf_afifo_rst = 1;
 #endif
   spi->dev->clock.val = 0;
+  spi->cfg_valid = false;
 }
 
 void spiStopBus(spi_t *spi) {
   if (!spi) {
     return;
   }
+  if (spi->dma) {
+    spiDmaEnd(spi);
+  }
 
   removeApbChangeCallback(spi, _on_apb_change);
 
@@ -756,6 +788,9 @@ spi_t *spiStartBus(uint8_t spi_num, uint32_t clockDiv, uint8_t dataMode, uint8_t
   perimanSetBusDeinit(ESP32_BUS_TYPE_SPI_MASTER_SS, spiDetachBus_SS);
 
   spi_t *spi = &_spi_bus_array[spi_num];
+  if (spi->dev_owner == NULL && spi->waiters == NULL) {
+    portMUX_INITIALIZE(&spi->dev_mux);
+  }
 
 #if !CONFIG_DISABLE_HAL_LOCKS
   if (spi->lock == NULL) {
@@ -1270,60 +1305,33 @@ void spiTransferBits(spi_t *spi, uint32_t data, uint32_t *out, uint8_t bits) {
     (var) = d[1] | (d[0] << 8) | (d[3] << 16) | (d[2] << 24); \
   }
 
-void spiTransaction(spi_t *spi, uint32_t clockDiv, uint8_t dataMode, uint8_t bitOrder) {
-  if (!spi) {
+// Write clock, mode and bit order unless the registers already hold exactly these settings,
+// so back-to-back transactions with the same settings cost no register accesses
+static void _spiApplySettings(spi_t *spi, uint32_t clockDiv, uint8_t dataMode, uint8_t bitOrder) {
+  if (spi->cfg_valid && spi->cfg_clock == clockDiv && spi->cfg_mode == dataMode && spi->cfg_order == bitOrder) {
     return;
   }
-  SPI_MUTEX_LOCK();
   // Set clock divider (handles ESP32P4 clock source selection if needed)
   _spiSetClockDivInternal(spi, clockDiv);
-  switch (dataMode) {
-    case SPI_MODE1:
-#if CONFIG_IDF_TARGET_ESP32
-      spi->dev->pin.ck_idle_edge = 0;
-#else
-      spi->dev->misc.ck_idle_edge = 0;
-#endif
-      spi->dev->user.ck_out_edge = 1;
-      break;
-    case SPI_MODE2:
-#if CONFIG_IDF_TARGET_ESP32
-      spi->dev->pin.ck_idle_edge = 1;
-#else
-      spi->dev->misc.ck_idle_edge = 1;
-#endif
-      spi->dev->user.ck_out_edge = 1;
-      break;
-    case SPI_MODE3:
-#if CONFIG_IDF_TARGET_ESP32
-      spi->dev->pin.ck_idle_edge = 1;
-#else
-      spi->dev->misc.ck_idle_edge = 1;
-#endif
-      spi->dev->user.ck_out_edge = 0;
-      break;
-    case SPI_MODE0:
-    default:
-#if CONFIG_IDF_TARGET_ESP32
-      spi->dev->pin.ck_idle_edge = 0;
-#else
-      spi->dev->misc.ck_idle_edge = 0;
-#endif
-      spi->dev->user.ck_out_edge = 0;
-      break;
-  }
-  if (SPI_MSBFIRST == bitOrder) {
-    spi->dev->ctrl.wr_bit_order = 0;
-    spi->dev->ctrl.rd_bit_order = 0;
-  } else if (SPI_LSBFIRST == bitOrder) {
-    spi->dev->ctrl.wr_bit_order = 1;
-    spi->dev->ctrl.rd_bit_order = 1;
-  }
+  _spiSetDataModeInternal(spi, dataMode);
+  _spiSetBitOrderInternal(spi, bitOrder);
 #if !defined(CONFIG_IDF_TARGET_ESP32) && !defined(CONFIG_IDF_TARGET_ESP32S2)
   // Sync new config with hardware, fixes https://github.com/espressif/arduino-esp32/issues/9221
   spi->dev->cmd.update = 1;
   while (spi->dev->cmd.update);
 #endif
+  spi->cfg_clock = clockDiv;
+  spi->cfg_mode = dataMode;
+  spi->cfg_order = bitOrder;
+  spi->cfg_valid = true;
+}
+
+void spiTransaction(spi_t *spi, uint32_t clockDiv, uint8_t dataMode, uint8_t bitOrder) {
+  if (!spi) {
+    return;
+  }
+  SPI_MUTEX_LOCK();
+  _spiApplySettings(spi, clockDiv, dataMode, bitOrder);
 }
 
 void spiSimpleTransaction(spi_t *spi) {
@@ -1731,6 +1739,671 @@ void ARDUINO_ISR_ATTR spiWritePixelsNL(spi_t *spi, const void *data_in, uint32_t
   }
 }
 
+/*
+ * Asynchronous DMA transfers
+ *
+ * The ESP-IDF SPI master driver runs the DMA transfers on the same peripheral. The pins stay
+ * routed through the GPIO matrix by this HAL; the registers used by the CPU transfers above are
+ * saved before the driver takes the bus and restored once all queued transfers are collected.
+ * */
+
+typedef struct {
+  spi_transaction_t trans;
+  spi_dma_cb_t cb;
+  void *arg;
+  uint16_t *staging;  // pixels in wire byte order, allocated by the first spiDmaQueuePixels()
+} spi_dma_slot_t;
+
+struct spi_dma_struct_t {
+  spi_host_device_t host;
+  spi_device_handle_t dev;
+  spi_dma_slot_t *slots;
+  uint32_t max_transfer;
+  uint32_t freq;
+  uint8_t data_mode;
+  uint8_t bit_order;
+  uint8_t queue_size;
+  uint8_t head;
+  uint8_t pending;
+  bool acquired;
+  // register state of the CPU transfers
+  uint32_t clock;
+  uint32_t user;
+  uint32_t user1;
+  uint32_t ctrl;
+  uint32_t pin;
+#if CONFIG_IDF_TARGET_ESP32S2 || CONFIG_IDF_TARGET_ESP32
+  uint32_t ctrl2;
+#endif
+};
+
+static bool spiDmaHost(spi_t *spi, spi_host_device_t *host) {
+#if CONFIG_IDF_TARGET_ESP32
+  if (spi->num == HSPI) {
+    *host = SPI2_HOST;
+    return true;
+  } else if (spi->num == VSPI) {
+    *host = SPI3_HOST;
+    return true;
+  }
+#else
+  if (spi->num == FSPI) {
+    *host = SPI2_HOST;
+    return true;
+  }
+#if SOC_SPI_PERIPH_NUM > 2
+  if (spi->num == HSPI) {
+    *host = SPI3_HOST;
+    return true;
+  }
+#endif
+#endif
+  return false;
+}
+
+static void spiDmaSaveRegs(spi_t *spi) {
+  spi_dma_t *dma = spi->dma;
+  dma->clock = spi->dev->clock.val;
+  dma->user = spi->dev->user.val;
+  dma->user1 = spi->dev->user1.val;
+  dma->ctrl = spi->dev->ctrl.val;
+#if CONFIG_IDF_TARGET_ESP32
+  dma->pin = spi->dev->pin.val;
+#else
+  dma->pin = spi->dev->misc.val;
+#endif
+#if CONFIG_IDF_TARGET_ESP32S2 || CONFIG_IDF_TARGET_ESP32
+  dma->ctrl2 = spi->dev->ctrl2.val;
+#endif
+}
+
+// The interrupt enable bits are left alone, the driver needs them for its next transfers
+static void spiDmaRestoreRegs(spi_t *spi) {
+  spi_dma_t *dma = spi->dma;
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+  // the driver may have switched the clock source for its own divider
+  PERIPH_RCC_ATOMIC() {
+    spi_ll_set_clk_source(spi->dev, spi->clk_src ? SPI_CLK_SRC_SPLL : SPI_CLK_SRC_XTAL);
+  }
+#endif
+  spi->dev->clock.val = dma->clock;
+  spi->dev->user.val = dma->user;
+  spi->dev->user1.val = dma->user1;
+  spi->dev->ctrl.val = dma->ctrl;
+#if CONFIG_IDF_TARGET_ESP32
+  spi->dev->pin.val = dma->pin;
+#else
+  spi->dev->misc.val = dma->pin;
+#endif
+#if CONFIG_IDF_TARGET_ESP32S2 || CONFIG_IDF_TARGET_ESP32
+  spi->dev->ctrl2.val = dma->ctrl2;
+#else
+  // the CPU transfers use the data buffer registers
+  spi->dev->dma_conf.dma_tx_ena = 0;
+  spi->dev->dma_conf.dma_rx_ena = 0;
+#endif
+}
+
+static void ARDUINO_ISR_ATTR spiDmaDone(spi_transaction_t *trans) {
+  spi_dma_slot_t *slot = (spi_dma_slot_t *)trans->user;
+  if (slot->cb) {
+    slot->cb(slot->arg);
+  }
+}
+
+static bool spiDmaAddDevice(spi_t *spi) {
+  spi_dma_t *dma = spi->dma;
+  spi_device_interface_config_t devcfg;
+  memset(&devcfg, 0, sizeof(spi_device_interface_config_t));
+  devcfg.mode = dma->data_mode;
+  devcfg.clock_speed_hz = dma->freq;
+  devcfg.spics_io_num = -1;  // chip select stays with the caller
+  devcfg.queue_size = dma->queue_size;
+  devcfg.flags = (dma->bit_order == SPI_LSBFIRST) ? SPI_DEVICE_BIT_LSBFIRST : 0;
+  devcfg.post_cb = spiDmaDone;
+  esp_err_t err = spi_bus_add_device(dma->host, &devcfg, &dma->dev);
+  if (err != ESP_OK) {
+    log_e("spi_bus_add_device failed: %d", err);
+    dma->dev = NULL;
+    return false;
+  }
+  return true;
+}
+
+// Take the bus for a batch of transfers with the current clock, mode and bit order
+static bool spiDmaAcquire(spi_t *spi) {
+  spi_dma_t *dma = spi->dma;
+  uint32_t freq = spiClockDivToFrequency(spi, spiGetClockDiv(spi));
+  uint8_t data_mode = spiGetDataMode(spi);
+  uint8_t bit_order = spiGetBitOrder(spi);
+  if (dma->dev == NULL || freq != dma->freq || data_mode != dma->data_mode || bit_order != dma->bit_order) {
+    if (dma->dev) {
+      spi_bus_remove_device(dma->dev);
+      dma->dev = NULL;
+    }
+    dma->freq = freq;
+    dma->data_mode = data_mode;
+    dma->bit_order = bit_order;
+    if (!spiDmaAddDevice(spi)) {
+      return false;
+    }
+  }
+  spiDmaSaveRegs(spi);
+  if (spi_device_acquire_bus(dma->dev, portMAX_DELAY) != ESP_OK) {
+    log_e("spi_device_acquire_bus failed");
+    spiDmaRestoreRegs(spi);
+    return false;
+  }
+  dma->acquired = true;
+  return true;
+}
+
+// Collect the oldest finished transfer
+static bool spiDmaCollect(spi_t *spi, TickType_t ticks) {
+  spi_dma_t *dma = spi->dma;
+  spi_transaction_t *trans = NULL;
+  if (spi_device_get_trans_result(dma->dev, &trans, ticks) != ESP_OK) {
+    return false;
+  }
+  dma->pending--;
+  return true;
+}
+
+bool spiDmaBegin(spi_t *spi, uint32_t max_transfer, uint8_t queue_size) {
+  if (!spi) {
+    return false;
+  }
+  if (spi->dma) {
+    return true;
+  }
+  spi_host_device_t host;
+  if (!spiDmaHost(spi, &host)) {
+    log_e("SPI bus %u does not support DMA transfers", spi->num);
+    return false;
+  }
+  if (queue_size == 0) {
+    queue_size = 1;
+  }
+  if (max_transfer == 0) {
+    max_transfer = SPI_DMA_MAX_TRANSFER;
+  }
+
+  spi_dma_t *dma = (spi_dma_t *)calloc(1, sizeof(spi_dma_t));
+  spi_dma_slot_t *slots = (spi_dma_slot_t *)calloc(queue_size, sizeof(spi_dma_slot_t));
+  if (!dma || !slots) {
+    log_e("Failed to allocate SPI DMA state");
+    free(dma);
+    free(slots);
+    return false;
+  }
+  dma->host = host;
+  dma->slots = slots;
+  dma->max_transfer = max_transfer;
+  dma->queue_size = queue_size;
+
+  // all pins -1: the driver leaves the GPIO matrix as this HAL set it up
+  spi_bus_config_t buscfg;
+  memset(&buscfg, 0, sizeof(spi_bus_config_t));
+  buscfg.mosi_io_num = -1;
+  buscfg.miso_io_num = -1;
+  buscfg.sclk_io_num = -1;
+  buscfg.quadwp_io_num = -1;
+  buscfg.quadhd_io_num = -1;
+  buscfg.data4_io_num = -1;
+  buscfg.data5_io_num = -1;
+  buscfg.data6_io_num = -1;
+  buscfg.data7_io_num = -1;
+  buscfg.max_transfer_sz = max_transfer;
+
+  SPI_MUTEX_LOCK();
+  spi->dma = dma;
+  spiDmaSaveRegs(spi);
+  // claiming the bus resets the peripheral
+  esp_err_t err = spi_bus_initialize(host, &buscfg, SPI_DMA_CH_AUTO);
+  if (err == ESP_OK) {
+    spiDmaRestoreRegs(spi);
+  }
+  SPI_MUTEX_UNLOCK();
+
+  if (err != ESP_OK) {
+    log_e("spi_bus_initialize failed: %d", err);
+    spi->dma = NULL;
+    free(slots);
+    free(dma);
+    return false;
+  }
+  return true;
+}
+
+void spiDmaEnd(spi_t *spi) {
+  if (!spi || !spi->dma) {
+    return;
+  }
+  spi_dma_t *dma = spi->dma;
+  spiDmaWait(spi, SPI_DMA_WAIT_FOREVER);
+
+  SPI_MUTEX_LOCK();
+  spiDmaSaveRegs(spi);
+  uint32_t clockDiv = dma->clock;
+  uint8_t dataMode = spiGetDataMode(spi);
+  uint8_t bitOrder = spiGetBitOrder(spi);
+  if (dma->dev) {
+    spi_bus_remove_device(dma->dev);
+  }
+  // also gates the peripheral clock
+  spi_bus_free(dma->host);
+  SPI_MUTEX_UNLOCK();
+
+  // bring the bus up again the way spiStartBus() left it, then restore what was set since
+  removeApbChangeCallback(spi, _on_apb_change);
+  spiStartBus(spi->num, clockDiv, dataMode, bitOrder);
+  SPI_MUTEX_LOCK();
+  spiDmaRestoreRegs(spi);
+  spi->dma = NULL;
+  SPI_MUTEX_UNLOCK();
+
+  for (uint8_t i = 0; i < dma->queue_size; i++) {
+    heap_caps_free(dma->slots[i].staging);
+  }
+  free(dma->slots);
+  free(dma);
+}
+
+// The next slot, once it is free
+static spi_dma_slot_t *spiDmaNextSlot(spi_t *spi) {
+  spi_dma_t *dma = spi->dma;
+  // all slots in flight: wait for the oldest, e.g. the other half of a double buffer
+  if (dma->pending == dma->queue_size && !spiDmaCollect(spi, portMAX_DELAY)) {
+    return NULL;
+  }
+  return &dma->slots[dma->head];
+}
+
+static bool spiDmaSubmit(spi_t *spi, spi_dma_slot_t *slot, const uint8_t *tx, uint8_t *rx, uint32_t len, spi_dma_cb_t cb, void *arg) {
+  spi_dma_t *dma = spi->dma;
+  memset(&slot->trans, 0, sizeof(spi_transaction_t));
+  slot->trans.length = len * 8;
+  slot->trans.rxlength = rx ? len * 8 : 0;
+  slot->trans.tx_buffer = tx;
+  slot->trans.rx_buffer = rx;
+  slot->trans.user = slot;
+  slot->cb = cb;
+  slot->arg = arg;
+  esp_err_t err = spi_device_queue_trans(dma->dev, &slot->trans, portMAX_DELAY);
+  if (err != ESP_OK) {
+    log_e("spi_device_queue_trans failed: %d", err);
+    return false;
+  }
+  dma->head = (dma->head + 1) % dma->queue_size;
+  dma->pending++;
+  return true;
+}
+
+bool spiDmaQueue(spi_t *spi, const void *data_in, void *data_out, uint32_t len, spi_dma_cb_t cb, void *arg) {
+  if (!spi || !spi->dma || !len || (!data_in && !data_out)) {
+    return false;
+  }
+  spi_dma_t *dma = spi->dma;
+  if (!dma->acquired && !spiDmaAcquire(spi)) {
+    return false;
+  }
+
+  const uint8_t *tx = (const uint8_t *)data_in;
+  uint8_t *rx = (uint8_t *)data_out;
+  while (len) {
+    uint32_t n = (len > dma->max_transfer) ? dma->max_transfer : len;
+    spi_dma_slot_t *slot = spiDmaNextSlot(spi);
+    // the callback reports the whole buffer, not the pieces of max_transfer
+    if (!slot || !spiDmaSubmit(spi, slot, tx, rx, n, (n == len) ? cb : NULL, arg)) {
+      return false;
+    }
+    if (tx) {
+      tx += n;
+    }
+    if (rx) {
+      rx += n;
+    }
+    len -= n;
+  }
+  return true;
+}
+
+bool spiDmaQueuePixels(spi_t *spi, const void *data, uint32_t len, spi_dma_cb_t cb, void *arg) {
+  if (!spi || !spi->dma || !data || !len) {
+    return false;
+  }
+  // LSB first sends the pixels in memory order already
+  if (spiGetBitOrder(spi) != SPI_MSBFIRST) {
+    return spiDmaQueue(spi, data, NULL, len, cb, arg);
+  }
+  spi_dma_t *dma = spi->dma;
+  uint32_t chunk = ((dma->max_transfer < SPI_DMA_PIXEL_CHUNK) ? dma->max_transfer : SPI_DMA_PIXEL_CHUNK) & ~1UL;
+  if (!chunk) {
+    log_e("DMA transfers of %u bytes can not carry pixels", (unsigned)dma->max_transfer);
+    return false;
+  }
+  if (!dma->acquired && !spiDmaAcquire(spi)) {
+    return false;
+  }
+
+  const uint16_t *pixels = (const uint16_t *)data;
+  while (len) {
+    uint32_t n = (len > chunk) ? chunk : len;
+    spi_dma_slot_t *slot = spiDmaNextSlot(spi);
+    if (!slot) {
+      return false;
+    }
+    if (!slot->staging) {
+      slot->staging = (uint16_t *)heap_caps_malloc(SPI_DMA_PIXEL_CHUNK, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+      if (!slot->staging) {
+        log_e("Failed to allocate the SPI DMA pixel buffer");
+        return false;
+      }
+    }
+    for (uint32_t i = 0; i < n / 2; i++) {
+      slot->staging[i] = __builtin_bswap16(pixels[i]);
+    }
+    if (n & 1) {
+      // odd length, the last byte goes out as it is
+      ((uint8_t *)slot->staging)[n - 1] = ((const uint8_t *)pixels)[n - 1];
+    }
+    if (!spiDmaSubmit(spi, slot, (const uint8_t *)slot->staging, NULL, n, (n == len) ? cb : NULL, arg)) {
+      return false;
+    }
+    pixels += n / 2;
+    len -= n;
+  }
+  return true;
+}
+
+bool spiDmaWait(spi_t *spi, uint32_t timeout_ms) {
+  if (!spi || !spi->dma) {
+    return false;
+  }
+  spi_dma_t *dma = spi->dma;
+  TickType_t ticks = (timeout_ms == SPI_DMA_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  while (dma->pending) {
+    if (!spiDmaCollect(spi, ticks)) {
+      return false;
+    }
+  }
+  if (dma->acquired) {
+    spi_device_release_bus(dma->dev);
+    spiDmaRestoreRegs(spi);
+    dma->acquired = false;
+  }
+  return true;
+}
+
+uint8_t spiDmaPending(spi_t *spi) {
+  if (!spi || !spi->dma) {
+    return 0;
+  }
+  spi_dma_t *dma = spi->dma;
+  while (dma->pending && spiDmaCollect(spi, 0));
+  return dma->pending;
+}
+
+void *spiDmaAlloc(size_t size) {
+  return heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+}
+
+void spiDmaFree(void *buffer) {
+  heap_caps_free(buffer);
+}
+
+/*
+ * Shared bus devices
+ *
+ * Every device keeps its clock divider, mode and bit order precomputed, so acquiring the bus only
+ * writes registers when another device, or spiTransaction() with other settings, used it since.
+ * Devices waiting for the bus are served by priority. Among waiters of the top priority the device
+ * that just released the bus goes first, up to SPI_DEVICE_MAX_BATCH times in a row, so tasks
+ * sharing one device keep running without switching settings in between.
+ * */
+
+struct spi_bus_device_struct_t {
+  spi_t *spi;
+  uint32_t freq;
+  uint32_t apb;  // APB frequency clock_div was computed for
+  uint32_t clock_div;
+  uint8_t data_mode;
+  uint8_t bit_order;
+  int8_t cs;
+  uint8_t priority;
+  bool selected;
+};
+
+// lives on the stack of the waiting task until it was granted the bus or gave up
+struct spi_waiter_struct_t {
+  spi_bus_device_t *dev;
+  spi_waiter_t *next;
+  SemaphoreHandle_t grant;
+  StaticSemaphore_t grant_buf;
+  bool granted;
+};
+
+static void spiDeviceUpdateClock(spi_bus_device_t *dev) {
+  dev->apb = getApbFrequency();
+  dev->clock_div = spiFrequencyToClockDiv(dev->spi, dev->freq);
+}
+
+// pass the bus to the next waiter or mark it free
+static void spiDeviceHandOver(spi_t *spi) {
+  spi_waiter_t *next = NULL;
+  portENTER_CRITICAL(&spi->dev_mux);
+  spi_bus_device_t *last = spi->dev_owner;
+  if (spi->waiters) {
+    spi_waiter_t **pick = &spi->waiters;
+    if (spi->dev_streak < SPI_DEVICE_MAX_BATCH) {
+      for (spi_waiter_t **w = &spi->waiters; *w && (*w)->dev->priority == spi->waiters->dev->priority; w = &(*w)->next) {
+        if ((*w)->dev == last) {
+          pick = w;
+          break;
+        }
+      }
+    }
+    next = *pick;
+    *pick = next->next;
+    next->granted = true;
+    spi->dev_streak = (next->dev == last) ? spi->dev_streak + 1 : 0;
+    spi->dev_owner = next->dev;
+  } else {
+    spi->dev_owner = NULL;
+    spi->dev_streak = 0;
+  }
+  portEXIT_CRITICAL(&spi->dev_mux);
+  if (next) {
+    xSemaphoreGive(next->grant);
+  }
+}
+
+spi_bus_device_t *spiDeviceAdd(spi_t *spi, uint32_t freq, uint8_t dataMode, uint8_t bitOrder, int8_t cs, uint8_t priority) {
+  if (!spi) {
+    return NULL;
+  }
+  spi_bus_device_t *dev = (spi_bus_device_t *)calloc(1, sizeof(spi_bus_device_t));
+  if (!dev) {
+    log_e("Failed to allocate SPI device");
+    return NULL;
+  }
+  dev->spi = spi;
+  dev->freq = freq;
+  dev->data_mode = dataMode;
+  dev->bit_order = bitOrder;
+  dev->cs = cs;
+  dev->priority = priority;
+  spiDeviceUpdateClock(dev);
+  if (cs >= 0) {
+    pinMode(cs, OUTPUT);
+    digitalWrite(cs, HIGH);
+  }
+  return dev;
+}
+
+void spiDeviceRemove(spi_bus_device_t *dev) {
+  if (!dev) {
+    return;
+  }
+  if (dev->spi->dev_owner == dev) {
+    log_e("SPI device still holds the bus");
+    return;
+  }
+  free(dev);
+}
+
+void spiDeviceSetFrequency(spi_bus_device_t *dev, uint32_t freq) {
+  if (!dev || dev->freq == freq) {
+    return;
+  }
+  dev->freq = freq;
+  spiDeviceUpdateClock(dev);
+  if (dev->spi->dev_owner == dev) {
+    _spiApplySettings(dev->spi, dev->clock_div, dev->data_mode, dev->bit_order);
+  }
+}
+
+bool spiDeviceAcquire(spi_bus_device_t *dev, uint32_t timeout_ms) {
+  if (!dev) {
+    return false;
+  }
+  spi_t *spi = dev->spi;
+  TickType_t start = xTaskGetTickCount();
+  TickType_t ticks = (timeout_ms == SPI_DEVICE_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+  portENTER_CRITICAL(&spi->dev_mux);
+  bool free_bus = (spi->dev_owner == NULL);
+  if (free_bus) {
+    spi->dev_owner = dev;
+  }
+  portEXIT_CRITICAL(&spi->dev_mux);
+
+  if (!free_bus) {
+    spi_waiter_t waiter = {.dev = dev};
+    waiter.grant = xSemaphoreCreateBinaryStatic(&waiter.grant_buf);
+    portENTER_CRITICAL(&spi->dev_mux);
+    free_bus = (spi->dev_owner == NULL);
+    if (free_bus) {
+      spi->dev_owner = dev;
+    } else {
+      // sorted by priority, first come first served within one priority
+      spi_waiter_t **w = &spi->waiters;
+      while (*w && (*w)->dev->priority >= dev->priority) {
+        w = &(*w)->next;
+      }
+      waiter.next = *w;
+      *w = &waiter;
+    }
+    portEXIT_CRITICAL(&spi->dev_mux);
+
+    if (!free_bus && xSemaphoreTake(waiter.grant, ticks) != pdTRUE) {
+      portENTER_CRITICAL(&spi->dev_mux);
+      bool granted = waiter.granted;
+      if (!granted) {
+        spi_waiter_t **w = &spi->waiters;
+        while (*w != &waiter) {
+          w = &(*w)->next;
+        }
+        *w = waiter.next;
+      }
+      portEXIT_CRITICAL(&spi->dev_mux);
+      if (!granted) {
+        vSemaphoreDelete(waiter.grant);
+        return false;
+      }
+      // handed over right at the timeout, the grant follows immediately
+      xSemaphoreTake(waiter.grant, portMAX_DELAY);
+    }
+    vSemaphoreDelete(waiter.grant);
+  }
+
+#if !CONFIG_DISABLE_HAL_LOCKS
+  // also wait for SPIClass transactions and pending DMA transfers on this bus
+  if (ticks != portMAX_DELAY) {
+    TickType_t spent = xTaskGetTickCount() - start;
+    ticks = (spent < ticks) ? ticks - spent : 0;
+  }
+  if (xSemaphoreTake(spi->lock, ticks) != pdTRUE) {
+    spiDeviceHandOver(spi);
+    return false;
+  }
+#else
+  (void)start;
+#endif
+  if (dev->apb != getApbFrequency()) {
+    spiDeviceUpdateClock(dev);
+  }
+  _spiApplySettings(spi, dev->clock_div, dev->data_mode, dev->bit_order);
+  return true;
+}
+
+void spiDeviceRelease(spi_bus_device_t *dev) {
+  if (!dev) {
+    return;
+  }
+  spi_t *spi = dev->spi;
+  if (dev->selected) {
+    spiDeviceSelect(dev, false);
+  }
+  SPI_MUTEX_UNLOCK();
+  spiDeviceHandOver(spi);
+}
+
+bool spiDeviceYield(spi_bus_device_t *dev, uint32_t timeout_ms) {
+  if (!dev) {
+    return false;
+  }
+  spi_t *spi = dev->spi;
+  portENTER_CRITICAL(&spi->dev_mux);
+  bool preempt = spi->waiters && spi->waiters->dev->priority > dev->priority;
+  portEXIT_CRITICAL(&spi->dev_mux);
+  if (!preempt) {
+    return true;
+  }
+  spiDeviceRelease(dev);
+  return spiDeviceAcquire(dev, timeout_ms);
+}
+
+void spiDeviceSelect(spi_bus_device_t *dev, bool select) {
+  if (!dev) {
+    return;
+  }
+  if (dev->cs >= 0) {
+    digitalWrite(dev->cs, select ? LOW : HIGH);
+  }
+  dev->selected = select;
+}
+
+bool spiDeviceTransfer(spi_bus_device_t *dev, const spi_device_trans_t *trans, size_t count, uint32_t timeout_ms) {
+  if (!dev || (!trans && count)) {
+    return false;
+  }
+  if (!spiDeviceAcquire(dev, timeout_ms)) {
+    return false;
+  }
+  spi_t *spi = dev->spi;
+  for (size_t i = 0; i < count; i++) {
+    if (!dev->selected) {
+      // a device with a higher priority may take over between two selections; once started,
+      // the rest of the list waits for the bus without a timeout
+      if (i && !spiDeviceYield(dev, SPI_DEVICE_WAIT_FOREVER)) {
+        return false;
+      }
+      spiDeviceSelect(dev, true);
+    }
+    if (trans[i].tx && !trans[i].rx) {
+      spiWriteNL(spi, trans[i].tx, trans[i].len);
+    } else {
+      spiTransferBytesNL(spi, trans[i].tx, (uint8_t *)trans[i].rx, trans[i].len);
+    }
+    if (!(trans[i].flags & SPI_DEVICE_KEEP_CS)) {
+      spiDeviceSelect(dev, false);
+    }
+  }
+  spiDeviceRelease(dev);
+  return true;
+}
+
 /*
  * Clock Calculators
  *
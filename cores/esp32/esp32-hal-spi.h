@@ -25,6 +25,7 @@ extern "C" {
 #include "sdkconfig.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #define SPI_HAS_TRANSACTION
 #ifdef CONFIG_IDF_TARGET_ESP32
@@ -137,6 +138,64 @@ uint32_t spiTransferLongNL(spi_t *spi, uint32_t data);
 void spiTransferBytesNL(spi_t *spi, const void *data_in, uint8_t *data_out, uint32_t len);
 void spiTransferBitsNL(spi_t *spi, uint32_t data_in, uint32_t *data_out, uint8_t bits);
 
+/*
+ * Asynchronous DMA transfers
+ * Queue and wait between spiTransaction()/spiSimpleTransaction() and spiEndTransaction(); the other
+ * transfer functions can be used again once spiDmaWait() returned true
+ * */
+#ifndef SPI_DMA_MAX_TRANSFER
+#define SPI_DMA_MAX_TRANSFER (32 * 1024)  // longer transfers are queued in pieces
+#endif
+#ifndef SPI_DMA_PIXEL_CHUNK
+#define SPI_DMA_PIXEL_CHUNK 4096  // bytes of the byte-swapped pixel buffer of every queue slot
+#endif
+#define SPI_DMA_WAIT_FOREVER 0xFFFFFFFF
+
+// called from the SPI interrupt when a queued transfer has finished
+typedef void (*spi_dma_cb_t)(void *arg);
+
+bool spiDmaBegin(spi_t *spi, uint32_t max_transfer, uint8_t queue_size);
+void spiDmaEnd(spi_t *spi);
+bool spiDmaQueue(spi_t *spi, const void *data_in, void *data_out, uint32_t len, spi_dma_cb_t cb, void *arg);
+// 16 bit pixels like spiWritePixelsNL(), data is left unchanged. MSB first the pixels are swapped into
+// buffers of the driver in pieces of SPI_DMA_PIXEL_CHUNK, then data can be reused once this returned
+bool spiDmaQueuePixels(spi_t *spi, const void *data, uint32_t len, spi_dma_cb_t cb, void *arg);
+bool spiDmaWait(spi_t *spi, uint32_t timeout_ms);
+uint8_t spiDmaPending(spi_t *spi);
+void *spiDmaAlloc(size_t size);
+void spiDmaFree(void *buffer);
+
+/*
+ * Shared bus devices
+ * Several devices on one bus, each with its own settings, chip select and priority. Use the NL
+ * transfer functions between spiDeviceAcquire() and spiDeviceRelease()
+ * */
+#ifndef SPI_DEVICE_MAX_BATCH
+#define SPI_DEVICE_MAX_BATCH 8  // bus grants in a row to one device while others of its priority wait
+#endif
+#define SPI_DEVICE_WAIT_FOREVER 0xFFFFFFFF
+#define SPI_DEVICE_KEEP_CS      0x01  // spi_device_trans_t flag: leave the device selected for the next entry
+
+typedef struct spi_bus_device_struct_t spi_bus_device_t;
+
+typedef struct {
+  const void *tx;  // NULL sends 0xFF
+  void *rx;        // NULL discards the received data
+  uint32_t len;
+  uint8_t flags;
+} spi_device_trans_t;
+
+spi_bus_device_t *spiDeviceAdd(spi_t *spi, uint32_t freq, uint8_t dataMode, uint8_t bitOrder, int8_t cs, uint8_t priority);
+void spiDeviceRemove(spi_bus_device_t *dev);
+void spiDeviceSetFrequency(spi_bus_device_t *dev, uint32_t freq);
+bool spiDeviceAcquire(spi_bus_device_t *dev, uint32_t timeout_ms);
+void spiDeviceRelease(spi_bus_device_t *dev);
+// release and acquire again if a device with a higher priority is waiting, call while deselected
+bool spiDeviceYield(spi_bus_device_t *dev, uint32_t timeout_ms);
+void spiDeviceSelect(spi_bus_device_t *dev, bool select);
+// run a list of transfers under one bus acquisition, the device is deselected after each entry
+bool spiDeviceTransfer(spi_bus_device_t *dev, const spi_device_trans_t *trans, size_t count, uint32_t timeout_ms);
+
 /*
  * Helper functions to translate frequency to clock divider and back
  * */
@@ -16,6 +16,7 @@
 
 #if SOC_GPTIMER_SUPPORTED
 #include "driver/gptimer.h"
+#include "esp_heap_caps.h"
 #if defined __has_include && __has_include("clk_tree.h")
 #include "clk_tree.h"
 #else
@@ -36,10 +37,35 @@ typedef struct {
   void *arg;
 } interrupt_config_t;
 
+// the alarm numbers in heap[] and num_scheduled are uint8_t
+_Static_assert(TIMER_MAX_ALARMS > 0 && TIMER_MAX_ALARMS <= 255, "TIMER_MAX_ALARMS must be 1 to 255");
+
+typedef struct {
+  void (*fn)(void *);
+  void *arg;
+  uint64_t deadline;  // counter value
+  uint64_t period;    // 0 for a one-shot
+  int16_t heap_pos;   // -1 when not scheduled
+  bool used;
+} timer_alarm_t;
+
+typedef struct {
+  portMUX_TYPE lock;
+  uint8_t num_scheduled;
+  uint64_t armed;  // deadline set in the hardware, UINT64_MAX if none
+  uint8_t heap[TIMER_MAX_ALARMS];
+  timer_alarm_t alarms[TIMER_MAX_ALARMS];
+  uint32_t fired;
+  uint32_t missed;
+  uint32_t max_latency;
+  uint64_t sum_latency;
+} timer_alarms_t;
+
 struct timer_struct_t {
   gptimer_handle_t timer_handle;
   interrupt_config_t interrupt_handle;
   bool timer_started;
+  timer_alarms_t *alarms;
 };
 
 inline TIMER_IRAM uint64_t timerRead(hw_timer_t *timer) {
@@ -65,9 +91,9 @@ void TIMER_IRAM timerWrite(hw_timer_t *timer, uint64_t val) {
 }
 
 void TIMER_IRAM timerAlarm(hw_timer_t *timer, uint64_t alarm_value, bool autoreload, uint64_t reload_count) {
-  if (timer == NULL) {
+  if (timer == NULL || timer->alarms != NULL) {
 #ifndef CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM
-    log_e("Timer handle is NULL");
+    log_e("Timer handle is NULL or the timer is used by multiplexed alarms");
 #endif
     return;
   }
@@ -161,6 +187,7 @@ hw_timer_t *timerBegin(uint32_t frequency) {
   };
 
   hw_timer_t *timer = malloc(sizeof(hw_timer_t));
+  timer->alarms = NULL;
 
   err = gptimer_new_timer(&config, &timer->timer_handle);
   if (err != ESP_OK) {
@@ -186,6 +213,7 @@ void timerEnd(hw_timer_t *timer) {
       log_e("Failed to destroy GPTimer, error num=%d", err);
       return;
     }
+    free(timer->alarms);
     free(timer);
   }
 }
@@ -208,6 +236,10 @@ void timerAttachInterruptFunctionalArg(hw_timer_t *timer, void (*userFunc)(void
     log_e("Timer handle is NULL");
     return;
   }
+  if (timer->alarms != NULL) {
+    log_e("Timer is used by multiplexed alarms");
+    return;
+  }
   esp_err_t err = ESP_OK;
   gptimer_event_callbacks_t cbs = {
     .on_alarm = timerFnWrapper,
@@ -243,6 +275,10 @@ void timerDetachInterrupt(hw_timer_t *timer) {
     log_e("Timer handle is NULL");
     return;
   }
+  if (timer->alarms != NULL) {
+    log_e("Timer is used by multiplexed alarms");
+    return;
+  }
   esp_err_t err = ESP_OK;
   err = gptimer_set_alarm_action(timer->timer_handle, NULL);
   timer->interrupt_handle.fn = NULL;
@@ -252,6 +288,257 @@ void timerDetachInterrupt(hw_timer_t *timer) {
   }
 }
 
+/*
+ * Multiplexed alarms
+ */
+
+static inline uint64_t IRAM_ATTR alarmDeadline(timer_alarms_t *a, int pos) {
+  return a->alarms[a->heap[pos]].deadline;
+}
+
+static void IRAM_ATTR alarmHeapSwap(timer_alarms_t *a, int i, int j) {
+  uint8_t tmp = a->heap[i];
+  a->heap[i] = a->heap[j];
+  a->heap[j] = tmp;
+  a->alarms[a->heap[i]].heap_pos = i;
+  a->alarms[a->heap[j]].heap_pos = j;
+}
+
+static void IRAM_ATTR alarmSiftUp(timer_alarms_t *a, int pos) {
+  while (pos > 0) {
+    int parent = (pos - 1) / 2;
+    if (alarmDeadline(a, parent) <= alarmDeadline(a, pos)) {
+      break;
+    }
+    alarmHeapSwap(a, parent, pos);
+    pos = parent;
+  }
+}
+
+static void IRAM_ATTR alarmSiftDown(timer_alarms_t *a, int pos) {
+  while (true) {
+    int left = 2 * pos + 1, right = left + 1, min = pos;
+    if (left < a->num_scheduled && alarmDeadline(a, left) < alarmDeadline(a, min)) {
+      min = left;
+    }
+    if (right < a->num_scheduled && alarmDeadline(a, right) < alarmDeadline(a, min)) {
+      min = right;
+    }
+    if (min == pos) {
+      break;
+    }
+    alarmHeapSwap(a, pos, min);
+    pos = min;
+  }
+}
+
+static void IRAM_ATTR alarmHeapPush(timer_alarms_t *a, uint8_t alarm) {
+  int pos = a->num_scheduled++;
+  a->heap[pos] = alarm;
+  a->alarms[alarm].heap_pos = pos;
+  alarmSiftUp(a, pos);
+}
+
+static void IRAM_ATTR alarmHeapRemove(timer_alarms_t *a, uint8_t alarm) {
+  int pos = a->alarms[alarm].heap_pos;
+  int last = --a->num_scheduled;
+  if (pos != last) {
+    a->heap[pos] = a->heap[last];
+    a->alarms[a->heap[pos]].heap_pos = pos;
+    alarmSiftDown(a, pos);
+    alarmSiftUp(a, pos);
+  }
+  a->alarms[alarm].heap_pos = -1;
+}
+
+// set the hardware alarm to the nearest deadline, an alarm already in the past fires right away
+static void IRAM_ATTR alarmArm(hw_timer_t *timer) {
+  timer_alarms_t *a = timer->alarms;
+  uint64_t next = a->num_scheduled ? alarmDeadline(a, 0) : UINT64_MAX;
+  if (next == a->armed) {
+    return;
+  }
+  a->armed = next;
+  if (next == UINT64_MAX) {
+    gptimer_set_alarm_action(timer->timer_handle, NULL);
+    return;
+  }
+  gptimer_alarm_config_t alarm_cfg = {
+    .alarm_count = next,
+    .reload_count = 0,
+    .flags.auto_reload_on_alarm = false,
+  };
+  gptimer_set_alarm_action(timer->timer_handle, &alarm_cfg);
+}
+
+static bool IRAM_ATTR alarmIsr(gptimer_handle_t handle, const gptimer_alarm_event_data_t *edata, void *args) {
+  hw_timer_t *timer = (hw_timer_t *)args;
+  timer_alarms_t *a = timer->alarms;
+  portENTER_CRITICAL_ISR(&a->lock);
+  a->armed = UINT64_MAX;
+  uint64_t now;
+  gptimer_get_raw_count(handle, &now);
+  while (a->num_scheduled && alarmDeadline(a, 0) <= now) {
+    uint8_t id = a->heap[0];
+    timer_alarm_t *alarm = &a->alarms[id];
+    uint32_t latency = (uint32_t)(now - alarm->deadline);
+    a->fired++;
+    a->sum_latency += latency;
+    if (latency > a->max_latency) {
+      a->max_latency = latency;
+    }
+
+    alarmHeapRemove(a, id);
+    if (alarm->period) {
+      // keep the phase of periodic alarms, skipping the periods that are already over
+      alarm->deadline += alarm->period;
+      if (alarm->deadline <= now) {
+        uint64_t skipped = (now - alarm->deadline) / alarm->period + 1;
+        alarm->deadline += skipped * alarm->period;
+        a->missed += skipped;
+      }
+      alarmHeapPush(a, id);
+    }
+
+    // the callback may schedule or cancel alarms, including its own
+    void (*fn)(void *) = alarm->fn;
+    void *arg = alarm->arg;
+    portEXIT_CRITICAL_ISR(&a->lock);
+    fn(arg);
+    portENTER_CRITICAL_ISR(&a->lock);
+    gptimer_get_raw_count(handle, &now);
+  }
+  alarmArm(timer);
+  portEXIT_CRITICAL_ISR(&a->lock);
+  return false;
+}
+
+int timerAddAlarm(hw_timer_t *timer, void (*userFunc)(void *), void *arg) {
+  if (timer == NULL || userFunc == NULL) {
+    log_e("Timer handle or callback is NULL");
+    return -1;
+  }
+  if (timer->alarms == NULL) {
+    // accessed from the interrupt
+    timer_alarms_t *a = (timer_alarms_t *)heap_caps_calloc(1, sizeof(timer_alarms_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (a == NULL) {
+      log_e("Alarm memory allocation failed");
+      return -1;
+    }
+    portMUX_INITIALIZE(&a->lock);
+    a->armed = UINT64_MAX;
+
+    gptimer_event_callbacks_t cbs = {
+      .on_alarm = alarmIsr,
+    };
+    if (timer->timer_started == true) {
+      gptimer_stop(timer->timer_handle);
+    }
+    gptimer_disable(timer->timer_handle);
+    gptimer_set_alarm_action(timer->timer_handle, NULL);
+    esp_err_t err = gptimer_register_event_callbacks(timer->timer_handle, &cbs, timer);
+    gptimer_enable(timer->timer_handle);
+    if (timer->timer_started == true) {
+      gptimer_start(timer->timer_handle);
+    }
+    if (err != ESP_OK) {
+      log_e("Timer alarm callback registration failed, error num=%d", err);
+      free(a);
+      return -1;
+    }
+    timer->interrupt_handle.fn = NULL;
+    timer->interrupt_handle.arg = NULL;
+    timer->alarms = a;
+  }
+
+  timer_alarms_t *a = timer->alarms;
+  int id = -1;
+  portENTER_CRITICAL(&a->lock);
+  for (int i = 0; i < TIMER_MAX_ALARMS; i++) {
+    if (!a->alarms[i].used) {
+      a->alarms[i].used = true;
+      a->alarms[i].fn = userFunc;
+      a->alarms[i].arg = arg;
+      a->alarms[i].heap_pos = -1;
+      id = i;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&a->lock);
+  if (id < 0) {
+    log_e("No free alarm (maximum %d)", TIMER_MAX_ALARMS);
+  }
+  return id;
+}
+
+void timerRemoveAlarm(hw_timer_t *timer, int alarm) {
+  if (timer == NULL || timer->alarms == NULL || alarm < 0 || alarm >= TIMER_MAX_ALARMS) {
+    return;
+  }
+  timer_alarms_t *a = timer->alarms;
+  portENTER_CRITICAL(&a->lock);
+  if (a->alarms[alarm].heap_pos >= 0) {
+    alarmHeapRemove(a, alarm);
+    alarmArm(timer);
+  }
+  a->alarms[alarm].used = false;
+  portEXIT_CRITICAL(&a->lock);
+}
+
+bool TIMER_IRAM timerScheduleAlarm(hw_timer_t *timer, int alarm, uint64_t delay, uint64_t period) {
+  if (timer == NULL || timer->alarms == NULL || alarm < 0 || alarm >= TIMER_MAX_ALARMS || !timer->alarms->alarms[alarm].used) {
+    return false;
+  }
+  timer_alarms_t *a = timer->alarms;
+  uint64_t now;
+  portENTER_CRITICAL_SAFE(&a->lock);
+  gptimer_get_raw_count(timer->timer_handle, &now);
+  if (a->alarms[alarm].heap_pos >= 0) {
+    alarmHeapRemove(a, alarm);
+  }
+  a->alarms[alarm].deadline = now + delay;
+  a->alarms[alarm].period = period;
+  alarmHeapPush(a, alarm);
+  alarmArm(timer);
+  portEXIT_CRITICAL_SAFE(&a->lock);
+  return true;
+}
+
+bool TIMER_IRAM timerCancelAlarm(hw_timer_t *timer, int alarm) {
+  if (timer == NULL || timer->alarms == NULL || alarm < 0 || alarm >= TIMER_MAX_ALARMS) {
+    return false;
+  }
+  timer_alarms_t *a = timer->alarms;
+  portENTER_CRITICAL_SAFE(&a->lock);
+  bool scheduled = a->alarms[alarm].heap_pos >= 0;
+  if (scheduled) {
+    alarmHeapRemove(a, alarm);
+    alarmArm(timer);
+  }
+  portEXIT_CRITICAL_SAFE(&a->lock);
+  return scheduled;
+}
+
+bool timerGetAlarmStats(hw_timer_t *timer, timer_alarm_stats_t *stats, bool reset) {
+  if (timer == NULL || timer->alarms == NULL || stats == NULL) {
+    return false;
+  }
+  timer_alarms_t *a = timer->alarms;
+  portENTER_CRITICAL(&a->lock);
+  stats->fired = a->fired;
+  stats->missed = a->missed;
+  stats->max_latency = a->max_latency;
+  stats->avg_latency = a->fired ? (uint32_t)(a->sum_latency / a->fired) : 0;
+  if (reset) {
+    a->fired = 0;
+    a->missed = 0;
+    a->max_latency = 0;
+    a->sum_latency = 0;
+  }
+  portEXIT_CRITICAL(&a->lock);
+  return true;
+}
+
 uint64_t timerReadMicros(hw_timer_t *timer) {
   if (timer == NULL) {
     log_e("Timer handle is NULL");
@@ -29,9 +29,21 @@
 extern "C" {
 #endif
 
+// Alarms that can be multiplexed on one timer by timerAddAlarm()
+#ifndef TIMER_MAX_ALARMS
+#define TIMER_MAX_ALARMS 32
+#endif
+
 struct timer_struct_t;
 typedef struct timer_struct_t hw_timer_t;
 
+typedef struct {
+  uint32_t fired;        // callbacks run
+  uint32_t missed;       // periods skipped because a periodic alarm was served too late
+  uint32_t max_latency;  // largest delay from the alarm to the start of its callback, in timer ticks
+  uint32_t avg_latency;  // in timer ticks
+} timer_alarm_stats_t;
+
 hw_timer_t *timerBegin(uint32_t frequency);
 void timerEnd(hw_timer_t *timer);
 
@@ -53,6 +65,22 @@ void timerDetachInterrupt(hw_timer_t *timer);
 
 void timerAlarm(hw_timer_t *timer, uint64_t alarm_value, bool autoreload, uint64_t reload_count);
 
+/*
+ * Multiplexed alarms: many one-shot and periodic deadlines on the same timer. Deadlines are kept
+ * in a min-heap and the hardware alarm is set to the nearest one. The first timerAddAlarm() takes
+ * over the timer interrupt, timerAlarm() and timerAttachInterrupt() can not be used with it anymore.
+ * The counter must keep running up from where it is, do not write or restart it.
+ * Callbacks run in the timer interrupt. Scheduling and cancelling may be called from any ISR.
+ */
+// returns the id of the new alarm, -1 on error
+int timerAddAlarm(hw_timer_t *timer, void (*userFunc)(void *), void *arg);
+void timerRemoveAlarm(hw_timer_t *timer, int alarm);
+// <delay> and <period> are in timer ticks, <period> 0 for a one-shot; reschedules a scheduled alarm
+bool timerScheduleAlarm(hw_timer_t *timer, int alarm, uint64_t delay, uint64_t period);
+// returns true if the alarm was scheduled
+bool timerCancelAlarm(hw_timer_t *timer, int alarm);
+bool timerGetAlarmStats(hw_timer_t *timer, timer_alarm_stats_t *stats, bool reset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,7 @@
 
 #include "esp32-hal-touch-ng.h"
 #include "esp32-hal-periman.h"
+#include "esp_timer.h"
 
 /*
     Internal Private Touch Data Structure and Functions
@@ -77,6 +78,31 @@ static touch_channel_handle_t touch_channel_handle[SOC_TOUCH_SENSOR_NUM] = {};
 // Active threshold to benchmark ratio. (i.e., touch will be activated when data >= benchmark * (1 + ratio))
 static float s_thresh2bm_ratio = 0.015f;  // 1.5% for all channels
 
+// Background scan, see touchScanBegin()
+typedef struct {
+  touch_channel_state_t state;
+  uint8_t pad;
+  bool started;       // false until the first value seeds the filters
+  uint8_t debounce;   // consecutive scans disagreeing with the pressed state
+  int64_t change_us;  // first of these scans
+  int64_t baseline;   // filter accumulators, scaled by 2^shift
+  int64_t noise;
+} touch_scan_channel_t;
+
+static touch_scan_channel_t scan_channels[SOC_TOUCH_SENSOR_NUM];
+static size_t scan_count = 0;
+static touch_event_cb_t scan_cb = NULL;
+static void *scan_cb_arg = NULL;
+static esp_timer_handle_t scan_timer = NULL;
+static SemaphoreHandle_t scan_lock = NULL;
+
+static uint32_t scan_passes = 0;
+static uint32_t scan_events = 0;
+static uint32_t scan_max_us = 0;
+static uint64_t scan_sum_us = 0;
+static uint32_t scan_max_latency_us = 0;
+static int64_t scan_stats_since_us = 0;
+
 static bool ARDUINO_ISR_ATTR __touchOnActiveISR(touch_sensor_handle_t sens_handle, const touch_active_event_data_t *event, void *user_ctx) {
   uint8_t pad_num = (uint8_t)event->chan_id;
   __touchInterruptHandlers[pad_num].lastStatusIsPressed = true;
@@ -214,7 +240,14 @@ bool touchBenchmarkThreshold(uint8_t pad) {
 
 static bool touchDetachBus(void *pin) {
   int8_t pad = digitalPinToTouchChannel((int)(pin - 1));
+  // the background scan stops reading the channel before it is deleted
+  if (scan_lock != NULL) {
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+  }
   channels_initialized[pad] = false;
+  if (scan_lock != NULL) {
+    xSemaphoreGive(scan_lock);
+  }
   //disable touch pad and delete the channel
   if (!touchStop()) {
     log_e("touchStop() failed!");
@@ -341,25 +374,32 @@ static void __touchChannelInit(int pad) {
   }
 }
 
-static touch_value_t __touchRead(uint8_t pin) {
-  int8_t pad = digitalPinToTouchChannel(pin);
-  if (pad < 0) {
-    return 0;
-  }
-
+static bool __touchPinAttach(uint8_t pin, int8_t pad) {
   if (perimanGetPinBus(pin, ESP32_BUS_TYPE_TOUCH) == NULL) {
     perimanSetBusDeinit(ESP32_BUS_TYPE_TOUCH, touchDetachBus);
     if (!perimanClearPinBus(pin)) {
-      return 0;
+      return false;
     }
     __touchInit();
     __touchChannelInit(pad);
 
     if (!perimanSetPinBus(pin, ESP32_BUS_TYPE_TOUCH, (void *)(pin + 1), -1, pad)) {
       touchDetachBus((void *)(pin + 1));
-      return 0;
+      return false;
     }
   }
+  return true;
+}
+
+static touch_value_t __touchRead(uint8_t pin) {
+  int8_t pad = digitalPinToTouchChannel(pin);
+  if (pad < 0) {
+    return 0;
+  }
+
+  if (!__touchPinAttach(pin, pad)) {
+    return 0;
+  }
 
   uint32_t touch_read[_sample_num] = {};
   touch_channel_read_data(touch_channel_handle[pad], TOUCH_CHAN_DATA_TYPE_SMOOTH, touch_read);
@@ -498,6 +538,232 @@ void touchSleepWakeUpEnable(uint8_t pin, touch_value_t threshold) {
   }
 }
 
+/*
+    Background Scan
+*/
+
+// returns true when the pressed state changed
+static bool touchScanFilter(touch_scan_channel_t *ch, touch_value_t value, int64_t now) {
+  touch_channel_state_t *state = &ch->state;
+  state->value = value;
+  if (!ch->started) {
+    ch->started = true;
+    ch->baseline = (int64_t)value << TOUCH_SCAN_BASELINE_SHIFT;
+    ch->noise = 0;
+    ch->debounce = 0;
+    state->pressed = false;
+  }
+  state->baseline = (touch_value_t)(ch->baseline >> TOUCH_SCAN_BASELINE_SHIFT);
+  state->noise = (touch_value_t)(ch->noise >> TOUCH_SCAN_NOISE_SHIFT);
+#if SOC_TOUCH_SENSOR_VERSION == 1  // ESP32 values fall when touched
+  state->delta = (int32_t)state->baseline - (int32_t)value;
+#else
+  state->delta = (int32_t)value - (int32_t)state->baseline;
+#endif
+
+  int32_t threshold = (int32_t)(state->baseline * s_thresh2bm_ratio);
+  if (threshold < (int32_t)(state->noise * TOUCH_SCAN_NOISE_FACTOR)) {
+    threshold = (int32_t)(state->noise * TOUCH_SCAN_NOISE_FACTOR);
+  }
+  bool active = state->pressed ? state->delta >= threshold / 2 : state->delta > threshold;
+
+  // only released values are filtered, so that a long press does not become the baseline
+  if (!state->pressed && !active) {
+    uint32_t distance = state->delta < 0 ? -state->delta : state->delta;
+    ch->baseline += (int64_t)value - state->baseline;
+    ch->noise += (int64_t)distance - state->noise;
+  }
+
+  if (active == state->pressed) {
+    ch->debounce = 0;
+    return false;
+  }
+  if (ch->debounce++ == 0) {
+    ch->change_us = now;
+  }
+  if (ch->debounce < TOUCH_SCAN_DEBOUNCE) {
+    return false;
+  }
+  ch->debounce = 0;
+  state->pressed = active;
+  return true;
+}
+
+static void touchScanTick(void *arg) {
+  touch_event_t events[SOC_TOUCH_SENSOR_NUM];
+  size_t num_events = 0;
+
+  xSemaphoreTake(scan_lock, portMAX_DELAY);
+  int64_t start = esp_timer_get_time();
+  for (size_t i = 0; i < scan_count; i++) {
+    touch_scan_channel_t *ch = &scan_channels[i];
+    if (!channels_initialized[ch->pad]) {
+      // detached, the filters start over if it comes back
+      ch->started = false;
+      continue;
+    }
+    uint32_t touch_read[_sample_num] = {};
+    if (touch_channel_read_data(touch_channel_handle[ch->pad], TOUCH_CHAN_DATA_TYPE_SMOOTH, touch_read) != ESP_OK) {
+      continue;
+    }
+    if (touchScanFilter(ch, touch_read[0], start)) {
+      events[num_events].pin = ch->state.pin;
+      events[num_events].pressed = ch->state.pressed;
+      events[num_events].delta = ch->state.delta;
+      events[num_events].latency_us = (uint32_t)(esp_timer_get_time() - ch->change_us);
+      if (events[num_events].latency_us > scan_max_latency_us) {
+        scan_max_latency_us = events[num_events].latency_us;
+      }
+      num_events++;
+    }
+  }
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+  scan_passes++;
+  scan_events += num_events;
+  scan_sum_us += elapsed;
+  if (elapsed > scan_max_us) {
+    scan_max_us = elapsed;
+  }
+  touch_event_cb_t cb = scan_cb;
+  void *cb_arg = scan_cb_arg;
+  xSemaphoreGive(scan_lock);
+
+  // outside of the lock, the callback may read the state
+  for (size_t i = 0; cb != NULL && i < num_events; i++) {
+    cb(&events[i], cb_arg);
+  }
+}
+
+bool touchScanBegin(const uint8_t *pins, size_t count, uint32_t period_ms, touch_event_cb_t callback, void *arg) {
+  if (pins == NULL || count == 0 || count > SOC_TOUCH_SENSOR_NUM || period_ms == 0) {
+    log_e("Invalid touch scan parameters");
+    return false;
+  }
+  touchScanEnd();
+
+  if (scan_lock == NULL) {
+    scan_lock = xSemaphoreCreateMutex();
+    if (scan_lock == NULL) {
+      log_e("xSemaphoreCreateMutex failed");
+      return false;
+    }
+  }
+  if (scan_timer == NULL) {
+    esp_timer_create_args_t timer_args = {
+      .callback = touchScanTick,
+      .arg = NULL,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "touch_scan",
+    };
+    if (esp_timer_create(&timer_args, &scan_timer) != ESP_OK) {
+      log_e("esp_timer_create failed");
+      scan_timer = NULL;
+      return false;
+    }
+  }
+
+  // attaching a pad stops and restarts the sensor, done before the scan runs
+  for (size_t i = 0; i < count; i++) {
+    int8_t pad = digitalPinToTouchChannel(pins[i]);
+    if (pad < 0 || !__touchPinAttach(pins[i], pad) || !channels_initialized[pad]) {
+      log_e("Pin %u could not be set up for touch", pins[i]);
+      return false;
+    }
+  }
+
+  xSemaphoreTake(scan_lock, portMAX_DELAY);
+  memset(scan_channels, 0, sizeof(scan_channels));
+  for (size_t i = 0; i < count; i++) {
+    scan_channels[i].state.pin = pins[i];
+    scan_channels[i].pad = digitalPinToTouchChannel(pins[i]);
+  }
+  scan_count = count;
+  scan_cb = callback;
+  scan_cb_arg = arg;
+  scan_passes = 0;
+  scan_events = 0;
+  scan_max_us = 0;
+  scan_sum_us = 0;
+  scan_max_latency_us = 0;
+  scan_stats_since_us = esp_timer_get_time();
+  xSemaphoreGive(scan_lock);
+
+  if (esp_timer_start_periodic(scan_timer, (uint64_t)period_ms * 1000) != ESP_OK) {
+    log_e("esp_timer_start_periodic failed");
+    touchScanEnd();
+    return false;
+  }
+  return true;
+}
+
+bool touchScanRead(uint8_t pin, touch_channel_state_t *state) {
+  if (scan_lock == NULL || state == NULL) {
+    return false;
+  }
+  bool found = false;
+  xSemaphoreTake(scan_lock, portMAX_DELAY);
+  for (size_t i = 0; i < scan_count; i++) {
+    if (scan_channels[i].state.pin == pin && scan_channels[i].started) {
+      *state = scan_channels[i].state;
+      found = true;
+      break;
+    }
+  }
+  xSemaphoreGive(scan_lock);
+  return found;
+}
+
+size_t touchScanSnapshot(touch_channel_state_t *states, size_t max) {
+  if (scan_lock == NULL || states == NULL) {
+    return 0;
+  }
+  xSemaphoreTake(scan_lock, portMAX_DELAY);
+  size_t count = scan_count < max ? scan_count : max;
+  for (size_t i = 0; i < count; i++) {
+    states[i] = scan_channels[i].state;
+  }
+  xSemaphoreGive(scan_lock);
+  return count;
+}
+
+bool touchScanGetStats(touch_scan_stats_t *stats, bool reset) {
+  if (scan_lock == NULL || stats == NULL) {
+    return false;
+  }
+  xSemaphoreTake(scan_lock, portMAX_DELAY);
+  int64_t now = esp_timer_get_time();
+  int64_t elapsed = now - scan_stats_since_us;
+  stats->scans = scan_passes;
+  stats->events = scan_events;
+  stats->max_scan_us = scan_max_us;
+  stats->avg_scan_us = scan_passes ? (uint32_t)(scan_sum_us / scan_passes) : 0;
+  stats->max_latency_us = scan_max_latency_us;
+  stats->cpu_permille = elapsed > 0 ? (uint32_t)(scan_sum_us * 1000 / elapsed) : 0;
+  if (reset) {
+    scan_passes = 0;
+    scan_events = 0;
+    scan_max_us = 0;
+    scan_sum_us = 0;
+    scan_max_latency_us = 0;
+    scan_stats_since_us = now;
+  }
+  xSemaphoreGive(scan_lock);
+  return true;
+}
+
+void touchScanEnd(void) {
+  if (scan_timer == NULL) {
+    return;
+  }
+  // the pads stay attached and can still be used with touchRead()
+  esp_timer_stop(scan_timer);
+  xSemaphoreTake(scan_lock, portMAX_DELAY);
+  scan_count = 0;
+  scan_cb = NULL;
+  scan_cb_arg = NULL;
+  xSemaphoreGive(scan_lock);
+}
+
 void touchSetDefaultThreshold(float percentage) {
   s_thresh2bm_ratio = (float)percentage / 100.0f;
 }
@@ -49,6 +49,50 @@ extern "C" {
 
 typedef uint32_t touch_value_t;
 
+// Baseline and noise filters of the background scan, new = old + (sample - old) / 2^shift
+#ifndef TOUCH_SCAN_BASELINE_SHIFT
+#define TOUCH_SCAN_BASELINE_SHIFT 6
+#endif
+#ifndef TOUCH_SCAN_NOISE_SHIFT
+#define TOUCH_SCAN_NOISE_SHIFT 3
+#endif
+// A press also needs a delta above this many times the noise level
+#ifndef TOUCH_SCAN_NOISE_FACTOR
+#define TOUCH_SCAN_NOISE_FACTOR 4
+#endif
+// Consecutive scans needed to change the pressed state
+#ifndef TOUCH_SCAN_DEBOUNCE
+#define TOUCH_SCAN_DEBOUNCE 2
+#endif
+
+typedef struct {
+  uint8_t pin;
+  bool pressed;
+  touch_value_t value;     // last value read from the touch sensor
+  touch_value_t baseline;  // filtered value while released
+  touch_value_t noise;     // filtered distance between the value and the baseline while released
+  int32_t delta;           // distance from the baseline, positive when touched on all chips
+} touch_channel_state_t;
+
+typedef struct {
+  uint8_t pin;
+  bool pressed;
+  int32_t delta;
+  uint32_t latency_us;  // since the scan that first saw the change
+} touch_event_t;
+
+// called from the esp_timer task, it shall not block
+typedef void (*touch_event_cb_t)(const touch_event_t *event, void *arg);
+
+typedef struct {
+  uint32_t scans;
+  uint32_t events;
+  uint32_t max_scan_us;     // longest scan pass, reading and filtering all channels
+  uint32_t avg_scan_us;
+  uint32_t max_latency_us;  // longest touch_event_t latency, debounce included
+  uint32_t cpu_permille;    // CPU time used by the scan passes since the last reset
+} touch_scan_stats_t;
+
 /*
  * Set time in us that measurement operation takes
  * The result from touchRead, threshold and detection
@@ -127,6 +171,21 @@ void touchSetDefaultThreshold(float percentage);
  **/
 void touchSleepWakeUpEnable(uint8_t pin, touch_value_t threshold);
 
+/*
+ * Background scanning of several touch pads.
+ * The touch sensor measures all the pads in sequence by itself; every <period_ms> the latest
+ * values are read at once, filtered into a baseline and a noise level, and pressed / released
+ * events are sent to <callback> after TOUCH_SCAN_DEBOUNCE scans. A pad is pressed when its
+ * delta rises above the touchSetDefaultThreshold() percentage of the baseline and the noise
+ * margin, released below half of that. <callback> may be NULL when the state is polled.
+ **/
+bool touchScanBegin(const uint8_t *pins, size_t count, uint32_t period_ms, touch_event_cb_t callback, void *arg);
+bool touchScanRead(uint8_t pin, touch_channel_state_t *state);
+// copies the state of up to <max> pads in the order given to touchScanBegin(), returns the number copied
+size_t touchScanSnapshot(touch_channel_state_t *states, size_t max);
+bool touchScanGetStats(touch_scan_stats_t *stats, bool reset);
+void touchScanEnd(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -122,6 +122,7 @@ void yield(void);
 #include "esp32-hal-i2c.h"
 #include "esp32-hal-ledc.h"
 #include "esp32-hal-rmt.h"
+#include "esp32-hal-pulse.h"
 #include "esp32-hal-sigmadelta.h"
 #include "esp32-hal-timer.h"
 #include "esp32-hal-bt.h"
@@ -44,8 +44,11 @@ int8_t gpioNumberToDigitalPin(int8_t gpioNumber);
 #define attachInterrupt(pin, fcn, mode)         attachInterrupt(digitalPinToGPIONumber(pin), fcn, mode)
 #define detachInterrupt(pin)                    detachInterrupt(digitalPinToGPIONumber(pin))
 #define digitalWrite(pin, val)                  digitalWrite(digitalPinToGPIONumber(pin), val)
+#define fastPinInit(fp, pin)                    fastPinInit(fp, digitalPinToGPIONumber(pin))
 #define pinMode(pin, mode)                      pinMode(digitalPinToGPIONumber(pin), mode)
 
+#define attachInterruptDeferred(pin, fcn, arg, mode) attachInterruptDeferred(digitalPinToGPIONumber(pin), fcn, arg, mode)
+
 // cores/esp32/esp32-hal-i2c.h
 #define i2cInit(i2c_num, sda, scl, clk_speed) i2cInit(i2c_num, digitalPinToGPIONumber(sda), digitalPinToGPIONumber(scl), clk_speed)
 
@@ -64,12 +67,17 @@ int8_t gpioNumberToDigitalPin(int8_t gpioNumber);
 #define ledcDetach(pin)                                   ledcDetach(digitalPinToGPIONumber(pin))
 #define ledcChangeFrequency(pin, freq, resolution)        ledcChangeFrequency(digitalPinToGPIONumber(pin), freq, resolution)
 #define ledcOutputInvert(pin, out_invert)                 ledcOutputInvert(digitalPinToGPIONumber(pin), out_invert)
+#define ledcWriteStage(pin, duty)                         ledcWriteStage(digitalPinToGPIONumber(pin), duty)
+#define ledcCancelScheduledFade(pin)                      ledcCancelScheduledFade(digitalPinToGPIONumber(pin))
+#define ledcScheduledFadeRunning(pin)                     ledcScheduledFadeRunning(digitalPinToGPIONumber(pin))
 
 #define ledcFade(pin, start_duty, target_duty, max_fade_time_ms) ledcFade(digitalPinToGPIONumber(pin), start_duty, target_duty, max_fade_time_ms)
 #define ledcFadeWithInterrupt(pin, start_duty, target_duty, max_fade_time_ms, userFunc) \
   ledcFadeWithInterrupt(digitalPinToGPIONumber(pin), start_duty, target_duty, max_fade_time_ms, userFunc)
 #define ledcFadeWithInterruptArg(pin, start_duty, target_duty, max_fade_time_ms, userFunc, arg) \
   ledcFadeWithInterruptArg(digitalPinToGPIONumber(pin), start_duty, target_duty, max_fade_time_ms, userFunc, arg)
+#define ledcScheduleFade(pin, start_duty, target_duty, fade_time_ms, userFunc, arg) \
+  ledcScheduleFade(digitalPinToGPIONumber(pin), start_duty, target_duty, fade_time_ms, userFunc, arg)
 
 // cores/esp32/esp32-hal-matrix.h
 #define pinMatrixInAttach(pin, signal, inverted)                   pinMatrixInAttach(digitalPinToGPIONumber(pin), signal, inverted)
@@ -95,6 +103,12 @@ int8_t gpioNumberToDigitalPin(int8_t gpioNumber);
 #define rmtSetRxMinThreshold(pin, filter_pulse_ticks) rmtSetRxMinThreshold(digitalPinToGPIONumber(pin), filter_pulse_ticks)
 #define rmtDeinit(pin)                                rmtDeinit(digitalPinToGPIONumber(pin))
 
+// cores/esp32/esp32-hal-pulse.h
+#define pulseMeasureBegin(pin, callback, arg) pulseMeasureBegin(digitalPinToGPIONumber(pin), callback, arg)
+#define pulseMeasureRead(pin, info, reset)    pulseMeasureRead(digitalPinToGPIONumber(pin), info, reset)
+#define pulseMeasureResolution(pin)           pulseMeasureResolution(digitalPinToGPIONumber(pin))
+#define pulseMeasureEnd(pin)                  pulseMeasureEnd(digitalPinToGPIONumber(pin))
+
 // cores/esp32/esp32-hal-sigmadelta.h
 #define sigmaDeltaAttach(pin, freq) sigmaDeltaAttach(digitalPinToGPIONumber(pin), freq)
 #define sigmaDeltaWrite(pin, duty)  sigmaDeltaWrite(digitalPinToGPIONumber(pin), duty)
@@ -113,6 +127,7 @@ int8_t gpioNumberToDigitalPin(int8_t gpioNumber);
 #define touchAttachInterrupt(pin, userFunc, threshold)         touchAttachInterrupt(digitalPinToGPIONumber(pin), userFunc, threshold)
 #define touchDetachInterrupt(pin)                              touchDetachInterrupt(digitalPinToGPIONumber(pin))
 #define touchSleepWakeUpEnable(pin, threshold)                 touchSleepWakeUpEnable(digitalPinToGPIONumber(pin), threshold)
+#define touchScanRead(pin, state)                              touchScanRead(digitalPinToGPIONumber(pin), state)
 
 // cores/esp32/esp32-hal-uart.h
 #define uartBegin(uart_nr, baudrate, config, rxPin, txPin, rx_buffer_size, tx_buffer_size, inverted, rxfifo_full_thrhd)                                  \
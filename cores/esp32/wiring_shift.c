@@ -18,12 +18,60 @@
  */
 
 #include "esp32-hal.h"
+#include "esp32-hal-periman.h"
 #include "wiring_private.h"
+#include "esp_cpu.h"
+
+// Shortest time the fast path holds the clock high and low, in ns. Without it the register writes
+// would clock at several MHz, too fast for slow shift registers and long wires. 0 disables the wait.
+#ifndef SHIFT_CLOCK_MIN_NS
+#define SHIFT_CLOCK_MIN_NS 500
+#endif
+
+static inline uint32_t shiftWaitCycles(void) {
+  return (uint32_t)SHIFT_CLOCK_MIN_NS * getCpuFrequencyMhz() / 1000;
+}
+
+// waits until cycles have passed since start, returns the current cycle count
+static inline uint32_t shiftWait(uint32_t start, uint32_t cycles) {
+  uint32_t now;
+  do {
+    now = esp_cpu_get_cycle_count();
+  } while (now - start < cycles);
+  return now;
+}
+
+// true when both pins are set up as GPIO, so the registers can be accessed directly
+static bool shiftFastPins(fast_gpio_t *data, uint8_t dataPin, fast_gpio_t *clock, uint8_t clockPin) {
+  return dataPin < SOC_GPIO_PIN_COUNT && clockPin < SOC_GPIO_PIN_COUNT && perimanGetPinBus(dataPin, ESP32_BUS_TYPE_GPIO) != NULL
+         && perimanGetPinBus(clockPin, ESP32_BUS_TYPE_GPIO) != NULL && fastPinInit(data, dataPin) && fastPinInit(clock, clockPin);
+}
 
 uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {  // codespell:ignore shiftin
   uint8_t value = 0;
   uint8_t i;
+  fast_gpio_t data, clock;
 
+  if (shiftFastPins(&data, dataPin, &clock, clockPin)) {
+    uint32_t cycles = shiftWaitCycles();
+    uint32_t t = esp_cpu_get_cycle_count();
+    for (i = 0; i < 8; ++i) {
+      // the clock has been low long enough for the device to present the bit
+      t = shiftWait(t, cycles);
+      if (bitOrder == LSBFIRST) {
+        value |= fastPinRead(&data) << i;
+      } else {
+        value |= fastPinRead(&data) << (7 - i);
+      }
+      fastPinSet(&clock);
+      shiftWait(esp_cpu_get_cycle_count(), cycles);
+      fastPinClear(&clock);
+      t = esp_cpu_get_cycle_count();
+    }
+    return value;
+  }
+
+  // RGB_BUILTIN or pins not set up by pinMode(), digitalRead() and digitalWrite() handle them
   for (i = 0; i < 8; ++i) {
     //digitalWrite(clockPin, HIGH);
     if (bitOrder == LSBFIRST) {
@@ -39,6 +87,26 @@ uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {  // codes
 
 void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val) {
   uint8_t i;
+  fast_gpio_t data, clock;
+
+  if (shiftFastPins(&data, dataPin, &clock, clockPin)) {
+    uint32_t cycles = shiftWaitCycles();
+    uint32_t t = esp_cpu_get_cycle_count();
+    for (i = 0; i < 8; i++) {
+      if (bitOrder == LSBFIRST) {
+        fastPinWrite(&data, val & (1 << i));
+      } else {
+        fastPinWrite(&data, val & (1 << (7 - i)));
+      }
+      // low phase, also the setup time of the data bit
+      shiftWait(t, cycles);
+      fastPinSet(&clock);
+      shiftWait(esp_cpu_get_cycle_count(), cycles);
+      fastPinClear(&clock);
+      t = esp_cpu_get_cycle_count();
+    }
+    return;
+  }
 
   for (i = 0; i < 8; i++) {
     if (bitOrder == LSBFIRST) {
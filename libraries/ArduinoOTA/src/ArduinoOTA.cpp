@@ -29,7 +29,8 @@
 
 ArduinoOTAClass::ArduinoOTAClass(UpdateClass *updater)
   : _updater(updater), _port(0), _initialized(false), _rebootOnSuccess(true), _mdnsEnabled(true), _state(OTA_IDLE), _size(0), _cmd(0), _ota_port(0),
-    _ota_timeout(1000), _start_callback(NULL), _end_callback(NULL), _error_callback(NULL), _progress_callback(NULL)
+    _ota_timeout(1000), _window(ARDUINO_OTA_DEFAULT_WINDOW), _ota_window(0), _start_callback(NULL), _end_callback(NULL), _error_callback(NULL),
+    _progress_callback(NULL)
 #ifdef UPDATE_SIGN
     ,
     _sign(NULL)
@@ -143,6 +144,13 @@ ArduinoOTAClass &ArduinoOTAClass::setMdnsEnabled(bool enabled) {
   return *this;
 }
 
+ArduinoOTAClass &ArduinoOTAClass::setWindowSize(uint32_t window) {
+  if (_state == OTA_IDLE) {
+    _window = window;
+  }
+  return *this;
+}
+
 #ifdef UPDATE_SIGN
 ArduinoOTAClass &ArduinoOTAClass::setSignature(UpdaterVerifyClass *sign) {
   if (_state == OTA_IDLE && sign) {
@@ -244,6 +252,18 @@ void ArduinoOTAClass::_onRx() {
       return;
     }
 
+    // Newer hosts append "V<version> <window>" on a second line, older devices never read it
+    _ota_window = 0;
+    if (_udp_ota.peek() == 'V') {
+      _udp_ota.read();
+      int version = parseInt();
+      int window = parseInt();
+      if (version >= ARDUINO_OTA_PROTOCOL_WINDOWED && window > 0 && _window > 0) {
+        _ota_window = min((uint32_t)window, _window);
+        log_d("windowed transfer, window: %" PRIu32, _ota_window);
+      }
+    }
+
     if (_password.length()) {
       // Generate a random challenge (nonce)
       SHA256Builder nonce_sha256;
@@ -254,12 +274,14 @@ void ArduinoOTAClass::_onRx() {
 
       _udp_ota.beginPacket(_udp_ota.remoteIP(), _udp_ota.remotePort());
       _udp_ota.printf("AUTH %s", _nonce.c_str());
+      _printWindow();
       _udp_ota.endPacket();
       _state = OTA_WAITAUTH;
       return;
     } else {
       _udp_ota.beginPacket(_udp_ota.remoteIP(), _udp_ota.remotePort());
       _udp_ota.print("OK");
+      _printWindow();
       _udp_ota.endPacket();
       _ota_ip = _udp_ota.remoteIP();
       _state = OTA_RUNUPDATE;
@@ -323,6 +345,13 @@ void ArduinoOTAClass::_onRx() {
   }
 }
 
+// Appends the accepted protocol version and window to the invitation reply, only for hosts that asked for it
+void ArduinoOTAClass::_printWindow() {
+  if (_ota_window) {
+    _udp_ota.printf(" %d %" PRIu32, ARDUINO_OTA_PROTOCOL_WINDOWED, _ota_window);
+  }
+}
+
 void ArduinoOTAClass::_runUpdate() {
   if (!_updater) {
     log_e("UpdateClass is NULL!");
@@ -373,7 +402,9 @@ void ArduinoOTAClass::_runUpdate() {
     _state = OTA_IDLE;
   }
 
-  uint32_t written = 0, total = 0, tried = 0;
+  uint32_t written = 0, total = 0, tried = 0, acked = 0;
+  // windowed hosts keep sending until a full window is unacknowledged, ACK every half window so they never stall
+  uint32_t ackInterval = _ota_window / 2;
 
   while (!_updater->isFinished() && client.connected()) {
     size_t waited = _ota_timeout;
@@ -384,6 +415,15 @@ void ArduinoOTAClass::_runUpdate() {
       available = client.available();
     }
     if (!waited) {
+      if (_ota_window && tried++ < 3) {
+        log_i("Try[%" PRIu32 "]: %" PRIu32, tried, total);
+        if (!client.printf("%" PRIu32 "\n", total)) {
+          log_e("failed to respond");
+          _state = OTA_IDLE;
+          break;
+        }
+        continue;
+      }
       if (written && tried++ < 3) {
         log_i("Try[%" PRIu32 "]: %" PRIu32, tried, written);
         if (!client.printf("%" PRIu32, written)) {
@@ -407,6 +447,28 @@ void ArduinoOTAClass::_runUpdate() {
       break;
     }
     tried = 0;
+
+    if (_ota_window) {
+      // read straight from the socket into the updater sector buffer
+      written = _updater->write(client);
+      if (_updater->hasError()) {
+        log_e("Write ERROR: %s", _updater->errorString());
+        break;
+      }
+      total += written;
+      if (_progress_callback) {
+        _progress_callback(total, _size);
+      }
+      if (total - acked >= ackInterval || _updater->isFinished()) {
+        // cumulative byte count, newline terminated
+        if (!client.printf("%" PRIu32 "\n", total)) {
+          log_w("failed to respond");
+        }
+        acked = total;
+      }
+      continue;
+    }
+
     static uint8_t buf[1460];
     if (available > 1460) {
       available = 1460;
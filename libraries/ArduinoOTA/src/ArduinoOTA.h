@@ -21,6 +21,12 @@
 
 #define INT_BUFFER_SIZE 16
 
+// Hosts announce "V<version> <window>" after the invitation, the device answers with the accepted window
+#define ARDUINO_OTA_PROTOCOL_WINDOWED 2
+#ifndef ARDUINO_OTA_DEFAULT_WINDOW
+#define ARDUINO_OTA_DEFAULT_WINDOW 16384
+#endif
+
 typedef enum {
   OTA_IDLE,
   OTA_WAITAUTH,
@@ -74,6 +80,11 @@ public:
   //Sets if the device should advertise itself to Arduino IDE. Default true
   ArduinoOTAClass &setMdnsEnabled(bool enabled);
 
+  //Sets the largest number of unacknowledged bytes a host supporting the windowed
+  //protocol may send. The device ACKs every half window instead of every chunk.
+  //0 keeps the legacy ACK per chunk for all hosts. Default ARDUINO_OTA_DEFAULT_WINDOW
+  ArduinoOTAClass &setWindowSize(uint32_t window);
+
 #ifdef UPDATE_SIGN
   //Install signature verification for OTA updates
   //Must be called before begin()
@@ -124,6 +135,8 @@ private:
   int _cmd;
   int _ota_port;
   int _ota_timeout;
+  uint32_t _window;
+  uint32_t _ota_window;  // negotiated for the current session, 0 for legacy hosts
   IPAddress _ota_ip;
   String _md5;
 
@@ -138,6 +151,7 @@ private:
 
   void _runUpdate(void);
   void _onRx(void);
+  void _printWindow(void);
   int parseInt(void);
   String readStringUntil(char end);
 };
@@ -0,0 +1,80 @@
+/* LEDC Scheduled Fade Arduino Example
+
+   Fades several LEDs concurrently with the LEDC fade scheduler, each one with its own
+   fade time, and switches them all at once with ledcWriteMulti().
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <Arduino.h>
+
+// use 12 bit precision for LEDC timer
+#define LEDC_TIMER_12_BIT 12
+
+// use 5000 Hz as a LEDC base frequency
+#define LEDC_BASE_FREQ 5000
+
+#define LEDC_MAX_DUTY 4095
+
+#define NUM_LEDS 3
+
+// all LEDs are attached with the same frequency and resolution, so they share one timer
+const uint8_t ledPins[NUM_LEDS] = {2, 4, 5};
+const uint32_t fadeTimes[NUM_LEDS] = {700, 1100, 1700};
+
+bool fadingIn[NUM_LEDS];
+
+// called from the timer task when the fade of a LED ended, start it in the other direction
+void fadeEnded(void *arg) {
+  int led = (int)(intptr_t)arg;
+  fadingIn[led] = !fadingIn[led];
+  if (fadingIn[led]) {
+    ledcScheduleFade(ledPins[led], 0, LEDC_MAX_DUTY, fadeTimes[led], fadeEnded, arg);
+  } else {
+    ledcScheduleFade(ledPins[led], LEDC_MAX_DUTY, 0, fadeTimes[led], fadeEnded, arg);
+  }
+}
+
+void startFades() {
+  for (int led = 0; led < NUM_LEDS; led++) {
+    fadingIn[led] = true;
+    ledcScheduleFade(ledPins[led], 0, LEDC_MAX_DUTY, fadeTimes[led], fadeEnded, (void *)(intptr_t)led);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  for (int led = 0; led < NUM_LEDS; led++) {
+    if (!ledcAttach(ledPins[led], LEDC_BASE_FREQ, LEDC_TIMER_12_BIT)) {
+      Serial.printf("Failed to attach LED on pin %u\n", ledPins[led]);
+    }
+  }
+
+  startFades();
+  Serial.println("Fades started.");
+}
+
+void loop() {
+  delay(10000);
+
+  // stop the fades and blink all LEDs together, every LED switches on the same PWM cycle
+  for (int led = 0; led < NUM_LEDS; led++) {
+    ledcCancelScheduledFade(ledPins[led]);
+  }
+  Serial.println("Blinking all LEDs together.");
+  const uint32_t allOn[NUM_LEDS] = {LEDC_MAX_DUTY, LEDC_MAX_DUTY, LEDC_MAX_DUTY};
+  const uint32_t allOff[NUM_LEDS] = {0, 0, 0};
+  for (int i = 0; i < 5; i++) {
+    ledcWriteMulti(ledPins, allOn, NUM_LEDS);
+    delay(200);
+    ledcWriteMulti(ledPins, allOff, NUM_LEDS);
+    delay(200);
+  }
+
+  startFades();
+  Serial.println("Fades started.");
+}
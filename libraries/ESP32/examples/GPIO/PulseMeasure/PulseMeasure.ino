@@ -0,0 +1,68 @@
+/*
+  Pulse measurement
+
+  Measures the high time, low time and period of a PWM signal without blocking, on two pins
+  at the same time. LEDC generates two test signals; connect PWM_A_GPIO to MEASURE_A_GPIO and
+  PWM_B_GPIO to MEASURE_B_GPIO with wires.
+
+  The first pin is polled with pulseMeasureRead(), the second one counts its pulses in a
+  callback that runs in the interrupt.
+*/
+
+#include <Arduino.h>
+
+#define PWM_A_GPIO     4
+#define MEASURE_A_GPIO 5
+#if CONFIG_IDF_TARGET_ESP32
+// GPIO 6 to 11 are used by the flash
+#define PWM_B_GPIO     18
+#define MEASURE_B_GPIO 19
+#else
+#define PWM_B_GPIO     6
+#define MEASURE_B_GPIO 7
+#endif
+
+volatile uint32_t longPulses = 0;
+
+// runs in the interrupt: keep it short
+void ARDUINO_ISR_ATTR onPulse(const pulse_event_t *pulse, void *arg) {
+  uint32_t min_width = *(uint32_t *)arg;
+  if (pulse->level == HIGH && pulse->width >= min_width) {
+    longPulses = longPulses + 1;
+  }
+}
+
+uint32_t minWidth = 0;
+
+void setup() {
+  Serial.begin(115200);
+
+  // 1 kHz with 25% duty and 50 Hz with 50% duty
+  ledcAttach(PWM_A_GPIO, 1000, 8);
+  ledcWrite(PWM_A_GPIO, 64);
+  ledcAttach(PWM_B_GPIO, 50, 8);
+  ledcWrite(PWM_B_GPIO, 128);
+
+  if (!pulseMeasureBegin(MEASURE_A_GPIO, NULL, NULL)) {
+    Serial.println("Failed to measure pin A");
+  }
+  // count high pulses of at least 5 ms, all pins have the same resolution
+  minWidth = pulseMeasureResolution(MEASURE_A_GPIO) / 200;
+  if (!pulseMeasureBegin(MEASURE_B_GPIO, onPulse, &minWidth)) {
+    Serial.println("Failed to measure pin B");
+  }
+}
+
+void loop() {
+  pulse_info_t info;
+  float ticks_per_us = pulseMeasureResolution(MEASURE_A_GPIO) / 1000000.0;
+
+  if (pulseMeasureRead(MEASURE_A_GPIO, &info, true) && info.period != 0) {
+    Serial.printf(
+      "A: high %.2f us, low %.2f us, period %.2f us, duty %.1f%%, %lu pulses\n", info.high / ticks_per_us, info.low / ticks_per_us,
+      info.period / ticks_per_us, 100.0 * info.high / info.period, (unsigned long)info.count
+    );
+  }
+  Serial.printf("B: %lu pulses longer than 5 ms\n", (unsigned long)longPulses);
+  delay(1000);
+}
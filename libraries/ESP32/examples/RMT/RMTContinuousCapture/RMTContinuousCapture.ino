@@ -0,0 +1,88 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+   @brief This example receives back to back frames with the RMT continuous capture.
+
+   A TX channel queues bursts of pulses, each burst encoding a frame number in its pulse count,
+   and a RX channel captures them into a ring of buffers. The loop takes longer to process a
+   frame than the sender needs to send one, yet no frame is lost as long as a buffer is free.
+
+   Connect TX_GPIO to RX_GPIO with a wire.
+*/
+
+#include <Arduino.h>
+
+#define TX_GPIO 4
+#define RX_GPIO 5
+
+// RMT at 1MHz, 1us tick
+#define RMT_FREQ 1000000
+
+#define CAPTURE_BUFFERS 8
+#define FRAME_SYMBOLS 64
+#define FRAMES_PER_BURST 6
+
+// a frame ends after 500us without edges
+#define IDLE_THRESHOLD_US 500
+
+// frame n has n + 1 pulses of 50us, followed by a gap that ends the frame at the receiver
+static rmt_data_t frames[FRAMES_PER_BURST][FRAME_SYMBOLS];
+
+void setup() {
+  Serial.begin(115200);
+
+  if (!rmtInit(TX_GPIO, RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, RMT_FREQ)) {
+    Serial.println("TX init failed");
+  }
+  if (!rmtInit(RX_GPIO, RMT_RX_MODE, RMT_MEM_NUM_BLOCKS_1, RMT_FREQ)) {
+    Serial.println("RX init failed");
+  }
+  rmtSetRxMaxThreshold(RX_GPIO, IDLE_THRESHOLD_US);
+
+  for (int f = 0; f < FRAMES_PER_BURST; f++) {
+    for (int i = 0; i <= f; i++) {
+      frames[f][i] = {{50, 1, 50, 0}};
+    }
+    frames[f][f].duration1 = 2 * IDLE_THRESHOLD_US;
+  }
+
+  if (!rmtBeginCapture(RX_GPIO, CAPTURE_BUFFERS, FRAME_SYMBOLS, NULL, NULL)) {
+    Serial.println("Capture failed to start");
+  }
+}
+
+void loop() {
+  // all frames of a burst are sent within a few ms
+  for (int f = 0; f < FRAMES_PER_BURST; f++) {
+    rmtWriteQueued(TX_GPIO, frames[f], f + 1);
+  }
+
+  rmt_frame_t frame;
+  int64_t last_us = 0;
+  while (rmtGetFrame(RX_GPIO, &frame, 100)) {
+    // the last symbol ends with the idle level, so it is counted as a pulse as well
+    Serial.printf("Frame of %u pulses", (unsigned)frame.num_symbols);
+    if (last_us != 0) {
+      Serial.printf(", %lld us after the previous one", frame.timestamp_us - last_us);
+    }
+    Serial.println();
+    last_us = frame.timestamp_us;
+    rmtReleaseFrame(RX_GPIO, &frame);
+    // slower than the sender
+    delay(5);
+  }
+  Serial.printf("Overruns: %lu\n\n", (unsigned long)rmtGetCaptureOverruns(RX_GPIO, true));
+  delay(2000);
+}
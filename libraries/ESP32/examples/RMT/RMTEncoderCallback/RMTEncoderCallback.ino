@@ -0,0 +1,109 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+   @brief This example sends NEC infrared remote control commands with an RMT encoder callback.
+
+   Each command is stored as 4 bytes (address, ~address, command, ~command). The callback turns
+   them into the 34 RMT symbols of a NEC frame while the frame is sent, so no symbol array is needed.
+   The frames are queued with rmtWriteEncodedQueued() and sent back to back, the gap between
+   them is part of the last symbol of each frame.
+
+   Connect an IR LED (with a transistor driver) to IR_TX_GPIO, or a logic analyzer.
+*/
+
+#include <Arduino.h>
+
+#define IR_TX_GPIO 4
+
+// RMT at 1MHz, 1us tick
+#define NEC_RMT_FREQ 1000000
+
+// NEC timing
+static const rmt_data_t nec_leader = {{9000, 1, 4500, 0}};
+static const rmt_data_t nec_zero = {{560, 1, 560, 0}};
+static const rmt_data_t nec_one = {{560, 1, 1690, 0}};
+// final burst, followed by a gap of about 33ms to the next frame
+static const rmt_data_t nec_stop = {{560, 1, 32767, 0}};
+
+#define NEC_SYMBOLS 34  // leader, 32 bits, stop
+
+// Runs in the RMT interrupt: writes the symbols that fit into the channel memory
+static size_t IRAM_ATTR necEncode(
+  const void *data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_data_t *symbols, bool *done, void *arg
+) {
+  const uint8_t *frame = (const uint8_t *)data;
+  size_t n = 0;
+  while (n < symbols_free && symbols_written + n < NEC_SYMBOLS) {
+    size_t i = symbols_written + n;
+    if (i == 0) {
+      symbols[n] = nec_leader;
+    } else if (i <= 32) {
+      // LSB first
+      uint8_t bit = (frame[(i - 1) / 8] >> ((i - 1) % 8)) & 1;
+      symbols[n] = bit ? nec_one : nec_zero;
+    } else {
+      symbols[n] = nec_stop;
+    }
+    n++;
+  }
+  if (symbols_written + n == NEC_SYMBOLS) {
+    *done = true;
+  }
+  return n;
+}
+
+// Frames must stay valid until they are sent
+static uint8_t frames[4][4];
+
+static void necFrame(uint8_t *frame, uint8_t address, uint8_t command) {
+  frame[0] = address;
+  frame[1] = ~address;
+  frame[2] = command;
+  frame[3] = ~command;
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  if (!rmtInit(IR_TX_GPIO, RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, NEC_RMT_FREQ)) {
+    Serial.println("RMT init failed");
+    return;
+  }
+  // 38kHz carrier with 33% duty cycle
+  rmtSetCarrier(IR_TX_GPIO, true, false, 38000, 0.33);
+  if (!rmtSetEncoder(IR_TX_GPIO, necEncode, NULL, 1)) {
+    Serial.println("RMT encoder setup failed");
+    return;
+  }
+  Serial.println("Sending NEC commands, Ctrl+C to stop.");
+}
+
+void loop() {
+  static uint8_t command = 0;
+
+  // queue 4 commands, they are sent without gaps beyond the NEC timing
+  for (int i = 0; i < 4; i++) {
+    necFrame(frames[i], 0x10, command + i);
+    if (!rmtWriteEncodedQueued(IR_TX_GPIO, frames[i], sizeof(frames[i]))) {
+      Serial.println("RMT queue full");
+    }
+  }
+  Serial.printf("Queued commands 0x%02X to 0x%02X\n", command, command + 3);
+  command += 4;
+
+  // the frames are in use until they are sent
+  rmtWaitTransmitCompleted(IR_TX_GPIO, 1000);
+  delay(500);
+}
@@ -0,0 +1,64 @@
+/*
+ Multiplexed alarms example
+
+ This example runs several alarms on one hardware timer: a LED blinking every
+ 250 ms, a sample taken every 10 ms and a one-shot alarm that the sampling
+ callback reschedules from the interrupt while the IO0 button is released.
+ The alarm statistics are printed every second.
+
+ This example code is in the public domain.
+ */
+
+#include <Arduino.h>
+
+#define LED_PIN   2
+#define INPUT_PIN 0
+
+// 1 MHz, 1 tick = 1 us
+#define TIMER_FREQ 1000000
+
+hw_timer_t *timer = NULL;
+int blinkAlarm, sampleAlarm, timeoutAlarm;
+
+volatile uint32_t samples = 0;
+volatile uint32_t timeouts = 0;
+
+void ARDUINO_ISR_ATTR onBlink(void *arg) {
+  digitalWrite(LED_PIN, !digitalRead(LED_PIN));
+}
+
+void ARDUINO_ISR_ATTR onSample(void *arg) {
+  samples = samples + 1;
+  // the timeout is pushed back by 50 ms as long as the input is high
+  if (digitalRead(INPUT_PIN)) {
+    timerScheduleAlarm(timer, timeoutAlarm, 50000, 0);
+  }
+}
+
+void ARDUINO_ISR_ATTR onTimeout(void *arg) {
+  timeouts = timeouts + 1;
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_PIN, OUTPUT);
+  pinMode(INPUT_PIN, INPUT_PULLUP);
+
+  timer = timerBegin(TIMER_FREQ);
+  blinkAlarm = timerAddAlarm(timer, onBlink, NULL);
+  sampleAlarm = timerAddAlarm(timer, onSample, NULL);
+  timeoutAlarm = timerAddAlarm(timer, onTimeout, NULL);
+
+  timerScheduleAlarm(timer, blinkAlarm, 250000, 250000);
+  timerScheduleAlarm(timer, sampleAlarm, 10000, 10000);
+}
+
+void loop() {
+  timer_alarm_stats_t stats;
+  timerGetAlarmStats(timer, &stats, true);
+  Serial.printf(
+    "samples: %lu, timeouts: %lu, alarms: %lu, missed: %lu, latency max %lu us, avg %lu us\n", (unsigned long)samples, (unsigned long)timeouts,
+    (unsigned long)stats.fired, (unsigned long)stats.missed, (unsigned long)stats.max_latency, (unsigned long)stats.avg_latency
+  );
+  delay(1000);
+}
@@ -0,0 +1,57 @@
+/*
+This is an example how to scan several touch pads in the background.
+The touch sensor measures the pads by itself, their values are filtered into
+a baseline and a noise level every 10 ms, and press / release events are
+reported without any touchRead() in the loop.
+*/
+
+#include <Arduino.h>
+
+const uint8_t pads[] = {T2, T3, T4, T5};
+#define NUM_PADS (sizeof(pads) / sizeof(pads[0]))
+
+QueueHandle_t touchEvents;
+
+// runs in the esp_timer task, hand the event over to the loop
+void onTouchEvent(const touch_event_t *event, void *arg) {
+  xQueueSend(touchEvents, event, 0);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);  // give me time to bring up serial monitor
+
+  touchEvents = xQueueCreate(16, sizeof(touch_event_t));
+  Serial.println("ESP32 Touch Scan Test");
+  if (!touchScanBegin(pads, NUM_PADS, 10, onTouchEvent, NULL)) {
+    Serial.println("Touch scan failed to start");
+  }
+}
+
+void loop() {
+  touch_event_t event;
+  uint32_t last = millis();
+  while (millis() - last < 2000) {
+    if (xQueueReceive(touchEvents, &event, pdMS_TO_TICKS(100))) {
+      Serial.printf(
+        "Pin %u %s, delta %ld, after %lu us\n", event.pin, event.pressed ? "pressed" : "released", (long)event.delta, (unsigned long)event.latency_us
+      );
+    }
+  }
+
+  touch_channel_state_t states[NUM_PADS];
+  size_t count = touchScanSnapshot(states, NUM_PADS);
+  for (size_t i = 0; i < count; i++) {
+    Serial.printf(
+      "Pin %u: value %lu, baseline %lu, noise %lu%s\n", states[i].pin, (unsigned long)states[i].value, (unsigned long)states[i].baseline,
+      (unsigned long)states[i].noise, states[i].pressed ? ", pressed" : ""
+    );
+  }
+
+  touch_scan_stats_t stats;
+  touchScanGetStats(&stats, true);
+  Serial.printf(
+    "%lu scans of %lu us on average (max %lu us), CPU %lu.%lu%%, max latency %lu us\n\n", (unsigned long)stats.scans, (unsigned long)stats.avg_scan_us,
+    (unsigned long)stats.max_scan_us, (unsigned long)(stats.cpu_permille / 10), (unsigned long)(stats.cpu_permille % 10), (unsigned long)stats.max_latency_us
+  );
+}
@@ -0,0 +1,90 @@
+/**
+ * AsyncRequests.ino
+ *
+ * Uploads readings to several servers at once from loop(), without a task
+ * per request. Each HTTPClient runs its own request, poll() advances it
+ * (connect, TLS handshake for https, send, response head, body) without
+ * waiting for the network. Resolving a host name still blocks, so the
+ * urls use IP addresses.
+ *
+ */
+
+#include <Arduino.h>
+
+#include <WiFi.h>
+#include <WiFiMulti.h>
+
+#include <HTTPClient.h>
+
+WiFiMulti wifiMulti;
+
+const char *urls[] = {
+  "http://192.168.1.12/upload",
+  "http://192.168.1.13/upload",
+  "http://192.168.1.14/upload",
+};
+
+#define NUM_REQUESTS (sizeof(urls) / sizeof(urls[0]))
+
+HTTPClient clients[NUM_REQUESTS];
+char payloads[NUM_REQUESTS][64];
+unsigned long lastUpload = 0;
+
+void setup() {
+
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println();
+  Serial.println();
+
+  for (uint8_t t = 4; t > 0; t--) {
+    Serial.printf("[SETUP] WAIT %u...\n", t);
+    Serial.flush();
+    delay(1000);
+  }
+
+  wifiMulti.addAP("SSID", "PASSWORD");
+
+  for (size_t i = 0; i < NUM_REQUESTS; i++) {
+    // print the response body as it arrives
+    clients[i].onAsyncBody([i](const uint8_t *data, size_t len) {
+      Serial.printf("[HTTP %u] %.*s\n", (unsigned)i, (int)len, (const char *)data);
+      return true;
+    });
+    clients[i].onAsyncDone([i](HTTPClient &http, int code) {
+      if (code > 0) {
+        Serial.printf("[HTTP %u] POST... code: %d\n", (unsigned)i, code);
+      } else {
+        Serial.printf("[HTTP %u] POST... failed, error: %s\n", (unsigned)i, HTTPClient::errorToString(code).c_str());
+      }
+      http.end();
+    });
+  }
+}
+
+void loop() {
+  // wait for WiFi connection
+  if ((wifiMulti.run() == WL_CONNECTED) && (millis() - lastUpload > 5000)) {
+    lastUpload = millis();
+
+    for (size_t i = 0; i < NUM_REQUESTS; i++) {
+      if (clients[i].asyncState() != HTTPC_ASYNC_IDLE) {
+        // previous upload still running
+        continue;
+      }
+      // the payload must stay valid until the request is done
+      int len = snprintf(payloads[i], sizeof(payloads[i]), "{\"uptime\":%lu}", lastUpload);
+      clients[i].begin(urls[i]);
+      clients[i].addHeader("Content-Type", "application/json");
+      clients[i].POSTAsync((const uint8_t *)payloads[i], len);
+    }
+  }
+
+  for (size_t i = 0; i < NUM_REQUESTS; i++) {
+    clients[i].poll();
+  }
+
+  // other work keeps running while the requests are in flight
+  delay(1);
+}
@@ -0,0 +1,75 @@
+/**
+ * ConnectionPool.ino
+ *
+ * Several HTTPClient objects talking to a set of backends in rotation.
+ * Keep-alive connections are parked in the global httpConnectionPool after
+ * http.end(), so the next request to the same host (from any HTTPClient)
+ * skips the TCP and TLS setup.
+ *
+ */
+
+#include <Arduino.h>
+
+#include <WiFi.h>
+#include <WiFiMulti.h>
+
+#include <HTTPClient.h>
+
+WiFiMulti wifiMulti;
+
+const char *urls[] = {
+  "http://192.168.1.12/sensor",
+  "http://192.168.1.13/status",
+  "http://192.168.1.14/config",
+};
+
+void setup() {
+
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println();
+  Serial.println();
+
+  for (uint8_t t = 4; t > 0; t--) {
+    Serial.printf("[SETUP] WAIT %u...\n", t);
+    Serial.flush();
+    delay(1000);
+  }
+
+  wifiMulti.addAP("SSID", "PASSWORD");
+
+  // keep at most one idle connection per host, close it after 20 s without use
+  httpConnectionPool.setMaxPerHost(1);
+  httpConnectionPool.setIdleTimeout(20000);
+}
+
+void loop() {
+  // wait for WiFi connection
+  if ((wifiMulti.run() == WL_CONNECTED)) {
+
+    for (const char *url : urls) {
+      HTTPClient http;
+      http.setConnectionPool(&httpConnectionPool);
+      http.begin(url);
+
+      int httpCode = http.GET();
+      if (httpCode > 0) {
+        Serial.printf("[HTTP] GET %s... code: %d\n", url, httpCode);
+        http.getString();
+      } else {
+        Serial.printf("[HTTP] GET %s... failed, error: %s\n", url, http.errorToString(httpCode).c_str());
+      }
+
+      // hands the connection back to the pool if the server allows keep-alive
+      http.end();
+    }
+
+    Serial.printf(
+      "[POOL] idle: %u hits: %lu misses: %lu evictions: %lu\n", (unsigned)httpConnectionPool.idleCount(), (unsigned long)httpConnectionPool.hits(),
+      (unsigned long)httpConnectionPool.misses(), (unsigned long)httpConnectionPool.evictions()
+    );
+  }
+
+  delay(1000);
+}
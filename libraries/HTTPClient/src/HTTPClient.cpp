@@ -28,9 +28,19 @@
 
 #include <Arduino.h>
 #include <esp32-hal-log.h>
+#include <new>
 #include <StreamString.h>
 #include <base64.h>
+#include <lwip/sockets.h>
 #include "HTTPClient.h"
+#ifndef HTTPCLIENT_NOSECURE
+#include "mbedtls/version.h"
+#if MBEDTLS_VERSION_MAJOR >= 4
+#include <psa/crypto.h>
+#else
+#include <mbedtls/sha256.h>
+#endif
+#endif
 
 /// Cookie jar support
 #include <time.h>
@@ -61,6 +71,28 @@ static bool parseHttpPortString(const String &port_str, uint16_t &port_out) {
   return true;
 }
 
+// Corks a client for the lifetime of the guard, so early error returns cannot leave it corked.
+class HTTPCorkGuard {
+public:
+  explicit HTTPCorkGuard(NetworkClient *client) : _client(client) {
+    if (_client) {
+      _client->cork();
+    }
+  }
+  ~HTTPCorkGuard() {
+    release();
+  }
+  void release() {
+    if (_client) {
+      _client->uncork();
+      _client = nullptr;
+    }
+  }
+
+private:
+  NetworkClient *_client;
+};
+
 #ifdef HTTPCLIENT_1_1_COMPATIBLE
 class TransportTraits {
 public:
@@ -73,6 +105,13 @@ public:
   virtual bool verify(NetworkClient &client, const char *host) {
     return true;
   }
+
+  // distinguishes connections with different trust settings in a HTTPConnectionPool,
+  // false if the connection must not be pooled
+  virtual bool identity(String &id) {
+    id = String();
+    return true;
+  }
 };
 
 #ifndef HTTPCLIENT_NOSECURE
@@ -96,6 +135,60 @@ public:
     return true;
   }
 
+  // SHA-256 of the certificate and key contents: a buffer rewritten with another CA never matches
+  // a pooled session, while the same certificate held in different buffers does
+  bool identity(String &id) override {
+    if (_cacert == nullptr) {
+      id = "insecure";
+      return true;
+    }
+    const char *parts[] = {_cacert, _clicert, _clikey};
+    uint8_t digest[32];
+#if MBEDTLS_VERSION_MAJOR >= 4
+    psa_hash_operation_t op = PSA_HASH_OPERATION_INIT;
+    size_t digestLen = 0;
+    bool ok = psa_hash_setup(&op, PSA_ALG_SHA_256) == PSA_SUCCESS;
+#else
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    bool ok = mbedtls_sha256_starts(&ctx, false) == 0;
+#endif
+    for (const char *part : parts) {
+      // each part is prefixed with its length, or ~0 when not set, so contents cannot shift between parts
+      uint32_t len = part ? strlen(part) : UINT32_MAX;
+      uint8_t prefix[4] = {(uint8_t)(len >> 24), (uint8_t)(len >> 16), (uint8_t)(len >> 8), (uint8_t)len};
+#if MBEDTLS_VERSION_MAJOR >= 4
+      ok = ok && psa_hash_update(&op, prefix, sizeof(prefix)) == PSA_SUCCESS;
+      ok = ok && (part == nullptr || psa_hash_update(&op, (const uint8_t *)part, len) == PSA_SUCCESS);
+#else
+      ok = ok && mbedtls_sha256_update(&ctx, prefix, sizeof(prefix)) == 0;
+      ok = ok && (part == nullptr || mbedtls_sha256_update(&ctx, (const uint8_t *)part, len) == 0);
+#endif
+    }
+#if MBEDTLS_VERSION_MAJOR >= 4
+    ok = ok && psa_hash_finish(&op, digest, sizeof(digest), &digestLen) == PSA_SUCCESS;
+    if (!ok) {
+      psa_hash_abort(&op);
+    }
+#else
+    ok = ok && mbedtls_sha256_finish(&ctx, digest) == 0;
+    mbedtls_sha256_free(&ctx);
+#endif
+    if (!ok) {
+      log_e("failed to hash the TLS credentials, connection is not pooled");
+      return false;
+    }
+    static const char hex[] = "0123456789abcdef";
+    char out[sizeof(digest) * 2 + 1];
+    for (size_t i = 0; i < sizeof(digest); i++) {
+      out[i * 2] = hex[digest[i] >> 4];
+      out[i * 2 + 1] = hex[digest[i] & 0x0f];
+    }
+    out[sizeof(out) - 1] = '\0';
+    id = out;
+    return true;
+  }
+
 protected:
   const char *_cacert;
   const char *_clicert;
@@ -338,9 +431,13 @@ bool HTTPClient::beginInternal(String url, const char *expectedProtocol) {
     }
   }
   if (_host != the_host && connected()) {
-    log_d("switching host from '%s' to '%s'. disconnecting first", _host.c_str(), the_host.c_str());
-    _canReuse = false;
-    disconnect(true);
+    if (releaseToPool()) {
+      log_d("switching host from '%s' to '%s'. previous connection returned to pool", _host.c_str(), the_host.c_str());
+    } else {
+      log_d("switching host from '%s' to '%s'. disconnecting first", _host.c_str(), the_host.c_str());
+      _canReuse = false;
+      disconnect(true);
+    }
   }
   _host = the_host;
   _uri = url;
@@ -413,6 +510,7 @@ bool HTTPClient::begin(String host, uint16_t port, String uri, const char *CAcer
  * called after the payload is handled
  */
 void HTTPClient::end(void) {
+  abortAsync();
   disconnect(false);
   clear();
 }
@@ -423,13 +521,20 @@ void HTTPClient::end(void) {
  */
 void HTTPClient::disconnect(bool preserveClient) {
   if (connected()) {
+    // the unread rest of a response would be taken for the next response of a pooled connection
+    bool poolable = !_pool || _poolKey.length() == 0 || preserveClient || (bodyConsumed() && _client->available() == 0);
+
     if (_client->available() > 0) {
       log_d("still data in buffer (%d), clean up.\n", _client->available());
       _client->clear();
     }
 
-    if (_reuse && _canReuse) {
-      log_d("tcp keep open for reuse");
+    if (_reuse && _canReuse && poolable) {
+      if (!preserveClient && releaseToPool()) {
+        log_d("tcp returned to connection pool");
+      } else {
+        log_d("tcp keep open for reuse");
+      }
     } else {
       log_d("tcp stop");
       _client->stop();
@@ -468,6 +573,52 @@ void HTTPClient::setReuse(bool reuse) {
   _reuse = reuse;
 }
 
+/**
+ * share idle keep-alive connections with other HTTPClient objects.
+ * Only connections created by HTTPClient itself (begin(url), begin(url, CAcert), ...)
+ * are pooled, clients passed to begin(NetworkClient &, ...) belong to the caller.
+ * @param pool HTTPConnectionPool * (nullptr to disable)
+ */
+void HTTPClient::setConnectionPool(HTTPConnectionPool *pool) {
+  _pool = pool;
+}
+
+/**
+ * hand the current connection to the connection pool if it can be reused
+ * @return true if the connection was detached from this object
+ */
+bool HTTPClient::releaseToPool() {
+#ifdef HTTPCLIENT_1_1_COMPATIBLE
+  if (!_pool || !_tcpDeprecated || _poolKey.length() == 0 || !_reuse || !_canReuse) {
+    return false;
+  }
+  if (!bodyConsumed() || _client->available() > 0) {
+    log_d("response not fully read, not returned to pool");
+    return false;
+  }
+  _client = nullptr;
+  _pool->release(_poolKey, std::move(_tcpDeprecated));
+  _poolKey = "";
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * checks if the connection is at the end of a response
+ * @return true if the body was read to its end, or was announced empty
+ */
+bool HTTPClient::bodyConsumed() {
+  if (!_parser || !_parser->headersComplete()) {
+    return false;
+  }
+  if (_parser->done()) {
+    return true;
+  }
+  return _transferEncoding == HTTPC_TE_IDENTITY && _size == 0;
+}
+
 /**
  * set User Agent
  * @param userAgent const char *
@@ -618,15 +769,7 @@ int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size) {
   bool redirect = false;
   uint16_t redirectCount = 0;
   do {
-    // wipe out any existing headers from previous request, but preserve the keys if collecting specific headers
-    if (_collectAllHeaders) {
-      _currentHeaders.clear();
-    } else {
-      // Only clear values, keep the keys for specific header collection
-      for (size_t i = 0; i < _currentHeaders.size(); ++i) {
-        _currentHeaders[i].value.clear();
-      }
-    }
+    resetResponseHeaders();
 
     log_d("request type: '%s' redirCount: %u\n", type, redirectCount);
 
@@ -635,15 +778,10 @@ int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size) {
       return returnError(HTTPC_ERROR_CONNECTION_REFUSED);
     }
 
-    if (payload && size > 0) {
-      addHeader(F("Content-Length"), String(size));
-    }
+    addRequestHeaders(payload ? size : 0);
 
-    // add cookies to header, if present
-    String cookie_string;
-    if (generateCookieString(&cookie_string)) {
-      addHeader("Cookie", cookie_string);
-    }
+    // send header and payload in as few TCP segments (or TLS records) as possible
+    HTTPCorkGuard cork(payload && size > 0 ? _client : nullptr);
 
     // send Header
     if (!sendHeader(type)) {
@@ -671,6 +809,9 @@ int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size) {
       }
     }
 
+    // the redirect handling below may replace _client
+    cork.release();
+
     code = handleHeaderResponse();
     log_d("sendRequest code=%d\n", code);
 
@@ -734,6 +875,326 @@ int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size) {
   return returnError(code);
 }
 
+/**
+ * wipe out any existing headers from previous request, but preserve the keys if collecting specific headers
+ */
+void HTTPClient::resetResponseHeaders() {
+  // the previous response is over, bodyConsumed() must not report it for the next one
+  if (_parser) {
+    _parser->reset();
+  }
+  if (_collectAllHeaders) {
+    _currentHeaders.clear();
+  } else {
+    // Only clear values, keep the keys for specific header collection
+    for (size_t i = 0; i < _currentHeaders.size(); ++i) {
+      _currentHeaders[i].value.clear();
+    }
+  }
+}
+
+/**
+ * adds the Content-Length and Cookie headers of a request
+ * @param contentLength size_t   0 if the request has no body
+ */
+void HTTPClient::addRequestHeaders(size_t contentLength) {
+  if (contentLength > 0) {
+    addHeader(F("Content-Length"), String(contentLength));
+  }
+
+  // add cookies to header, if present
+  String cookie_string;
+  if (generateCookieString(&cookie_string)) {
+    addHeader("Cookie", cookie_string);
+  }
+}
+
+/**
+ * start a GET request without blocking, see sendRequestAsync()
+ * @return true if the request was started
+ */
+bool HTTPClient::GETAsync() {
+  return sendRequestAsync("GET");
+}
+
+/**
+ * start a POST request without blocking, see sendRequestAsync()
+ * @param payload const uint8_t *   must stay valid until the request is finished
+ * @param size size_t
+ * @return true if the request was started
+ */
+bool HTTPClient::POSTAsync(const uint8_t *payload, size_t size) {
+  return sendRequestAsync("POST", payload, size);
+}
+
+/**
+ * start a request and return immediately. The request is driven by poll(),
+ * so a single task can keep requests to several hosts in flight, each with
+ * its own HTTPClient. Redirects are not followed.
+ *
+ * The DNS lookup of the host still blocks inside this call. The TCP connect
+ * and, for https, the TLS handshake are advanced by poll() without waiting
+ * for the network, but each handshake step spends its crypto time (key
+ * exchange, certificate verification) inside poll().
+ *
+ * @param type const char *         "GET", "POST", .... (must stay valid until the request is finished)
+ * @param payload const uint8_t *   data for the message body, must stay valid until the request is finished
+ * @param size size_t               size for the message body if 0 not send
+ * @return true if the request was started, else asyncResult() holds the error
+ */
+bool HTTPClient::sendRequestAsync(const char *type, const uint8_t *payload, size_t size) {
+  if (_asyncState > HTTPC_ASYNC_IDLE && _asyncState < HTTPC_ASYNC_DONE) {
+    log_e("request already in progress");
+    return false;
+  }
+
+  resetResponseHeaders();
+
+  _asyncType = type;
+  _asyncPayload = payload;
+  _asyncSize = payload ? size : 0;
+  _asyncSent = 0;
+  _asyncResult = 0;
+  _asyncLastActivity = millis();
+
+  log_d("async request type: '%s'", type);
+
+  if (connected()) {
+    // reuse the keep-alive connection
+    if (!connect()) {
+      asyncFinish(HTTPC_ERROR_CONNECTION_REFUSED);
+      return false;
+    }
+    _asyncState = HTTPC_ASYNC_CONNECTING;
+  } else {
+    int prepared = prepareClient();
+    if (prepared < 0) {
+      asyncFinish(HTTPC_ERROR_CONNECTION_REFUSED);
+      return false;
+    }
+    if (prepared == 0) {
+      if (!_client->connectAsync(_host.c_str(), _port)) {
+        log_d("failed connect to %s:%u", _host.c_str(), _port);
+        asyncFinish(HTTPC_ERROR_CONNECTION_REFUSED);
+        return false;
+      }
+    }
+    _asyncState = HTTPC_ASYNC_CONNECTING;
+  }
+
+  addRequestHeaders(_asyncSize);
+  return true;
+}
+
+/**
+ * advance the request started with sendRequestAsync() with the data that is
+ * already there, without waiting for the network. A TLS handshake step still
+ * takes its crypto time here.
+ * @return current state
+ */
+httpc_async_state_t HTTPClient::poll() {
+  switch (_asyncState) {
+    case HTTPC_ASYNC_CONNECTING:
+    case HTTPC_ASYNC_HANDSHAKE:
+    {
+      int res = _client->connecting() ? _client->connectPoll() : (connected() ? 1 : -1);
+      if (res < 0) {
+        log_d("failed connect to %s:%u", _host.c_str(), _port);
+        asyncFinish(HTTPC_ERROR_CONNECTION_REFUSED);
+        break;
+      }
+      if (res == 0) {
+        if (_client->handshaking()) {
+          // TCP is up, the handshake is bounded by the handshake timeout of the client
+          _asyncState = HTTPC_ASYNC_HANDSHAKE;
+        } else if (_connectTimeout >= 0 && (millis() - _asyncLastActivity) > (unsigned long)_connectTimeout) {
+          log_d("connect to %s:%u timed out", _host.c_str(), _port);
+          asyncFinish(HTTPC_ERROR_CONNECTION_REFUSED);
+        }
+        break;
+      }
+
+      // set Timeout for NetworkClient and for Stream::readBytesUntil() and Stream::readStringUntil()
+      _client->setTimeout(_tcpTimeout);
+      log_d(" connected to %s:%u", _host.c_str(), _port);
+
+      // the request head is small enough to go straight into the socket send buffer
+      if (!sendHeader(_asyncType)) {
+        asyncFinish(HTTPC_ERROR_SEND_HEADER_FAILED);
+        break;
+      }
+      _asyncLastActivity = millis();
+      _asyncState = HTTPC_ASYNC_SENDING;
+    }
+    // fall through
+    case HTTPC_ASYNC_SENDING:
+    {
+      if (_asyncSent < _asyncSize) {
+        // only write what fits into the socket now
+        fd_set set;
+        struct timeval tv = {0, 0};
+        int fd = _client->fd();
+        FD_ZERO(&set);
+        if (fd >= 0) {
+          FD_SET(fd, &set);
+        }
+        if (fd < 0 || select(fd + 1, NULL, &set, NULL, &tv) < 0) {
+          asyncFinish(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+          break;
+        }
+        if (!FD_ISSET(fd, &set)) {
+          if ((millis() - _asyncLastActivity) > _tcpTimeout) {
+            asyncFinish(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+          }
+          break;
+        }
+        size_t toSend = _asyncSize - _asyncSent;
+        if (toSend > HTTP_TCP_TX_BUFFER_SIZE) {
+          toSend = HTTP_TCP_TX_BUFFER_SIZE;
+        }
+        size_t sent = _client->write(_asyncPayload + _asyncSent, toSend);
+        if (sent == 0) {
+          log_e("Failed to send chunk!");
+          asyncFinish(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+          break;
+        }
+        _asyncSent += sent;
+        _asyncLastActivity = millis();
+        if (_asyncSent < _asyncSize) {
+          break;
+        }
+      }
+
+      if (!beginHeaderResponse()) {
+        asyncFinish(HTTPC_ERROR_TOO_LESS_RAM);
+        break;
+      }
+      _asyncState = HTTPC_ASYNC_HEADERS;
+    }
+    // fall through
+    case HTTPC_ASYNC_HEADERS:
+    {
+      if (_client->available() <= 0) {
+        if (!connected()) {
+          asyncFinish(HTTPC_ERROR_CONNECTION_LOST);
+        } else if ((millis() - _asyncLastActivity) > _tcpTimeout) {
+          asyncFinish(HTTPC_ERROR_READ_TIMEOUT);
+        }
+        break;
+      }
+      _asyncLastActivity = millis();
+
+      int code = readHeaderResponse();
+      if (code == 0) {
+        break;
+      }
+      log_d("async request code=%d", code);
+      if (code < 0 || !_asyncBodySink) {
+        asyncFinish(code);
+        break;
+      }
+
+      _asyncBufferSize = beginBody(_asyncBodySink);
+      if (_asyncBufferSize < 0) {
+        asyncFinish(_asyncBufferSize);
+        break;
+      }
+      _asyncBuffer.reset(new (std::nothrow) uint8_t[_asyncBufferSize]);
+      if (!_asyncBuffer) {
+        log_w("too less ram! need %d", _asyncBufferSize);
+        asyncFinish(HTTPC_ERROR_TOO_LESS_RAM);
+        break;
+      }
+      _asyncState = HTTPC_ASYNC_BODY;
+    }
+    // fall through
+    case HTTPC_ASYNC_BODY:
+    {
+      if (!_parser->done()) {
+        int bytesRead = readBodyBlock(_asyncBuffer.get(), _asyncBufferSize);
+        if (bytesRead < 0) {
+          asyncFinish(bytesRead);
+          break;
+        }
+        if (bytesRead > 0) {
+          _asyncLastActivity = millis();
+        } else if (!connected()) {
+          // without Content-Length the body ends when the server closes the connection
+          if (!(_transferEncoding == HTTPC_TE_IDENTITY && _size < 0)) {
+            asyncFinish(HTTPC_ERROR_CONNECTION_LOST);
+            break;
+          }
+        } else {
+          if ((millis() - _asyncLastActivity) > _tcpTimeout) {
+            asyncFinish(HTTPC_ERROR_READ_TIMEOUT);
+          }
+          break;
+        }
+        if (!_parser->done() && connected()) {
+          break;
+        }
+      }
+
+      int ret = endBody();
+      if (ret < 0) {
+        asyncFinish(ret);
+        break;
+      }
+      disconnect(true);
+      asyncFinish(_returnCode);
+      break;
+    }
+    default: break;
+  }
+  return _asyncState;
+}
+
+/**
+ * stop the request started with sendRequestAsync() and close the connection
+ */
+void HTTPClient::abortAsync() {
+  if (_asyncState > HTTPC_ASYNC_IDLE && _asyncState < HTTPC_ASYNC_DONE) {
+    _canReuse = false;
+    if (_client) {
+      _client->stop();
+    }
+  }
+  _asyncBuffer.reset();
+  _asyncState = HTTPC_ASYNC_IDLE;
+}
+
+/**
+ * let poll() hand the response body to sink as it arrives.
+ * Without a body callback the request is done after the response head and
+ * the body can be read with getString(), getStream(), ...
+ * @param sink HTTPResponseParser::BodySink   return false to abort
+ */
+void HTTPClient::onAsyncBody(HTTPResponseParser::BodySink sink) {
+  _asyncBodySink = sink;
+}
+
+/**
+ * called once from poll() when the request is done or has failed
+ * @param callback AsyncCallback   receives the http code or HTTPC_ERROR_*
+ */
+void HTTPClient::onAsyncDone(AsyncCallback callback) {
+  _asyncDoneCallback = callback;
+}
+
+void HTTPClient::asyncFinish(int code) {
+  _asyncBuffer.reset();
+  _asyncResult = code;
+  if (code < 0) {
+    returnError(code);
+    _asyncState = HTTPC_ASYNC_FAILED;
+  } else {
+    _asyncState = HTTPC_ASYNC_DONE;
+  }
+  if (_asyncDoneCallback) {
+    _asyncDoneCallback(*this, code);
+  }
+}
+
 /**
  * sendRequest
  * @param type const char *     "GET", "POST", ....
@@ -924,73 +1385,110 @@ int HTTPClient::writeToStream(Stream *stream) {
     return returnError(HTTPC_ERROR_NO_STREAM);
   }
 
-  if (!connected()) {
-    return returnError(HTTPC_ERROR_NOT_CONNECTED);
-  }
+  return writeToCallback([stream](const uint8_t *data, size_t len) -> bool {
+    size_t bytesWrite = stream->write(data, len);
 
-  // get length of document (is -1 when Server sends no Content-Length header)
-  int len = _size;
-  int ret = 0;
+    // are all Bytes a written to stream ?
+    if (bytesWrite != len) {
+      log_d("short write asked for %u but got %u retry...", (unsigned)len, (unsigned)bytesWrite);
 
-  if (_transferEncoding == HTTPC_TE_IDENTITY) {
-    ret = writeToStreamDataBlock(stream, len);
+      // check for write error
+      if (stream->getWriteError()) {
+        log_d("stream write error %d", stream->getWriteError());
 
-    // have we an error?
-    if (ret < 0) {
-      return returnError(ret);
-    }
-  } else if (_transferEncoding == HTTPC_TE_CHUNKED) {
-    int size = 0;
-    while (1) {
-      if (!connected()) {
-        return returnError(HTTPC_ERROR_CONNECTION_LOST);
+        //reset write error for retry
+        stream->clearWriteError();
       }
-      String chunkHeader = _client->readStringUntil('\n');
 
-      if (chunkHeader.length() <= 0) {
-        return returnError(HTTPC_ERROR_READ_TIMEOUT);
+      // some time for the stream
+      delay(1);
+
+      size_t leftBytes = len - bytesWrite;
+
+      // retry to send the missed bytes
+      if (stream->write(data + bytesWrite, leftBytes) != leftBytes) {
+        // failed again
+        log_w("short write asked for %u failed.", (unsigned)leftBytes);
+        return false;
       }
+    }
 
-      chunkHeader.trim();  // remove \r
+    // check for write error
+    if (stream->getWriteError()) {
+      log_w("stream write error %d", stream->getWriteError());
+      return false;
+    }
+    return true;
+  });
+}
 
-      // read size of chunk
-      len = (uint32_t)strtol((const char *)chunkHeader.c_str(), NULL, 16);
-      size += len;
-      log_v(" read chunk len: %d", len);
+/**
+ * pass the message body / payload to a callback in blocks, as it is received.
+ * The data is handed over straight from the receive buffer, chunked
+ * transfer encoding is removed.
+ * @param sink HTTPResponseParser::BodySink   return false to abort
+ * @return bytes passed to sink ( negative values are error codes )
+ */
+int HTTPClient::writeToCallback(HTTPResponseParser::BodySink sink) {
 
-      // data left?
-      if (len > 0) {
-        int r = writeToStreamDataBlock(stream, len);
-        if (r < 0) {
-          // error in writeToStreamDataBlock
-          return returnError(r);
-        }
-        ret += r;
-      } else {
+  if (!sink) {
+    return returnError(HTTPC_ERROR_NO_STREAM);
+  }
 
-        // if no length Header use global chunk size
-        if (_size <= 0) {
-          _size = size;
-        }
+  if (!connected() || !_parser) {
+    return returnError(HTTPC_ERROR_NOT_CONNECTED);
+  }
 
-        // check if we have write all data out
-        if (ret != _size) {
-          return returnError(HTTPC_ERROR_STREAM_WRITE);
-        }
+  int buff_size = beginBody(sink);
+  if (buff_size < 0) {
+    return returnError(buff_size);
+  }
+
+  // create buffer for read
+  uint8_t *buff = (uint8_t *)malloc(buff_size);
+  if (!buff) {
+    log_w("too less ram! need %d", buff_size);
+    return returnError(HTTPC_ERROR_TOO_LESS_RAM);
+  }
+
+  int ret = 0;
+  unsigned long lastDataTime = millis();
+  while (!_parser->done()) {
+    if (!connected()) {
+      // without Content-Length the body ends when the server closes the connection
+      if (_transferEncoding == HTTPC_TE_IDENTITY && _size < 0) {
         break;
       }
+      ret = HTTPC_ERROR_CONNECTION_LOST;
+      break;
+    }
 
-      // read trailing \r\n at the end of the chunk
-      char buf[2];
-      auto trailing_seq_len = _client->readBytes((uint8_t *)buf, 2);
-      if (trailing_seq_len != 2 || buf[0] != '\r' || buf[1] != '\n') {
-        return returnError(HTTPC_ERROR_READ_TIMEOUT);
+    int bytesRead = readBodyBlock(buff, buff_size);
+    if (bytesRead < 0) {
+      ret = bytesRead;
+      break;
+    }
+    if (bytesRead == 0) {
+      if ((millis() - lastDataTime) > _tcpTimeout) {
+        ret = HTTPC_ERROR_READ_TIMEOUT;
+        break;
       }
-
-      delay(0);
+      delay(1);
+      continue;
     }
-  } else {
-    return returnError(HTTPC_ERROR_ENCODING);
+    lastDataTime = millis();
+
+    delay(0);
+  }
+
+  free(buff);
+
+  if (ret == 0) {
+    ret = endBody();
+  }
+
+  if (ret < 0) {
+    return returnError(ret);
   }
 
   //    end();
@@ -998,6 +1496,81 @@ int HTTPClient::writeToStream(Stream *stream) {
   return ret;
 }
 
+/**
+ * prepares the parser to hand the message body to sink
+ * @return size of the read buffer to use, or error
+ */
+int HTTPClient::beginBody(HTTPResponseParser::BodySink sink) {
+  if (_transferEncoding != HTTPC_TE_IDENTITY && _transferEncoding != HTTPC_TE_CHUNKED) {
+    return HTTPC_ERROR_ENCODING;
+  }
+
+  int buff_size = HTTP_TCP_RX_BUFFER_SIZE;
+
+  // if possible create smaller buffer then HTTP_TCP_RX_BUFFER_SIZE
+  if (_transferEncoding == HTTPC_TE_IDENTITY && (_size > 0) && (_size < buff_size)) {
+    buff_size = _size;
+  }
+
+  _parser->onBody(sink);
+  _parser->beginBody(_size, _transferEncoding == HTTPC_TE_CHUNKED);
+  return buff_size;
+}
+
+/**
+ * moves the received part of the body through the parser to the sink, never waits for data
+ * @return bytes read from the connection (0 if none were available), or error
+ */
+int HTTPClient::readBodyBlock(uint8_t *buff, int buff_size) {
+  int sizeAvailable = _client->available();
+  if (sizeAvailable <= 0) {
+    return 0;
+  }
+
+  // not read more the buffer can handle, nor past the end of an identity body
+  int readBytes = sizeAvailable > buff_size ? buff_size : sizeAvailable;
+  if (_transferEncoding == HTTPC_TE_IDENTITY && _parser->remaining() >= 0 && readBytes > _parser->remaining()) {
+    readBytes = _parser->remaining();
+  }
+
+  int bytesRead = _client->read(buff, readBytes);
+  if (bytesRead <= 0) {
+    return 0;
+  }
+
+  _parser->parseBody(buff, bytesRead);
+  if (_parser->failed()) {
+    // a broken chunk framing is reported like the former readStringUntil() timeout
+    return _parser->error() == HTTPResponseParser::PARSER_ERROR_SINK ? HTTPC_ERROR_STREAM_WRITE : HTTPC_ERROR_READ_TIMEOUT;
+  }
+  return bytesRead;
+}
+
+/**
+ * checks the amount of body data passed to the sink
+ * @return bytes passed to the sink, or error
+ */
+int HTTPClient::endBody() {
+  _parser->onBody(nullptr);
+
+  int ret = _parser->bodyBytes();
+  log_v("connection closed or file end (written: %d).", ret);
+
+  if (_transferEncoding == HTTPC_TE_CHUNKED) {
+    // if no length Header use global chunk size
+    if (_size <= 0) {
+      _size = ret;
+    }
+  }
+
+  // check if we have write all data out
+  if ((_size > 0) && (_size != ret)) {
+    log_d("bytesWritten %d and size %d mismatch!.", ret, _size);
+    return HTTPC_ERROR_STREAM_WRITE;
+  }
+  return ret;
+}
+
 /**
  * return all payload as String (may need lot of ram or trigger out of memory!)
  * @return String
@@ -1141,12 +1714,55 @@ bool HTTPClient::connect(void) {
     return true;
   }
 
+  int prepared = prepareClient();
+  if (prepared < 0) {
+    return false;
+  } else if (prepared > 0) {
+    return true;
+  }
+
+  if (!_client->connect(_host.c_str(), _port, _connectTimeout)) {
+    log_d("failed connect to %s:%u", _host.c_str(), _port);
+    return false;
+  }
+
+  // set Timeout for NetworkClient and for Stream::readBytesUntil() and Stream::readStringUntil()
+  _client->setTimeout(_tcpTimeout);
+
+  log_d(" connected to %s:%u", _host.c_str(), _port);
+
+  /*
+#ifdef ESP8266
+    _client->setNoDelay(true);
+#endif
+ */
+  return connected();
+}
+
+/**
+ * picks a pooled connection or creates and verifies the transport client
+ * @return 1 pooled connection ready, 0 client ready to connect, -1 error
+ */
+int HTTPClient::prepareClient() {
 #ifdef HTTPCLIENT_1_1_COMPATIBLE
+  _poolKey = "";
+  String identity;
+  if (_transportTraits && !_client && _pool && _transportTraits->identity(identity)) {
+    _poolKey = HTTPConnectionPool::makeKey(_protocol, _host, _port, identity);
+    _tcpDeprecated = _pool->acquire(_poolKey);
+    if (_tcpDeprecated) {
+      _client = _tcpDeprecated.get();
+      _client->setTimeout(_tcpTimeout);
+      log_d(" reusing pooled connection to %s:%u", _host.c_str(), _port);
+      return 1;
+    }
+  }
+
   if (_transportTraits && !_client) {
     _tcpDeprecated = _transportTraits->create();
     if (!_tcpDeprecated) {
       log_e("failed to create client");
-      return false;
+      return -1;
     }
     _client = _tcpDeprecated.get();
   }
@@ -1154,31 +1770,16 @@ bool HTTPClient::connect(void) {
 
   if (!_client) {
     log_d("HTTPClient::begin was not called or returned error");
-    return false;
+    return -1;
   }
 #ifdef HTTPCLIENT_1_1_COMPATIBLE
   if (_tcpDeprecated && !_transportTraits->verify(*_client, _host.c_str())) {
     log_d("transport level verify failed");
     _client->stop();
-    return false;
-  }
-#endif
-  if (!_client->connect(_host.c_str(), _port, _connectTimeout)) {
-    log_d("failed connect to %s:%u", _host.c_str(), _port);
-    return false;
+    return -1;
   }
-
-  // set Timeout for NetworkClient and for Stream::readBytesUntil() and Stream::readStringUntil()
-  _client->setTimeout(_tcpTimeout);
-
-  log_d(" connected to %s:%u", _host.c_str(), _port);
-
-  /*
-#ifdef ESP8266
-    _client->setNoDelay(true);
 #endif
- */
-  return connected();
+  return 0;
 }
 
 /**
@@ -1241,6 +1842,12 @@ bool HTTPClient::sendHeader(const char *type) {
   return (_client->write((const uint8_t *)header.c_str(), header.length()) == header.length());
 }
 
+static String sliceToString(const HTTPResponseParser::Slice &slice) {
+  String str;
+  str.concat(slice.data, slice.len);
+  return str;
+}
+
 /**
  * reads the response from the server
  * @return int http code
@@ -1251,105 +1858,19 @@ int HTTPClient::handleHeaderResponse() {
     return HTTPC_ERROR_NOT_CONNECTED;
   }
 
-  _returnCode = 0;
-  _size = -1;
-  _canReuse = _reuse;
-
-  String transferEncoding;
+  if (!beginHeaderResponse()) {
+    return HTTPC_ERROR_TOO_LESS_RAM;
+  }
 
-  _transferEncoding = HTTPC_TE_IDENTITY;
   unsigned long lastDataTime = millis();
-  bool firstLine = true;
-  String date;
 
   while (connected()) {
-    size_t len = _client->available();
-    if (len > 0) {
-      String headerLine = _client->readStringUntil('\n');
-      headerLine.trim();  // remove \r
-
+    if (_client->available() > 0) {
+      int code = readHeaderResponse();
       lastDataTime = millis();
-
-      log_v("RX: '%s'", headerLine.c_str());
-
-      if (firstLine) {
-        firstLine = false;
-        if (_canReuse && headerLine.startsWith("HTTP/1.")) {
-          _canReuse = (headerLine[sizeof "HTTP/1." - 1] != '0');
-        }
-        int codePos = headerLine.indexOf(' ') + 1;
-        _returnCode = headerLine.substring(codePos, headerLine.indexOf(' ', codePos)).toInt();
-      } else if (headerLine.indexOf(':')) {
-        String headerName = headerLine.substring(0, headerLine.indexOf(':'));
-        String headerValue = headerLine.substring(headerLine.indexOf(':') + 1);
-        headerValue.trim();
-
-        if (headerName.equalsIgnoreCase("Date")) {
-          date = headerValue;
-        }
-
-        if (headerName.equalsIgnoreCase("Content-Length")) {
-          _size = headerValue.toInt();
-        }
-
-        if (_canReuse && headerName.equalsIgnoreCase("Connection")) {
-          if (headerValue.indexOf("close") >= 0 && headerValue.indexOf("keep-alive") < 0) {
-            _canReuse = false;
-          }
-        }
-
-        if (headerName.equalsIgnoreCase("Transfer-Encoding")) {
-          transferEncoding = headerValue;
-        }
-
-        if (headerName.equalsIgnoreCase("Location")) {
-          _location = headerValue;
-        }
-
-        if (headerName.equalsIgnoreCase("Set-Cookie")) {
-          setCookie(date, headerValue);
-        }
-
-        if (_collectAllHeaders && headerName.length() > 0) {
-          _currentHeaders.push_back({headerName, headerValue});
-        } else {
-          for (size_t i = 0; i < _currentHeaders.size(); ++i) {
-            if (_currentHeaders[i].key.equalsIgnoreCase(headerName)) {
-              _currentHeaders[i].value = headerValue;
-              break;  // We found a match, stop looking
-            }
-          }
-        }
+      if (code) {
+        return code;
       }
-
-      if (headerLine == "") {
-        log_d("code: %d", _returnCode);
-
-        if (_size > 0) {
-          log_d("size: %d", _size);
-        }
-
-        if (transferEncoding.length() > 0) {
-          log_d("Transfer-Encoding: %s", transferEncoding.c_str());
-          if (transferEncoding.equalsIgnoreCase("chunked")) {
-            _transferEncoding = HTTPC_TE_CHUNKED;
-          } else if (transferEncoding.equalsIgnoreCase("identity")) {
-            _transferEncoding = HTTPC_TE_IDENTITY;
-          } else {
-            return HTTPC_ERROR_ENCODING;
-          }
-        } else {
-          _transferEncoding = HTTPC_TE_IDENTITY;
-        }
-
-        if (_returnCode) {
-          return _returnCode;
-        } else {
-          log_d("Remote host is not an HTTP Server!");
-          return HTTPC_ERROR_NO_HTTP_SERVER;
-        }
-      }
-
     } else {
       if ((millis() - lastDataTime) > _tcpTimeout) {
         return HTTPC_ERROR_READ_TIMEOUT;
@@ -1362,122 +1883,149 @@ int HTTPClient::handleHeaderResponse() {
 }
 
 /**
- * write one Data Block to Stream
- * @param stream Stream *
- * @param size int
- * @return < 0 = error >= 0 = size written
+ * prepares the response parser for a new response
+ * @return false if the line buffer could not be allocated
  */
-int HTTPClient::writeToStreamDataBlock(Stream *stream, int size) {
-  int buff_size = HTTP_TCP_RX_BUFFER_SIZE;
-  int len = size;
-  int bytesWritten = 0;
-
-  // if possible create smaller buffer then HTTP_TCP_RX_BUFFER_SIZE
-  if ((len > 0) && (len < buff_size)) {
-    buff_size = len;
+bool HTTPClient::beginHeaderResponse() {
+  // one line buffer per HTTPClient, reused by every request
+  if (!_headerLine) {
+    _headerLine.reset(new (std::nothrow) char[HTTP_HEADER_LINE_SIZE]);
+    if (!_headerLine) {
+      log_w("too less ram! need %d", HTTP_HEADER_LINE_SIZE);
+      return false;
+    }
+  }
+  if (!_parser) {
+    _parser.reset(new (std::nothrow) HTTPResponseParser(_headerLine.get(), HTTP_HEADER_LINE_SIZE));
+    if (!_parser) {
+      log_w("too less ram!");
+      return false;
+    }
+    _parser->onHeader([this](const HTTPResponseParser::Slice &name, const HTTPResponseParser::Slice &value) {
+      handleHeader(name, value);
+    });
   }
 
-  // create buffer for read
-  uint8_t *buff = (uint8_t *)malloc(buff_size);
-
-  if (buff) {
-    // read all data from server
-    while (connected() && (len > 0 || len == -1)) {
-
-      // get available data size
-      size_t sizeAvailable = buff_size;
-      if (len < 0) {
-        sizeAvailable = _client->available();
-      }
-
-      if (sizeAvailable) {
-
-        int readBytes = sizeAvailable;
-
-        // read only the asked bytes
-        if (len > 0 && readBytes > len) {
-          readBytes = len;
-        }
-
-        // not read more the buffer can handle
-        if (readBytes > buff_size) {
-          readBytes = buff_size;
-        }
-
-        // stop if no more reading
-        if (readBytes == 0) {
-          break;
-        }
-
-        // read data
-        int bytesRead = _client->readBytes(buff, readBytes);
-
-        // write it to Stream
-        int bytesWrite = stream->write(buff, bytesRead);
-        bytesWritten += bytesWrite;
-
-        // are all Bytes a written to stream ?
-        if (bytesWrite != bytesRead) {
-          log_d("short write asked for %d but got %d retry...", bytesRead, bytesWrite);
+  _returnCode = 0;
+  _size = -1;
+  _canReuse = _reuse;
+  _unknownEncoding = false;
+  _date = "";
+  _transferEncoding = HTTPC_TE_IDENTITY;
 
-          // check for write error
-          if (stream->getWriteError()) {
-            log_d("stream write error %d", stream->getWriteError());
+  _parser->reset();
+  return true;
+}
 
-            //reset write error for retry
-            stream->clearWriteError();
-          }
+/**
+ * handles one response header line
+ */
+void HTTPClient::handleHeader(const HTTPResponseParser::Slice &name, const HTTPResponseParser::Slice &value) {
+  log_v("RX: '%.*s: %.*s'", (int)name.len, name.data, (int)value.len, value.data);
 
-          // some time for the stream
-          delay(1);
+  if (name.equalsIgnoreCase("Date")) {
+    _date = sliceToString(value);
+  }
 
-          int leftBytes = (bytesRead - bytesWrite);
+  if (_canReuse && name.equalsIgnoreCase("Connection")) {
+    if (value.containsIgnoreCase("close") && !value.containsIgnoreCase("keep-alive")) {
+      _canReuse = false;
+    }
+  }
 
-          // retry to send the missed bytes
-          bytesWrite = stream->write((buff + bytesWrite), leftBytes);
-          bytesWritten += bytesWrite;
+  if (name.equalsIgnoreCase("Transfer-Encoding")) {
+    log_d("Transfer-Encoding: %.*s", (int)value.len, value.data);
+    _unknownEncoding = false;
+    if (value.equalsIgnoreCase("chunked")) {
+      _transferEncoding = HTTPC_TE_CHUNKED;
+    } else if (value.equalsIgnoreCase("identity")) {
+      _transferEncoding = HTTPC_TE_IDENTITY;
+    } else {
+      _unknownEncoding = true;
+    }
+  }
 
-          if (bytesWrite != leftBytes) {
-            // failed again
-            log_w("short write asked for %d but got %d failed.", leftBytes, bytesWrite);
-            free(buff);
-            return HTTPC_ERROR_STREAM_WRITE;
-          }
-        }
+  if (name.equalsIgnoreCase("Location")) {
+    _location = sliceToString(value);
+  }
 
-        // check for write error
-        if (stream->getWriteError()) {
-          log_w("stream write error %d", stream->getWriteError());
-          free(buff);
-          return HTTPC_ERROR_STREAM_WRITE;
-        }
+  if (name.equalsIgnoreCase("Set-Cookie")) {
+    setCookie(_date, sliceToString(value));
+  }
 
-        // count bytes to read left
-        if (len > 0) {
-          len -= bytesRead;
-        }
+  if (_collectAllHeaders && name.len > 0) {
+    _currentHeaders.push_back({sliceToString(name), sliceToString(value)});
+  } else {
+    for (size_t i = 0; i < _currentHeaders.size(); ++i) {
+      if (name.equalsIgnoreCase(_currentHeaders[i].key.c_str())) {
+        _currentHeaders[i].value = sliceToString(value);
+        break;  // We found a match, stop looking
+      }
+    }
+  }
+}
 
-        delay(0);
-      } else {
-        delay(1);
+/**
+ * feeds the received part of the response head to the parser, never waits for data
+ * @return 0 if the head is not complete yet, else http code or error
+ */
+int HTTPClient::readHeaderResponse() {
+  uint8_t buff[HTTP_HEADER_READ_SIZE];
+
+  // the head is peeked in blocks and only the bytes the parser used are read,
+  // so the body stays in the client for getStream() and the body readers
+  while (!_parser->headersComplete()) {
+    int len = _client->peek(buff, sizeof(buff));
+    if (len <= 0) {
+      // a client that can not peek ahead (plain start of a secure client)
+      if (_client->available() <= 0) {
+        break;
       }
+      int c = _client->read();
+      if (c < 0) {
+        break;
+      }
+      buff[0] = (uint8_t)c;
+      _parser->parseHeaders(buff, 1);
+      continue;
+    }
+    size_t used = _parser->parseHeaders(buff, len);
+    if (used == 0 || _client->read(buff, used) != (int)used) {
+      break;
     }
+  }
 
-    free(buff);
+  if (!_parser->headersComplete()) {
+    return 0;
+  }
 
-    log_v("connection closed or file end (written: %d).", bytesWritten);
+  _returnCode = _parser->statusCode();
+  if (_canReuse && _parser->httpMinorVersion() == 0) {
+    _canReuse = false;
+  }
+  if (_parser->contentLength() >= 0) {
+    _size = _parser->contentLength();
+  }
+  if (_parser->truncatedLines()) {
+    log_w("%u header lines longer than %d bytes were truncated", _parser->truncatedLines(), HTTP_HEADER_LINE_SIZE);
+  }
 
-    if ((size > 0) && (size != bytesWritten)) {
-      log_d("bytesWritten %d and size %d mismatch!.", bytesWritten, size);
-      return HTTPC_ERROR_STREAM_WRITE;
-    }
+  log_d("code: %d", _returnCode);
 
-  } else {
-    log_w("too less ram! need %d", buff_size);
-    return HTTPC_ERROR_TOO_LESS_RAM;
+  if (_size > 0) {
+    log_d("size: %d", _size);
   }
 
-  return bytesWritten;
+  if (_unknownEncoding) {
+    return HTTPC_ERROR_ENCODING;
+  }
+
+  if (_returnCode) {
+    return _returnCode;
+  } else {
+    log_d("Remote host is not an HTTP Server!");
+    return HTTPC_ERROR_NO_HTTP_SERVER;
+  }
 }
 
 /**
@@ -32,11 +32,14 @@
 #endif
 
 #include <memory>
+#include <functional>
 #include <Arduino.h>
 #include <NetworkClient.h>
 #ifndef HTTPCLIENT_NOSECURE
 #include <NetworkClientSecure.h>
 #endif  // HTTPCLIENT_NOSECURE
+#include "HTTPConnectionPool.h"
+#include "HTTPResponseParser.h"
 
 /// Cookie jar and header support
 #include <vector>
@@ -59,6 +62,14 @@
 /// size for the stream handling
 #define HTTP_TCP_RX_BUFFER_SIZE (4096)
 #define HTTP_TCP_TX_BUFFER_SIZE (1460)
+/// longest response header line kept in full, longer lines are truncated
+#ifndef HTTP_HEADER_LINE_SIZE
+#define HTTP_HEADER_LINE_SIZE (1024)
+#endif
+/// response head bytes handed to the parser at once (stack buffer)
+#ifndef HTTP_HEADER_READ_SIZE
+#define HTTP_HEADER_READ_SIZE (128)
+#endif
 
 /// HTTP codes see RFC7231
 typedef enum {
@@ -127,6 +138,27 @@ typedef enum {
   HTTPC_TE_CHUNKED
 } transferEncoding_t;
 
+/**
+ * state of a request started with sendRequestAsync(), advanced by poll().
+ * + `HTTPC_ASYNC_CONNECTING` - waiting for the TCP handshake
+ * + `HTTPC_ASYNC_HANDSHAKE` - https only, running the TLS handshake
+ * + `HTTPC_ASYNC_SENDING` - request header sent, writing the payload
+ * + `HTTPC_ASYNC_HEADERS` - waiting for / parsing the response head
+ * + `HTTPC_ASYNC_BODY` - passing the body to the callback set with onAsyncBody()
+ * + `HTTPC_ASYNC_DONE` - finished, asyncResult() holds the http code
+ * + `HTTPC_ASYNC_FAILED` - finished, asyncResult() holds the HTTPC_ERROR_* code
+ */
+typedef enum {
+  HTTPC_ASYNC_IDLE,
+  HTTPC_ASYNC_CONNECTING,
+  HTTPC_ASYNC_HANDSHAKE,
+  HTTPC_ASYNC_SENDING,
+  HTTPC_ASYNC_HEADERS,
+  HTTPC_ASYNC_BODY,
+  HTTPC_ASYNC_DONE,
+  HTTPC_ASYNC_FAILED
+} httpc_async_state_t;
+
 /**
  * redirection follow mode.
  * + `HTTPC_DISABLE_FOLLOW_REDIRECTS` - no redirection will be followed.
@@ -208,6 +240,8 @@ public:
   bool connected(void);
 
   void setReuse(bool reuse);  /// keep-alive
+  /// share keep-alive connections with other HTTPClient objects (only for connections created by begin(url, ...))
+  void setConnectionPool(HTTPConnectionPool *pool);
   void setUserAgent(const String &userAgent);
   void setAcceptEncoding(const String &acceptEncoding);
   void setAuthorization(const char *user, const char *password);
@@ -235,6 +269,23 @@ public:
   int sendRequest(const char *type, uint8_t *payload = NULL, size_t size = 0);
   int sendRequest(const char *type, Stream *stream, size_t size = 0);
 
+  /// non-blocking request handling, call poll() from loop() until it returns HTTPC_ASYNC_DONE or HTTPC_ASYNC_FAILED.
+  /// The DNS lookup still blocks in sendRequestAsync(), and poll() runs the TLS crypto steps inline.
+  typedef std::function<void(HTTPClient &client, int code)> AsyncCallback;
+  bool GETAsync();
+  bool POSTAsync(const uint8_t *payload, size_t size);
+  bool sendRequestAsync(const char *type, const uint8_t *payload = NULL, size_t size = 0);
+  httpc_async_state_t poll();
+  void abortAsync();
+  void onAsyncBody(HTTPResponseParser::BodySink sink);
+  void onAsyncDone(AsyncCallback callback);
+  httpc_async_state_t asyncState() const {
+    return _asyncState;
+  }
+  int asyncResult() const {
+    return _asyncResult;
+  }
+
   void addHeader(const String &name, const String &value, bool first = false, bool replace = true);
 
   /// Response handling
@@ -252,6 +303,7 @@ public:
   NetworkClient &getStream(void);
   NetworkClient *getStreamPtr(void);
   int writeToStream(Stream *stream);
+  int writeToCallback(HTTPResponseParser::BodySink sink);
   String getString(void);
 
   static String errorToString(int error);
@@ -272,9 +324,20 @@ protected:
   void clear();
   int returnError(int error);
   bool connect(void);
+  int prepareClient();
+  bool releaseToPool();
+  bool bodyConsumed();
   bool sendHeader(const char *type);
   int handleHeaderResponse();
-  int writeToStreamDataBlock(Stream *stream, int len);
+  bool beginHeaderResponse();
+  void handleHeader(const HTTPResponseParser::Slice &name, const HTTPResponseParser::Slice &value);
+  int readHeaderResponse();
+  int beginBody(HTTPResponseParser::BodySink sink);
+  int readBodyBlock(uint8_t *buff, int buff_size);
+  int endBody();
+  void resetResponseHeaders();
+  void addRequestHeaders(size_t contentLength);
+  void asyncFinish(int code);
 
   /// Cookie jar support
   void setCookie(String date, String headerValue);
@@ -286,6 +349,8 @@ protected:
 #endif
 
   NetworkClient *_client = nullptr;
+  HTTPConnectionPool *_pool = nullptr;
+  String _poolKey;  // key of the current connection if it came from / can go to _pool
 
   /// request handling
   String _host;
@@ -307,6 +372,10 @@ protected:
 
   /// Response handling
   std::vector<RequestArgument> _currentHeaders;
+  std::unique_ptr<char[]> _headerLine;
+  std::unique_ptr<HTTPResponseParser> _parser;
+  bool _unknownEncoding = false;
+  String _date;
 
   int _returnCode = 0;
   int _size = -1;
@@ -318,6 +387,19 @@ protected:
 
   /// Cookie jar support
   CookieJar *_cookieJar = nullptr;
+
+  /// non-blocking request handling
+  httpc_async_state_t _asyncState = HTTPC_ASYNC_IDLE;
+  int _asyncResult = 0;
+  const char *_asyncType = nullptr;
+  const uint8_t *_asyncPayload = nullptr;
+  size_t _asyncSize = 0;
+  size_t _asyncSent = 0;
+  unsigned long _asyncLastActivity = 0;
+  std::unique_ptr<uint8_t[]> _asyncBuffer;
+  int _asyncBufferSize = 0;
+  HTTPResponseParser::BodySink _asyncBodySink;
+  AsyncCallback _asyncDoneCallback;
 };
 
 #endif /* HTTPClient_H_ */
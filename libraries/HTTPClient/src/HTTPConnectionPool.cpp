@@ -0,0 +1,206 @@
+/**
+ * HTTPConnectionPool.cpp
+ *
+ * Process-wide pool of idle keep-alive connections shared by HTTPClient
+ * instances.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <Arduino.h>
+#include <esp32-hal-log.h>
+#include "HTTPConnectionPool.h"
+
+HTTPConnectionPool::HTTPConnectionPool(size_t maxPerHost, uint32_t idleTimeout) : _maxPerHost(maxPerHost), _idleTimeout(idleTimeout) {}
+
+HTTPConnectionPool::~HTTPConnectionPool() {
+  clear();
+  if (_mtx) {
+    vSemaphoreDelete(_mtx);
+  }
+}
+
+void HTTPConnectionPool::_lock() {
+  // created on first use, the global pool is constructed before the scheduler runs
+  SemaphoreHandle_t mtx = __atomic_load_n(&_mtx, __ATOMIC_ACQUIRE);
+  if (!mtx) {
+    mtx = xSemaphoreCreateMutex();
+    if (!mtx) {
+      log_e("HTTPConnectionPool Mutex Create Failed!");
+      return;
+    }
+    SemaphoreHandle_t expected = NULL;
+    if (!__atomic_compare_exchange_n(&_mtx, &expected, mtx, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      // another task created it meanwhile
+      vSemaphoreDelete(mtx);
+      mtx = expected;
+    }
+  }
+  xSemaphoreTake(mtx, portMAX_DELAY);
+}
+
+void HTTPConnectionPool::_unlock() {
+  if (_mtx) {
+    xSemaphoreGive(_mtx);
+  }
+}
+
+/**
+ * builds the pool key of a connection
+ * @param protocol String  "http" or "https"
+ * @param host String
+ * @param port uint16_t
+ * @param identity String  anything that distinguishes the TLS trust settings
+ * @return key String
+ */
+String HTTPConnectionPool::makeKey(const String &protocol, const String &host, uint16_t port, const String &identity) {
+  String key = protocol;
+  key += "://";
+  key += host;
+  key += ':';
+  key += String(port);
+  if (identity.length()) {
+    key += '#';
+    key += identity;
+  }
+  return key;
+}
+
+void HTTPConnectionPool::setMaxPerHost(size_t maxPerHost) {
+  _lock();
+  _maxPerHost = maxPerHost;
+  _unlock();
+}
+
+void HTTPConnectionPool::setIdleTimeout(uint32_t idleTimeout) {
+  _lock();
+  _idleTimeout = idleTimeout;
+  _unlock();
+}
+
+void HTTPConnectionPool::_evictIdle(unsigned long now) {
+  for (auto it = _idle.begin(); it != _idle.end();) {
+    if ((now - it->lastUsed) > _idleTimeout) {
+      log_d("evicting idle connection to %s", it->key.c_str());
+      it->client->stop();
+      it = _idle.erase(it);
+      _evictions++;
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::unique_ptr<NetworkClient> HTTPConnectionPool::acquire(const String &key) {
+  std::unique_ptr<NetworkClient> client;
+  _lock();
+  _evictIdle(millis());
+  // most recently released connections are at the back and the least likely to be closed by the server
+  for (size_t i = _idle.size(); i > 0; i--) {
+    IdleConnection &entry = _idle[i - 1];
+    if (entry.key != key) {
+      continue;
+    }
+    std::unique_ptr<NetworkClient> candidate = std::move(entry.client);
+    _idle.erase(_idle.begin() + (i - 1));
+    // drop anything left over from the previous response
+    while (candidate->available() > 0) {
+      candidate->read();
+    }
+    if (candidate->connected()) {
+      client = std::move(candidate);
+      break;
+    }
+    log_d("pooled connection to %s was closed by the server", key.c_str());
+    candidate->stop();
+  }
+  if (client) {
+    _hits++;
+  } else {
+    _misses++;
+  }
+  _unlock();
+  log_d("%s pooled connection for %s", client ? "reusing" : "no", key.c_str());
+  return client;
+}
+
+bool HTTPConnectionPool::release(const String &key, std::unique_ptr<NetworkClient> client) {
+  if (!client) {
+    return false;
+  }
+  if (!client->connected()) {
+    client->stop();
+    return false;
+  }
+
+  _lock();
+  unsigned long now = millis();
+  _evictIdle(now);
+  size_t count = 0;
+  for (const IdleConnection &entry : _idle) {
+    if (entry.key == key) {
+      count++;
+    }
+  }
+  if (count >= _maxPerHost) {
+    _unlock();
+    log_d("pool for %s is full (%u), closing connection", key.c_str(), (unsigned)_maxPerHost);
+    client->stop();
+    return false;
+  }
+  _idle.push_back({key, std::move(client), now});
+  _unlock();
+  log_d("connection to %s returned to pool", key.c_str());
+  return true;
+}
+
+void HTTPConnectionPool::evictIdle() {
+  _lock();
+  _evictIdle(millis());
+  _unlock();
+}
+
+void HTTPConnectionPool::clear() {
+  _lock();
+  for (IdleConnection &entry : _idle) {
+    entry.client->stop();
+  }
+  _idle.clear();
+  _unlock();
+}
+
+size_t HTTPConnectionPool::idleCount() {
+  _lock();
+  size_t count = _idle.size();
+  _unlock();
+  return count;
+}
+
+size_t HTTPConnectionPool::idleCount(const String &key) {
+  size_t count = 0;
+  _lock();
+  for (const IdleConnection &entry : _idle) {
+    if (entry.key == key) {
+      count++;
+    }
+  }
+  _unlock();
+  return count;
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_HTTPCONNECTIONPOOL)
+HTTPConnectionPool httpConnectionPool;
+#endif
@@ -0,0 +1,107 @@
+/**
+ * HTTPConnectionPool.h
+ *
+ * Process-wide pool of idle keep-alive connections shared by HTTPClient
+ * instances.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HTTPConnectionPool_H_
+#define HTTPConnectionPool_H_
+
+#include <memory>
+#include <vector>
+#include <Arduino.h>
+#include <NetworkClient.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define HTTPCLIENT_POOL_DEFAULT_MAX_PER_HOST (2)
+#define HTTPCLIENT_POOL_DEFAULT_IDLE_TIMEOUT (30000)
+
+/**
+ * Keeps connected NetworkClient / NetworkClientSecure objects that finished a
+ * keep-alive request so that the next request to the same scheme, host and
+ * port (from any HTTPClient using this pool) skips the TCP and TLS setup.
+ *
+ * Connections are keyed by "scheme://host:port" plus a SHA-256 of the CA,
+ * client certificate and key contents, so a connection verified against one CA
+ * is never handed to a client expecting another, even if both use the same
+ * buffer. At most `maxPerHost` idle connections are kept
+ * per key, and idle connections are closed after `idleTimeout` ms.
+ * HTTPClient only hands back a connection once the response body was read to
+ * its end; a connection with unread data is closed instead.
+ */
+class HTTPConnectionPool {
+public:
+  HTTPConnectionPool(size_t maxPerHost = HTTPCLIENT_POOL_DEFAULT_MAX_PER_HOST, uint32_t idleTimeout = HTTPCLIENT_POOL_DEFAULT_IDLE_TIMEOUT);
+  ~HTTPConnectionPool();
+
+  void setMaxPerHost(size_t maxPerHost);
+  void setIdleTimeout(uint32_t idleTimeout);
+
+  /// take an idle, still connected client for key (nullptr if there is none)
+  std::unique_ptr<NetworkClient> acquire(const String &key);
+  /// hand a connected client back; returns false if it was closed instead (cap reached or disconnected)
+  bool release(const String &key, std::unique_ptr<NetworkClient> client);
+
+  /// close connections idle for longer than the idle timeout
+  void evictIdle();
+  /// close all idle connections
+  void clear();
+
+  size_t idleCount();
+  size_t idleCount(const String &key);
+
+  /// statistics
+  uint32_t hits() const {
+    return _hits;
+  }
+  uint32_t misses() const {
+    return _misses;
+  }
+  uint32_t evictions() const {
+    return _evictions;
+  }
+
+  static String makeKey(const String &protocol, const String &host, uint16_t port, const String &identity = String());
+
+protected:
+  struct IdleConnection {
+    String key;
+    std::unique_ptr<NetworkClient> client;
+    unsigned long lastUsed;
+  };
+
+  void _evictIdle(unsigned long now);
+  void _lock();
+  void _unlock();
+
+  std::vector<IdleConnection> _idle;
+  size_t _maxPerHost;
+  uint32_t _idleTimeout;
+  uint32_t _hits = 0;
+  uint32_t _misses = 0;
+  uint32_t _evictions = 0;
+  SemaphoreHandle_t _mtx = NULL;
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_HTTPCONNECTIONPOOL)
+extern HTTPConnectionPool httpConnectionPool;
+#endif
+
+#endif /* HTTPConnectionPool_H_ */
@@ -0,0 +1,362 @@
+/**
+ * HTTPResponseParser.cpp
+ *
+ * Incremental HTTP/1.x response parser working on a caller supplied line
+ * buffer.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <string.h>
+#include <strings.h>
+#include "HTTPResponseParser.h"
+
+// chunk sizes are limited to 7 hex digits so they always fit in _remaining
+#define HTTP_PARSER_MAX_CHUNK_DIGITS (7)
+
+static inline bool isHttpSpace(char c) {
+  return c == ' ' || c == '\t';
+}
+
+static inline int hexValue(uint8_t c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool HTTPResponseParser::Slice::equalsIgnoreCase(const char *str) const {
+  return strlen(str) == len && strncasecmp(data, str, len) == 0;
+}
+
+bool HTTPResponseParser::Slice::containsIgnoreCase(const char *str) const {
+  size_t strLen = strlen(str);
+  if (strLen == 0) {
+    return true;
+  }
+  for (size_t i = 0; i + strLen <= len; i++) {
+    if (strncasecmp(data + i, str, strLen) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+long HTTPResponseParser::Slice::toLong() const {
+  size_t i = 0;
+  while (i < len && isHttpSpace(data[i])) {
+    i++;
+  }
+  long value = 0;
+  for (; i < len && data[i] >= '0' && data[i] <= '9'; i++) {
+    if (value > (0x7FFFFFFFL - 9) / 10) {
+      return 0x7FFFFFFFL;
+    }
+    value = value * 10 + (data[i] - '0');
+  }
+  return value;
+}
+
+HTTPResponseParser::HTTPResponseParser(char *lineBuffer, size_t lineBufferSize) : _line(lineBuffer), _lineSize(lineBufferSize) {}
+
+void HTTPResponseParser::reset() {
+  _lineLen = 0;
+  _lineTruncated = false;
+  _state = STATE_STATUS_LINE;
+  _error = PARSER_OK;
+  _statusCode = 0;
+  _httpMinor = 1;
+  _contentLength = -1;
+  _chunked = false;
+  _truncatedLines = 0;
+  _remaining = -1;
+  _chunkSize = 0;
+  _chunkDigits = 0;
+  _bodyBytes = 0;
+}
+
+size_t HTTPResponseParser::parseHeaders(const uint8_t *data, size_t len) {
+  size_t i = 0;
+  while (i < len && _state < STATE_BODY) {
+    const uint8_t *nl = (const uint8_t *)memchr(data + i, '\n', len - i);
+    size_t end = nl ? (size_t)(nl - data) : len;
+    size_t n = end - i;
+
+    // copy what fits, the rest of an overlong line is dropped
+    size_t room = _lineSize - _lineLen;
+    if (n > room) {
+      n = room;
+      _lineTruncated = true;
+    }
+    memcpy(_line + _lineLen, data + i, n);
+    _lineLen += n;
+
+    i = end;
+    if (nl) {
+      i++;
+      _lineDone();
+    }
+  }
+  return i;
+}
+
+void HTTPResponseParser::_lineDone() {
+  size_t len = _lineLen;
+  if (len > 0 && _line[len - 1] == '\r') {
+    len--;
+  }
+  if (_lineTruncated) {
+    _truncatedLines++;
+  }
+
+  if (_state == STATE_STATUS_LINE) {
+    // tolerate empty lines left over before the status line
+    if (len > 0) {
+      _parseStatusLine(_line, len);
+      _state = STATE_HEADER_LINE;
+    }
+  } else if (len == 0) {
+    _state = STATE_BODY;
+  } else {
+    _parseHeaderLine(_line, len);
+  }
+
+  _lineLen = 0;
+  _lineTruncated = false;
+}
+
+void HTTPResponseParser::_parseStatusLine(const char *line, size_t len) {
+  // HTTP/1.x <code> <reason>
+  if (len >= 8 && strncmp(line, "HTTP/1.", 7) == 0) {
+    _httpMinor = line[7] - '0';
+  }
+  const char *sp = (const char *)memchr(line, ' ', len);
+  if (!sp) {
+    return;
+  }
+  Slice code;
+  code.data = sp + 1;
+  code.len = len - (code.data - line);
+  _statusCode = (int)code.toLong();
+}
+
+void HTTPResponseParser::_parseHeaderLine(const char *line, size_t len) {
+  const char *colon = (const char *)memchr(line, ':', len);
+  if (!colon) {
+    return;
+  }
+
+  Slice name;
+  name.data = line;
+  name.len = colon - line;
+  while (name.len > 0 && isHttpSpace(name.data[name.len - 1])) {
+    name.len--;
+  }
+
+  Slice value;
+  value.data = colon + 1;
+  value.len = len - (value.data - line);
+  while (value.len > 0 && isHttpSpace(value.data[0])) {
+    value.data++;
+    value.len--;
+  }
+  while (value.len > 0 && isHttpSpace(value.data[value.len - 1])) {
+    value.len--;
+  }
+
+  if (name.equalsIgnoreCase("Content-Length")) {
+    _contentLength = (int)value.toLong();
+  } else if (name.equalsIgnoreCase("Transfer-Encoding")) {
+    _chunked = value.containsIgnoreCase("chunked");
+  }
+
+  if (_onHeader) {
+    _onHeader(name, value);
+  }
+}
+
+void HTTPResponseParser::beginBody(int contentLength, bool chunked) {
+  _bodyBytes = 0;
+  _chunkSize = 0;
+  _chunkDigits = 0;
+  _lineLen = 0;
+  if (chunked) {
+    _remaining = 0;
+    _state = STATE_CHUNK_SIZE;
+  } else if (contentLength == 0) {
+    _remaining = 0;
+    _state = STATE_DONE;
+  } else {
+    _remaining = contentLength < 0 ? -1 : contentLength;
+    _state = STATE_BODY;
+  }
+}
+
+bool HTTPResponseParser::_emit(const uint8_t *data, size_t len) {
+  if (len == 0) {
+    return true;
+  }
+  _bodyBytes += len;
+  if (_onBody && !_onBody(data, len)) {
+    _error = PARSER_ERROR_SINK;
+    return false;
+  }
+  return true;
+}
+
+// byte after the chunk size digits: whitespace, an extension or the line end ("\r" only right before "\n")
+void HTTPResponseParser::_chunkSizeDelimiter(uint8_t c) {
+  if (isHttpSpace(c)) {
+    _state = STATE_CHUNK_SIZE_WS;
+  } else if (c == ';') {
+    _state = STATE_CHUNK_EXT;
+  } else if (c == '\r') {
+    _state = STATE_CHUNK_SIZE_CR;
+  } else if (c == '\n') {
+    _chunkSizeLineDone();
+  } else {
+    _error = PARSER_ERROR_CHUNK_FORMAT;
+  }
+}
+
+void HTTPResponseParser::_chunkSizeLineDone() {
+  if (_chunkSize == 0) {
+    _lineLen = 0;
+    _state = STATE_TRAILER;
+  } else {
+    _remaining = _chunkSize;
+    _state = STATE_CHUNK_DATA;
+  }
+}
+
+size_t HTTPResponseParser::parseBody(const uint8_t *data, size_t len) {
+  size_t i = 0;
+  while (i < len && _state != STATE_DONE && _error == PARSER_OK) {
+    switch (_state) {
+      case STATE_BODY:
+      {
+        size_t n = len - i;
+        if (_remaining >= 0 && n > (size_t)_remaining) {
+          n = _remaining;
+        }
+        if (!_emit(data + i, n)) {
+          return i;
+        }
+        i += n;
+        if (_remaining >= 0) {
+          _remaining -= n;
+          if (_remaining == 0) {
+            _state = STATE_DONE;
+          }
+        }
+        break;
+      }
+      case STATE_CHUNK_SIZE:
+      {
+        uint8_t c = data[i++];
+        int v = hexValue(c);
+        if (v >= 0) {
+          if (_chunkDigits >= HTTP_PARSER_MAX_CHUNK_DIGITS) {
+            _error = PARSER_ERROR_CHUNK_FORMAT;
+            break;
+          }
+          _chunkSize = (_chunkSize << 4) | v;
+          _chunkDigits++;
+        } else if (_chunkDigits == 0) {
+          _error = PARSER_ERROR_CHUNK_FORMAT;
+        } else {
+          _chunkSizeDelimiter(c);
+        }
+        break;
+      }
+      case STATE_CHUNK_SIZE_WS:
+        // whitespace after the last digit, no more digits allowed
+        _chunkSizeDelimiter(data[i++]);
+        break;
+      case STATE_CHUNK_SIZE_CR:
+        if (data[i++] != '\n') {
+          _error = PARSER_ERROR_CHUNK_FORMAT;
+        } else {
+          _chunkSizeLineDone();
+        }
+        break;
+      case STATE_CHUNK_EXT:
+      {
+        // chunk extensions are ignored up to the line end
+        const uint8_t *nl = (const uint8_t *)memchr(data + i, '\n', len - i);
+        if (nl) {
+          i = nl - data;
+          _state = STATE_CHUNK_SIZE_CR;
+        } else {
+          i = len;
+        }
+        break;
+      }
+      case STATE_CHUNK_DATA:
+      {
+        size_t n = len - i;
+        if (n > (size_t)_remaining) {
+          n = _remaining;
+        }
+        if (!_emit(data + i, n)) {
+          return i;
+        }
+        i += n;
+        _remaining -= n;
+        if (_remaining == 0) {
+          _state = STATE_CHUNK_DATA_CR;
+        }
+        break;
+      }
+      case STATE_CHUNK_DATA_CR:
+        if (data[i++] != '\r') {
+          _error = PARSER_ERROR_CHUNK_FORMAT;
+        } else {
+          _state = STATE_CHUNK_DATA_LF;
+        }
+        break;
+      case STATE_CHUNK_DATA_LF:
+        if (data[i++] != '\n') {
+          _error = PARSER_ERROR_CHUNK_FORMAT;
+        } else {
+          _chunkSize = 0;
+          _chunkDigits = 0;
+          _state = STATE_CHUNK_SIZE;
+        }
+        break;
+      case STATE_TRAILER:
+      {
+        // trailer fields are skipped, the body ends with an empty line
+        uint8_t c = data[i++];
+        if (c == '\n') {
+          if (_lineLen == 0) {
+            _state = STATE_DONE;
+          }
+          _lineLen = 0;
+        } else if (c != '\r') {
+          _lineLen++;
+        }
+        break;
+      }
+      default: i = len; break;
+    }
+  }
+  return i;
+}
@@ -0,0 +1,175 @@
+/**
+ * HTTPResponseParser.h
+ *
+ * Incremental HTTP/1.x response parser working on a caller supplied line
+ * buffer. Header names and values are handed out as slices into that buffer
+ * and body bytes are passed straight from the input to a sink, so parsing a
+ * response does not create any String temporaries.
+ *
+ * The parser only depends on the C/C++ standard library, so it is tested and
+ * benchmarked on the host by .github/scripts/ci_testing/test_http_parser.py.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HTTPResponseParser_H_
+#define HTTPResponseParser_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+class HTTPResponseParser {
+public:
+  /// view into the line buffer, only valid inside the header callback
+  struct Slice {
+    const char *data = nullptr;
+    size_t len = 0;
+
+    bool equalsIgnoreCase(const char *str) const;
+    bool containsIgnoreCase(const char *str) const;
+    long toLong() const;
+  };
+
+  typedef std::function<void(const Slice &name, const Slice &value)> HeaderCallback;
+  /// return false to abort the transfer
+  typedef std::function<bool(const uint8_t *data, size_t len)> BodySink;
+
+  typedef enum {
+    PARSER_OK,
+    PARSER_ERROR_CHUNK_FORMAT,  // bad chunk size or missing CRLF after chunk data
+    PARSER_ERROR_SINK           // body sink returned false
+  } parser_error_t;
+
+  HTTPResponseParser(char *lineBuffer, size_t lineBufferSize);
+
+  void onHeader(HeaderCallback cb) {
+    _onHeader = cb;
+  }
+  void onBody(BodySink sink) {
+    _onBody = sink;
+  }
+
+  /// start over with a new response (status line expected next)
+  void reset();
+
+  /**
+   * feed response head bytes. Stops right after the empty line that ends the
+   * headers, so no body byte is consumed.
+   * @return number of bytes consumed
+   */
+  size_t parseHeaders(const uint8_t *data, size_t len);
+
+  /**
+   * prepare the body phase
+   * @param contentLength int   -1 if unknown (read until the connection closes)
+   * @param chunked bool        body uses chunked transfer encoding
+   */
+  void beginBody(int contentLength, bool chunked);
+
+  /**
+   * feed body bytes, the payload is passed to the body sink without copying
+   * @return number of bytes consumed (less than len once the body is complete)
+   */
+  size_t parseBody(const uint8_t *data, size_t len);
+
+  bool headersComplete() const {
+    return _state >= STATE_BODY;
+  }
+  bool done() const {
+    return _state == STATE_DONE;
+  }
+  bool failed() const {
+    return _error != PARSER_OK;
+  }
+  parser_error_t error() const {
+    return _error;
+  }
+
+  /// values taken from the response head, statusCode() is 0 if the status line was not understood
+  int statusCode() const {
+    return _statusCode;
+  }
+  int httpMinorVersion() const {
+    return _httpMinor;
+  }
+  int contentLength() const {
+    return _contentLength;
+  }
+  bool chunked() const {
+    return _chunked;
+  }
+  /// number of header lines that did not fit into the line buffer
+  uint16_t truncatedLines() const {
+    return _truncatedLines;
+  }
+
+  /// bytes of payload handed to the body sink
+  uint32_t bodyBytes() const {
+    return _bodyBytes;
+  }
+  /// bytes still expected in the current chunk or identity body (-1 if unknown)
+  int32_t remaining() const {
+    return _remaining;
+  }
+
+protected:
+  typedef enum {
+    STATE_STATUS_LINE,
+    STATE_HEADER_LINE,
+    STATE_BODY,
+    STATE_CHUNK_SIZE,
+    STATE_CHUNK_SIZE_WS,
+    STATE_CHUNK_SIZE_CR,
+    STATE_CHUNK_EXT,
+    STATE_CHUNK_DATA,
+    STATE_CHUNK_DATA_CR,
+    STATE_CHUNK_DATA_LF,
+    STATE_TRAILER,
+    STATE_DONE
+  } parser_state_t;
+
+  void _lineDone();
+  void _parseStatusLine(const char *line, size_t len);
+  void _parseHeaderLine(const char *line, size_t len);
+  bool _emit(const uint8_t *data, size_t len);
+  void _chunkSizeDelimiter(uint8_t c);
+  void _chunkSizeLineDone();
+
+  char *_line;
+  size_t _lineSize;
+  size_t _lineLen = 0;
+  bool _lineTruncated = false;
+
+  parser_state_t _state = STATE_STATUS_LINE;
+  parser_error_t _error = PARSER_OK;
+
+  int _statusCode = 0;
+  int _httpMinor = 1;
+  int _contentLength = -1;
+  bool _chunked = false;
+  uint16_t _truncatedLines = 0;
+
+  int32_t _remaining = -1;
+  uint32_t _chunkSize = 0;
+  uint8_t _chunkDigits = 0;
+  uint32_t _bodyBytes = 0;
+
+  HeaderCallback _onHeader;
+  BodySink _onBody;
+};
+
+#endif /* HTTPResponseParser_H_ */
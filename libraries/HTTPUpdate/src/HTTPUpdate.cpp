@@ -366,7 +366,9 @@ HTTPUpdateResult HTTPUpdate::handleUpdate(HTTPClient &http, const String &curren
 
             // check for valid first magic byte
             //                    if(buf[0] != 0xE9) {
-            if (tcp->peek() != 0xE9) {
+            // compressed and delta packages made with tools/ota_package.py are decoded by Update
+            int magic = tcp->peek();
+            if (magic != 0xE9 && magic != UPDATE_PACKAGE_MAGIC_BYTE) {
               log_e("Magic header does not start with 0xE9\n");
               _lastError = HTTP_UE_BIN_VERIFY_HEADER_FAILED;
               http.end();
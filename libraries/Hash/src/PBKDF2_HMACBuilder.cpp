@@ -15,8 +15,104 @@
 #include <Arduino.h>
 #include "PBKDF2_HMACBuilder.h"
 
-// Block size for HMAC (64 bytes for SHA-1, SHA-256, SHA-512)
+// HMAC block size of MD5, SHA-1 and SHA-256, and of every algorithm in legacy mode
 #define HMAC_BLOCK_SIZE 64
+// Largest block size of the Hash library builders (SHA3-224)
+#define HMAC_MAX_BLOCK_SIZE 144
+
+// HMAC with a fixed key. The key pads are prepared once; when the builder
+// supports midstates, the state after each pad block is kept as well so every
+// HMAC only hashes the message and the inner digest.
+class HMACKey {
+public:
+  HMACKey(HashBuilder *hash, const uint8_t *key, size_t keyLen, bool legacyBlockSize);
+  ~HMACKey();
+  // HMAC(key, data1 || data2)
+  void compute(const uint8_t *data1, size_t len1, const uint8_t *data2, size_t len2, uint8_t *output);
+
+private:
+  HashBuilder *_hash;
+  size_t _blockSize;
+  size_t _hashSize;
+  uint8_t _innerPad[HMAC_MAX_BLOCK_SIZE];
+  uint8_t _outerPad[HMAC_MAX_BLOCK_SIZE];
+  HashBuilder *_innerState;
+  HashBuilder *_outerState;
+};
+
+HMACKey::HMACKey(HashBuilder *hash, const uint8_t *key, size_t keyLen, bool legacyBlockSize) : _hash(hash), _innerState(nullptr), _outerState(nullptr) {
+  _hashSize = hash->getHashSize();
+  _blockSize = legacyBlockSize ? 0 : hash->getBlockSize();
+  if (_blockSize == 0 || _blockSize > HMAC_MAX_BLOCK_SIZE) {
+    _blockSize = HMAC_BLOCK_SIZE;
+  }
+
+  // Keys longer than a block are hashed first
+  uint8_t keyPad[HMAC_MAX_BLOCK_SIZE];
+  if (keyLen > _blockSize) {
+    hash->begin();
+    hash->add(key, keyLen);
+    hash->calculate();
+    hash->getBytes(keyPad);
+    keyLen = _hashSize;
+  } else {
+    memcpy(keyPad, key, keyLen);
+  }
+  memset(keyPad + keyLen, 0, _blockSize - keyLen);
+
+  for (size_t i = 0; i < _blockSize; i++) {
+    _innerPad[i] = keyPad[i] ^ 0x36;
+    _outerPad[i] = keyPad[i] ^ 0x5c;
+  }
+  forced_memzero(keyPad, sizeof(keyPad));
+
+  // Midstates after the pad blocks, the generic path below is used if the builder can not provide them
+  hash->begin();
+  hash->add(_innerPad, _blockSize);
+  _innerState = hash->clone();
+  hash->begin();
+  hash->add(_outerPad, _blockSize);
+  _outerState = hash->clone();
+  if (_innerState == nullptr || _outerState == nullptr) {
+    delete _innerState;
+    delete _outerState;
+    _innerState = nullptr;
+    _outerState = nullptr;
+  }
+}
+
+HMACKey::~HMACKey() {
+  forced_memzero(_innerPad, sizeof(_innerPad));
+  forced_memzero(_outerPad, sizeof(_outerPad));
+  delete _innerState;
+  delete _outerState;
+}
+
+void HMACKey::compute(const uint8_t *data1, size_t len1, const uint8_t *data2, size_t len2, uint8_t *output) {
+  uint8_t innerHash[64];  // Large enough for any hash
+
+  // Inner hash: H(K XOR ipad, text)
+  if (!_innerState || !_hash->copyStateFrom(*_innerState)) {
+    _hash->begin();
+    _hash->add(_innerPad, _blockSize);
+  }
+  _hash->add(data1, len1);
+  if (len2) {
+    _hash->add(data2, len2);
+  }
+  _hash->calculate();
+  _hash->getBytes(innerHash);
+
+  // Outer hash: H(K XOR opad, inner_hash)
+  if (!_outerState || !_hash->copyStateFrom(*_outerState)) {
+    _hash->begin();
+    _hash->add(_outerPad, _blockSize);
+  }
+  _hash->add(innerHash, _hashSize);
+  _hash->calculate();
+  _hash->getBytes(output);
+  forced_memzero(innerHash, sizeof(innerHash));
+}
 
 PBKDF2_HMACBuilder::PBKDF2_HMACBuilder(HashBuilder *hash, String password, String salt, uint32_t iterations) {
   this->hashBuilder = hash;
@@ -27,6 +123,7 @@ PBKDF2_HMACBuilder::PBKDF2_HMACBuilder(HashBuilder *hash, String password, Strin
     log_w("PBKDF2_HMACBuilder: No hash algorithm provided. Use setHashAlgorithm() before calculate().");
   }
   this->iterations = iterations;
+  this->legacyBlockSize = PBKDF2_HMAC_LEGACY_BLOCK_SIZE;
 
   // Initialize pointers
   this->password = nullptr;
@@ -60,50 +157,6 @@ void PBKDF2_HMACBuilder::clearData() {
   calculated = false;
 }
 
-void PBKDF2_HMACBuilder::hmac(const uint8_t *key, size_t keyLen, const uint8_t *data, size_t dataLen, uint8_t *output) {
-  uint8_t keyPad[HMAC_BLOCK_SIZE];
-  uint8_t outerPad[HMAC_BLOCK_SIZE];
-  uint8_t innerHash[64];  // Large enough for any hash
-
-  // Prepare key
-  if (keyLen > HMAC_BLOCK_SIZE) {
-    // Key is longer than block size, hash it
-    hashBuilder->begin();
-    hashBuilder->add(key, keyLen);
-    hashBuilder->calculate();
-    hashBuilder->getBytes(keyPad);
-    keyLen = hashSize;
-  } else {
-    // Copy key to keyPad
-    memcpy(keyPad, key, keyLen);
-  }
-
-  // Pad key with zeros if necessary
-  if (keyLen < HMAC_BLOCK_SIZE) {
-    memset(keyPad + keyLen, 0, HMAC_BLOCK_SIZE - keyLen);
-  }
-
-  // Create outer and inner pads
-  for (int i = 0; i < HMAC_BLOCK_SIZE; i++) {
-    outerPad[i] = keyPad[i] ^ 0x5c;
-    keyPad[i] = keyPad[i] ^ 0x36;
-  }
-
-  // Inner hash: H(K XOR ipad, text)
-  hashBuilder->begin();
-  hashBuilder->add(keyPad, HMAC_BLOCK_SIZE);
-  hashBuilder->add(data, dataLen);
-  hashBuilder->calculate();
-  hashBuilder->getBytes(innerHash);
-
-  // Outer hash: H(K XOR opad, inner_hash)
-  hashBuilder->begin();
-  hashBuilder->add(outerPad, HMAC_BLOCK_SIZE);
-  hashBuilder->add(innerHash, hashSize);
-  hashBuilder->calculate();
-  hashBuilder->getBytes(output);
-}
-
 // HashBuilder interface methods
 void PBKDF2_HMACBuilder::begin() {
   clearData();
@@ -215,6 +268,11 @@ void PBKDF2_HMACBuilder::setIterations(uint32_t iterations) {
   this->iterations = iterations;
 }
 
+void PBKDF2_HMACBuilder::setLegacyBlockSize(bool enable) {
+  legacyBlockSize = enable;
+  calculated = false;
+}
+
 void PBKDF2_HMACBuilder::setHashAlgorithm(HashBuilder *hash) {
   hashBuilder = hash;
   if (hash) {
@@ -228,33 +286,29 @@ void PBKDF2_HMACBuilder::setHashAlgorithm(HashBuilder *hash) {
 void PBKDF2_HMACBuilder::pbkdf2_hmac(
   const uint8_t *password, size_t passwordLen, const uint8_t *salt, size_t saltLen, uint32_t iterations, uint8_t *output, size_t outputLen
 ) {
-  uint8_t u1[64];  // Large enough for any hash
-  uint8_t u2[64];
-  uint8_t saltWithBlock[256];  // Salt + block number
+  uint8_t u[64];  // Large enough for any hash
   uint8_t block[64];
+  uint8_t counter[4];
 
+  HMACKey key(hashBuilder, password, passwordLen, legacyBlockSize);
   size_t blocks = (outputLen + hashSize - 1) / hashSize;
 
   for (size_t i = 1; i <= blocks; i++) {
-    // Prepare salt || INT(i)
-    memcpy(saltWithBlock, salt, saltLen);
-    saltWithBlock[saltLen] = (i >> 24) & 0xFF;
-    saltWithBlock[saltLen + 1] = (i >> 16) & 0xFF;
-    saltWithBlock[saltLen + 2] = (i >> 8) & 0xFF;
-    saltWithBlock[saltLen + 3] = i & 0xFF;
-
     // U1 = HMAC(password, salt || INT(i))
-    hmac(password, passwordLen, saltWithBlock, saltLen + 4, u1);
-    memcpy(block, u1, hashSize);
-
-    // U2 = HMAC(password, U1)
+    counter[0] = (i >> 24) & 0xFF;
+    counter[1] = (i >> 16) & 0xFF;
+    counter[2] = (i >> 8) & 0xFF;
+    counter[3] = i & 0xFF;
+    key.compute(salt, saltLen, counter, sizeof(counter), u);
+    memcpy(block, u, hashSize);
+
+    // Uj = HMAC(password, Uj-1)
     for (uint32_t j = 1; j < iterations; j++) {
-      hmac(password, passwordLen, u1, hashSize, u2);
-      memcpy(u1, u2, hashSize);
+      key.compute(u, hashSize, nullptr, 0, u);
 
       // XOR with previous result
       for (size_t k = 0; k < hashSize; k++) {
-        block[k] ^= u1[k];
+        block[k] ^= u[k];
       }
     }
 
@@ -262,4 +316,7 @@ void PBKDF2_HMACBuilder::pbkdf2_hmac(
     size_t copyLen = (i == blocks) ? (outputLen - (i - 1) * hashSize) : hashSize;
     memcpy(output + (i - 1) * hashSize, block, copyLen);
   }
+
+  forced_memzero(u, sizeof(u));
+  forced_memzero(block, sizeof(block));
 }
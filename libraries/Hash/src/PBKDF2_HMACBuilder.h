@@ -19,11 +19,22 @@
 #include <Stream.h>
 #include "HashBuilder.h"
 
+// Default of setLegacyBlockSize() for every PBKDF2_HMACBuilder of the build
+#ifndef PBKDF2_HMAC_LEGACY_BLOCK_SIZE
+#define PBKDF2_HMAC_LEGACY_BLOCK_SIZE 0
+#endif
+
+// PBKDF2 (RFC 8018) with HMAC over the given hash builder. HMAC pads the key
+// to the block size of the hash: 64 bytes for MD5, SHA-1 and SHA-224/256,
+// 128 bytes for SHA-384/512 and the rate for SHA-3. Releases up to 3.3.11
+// always used 64 bytes; setLegacyBlockSize(true) reproduces the keys they
+// derived with SHA-384, SHA-512 and SHA-3.
 class PBKDF2_HMACBuilder : public HashBuilder {
 private:
   HashBuilder *hashBuilder;
   size_t hashSize;
   uint32_t iterations;
+  bool legacyBlockSize;
 
   // Password and salt storage
   uint8_t *password;
@@ -36,7 +47,6 @@ private:
   size_t derivedKeyLen;
   bool calculated;
 
-  void hmac(const uint8_t *key, size_t keyLen, const uint8_t *data, size_t dataLen, uint8_t *output);
   void pbkdf2_hmac(const uint8_t *password, size_t passwordLen, const uint8_t *salt, size_t saltLen, uint32_t iterations, uint8_t *output, size_t outputLen);
   void clearData();
 
@@ -67,6 +77,8 @@ public:
   void setSalt(const char *salt);
   void setSalt(String salt);
   void setIterations(uint32_t iterations);
+  // Use the 64 byte HMAC block of releases up to 3.3.11 for every algorithm
+  void setLegacyBlockSize(bool enable);
   void setHashAlgorithm(HashBuilder *hash);
 };
 
@@ -15,6 +15,7 @@
 // Based on mbed TLS (https://tls.mbed.org)
 
 #include <Arduino.h>
+#include <new>
 #include "SHA1Builder.h"
 
 // 32-bit integer manipulation macros (big endian)
@@ -197,6 +198,11 @@ void SHA1Builder::process(const uint8_t *data) {
 void SHA1Builder::begin(void) {
   finalized = false;
 
+  hw = hw_enabled && hw_ctx.begin(SHAHardware::SHA_HW_1);
+  if (!hw) {
+    hw_ctx.end();
+  }
+
   total[0] = 0;
   total[1] = 0;
 
@@ -218,6 +224,11 @@ void SHA1Builder::add(const uint8_t *data, size_t len) {
     return;
   }
 
+  if (hw) {
+    hw_ctx.add(data, len);
+    return;
+  }
+
   left = total[0] & 0x3F;
   fill = 64 - left;
 
@@ -247,6 +258,35 @@ void SHA1Builder::add(const uint8_t *data, size_t len) {
   }
 }
 
+HashBuilder *SHA1Builder::clone() const {
+  return new (std::nothrow) SHA1Builder(*this);
+}
+
+bool SHA1Builder::copyStateFrom(const HashBuilder &other) {
+  if (&other == this) {
+    return true;
+  }
+  if (other.getBlockSize() != SHA1_BLOCK_SIZE || other.getHashSize() != SHA1_HASH_SIZE) {
+    log_e("State of a different hash algorithm");
+    return false;
+  }
+  const SHA1Builder &src = static_cast<const SHA1Builder &>(other);
+
+  hw = src.hw && hw_ctx.clone(src.hw_ctx);
+  if (src.hw && !hw) {
+    return false;
+  }
+  if (!hw) {
+    hw_ctx.end();
+    memcpy(total, src.total, sizeof(total));
+    memcpy(state, src.state, sizeof(state));
+    memcpy(buffer, src.buffer, src.total[0] & 0x3F);
+  }
+  finalized = src.finalized;
+  memcpy(hash, src.hash, sizeof(hash));
+  return true;
+}
+
 bool SHA1Builder::addStream(Stream &stream, const size_t maxLen) {
   const int buf_size = 512;
   int maxLengthLeft = maxLen;
@@ -295,6 +335,17 @@ void SHA1Builder::calculate(void) {
     return;
   }
 
+  if (hw) {
+    uint8_t digest[64];
+    if (!hw_ctx.finish(digest)) {
+      memset(digest, 0, sizeof(digest));
+    }
+    memcpy(hash, digest, SHA1_HASH_SIZE);
+    forced_memzero(digest, sizeof(digest));
+    finalized = true;
+    return;
+  }
+
   high = (total[0] >> 29) | (total[1] << 3);
   low = (total[0] << 3);
 
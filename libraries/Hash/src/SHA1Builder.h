@@ -19,23 +19,28 @@
 #include <Stream.h>
 
 #include "HashBuilder.h"
+#include "SHAHardware.h"
 
-#define SHA1_HASH_SIZE 20
+#define SHA1_HASH_SIZE  20
+#define SHA1_BLOCK_SIZE 64
 
 class SHA1Builder : public HashBuilder {
 private:
-  uint32_t total[2];            /* number of bytes processed  */
-  uint32_t state[5];            /* intermediate digest state  */
-  unsigned char buffer[64];     /* data block being processed */
-  uint8_t hash[SHA1_HASH_SIZE]; /* SHA-1 result               */
-  bool finalized;               /* Whether hash has been finalized */
+  uint32_t total[2];                     /* number of bytes processed  */
+  uint32_t state[5];                     /* intermediate digest state  */
+  unsigned char buffer[SHA1_BLOCK_SIZE]; /* data block being processed */
+  uint8_t hash[SHA1_HASH_SIZE];          /* SHA-1 result               */
+  bool finalized;                        /* Whether hash has been finalized */
+  SHAHardware hw_ctx;                    /* hardware backend context   */
+  bool hw_enabled;                       /* hardware backend may be used */
+  bool hw;                               /* current hash runs in hardware */
 
   void process(const uint8_t *data);
 
 public:
   using HashBuilder::add;
 
-  SHA1Builder() : finalized(false) {}
+  SHA1Builder() : finalized(false), hw_enabled(true), hw(false) {}
   void begin() override;
   void add(const uint8_t *data, size_t len) override;
   bool addStream(Stream &stream, const size_t maxLen) override;
@@ -46,6 +51,20 @@ public:
   size_t getHashSize() const override {
     return SHA1_HASH_SIZE;
   }
+  size_t getBlockSize() const override {
+    return SHA1_BLOCK_SIZE;
+  }
+  HashBuilder *clone() const override;
+  bool copyStateFrom(const HashBuilder &other) override;
+
+  // Use the SHA peripheral when the build supports it (default: true), applies from the next begin()
+  void setHardwareAcceleration(bool enable) {
+    hw_enabled = enable;
+  }
+  // Whether the hash started by the last begin() is computed in hardware
+  bool usesHardware() const {
+    return hw;
+  }
 };
 
 #endif
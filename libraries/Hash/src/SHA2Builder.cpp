@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <new>
 #include <string.h>
 
 #include "esp32-hal-log.h"
@@ -61,12 +62,26 @@ static const uint64_t sha512_k[80] = {0x428a2f98d728ae22ULL, 0x7137449123ef65cdU
 #define SIG1_32(x)     (ROTR32(x, 17) ^ ROTR32(x, 19) ^ ((x) >> 10))
 #define SIG1_64(x)     (ROTR64(x, 19) ^ ROTR64(x, 61) ^ ((x) >> 6))
 
+// One round, the caller rotates the variable names: d and h are the only ones written
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, i)                \
+  do {                                                         \
+    t1 = (h) + EP1_32(e) + CH32(e, f, g) + sha256_k[i] + w[i]; \
+    (d) += t1;                                                 \
+    (h) = t1 + EP0_32(a) + MAJ32(a, b, c);                     \
+  } while (0)
+#define SHA512_ROUND(a, b, c, d, e, f, g, h, i)                \
+  do {                                                         \
+    t1 = (h) + EP1_64(e) + CH64(e, f, g) + sha512_k[i] + w[i]; \
+    (d) += t1;                                                 \
+    (h) = t1 + EP0_64(a) + MAJ64(a, b, c);                     \
+  } while (0)
+
 // Byte order conversion
 #define BYTESWAP32(x) ((((x) & 0xFF000000) >> 24) | (((x) & 0x00FF0000) >> 8) | (((x) & 0x0000FF00) << 8) | (((x) & 0x000000FF) << 24))
 #define BYTESWAP64(x) (((uint64_t)BYTESWAP32((uint32_t)((x) >> 32))) | (((uint64_t)BYTESWAP32((uint32_t)(x))) << 32))
 
 // Constructor
-SHA2Builder::SHA2Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0), finalized(false), total_length(0) {
+SHA2Builder::SHA2Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0), finalized(false), total_length(0), hw_enabled(true), hw(false) {
   // Determine block size and algorithm family
   if (hash_size == SHA2_224_HASH_SIZE || hash_size == SHA2_256_HASH_SIZE) {
     block_size = SHA2_256_BLOCK_SIZE;
@@ -81,8 +96,23 @@ SHA2Builder::SHA2Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0
   }
 }
 
+SHAHardware::sha_hw_type_t SHA2Builder::hw_type() const {
+  switch (hash_size) {
+    case SHA2_224_HASH_SIZE: return SHAHardware::SHA_HW_224;
+    case SHA2_384_HASH_SIZE: return SHAHardware::SHA_HW_384;
+    case SHA2_512_HASH_SIZE: return SHAHardware::SHA_HW_512;
+    default:                 return SHAHardware::SHA_HW_256;
+  }
+}
+
 // Initialize the hash computation
 void SHA2Builder::begin() {
+  // Prefer the hardware backend, the software rounds below are the fallback
+  hw = hw_enabled && block_size != 0 && hw_ctx.begin(hw_type());
+  if (!hw) {
+    hw_ctx.end();
+  }
+
   // Clear the state and buffer
   memset(state_32, 0, sizeof(state_32));
   memset(state_64, 0, sizeof(state_64));
@@ -145,7 +175,7 @@ void SHA2Builder::begin() {
 void SHA2Builder::process_block_sha256(const uint8_t *data) {
   uint32_t w[64];
   uint32_t a, b, c, d, e, f, g, h;
-  uint32_t t1, t2;
+  uint32_t t1;
 
   // Prepare message schedule
   for (int i = 0; i < 16; i++) {
@@ -165,18 +195,16 @@ void SHA2Builder::process_block_sha256(const uint8_t *data) {
   g = state_32[6];
   h = state_32[7];
 
-  // Main loop
-  for (int i = 0; i < 64; i++) {
-    t1 = h + EP1_32(e) + CH32(e, f, g) + sha256_k[i] + w[i];
-    t2 = EP0_32(a) + MAJ32(a, b, c);
-    h = g;
-    g = f;
-    f = e;
-    e = d + t1;
-    d = c;
-    c = b;
-    b = a;
-    a = t1 + t2;
+  // Main loop, eight rounds per pass so the working variables rotate by name instead of by copy
+  for (int i = 0; i < 64; i += 8) {
+    SHA256_ROUND(a, b, c, d, e, f, g, h, i);
+    SHA256_ROUND(h, a, b, c, d, e, f, g, i + 1);
+    SHA256_ROUND(g, h, a, b, c, d, e, f, i + 2);
+    SHA256_ROUND(f, g, h, a, b, c, d, e, i + 3);
+    SHA256_ROUND(e, f, g, h, a, b, c, d, i + 4);
+    SHA256_ROUND(d, e, f, g, h, a, b, c, i + 5);
+    SHA256_ROUND(c, d, e, f, g, h, a, b, i + 6);
+    SHA256_ROUND(b, c, d, e, f, g, h, a, i + 7);
   }
 
   // Add the compressed chunk to the current hash value
@@ -194,7 +222,7 @@ void SHA2Builder::process_block_sha256(const uint8_t *data) {
 void SHA2Builder::process_block_sha512(const uint8_t *data) {
   uint64_t w[80];
   uint64_t a, b, c, d, e, f, g, h;
-  uint64_t t1, t2;
+  uint64_t t1;
 
   // Prepare message schedule
   for (int i = 0; i < 16; i++) {
@@ -214,18 +242,16 @@ void SHA2Builder::process_block_sha512(const uint8_t *data) {
   g = state_64[6];
   h = state_64[7];
 
-  // Main loop
-  for (int i = 0; i < 80; i++) {
-    t1 = h + EP1_64(e) + CH64(e, f, g) + sha512_k[i] + w[i];
-    t2 = EP0_64(a) + MAJ64(a, b, c);
-    h = g;
-    g = f;
-    f = e;
-    e = d + t1;
-    d = c;
-    c = b;
-    b = a;
-    a = t1 + t2;
+  // Main loop, unrolled like SHA-256
+  for (int i = 0; i < 80; i += 8) {
+    SHA512_ROUND(a, b, c, d, e, f, g, h, i);
+    SHA512_ROUND(h, a, b, c, d, e, f, g, i + 1);
+    SHA512_ROUND(g, h, a, b, c, d, e, f, i + 2);
+    SHA512_ROUND(f, g, h, a, b, c, d, e, i + 3);
+    SHA512_ROUND(e, f, g, h, a, b, c, d, i + 4);
+    SHA512_ROUND(d, e, f, g, h, a, b, c, i + 5);
+    SHA512_ROUND(c, d, e, f, g, h, a, b, i + 6);
+    SHA512_ROUND(b, c, d, e, f, g, h, a, i + 7);
   }
 
   // Add the compressed chunk to the current hash value
@@ -245,6 +271,11 @@ void SHA2Builder::add(const uint8_t *data, size_t len) {
     return;
   }
 
+  if (hw) {
+    hw_ctx.add(data, len);
+    return;
+  }
+
   total_length += len;
   size_t offset = 0;
 
@@ -282,6 +313,44 @@ void SHA2Builder::add(const uint8_t *data, size_t len) {
   }
 }
 
+// Snapshot of the running hash, e.g. an HMAC key block
+HashBuilder *SHA2Builder::clone() const {
+  return new (std::nothrow) SHA2Builder(*this);
+}
+
+// Continue from a snapshot made by clone()
+bool SHA2Builder::copyStateFrom(const HashBuilder &other) {
+  if (&other == this) {
+    return true;
+  }
+  if (other.getBlockSize() != block_size || other.getHashSize() != hash_size) {
+    log_e("State of a different hash algorithm");
+    return false;
+  }
+  const SHA2Builder &src = static_cast<const SHA2Builder &>(other);
+
+  hw = src.hw && hw_ctx.clone(src.hw_ctx);
+  if (src.hw && !hw) {
+    return false;
+  }
+  if (!hw) {
+    hw_ctx.end();
+    if (is_sha512) {
+      memcpy(state_64, src.state_64, sizeof(state_64));
+    } else {
+      memcpy(state_32, src.state_32, sizeof(state_32));
+    }
+    memcpy(buffer, src.buffer, src.buffer_size);
+    buffer_size = src.buffer_size;
+    total_length = src.total_length;
+  }
+  finalized = src.finalized;
+  if (finalized) {
+    memcpy(hash, src.hash, hash_size);
+  }
+  return true;
+}
+
 // Add data from a stream
 bool SHA2Builder::addStream(Stream &stream, const size_t maxLen) {
   const int buf_size = 512;
@@ -374,6 +443,17 @@ void SHA2Builder::calculate() {
     return;
   }
 
+  if (hw) {
+    uint8_t digest[SHA2_512_HASH_SIZE];
+    if (!hw_ctx.finish(digest)) {
+      memset(digest, 0, sizeof(digest));
+    }
+    memcpy(hash, digest, hash_size);
+    forced_memzero(digest, sizeof(digest));
+    finalized = true;
+    return;
+  }
+
   // Pad the input
   pad();
 
@@ -19,6 +19,7 @@
 #include <Stream.h>
 
 #include "HashBuilder.h"
+#include "SHAHardware.h"
 
 // SHA2 constants
 #define SHA2_224_HASH_SIZE 28
@@ -49,7 +50,11 @@ protected:
   bool is_sha512;         // Whether using SHA-512 family
   uint8_t hash[64];       // Hash result
   uint64_t total_length;  // Total length of input data
+  SHAHardware hw_ctx;     // Hardware backend context
+  bool hw_enabled;        // Whether the hardware backend may be used
+  bool hw;                // Whether the current hash runs on the hardware backend
 
+  SHAHardware::sha_hw_type_t hw_type() const;
   void process_block_sha256(const uint8_t *data);
   void process_block_sha512(const uint8_t *data);
   void pad();
@@ -71,6 +76,20 @@ public:
   size_t getHashSize() const override {
     return hash_size;
   }
+  size_t getBlockSize() const override {
+    return block_size;
+  }
+  HashBuilder *clone() const override;
+  bool copyStateFrom(const HashBuilder &other) override;
+
+  // Use the SHA peripheral when the build supports it for this hash size (default: true), applies from the next begin()
+  void setHardwareAcceleration(bool enable) {
+    hw_enabled = enable;
+  }
+  // Whether the hash started by the last begin() is computed in hardware
+  bool usesHardware() const {
+    return hw;
+  }
 };
 
 class SHA224Builder : public SHA2Builder {
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <new>
 
 #include "esp32-hal-log.h"
 #include "SHA3Builder.h"
@@ -183,6 +184,31 @@ void SHA3Builder::add(const uint8_t *data, size_t len) {
   }
 }
 
+// Snapshot of the running hash, e.g. an HMAC key block
+HashBuilder *SHA3Builder::clone() const {
+  return new (std::nothrow) SHA3Builder(*this);
+}
+
+// Continue from a snapshot made by clone()
+bool SHA3Builder::copyStateFrom(const HashBuilder &other) {
+  if (&other == this) {
+    return true;
+  }
+  if (other.getBlockSize() != rate || other.getHashSize() != hash_size) {
+    log_e("State of a different hash algorithm");
+    return false;
+  }
+  const SHA3Builder &src = static_cast<const SHA3Builder &>(other);
+  memcpy(state, src.state, sizeof(state));
+  memcpy(buffer, src.buffer, src.buffer_size);
+  buffer_size = src.buffer_size;
+  finalized = src.finalized;
+  if (finalized) {
+    memcpy(hash, src.hash, hash_size);
+  }
+  return true;
+}
+
 // Add data from a stream
 bool SHA3Builder::addStream(Stream &stream, const size_t maxLen) {
   const int buf_size = 512;
@@ -64,6 +64,11 @@ public:
   size_t getHashSize() const override {
     return hash_size;
   }
+  size_t getBlockSize() const override {
+    return rate;
+  }
+  HashBuilder *clone() const override;
+  bool copyStateFrom(const HashBuilder &other) override;
 };
 
 class SHA3_224Builder : public SHA3Builder {
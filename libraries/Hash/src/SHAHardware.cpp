@@ -0,0 +1,339 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SHAHardware.h"
+
+#if HASH_USE_HW_SHA
+
+#include "esp32-hal-log.h"
+
+#if MBEDTLS_VERSION_MAJOR >= 4
+
+// ==================== PSA crypto (mbedtls 4.x) ====================
+
+static psa_algorithm_t psa_alg(SHAHardware::sha_hw_type_t type) {
+  switch (type) {
+#ifdef PSA_WANT_ALG_SHA_1
+    case SHAHardware::SHA_HW_1: return PSA_ALG_SHA_1;
+#endif
+#ifdef PSA_WANT_ALG_SHA_224
+    case SHAHardware::SHA_HW_224: return PSA_ALG_SHA_224;
+#endif
+#ifdef PSA_WANT_ALG_SHA_256
+    case SHAHardware::SHA_HW_256: return PSA_ALG_SHA_256;
+#endif
+#ifdef PSA_WANT_ALG_SHA_384
+    case SHAHardware::SHA_HW_384: return PSA_ALG_SHA_384;
+#endif
+#ifdef PSA_WANT_ALG_SHA_512
+    case SHAHardware::SHA_HW_512: return PSA_ALG_SHA_512;
+#endif
+    default: return PSA_ALG_NONE;
+  }
+}
+
+bool SHAHardware::available(sha_hw_type_t type) {
+  return psa_alg(type) != PSA_ALG_NONE;
+}
+
+bool SHAHardware::begin(sha_hw_type_t type) {
+  end();
+  psa_algorithm_t alg = psa_alg(type);
+  if (alg == PSA_ALG_NONE || psa_crypto_init() != PSA_SUCCESS) {
+    return false;
+  }
+  _op = PSA_HASH_OPERATION_INIT;
+  if (psa_hash_setup(&_op, alg) != PSA_SUCCESS) {
+    psa_hash_abort(&_op);
+    return false;
+  }
+  _type = type;
+  _active = true;
+  return true;
+}
+
+bool SHAHardware::add(const uint8_t *data, size_t len) {
+  if (!_active) {
+    return false;
+  }
+  psa_status_t ret = psa_hash_update(&_op, data, len);
+  if (ret != PSA_SUCCESS) {
+    log_e("psa_hash_update failed: %d", (int)ret);
+    return false;
+  }
+  return true;
+}
+
+bool SHAHardware::finish(uint8_t *output) {
+  if (!_active) {
+    return false;
+  }
+  size_t len = 0;
+  psa_status_t ret = psa_hash_finish(&_op, output, 64, &len);
+  _active = false;
+  if (ret != PSA_SUCCESS) {
+    log_e("psa_hash_finish failed: %d", (int)ret);
+    psa_hash_abort(&_op);
+    return false;
+  }
+  return true;
+}
+
+void SHAHardware::end() {
+  if (_active) {
+    psa_hash_abort(&_op);
+    _active = false;
+  }
+}
+
+bool SHAHardware::clone(const SHAHardware &other) {
+  end();
+  if (!other._active) {
+    return false;
+  }
+  _op = PSA_HASH_OPERATION_INIT;
+  if (psa_hash_clone(&other._op, &_op) != PSA_SUCCESS) {
+    psa_hash_abort(&_op);
+    return false;
+  }
+  _type = other._type;
+  _active = true;
+  return true;
+}
+
+#else
+
+// ==================== mbedtls 3.x ====================
+
+bool SHAHardware::available(sha_hw_type_t type) {
+  switch (type) {
+#ifdef MBEDTLS_SHA1_C
+    case SHA_HW_1: return true;
+#endif
+#ifdef MBEDTLS_SHA224_C
+    case SHA_HW_224: return true;
+#endif
+#ifdef MBEDTLS_SHA256_C
+    case SHA_HW_256: return true;
+#endif
+#ifdef MBEDTLS_SHA384_C
+    case SHA_HW_384: return true;
+#endif
+#ifdef MBEDTLS_SHA512_C
+    case SHA_HW_512: return true;
+#endif
+    default: return false;
+  }
+}
+
+bool SHAHardware::begin(sha_hw_type_t type) {
+  end();
+  if (!available(type)) {
+    return false;
+  }
+  int ret = -1;
+  switch (type) {
+#ifdef MBEDTLS_SHA1_C
+    case SHA_HW_1:
+      mbedtls_sha1_init(&_ctx.sha1);
+      ret = mbedtls_sha1_starts(&_ctx.sha1);
+      break;
+#endif
+#if defined(MBEDTLS_SHA224_C) || defined(MBEDTLS_SHA256_C)
+    case SHA_HW_224:
+    case SHA_HW_256:
+      mbedtls_sha256_init(&_ctx.sha256);
+      ret = mbedtls_sha256_starts(&_ctx.sha256, type == SHA_HW_224);
+      break;
+#endif
+#if defined(MBEDTLS_SHA384_C) || defined(MBEDTLS_SHA512_C)
+    case SHA_HW_384:
+    case SHA_HW_512:
+      mbedtls_sha512_init(&_ctx.sha512);
+      ret = mbedtls_sha512_starts(&_ctx.sha512, type == SHA_HW_384);
+      break;
+#endif
+    default: break;
+  }
+  _type = type;
+  _active = true;
+  if (ret != 0) {
+    end();
+    return false;
+  }
+  return true;
+}
+
+bool SHAHardware::add(const uint8_t *data, size_t len) {
+  if (!_active) {
+    return false;
+  }
+  int ret = -1;
+  switch (_type) {
+#ifdef MBEDTLS_SHA1_C
+    case SHA_HW_1: ret = mbedtls_sha1_update(&_ctx.sha1, data, len); break;
+#endif
+#if defined(MBEDTLS_SHA224_C) || defined(MBEDTLS_SHA256_C)
+    case SHA_HW_224:
+    case SHA_HW_256: ret = mbedtls_sha256_update(&_ctx.sha256, data, len); break;
+#endif
+#if defined(MBEDTLS_SHA384_C) || defined(MBEDTLS_SHA512_C)
+    case SHA_HW_384:
+    case SHA_HW_512: ret = mbedtls_sha512_update(&_ctx.sha512, data, len); break;
+#endif
+    default: break;
+  }
+  if (ret != 0) {
+    log_e("SHA update failed: %d", ret);
+    return false;
+  }
+  return true;
+}
+
+bool SHAHardware::finish(uint8_t *output) {
+  if (!_active) {
+    return false;
+  }
+  int ret = -1;
+  switch (_type) {
+#ifdef MBEDTLS_SHA1_C
+    case SHA_HW_1: ret = mbedtls_sha1_finish(&_ctx.sha1, output); break;
+#endif
+#if defined(MBEDTLS_SHA224_C) || defined(MBEDTLS_SHA256_C)
+    case SHA_HW_224:
+    case SHA_HW_256: ret = mbedtls_sha256_finish(&_ctx.sha256, output); break;
+#endif
+#if defined(MBEDTLS_SHA384_C) || defined(MBEDTLS_SHA512_C)
+    case SHA_HW_384:
+    case SHA_HW_512: ret = mbedtls_sha512_finish(&_ctx.sha512, output); break;
+#endif
+    default: break;
+  }
+  end();
+  if (ret != 0) {
+    log_e("SHA finish failed: %d", ret);
+    return false;
+  }
+  return true;
+}
+
+void SHAHardware::end() {
+  if (!_active) {
+    return;
+  }
+  // also releases the SHA engine if the context was holding it
+  switch (_type) {
+#ifdef MBEDTLS_SHA1_C
+    case SHA_HW_1: mbedtls_sha1_free(&_ctx.sha1); break;
+#endif
+#if defined(MBEDTLS_SHA224_C) || defined(MBEDTLS_SHA256_C)
+    case SHA_HW_224:
+    case SHA_HW_256: mbedtls_sha256_free(&_ctx.sha256); break;
+#endif
+#if defined(MBEDTLS_SHA384_C) || defined(MBEDTLS_SHA512_C)
+    case SHA_HW_384:
+    case SHA_HW_512: mbedtls_sha512_free(&_ctx.sha512); break;
+#endif
+    default: break;
+  }
+  _active = false;
+}
+
+bool SHAHardware::clone(const SHAHardware &other) {
+  end();
+  if (!other._active) {
+    return false;
+  }
+  switch (other._type) {
+#ifdef MBEDTLS_SHA1_C
+    case SHA_HW_1:
+      mbedtls_sha1_init(&_ctx.sha1);
+      mbedtls_sha1_clone(&_ctx.sha1, &other._ctx.sha1);
+      break;
+#endif
+#if defined(MBEDTLS_SHA224_C) || defined(MBEDTLS_SHA256_C)
+    case SHA_HW_224:
+    case SHA_HW_256:
+      mbedtls_sha256_init(&_ctx.sha256);
+      mbedtls_sha256_clone(&_ctx.sha256, &other._ctx.sha256);
+      break;
+#endif
+#if defined(MBEDTLS_SHA384_C) || defined(MBEDTLS_SHA512_C)
+    case SHA_HW_384:
+    case SHA_HW_512:
+      mbedtls_sha512_init(&_ctx.sha512);
+      mbedtls_sha512_clone(&_ctx.sha512, &other._ctx.sha512);
+      break;
+#endif
+    default: return false;
+  }
+  _type = other._type;
+  _active = true;
+  return true;
+}
+
+#endif /* MBEDTLS_VERSION_MAJOR >= 4 */
+
+#else
+
+// ==================== No hardware backend ====================
+
+bool SHAHardware::available(sha_hw_type_t type) {
+  (void)type;
+  return false;
+}
+
+bool SHAHardware::begin(sha_hw_type_t type) {
+  (void)type;
+  return false;
+}
+
+bool SHAHardware::add(const uint8_t *data, size_t len) {
+  (void)data;
+  (void)len;
+  return false;
+}
+
+bool SHAHardware::finish(uint8_t *output) {
+  (void)output;
+  return false;
+}
+
+void SHAHardware::end() {
+  _active = false;
+}
+
+bool SHAHardware::clone(const SHAHardware &other) {
+  (void)other;
+  return false;
+}
+
+#endif /* HASH_USE_HW_SHA */
+
+SHAHardware::SHAHardware(const SHAHardware &other) : _type(other._type), _active(false) {
+  if (other._active) {
+    clone(other);
+  }
+}
+
+SHAHardware &SHAHardware::operator=(const SHAHardware &other) {
+  if (this != &other) {
+    if (other._active) {
+      clone(other);
+    } else {
+      end();
+    }
+  }
+  return *this;
+}
@@ -0,0 +1,98 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAHardware_h
+#define SHAHardware_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+// SHA1Builder and SHA2Builder hash through mbedTLS, which drives the SHA peripheral,
+// when the SDK is built with hardware SHA. Define as 0 to always use the software rounds.
+#ifndef HASH_USE_HW_SHA
+#if defined(CONFIG_MBEDTLS_HARDWARE_SHA) && CONFIG_MBEDTLS_HARDWARE_SHA
+#define HASH_USE_HW_SHA 1
+#else
+#define HASH_USE_HW_SHA 0
+#endif
+#endif
+
+#if HASH_USE_HW_SHA
+#include "mbedtls/build_info.h"
+#if MBEDTLS_VERSION_MAJOR >= 4
+#include "psa/crypto.h"
+#else
+#include "mbedtls/sha1.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#endif
+#endif
+
+// Hash context of the hardware accelerated backend, used by the builders while a hash is running
+class SHAHardware {
+public:
+  typedef enum {
+    SHA_HW_1,
+    SHA_HW_224,
+    SHA_HW_256,
+    SHA_HW_384,
+    SHA_HW_512
+  } sha_hw_type_t;
+
+  SHAHardware() : _type(SHA_HW_256), _active(false) {}
+  SHAHardware(const SHAHardware &other);
+  SHAHardware &operator=(const SHAHardware &other);
+  ~SHAHardware() {
+    end();
+  }
+
+  /// true if this build can compute type with the hardware backend
+  static bool available(sha_hw_type_t type);
+
+  /// start a new hash, false if the backend can not compute type
+  bool begin(sha_hw_type_t type);
+  bool add(const uint8_t *data, size_t len);
+  /// write the digest (up to 64 bytes) and release the context
+  bool finish(uint8_t *output);
+  /// release the context without a result
+  void end();
+  /// copy the running hash of other, e.g. to continue from a common prefix
+  bool clone(const SHAHardware &other);
+
+  bool active() const {
+    return _active;
+  }
+
+private:
+  sha_hw_type_t _type;
+  bool _active;
+
+#if HASH_USE_HW_SHA
+#if MBEDTLS_VERSION_MAJOR >= 4
+  psa_hash_operation_t _op;
+#else
+  union {
+    mbedtls_sha1_context sha1;
+    mbedtls_sha256_context sha256;
+    mbedtls_sha512_context sha512;
+  } _ctx;
+#endif
+#endif
+};
+
+#endif
@@ -31,6 +31,8 @@
 #define WIFI_CLIENT_MAX_WRITE_RETRY     (10)
 #define WIFI_CLIENT_SELECT_TIMEOUT_US   (1000000)
 #define WIFI_CLIENT_FLUSH_BUFFER_SIZE   (1024)
+#define WIFI_CLIENT_TX_BUFFER_SIZE      (TCP_MSS)
+#define WIFI_CLIENT_MAX_IOV             (8)
 
 #undef connect
 #undef write
@@ -144,6 +146,21 @@ public:
     return _buffer[_pos];
   }
 
+  int peek(uint8_t *dst, size_t len) {
+    if (!dst || !len || (_pos == _fill && !fillBuffer())) {
+      return _failed ? -1 : 0;
+    }
+    if (_fill - _pos < len) {
+      fillBuffer();
+    }
+    size_t a = _fill - _pos;
+    if (a > len) {
+      a = len;
+    }
+    memcpy(dst, _buffer + _pos, a);
+    return a;
+  }
+
   size_t available() {
     return _fill - _pos + r_available();
   }
@@ -160,6 +177,53 @@ public:
   }
 };
 
+class NetworkClientTxBuffer {
+private:
+  size_t _size;
+  uint8_t *_buffer;
+  size_t _fill;
+
+public:
+  bool corked;
+
+  NetworkClientTxBuffer(size_t size = WIFI_CLIENT_TX_BUFFER_SIZE) : _size(size), _buffer(NULL), _fill(0), corked(false) {}
+
+  ~NetworkClientTxBuffer() {
+    free(_buffer);
+  }
+
+  // copies as much of buf as fits, returns the number of bytes taken
+  size_t append(const uint8_t *buf, size_t len) {
+    if (!_buffer) {
+      _buffer = (uint8_t *)malloc(_size);
+      if (!_buffer) {
+        log_e("Not enough memory to allocate buffer");
+        return 0;
+      }
+    }
+    size_t n = (len > _size - _fill) ? _size - _fill : len;
+    memcpy(_buffer + _fill, buf, n);
+    _fill += n;
+    return n;
+  }
+
+  uint8_t *data() {
+    return _buffer;
+  }
+
+  size_t length() {
+    return _fill;
+  }
+
+  size_t size() {
+    return _size;
+  }
+
+  void clear() {
+    _fill = 0;
+  }
+};
+
 class NetworkClientSocketHandle {
 private:
   int sockfd;
@@ -193,12 +257,21 @@ NetworkClient::NetworkClient(int fd) : _connected(true), _timeout(WIFI_CLIENT_DE
 NetworkClient::~NetworkClient() {}
 
 void NetworkClient::stop() {
+  if (_txBuffer && _txBuffer->length() && _connected) {
+    // send what was collected while corked before closing
+    std::shared_ptr<NetworkClientTxBuffer> tx = _txBuffer;
+    _txBuffer = NULL;
+    struct iovec iov = {tx->data(), tx->length()};
+    _sendv(&iov, 1, 0);
+  }
   if (clientSocketHandle) {
     clientSocketHandle->close();
   }
   clientSocketHandle = NULL;
   _rxBuffer = NULL;
+  _txBuffer = NULL;
   _connected = false;
+  _connecting = false;
   _lastReadTimeout = 0;
   _lastWriteTimeout = 0;
 }
@@ -208,10 +281,29 @@ int NetworkClient::connect(IPAddress ip, uint16_t port) {
 }
 
 int NetworkClient::connect(IPAddress ip, uint16_t port, int32_t timeout_ms) {
-  struct sockaddr_storage serveraddr = {};
   _timeout = timeout_ms;
+  if (!NetworkClient::connectAsync(ip, port)) {
+    return 0;
+  }
+  int res = _connectWait(_timeout);
+  if (res == 0) {
+    log_i("select returned due to timeout %d ms for fd %d", _timeout, fd());
+    stop();
+  }
+  return res > 0;
+}
+
+/**
+ * start connecting without waiting for the TCP handshake.
+ * Call connectPoll() until it returns 1 (connected) or -1 (failed).
+ * @return 1 if the connection is in progress, 0 on error
+ */
+int NetworkClient::connectAsync(IPAddress ip, uint16_t port) {
+  struct sockaddr_storage serveraddr = {};
   int sockfd = -1;
 
+  stop();
+
 #if CONFIG_LWIP_IPV6
   if (ip.type() == IPv6) {
     struct sockaddr_in6 *tmpaddr = (struct sockaddr_in6 *)&serveraddr;
@@ -236,13 +328,6 @@ int NetworkClient::connect(IPAddress ip, uint16_t port, int32_t timeout_ms) {
   }
   fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL, 0) | O_NONBLOCK);
 
-  fd_set fdset;
-  struct timeval tv;
-  FD_ZERO(&fdset);
-  FD_SET(sockfd, &fdset);
-  tv.tv_sec = _timeout / 1000;
-  tv.tv_usec = (_timeout % 1000) * 1000;
-
 #ifdef ESP_IDF_VERSION_MAJOR
   int res = lwip_connect(sockfd, (struct sockaddr *)&serveraddr, sizeof(serveraddr));
 #else
@@ -254,38 +339,82 @@ int NetworkClient::connect(IPAddress ip, uint16_t port, int32_t timeout_ms) {
     return 0;
   }
 
-  res = select(sockfd + 1, nullptr, &fdset, nullptr, _timeout < 0 ? nullptr : &tv);
+  clientSocketHandle.reset(new NetworkClientSocketHandle(sockfd));
+  _connecting = true;
+  return 1;
+}
+
+/**
+ * resolve host (blocking) and start connecting without waiting for the TCP handshake
+ * @return 1 if the connection is in progress, 0 on error
+ */
+int NetworkClient::connectAsync(const char *host, uint16_t port) {
+  IPAddress srv((uint32_t)0);
+  if (!Network.hostByName(host, srv)) {
+    return 0;
+  }
+  return connectAsync(srv, port);
+}
+
+/**
+ * check on a connection started with connectAsync() without blocking
+ * @return 1 connected, 0 still in progress, -1 failed (the socket is closed)
+ */
+int NetworkClient::connectPoll() {
+  return _connectWait(0);
+}
+
+bool NetworkClient::connecting() const {
+  return _connecting;
+}
+
+int NetworkClient::_connectWait(int32_t timeout_ms) {
+  int sockfd = fd();
+  if (!_connecting || sockfd < 0) {
+    return _connected ? 1 : -1;
+  }
+
+  fd_set fdset;
+  struct timeval tv;
+  FD_ZERO(&fdset);
+  FD_SET(sockfd, &fdset);
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+  int res = select(sockfd + 1, nullptr, &fdset, nullptr, timeout_ms < 0 ? nullptr : &tv);
   if (res < 0) {
     log_e("select on fd %d, errno: %d, \"%s\"", sockfd, errno, strerror(errno));
-    close(sockfd);
-    return 0;
+    stop();
+    return -1;
   } else if (res == 0) {
-    log_i("select returned due to timeout %d ms for fd %d", _timeout, sockfd);
-    close(sockfd);
     return 0;
-  } else {
-    int sockerr;
-    socklen_t len = (socklen_t)sizeof(int);
-    res = getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &sockerr, &len);
+  }
 
-    if (res < 0) {
-      log_e("getsockopt on fd %d, errno: %d, \"%s\"", sockfd, errno, strerror(errno));
-      close(sockfd);
-      return 0;
-    }
+  int sockerr;
+  socklen_t len = (socklen_t)sizeof(int);
+  res = getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &sockerr, &len);
 
-    if (sockerr != 0) {
-      log_e("socket error on fd %d, errno: %d, \"%s\"", sockfd, sockerr, strerror(sockerr));
-      close(sockfd);
-      return 0;
-    }
+  if (res < 0) {
+    log_e("getsockopt on fd %d, errno: %d, \"%s\"", sockfd, errno, strerror(errno));
+    stop();
+    return -1;
+  }
+
+  if (sockerr != 0) {
+    log_e("socket error on fd %d, errno: %d, \"%s\"", sockfd, sockerr, strerror(sockerr));
+    stop();
+    return -1;
   }
 
+  tv.tv_sec = _timeout / 1000;
+  tv.tv_usec = (_timeout % 1000) * 1000;
+
 #define ROE_WIFICLIENT(x, msg)                                                                           \
   {                                                                                                      \
     if (((x) < 0)) {                                                                                     \
       log_e("Setsockopt '" msg "'' on fd %d failed. errno: %d, \"%s\"", sockfd, errno, strerror(errno)); \
-      return 0;                                                                                          \
+      stop();                                                                                            \
+      return -1;                                                                                         \
     }                                                                                                    \
   }
   ROE_WIFICLIENT(setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)), "SO_SNDTIMEO");
@@ -296,9 +425,9 @@ int NetworkClient::connect(IPAddress ip, uint16_t port, int32_t timeout_ms) {
   //ROE_WIFICLIENT (setsockopt(sockfd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable)),"SO_KEEPALIVE");
 
   fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL, 0) & (~O_NONBLOCK));
-  clientSocketHandle.reset(new NetworkClientSocketHandle(sockfd));
   _rxBuffer.reset(new NetworkClientRxBuffer(sockfd));
 
+  _connecting = false;
   _connected = true;
   return 1;
 }
@@ -380,20 +509,152 @@ int NetworkClient::read() {
 }
 
 void NetworkClient::flush() {
-  // NetworkClient has no TX buffer; clear() is the explicit RX discard API.
+  // Only data collected while corked is buffered; clear() is the explicit RX discard API.
+  if (_txBuffer && _txBuffer->length()) {
+    struct iovec iov = {_txBuffer->data(), _txBuffer->length()};
+    size_t len = iov.iov_len;
+    _txBuffer->clear();
+    if (_sendv(&iov, 1, 0) != len) {
+      log_w("flush of %u corked bytes on fd %d incomplete", (unsigned)len, fd());
+    }
+  }
+}
+
+/**
+ * hold back small writes and send them in full TCP segments.
+ * Data is sent when a segment worth of data is collected, on flush(),
+ * uncork() and stop().
+ */
+void NetworkClient::cork() {
+  if (!_txBuffer) {
+    _txBuffer.reset(new NetworkClientTxBuffer());
+  }
+  _txBuffer->corked = true;
+}
+
+/**
+ * send the collected data and go back to sending every write immediately
+ */
+void NetworkClient::uncork() {
+  if (!_txBuffer) {
+    return;
+  }
+  _txBuffer->corked = false;
+  flush();
+}
+
+bool NetworkClient::corked() const {
+  return _txBuffer && _txBuffer->corked;
+}
+
+uint32_t NetworkClient::txBytes() const {
+  return _txBytes;
+}
+
+uint32_t NetworkClient::estimatedTxSegments() const {
+  return _estimatedTxSegments;
+}
+
+void NetworkClient::resetTxStats() {
+  _txBytes = 0;
+  _estimatedTxSegments = 0;
 }
 
 size_t NetworkClient::write(const uint8_t *buf, size_t size) {
+  struct iovec iov = {(void *)buf, size};
+  return writev(&iov, 1);
+}
+
+/**
+ * scatter-gather write: sends the buffers as if they were one, letting the
+ * TCP stack fill segments across buffer boundaries
+ * @return bytes sent
+ */
+size_t NetworkClient::writev(const struct iovec *iov, int iovcnt) {
+  struct iovec vec[WIFI_CLIENT_MAX_IOV];
+  size_t totalBytesSent = 0;
+
+  if (!_connected || (fd() < 0)) {
+    return 0;
+  }
+
+  if (corked()) {
+    for (int i = 0; i < iovcnt; i++) {
+      const uint8_t *buf = (const uint8_t *)iov[i].iov_base;
+      size_t left = iov[i].iov_len;
+      while (left) {
+        if (_txBuffer->length() + left < _txBuffer->size()) {
+          if (_txBuffer->append(buf, left) != left) {
+            return totalBytesSent;
+          }
+          totalBytesSent += left;
+          break;
+        }
+        // a segment is complete: send the collected data together with this buffer
+        vec[0].iov_base = _txBuffer->data();
+        vec[0].iov_len = _txBuffer->length();
+        vec[1].iov_base = (void *)buf;
+        vec[1].iov_len = left;
+        size_t pending = vec[0].iov_len + left;
+        _txBuffer->clear();
+#ifdef MSG_MORE
+        size_t sent = _sendv(vec, 2, MSG_MORE);
+#else
+        size_t sent = _sendv(vec, 2, 0);
+#endif
+        if (sent != pending) {
+          return totalBytesSent;
+        }
+        totalBytesSent += left;
+        left = 0;
+      }
+    }
+    return totalBytesSent;
+  }
+
+  while (iovcnt > 0) {
+    int n = (iovcnt > WIFI_CLIENT_MAX_IOV) ? WIFI_CLIENT_MAX_IOV : iovcnt;
+    size_t len = 0;
+    for (int i = 0; i < n; i++) {
+      vec[i] = iov[i];
+      len += iov[i].iov_len;
+    }
+    size_t sent = _sendv(vec, n, 0);
+    totalBytesSent += sent;
+    if (sent != len) {
+      break;
+    }
+    iov += n;
+    iovcnt -= n;
+  }
+  return totalBytesSent;
+}
+
+/**
+ * sends all iov buffers, iov is modified to track the progress
+ * @return bytes sent
+ */
+size_t NetworkClient::_sendv(struct iovec *iov, int iovcnt, int flags) {
   int res = 0;
   int retry = WIFI_CLIENT_MAX_WRITE_RETRY;
   int socketFileDescriptor = fd();
   size_t totalBytesSent = 0;
-  size_t bytesRemaining = size;
+  size_t size = 0;
+
+  for (int i = 0; i < iovcnt; i++) {
+    size += iov[i].iov_len;
+  }
 
-  if (!_connected || (socketFileDescriptor < 0)) {
+  if (!_connected || (socketFileDescriptor < 0) || !size) {
     return 0;
   }
 
+  // skip empty buffers at the front
+  while (iovcnt && !iov->iov_len) {
+    iov++;
+    iovcnt--;
+  }
+
   while (retry) {
     //use select to make sure the socket is ready for writing
     fd_set set;
@@ -420,15 +681,31 @@ size_t NetworkClient::write(const uint8_t *buf, size_t size) {
     }
 
     if (FD_ISSET(socketFileDescriptor, &set)) {
-      res = send(socketFileDescriptor, (void *)buf, bytesRemaining, MSG_DONTWAIT);
+      if (iovcnt == 1) {
+        res = send(socketFileDescriptor, iov->iov_base, iov->iov_len, MSG_DONTWAIT | flags);
+      } else {
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        res = sendmsg(socketFileDescriptor, &msg, MSG_DONTWAIT | flags);
+      }
       if (res > 0) {
         totalBytesSent += res;
+        _txBytes += res;
+        _estimatedTxSegments += (res + WIFI_CLIENT_TX_BUFFER_SIZE - 1) / WIFI_CLIENT_TX_BUFFER_SIZE;
         if (totalBytesSent >= size) {
           //completed successfully
           retry = 0;
         } else {
-          buf += res;
-          bytesRemaining -= res;
+          // advance past what was sent
+          size_t done = res;
+          while (done >= iov->iov_len) {
+            done -= iov->iov_len;
+            iov++;
+            iovcnt--;
+          }
+          iov->iov_base = (uint8_t *)iov->iov_base + done;
+          iov->iov_len -= done;
           retry = WIFI_CLIENT_MAX_WRITE_RETRY;
         }
       } else if (res < 0) {
@@ -550,6 +827,18 @@ int NetworkClient::peek() {
   return res;
 }
 
+int NetworkClient::peek(uint8_t *buf, size_t size) {
+  int res = -1;
+  if (fd() >= 0 && _rxBuffer) {
+    res = _rxBuffer->peek(buf, size);
+    if (_rxBuffer->failed()) {
+      log_e("fail on fd %d, errno: %d, \"%s\"", fd(), errno, strerror(errno));
+      stop();
+    }
+  }
+  return res;
+}
+
 int NetworkClient::available() {
   if (fd() < 0 || !_rxBuffer) {
     return 0;
@@ -22,9 +22,11 @@
 #include "Arduino.h"
 #include "Client.h"
 #include <memory>
+#include <sys/uio.h>
 
 class NetworkClientSocketHandle;
 class NetworkClientRxBuffer;
+class NetworkClientTxBuffer;
 
 class ESPLwIPClient : public Client {
 public:
@@ -38,11 +40,15 @@ class NetworkClient : public ESPLwIPClient {
 protected:
   std::shared_ptr<NetworkClientSocketHandle> clientSocketHandle = nullptr;
   std::shared_ptr<NetworkClientRxBuffer> _rxBuffer = nullptr;
+  std::shared_ptr<NetworkClientTxBuffer> _txBuffer = nullptr;
   bool _connected = false;
+  bool _connecting = false;
   bool _sse = false;
   int _timeout;
   int _lastWriteTimeout = 0;
   int _lastReadTimeout = 0;
+  uint32_t _txBytes = 0;
+  uint32_t _estimatedTxSegments = 0;
 
 public:
   NetworkClient *next;
@@ -53,12 +59,32 @@ public:
   int connect(IPAddress ip, uint16_t port, int32_t timeout_ms);
   int connect(const char *host, uint16_t port);
   int connect(const char *host, uint16_t port, int32_t timeout_ms);
+  /// non-blocking connect, poll with connectPoll() (DNS resolution of host still blocks)
+  virtual int connectAsync(IPAddress ip, uint16_t port);
+  virtual int connectAsync(const char *host, uint16_t port);
+  virtual int connectPoll();
+  bool connecting() const;
+  /// true while connectPoll() waits for a TLS handshake (NetworkClientSecure) instead of the TCP handshake
+  virtual bool handshaking() const {
+    return false;
+  }
   size_t write(uint8_t data);
   size_t write(const uint8_t *buf, size_t size);
   size_t write_P(PGM_P buf, size_t size);
   size_t write(Stream &stream);
   size_t write(Stream &stream, size_t length);
-  void flush();  // Print::flush tx
+  virtual size_t writev(const struct iovec *iov, int iovcnt);
+  void flush();  // Print::flush tx, sends data held back by cork()
+  /// coalesce small writes into full TCP segments until uncork()
+  virtual void cork();
+  virtual void uncork();
+  virtual bool corked() const;
+  /// bytes handed to the TCP stack
+  uint32_t txBytes() const;
+  /// estimate, not a count of the segments sent: every send() adds its bytes divided by TCP_MSS, rounded up.
+  /// Segments that Nagle, delayed ACKs or retransmissions add or merge in the TCP stack are not seen
+  uint32_t estimatedTxSegments() const;
+  void resetTxStats();
   int available();
   int read();
   int read(uint8_t *buf, size_t size);
@@ -67,6 +93,8 @@ public:
     return readBytes((char *)buffer, length);
   }
   int peek();
+  // copies the bytes the next reads will return, without waiting for more; returns the number copied
+  virtual int peek(uint8_t *buf, size_t size);
   void clear();  // clear rx
   void stop();
   uint8_t connected();
@@ -109,4 +137,8 @@ public:
 
   //friend class NetworkServer;
   using Print::write;
+
+protected:
+  int _connectWait(int32_t timeout_ms);
+  size_t _sendv(struct iovec *iov, int iovcnt, int flags);
 };
@@ -52,6 +52,8 @@ NetworkClientSecure::NetworkClientSecure() {
   next = NULL;
   _alpn_protos = NULL;
   _use_ca_bundle = false;
+  _handshaking = false;
+  _handshakeStart = 0;
 }
 
 NetworkClientSecure::NetworkClientSecure(int sock) {
@@ -84,6 +86,8 @@ NetworkClientSecure::NetworkClientSecure(int sock) {
   _psKey = NULL;
   next = NULL;
   _alpn_protos = NULL;
+  _handshaking = false;
+  _handshakeStart = 0;
 }
 
 NetworkClientSecure::~NetworkClientSecure() {
@@ -99,10 +103,13 @@ NetworkClientSecure::~NetworkClientSecure() {
 }
 
 void NetworkClientSecure::stop() {
+  flush();
   stop_ssl_socket(sslclient.get());
 
   _connected = false;
-  sslclient->peek_buf = -1;
+  _connecting = false;
+  _handshaking = false;
+  sslclient->peek_len = 0;
   _lastReadTimeout = 0;
   _lastWriteTimeout = 0;
 }
@@ -160,6 +167,85 @@ int NetworkClientSecure::connect(IPAddress ip, uint16_t port, const char *host,
     stop();
     return 0;
   }
+  _connecting = false;
+  _handshaking = false;
+  _connected = true;
+  return 1;
+}
+
+int NetworkClientSecure::connectAsync(IPAddress ip, uint16_t port) {
+  return _connectAsync(ip, port, NULL);
+}
+
+/**
+ * resolve host (blocking) and start connecting without waiting for the TCP and TLS handshakes
+ * @return 1 if the connection is in progress, 0 on error
+ */
+int NetworkClientSecure::connectAsync(const char *host, uint16_t port) {
+  IPAddress address;
+  if (!Network.hostByName(host, address)) {
+    return 0;
+  }
+  return _connectAsync(address, port, host);
+}
+
+int NetworkClientSecure::_connectAsync(IPAddress ip, uint16_t port, const char *host) {
+  int ret;
+  if (_pskIdent && _psKey) {
+    ret = start_ssl_client_async(sslclient.get(), ip, port, host, _timeout, NULL, false, NULL, NULL, _pskIdent, _psKey, _use_insecure, _alpn_protos);
+  } else {
+    ret = start_ssl_client_async(sslclient.get(), ip, port, host, _timeout, _CA_cert, _use_ca_bundle, _cert, _private_key, NULL, NULL, _use_insecure, _alpn_protos);
+  }
+  sslclient->last_error = ret;
+  if (ret < 0) {
+    log_e("start_ssl_client: connect failed: %d", ret);
+    stop();
+    return 0;
+  }
+  _connecting = true;
+  _handshaking = false;
+  return 1;
+}
+
+/**
+ * check on a connection started with connectAsync() without waiting for the network
+ * @return 1 connected (and the handshake verified), 0 still in progress, -1 failed
+ */
+int NetworkClientSecure::connectPoll() {
+  if (!_connecting) {
+    return _connected ? 1 : -1;
+  }
+
+  int ret = 1;
+  if (!_handshaking) {
+    ret = ssl_connect_poll(sslclient.get(), 0);
+    if (ret == 0) {
+      return 0;
+    }
+    if (ret > 0 && !_stillinPlainStart) {
+      log_v("Performing the SSL/TLS handshake...");
+      _handshaking = true;
+      _handshakeStart = millis();
+    }
+  }
+  if (_handshaking) {
+    ret = ssl_handshake_poll(sslclient.get());
+    if (ret == 0) {
+      if ((millis() - _handshakeStart) <= sslclient->handshake_timeout) {
+        return 0;
+      }
+      ret = -1;
+    }
+  }
+
+  _connecting = false;
+  _handshaking = false;
+  if (ret < 0) {
+    sslclient->last_error = ret;
+    log_e("start_ssl_client: connect failed: %d", ret);
+    stop();
+    return -1;
+  }
   _connected = true;
   return 1;
 }
@@ -200,22 +286,128 @@ int NetworkClientSecure::connect(const char *host, uint16_t port, const char *ps
     stop();
     return 0;
   }
+  _connecting = false;
+  _handshaking = false;
   _connected = true;
   return 1;
 }
 
 int NetworkClientSecure::peek() {
-  if (sslclient->peek_buf >= 0) {
-    return sslclient->peek_buf;
+  if (sslclient->peek_len) {
+    return sslclient->peek_buf[0];
+  }
+  int c = timedRead();
+  if (c >= 0) {
+    sslclient->peek_buf[0] = c;
+    sslclient->peek_len = 1;
+  }
+  return c;
+}
+
+/**
+ * copies up to size bytes (at most SSL_CLIENT_PEEK_SIZE) that the next reads will return, without blocking
+ * @return number of bytes copied, or -1 on error
+ */
+int NetworkClientSecure::peek(uint8_t *buf, size_t size) {
+  if (!buf) {
+    return -1;
+  }
+  if (_stillinPlainStart) {
+    return 0;
+  }
+  if (size > SSL_CLIENT_PEEK_SIZE) {
+    size = SSL_CLIENT_PEEK_SIZE;
   }
-  sslclient->peek_buf = timedRead();
-  return sslclient->peek_buf;
+  if (sslclient->peek_len < size && _connected) {
+    int avail = data_to_read(sslclient.get());
+    if (avail > 0) {
+      size_t want = size - sslclient->peek_len;
+      int res = get_ssl_receive(sslclient.get(), sslclient->peek_buf + sslclient->peek_len, (size_t)avail < want ? avail : want);
+      if (res > 0) {
+        sslclient->peek_len += res;
+      }
+    }
+  }
+  if (size > sslclient->peek_len) {
+    size = sslclient->peek_len;
+  }
+  memcpy(buf, sslclient->peek_buf, size);
+  return size;
 }
 
 size_t NetworkClientSecure::write(uint8_t data) {
   return write(&data, 1);
 }
 
+size_t NetworkClientSecure::writev(const struct iovec *iov, int iovcnt) {
+  if (!_connected || !iov || iovcnt <= 0) {
+    return 0;
+  }
+  if (!sslclient->tx_buf) {
+    sslclient->tx_buf = (uint8_t *)malloc(SSL_CLIENT_TX_BUFFER_SIZE);
+  }
+
+  // small buffers are copied together so that they go out as one TLS record instead of one record each
+  size_t total = 0;
+  for (int i = 0; i < iovcnt; i++) {
+    const uint8_t *buf = (const uint8_t *)iov[i].iov_base;
+    size_t len = iov[i].iov_len;
+    if (!sslclient->tx_buf || (!sslclient->tx_len && len >= SSL_CLIENT_TX_BUFFER_SIZE)) {
+      size_t sent = _sendRecord(buf, len);
+      total += sent;
+      if (sent != len) {
+        return total;
+      }
+      continue;
+    }
+    while (len) {
+      size_t n = SSL_CLIENT_TX_BUFFER_SIZE - sslclient->tx_len;
+      if (n > len) {
+        n = len;
+      }
+      memcpy(sslclient->tx_buf + sslclient->tx_len, buf, n);
+      sslclient->tx_len += n;
+      buf += n;
+      len -= n;
+      total += n;
+      if (sslclient->tx_len == SSL_CLIENT_TX_BUFFER_SIZE && !_sendStaged()) {
+        return total > SSL_CLIENT_TX_BUFFER_SIZE ? total - SSL_CLIENT_TX_BUFFER_SIZE : 0;
+      }
+    }
+  }
+
+  size_t staged = sslclient->tx_len;
+  if (!sslclient->tx_corked && staged && !_sendStaged()) {
+    return total > staged ? total - staged : 0;
+  }
+  return total;
+}
+
+void NetworkClientSecure::flush() {
+  if (_connected && sslclient->tx_len) {
+    _sendStaged();
+  }
+}
+
+void NetworkClientSecure::cork() {
+  sslclient->tx_corked = true;
+}
+
+void NetworkClientSecure::uncork() {
+  sslclient->tx_corked = false;
+  flush();
+}
+
+bool NetworkClientSecure::corked() const {
+  return sslclient->tx_corked;
+}
+
+bool NetworkClientSecure::_sendStaged() {
+  size_t len = sslclient->tx_len;
+  sslclient->tx_len = 0;  // a failed send stops the client, which frees tx_buf
+  return _sendRecord(sslclient->tx_buf, len) == len;
+}
+
 int NetworkClientSecure::read() {
   uint8_t data = -1;
   int res = read(&data, 1);
@@ -231,8 +423,17 @@ size_t NetworkClientSecure::write(const uint8_t *buf, size_t size) {
     return 0;
   }
 
+  if (sslclient->tx_corked) {
+    struct iovec iov = {(void *)buf, size};
+    return writev(&iov, 1);
+  }
+  return _sendRecord(buf, size);
+}
+
+size_t NetworkClientSecure::_sendRecord(const uint8_t *buf, size_t size) {
   if (_stillinPlainStart) {
-    return send_net_data(sslclient.get(), buf, size);
+    int res = send_net_data(sslclient.get(), buf, size);
+    return res > 0 ? res : 0;
   }
 
   if (_lastWriteTimeout != _timeout) {
@@ -276,16 +477,17 @@ int NetworkClientSecure::read(uint8_t *buf, size_t size) {
   if (!size) {
     return 0;
   }
-  if (sslclient->peek_buf >= 0) {
-    buf[0] = sslclient->peek_buf;
-    sslclient->peek_buf = -1;
-    size--;
-    avail--;
+  if (sslclient->peek_len) {
+    peeked = size < sslclient->peek_len ? size : sslclient->peek_len;
+    memcpy(buf, sslclient->peek_buf, peeked);
+    sslclient->peek_len -= peeked;
+    memmove(sslclient->peek_buf, sslclient->peek_buf + peeked, sslclient->peek_len);
+    size -= peeked;
+    avail -= peeked;
     if (!size || !avail) {
-      return 1;
+      return peeked;
     }
-    buf++;
-    peeked = 1;
+    buf += peeked;
   }
   res = get_ssl_receive(sslclient.get(), buf, size);
 
@@ -302,7 +504,7 @@ int NetworkClientSecure::available() {
     return peek_net_receive(sslclient.get(), 0);
   }
 
-  int peeked = (sslclient->peek_buf >= 0), res = -1;
+  int peeked = sslclient->peek_len, res = -1;
   if (!_connected) {
     return peeked;
   }
@@ -460,6 +662,93 @@ void NetworkClientSecure::setAlpnProtocols(const char **alpn_protos) {
   _alpn_protos = alpn_protos;
 }
 
+bool NetworkClientSecure::setMaxFragmentLength(uint16_t max_fragment_length) {
+  unsigned char mfl_code = ssl_max_fragment_length_code(max_fragment_length);
+  sslclient->mfl_code = mfl_code;
+  return max_fragment_length == 0 || mfl_code != 0;
+}
+
+bool NetworkClientSecure::setSharedConfig(const NetworkClientSecureConfig &config) {
+  if (_connected) {
+    log_e("Cannot change the TLS config of a connected client");
+    return false;
+  }
+  if (!config.ready()) {
+    _shared_conf.reset();
+    sslclient->shared_conf = NULL;
+    return false;
+  }
+  _shared_conf = config._conf;
+  sslclient->shared_conf = _shared_conf.get();
+  return true;
+}
+
 int NetworkClientSecure::fd() const {
   return sslclient->socket;
 }
+
+NetworkClientSecureConfig::NetworkClientSecureConfig() {
+  _use_insecure = false;
+  _use_ca_bundle = false;
+  _CA_cert = NULL;
+  _cert = NULL;
+  _private_key = NULL;
+  _alpn_protos = NULL;
+  _mfl_code = 0;
+  _last_error = 0;
+}
+
+void NetworkClientSecureConfig::setInsecure() {
+  _CA_cert = NULL;
+  _cert = NULL;
+  _private_key = NULL;
+  _use_insecure = true;
+}
+
+void NetworkClientSecureConfig::setCACert(const char *rootCA) {
+  _CA_cert = rootCA;
+  _use_insecure = false;
+}
+
+void NetworkClientSecureConfig::useBuiltinCACertBundle() {
+  _use_ca_bundle = true;
+}
+
+void NetworkClientSecureConfig::setCertificate(const char *client_ca) {
+  _cert = client_ca;
+}
+
+void NetworkClientSecureConfig::setPrivateKey(const char *private_key) {
+  _private_key = private_key;
+}
+
+void NetworkClientSecureConfig::setAlpnProtocols(const char **alpn_protos) {
+  _alpn_protos = alpn_protos;
+}
+
+bool NetworkClientSecureConfig::setMaxFragmentLength(uint16_t max_fragment_length) {
+  _mfl_code = ssl_max_fragment_length_code(max_fragment_length);
+  return max_fragment_length == 0 || _mfl_code != 0;
+}
+
+bool NetworkClientSecureConfig::begin() {
+  // Clients still using a previous config keep their own reference to it
+  std::shared_ptr<sslclient_shared_config> conf(new sslclient_shared_config(), [](sslclient_shared_config *conf) {
+    ssl_shared_config_free(conf);
+    delete conf;
+  });
+
+  _last_error = ssl_shared_config_init(
+    conf.get(), _CA_cert, _use_ca_bundle, _use_ca_bundle ? &esp_crt_bundle_attach : NULL, _cert, _private_key, _use_insecure, _alpn_protos, _mfl_code
+  );
+  if (_last_error != 0) {
+    log_e("ssl_shared_config_init failed: %d", _last_error);
+    return false;
+  }
+  _conf = conf;
+  return true;
+}
+
+void NetworkClientSecureConfig::end() {
+  _conf.reset();
+}
@@ -26,8 +26,56 @@
 #include "ssl_client.h"
 #include <memory>
 
+// A TLS configuration (trust store, own certificate, ALPN and max fragment
+// length) that is parsed once and then shared by any number of
+// NetworkClientSecure objects. Each client only keeps a reference, so the CA
+// chain and mbedtls_ssl_config are not duplicated per connection. The
+// certificates are released once the config and all clients using it are gone.
+class NetworkClientSecureConfig {
+public:
+  NetworkClientSecureConfig();
+
+  void setInsecure();
+  void setCACert(const char *rootCA);
+  void useBuiltinCACertBundle();
+  void setCertificate(const char *client_ca);
+  void setPrivateKey(const char *private_key);
+  void setAlpnProtocols(const char **alpn_protos);
+  bool setMaxFragmentLength(uint16_t max_fragment_length);  // 512, 1024, 2048 or 4096 bytes, 0 to disable
+
+  // Parses the certificates and builds the shared mbedtls configuration.
+  // The PEM buffers are no longer needed once this returns true.
+  bool begin();
+  void end();
+  bool ready() const {
+    return _conf && _conf->initialized;
+  }
+  int lastError() const {
+    return _last_error;
+  }
+  // Number of NetworkClientSecure objects (plus this config) referencing the shared state
+  long useCount() const {
+    return _conf.use_count();
+  }
+
+private:
+  friend class NetworkClientSecure;
+
+  std::shared_ptr<sslclient_shared_config> _conf;
+  bool _use_insecure;
+  bool _use_ca_bundle;
+  const char *_CA_cert;
+  const char *_cert;
+  const char *_private_key;
+  const char **_alpn_protos;
+  unsigned char _mfl_code;
+  int _last_error;
+};
+
 class NetworkClientSecure : public NetworkClient {
 protected:
+  // declared before sslclient so that the ssl context is freed before the config it points to
+  std::shared_ptr<sslclient_shared_config> _shared_conf;
   std::shared_ptr<sslclient_context> sslclient;
 
   bool _use_insecure;
@@ -42,6 +90,8 @@ protected:
   const char *_psKey;     // key in hex for PSK cipher suites
   const char **_alpn_protos;
   bool _use_ca_bundle;
+  bool _handshaking;
+  unsigned long _handshakeStart;
 
 public:
   NetworkClientSecure *next;
@@ -57,13 +107,28 @@ public:
   int connect(IPAddress ip, uint16_t port, const char *pskIdent, const char *psKey);
   int connect(const char *host, uint16_t port, const char *pskIdent, const char *psKey);
   int connect(IPAddress ip, uint16_t port, const char *host, const char *CA_cert, const char *cert, const char *private_key);
+  // Start the TCP connection without waiting for it. connectPoll() then runs the TLS
+  // handshake as far as the received data allows and returns 1 once it is verified.
+  // Resolving host still blocks, and each handshake step spends its crypto time inside connectPoll().
+  int connectAsync(IPAddress ip, uint16_t port) override;
+  int connectAsync(const char *host, uint16_t port) override;
+  int connectPoll() override;
+  bool handshaking() const override {
+    return _handshaking;
+  }
   int peek();
+  int peek(uint8_t *buf, size_t size) override;
   size_t write(uint8_t data);
   size_t write(const uint8_t *buf, size_t size);
+  size_t writev(const struct iovec *iov, int iovcnt) override;
   int available();
   int read();
   int read(uint8_t *buf, size_t size);
-  void flush() {}
+  void flush();  // sends plaintext staged by cork() or writev() as one TLS record
+  /// coalesce small writes into TLS records of up to SSL_CLIENT_TX_BUFFER_SIZE bytes until uncork()
+  void cork() override;
+  void uncork() override;
+  bool corked() const override;
   void stop();
   uint8_t connected();
   int lastError(char *buf, const size_t size);
@@ -79,9 +144,23 @@ public:
   bool verify(const char *fingerprint, const char *domain_name);
   void setHandshakeTimeout(unsigned long handshake_timeout);
   void setAlpnProtocols(const char **alpn_protos);
+  bool setMaxFragmentLength(uint16_t max_fragment_length);  // 512, 1024, 2048 or 4096 bytes, 0 to disable
 
   void useBuiltinCACertBundle();
 
+  // Use a pre-parsed configuration shared with other clients instead of the
+  // per-client CA/certificate settings. Pass a config that is not ready() to
+  // go back to the per-client settings.
+  bool setSharedConfig(const NetworkClientSecureConfig &config);
+
+  // Approximate internal heap (in bytes) held by the last established connection.
+  // It is the drop of the global free internal heap during connect(), so memory
+  // allocated or freed meanwhile by other tasks is counted as well. Use it as an
+  // estimate only, not to account for mbedTLS allocations.
+  uint32_t getHeapUsage() const {
+    return sslclient->heap_used;
+  }
+
   // Certain protocols start in plain-text; and then have the client
   // give some STARTSSL command to `upgrade' the connection to TLS
   // or SSL. Setting PlainStart to true (the default is false) enables
@@ -124,7 +203,10 @@ public:
   }
 
 private:
+  int _connectAsync(IPAddress ip, uint16_t port, const char *host);
   char *_streamLoad(Stream &stream, size_t size);
+  size_t _sendRecord(const uint8_t *buf, size_t size);
+  bool _sendStaged();
 
   //friend class NetworkServer;
   using Print::write;
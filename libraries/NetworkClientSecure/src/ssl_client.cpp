@@ -23,6 +23,7 @@
 #include <string>
 #include "ssl_client.h"
 #include "esp_crt_bundle.h"
+#include "esp_random.h"
 
 #if !defined(MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED) && !defined(MBEDTLS_KEY_EXCHANGE_SOME_PSK_ENABLED)
 #warning \
@@ -55,7 +56,7 @@ void ssl_init(sslclient_context *ssl_client) {
 #if MBEDTLS_VERSION_MAJOR < 4
   mbedtls_ctr_drbg_init(&ssl_client->drbg_ctx);
 #endif
-  ssl_client->peek_buf = -1;
+  ssl_client->peek_len = 0;
 }
 
 void attach_ssl_certificate_bundle(sslclient_context *ssl_client, bool att) {
@@ -66,15 +67,231 @@ void attach_ssl_certificate_bundle(sslclient_context *ssl_client, bool att) {
   }
 }
 
+#if MBEDTLS_VERSION_MAJOR < 4
+// Shared configurations are used by several connections at once, so they draw
+// from the hardware RNG instead of a per-config (and non thread-safe) CTR_DRBG.
+static int ssl_hw_random(void *ctx, unsigned char *output, size_t len) {
+  esp_fill_random(output, len);
+  return 0;
+}
+#endif
+
+static int ssl_conf_set_ca(
+  mbedtls_ssl_config *conf, mbedtls_x509_crt *ca_cert, const char *rootCABuff, bool useRootCABundle, crt_bundle_attach_cb bundle_attach_cb, bool insecure
+) {
+  int ret;
+
+  // MBEDTLS_SSL_VERIFY_REQUIRED if a CA certificate is defined on Arduino IDE and
+  // MBEDTLS_SSL_VERIFY_NONE if not.
+
+  if (insecure) {
+    mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_NONE);
+    log_d("WARNING: Skipping SSL Verification. INSECURE!");
+  } else if (rootCABuff != NULL) {
+    log_v("Loading CA cert");
+    mbedtls_x509_crt_init(ca_cert);
+    mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    ret = mbedtls_x509_crt_parse(ca_cert, (const unsigned char *)rootCABuff, strlen(rootCABuff) + 1);
+    mbedtls_ssl_conf_ca_chain(conf, ca_cert, NULL);
+    //mbedtls_ssl_conf_verify(&ssl_client->ssl_ctx, my_verify, NULL );
+    if (ret < 0) {
+      // free the ca_cert in the case parse failed, otherwise, the old ca_cert still in the heap memory, that lead to "out of memory" crash.
+      mbedtls_x509_crt_free(ca_cert);
+      return handle_error(ret);
+    }
+  } else if (useRootCABundle) {
+    if (bundle_attach_cb != NULL) {
+      log_v("Attaching root CA cert bundle");
+      ret = bundle_attach_cb(conf);
+      if (ret < 0) {
+        return handle_error(ret);
+      }
+    } else {
+      log_e("useRootCABundle is set, but attach_ssl_certificate_bundle(ssl, true); was not called!");
+    }
+  }
+  return 0;
+}
+
+static int ssl_conf_set_own_cert(
+  mbedtls_ssl_config *conf, mbedtls_x509_crt *client_cert, mbedtls_pk_context *client_key, const char *cli_cert, const char *cli_key
+) {
+  int ret;
+
+  mbedtls_x509_crt_init(client_cert);
+  mbedtls_pk_init(client_key);
+
+  log_v("Loading CRT cert");
+
+  ret = mbedtls_x509_crt_parse(client_cert, (const unsigned char *)cli_cert, strlen(cli_cert) + 1);
+  if (ret < 0) {
+    // free the client_cert in the case parse failed, otherwise, the old client_cert still in the heap memory, that lead to "out of memory" crash.
+    mbedtls_x509_crt_free(client_cert);
+    return handle_error(ret);
+  }
+
+  log_v("Loading private key");
+#if MBEDTLS_VERSION_MAJOR >= 4
+  ret = mbedtls_pk_parse_key(client_key, (const unsigned char *)cli_key, strlen(cli_key) + 1, NULL, 0);
+#else
+  mbedtls_ctr_drbg_context ctr_drbg;
+  mbedtls_ctr_drbg_init(&ctr_drbg);
+  ret = mbedtls_pk_parse_key(client_key, (const unsigned char *)cli_key, strlen(cli_key) + 1, NULL, 0, mbedtls_ctr_drbg_random, &ctr_drbg);
+  mbedtls_ctr_drbg_free(&ctr_drbg);
+#endif
+
+  if (ret != 0) {
+    mbedtls_x509_crt_free(client_cert);  // cert+key are free'd in pair
+    return handle_error(ret);
+  }
+
+  return mbedtls_ssl_conf_own_cert(conf, client_cert, client_key);
+}
+
+static int ssl_conf_set_max_frag_len(mbedtls_ssl_config *conf, unsigned char mfl_code) {
+  if (mfl_code == 0) {
+    return 0;
+  }
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+  log_v("Requesting max fragment length code %u", mfl_code);
+  int ret = mbedtls_ssl_conf_max_frag_len(conf, mfl_code);
+  if (ret != 0) {
+    return handle_error(ret);
+  }
+#endif
+  return 0;
+}
+
+unsigned char ssl_max_fragment_length_code(uint16_t max_fragment_length) {
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+  switch (max_fragment_length) {
+    case 0:    return MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+    case 512:  return MBEDTLS_SSL_MAX_FRAG_LEN_512;
+    case 1024: return MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+    case 2048: return MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+    case 4096: return MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+    default:
+      log_w("Unsupported max fragment length %u (use 512, 1024, 2048 or 4096)", max_fragment_length);
+      return MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+  }
+#else
+  if (max_fragment_length != 0) {
+    log_w("Max fragment length extension is disabled in mbedTLS (CONFIG_MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)");
+  }
+  return 0;
+#endif
+}
+
+static int ssl_shared_config_setup(
+  sslclient_shared_config *shared_conf, const char *rootCABuff, bool useRootCABundle, crt_bundle_attach_cb bundle_attach_cb, const char *cli_cert,
+  const char *cli_key, bool insecure, const char **alpn_protos, unsigned char mfl_code
+) {
+  int ret;
+
+  if ((ret = mbedtls_ssl_config_defaults(&shared_conf->ssl_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
+    return handle_error(ret);
+  }
+
+  if (alpn_protos != NULL) {
+    log_v("Setting ALPN protocols");
+    if ((ret = mbedtls_ssl_conf_alpn_protocols(&shared_conf->ssl_conf, alpn_protos)) != 0) {
+      return handle_error(ret);
+    }
+  }
+
+  if ((ret = ssl_conf_set_ca(&shared_conf->ssl_conf, &shared_conf->ca_cert, rootCABuff, useRootCABundle, bundle_attach_cb, insecure)) != 0) {
+    return ret;
+  }
+
+  if (!insecure && cli_cert != NULL && cli_key != NULL) {
+    if ((ret = ssl_conf_set_own_cert(&shared_conf->ssl_conf, &shared_conf->client_cert, &shared_conf->client_key, cli_cert, cli_key)) != 0) {
+      return ret;
+    }
+  }
+
+  if ((ret = ssl_conf_set_max_frag_len(&shared_conf->ssl_conf, mfl_code)) != 0) {
+    return ret;
+  }
+
+#if MBEDTLS_VERSION_MAJOR < 4
+  mbedtls_ssl_conf_rng(&shared_conf->ssl_conf, ssl_hw_random, NULL);
+#endif
+  return 0;
+}
+
+int ssl_shared_config_init(
+  sslclient_shared_config *shared_conf, const char *rootCABuff, bool useRootCABundle, crt_bundle_attach_cb bundle_attach_cb, const char *cli_cert,
+  const char *cli_key, bool insecure, const char **alpn_protos, unsigned char mfl_code
+) {
+  if (rootCABuff == NULL && !insecure && !useRootCABundle) {
+    log_e("Shared TLS config needs a CA cert, the CA cert bundle or insecure mode");
+    return -1;
+  }
+
+  log_v("Free internal heap before shared TLS config %" PRIu32, ESP.getFreeHeap());
+  ssl_shared_config_free(shared_conf);
+  mbedtls_ssl_config_init(&shared_conf->ssl_conf);
+  mbedtls_x509_crt_init(&shared_conf->ca_cert);
+  mbedtls_x509_crt_init(&shared_conf->client_cert);
+  mbedtls_pk_init(&shared_conf->client_key);
+  shared_conf->mfl_code = mfl_code;
+
+  int ret = ssl_shared_config_setup(shared_conf, rootCABuff, useRootCABundle, bundle_attach_cb, cli_cert, cli_key, insecure, alpn_protos, mfl_code);
+  if (ret != 0) {
+    ssl_shared_config_free(shared_conf);
+    return ret;
+  }
+
+  shared_conf->initialized = true;
+  log_v("Free internal heap after shared TLS config %" PRIu32, ESP.getFreeHeap());
+  return 0;
+}
+
+void ssl_shared_config_free(sslclient_shared_config *shared_conf) {
+  mbedtls_x509_crt_free(&shared_conf->ca_cert);
+  mbedtls_x509_crt_free(&shared_conf->client_cert);
+  mbedtls_pk_free(&shared_conf->client_key);
+  mbedtls_ssl_config_free(&shared_conf->ssl_conf);
+
+  // reset embedded pointers to zero
+  memset(shared_conf, 0, sizeof(sslclient_shared_config));
+}
+
 int start_ssl_client(
   sslclient_context *ssl_client, const IPAddress &ip, uint32_t port, const char *hostname, int timeout, const char *rootCABuff, bool useRootCABundle,
   const char *cli_cert, const char *cli_key, const char *pskIdent, const char *psKey, bool insecure, const char **alpn_protos
+) {
+  int ret = start_ssl_client_async(
+    ssl_client, ip, port, hostname, timeout, rootCABuff, useRootCABundle, cli_cert, cli_key, pskIdent, psKey, insecure, alpn_protos
+  );
+  if (ret < 0) {
+    return ret;
+  }
+
+  int res = ssl_connect_poll(ssl_client, ssl_client->socket_timeout);
+  if (res == 0) {
+    log_i("select returned due to timeout %lu ms for fd %d", ssl_client->socket_timeout, ssl_client->socket);
+    lwip_close(ssl_client->socket);
+    ssl_client->socket = -1;
+  }
+  return res > 0 ? ssl_client->socket : -1;
+}
+
+/**
+ * start the TCP connection without waiting for it and prepare the TLS session.
+ * Call ssl_connect_poll() until the socket is connected, then ssl_handshake_poll().
+ * @return the socket, or < 0 on error
+ */
+int start_ssl_client_async(
+  sslclient_context *ssl_client, const IPAddress &ip, uint32_t port, const char *hostname, int timeout, const char *rootCABuff, bool useRootCABundle,
+  const char *cli_cert, const char *cli_key, const char *pskIdent, const char *psKey, bool insecure, const char **alpn_protos
 ) {
   int ret;
   int enable = 1;
-  log_v("Free internal heap before TLS %" PRIu32, ESP.getFreeHeap());
+  ssl_client->heap_before = ESP.getFreeHeap();
+  log_v("Free internal heap before TLS %" PRIu32, ssl_client->heap_before);
 
-  if (rootCABuff == NULL && pskIdent == NULL && psKey == NULL && !insecure && !useRootCABundle) {
+  if (ssl_client->shared_conf == NULL && rootCABuff == NULL && pskIdent == NULL && psKey == NULL && !insecure && !useRootCABundle) {
     return -1;
   }
 
@@ -115,10 +332,7 @@ int start_ssl_client(
 
   ssl_client->socket_timeout = timeout;
 
-  fd_set fdset;
   struct timeval tv;
-  FD_ZERO(&fdset);
-  FD_SET(ssl_client->socket, &fdset);
   tv.tv_sec = timeout / 1000;
   tv.tv_usec = (timeout % 1000) * 1000;
 
@@ -130,37 +344,6 @@ int start_ssl_client(
     return -1;
   }
 
-  res = select(ssl_client->socket + 1, nullptr, &fdset, nullptr, timeout < 0 ? nullptr : &tv);
-  if (res < 0) {
-    log_e("select on fd %d, errno: %d, \"%s\"", ssl_client->socket, errno, strerror(errno));
-    lwip_close(ssl_client->socket);
-    ssl_client->socket = -1;
-    return -1;
-  } else if (res == 0) {
-    log_i("select returned due to timeout %d ms for fd %d", timeout, ssl_client->socket);
-    lwip_close(ssl_client->socket);
-    ssl_client->socket = -1;
-    return -1;
-  } else {
-    int sockerr;
-    socklen_t len = (socklen_t)sizeof(int);
-    res = getsockopt(ssl_client->socket, SOL_SOCKET, SO_ERROR, &sockerr, &len);
-
-    if (res < 0) {
-      log_e("getsockopt on fd %d, errno: %d, \"%s\"", ssl_client->socket, errno, strerror(errno));
-      lwip_close(ssl_client->socket);
-      ssl_client->socket = -1;
-      return -1;
-    }
-
-    if (sockerr != 0) {
-      log_e("socket error on fd %d, errno: %d, \"%s\"", ssl_client->socket, sockerr, strerror(sockerr));
-      lwip_close(ssl_client->socket);
-      ssl_client->socket = -1;
-      return -1;
-    }
-  }
-
 #define ROE(x, msg)                                   \
   {                                                   \
     if (((x) < 0)) {                                  \
@@ -174,133 +357,103 @@ int start_ssl_client(
   ROE(lwip_setsockopt(ssl_client->socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable)), "TCP_NODELAY");
   ROE(lwip_setsockopt(ssl_client->socket, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable)), "SO_KEEPALIVE");
 
-#if MBEDTLS_VERSION_MAJOR < 4
-  log_v("Seeding the random number generator");
-  mbedtls_entropy_init(&ssl_client->entropy_ctx);
-
-  ret = mbedtls_ctr_drbg_seed(&ssl_client->drbg_ctx, mbedtls_entropy_func, &ssl_client->entropy_ctx, (const unsigned char *)pers, strlen(pers));
-  if (ret < 0) {
-    return handle_error(ret);
-  }
-#endif
-
-  log_v("Setting up the SSL/TLS structure...");
+  mbedtls_ssl_config *conf = &ssl_client->ssl_conf;
 
-  if ((ret = mbedtls_ssl_config_defaults(&ssl_client->ssl_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
-    return handle_error(ret);
-  }
+  if (ssl_client->shared_conf != NULL) {
+    if (!ssl_client->shared_conf->initialized) {
+      log_e("Shared TLS config was not initialized");
+      return -1;
+    }
+    log_v("Using shared SSL/TLS configuration");
+    conf = &ssl_client->shared_conf->ssl_conf;
+  } else {
+#if MBEDTLS_VERSION_MAJOR < 4
+    log_v("Seeding the random number generator");
+    mbedtls_entropy_init(&ssl_client->entropy_ctx);
 
-  if (alpn_protos != NULL) {
-    log_v("Setting ALPN protocols");
-    if ((ret = mbedtls_ssl_conf_alpn_protocols(&ssl_client->ssl_conf, alpn_protos)) != 0) {
+    ret = mbedtls_ctr_drbg_seed(&ssl_client->drbg_ctx, mbedtls_entropy_func, &ssl_client->entropy_ctx, (const unsigned char *)pers, strlen(pers));
+    if (ret < 0) {
       return handle_error(ret);
     }
-  }
+#endif
 
-  // MBEDTLS_SSL_VERIFY_REQUIRED if a CA certificate is defined on Arduino IDE and
-  // MBEDTLS_SSL_VERIFY_NONE if not.
+    log_v("Setting up the SSL/TLS structure...");
 
-  if (insecure) {
-    mbedtls_ssl_conf_authmode(&ssl_client->ssl_conf, MBEDTLS_SSL_VERIFY_NONE);
-    log_d("WARNING: Skipping SSL Verification. INSECURE!");
-  } else if (rootCABuff != NULL) {
-    log_v("Loading CA cert");
-    mbedtls_x509_crt_init(&ssl_client->ca_cert);
-    mbedtls_ssl_conf_authmode(&ssl_client->ssl_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
-    ret = mbedtls_x509_crt_parse(&ssl_client->ca_cert, (const unsigned char *)rootCABuff, strlen(rootCABuff) + 1);
-    mbedtls_ssl_conf_ca_chain(&ssl_client->ssl_conf, &ssl_client->ca_cert, NULL);
-    //mbedtls_ssl_conf_verify(&ssl_client->ssl_ctx, my_verify, NULL );
-    if (ret < 0) {
-      // free the ca_cert in the case parse failed, otherwise, the old ca_cert still in the heap memory, that lead to "out of memory" crash.
-      mbedtls_x509_crt_free(&ssl_client->ca_cert);
+    if ((ret = mbedtls_ssl_config_defaults(conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
       return handle_error(ret);
     }
-  } else if (useRootCABundle) {
-    if (ssl_client->bundle_attach_cb != NULL) {
-      log_v("Attaching root CA cert bundle");
-      ret = ssl_client->bundle_attach_cb(&ssl_client->ssl_conf);
-      if (ret < 0) {
+
+    if (alpn_protos != NULL) {
+      log_v("Setting ALPN protocols");
+      if ((ret = mbedtls_ssl_conf_alpn_protocols(conf, alpn_protos)) != 0) {
         return handle_error(ret);
       }
-    } else {
-      log_e("useRootCABundle is set, but attach_ssl_certificate_bundle(ssl, true); was not called!");
-    }
-  } else if (pskIdent != NULL && psKey != NULL) {
-    log_v("Setting up PSK");
-    // convert PSK from hex to binary
-    if ((strlen(psKey) & 1) != 0 || strlen(psKey) > 2 * MBEDTLS_PSK_MAX_LEN) {
-      log_e("pre-shared key not valid hex or too long");
-      return -1;
     }
-    unsigned char pskBytes[MBEDTLS_PSK_MAX_LEN];
-    size_t pskStrLen = strlen(psKey);
-    size_t pskByteLen = pskStrLen / 2;
-    for (int j = 0; j < pskStrLen; j += 2) {
-      char c = psKey[j];
-      if (c >= '0' && c <= '9') {
-        c -= '0';
-      } else if (c >= 'A' && c <= 'F') {
-        c -= 'A' - 10;
-      } else if (c >= 'a' && c <= 'f') {
-        c -= 'a' - 10;
-      } else {
-        return -1;
+
+    if (insecure || rootCABuff != NULL || useRootCABundle) {
+      if ((ret = ssl_conf_set_ca(conf, &ssl_client->ca_cert, rootCABuff, useRootCABundle, ssl_client->bundle_attach_cb, insecure)) != 0) {
+        return ret;
       }
-      pskBytes[j / 2] = c << 4;
-      c = psKey[j + 1];
-      if (c >= '0' && c <= '9') {
-        c -= '0';
-      } else if (c >= 'A' && c <= 'F') {
-        c -= 'A' - 10;
-      } else if (c >= 'a' && c <= 'f') {
-        c -= 'a' - 10;
-      } else {
+    } else if (pskIdent != NULL && psKey != NULL) {
+      log_v("Setting up PSK");
+      // convert PSK from hex to binary
+      if ((strlen(psKey) & 1) != 0 || strlen(psKey) > 2 * MBEDTLS_PSK_MAX_LEN) {
+        log_e("pre-shared key not valid hex or too long");
         return -1;
       }
-      pskBytes[j / 2] |= c;
-    }
-    // set mbedtls config
-    ret = mbedtls_ssl_conf_psk(&ssl_client->ssl_conf, pskBytes, pskByteLen, (const unsigned char *)pskIdent, strlen(pskIdent));
-    if (ret != 0) {
-      log_e("mbedtls_ssl_conf_psk returned %d", ret);
-      return handle_error(ret);
+      unsigned char pskBytes[MBEDTLS_PSK_MAX_LEN];
+      size_t pskStrLen = strlen(psKey);
+      size_t pskByteLen = pskStrLen / 2;
+      for (int j = 0; j < pskStrLen; j += 2) {
+        char c = psKey[j];
+        if (c >= '0' && c <= '9') {
+          c -= '0';
+        } else if (c >= 'A' && c <= 'F') {
+          c -= 'A' - 10;
+        } else if (c >= 'a' && c <= 'f') {
+          c -= 'a' - 10;
+        } else {
+          return -1;
+        }
+        pskBytes[j / 2] = c << 4;
+        c = psKey[j + 1];
+        if (c >= '0' && c <= '9') {
+          c -= '0';
+        } else if (c >= 'A' && c <= 'F') {
+          c -= 'A' - 10;
+        } else if (c >= 'a' && c <= 'f') {
+          c -= 'a' - 10;
+        } else {
+          return -1;
+        }
+        pskBytes[j / 2] |= c;
+      }
+      // set mbedtls config
+      ret = mbedtls_ssl_conf_psk(conf, pskBytes, pskByteLen, (const unsigned char *)pskIdent, strlen(pskIdent));
+      if (ret != 0) {
+        log_e("mbedtls_ssl_conf_psk returned %d", ret);
+        return handle_error(ret);
+      }
+    } else {
+      return -1;
     }
-  } else {
-    return -1;
-  }
-
-  // Note - this check for BOTH key and cert is relied on
-  // later during cleanup.
-
-  if (!insecure && cli_cert != NULL && cli_key != NULL) {
-    mbedtls_x509_crt_init(&ssl_client->client_cert);
-    mbedtls_pk_init(&ssl_client->client_key);
 
-    log_v("Loading CRT cert");
+    // Note - this check for BOTH key and cert is relied on
+    // later during cleanup.
 
-    ret = mbedtls_x509_crt_parse(&ssl_client->client_cert, (const unsigned char *)cli_cert, strlen(cli_cert) + 1);
-    if (ret < 0) {
-      // free the client_cert in the case parse failed, otherwise, the old client_cert still in the heap memory, that lead to "out of memory" crash.
-      mbedtls_x509_crt_free(&ssl_client->client_cert);
-      return handle_error(ret);
+    if (!insecure && cli_cert != NULL && cli_key != NULL) {
+      if ((ret = ssl_conf_set_own_cert(conf, &ssl_client->client_cert, &ssl_client->client_key, cli_cert, cli_key)) != 0) {
+        return ret;
+      }
     }
 
-    log_v("Loading private key");
-#if MBEDTLS_VERSION_MAJOR >= 4
-    ret = mbedtls_pk_parse_key(&ssl_client->client_key, (const unsigned char *)cli_key, strlen(cli_key) + 1, NULL, 0);
-#else
-    mbedtls_ctr_drbg_context ctr_drbg;
-    mbedtls_ctr_drbg_init(&ctr_drbg);
-    ret = mbedtls_pk_parse_key(&ssl_client->client_key, (const unsigned char *)cli_key, strlen(cli_key) + 1, NULL, 0, mbedtls_ctr_drbg_random, &ctr_drbg);
-    mbedtls_ctr_drbg_free(&ctr_drbg);
-#endif
-
-    if (ret != 0) {
-      mbedtls_x509_crt_free(&ssl_client->client_cert);  // cert+key are free'd in pair
-      return handle_error(ret);
+    if ((ret = ssl_conf_set_max_frag_len(conf, ssl_client->mfl_code)) != 0) {
+      return ret;
     }
 
-    mbedtls_ssl_conf_own_cert(&ssl_client->ssl_conf, &ssl_client->client_cert, &ssl_client->client_key);
+#if MBEDTLS_VERSION_MAJOR < 4
+    mbedtls_ssl_conf_rng(conf, mbedtls_ctr_drbg_random, &ssl_client->drbg_ctx);
+#endif
   }
 
   log_v("Setting hostname for TLS session...");
@@ -310,11 +463,7 @@ int start_ssl_client(
     return handle_error(ret);
   }
 
-#if MBEDTLS_VERSION_MAJOR < 4
-  mbedtls_ssl_conf_rng(&ssl_client->ssl_conf, mbedtls_ctr_drbg_random, &ssl_client->drbg_ctx);
-#endif
-
-  if ((ret = mbedtls_ssl_setup(&ssl_client->ssl_ctx, &ssl_client->ssl_conf)) != 0) {
+  if ((ret = mbedtls_ssl_setup(&ssl_client->ssl_ctx, conf)) != 0) {
     return handle_error(ret);
   }
 
@@ -322,22 +471,57 @@ int start_ssl_client(
   return ssl_client->socket;
 }
 
-int ssl_starttls_handshake(sslclient_context *ssl_client) {
-  char buf[512];
-  int ret, flags;
+/**
+ * check on the TCP connection started by start_ssl_client_async()
+ * @param timeout_ms  time to wait for it, 0 to only check
+ * @return 1 connected, 0 still in progress, -1 failed (the socket is closed)
+ */
+int ssl_connect_poll(sslclient_context *ssl_client, int timeout_ms) {
+  if (ssl_client->socket < 0) {
+    return -1;
+  }
 
-  log_v("Performing the SSL/TLS handshake...");
-  unsigned long handshake_start_time = millis();
-  while ((ret = mbedtls_ssl_handshake(&ssl_client->ssl_ctx)) != 0) {
-    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
-      return handle_error(ret);
-    }
-    if ((millis() - handshake_start_time) > ssl_client->handshake_timeout) {
-      return -1;
-    }
-    vTaskDelay(2);  //2 ticks
+  fd_set fdset;
+  struct timeval tv;
+  FD_ZERO(&fdset);
+  FD_SET(ssl_client->socket, &fdset);
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+  int res = select(ssl_client->socket + 1, nullptr, &fdset, nullptr, timeout_ms < 0 ? nullptr : &tv);
+  if (res < 0) {
+    log_e("select on fd %d, errno: %d, \"%s\"", ssl_client->socket, errno, strerror(errno));
+    lwip_close(ssl_client->socket);
+    ssl_client->socket = -1;
+    return -1;
+  } else if (res == 0) {
+    return 0;
   }
 
+  int sockerr;
+  socklen_t len = (socklen_t)sizeof(int);
+  res = getsockopt(ssl_client->socket, SOL_SOCKET, SO_ERROR, &sockerr, &len);
+
+  if (res < 0) {
+    log_e("getsockopt on fd %d, errno: %d, \"%s\"", ssl_client->socket, errno, strerror(errno));
+    lwip_close(ssl_client->socket);
+    ssl_client->socket = -1;
+    return -1;
+  }
+
+  if (sockerr != 0) {
+    log_e("socket error on fd %d, errno: %d, \"%s\"", ssl_client->socket, sockerr, strerror(sockerr));
+    lwip_close(ssl_client->socket);
+    ssl_client->socket = -1;
+    return -1;
+  }
+  return 1;
+}
+
+static int ssl_handshake_finish(sslclient_context *ssl_client) {
+  char buf[512];
+  int ret = 0, flags;
+
   if (ssl_client->client_cert.version) {
     log_d("Protocol is %s Ciphersuite is %s", mbedtls_ssl_get_version(&ssl_client->ssl_ctx), mbedtls_ssl_get_ciphersuite(&ssl_client->ssl_ctx));
     if ((ret = mbedtls_ssl_get_record_expansion(&ssl_client->ssl_ctx)) >= 0) {
@@ -371,11 +555,45 @@ int ssl_starttls_handshake(sslclient_context *ssl_client) {
     mbedtls_pk_free(&ssl_client->client_key);
   }
 
-  log_v("Free internal heap after TLS %" PRIu32, ESP.getFreeHeap());
+  // global free heap delta, includes what other tasks allocated during the handshake
+  uint32_t heap_after = ESP.getFreeHeap();
+  ssl_client->heap_used = ssl_client->heap_before > heap_after ? ssl_client->heap_before - heap_after : 0;
+  log_v("Free internal heap after TLS %" PRIu32 " (connection uses ~%" PRIu32 " bytes)", heap_after, ssl_client->heap_used);
 
   return ssl_client->socket;
 }
 
+int ssl_starttls_handshake(sslclient_context *ssl_client) {
+  int ret;
+
+  log_v("Performing the SSL/TLS handshake...");
+  unsigned long handshake_start_time = millis();
+  while ((ret = ssl_handshake_poll(ssl_client)) == 0) {
+    if ((millis() - handshake_start_time) > ssl_client->handshake_timeout) {
+      return -1;
+    }
+    vTaskDelay(2);  //2 ticks
+  }
+  return ret < 0 ? ret : ssl_client->socket;
+}
+
+/**
+ * run the TLS handshake as far as the received data allows, without waiting for the network.
+ * The cryptographic steps still take their time inside the call.
+ * @return 1 done and verified, 0 waiting for the peer, < 0 on error
+ */
+int ssl_handshake_poll(sslclient_context *ssl_client) {
+  int ret = mbedtls_ssl_handshake(&ssl_client->ssl_ctx);
+  if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+    return 0;
+  }
+  if (ret != 0) {
+    return handle_error(ret);
+  }
+  ret = ssl_handshake_finish(ssl_client);
+  return ret < 0 ? ret : 1;
+}
+
 void stop_ssl_socket(sslclient_context *ssl_client) {
   log_v("Cleaning SSL connection.");
 
@@ -398,12 +616,16 @@ void stop_ssl_socket(sslclient_context *ssl_client) {
   mbedtls_ctr_drbg_free(&ssl_client->drbg_ctx);
   mbedtls_entropy_free(&ssl_client->entropy_ctx);
 #endif
+  free(ssl_client->tx_buf);
 
   // save only interesting fields
   unsigned long handshake_timeout = ssl_client->handshake_timeout;
   unsigned long socket_timeout = ssl_client->socket_timeout;
   int last_err = ssl_client->last_error;
   crt_bundle_attach_cb bundle_attach_cb = ssl_client->bundle_attach_cb;
+  sslclient_shared_config *shared_conf = ssl_client->shared_conf;
+  unsigned char mfl_code = ssl_client->mfl_code;
+  uint32_t heap_used = ssl_client->heap_used;
 
   // reset embedded pointers to zero
   memset(ssl_client, 0, sizeof(sslclient_context));
@@ -412,7 +634,10 @@ void stop_ssl_socket(sslclient_context *ssl_client) {
   ssl_client->socket_timeout = socket_timeout;
   ssl_client->last_error = last_err;
   ssl_client->bundle_attach_cb = bundle_attach_cb;
-  ssl_client->peek_buf = -1;
+  ssl_client->shared_conf = shared_conf;
+  ssl_client->mfl_code = mfl_code;
+  ssl_client->heap_used = heap_used;
+  ssl_client->peek_len = 0;
 }
 
 int data_to_read(sslclient_context *ssl_client) {
@@ -16,8 +16,33 @@
 #include "mbedtls/ctr_drbg.h"
 #endif
 
+// Decrypted bytes that peek() can read ahead of read()
+#ifndef SSL_CLIENT_PEEK_SIZE
+#define SSL_CLIENT_PEEK_SIZE 128
+#endif
+
+// Plaintext staged by writev() and while corked, sent as one TLS record.
+// The default keeps a record with AES-GCM overhead inside one TCP segment.
+#ifndef SSL_CLIENT_TX_BUFFER_SIZE
+#define SSL_CLIENT_TX_BUFFER_SIZE 1400
+#endif
+
 typedef esp_err_t (*crt_bundle_attach_cb)(void *conf);
 
+// Pre-parsed TLS configuration that can be shared between several
+// connections. The CA chain, own certificate and mbedtls_ssl_config are
+// built once and only referenced by each sslclient_context using it.
+typedef struct sslclient_shared_config {
+  mbedtls_ssl_config ssl_conf;
+
+  mbedtls_x509_crt ca_cert;
+  mbedtls_x509_crt client_cert;
+  mbedtls_pk_context client_key;
+
+  unsigned char mfl_code;
+  bool initialized;
+} sslclient_shared_config;
+
 typedef struct sslclient_context {
   int socket;
   mbedtls_ssl_context ssl_ctx;
@@ -33,22 +58,43 @@ typedef struct sslclient_context {
   mbedtls_pk_context client_key;
 
   crt_bundle_attach_cb bundle_attach_cb;
+  sslclient_shared_config *shared_conf;
 
   unsigned long socket_timeout;
   unsigned long handshake_timeout;
 
   int last_error;
-  int peek_buf;
+  uint8_t peek_buf[SSL_CLIENT_PEEK_SIZE];
+  uint8_t peek_len;
+  uint8_t *tx_buf;  // allocated on first use, freed by stop_ssl_socket()
+  size_t tx_len;
+  bool tx_corked;
+
+  unsigned char mfl_code;
+  uint32_t heap_before;
+  uint32_t heap_used;
 
 } sslclient_context;
 
 void ssl_init(sslclient_context *ssl_client);
+int ssl_shared_config_init(
+  sslclient_shared_config *shared_conf, const char *rootCABuff, bool useRootCABundle, crt_bundle_attach_cb bundle_attach_cb, const char *cli_cert,
+  const char *cli_key, bool insecure, const char **alpn_protos, unsigned char mfl_code
+);
+void ssl_shared_config_free(sslclient_shared_config *shared_conf);
+unsigned char ssl_max_fragment_length_code(uint16_t max_fragment_length);
 int start_ssl_client(
   sslclient_context *ssl_client, const IPAddress &ip, uint32_t port, const char *hostname, int timeout, const char *rootCABuff, bool useRootCABundle,
   const char *cli_cert, const char *cli_key, const char *pskIdent, const char *psKey, bool insecure, const char **alpn_protos
 );
+int start_ssl_client_async(
+  sslclient_context *ssl_client, const IPAddress &ip, uint32_t port, const char *hostname, int timeout, const char *rootCABuff, bool useRootCABundle,
+  const char *cli_cert, const char *cli_key, const char *pskIdent, const char *psKey, bool insecure, const char **alpn_protos
+);
+int ssl_connect_poll(sslclient_context *ssl_client, int timeout_ms);
 void attach_ssl_certificate_bundle(sslclient_context *ssl_client, bool att);
 int ssl_starttls_handshake(sslclient_context *ssl_client);
+int ssl_handshake_poll(sslclient_context *ssl_client);
 void stop_ssl_socket(sslclient_context *ssl_client);
 int data_to_read(sslclient_context *ssl_client);
 int send_ssl_data(sslclient_context *ssl_client, const uint8_t *data, size_t len);
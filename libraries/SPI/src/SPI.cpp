@@ -36,7 +36,8 @@
 #endif
 
 SPIClass::SPIClass(uint8_t spi_bus)
-  : _spi_num(spi_bus), _spi(NULL), _use_hw_ss(false), _sck(-1), _miso(-1), _mosi(-1), _ss(-1), _div(0), _freq(1000000), _inTransaction(false)
+  : _spi_num(spi_bus), _spi(NULL), _use_hw_ss(false), _sck(-1), _miso(-1), _mosi(-1), _ss(-1), _div(0), _freq(1000000), _inTransaction(false),
+    _dmaActive(false), _dmaLocked(false)
 #if !CONFIG_DISABLE_HAL_LOCKS
     ,
     paramLock(NULL) {
@@ -135,6 +136,7 @@ void SPIClass::end() {
   if (!_spi) {
     return;
   }
+  endDMA();
   spiDetachSCK(_spi);
   spiDetachMISO(_spi);
   spiDetachMOSI(_spi);
@@ -146,6 +148,7 @@ void SPIClass::end() {
 }
 
 void SPIClass::setHwCs(bool use) {
+  finishDMA();
   if (_ss < 0) {
     return;
   }
@@ -166,6 +169,7 @@ void SPIClass::setSSInvert(bool invert) {
 }
 
 void SPIClass::setFrequency(uint32_t freq) {
+  finishDMA();
   SPI_PARAM_LOCK();
   //check if last freq changed
   uint32_t cdiv = spiGetClockDiv(_spi);
@@ -178,6 +182,7 @@ void SPIClass::setFrequency(uint32_t freq) {
 }
 
 void SPIClass::setClockDivider(uint32_t clockDiv) {
+  finishDMA();
   SPI_PARAM_LOCK();
   _div = clockDiv;
   spiSetClockDiv(_spi, _div);
@@ -189,14 +194,17 @@ uint32_t SPIClass::getClockDivider() {
 }
 
 void SPIClass::setDataMode(uint8_t dataMode) {
+  finishDMA();
   spiSetDataMode(_spi, dataMode);
 }
 
 void SPIClass::setBitOrder(uint8_t bitOrder) {
+  finishDMA();
   spiSetBitOrder(_spi, bitOrder);
 }
 
 void SPIClass::beginTransaction(SPISettings settings) {
+  finishDMA();
   SPI_PARAM_LOCK();
   //check if last freq changed
   uint32_t cdiv = spiGetClockDiv(_spi);
@@ -209,6 +217,7 @@ void SPIClass::beginTransaction(SPISettings settings) {
 }
 
 void SPIClass::endTransaction() {
+  finishDMA();
   if (_inTransaction) {
     _inTransaction = false;
     spiEndTransaction(_spi);
@@ -217,6 +226,7 @@ void SPIClass::endTransaction() {
 }
 
 void SPIClass::write(uint8_t data) {
+  finishDMA();
   if (_inTransaction) {
     return spiWriteByteNL(_spi, data);
   }
@@ -224,6 +234,7 @@ void SPIClass::write(uint8_t data) {
 }
 
 uint8_t SPIClass::transfer(uint8_t data) {
+  finishDMA();
   if (_inTransaction) {
     return spiTransferByteNL(_spi, data);
   }
@@ -231,6 +242,7 @@ uint8_t SPIClass::transfer(uint8_t data) {
 }
 
 void SPIClass::write16(uint16_t data) {
+  finishDMA();
   if (_inTransaction) {
     return spiWriteShortNL(_spi, data);
   }
@@ -238,6 +250,7 @@ void SPIClass::write16(uint16_t data) {
 }
 
 uint16_t SPIClass::transfer16(uint16_t data) {
+  finishDMA();
   if (_inTransaction) {
     return spiTransferShortNL(_spi, data);
   }
@@ -245,6 +258,7 @@ uint16_t SPIClass::transfer16(uint16_t data) {
 }
 
 void SPIClass::write32(uint32_t data) {
+  finishDMA();
   if (_inTransaction) {
     return spiWriteLongNL(_spi, data);
   }
@@ -252,6 +266,7 @@ void SPIClass::write32(uint32_t data) {
 }
 
 uint32_t SPIClass::transfer32(uint32_t data) {
+  finishDMA();
   if (_inTransaction) {
     return spiTransferLongNL(_spi, data);
   }
@@ -259,6 +274,7 @@ uint32_t SPIClass::transfer32(uint32_t data) {
 }
 
 void SPIClass::transferBits(uint32_t data, uint32_t *out, uint8_t bits) {
+  finishDMA();
   if (_inTransaction) {
     return spiTransferBitsNL(_spi, data, out, bits);
   }
@@ -270,6 +286,7 @@ void SPIClass::transferBits(uint32_t data, uint32_t *out, uint8_t bits) {
  * @param size uint32_t
  */
 void SPIClass::writeBytes(const uint8_t *data, uint32_t size) {
+  finishDMA();
   if (_inTransaction) {
     return spiWriteNL(_spi, data, size);
   }
@@ -287,6 +304,7 @@ void SPIClass::transfer(void *data, uint32_t size) {
  * @param size uint32_t
  */
 void SPIClass::writePixels(const void *data, uint32_t size) {
+  finishDMA();
   if (_inTransaction) {
     return spiWritePixelsNL(_spi, data, size);
   }
@@ -301,6 +319,7 @@ void SPIClass::writePixels(const void *data, uint32_t size) {
  * @param size uint32_t
  */
 void SPIClass::transferBytes(const uint8_t *data, uint8_t *out, uint32_t size) {
+  finishDMA();
   if (_inTransaction) {
     return spiTransferBytesNL(_spi, data, out, size);
   }
@@ -351,6 +370,238 @@ void SPIClass::writePattern_(const uint8_t *data, uint8_t size, uint8_t repeat)
   writeBytes(&buffer[0], bytes);
 }
 
+bool SPIClass::beginDMA(uint32_t maxTransfer, uint8_t queueSize) {
+  if (!_spi) {
+    log_e("SPI bus not started");
+    return false;
+  }
+  return spiDmaBegin(_spi, maxTransfer, queueSize);
+}
+
+void SPIClass::endDMA() {
+  finishDMA();
+  spiDmaEnd(_spi);
+}
+
+/**
+ * @param data const void * data to send. can be NULL for Read Only operation
+ * @param out  void * receive buffer. can be NULL for Write Only operation
+ * @param size uint32_t
+ * @param cb   spi_dma_cb_t called from the SPI interrupt when the transfer has finished
+ * @param arg  void * passed to cb
+ */
+bool SPIClass::queueDMA(const void *data, void *out, uint32_t size, bool pixels, spi_dma_cb_t cb, void *arg) {
+  if (!_spi) {
+    return false;
+  }
+  // outside of a transaction the bus stays locked until waitDMA()
+  if (!_inTransaction && !_dmaLocked) {
+    spiSimpleTransaction(_spi);
+    _dmaLocked = true;
+  }
+  bool queued = pixels ? spiDmaQueuePixels(_spi, data, size, cb, arg) : spiDmaQueue(_spi, data, out, size, cb, arg);
+  if (!queued) {
+    // collect what was queued before and give the bus back
+    spiDmaWait(_spi, SPI_DMA_WAIT_FOREVER);
+    _dmaActive = false;
+    if (_dmaLocked) {
+      _dmaLocked = false;
+      spiEndTransaction(_spi);
+    }
+    return false;
+  }
+  _dmaActive = true;
+  return true;
+}
+
+bool SPIClass::queueTransfer(const void *data, void *out, uint32_t size, spi_dma_cb_t cb, void *arg) {
+  return queueDMA(data, out, size, false, cb, arg);
+}
+
+/**
+ * @param data const void * RGB565 pixels, left unchanged
+ * @param size uint32_t in bytes
+ */
+bool SPIClass::queuePixels(const void *data, uint32_t size, spi_dma_cb_t cb, void *arg) {
+  return queueDMA(data, NULL, size, true, cb, arg);
+}
+
+bool SPIClass::waitDMA(uint32_t timeout_ms) {
+  if (!_dmaActive) {
+    return true;
+  }
+  if (!spiDmaWait(_spi, timeout_ms)) {
+    return false;
+  }
+  _dmaActive = false;
+  if (_dmaLocked) {
+    _dmaLocked = false;
+    spiEndTransaction(_spi);
+  }
+  return true;
+}
+
+uint8_t SPIClass::pendingDMA() {
+  return spiDmaPending(_spi);
+}
+
+SPIDevice::SPIDevice(SPIClass &bus, int8_t cs, const SPISettings &settings, uint8_t priority)
+  : _bus(bus), _cs(cs), _settings(settings), _priority(priority), _dev(NULL), _inTransaction(false), _queued(0) {}
+
+SPIDevice::~SPIDevice() {
+  end();
+}
+
+bool SPIDevice::begin() {
+  if (_dev) {
+    return true;
+  }
+  if (!_bus.bus()) {
+    log_e("SPI bus not started");
+    return false;
+  }
+  _dev = spiDeviceAdd(_bus.bus(), _settings._clock, _settings._dataMode, _settings._bitOrder, _cs, _priority);
+  return _dev != NULL;
+}
+
+void SPIDevice::end() {
+  if (!_dev) {
+    return;
+  }
+  if (_queued) {
+    flush();
+  }
+  if (_inTransaction) {
+    endTransaction();
+  }
+  spiDeviceRemove(_dev);
+  _dev = NULL;
+}
+
+void SPIDevice::setFrequency(uint32_t freq) {
+  _settings._clock = freq;
+  spiDeviceSetFrequency(_dev, freq);
+}
+
+bool SPIDevice::beginTransaction(uint32_t timeout_ms) {
+  if (!_dev || _inTransaction) {
+    return _inTransaction;
+  }
+  if (!spiDeviceAcquire(_dev, timeout_ms)) {
+    return false;
+  }
+  spiDeviceSelect(_dev, true);
+  _inTransaction = true;
+  return true;
+}
+
+void SPIDevice::endTransaction() {
+  if (_inTransaction) {
+    _inTransaction = false;
+    spiDeviceRelease(_dev);
+  }
+}
+
+// single transfers outside of a transaction get one of their own
+bool SPIDevice::lock() {
+  return _inTransaction || beginTransaction();
+}
+
+void SPIDevice::unlock(bool locked) {
+  if (!locked) {
+    endTransaction();
+  }
+}
+
+uint8_t SPIDevice::transfer(uint8_t data) {
+  bool locked = _inTransaction;
+  if (!lock()) {
+    return 0;
+  }
+  data = spiTransferByteNL(_bus.bus(), data);
+  unlock(locked);
+  return data;
+}
+
+uint16_t SPIDevice::transfer16(uint16_t data) {
+  bool locked = _inTransaction;
+  if (!lock()) {
+    return 0;
+  }
+  data = spiTransferShortNL(_bus.bus(), data);
+  unlock(locked);
+  return data;
+}
+
+void SPIDevice::transfer(void *data, uint32_t size) {
+  transferBytes((const uint8_t *)data, (uint8_t *)data, size);
+}
+
+void SPIDevice::transferBytes(const uint8_t *data, uint8_t *out, uint32_t size) {
+  bool locked = _inTransaction;
+  if (!lock()) {
+    return;
+  }
+  spiTransferBytesNL(_bus.bus(), data, out, size);
+  unlock(locked);
+}
+
+void SPIDevice::write(uint8_t data) {
+  bool locked = _inTransaction;
+  if (!lock()) {
+    return;
+  }
+  spiWriteByteNL(_bus.bus(), data);
+  unlock(locked);
+}
+
+void SPIDevice::writeBytes(const uint8_t *data, uint32_t size) {
+  bool locked = _inTransaction;
+  if (!lock()) {
+    return;
+  }
+  spiWriteNL(_bus.bus(), data, size);
+  unlock(locked);
+}
+
+bool SPIDevice::queue(const void *data, void *out, uint32_t size, bool keepSelected) {
+  if (!_dev) {
+    return false;
+  }
+  if (_queued == SPI_DEVICE_QUEUE_SIZE && !flush()) {
+    return false;
+  }
+  spi_device_trans_t *t = &_queue[_queued++];
+  t->tx = data;
+  t->rx = out;
+  t->len = size;
+  t->flags = keepSelected ? SPI_DEVICE_KEEP_CS : 0;
+  return true;
+}
+
+/**
+ * @param timeout_ms uint32_t for getting the bus, nothing is sent and the queue is kept if it expires
+ */
+bool SPIDevice::flush(uint32_t timeout_ms) {
+  if (!_queued) {
+    return true;
+  }
+  if (_inTransaction) {
+    // already holding the bus and selected
+    for (uint8_t i = 0; i < _queued; i++) {
+      if (_queue[i].tx && !_queue[i].rx) {
+        spiWriteNL(_bus.bus(), _queue[i].tx, _queue[i].len);
+      } else {
+        spiTransferBytesNL(_bus.bus(), _queue[i].tx, (uint8_t *)_queue[i].rx, _queue[i].len);
+      }
+    }
+  } else if (!spiDeviceTransfer(_dev, _queue, _queued, timeout_ms)) {
+    return false;
+  }
+  _queued = 0;
+  return true;
+}
+
 #if CONFIG_IDF_TARGET_ESP32
 SPIClass SPI(VSPI);
 #else
@@ -53,10 +53,18 @@ private:
   uint32_t _div;
   uint32_t _freq;
   bool _inTransaction;
+  bool _dmaActive;  // DMA transfers queued since the last waitDMA()
+  bool _dmaLocked;  // the bus was locked for them outside of a transaction
 #if !CONFIG_DISABLE_HAL_LOCKS
   SemaphoreHandle_t paramLock = NULL;
 #endif
   void writePattern_(const uint8_t *data, uint8_t size, uint8_t repeat);
+  bool queueDMA(const void *data, void *out, uint32_t size, bool pixels, spi_dma_cb_t cb, void *arg);
+  void finishDMA() {
+    if (_dmaActive) {
+      waitDMA();
+    }
+  }
 
 public:
   SPIClass(uint8_t spi_bus = HSPI);
@@ -90,6 +98,34 @@ public:
   void writePixels(const void *data, uint32_t size);  //ili9341 compatible
   void writePattern(const uint8_t *data, uint8_t size, uint32_t repeat);
 
+  /*
+   * Asynchronous DMA transfers. The queue functions return as soon as the transfer is queued;
+   * with queueSize 2 one buffer can be filled while the other one is sent. Buffers must stay
+   * valid until the callback ran or waitDMA() returned, and are best allocated with allocDMA().
+   * Chip select is not driven by these transfers. The other transfer functions wait for
+   * the queued transfers first.
+   */
+  bool beginDMA(uint32_t maxTransfer = SPI_DMA_MAX_TRANSFER, uint8_t queueSize = 2);
+  void endDMA();
+  // cb is called from the SPI interrupt when the whole buffer was sent
+  bool queueTransfer(const void *data, void *out, uint32_t size, spi_dma_cb_t cb = NULL, void *arg = NULL);
+  bool queueBytes(const uint8_t *data, uint32_t size, spi_dma_cb_t cb = NULL, void *arg = NULL) {
+    return queueTransfer(data, NULL, size, cb, arg);
+  }
+  // 16 bit pixels like writePixels(), the buffer is left unchanged. MSB first they are converted to wire
+  // byte order in buffers of the driver (SPI_DMA_PIXEL_CHUNK per queue slot), then the buffer can be
+  // reused once this returned
+  bool queuePixels(const void *data, uint32_t size, spi_dma_cb_t cb = NULL, void *arg = NULL);
+  bool waitDMA(uint32_t timeout_ms = SPI_DMA_WAIT_FOREVER);
+  // number of queued transfers that have not finished yet
+  uint8_t pendingDMA();
+  static void *allocDMA(size_t size) {
+    return spiDmaAlloc(size);
+  }
+  static void freeDMA(void *buffer) {
+    spiDmaFree(buffer);
+  }
+
   spi_t *bus() {
     return _spi;
   }
@@ -98,6 +134,60 @@ public:
   }
 };
 
+#ifndef SPI_DEVICE_QUEUE_SIZE
+#define SPI_DEVICE_QUEUE_SIZE 8  // transfers collected by SPIDevice::queue() before they are flushed
+#endif
+
+/*
+ * A device sharing the bus of an SPIClass with others. The settings are converted once and only
+ * written to the peripheral when another device used the bus in between. Devices waiting for the
+ * bus get it by priority (higher first), and a long flush() steps aside between its transfers
+ * for a device with a higher priority. Chip select is driven by the device if cs is set.
+ */
+class SPIDevice {
+private:
+  SPIClass &_bus;
+  int8_t _cs;
+  SPISettings _settings;
+  uint8_t _priority;
+  spi_bus_device_t *_dev;
+  bool _inTransaction;
+  uint8_t _queued;
+  spi_device_trans_t _queue[SPI_DEVICE_QUEUE_SIZE];
+
+  bool lock();
+  void unlock(bool locked);
+
+public:
+  SPIDevice(SPIClass &bus, int8_t cs, const SPISettings &settings, uint8_t priority = 0);
+  ~SPIDevice();
+  // call after begin() of the bus
+  bool begin();
+  void end();
+  void setFrequency(uint32_t freq);
+
+  // acquire the bus and select the device; the transfer functions do this on their own when called outside
+  bool beginTransaction(uint32_t timeout_ms = SPI_DEVICE_WAIT_FOREVER);
+  void endTransaction();
+  uint8_t transfer(uint8_t data);
+  uint16_t transfer16(uint16_t data);
+  void transfer(void *data, uint32_t size);
+  void transferBytes(const uint8_t *data, uint8_t *out, uint32_t size);
+  void write(uint8_t data);
+  void writeBytes(const uint8_t *data, uint32_t size);
+
+  /*
+   * Collect transfers and send them back to back under one bus acquisition with flush().
+   * keepSelected holds chip select for the next entry, e.g. for a command followed by its data.
+   * Buffers must stay valid until flush() returned; a full queue is flushed first.
+   */
+  bool queue(const void *data, void *out, uint32_t size, bool keepSelected = false);
+  bool flush(uint32_t timeout_ms = SPI_DEVICE_WAIT_FOREVER);
+  uint8_t queued() const {
+    return _queued;
+  }
+};
+
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_SPI)
 extern SPIClass SPI;
 #endif
@@ -0,0 +1,48 @@
+/*
+  Many Tickers on the timer wheel
+
+  By default each Ticker creates its own esp_timer. Tickers constructed with
+  TICKER_WHEEL share a single timer wheel instead: scheduling and detaching
+  cost the same no matter how many Tickers are running, and callbacks due in
+  the same wheel tick (1 ms by default) are run together.
+
+  This sample runs 200 periodic Tickers with different periods and prints
+  how many callbacks ran and how late they started.
+*/
+
+#include <Arduino.h>
+#include <Ticker.h>
+
+#define NUM_TICKERS 200
+
+Ticker *tickers[NUM_TICKERS];
+volatile uint32_t counts[NUM_TICKERS];
+
+void tick(int index) {
+  counts[index] = counts[index] + 1;
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  for (int i = 0; i < NUM_TICKERS; i++) {
+    tickers[i] = new Ticker(TICKER_WHEEL);
+    // periods from 10 ms to 2 s
+    tickers[i]->attach_ms(10 + i * 10, tick, i);
+  }
+}
+
+void loop() {
+  delay(5000);
+
+  ticker_wheel_stats_t stats;
+  Ticker::wheelStats(TICKER_WHEEL, &stats, true);
+  Serial.printf(
+    "%lu callbacks in %lu wakeups, late by %lu us on average, %lu us at most\n", (unsigned long)stats.callbacks, (unsigned long)stats.wakeups,
+    (unsigned long)stats.avg_late_us, (unsigned long)stats.max_late_us
+  );
+  Serial.printf(
+    "Ticker 0 (10 ms) ran %lu times, ticker %d (%d ms) ran %lu times\n", (unsigned long)counts[0], NUM_TICKERS - 1, NUM_TICKERS * 10,
+    (unsigned long)counts[NUM_TICKERS - 1]
+  );
+}
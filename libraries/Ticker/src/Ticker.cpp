@@ -24,13 +24,34 @@
 
 #include "Ticker.h"
 
-Ticker::Ticker() : _timer(nullptr) {}
+static TickerWheel *_wheel(ticker_mode_t mode) {
+  if (mode == TICKER_ESP_TIMER) {
+    return nullptr;
+  }
+  return TickerWheel::get(mode != TICKER_WHEEL);
+}
+
+Ticker::Ticker() : _timer(nullptr), _mode(TICKER_ESP_TIMER), _entry() {}
+
+Ticker::Ticker(ticker_mode_t mode) : _timer(nullptr), _mode(mode), _entry() {}
 
 Ticker::~Ticker() {
   detach();
 }
 
 void Ticker::_attach_us(uint64_t micros, bool repeat, callback_with_arg_t callback, void *arg) {
+  if (_mode != TICKER_ESP_TIMER) {
+    TickerWheel *wheel = _wheel(_mode);
+    if (wheel) {
+      if (repeat && micros < TICKER_WHEEL_RESOLUTION_US) {
+        micros = TICKER_WHEEL_RESOLUTION_US;
+      }
+      _entry.callback = callback;
+      _entry.arg = arg;
+      wheel->add(&_entry, micros, repeat ? micros : 0);
+    }
+    return;
+  }
   esp_timer_create_args_t _timerConfig;
   _timerConfig.arg = reinterpret_cast<void *>(arg);
   _timerConfig.callback = callback;
@@ -49,6 +70,13 @@ void Ticker::_attach_us(uint64_t micros, bool repeat, callback_with_arg_t callba
 }
 
 void Ticker::detach() {
+  if (_mode != TICKER_ESP_TIMER) {
+    TickerWheel *wheel = _wheel(_mode);
+    if (wheel && wheel->remove(&_entry)) {
+      _callback_function = nullptr;
+    }
+    return;
+  }
   if (_timer) {
     esp_timer_stop(_timer);
     esp_timer_delete(_timer);
@@ -58,6 +86,10 @@ void Ticker::detach() {
 }
 
 bool Ticker::active() const {
+  if (_mode != TICKER_ESP_TIMER) {
+    TickerWheel *wheel = _wheel(_mode);
+    return wheel && wheel->scheduled(&_entry);
+  }
   if (!_timer) {
     return false;
   }
@@ -72,19 +104,33 @@ void Ticker::_static_callback(void *arg) {
 }
 
 void Ticker::restart(float seconds) {
-  if (active()) {
-    esp_timer_restart(_timer, 1000000ULL * seconds);
-  }
+  restart_us(1000000ULL * seconds);
 }
 
 void Ticker::restart_ms(uint64_t milliseconds) {
-  if (active()) {
-    esp_timer_restart(_timer, 1000ULL * milliseconds);
-  }
+  restart_us(1000ULL * milliseconds);
 }
 
 void Ticker::restart_us(uint64_t micros) {
-  if (active()) {
-    esp_timer_restart(_timer, micros);
+  if (!active()) {
+    return;
+  }
+  if (_mode != TICKER_ESP_TIMER) {
+    bool repeat = _entry.period_us != 0;
+    if (repeat && micros < TICKER_WHEEL_RESOLUTION_US) {
+      micros = TICKER_WHEEL_RESOLUTION_US;
+    }
+    _wheel(_mode)->add(&_entry, micros, repeat ? micros : 0);
+    return;
+  }
+  esp_timer_restart(_timer, micros);
+}
+
+bool Ticker::wheelStats(ticker_mode_t mode, ticker_wheel_stats_t *stats, bool reset) {
+  TickerWheel *wheel = _wheel(mode);
+  if (wheel == nullptr || stats == nullptr) {
+    return false;
   }
+  wheel->stats(stats, reset);
+  return true;
 }
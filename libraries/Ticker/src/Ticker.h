@@ -29,10 +29,22 @@ extern "C" {
 #include "esp_timer.h"
 }
 #include <functional>
+#include "TickerWheel.h"
+
+typedef enum {
+  TICKER_ESP_TIMER,  // own esp_timer per Ticker
+  TICKER_WHEEL,      // shared timer wheel, callbacks run in the esp_timer task
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+  TICKER_WHEEL_ISR,  // shared timer wheel, callbacks run in the esp_timer interrupt and must be short
+#endif
+} ticker_mode_t;
 
 class Ticker {
 public:
   Ticker();
+  // Tickers of a wheel mode share one esp_timer, which suits many Tickers at little cost per Ticker.
+  // Their due times are rounded up to TICKER_WHEEL_RESOLUTION_US and periods are at least that long.
+  explicit Ticker(ticker_mode_t mode);
   ~Ticker();
 
   typedef void (*callback_with_arg_t)(void *);
@@ -133,12 +145,17 @@ public:
   void detach();
   bool active() const;
 
+  // callback timing of all Tickers of a wheel mode, false if the wheel is not available
+  static bool wheelStats(ticker_mode_t mode, ticker_wheel_stats_t *stats, bool reset = false);
+
 protected:
   static void _static_callback(void *arg);
 
   callback_function_t _callback_function = nullptr;
 
   esp_timer_handle_t _timer;
+  ticker_mode_t _mode;
+  TickerWheel::Entry _entry;
 
 private:
   void _attach_us(uint64_t micros, bool repeat, callback_with_arg_t callback, void *arg);
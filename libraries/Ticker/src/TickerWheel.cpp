@@ -0,0 +1,317 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "TickerWheel.h"
+#include <new>
+#include "esp32-hal.h"
+
+static inline uint64_t ror64(uint64_t value, unsigned shift) {
+  shift &= 63;
+  return shift ? (value >> shift) | (value << (64 - shift)) : value;
+}
+
+static inline void list_init(TickerWheel::Link *head) {
+  head->prev = head;
+  head->next = head;
+}
+
+static inline bool list_empty(const TickerWheel::Link *head) {
+  return head->next == head;
+}
+
+// move all nodes of <from> to the empty list <to>
+static inline void list_move(TickerWheel::Link *from, TickerWheel::Link *to) {
+  if (list_empty(from)) {
+    list_init(to);
+    return;
+  }
+  to->next = from->next;
+  to->prev = from->prev;
+  to->next->prev = to;
+  to->prev->next = to;
+  list_init(from);
+}
+
+TickerWheel *TickerWheel::get(bool isr) {
+  static TickerWheel *wheels[2] = {nullptr, nullptr};
+#if !CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+  if (isr) {
+    return nullptr;
+  }
+#endif
+  TickerWheel *wheel = __atomic_load_n(&wheels[isr], __ATOMIC_ACQUIRE);
+  if (wheel != nullptr) {
+    return wheel;
+  }
+  wheel = new (std::nothrow) TickerWheel(isr);
+  if (wheel == nullptr || wheel->_timer == nullptr) {
+    log_e("Ticker wheel could not be created");
+    delete wheel;
+    return nullptr;
+  }
+  // another task may have created it meanwhile
+  TickerWheel *expected = nullptr;
+  if (!__atomic_compare_exchange_n(&wheels[isr], &expected, wheel, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    delete wheel;
+    return expected;
+  }
+  return wheel;
+}
+
+TickerWheel::TickerWheel(bool isr)
+  : _occupied{0}, _current((uint64_t)esp_timer_get_time() / TICKER_WHEEL_RESOLUTION_US), _armed_tick(UINT64_MAX), _count(0), _timer(nullptr),
+    _callbacks(0), _wakeups(0), _max_late_us(0), _sum_late_us(0) {
+  portMUX_INITIALIZE(&_lock);
+  for (unsigned level = 0; level < LEVELS; level++) {
+    for (unsigned index = 0; index < SLOTS; index++) {
+      list_init(&_slots[level][index]);
+    }
+  }
+  esp_timer_create_args_t config = {};
+  config.callback = _on_timer;
+  config.arg = this;
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+  config.dispatch_method = isr ? ESP_TIMER_ISR : ESP_TIMER_TASK;
+#else
+  config.dispatch_method = ESP_TIMER_TASK;
+#endif
+  config.name = "TickerWheel";
+  if (esp_timer_create(&config, &_timer) != ESP_OK) {
+    _timer = nullptr;
+  }
+}
+
+TickerWheel::~TickerWheel() {
+  if (_timer) {
+    esp_timer_stop(_timer);
+    esp_timer_delete(_timer);
+  }
+}
+
+void ARDUINO_ISR_ATTR TickerWheel::_unlink(Entry *entry) {
+  entry->prev->next = entry->next;
+  entry->next->prev = entry->prev;
+  if (entry->slot != NO_SLOT) {
+    unsigned level = entry->slot / SLOTS, index = entry->slot % SLOTS;
+    if (list_empty(&_slots[level][index])) {
+      _occupied[level] &= ~(1ULL << index);
+    }
+  }
+  entry->prev = nullptr;
+  entry->next = nullptr;
+}
+
+void ARDUINO_ISR_ATTR TickerWheel::_insert(Entry *entry) {
+  if (entry->tick < _current) {
+    entry->tick = _current;
+  }
+  uint64_t delta = entry->tick - _current;
+  uint64_t slot_tick = entry->tick;
+  unsigned level = 0;
+  while (level < LEVELS - 1 && delta >= (1ULL << ((level + 1) * SLOT_BITS))) {
+    level++;
+  }
+  // beyond the last level, parked in its farthest slot until it gets closer
+  if (delta >= (1ULL << (LEVELS * SLOT_BITS))) {
+    slot_tick = _current + (1ULL << (LEVELS * SLOT_BITS)) - 1;
+  }
+  unsigned index = (slot_tick >> (level * SLOT_BITS)) & (SLOTS - 1);
+
+  Link *head = &_slots[level][index];
+  entry->next = head;
+  entry->prev = head->prev;
+  head->prev->next = entry;
+  head->prev = entry;
+  entry->slot = level * SLOTS + index;
+  _occupied[level] |= 1ULL << index;
+}
+
+void ARDUINO_ISR_ATTR TickerWheel::_cascade(unsigned level, uint32_t index) {
+  Link list;
+  list_move(&_slots[level][index], &list);
+  _occupied[level] &= ~(1ULL << index);
+  while (!list_empty(&list)) {
+    Entry *entry = static_cast<Entry *>(list.next);
+    entry->slot = NO_SLOT;
+    _unlink(entry);
+    _insert(entry);
+  }
+}
+
+uint64_t ARDUINO_ISR_ATTR TickerWheel::_next_tick() const {
+  uint64_t next = UINT64_MAX;
+  if (_occupied[0]) {
+    next = _current + __builtin_ctzll(ror64(_occupied[0], _current & (SLOTS - 1)));
+  }
+  // upper levels wake the wheel when their next occupied slot is due to cascade
+  for (unsigned level = 1; level < LEVELS; level++) {
+    if (!_occupied[level]) {
+      continue;
+    }
+    unsigned shift = level * SLOT_BITS;
+    uint64_t block = _current >> shift;
+    unsigned index = block & (SLOTS - 1);
+    uint64_t tick;
+    if ((_current & ((1ULL << shift) - 1)) == 0 && (_occupied[level] & (1ULL << index))) {
+      tick = _current;
+    } else {
+      tick = (block + 1 + __builtin_ctzll(ror64(_occupied[level], index + 1))) << shift;
+    }
+    if (tick < next) {
+      next = tick;
+    }
+  }
+  return next;
+}
+
+void ARDUINO_ISR_ATTR TickerWheel::_arm() {
+  uint64_t next = _count ? _next_tick() : UINT64_MAX;
+  if (next == _armed_tick) {
+    return;
+  }
+  if (_armed_tick != UINT64_MAX) {
+    esp_timer_stop(_timer);
+  }
+  _armed_tick = next;
+  if (next == UINT64_MAX) {
+    return;
+  }
+  uint64_t now = esp_timer_get_time();
+  uint64_t target = next * TICKER_WHEEL_RESOLUTION_US;
+  esp_timer_start_once(_timer, target > now ? target - now : 0);
+}
+
+void ARDUINO_ISR_ATTR TickerWheel::_on_timer(void *arg) {
+  static_cast<TickerWheel *>(arg)->_run();
+}
+
+void ARDUINO_ISR_ATTR TickerWheel::_run() {
+  portENTER_CRITICAL_SAFE(&_lock);
+  _armed_tick = UINT64_MAX;
+  _wakeups++;
+  uint64_t now_tick = (uint64_t)esp_timer_get_time() / TICKER_WHEEL_RESOLUTION_US;
+  while (_count && _current <= now_tick) {
+    // jump over the empty ticks, one slot per pass so the lock is not held for a long catch-up
+    uint64_t tick = _next_tick();
+    if (tick > now_tick) {
+      _current = now_tick + 1;
+      break;
+    }
+    _current = tick;
+    for (unsigned level = 1; level < LEVELS; level++) {
+      unsigned shift = level * SLOT_BITS;
+      if (tick & ((1ULL << shift) - 1)) {
+        break;
+      }
+      _cascade(level, (tick >> shift) & (SLOTS - 1));
+    }
+
+    // all callbacks of the tick are run in this wakeup
+    Link expired;
+    unsigned index = tick & (SLOTS - 1);
+    list_move(&_slots[0][index], &expired);
+    _occupied[0] &= ~(1ULL << index);
+    _current = tick + 1;
+
+    while (!list_empty(&expired)) {
+      Entry *entry = static_cast<Entry *>(expired.next);
+      entry->slot = NO_SLOT;
+      _unlink(entry);
+
+      uint64_t now = esp_timer_get_time();
+      uint32_t late = now > entry->due_us ? (uint32_t)(now - entry->due_us) : 0;
+      _callbacks++;
+      _sum_late_us += late;
+      if (late > _max_late_us) {
+        _max_late_us = late;
+      }
+
+      void (*callback)(void *) = entry->callback;
+      void *cb_arg = entry->arg;
+      if (entry->period_us) {
+        // from the due time, not from now, so that the period does not drift
+        entry->due_us += entry->period_us;
+        entry->tick = (entry->due_us + TICKER_WHEEL_RESOLUTION_US - 1) / TICKER_WHEEL_RESOLUTION_US;
+        _insert(entry);
+      } else {
+        _count--;
+      }
+
+      // the callback may add or remove entries, including its own
+      portEXIT_CRITICAL_SAFE(&_lock);
+      callback(cb_arg);
+      portENTER_CRITICAL_SAFE(&_lock);
+    }
+
+    // let other cores and interrupts in between slots
+    portEXIT_CRITICAL_SAFE(&_lock);
+    portENTER_CRITICAL_SAFE(&_lock);
+  }
+  if (_count == 0 && _current <= now_tick) {
+    _current = now_tick + 1;
+  }
+  _arm();
+  portEXIT_CRITICAL_SAFE(&_lock);
+}
+
+bool TickerWheel::add(Entry *entry, uint64_t delay_us, uint64_t period_us) {
+  if (entry->callback == nullptr) {
+    return false;
+  }
+  portENTER_CRITICAL_SAFE(&_lock);
+  uint64_t now = esp_timer_get_time();
+  if (entry->next != nullptr) {
+    _unlink(entry);
+  } else {
+    if (_count == 0 && _current <= now / TICKER_WHEEL_RESOLUTION_US) {
+      // nothing was scheduled, skip the idle ticks
+      _current = now / TICKER_WHEEL_RESOLUTION_US;
+    }
+    _count++;
+  }
+  entry->due_us = now + delay_us;
+  entry->period_us = period_us;
+  entry->tick = (entry->due_us + TICKER_WHEEL_RESOLUTION_US - 1) / TICKER_WHEEL_RESOLUTION_US;
+  _insert(entry);
+  _arm();
+  portEXIT_CRITICAL_SAFE(&_lock);
+  return true;
+}
+
+bool TickerWheel::remove(Entry *entry) {
+  portENTER_CRITICAL_SAFE(&_lock);
+  bool was_scheduled = entry->next != nullptr;
+  if (was_scheduled) {
+    _unlink(entry);
+    _count--;
+    _arm();
+  }
+  portEXIT_CRITICAL_SAFE(&_lock);
+  return was_scheduled;
+}
+
+void TickerWheel::stats(ticker_wheel_stats_t *stats, bool reset) {
+  portENTER_CRITICAL_SAFE(&_lock);
+  stats->callbacks = _callbacks;
+  stats->wakeups = _wakeups;
+  stats->max_late_us = _max_late_us;
+  stats->avg_late_us = _callbacks ? (uint32_t)(_sum_late_us / _callbacks) : 0;
+  if (reset) {
+    _callbacks = 0;
+    _wakeups = 0;
+    _max_late_us = 0;
+    _sum_late_us = 0;
+  }
+  portEXIT_CRITICAL_SAFE(&_lock);
+}
@@ -0,0 +1,104 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TICKER_WHEEL_H
+#define TICKER_WHEEL_H
+
+#include <stdint.h>
+#include "sdkconfig.h"
+extern "C" {
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+}
+
+// Tick of the timer wheel, due times are rounded up to it
+#ifndef TICKER_WHEEL_RESOLUTION_US
+#define TICKER_WHEEL_RESOLUTION_US 1000
+#endif
+
+typedef struct {
+  uint32_t callbacks;    // callbacks run
+  uint32_t wakeups;      // times the wheel timer fired, callbacks due in the same tick share one
+  uint32_t max_late_us;  // largest delay between the due time of a callback and its start
+  uint32_t avg_late_us;
+} ticker_wheel_stats_t;
+
+/*
+ * Hierarchical timer wheel driven by a single esp_timer, shared by all Tickers of one mode.
+ * 4 levels of 64 slots cover 2^24 ticks; longer delays are parked in the last level and
+ * re-inserted until they get close. Scheduling and cancelling are O(1), the esp_timer only fires
+ * for ticks with callbacks due or a slot of an upper level to cascade. Periodic due times
+ * advance by exactly one period, so they do not drift.
+ */
+class TickerWheel {
+public:
+  struct Link {
+    Link *prev;
+    Link *next;
+  };
+
+  // scheduled when next != nullptr
+  struct Entry : Link {
+    uint64_t due_us;
+    uint64_t period_us;  // 0 for a one-shot
+    uint64_t tick;
+    void (*callback)(void *);
+    void *arg;
+    uint16_t slot;
+  };
+
+  // the wheel running callbacks in the esp_timer task, or in its interrupt; created on first use
+  static TickerWheel *get(bool isr);
+
+  // (re)schedule entry->callback in delay_us, then every period_us if not 0
+  bool add(Entry *entry, uint64_t delay_us, uint64_t period_us);
+  // returns true if the entry was scheduled
+  bool remove(Entry *entry);
+  bool scheduled(const Entry *entry) const {
+    return entry->next != nullptr;
+  }
+  void stats(ticker_wheel_stats_t *stats, bool reset);
+
+private:
+  static constexpr unsigned LEVELS = 4;
+  static constexpr unsigned SLOT_BITS = 6;
+  static constexpr unsigned SLOTS = 1 << SLOT_BITS;
+  static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+  explicit TickerWheel(bool isr);
+  ~TickerWheel();
+
+  static void _on_timer(void *arg);
+  void _run();
+  void _insert(Entry *entry);
+  void _unlink(Entry *entry);
+  void _cascade(unsigned level, uint32_t index);
+  uint64_t _next_tick() const;
+  void _arm();
+
+  Link _slots[LEVELS][SLOTS];
+  uint64_t _occupied[LEVELS];
+  uint64_t _current;     // next tick to run
+  uint64_t _armed_tick;  // UINT64_MAX when the timer is not armed
+  uint32_t _count;       // scheduled entries
+  esp_timer_handle_t _timer;
+  portMUX_TYPE _lock;
+
+  uint32_t _callbacks;
+  uint32_t _wakeups;
+  uint32_t _max_late_us;
+  uint64_t _sum_late_us;
+};
+
+#endif  // TICKER_WHEEL_H
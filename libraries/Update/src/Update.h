@@ -11,6 +11,11 @@
 #include <MD5Builder.h>
 #include <functional>
 #include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "Updater_Package.h"
 #ifdef UPDATE_SIGN
 #include "Updater_Signing.h"
 #endif /* UPDATE_SIGN */
@@ -30,6 +35,8 @@
 #define UPDATE_ERROR_ABORT        (12)  ///< Update was aborted
 #define UPDATE_ERROR_DECRYPT      (13)  ///< Decryption failed
 #define UPDATE_ERROR_SIGN         (14)  ///< Signature verification failed
+#define UPDATE_ERROR_PACKAGE      (15)  ///< Compressed or delta package is corrupt or not supported
+#define UPDATE_ERROR_DELTA_BASE   (16)  ///< Running firmware is not the base of the delta package
 
 #define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF  ///< Constant indicating update size is unknown
 
@@ -50,6 +57,15 @@
 #define U_AES_DECRYPT_MODE_MASK    3  ///< Mask for decryption mode bits
 #define U_AES_IMAGE_DECRYPTING_BIT 4  ///< Bit flag indicating image is being decrypted
 
+#define UPDATE_MAX_WRITE_BUFFERS 8  ///< Maximum number of sector buffers, see UpdateClass::setWriteBuffers()
+
+#ifndef UPDATE_WRITER_TASK_STACK
+#define UPDATE_WRITER_TASK_STACK 4096  ///< Stack size of the background writer task
+#endif
+#ifndef UPDATE_WRITER_TASK_PRIORITY
+#define UPDATE_WRITER_TASK_PRIORITY 2  ///< Priority of the background writer task
+#endif
+
 #define SPI_SECTORS_PER_BLOCK 16  // usually large erase block is 32k/64k ///< Number of SPI sectors per erase block (platform dependent)
 #define SPI_FLASH_BLOCK_SIZE  (SPI_SECTORS_PER_BLOCK * SPI_FLASH_SEC_SIZE)  ///< Calculated SPI flash block size in bytes
 
@@ -86,6 +102,44 @@ public:
    */
   bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH, int ledPin = -1, uint8_t ledOn = LOW, const char *label = NULL);
 
+  /**
+   * @brief Set the number of sector buffers used while writing
+   *
+   * With more than one buffer, a background task hashes, decrypts, erases
+   * and writes each filled sector while `write()` / `writeStream()` keep
+   * filling the next one, so receiving and flash programming overlap.
+   * The producer only blocks when all buffers are waiting for flash, the
+   * progress callback reports bytes handed to the writer task and `end()`
+   * waits for the outstanding sectors. `abort()` also lets queued sectors
+   * finish. The default of 1 writes synchronously in the caller context.
+   *
+   * Must be called before `begin()`; the value is kept for later updates.
+   *
+   * @param count Number of `SPI_FLASH_SEC_SIZE` buffers (1 to `UPDATE_MAX_WRITE_BUFFERS`)
+   * @return true if the value was accepted
+   * @return false if an update is running or count is out of range
+   */
+  bool setWriteBuffers(uint8_t count);
+
+  /**
+   * @brief Number of sector buffers set with `setWriteBuffers()`
+   */
+  uint8_t writeBuffers() const {
+    return _writeBuffers;
+  }
+
+  /**
+   * @brief Time the producer spent waiting for the writer task
+   *
+   * Accumulated since `begin()`. A value close to the total update time
+   * means flash is the bottleneck, close to zero means the source is.
+   *
+   * @return Wait time in microseconds (always 0 with a single buffer)
+   */
+  uint32_t writeWaitTime() const {
+    return _pipeWaitTime;
+  }
+
 #ifndef UPDATE_NOCRYPT
   /**
    * @brief Configure decryption parameters for encrypted images
@@ -106,6 +160,12 @@ public:
    * Writes `len` bytes from `data` into the current update partition and
    * advances the internal write pointer.
    *
+   * If the data starts with a package header (see `tools/ota_package.py`),
+   * the gzip or heatshrink compressed payload is decompressed and delta
+   * patches are applied against the running firmware while writing. `size`,
+   * `progress()` and the MD5 given to `setMD5()` then refer to the package,
+   * not to the image written to flash.
+   *
    * @param data Pointer to data buffer
    * @param len Number of bytes to write
    * @return Number of bytes actually written
@@ -257,6 +317,10 @@ public:
   bool isFinished() {
     return _progress == _size;
   }
+  /// true while a compressed or delta package is being written
+  bool isPackage() {
+    return _package != nullptr;
+  }
   size_t size() {
     return _size;
   }
@@ -324,9 +388,23 @@ private:
   void _abort(uint8_t err);
 #ifndef UPDATE_NOCRYPT
   void _cryptKeyTweak(size_t cryptAddress, uint8_t *tweaked_key);
-  bool _decryptBuffer();
+  bool _decryptBuffer(uint8_t *data, size_t len, size_t pos);
 #endif /* UPDATE_NOCRYPT */
+  void _checkCrypt(const uint8_t *data);
   bool _writeBuffer();
+  uint8_t _processBuffer(uint8_t *data, size_t len, size_t pos);  // returns UPDATE_ERROR_*
+  bool _pipelineBegin();
+  void _pipelineEnd();
+  bool _pipelineDrain();
+  uint8_t _queueBuffer(uint8_t **data, size_t len, size_t pos);  // returns UPDATE_ERROR_*
+  bool _packageBegin();
+  bool _packageCheckBase(const esp_partition_t *base, const UpdaterPackageHeader &header);
+  bool _packageWrite();
+  bool _packageEnd();
+  bool _packageOutput(const uint8_t *data, size_t len);
+  bool _packageFlush();
+  uint8_t _packageErrorCode();
+  static void _pipelineTask(void *arg);
   bool _verifyHeader(uint8_t data);
   bool _verifyEnd();
   bool _enablePartition(const esp_partition_t *partition);
@@ -341,11 +419,35 @@ private:
   uint8_t *_skipBuffer;
   size_t _bufferLen;
   size_t _size;
+  size_t _imageSize;  // bytes written to the partition, differs from _size for packages
   THandlerFunction_Progress _progress_callback;
   uint32_t _progress;
   uint32_t _command;
   const esp_partition_t *_partition;
 
+  // background writer, only used with more than one write buffer
+  struct PipelineItem {
+    uint8_t *data;
+    size_t len;
+    size_t pos;
+  };
+  uint8_t _writeBuffers;
+  uint8_t *_pipeBuffers[UPDATE_MAX_WRITE_BUFFERS];
+  QueueHandle_t _pipeQueue;  // filled sectors, in image order
+  QueueHandle_t _pipeFree;   // buffers ready to be filled again
+  SemaphoreHandle_t _pipeDone;
+  TaskHandle_t _pipeTask;
+  volatile uint8_t _pipeError;
+  uint32_t _pipeWaitTime;
+
+  // compressed or delta package: _buffer collects package bytes, the decoded image is collected in _packageOut
+  UpdaterPackage *_package;
+  uint8_t *_packageIn;
+  uint8_t *_packageOut;
+  size_t _packageOutLen;
+  size_t _packageOutPos;
+  uint8_t _packageOutError;
+
   String _target_md5;
 #ifndef UPDATE_NOCRYPT
   bool _target_md5_decrypted = true;
@@ -9,6 +9,7 @@
 #include "spi_flash_mmap.h"
 #include "esp_ota_ops.h"
 #include "esp_image_format.h"
+#include "SHA2Builder.h"
 #ifndef UPDATE_NOCRYPT
 #include "mbedtls/build_info.h"
 #if MBEDTLS_VERSION_MAJOR >= 4
@@ -53,6 +54,10 @@ static const char *_err2str(uint8_t _error) {
   } else if (_error == UPDATE_ERROR_SIGN) {
     return ("Signature Verification Failed");
 #endif /* UPDATE_SIGN */
+  } else if (_error == UPDATE_ERROR_PACKAGE) {
+    return ("Bad Package");
+  } else if (_error == UPDATE_ERROR_DELTA_BASE) {
+    return ("Delta Base Mismatch");
   }
   return ("UNKNOWN");
 }
@@ -84,7 +89,9 @@ UpdateClass::UpdateClass()
 #ifndef UPDATE_NOCRYPT
     _cryptKey(0), _cryptBuffer(0),
 #endif /* UPDATE_NOCRYPT */
-    _buffer(0), _skipBuffer(0), _bufferLen(0), _size(0), _progress_callback(NULL), _progress(0), _command(U_FLASH), _partition(NULL)
+    _buffer(0), _skipBuffer(0), _bufferLen(0), _size(0), _imageSize(0), _progress_callback(NULL), _progress(0), _command(U_FLASH), _partition(NULL),
+    _writeBuffers(1), _pipeBuffers(), _pipeQueue(NULL), _pipeFree(NULL), _pipeDone(NULL), _pipeTask(NULL), _pipeError(UPDATE_ERROR_OK), _pipeWaitTime(0),
+    _package(NULL), _packageIn(NULL), _packageOut(NULL), _packageOutLen(0), _packageOutPos(0), _packageOutError(UPDATE_ERROR_OK)
 #ifndef UPDATE_NOCRYPT
     ,
     _cryptMode(U_AES_DECRYPT_AUTO), _cryptAddress(0), _cryptCfg(0xf)
@@ -102,6 +109,19 @@ UpdateClass &UpdateClass::onProgress(THandlerFunction_Progress fn) {
 }
 
 void UpdateClass::_reset() {
+  if (_package) {
+    //the output sector is the buffer allocated in begin(), release it with the others
+    _buffer = _packageOut;
+  }
+  //wait for the writer task before releasing anything it may still use
+  _pipelineEnd();
+  if (_package) {
+    delete _package;
+    delete[] _packageIn;
+    _package = nullptr;
+    _packageIn = nullptr;
+    _packageOut = nullptr;
+  }
   if (_buffer) {
     delete[] _buffer;
   }
@@ -128,6 +148,7 @@ void UpdateClass::_reset() {
   _bufferLen = 0;
   _progress = 0;
   _size = 0;
+  _imageSize = 0;
   _command = U_FLASH;
 
   if (_ledPin != -1) {
@@ -194,6 +215,7 @@ bool UpdateClass::begin(size_t size, int command, int ledPin, uint8_t ledOn, con
 
   _reset();
   _error = 0;
+  _pipeWaitTime = 0;
   _target_md5 = emptyString;
   _md5 = MD5Builder();
 
@@ -288,12 +310,21 @@ bool UpdateClass::begin(size_t size, int command, int ledPin, uint8_t ledOn, con
   }
 
   //initialize
-  _buffer = new (std::nothrow) uint8_t[SPI_FLASH_SEC_SIZE];
-  if (!_buffer) {
-    log_e("_buffer allocation failed");
-    return false;
+  if (_writeBuffers > 1) {
+    if (!_pipelineBegin()) {
+      _pipelineEnd();
+      return false;
+    }
+    log_d("Writing with %u buffers", _writeBuffers);
+  } else {
+    _buffer = new (std::nothrow) uint8_t[SPI_FLASH_SEC_SIZE];
+    if (!_buffer) {
+      log_e("_buffer allocation failed");
+      return false;
+    }
   }
   _size = size;
+  _imageSize = size;
   _command = command;
   _md5.begin();
   return true;
@@ -494,12 +525,12 @@ void UpdateClass::_cryptKeyTweak(size_t cryptAddress, uint8_t *tweaked_key) {
  * Reference: ESP-IDF flash encryption documentation
  * https://docs.espressif.com/projects/esp-idf/en/latest/esp32/security/flash-encryption.html
  */
-bool UpdateClass::_decryptBuffer() {
+bool UpdateClass::_decryptBuffer(uint8_t *data, size_t len, size_t pos) {
   if (!_cryptKey) {
     log_w("AES key not set");
     return false;
   }
-  if (_bufferLen % ENCRYPTED_BLOCK_SIZE != 0) {
+  if (len % ENCRYPTED_BLOCK_SIZE != 0) {
     log_e("buffer size error");
     return false;
   }
@@ -526,14 +557,14 @@ bool UpdateClass::_decryptBuffer() {
   size_t last_key_address = (size_t)-1;
   uint8_t ecb_out[ENCRYPTED_BLOCK_SIZE];
 
-  while ((_bufferLen - done) >= ENCRYPTED_BLOCK_SIZE) {
+  while ((len - done) >= ENCRYPTED_BLOCK_SIZE) {
     // Step 1: Reverse byte order of the 16-byte block
     for (int i = 0; i < ENCRYPTED_BLOCK_SIZE; i++) {
-      _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i] = _buffer[i + done];
+      _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i] = data[i + done];
     }
 
     // Update tweaked key every ENCRYPTED_TWEAK_BLOCK_SIZE (32) bytes or at start
-    size_t cur_address = _cryptAddress + _progress + done;
+    size_t cur_address = _cryptAddress + pos + done;
     size_t tweak_base = cur_address - (cur_address % ENCRYPTED_TWEAK_BLOCK_SIZE);
     if (tweak_base != last_key_address) {
       last_key_address = tweak_base;
@@ -562,7 +593,7 @@ bool UpdateClass::_decryptBuffer() {
 
     // Step 3: Reverse byte order back to get the decrypted plaintext
     for (int i = 0; i < ENCRYPTED_BLOCK_SIZE; i++) {
-      _buffer[i + done] = _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i];
+      data[i + done] = _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i];
     }
 
     done += ENCRYPTED_BLOCK_SIZE;
@@ -575,15 +606,15 @@ bool UpdateClass::_decryptBuffer() {
   mbedtls_aes_context ctx;
   mbedtls_aes_init(&ctx);
 
-  while ((_bufferLen - done) >= ENCRYPTED_BLOCK_SIZE) {
+  while ((len - done) >= ENCRYPTED_BLOCK_SIZE) {
     // Step 1: Reverse byte order of the 16-byte block
     for (int i = 0; i < ENCRYPTED_BLOCK_SIZE; i++) {
-      _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i] = _buffer[i + done];
+      _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i] = data[i + done];
     }
 
     // Update tweaked key every ENCRYPTED_TWEAK_BLOCK_SIZE (32) bytes or at start
-    if (((_cryptAddress + _progress + done) % ENCRYPTED_TWEAK_BLOCK_SIZE) == 0 || done == 0) {
-      _cryptKeyTweak(_cryptAddress + _progress + done, tweaked_key);
+    if (((_cryptAddress + pos + done) % ENCRYPTED_TWEAK_BLOCK_SIZE) == 0 || done == 0) {
+      _cryptKeyTweak(_cryptAddress + pos + done, tweaked_key);
       // Use setkey_enc because we perform AES_ENCRYPT operation below
       if (mbedtls_aes_setkey_enc(&ctx, tweaked_key, 256)) {
         return false;
@@ -597,7 +628,7 @@ bool UpdateClass::_decryptBuffer() {
 
     // Step 3: Reverse byte order back to get the decrypted plaintext
     for (int i = 0; i < ENCRYPTED_BLOCK_SIZE; i++) {
-      _buffer[i + done] = _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i];
+      data[i + done] = _cryptBuffer[(ENCRYPTED_BLOCK_SIZE - 1) - i];
     }
 
     done += ENCRYPTED_BLOCK_SIZE;
@@ -608,36 +639,86 @@ bool UpdateClass::_decryptBuffer() {
 }
 #endif /* UPDATE_NOCRYPT */
 
-bool UpdateClass::_writeBuffer() {
+void UpdateClass::_checkCrypt(const uint8_t *data) {
 #ifndef UPDATE_NOCRYPT
   //first bytes of loading image, check to see if loading image needs decrypting
+  _cryptMode &= U_AES_DECRYPT_MODE_MASK;
+  if ((_cryptMode == U_AES_DECRYPT_ON) || ((_command == U_FLASH) && (_cryptMode & U_AES_DECRYPT_AUTO) && (data[0] != ESP_IMAGE_HEADER_MAGIC))) {
+    _cryptMode |= U_AES_IMAGE_DECRYPTING_BIT;  //set to decrypt the loading image
+    log_d("Decrypting OTA Image");
+  }
+#else
+  (void)data;
+#endif /* UPDATE_NOCRYPT */
+}
+
+bool UpdateClass::_writeBuffer() {
   if (!_progress) {
-    _cryptMode &= U_AES_DECRYPT_MODE_MASK;
-    if ((_cryptMode == U_AES_DECRYPT_ON) || ((_command == U_FLASH) && (_cryptMode & U_AES_DECRYPT_AUTO) && (_buffer[0] != ESP_IMAGE_HEADER_MAGIC))) {
-      _cryptMode |= U_AES_IMAGE_DECRYPTING_BIT;  //set to decrypt the loading image
-      log_d("Decrypting OTA Image");
+    //compressed and delta packages are decoded first, the decoded image is checked in _packageFlush()
+    if (UpdaterPackageHeader::isPackage(_buffer, _bufferLen)) {
+      if (!_packageBegin()) {
+        return false;
+      }
+    } else {
+      _checkCrypt(_buffer);
+    }
+    if (_progress_callback) {
+      _progress_callback(0, _size);
+    }
+  }
+
+  if (_package) {
+    if (!_packageWrite()) {
+      return false;
+    }
+  } else {
+    uint8_t err;
+    if (_pipeTask) {
+      //hand the sector to the writer task and continue with the next free buffer
+      err = _queueBuffer(&_buffer, _bufferLen, _progress);
+    } else {
+      err = _processBuffer(_buffer, _bufferLen, _progress);
     }
+    if (err != UPDATE_ERROR_OK) {
+      _abort(err);
+      return false;
+    }
+  }
+
+  _progress += _bufferLen;
+  _bufferLen = 0;
+  if (_progress_callback) {
+    _progress_callback(_progress, _size);
   }
+  return true;
+}
 
-  if (!_target_md5_decrypted) {
-    _md5.add(_buffer, _bufferLen);
+/*
+ * Hashes, decrypts, erases and writes one sector buffer holding the image
+ * bytes starting at pos. Runs in the caller context or, with more than one
+ * write buffer, in the writer task; sectors are always processed in order.
+ */
+uint8_t UpdateClass::_processBuffer(uint8_t *data, size_t len, size_t pos) {
+  //packages are hashed as they were received, see _packageWrite()
+  bool md5Image = !_package;
+#ifndef UPDATE_NOCRYPT
+  if (md5Image && !_target_md5_decrypted) {
+    _md5.add(data, len);
   }
 
   //check if data in buffer needs decrypting
   if (_cryptMode & U_AES_IMAGE_DECRYPTING_BIT) {
-    if (!_decryptBuffer()) {
-      _abort(UPDATE_ERROR_DECRYPT);
-      return false;
+    if (!_decryptBuffer(data, len, pos)) {
+      return UPDATE_ERROR_DECRYPT;
     }
   }
 #endif /* UPDATE_NOCRYPT */
   //first bytes of new firmware
   uint8_t skip = 0;
-  if (!_progress && _command == U_FLASH) {
+  if (!pos && _command == U_FLASH) {
     //check magic
-    if (_buffer[0] != ESP_IMAGE_HEADER_MAGIC) {
-      _abort(UPDATE_ERROR_MAGIC_BYTE);
-      return false;
+    if (data[0] != ESP_IMAGE_HEADER_MAGIC) {
+      return UPDATE_ERROR_MAGIC_BYTE;
     }
 
     //Stash the first 16 bytes of data and set the offset so they are
@@ -647,74 +728,352 @@ bool UpdateClass::_writeBuffer() {
     _skipBuffer = new (std::nothrow) uint8_t[skip];
     if (!_skipBuffer) {
       log_e("_skipBuffer allocation failed");
-      return false;
+      return UPDATE_ERROR_WRITE;
     }
-    memcpy(_skipBuffer, _buffer, skip);
-  }
-  if (!_progress && _progress_callback) {
-    _progress_callback(0, _size);
+    memcpy(_skipBuffer, data, skip);
   }
-  size_t offset = _partition->address + _progress;
+  size_t offset = _partition->address + pos;
   bool block_erase =
-    (_size - _progress >= SPI_FLASH_BLOCK_SIZE) && (offset % SPI_FLASH_BLOCK_SIZE == 0);  // if it's the block boundary, than erase the whole block from here
+    (_imageSize - pos >= SPI_FLASH_BLOCK_SIZE) && (offset % SPI_FLASH_BLOCK_SIZE == 0);  // if it's the block boundary, than erase the whole block from here
   bool part_head_sectors =
     _partition->address % SPI_FLASH_BLOCK_SIZE
     && offset < (_partition->address / SPI_FLASH_BLOCK_SIZE + 1) * SPI_FLASH_BLOCK_SIZE;  // sector belong to unaligned partition heading block
   bool part_tail_sectors =
-    offset >= (_partition->address + _size) / SPI_FLASH_BLOCK_SIZE * SPI_FLASH_BLOCK_SIZE;  // sector belong to unaligned partition tailing block
+    offset >= (_partition->address + _imageSize) / SPI_FLASH_BLOCK_SIZE * SPI_FLASH_BLOCK_SIZE;  // sector belong to unaligned partition tailing block
   if (block_erase || part_head_sectors || part_tail_sectors) {
-    if (!ESP.partitionEraseRange(_partition, _progress, block_erase ? SPI_FLASH_BLOCK_SIZE : SPI_FLASH_SEC_SIZE)) {
-      _abort(UPDATE_ERROR_ERASE);
-      return false;
+    if (!ESP.partitionEraseRange(_partition, pos, block_erase ? SPI_FLASH_BLOCK_SIZE : SPI_FLASH_SEC_SIZE)) {
+      return UPDATE_ERROR_ERASE;
     }
   }
 
   // try to skip empty blocks on unencrypted partitions
-  if ((_partition->encrypted || _chkDataInBlock(_buffer + skip / sizeof(uint32_t), _bufferLen - skip))
-      && !ESP.partitionWrite(_partition, _progress + skip, (uint32_t *)_buffer + skip / sizeof(uint32_t), _bufferLen - skip)) {
-    _abort(UPDATE_ERROR_WRITE);
-    return false;
+  if ((_partition->encrypted || _chkDataInBlock(data + skip / sizeof(uint32_t), len - skip))
+      && !ESP.partitionWrite(_partition, pos + skip, (uint32_t *)data + skip / sizeof(uint32_t), len - skip)) {
+    return UPDATE_ERROR_WRITE;
   }
 
   //restore magic or md5 will fail
-  if (!_progress && _command == U_FLASH) {
-    _buffer[0] = ESP_IMAGE_HEADER_MAGIC;
+  if (!pos && _command == U_FLASH) {
+    data[0] = ESP_IMAGE_HEADER_MAGIC;
   }
 #ifndef UPDATE_NOCRYPT
-  if (_target_md5_decrypted) {
+  md5Image = md5Image && _target_md5_decrypted;
 #endif /* UPDATE_NOCRYPT */
-    _md5.add(_buffer, _bufferLen);
-#ifndef UPDATE_NOCRYPT
+  if (md5Image) {
+    _md5.add(data, len);
   }
-#endif /* UPDATE_NOCRYPT */
 
 #ifdef UPDATE_SIGN
   // Add data to signature hash if signature verification is enabled
   // Only hash firmware bytes, not the signature bytes at the end
   if (_hash && _signatureSize > 0) {
-    size_t firmwareSize = _size - _signatureSize;
-    if (_progress < firmwareSize) {
+    size_t firmwareSize = _imageSize - _signatureSize;
+    if (pos < firmwareSize) {
       // Calculate how many bytes of this buffer are firmware (not signature)
-      size_t bytesToHash = _bufferLen;
-      if (_progress + _bufferLen > firmwareSize) {
-        bytesToHash = firmwareSize - _progress;
+      size_t bytesToHash = len;
+      if (pos + len > firmwareSize) {
+        bytesToHash = firmwareSize - pos;
       }
-      _hash->add(_buffer, bytesToHash);
+      _hash->add(data, bytesToHash);
     }
   }
 #endif /* UPDATE_SIGN */
 
-  _progress += _bufferLen;
-  _bufferLen = 0;
-  if (_progress_callback) {
-    _progress_callback(_progress, _size);
+  return UPDATE_ERROR_OK;
+}
+
+bool UpdateClass::setWriteBuffers(uint8_t count) {
+  if (_size > 0) {
+    log_w("Update already running");
+    return false;
+  }
+  if (count < 1 || count > UPDATE_MAX_WRITE_BUFFERS) {
+    log_e("bad buffer count %u", count);
+    return false;
+  }
+  _writeBuffers = count;
+  return true;
+}
+
+bool UpdateClass::_pipelineBegin() {
+  for (uint8_t i = 0; i < _writeBuffers; i++) {
+    _pipeBuffers[i] = new (std::nothrow) uint8_t[SPI_FLASH_SEC_SIZE];
+    if (!_pipeBuffers[i]) {
+      log_e("_buffer allocation failed");
+      return false;
+    }
+  }
+  _pipeQueue = xQueueCreate(_writeBuffers, sizeof(PipelineItem));
+  _pipeFree = xQueueCreate(_writeBuffers, sizeof(uint8_t *));
+  _pipeDone = xSemaphoreCreateBinary();
+  if (!_pipeQueue || !_pipeFree || !_pipeDone) {
+    log_e("writer queue create failed");
+    return false;
+  }
+  //the producer fills the first buffer, the others wait in the free queue
+  _buffer = _pipeBuffers[0];
+  for (uint8_t i = 1; i < _writeBuffers; i++) {
+    xQueueSend(_pipeFree, &_pipeBuffers[i], 0);
+  }
+  _pipeError = UPDATE_ERROR_OK;
+  if (xTaskCreate(_pipelineTask, "update_writer", UPDATE_WRITER_TASK_STACK, this, UPDATE_WRITER_TASK_PRIORITY, &_pipeTask) != pdPASS) {
+    log_e("writer task create failed");
+    _pipeTask = NULL;
+    _buffer = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void UpdateClass::_pipelineEnd() {
+  if (_pipeTask) {
+    //queued sectors are still written, the stop request is handled after them
+    PipelineItem stop = {NULL, 0, 0};
+    xQueueSend(_pipeQueue, &stop, portMAX_DELAY);
+    xSemaphoreTake(_pipeDone, portMAX_DELAY);
+    _pipeTask = NULL;
+    _buffer = nullptr;
+  }
+  if (_pipeQueue) {
+    vQueueDelete(_pipeQueue);
+    _pipeQueue = NULL;
+  }
+  if (_pipeFree) {
+    vQueueDelete(_pipeFree);
+    _pipeFree = NULL;
+  }
+  if (_pipeDone) {
+    vSemaphoreDelete(_pipeDone);
+    _pipeDone = NULL;
+  }
+  for (uint8_t i = 0; i < UPDATE_MAX_WRITE_BUFFERS; i++) {
+    if (_pipeBuffers[i]) {
+      delete[] _pipeBuffers[i];
+      _pipeBuffers[i] = nullptr;
+    }
+  }
+}
+
+uint8_t UpdateClass::_queueBuffer(uint8_t **data, size_t len, size_t pos) {
+  if (_pipeError != UPDATE_ERROR_OK) {
+    return _pipeError;
+  }
+  PipelineItem item = {*data, len, pos};
+  xQueueSend(_pipeQueue, &item, portMAX_DELAY);
+  //blocks only while all other buffers are still being written
+  uint32_t start = micros();
+  xQueueReceive(_pipeFree, data, portMAX_DELAY);
+  _pipeWaitTime += micros() - start;
+  return UPDATE_ERROR_OK;
+}
+
+bool UpdateClass::_pipelineDrain() {
+  if (!_pipeTask) {
+    return true;
   }
+  //once the writer task has returned every buffer but the one being filled, all queued sectors are in flash
+  uint8_t *done[UPDATE_MAX_WRITE_BUFFERS];
+  uint8_t count = _writeBuffers - 1;
+  uint32_t start = micros();
+  for (uint8_t i = 0; i < count; i++) {
+    xQueueReceive(_pipeFree, &done[i], portMAX_DELAY);
+  }
+  _pipeWaitTime += micros() - start;
+  for (uint8_t i = 0; i < count; i++) {
+    xQueueSend(_pipeFree, &done[i], 0);
+  }
+  if (_pipeError != UPDATE_ERROR_OK) {
+    _abort(_pipeError);
+    return false;
+  }
+  return true;
+}
+
+void UpdateClass::_pipelineTask(void *arg) {
+  UpdateClass *self = (UpdateClass *)arg;
+  PipelineItem item;
+  while (xQueueReceive(self->_pipeQueue, &item, portMAX_DELAY) == pdTRUE && item.data) {
+    //after an error the remaining sectors are only handed back until the producer aborts
+    if (self->_pipeError == UPDATE_ERROR_OK) {
+      self->_pipeError = self->_processBuffer(item.data, item.len, item.pos);
+    }
+    xQueueSend(self->_pipeFree, &item.data, portMAX_DELAY);
+  }
+  xSemaphoreGive(self->_pipeDone);
+  vTaskDelete(NULL);
+}
+
+bool UpdateClass::_packageBegin() {
+  UpdaterPackageHeader header;
+  if (_bufferLen < UPDATE_PACKAGE_HEADER_SIZE || !header.parse(_buffer)) {
+    log_e("bad package header");
+    _abort(UPDATE_ERROR_PACKAGE);
+    return false;
+  }
+  if (!header.imageSize || header.imageSize > _partition->size) {
+    log_e("image too large %lu > %" PRIu32, (unsigned long)header.imageSize, _partition->size);
+    _abort(UPDATE_ERROR_SIZE);
+    return false;
+  }
+
+  _packageIn = new (std::nothrow) uint8_t[SPI_FLASH_SEC_SIZE];
+  if (!_packageIn) {
+    log_e("_packageIn allocation failed");
+    _abort(UPDATE_ERROR_PACKAGE);
+    return false;
+  }
+
+  const esp_partition_t *base = NULL;
+  if (header.flags & UPDATE_PACKAGE_FLAG_DELTA) {
+    base = esp_ota_get_running_partition();
+    if (_command != U_FLASH || !base || header.baseSize > base->size || !_packageCheckBase(base, header)) {
+      log_e("running firmware is not the base of this delta package");
+      delete[] _packageIn;
+      _packageIn = nullptr;
+      _abort(UPDATE_ERROR_DELTA_BASE);
+      return false;
+    }
+  }
+
+  _package = new (std::nothrow) UpdaterPackage(
+    header,
+    [this](const uint8_t *data, size_t len) {
+      return _packageOutput(data, len);
+    },
+    [base](size_t offset, uint8_t *data, size_t len) {
+      return ESP.partitionRead(base, offset, (uint32_t *)data, len);
+    }
+  );
+  if (!_package) {
+    log_e("_package allocation failed");
+    delete[] _packageIn;
+    _packageIn = nullptr;
+    _abort(UPDATE_ERROR_PACKAGE);
+    return false;
+  }
+
+  //package bytes keep arriving in _buffer, the decoded image goes to the sector buffer allocated in begin()
+  memcpy(_packageIn, _buffer, _bufferLen);
+  _packageOut = _buffer;
+  _buffer = _packageIn;
+  _packageOutLen = 0;
+  _packageOutPos = 0;
+  _packageOutError = UPDATE_ERROR_OK;
+  _imageSize = header.imageSize;
+
+  if (!_package->begin()) {
+    _abort(_packageErrorCode());
+    return false;
+  }
+  log_d(
+    "Package: compression %u%s, %lu -> %lu bytes", header.compression, (header.flags & UPDATE_PACKAGE_FLAG_DELTA) ? ", delta" : "", (unsigned long)_size,
+    (unsigned long)_imageSize
+  );
+  return true;
+}
+
+bool UpdateClass::_packageCheckBase(const esp_partition_t *base, const UpdaterPackageHeader &header) {
+  //_packageIn is not in use yet and serves as read buffer
+  SHA256Builder sha;
+  uint8_t digest[32];
+  sha.begin();
+  for (size_t offset = 0; offset < header.baseSize; offset += SPI_FLASH_SEC_SIZE) {
+    size_t len = header.baseSize - offset;
+    if (len > SPI_FLASH_SEC_SIZE) {
+      len = SPI_FLASH_SEC_SIZE;
+    }
+    if (!ESP.partitionRead(base, offset, (uint32_t *)_packageIn, len)) {
+      return false;
+    }
+    sha.add(_packageIn, len);
+  }
+  sha.calculate();
+  sha.getBytes(digest);
+  return memcmp(digest, header.baseSha256, sizeof(digest)) == 0;
+}
+
+bool UpdateClass::_packageWrite() {
+  //the MD5 given to setMD5() is the one of the package as it was transferred
+  _md5.add(_buffer, _bufferLen);
+  size_t skip = _progress ? 0 : UPDATE_PACKAGE_HEADER_SIZE;
+  if (!_package->write(_buffer + skip, _bufferLen - skip)) {
+    _abort(_packageErrorCode());
+    return false;
+  }
+  return true;
+}
+
+bool UpdateClass::_packageEnd() {
+  if (!_package->end()) {
+    _abort(_packageErrorCode());
+    return false;
+  }
+  if (!_packageFlush()) {
+    _abort(_packageOutError);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Sink of the package decoder: collects the decoded image into sectors that
+ * are written exactly like the sectors of a plain image.
+ */
+bool UpdateClass::_packageOutput(const uint8_t *data, size_t len) {
+  while (len) {
+    size_t n = SPI_FLASH_SEC_SIZE - _packageOutLen;
+    if (n > len) {
+      n = len;
+    }
+    memcpy(_packageOut + _packageOutLen, data, n);
+    _packageOutLen += n;
+    data += n;
+    len -= n;
+    if (_packageOutLen == SPI_FLASH_SEC_SIZE && !_packageFlush()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool UpdateClass::_packageFlush() {
+  if (!_packageOutLen) {
+    return true;
+  }
+  if (!_packageOutPos) {
+    _checkCrypt(_packageOut);
+  }
+  //errors are only recorded here, the decoder is still running and _abort() would delete it
+  uint8_t err;
+  if (_pipeTask) {
+    err = _queueBuffer(&_packageOut, _packageOutLen, _packageOutPos);
+  } else {
+    err = _processBuffer(_packageOut, _packageOutLen, _packageOutPos);
+  }
+  if (err != UPDATE_ERROR_OK) {
+    _packageOutError = err;
+    return false;
+  }
+  _packageOutPos += _packageOutLen;
+  _packageOutLen = 0;
   return true;
 }
 
+uint8_t UpdateClass::_packageErrorCode() {
+  switch (_package->error()) {
+    case UpdaterPackage::PACKAGE_ERROR_SINK: return _packageOutError;
+    case UpdaterPackage::PACKAGE_ERROR_BASE: return UPDATE_ERROR_READ;
+    case UpdaterPackage::PACKAGE_ERROR_SIZE: return UPDATE_ERROR_SIZE;
+    case UpdaterPackage::PACKAGE_ERROR_MEMORY:
+      log_e("package decoder allocation failed");
+      return UPDATE_ERROR_PACKAGE;
+    default: return UPDATE_ERROR_PACKAGE;
+  }
+}
+
 bool UpdateClass::_verifyHeader(uint8_t data) {
   if (_command == U_FLASH) {
-    if (data != ESP_IMAGE_HEADER_MAGIC) {
+    if (data != ESP_IMAGE_HEADER_MAGIC && data != UPDATE_PACKAGE_MAGIC_BYTE) {
       _abort(UPDATE_ERROR_MAGIC_BYTE);
       return false;
     }
@@ -778,7 +1137,23 @@ bool UpdateClass::end(bool evenIfRemaining) {
     if (_bufferLen > 0) {
       _writeBuffer();
     }
+  }
+
+  //decode the rest of the package and write the last sector of the image
+  if (_package && !_packageEnd()) {
+    return false;
+  }
+
+  //sectors still queued for the writer task have to be in flash before verifying
+  if (!_pipelineDrain()) {
+    return false;
+  }
+
+  if (evenIfRemaining) {
     _size = progress();
+    if (!_package) {
+      _imageSize = _size;
+    }
   }
 
   _md5.calculate();
@@ -805,9 +1180,10 @@ bool UpdateClass::end(bool evenIfRemaining) {
     }
 
     // Read signature from partition (last 512 bytes of what was written)
-    size_t firmwareSize = _size - _signatureSize;
+    size_t firmwareSize = _imageSize - _signatureSize;
     log_d(
-      "Reading signature from offset %lu (firmware size: %lu, total size: %lu)", (unsigned long)firmwareSize, (unsigned long)firmwareSize, (unsigned long)_size
+      "Reading signature from offset %lu (firmware size: %lu, total size: %lu)", (unsigned long)firmwareSize, (unsigned long)firmwareSize,
+      (unsigned long)_imageSize
     );
     if (!ESP.partitionRead(_partition, firmwareSize, (uint32_t *)_signatureBuffer, maxSigSize)) {
       log_e("Failed to read signature from partition");
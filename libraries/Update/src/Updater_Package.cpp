@@ -0,0 +1,808 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <new>
+#include "Updater_Package.h"
+
+#define INFLATE_WINDOW_SIZE 32768
+#define INFLATE_WINDOW_MASK (INFLATE_WINDOW_SIZE - 1)
+#define INFLATE_MAX_BITS    15
+// literal/length code with extra bits plus distance code with extra bits
+#define INFLATE_SYMBOL_BITS 48
+
+#define GZIP_FLAG_HCRC    0x02
+#define GZIP_FLAG_EXTRA   0x04
+#define GZIP_FLAG_NAME    0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+static const uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t distBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                      193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const uint8_t codeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len) {
+  static const uint32_t table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+  };
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ table[crc & 0x0f];
+    crc = (crc >> 4) ^ table[crc & 0x0f];
+  }
+  return ~crc;
+}
+
+static uint32_t readLE32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool UpdaterPackageHeader::isPackage(const uint8_t *data, size_t len) {
+  return len >= 4 && memcmp(data, "UPKG", 4) == 0;
+}
+
+bool UpdaterPackageHeader::parse(const uint8_t *data) {
+  if (!isPackage(data, UPDATE_PACKAGE_HEADER_SIZE) || data[4] != UPDATE_PACKAGE_VERSION) {
+    return false;
+  }
+  compression = data[5];
+  hsWindow = data[6];
+  hsLookahead = data[7];
+  flags = data[8];
+  imageSize = readLE32(data + 12);
+  baseSize = readLE32(data + 16);
+  memcpy(baseSha256, data + 32, sizeof(baseSha256));
+  return true;
+}
+
+bool UpdaterDecoder::_emit(const uint8_t *data, size_t len) {
+  if (len == 0 || _sinkFailed) {
+    return !_sinkFailed;
+  }
+  if (!_sink(data, len)) {
+    _sinkFailed = true;
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Inflate
+ *
+ * Input is consumed through a 64 bit bit buffer. A symbol is only decoded
+ * once enough bits for the longest possible code are buffered, so decoding
+ * never has to be suspended in the middle of a symbol. This cannot stall at
+ * the end of the stream because the 8 byte gzip trailer follows the last
+ * block.
+ */
+
+UpdaterInflate::UpdaterInflate(Sink sink)
+  : UpdaterDecoder(sink), _state(STATE_GZIP_HEADER), _last(false), _in(NULL), _inEnd(NULL), _bitBuf(0), _bitCount(0), _hdrFlags(0), _hdrPos(0), _hdrSkip(0),
+    _window(NULL), _wpos(0), _flushPos(0), _total(0), _crc(0), _storedLeft(0), _nlen(0), _ndist(0), _ncode(0), _lenIndex(0), _trailerLen(0) {
+  _lencode.symbol = _lenSymbols;
+  _distcode.symbol = _distSymbols;
+}
+
+UpdaterInflate::~UpdaterInflate() {
+  delete[] _window;
+}
+
+bool UpdaterInflate::begin() {
+  _window = new (std::nothrow) uint8_t[INFLATE_WINDOW_SIZE];
+  return _window != NULL;
+}
+
+void UpdaterInflate::_gzipNext() {
+  if (_hdrFlags & GZIP_FLAG_EXTRA) {
+    _hdrFlags &= ~GZIP_FLAG_EXTRA;
+    _hdrPos = 10;
+  } else if (_hdrFlags & GZIP_FLAG_NAME) {
+    _hdrFlags &= ~GZIP_FLAG_NAME;
+    _hdrPos = 13;
+  } else if (_hdrFlags & GZIP_FLAG_COMMENT) {
+    _hdrFlags &= ~GZIP_FLAG_COMMENT;
+    _hdrPos = 14;
+  } else if (_hdrFlags & GZIP_FLAG_HCRC) {
+    _hdrFlags &= ~GZIP_FLAG_HCRC;
+    _hdrPos = 15;
+    _hdrSkip = 2;
+  } else {
+    _state = STATE_BLOCK;
+  }
+}
+
+bool UpdaterInflate::_gzipHeader(uint8_t c) {
+  // 10 fixed bytes, then the optional fields selected by the flags
+  switch (_hdrPos) {
+    case 0:  if (c != 0x1f) return false; break;
+    case 1:  if (c != 0x8b) return false; break;
+    case 2:  if (c != 8) return false; break;  // deflate
+    case 3:
+      if (c & 0xe0) {
+        return false;
+      }
+      _hdrFlags = c;
+      break;
+    case 10: _hdrSkip = c; _hdrPos = 11; return true;
+    case 11:
+      _hdrSkip |= (uint16_t)c << 8;
+      if (_hdrSkip) {
+        _hdrPos = 12;
+      } else {
+        _gzipNext();
+      }
+      return true;
+    case 12:
+    case 15:
+      if (--_hdrSkip == 0) {
+        _gzipNext();
+      }
+      return true;
+    case 13:
+    case 14:
+      if (c == 0) {
+        _gzipNext();
+      }
+      return true;
+    default: break;
+  }
+  if (++_hdrPos == 10) {
+    _gzipNext();
+  }
+  return true;
+}
+
+void UpdaterInflate::_refill() {
+  while (_bitCount <= 56 && _in < _inEnd) {
+    _bitBuf |= (uint64_t)*_in++ << _bitCount;
+    _bitCount += 8;
+  }
+}
+
+uint32_t UpdaterInflate::_bits(uint8_t n) {
+  uint32_t v = (uint32_t)_bitBuf & ((1UL << n) - 1);
+  _bitBuf >>= n;
+  _bitCount -= n;
+  return v;
+}
+
+// canonical Huffman decoding one bit at a time, the caller makes sure INFLATE_MAX_BITS are buffered
+int UpdaterInflate::_decode(const Huffman &h) {
+  int code = 0;
+  int first = 0;
+  int index = 0;
+  for (int len = 1; len <= INFLATE_MAX_BITS; len++) {
+    code |= _bits(1);
+    int count = h.count[len];
+    if (code - count < first) {
+      return h.symbol[index + (code - first)];
+    }
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+bool UpdaterInflate::_build(Huffman &h, const uint8_t *lengths, uint16_t n) {
+  uint16_t offs[INFLATE_MAX_BITS + 1];
+  memset(h.count, 0, sizeof(h.count));
+  for (uint16_t i = 0; i < n; i++) {
+    h.count[lengths[i]]++;
+  }
+  if (h.count[0] == n) {
+    return true;
+  }
+  // over-subscribed sets are invalid, incomplete ones only fail when a missing code is used
+  int left = 1;
+  for (int len = 1; len <= INFLATE_MAX_BITS; len++) {
+    left <<= 1;
+    left -= h.count[len];
+    if (left < 0) {
+      return false;
+    }
+  }
+  offs[1] = 0;
+  for (int len = 1; len < INFLATE_MAX_BITS; len++) {
+    offs[len + 1] = offs[len] + h.count[len];
+  }
+  for (uint16_t i = 0; i < n; i++) {
+    if (lengths[i]) {
+      h.symbol[offs[lengths[i]]++] = i;
+    }
+  }
+  return true;
+}
+
+void UpdaterInflate::_put(uint8_t c) {
+  _window[_wpos++] = c;
+  _total++;
+  if (_wpos == INFLATE_WINDOW_SIZE) {
+    _flush();
+    _wpos = 0;
+    _flushPos = 0;
+  }
+}
+
+bool UpdaterInflate::_flush() {
+  size_t len = _wpos - _flushPos;
+  const uint8_t *data = _window + _flushPos;
+  _flushPos = _wpos;
+  _crc = crc32Update(_crc, data, len);
+  return _emit(data, len);
+}
+
+bool UpdaterInflate::_run() {
+  for (;;) {
+    _refill();
+    switch (_state) {
+      case STATE_BLOCK:
+      {
+        if (_bitCount < 3) {
+          return true;
+        }
+        _last = _bits(1);
+        uint8_t type = _bits(2);
+        if (type == 0) {
+          _state = STATE_STORED_HEADER;
+        } else if (type == 1) {
+          uint16_t i = 0;
+          for (; i < 144; i++) {
+            _lengths[i] = 8;
+          }
+          for (; i < 256; i++) {
+            _lengths[i] = 9;
+          }
+          for (; i < 280; i++) {
+            _lengths[i] = 7;
+          }
+          for (; i < 288; i++) {
+            _lengths[i] = 8;
+          }
+          _build(_lencode, _lengths, 288);
+          memset(_lengths, 5, 30);
+          _build(_distcode, _lengths, 30);
+          _state = STATE_CODES;
+        } else if (type == 2) {
+          _state = STATE_DYNAMIC_HEADER;
+        } else {
+          return false;
+        }
+        break;
+      }
+
+      case STATE_STORED_HEADER:
+        _bits(_bitCount & 7);
+        if (_bitCount < 32) {
+          return true;
+        }
+        _storedLeft = _bits(16);
+        if ((_storedLeft ^ 0xffff) != _bits(16)) {
+          return false;
+        }
+        _state = STATE_STORED;
+        break;
+
+      case STATE_STORED:
+        while (_storedLeft && _bitCount >= 8) {
+          _put(_bits(8));
+          _storedLeft--;
+        }
+        while (_storedLeft && _in < _inEnd) {
+          _put(*_in++);
+          _storedLeft--;
+        }
+        if (_sinkFailed) {
+          return false;
+        }
+        if (_storedLeft) {
+          return true;
+        }
+        _state = _last ? STATE_TRAILER : STATE_BLOCK;
+        break;
+
+      case STATE_DYNAMIC_HEADER:
+        if (_bitCount < 14) {
+          return true;
+        }
+        _nlen = _bits(5) + 257;
+        _ndist = _bits(5) + 1;
+        _ncode = _bits(4) + 4;
+        if (_nlen > 286 || _ndist > 30) {
+          return false;
+        }
+        memset(_lengths, 0, 19);
+        _lenIndex = 0;
+        _state = STATE_DYNAMIC_CODE_LENGTHS;
+        break;
+
+      case STATE_DYNAMIC_CODE_LENGTHS:
+        while (_lenIndex < _ncode) {
+          if (_bitCount < 3) {
+            return true;
+          }
+          _lengths[codeLengthOrder[_lenIndex++]] = _bits(3);
+        }
+        // the distance table holds the code length code until the real tables are built
+        if (!_build(_distcode, _lengths, 19)) {
+          return false;
+        }
+        _lenIndex = 0;
+        _state = STATE_DYNAMIC_LENGTHS;
+        break;
+
+      case STATE_DYNAMIC_LENGTHS:
+        while (_lenIndex < _nlen + _ndist) {
+          if (_bitCount < 14) {
+            _refill();
+            if (_bitCount < 14) {
+              return true;
+            }
+          }
+          int sym = _decode(_distcode);
+          if (sym < 0) {
+            return false;
+          }
+          if (sym < 16) {
+            _lengths[_lenIndex++] = sym;
+            continue;
+          }
+          uint8_t len = 0;
+          uint16_t repeat;
+          if (sym == 16) {
+            if (_lenIndex == 0) {
+              return false;
+            }
+            len = _lengths[_lenIndex - 1];
+            repeat = 3 + _bits(2);
+          } else if (sym == 17) {
+            repeat = 3 + _bits(3);
+          } else {
+            repeat = 11 + _bits(7);
+          }
+          if (_lenIndex + repeat > _nlen + _ndist) {
+            return false;
+          }
+          while (repeat--) {
+            _lengths[_lenIndex++] = len;
+          }
+        }
+        if (_lengths[256] == 0) {
+          return false;
+        }
+        if (!_build(_lencode, _lengths, _nlen) || !_build(_distcode, _lengths + _nlen, _ndist)) {
+          return false;
+        }
+        _state = STATE_CODES;
+        break;
+
+      case STATE_CODES:
+        for (;;) {
+          if (_bitCount < INFLATE_SYMBOL_BITS) {
+            _refill();
+            if (_bitCount < INFLATE_SYMBOL_BITS) {
+              return true;
+            }
+          }
+          int sym = _decode(_lencode);
+          if (sym < 0) {
+            return false;
+          }
+          if (sym < 256) {
+            _put(sym);
+          } else if (sym == 256) {
+            _state = _last ? STATE_TRAILER : STATE_BLOCK;
+            break;
+          } else {
+            sym -= 257;
+            if (sym >= 29) {
+              return false;
+            }
+            uint16_t len = lengthBase[sym] + _bits(lengthExtra[sym]);
+            int dsym = _decode(_distcode);
+            if (dsym < 0 || dsym >= 30) {
+              return false;
+            }
+            uint32_t dist = distBase[dsym] + _bits(distExtra[dsym]);
+            if (dist > _total) {
+              return false;
+            }
+            while (len--) {
+              _put(_window[(_wpos - dist) & INFLATE_WINDOW_MASK]);
+            }
+          }
+          if (_sinkFailed) {
+            return false;
+          }
+        }
+        if (_state == STATE_TRAILER) {
+          _bits(_bitCount & 7);
+        }
+        break;
+
+      case STATE_TRAILER:
+        while (_trailerLen < sizeof(_trailer) && _bitCount >= 8) {
+          _trailer[_trailerLen++] = _bits(8);
+        }
+        while (_trailerLen < sizeof(_trailer) && _in < _inEnd) {
+          _trailer[_trailerLen++] = *_in++;
+        }
+        if (_trailerLen < sizeof(_trailer)) {
+          return true;
+        }
+        if (!_flush() || readLE32(_trailer) != _crc || readLE32(_trailer + 4) != _total) {
+          return false;
+        }
+        _state = STATE_DONE;
+        break;
+
+      case STATE_DONE:
+        // a single gzip member, nothing may follow it
+        return _bitCount == 0 && _in == _inEnd;
+
+      default: return false;
+    }
+  }
+}
+
+bool UpdaterInflate::write(const uint8_t *data, size_t len) {
+  if (_state == STATE_ERROR || !_window) {
+    return false;
+  }
+  size_t i = 0;
+  while (_state == STATE_GZIP_HEADER && i < len) {
+    if (!_gzipHeader(data[i++])) {
+      _state = STATE_ERROR;
+      return false;
+    }
+  }
+  if (_state == STATE_GZIP_HEADER) {
+    return true;
+  }
+  _in = data + i;
+  _inEnd = data + len;
+  bool ok = _run();
+  ok = _flush() && ok;
+  if (!ok) {
+    _state = STATE_ERROR;
+  }
+  return ok;
+}
+
+bool UpdaterInflate::finish() {
+  return _state == STATE_DONE;
+}
+
+/*
+ * Heatshrink
+ *
+ * Bits are read MSB first. A 1 tag bit is followed by an 8 bit literal, a 0
+ * tag bit by (offset - 1) in window bits and (count - 1) in lookahead bits.
+ */
+
+UpdaterHeatshrink::UpdaterHeatshrink(Sink sink, uint8_t windowBits, uint8_t lookaheadBits)
+  : UpdaterDecoder(sink), _windowBits(windowBits), _lookaheadBits(lookaheadBits), _state(STATE_TAG), _bitBuf(0), _bitCount(0), _index(0), _window(NULL),
+    _mask(0), _wpos(0), _flushPos(0) {}
+
+UpdaterHeatshrink::~UpdaterHeatshrink() {
+  delete[] _window;
+}
+
+bool UpdaterHeatshrink::begin() {
+  if (_windowBits < 4 || _windowBits > 15 || _lookaheadBits < 3 || _lookaheadBits >= _windowBits) {
+    return false;
+  }
+  size_t size = 1 << _windowBits;
+  _window = new (std::nothrow) uint8_t[size];
+  if (!_window) {
+    return false;
+  }
+  // like heatshrink_decoder, back-references before the start of the stream read zeros
+  memset(_window, 0, size);
+  _mask = size - 1;
+  return true;
+}
+
+void UpdaterHeatshrink::_put(uint8_t c) {
+  _window[_wpos++] = c;
+  if (_wpos > _mask) {
+    _flush();
+    _wpos = 0;
+    _flushPos = 0;
+  }
+}
+
+bool UpdaterHeatshrink::_flush() {
+  size_t len = _wpos - _flushPos;
+  const uint8_t *data = _window + _flushPos;
+  _flushPos = _wpos;
+  return _emit(data, len);
+}
+
+bool UpdaterHeatshrink::write(const uint8_t *data, size_t len) {
+  if (!_window || _sinkFailed) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    _bitBuf = (_bitBuf << 8) | data[i];
+    _bitCount += 8;
+    for (;;) {
+      uint8_t need = _state == STATE_TAG ? 1 : _state == STATE_LITERAL ? 8 : _state == STATE_INDEX ? _windowBits : _lookaheadBits;
+      if (_bitCount < need) {
+        break;
+      }
+      _bitCount -= need;
+      uint16_t value = (_bitBuf >> _bitCount) & ((1UL << need) - 1);
+      if (_state == STATE_TAG) {
+        _state = value ? STATE_LITERAL : STATE_INDEX;
+      } else if (_state == STATE_LITERAL) {
+        _put(value);
+        _state = STATE_TAG;
+      } else if (_state == STATE_INDEX) {
+        _index = value + 1;
+        _state = STATE_COUNT;
+      } else {
+        for (uint16_t count = value + 1; count > 0; count--) {
+          _put(_window[(_wpos - _index) & _mask]);
+        }
+        _state = STATE_TAG;
+      }
+    }
+    if (_sinkFailed) {
+      return false;
+    }
+  }
+  return _flush();
+}
+
+bool UpdaterHeatshrink::finish() {
+  // the last byte is padded with zero bits, the package checks the output size
+  return !_sinkFailed;
+}
+
+/*
+ * Delta
+ */
+
+UpdaterDelta::UpdaterDelta(Sink sink, BaseReader base, size_t baseSize)
+  : UpdaterDecoder(sink), _base(base), _baseSize(baseSize), _baseFailed(false), _state(STATE_OP), _op(OP_COPY), _varint(0), _varintShift(0), _length(0),
+    _basePos(0) {}
+
+bool UpdaterDelta::_copy() {
+  while (_length) {
+    size_t n = _length < sizeof(_chunk) ? _length : sizeof(_chunk);
+    if (!_base(_basePos, _chunk, n)) {
+      _baseFailed = true;
+      return false;
+    }
+    if (!_emit(_chunk, n)) {
+      return false;
+    }
+    _basePos += n;
+    _length -= n;
+  }
+  return true;
+}
+
+bool UpdaterDelta::write(const uint8_t *data, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    switch (_state) {
+      case STATE_OP:
+      case STATE_SEEK:
+      {
+        uint8_t c = data[i++];
+        if (_varintShift > 63) {
+          return false;
+        }
+        _varint |= (uint64_t)(c & 0x7f) << _varintShift;
+        _varintShift += 7;
+        if (c & 0x80) {
+          break;
+        }
+        uint64_t value = _varint;
+        _varint = 0;
+        _varintShift = 0;
+        if (_state == STATE_OP) {
+          _op = value & 3;
+          _length = value >> 2;
+          if (_op > OP_INSERT || (value >> 2) > 0xffffffffULL) {
+            return false;
+          }
+          if (_op == OP_INSERT) {
+            _state = _length ? STATE_INSERT : STATE_OP;
+          } else {
+            _state = STATE_SEEK;
+          }
+          break;
+        }
+        // zigzag encoded offset relative to the end of the previous COPY/ADD
+        int64_t pos = (int64_t)_basePos + (int64_t)((value >> 1) ^ (~(value & 1) + 1));
+        if (pos < 0 || (uint64_t)pos + _length > _baseSize) {
+          return false;
+        }
+        _basePos = pos;
+        if (_op == OP_COPY) {
+          if (!_copy()) {
+            return false;
+          }
+          _state = STATE_OP;
+        } else {
+          _state = _length ? STATE_ADD : STATE_OP;
+        }
+        break;
+      }
+
+      case STATE_ADD:
+      {
+        size_t n = len - i;
+        if (n > _length) {
+          n = _length;
+        }
+        if (n > sizeof(_chunk)) {
+          n = sizeof(_chunk);
+        }
+        if (!_base(_basePos, _chunk, n)) {
+          _baseFailed = true;
+          return false;
+        }
+        for (size_t k = 0; k < n; k++) {
+          _chunk[k] += data[i + k];
+        }
+        if (!_emit(_chunk, n)) {
+          return false;
+        }
+        i += n;
+        _basePos += n;
+        _length -= n;
+        if (!_length) {
+          _state = STATE_OP;
+        }
+        break;
+      }
+
+      case STATE_INSERT:
+      {
+        size_t n = len - i;
+        if (n > _length) {
+          n = _length;
+        }
+        if (!_emit(data + i, n)) {
+          return false;
+        }
+        i += n;
+        _length -= n;
+        if (!_length) {
+          _state = STATE_OP;
+        }
+        break;
+      }
+
+      default: return false;
+    }
+  }
+  return true;
+}
+
+bool UpdaterDelta::finish() {
+  return _state == STATE_OP && _varintShift == 0;
+}
+
+/*
+ * Package
+ */
+
+UpdaterPackage::UpdaterPackage(const UpdaterPackageHeader &header, UpdaterDecoder::Sink sink, UpdaterDelta::BaseReader base)
+  : _header(header), _sink(sink), _base(base), _decompress(NULL), _delta(NULL), _output(0), _error(PACKAGE_OK), _sinkFailed(false) {}
+
+UpdaterPackage::~UpdaterPackage() {
+  delete _decompress;
+  delete _delta;
+}
+
+bool UpdaterPackage::_out(const uint8_t *data, size_t len) {
+  if (_output + len > _header.imageSize) {
+    _error = PACKAGE_ERROR_SIZE;
+    return false;
+  }
+  _output += len;
+  if (!_sink(data, len)) {
+    _sinkFailed = true;
+    return false;
+  }
+  return true;
+}
+
+bool UpdaterPackage::begin() {
+  UpdaterDecoder::Sink next = [this](const uint8_t *data, size_t len) {
+    return _out(data, len);
+  };
+
+  if (_header.flags & UPDATE_PACKAGE_FLAG_DELTA) {
+    _delta = new (std::nothrow) UpdaterDelta(next, _base, _header.baseSize);
+    if (!_delta) {
+      _error = PACKAGE_ERROR_MEMORY;
+      return false;
+    }
+    UpdaterDelta *delta = _delta;
+    next = [delta](const uint8_t *data, size_t len) {
+      return delta->write(data, len);
+    };
+  }
+
+  if (_header.compression == UPDATE_COMPRESSION_GZIP) {
+    UpdaterInflate *inflate = new (std::nothrow) UpdaterInflate(next);
+    _decompress = inflate;
+    if (!inflate || !inflate->begin()) {
+      _error = PACKAGE_ERROR_MEMORY;
+      return false;
+    }
+  } else if (_header.compression == UPDATE_COMPRESSION_HEATSHRINK) {
+    uint8_t window = _header.hsWindow;
+    uint8_t lookahead = _header.hsLookahead;
+    if (window < 4 || window > 15 || lookahead < 3 || lookahead >= window) {
+      _error = PACKAGE_ERROR_DATA;
+      return false;
+    }
+    UpdaterHeatshrink *heatshrink = new (std::nothrow) UpdaterHeatshrink(next, window, lookahead);
+    _decompress = heatshrink;
+    if (!heatshrink || !heatshrink->begin()) {
+      _error = PACKAGE_ERROR_MEMORY;
+      return false;
+    }
+  } else if (_header.compression != UPDATE_COMPRESSION_NONE) {
+    _error = PACKAGE_ERROR_DATA;
+    return false;
+  }
+  return true;
+}
+
+bool UpdaterPackage::_fail() {
+  if (_error == PACKAGE_OK) {
+    if (_sinkFailed) {
+      _error = PACKAGE_ERROR_SINK;
+    } else if (_delta && _delta->baseFailed()) {
+      _error = PACKAGE_ERROR_BASE;
+    } else {
+      _error = PACKAGE_ERROR_DATA;
+    }
+  }
+  return false;
+}
+
+bool UpdaterPackage::write(const uint8_t *data, size_t len) {
+  if (_error != PACKAGE_OK) {
+    return false;
+  }
+  bool ok;
+  if (_decompress) {
+    ok = _decompress->write(data, len);
+  } else if (_delta) {
+    ok = _delta->write(data, len);
+  } else {
+    ok = _out(data, len);
+  }
+  return ok || _fail();
+}
+
+bool UpdaterPackage::end() {
+  if (_error != PACKAGE_OK) {
+    return false;
+  }
+  if ((_decompress && !_decompress->finish()) || (_delta && !_delta->finish())) {
+    return _fail();
+  }
+  if (_output != _header.imageSize) {
+    _error = PACKAGE_ERROR_SIZE;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,294 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Streaming decoders for compressed and delta OTA packages.
+ *
+ * A package is a 64 byte header followed by the payload:
+ *
+ *   offset  size  field
+ *        0     4  magic "UPKG"
+ *        4     1  version (1)
+ *        5     1  compression: 0 none, 1 gzip, 2 heatshrink
+ *        6     1  heatshrink window bits
+ *        7     1  heatshrink lookahead bits
+ *        8     1  flags: bit 0 payload is a delta patch
+ *        9     3  reserved
+ *       12     4  size of the resulting image (little endian)
+ *       16     4  delta: number of base bytes the patch refers to
+ *       20    12  reserved
+ *       32    32  delta: SHA-256 of those base bytes
+ *
+ * The payload is decompressed and, for delta packages, applied against the
+ * running firmware on the fly, so only a few KiB of state are needed no matter
+ * how large the image is. Packages are created with tools/ota_package.py.
+ *
+ * The decoders only depend on the C/C++ standard library so they can also be
+ * tested on a host machine.
+ */
+
+#ifndef ESP32UPDATER_PACKAGE_H
+#define ESP32UPDATER_PACKAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+#define UPDATE_PACKAGE_MAGIC_BYTE  'U'  ///< First byte of a package, see UpdaterPackageHeader
+#define UPDATE_PACKAGE_HEADER_SIZE 64   ///< Size of the package header in bytes
+#define UPDATE_PACKAGE_VERSION     1    ///< Package format version understood by this decoder
+
+#define UPDATE_COMPRESSION_NONE       0  ///< Payload is not compressed
+#define UPDATE_COMPRESSION_GZIP       1  ///< Payload is a gzip (RFC 1952) stream
+#define UPDATE_COMPRESSION_HEATSHRINK 2  ///< Payload is a heatshrink (LZSS) stream
+
+#define UPDATE_PACKAGE_FLAG_DELTA 0x01  ///< Payload is a patch against the running firmware
+
+#ifndef UPDATE_PACKAGE_DELTA_CHUNK
+#define UPDATE_PACKAGE_DELTA_CHUNK 256  ///< Bytes read from the base partition at a time while patching
+#endif
+
+struct UpdaterPackageHeader {
+  uint8_t compression;
+  uint8_t hsWindow;
+  uint8_t hsLookahead;
+  uint8_t flags;
+  uint32_t imageSize;
+  uint32_t baseSize;
+  uint8_t baseSha256[32];
+
+  /// true if data starts with the package magic
+  static bool isPackage(const uint8_t *data, size_t len);
+  /// fill the fields from UPDATE_PACKAGE_HEADER_SIZE bytes, false if the header is not understood
+  bool parse(const uint8_t *data);
+};
+
+/*
+ * Common interface of the stream stages. Every stage passes its output to the
+ * sink of the next one, the sink returns false to stop the stream.
+ */
+class UpdaterDecoder {
+public:
+  typedef std::function<bool(const uint8_t *data, size_t len)> Sink;
+
+  virtual ~UpdaterDecoder() {}
+  /// feed input, false on corrupt data or when the sink failed
+  virtual bool write(const uint8_t *data, size_t len) = 0;
+  /// no more input, false if the stream is incomplete
+  virtual bool finish() = 0;
+  bool sinkFailed() const {
+    return _sinkFailed;
+  }
+
+protected:
+  UpdaterDecoder(Sink sink) : _sink(sink), _sinkFailed(false) {}
+  bool _emit(const uint8_t *data, size_t len);
+
+  Sink _sink;
+  bool _sinkFailed;
+};
+
+// gzip member with a deflate (RFC 1951) body, checked against the CRC-32 and length in the trailer
+class UpdaterInflate : public UpdaterDecoder {
+public:
+  UpdaterInflate(Sink sink);
+  ~UpdaterInflate();
+  bool begin();  // allocates the 32 KiB window
+  bool write(const uint8_t *data, size_t len) override;
+  bool finish() override;
+
+private:
+  struct Huffman {
+    uint16_t count[16];
+    uint16_t *symbol;
+  };
+  enum {
+    STATE_GZIP_HEADER,
+    STATE_BLOCK,
+    STATE_STORED_HEADER,
+    STATE_STORED,
+    STATE_DYNAMIC_HEADER,
+    STATE_DYNAMIC_CODE_LENGTHS,
+    STATE_DYNAMIC_LENGTHS,
+    STATE_CODES,
+    STATE_TRAILER,
+    STATE_DONE,
+    STATE_ERROR
+  };
+
+  bool _gzipHeader(uint8_t c);
+  void _gzipNext();
+  bool _run();
+  void _refill();
+  uint32_t _bits(uint8_t n);
+  int _decode(const Huffman &h);
+  static bool _build(Huffman &h, const uint8_t *lengths, uint16_t n);
+  void _put(uint8_t c);
+  bool _flush();
+
+  uint8_t _state;
+  bool _last;
+
+  const uint8_t *_in;
+  const uint8_t *_inEnd;
+  uint64_t _bitBuf;
+  uint8_t _bitCount;
+
+  // gzip header
+  uint8_t _hdrFlags;
+  uint8_t _hdrPos;
+  uint16_t _hdrSkip;
+
+  uint8_t *_window;
+  uint16_t _wpos;
+  uint16_t _flushPos;
+  uint32_t _total;
+  uint32_t _crc;
+
+  // current block
+  uint16_t _storedLeft;
+  uint16_t _nlen;
+  uint16_t _ndist;
+  uint16_t _ncode;
+  uint16_t _lenIndex;
+  uint8_t _lengths[320];
+  uint16_t _lenSymbols[288];
+  uint16_t _distSymbols[30];
+  Huffman _lencode;
+  Huffman _distcode;
+  uint8_t _trailer[8];
+  uint8_t _trailerLen;
+};
+
+// heatshrink LZSS stream, as produced by heatshrink_encoder with the same window and lookahead bits
+class UpdaterHeatshrink : public UpdaterDecoder {
+public:
+  UpdaterHeatshrink(Sink sink, uint8_t windowBits, uint8_t lookaheadBits);
+  ~UpdaterHeatshrink();
+  bool begin();
+  bool write(const uint8_t *data, size_t len) override;
+  bool finish() override;
+
+private:
+  enum {
+    STATE_TAG,
+    STATE_LITERAL,
+    STATE_INDEX,
+    STATE_COUNT
+  };
+
+  void _put(uint8_t c);
+  bool _flush();
+
+  uint8_t _windowBits;
+  uint8_t _lookaheadBits;
+  uint8_t _state;
+  uint32_t _bitBuf;
+  uint8_t _bitCount;
+  uint16_t _index;
+
+  uint8_t *_window;
+  uint16_t _mask;
+  uint16_t _wpos;
+  uint16_t _flushPos;
+};
+
+/*
+ * Applies a patch against the base image. The patch is a sequence of
+ * operations, each starting with a varint (length << 2 | op):
+ *   COPY   (0) zigzag varint base offset delta, then length bytes are copied from the base
+ *   ADD    (1) zigzag varint base offset delta, then length bytes added (mod 256) to the base bytes
+ *   INSERT (2) length literal bytes
+ * The base offset continues after the last COPY/ADD, so mostly unchanged
+ * images encode as short seeks.
+ */
+class UpdaterDelta : public UpdaterDecoder {
+public:
+  /// read len bytes at offset of the base image, false on a read error
+  typedef std::function<bool(size_t offset, uint8_t *data, size_t len)> BaseReader;
+
+  UpdaterDelta(Sink sink, BaseReader base, size_t baseSize);
+  bool write(const uint8_t *data, size_t len) override;
+  bool finish() override;
+  bool baseFailed() const {
+    return _baseFailed;
+  }
+
+private:
+  enum {
+    STATE_OP,
+    STATE_SEEK,
+    STATE_ADD,
+    STATE_INSERT
+  };
+  enum {
+    OP_COPY,
+    OP_ADD,
+    OP_INSERT
+  };
+
+  bool _copy();
+
+  BaseReader _base;
+  size_t _baseSize;
+  bool _baseFailed;
+  uint8_t _state;
+  uint8_t _op;
+  uint64_t _varint;
+  uint8_t _varintShift;
+  size_t _length;
+  size_t _basePos;
+  uint8_t _chunk[UPDATE_PACKAGE_DELTA_CHUNK];
+};
+
+/*
+ * Runs the payload of a package through the stages selected by its header.
+ */
+class UpdaterPackage {
+public:
+  typedef enum {
+    PACKAGE_OK,
+    PACKAGE_ERROR_MEMORY,  // decoder state could not be allocated
+    PACKAGE_ERROR_DATA,    // corrupt compressed data or patch
+    PACKAGE_ERROR_BASE,    // base image could not be read
+    PACKAGE_ERROR_SIZE,    // output does not match the image size of the header
+    PACKAGE_ERROR_SINK     // the output sink returned false
+  } package_error_t;
+
+  UpdaterPackage(const UpdaterPackageHeader &header, UpdaterDecoder::Sink sink, UpdaterDelta::BaseReader base);
+  ~UpdaterPackage();
+
+  bool begin();
+  /// feed payload bytes (everything after the header)
+  bool write(const uint8_t *data, size_t len);
+  /// all payload bytes given, checks that the complete image was produced
+  bool end();
+
+  package_error_t error() const {
+    return _error;
+  }
+  size_t outputSize() const {
+    return _output;
+  }
+  const UpdaterPackageHeader &header() const {
+    return _header;
+  }
+
+private:
+  bool _fail();
+  bool _out(const uint8_t *data, size_t len);
+
+  UpdaterPackageHeader _header;
+  UpdaterDecoder::Sink _sink;
+  UpdaterDelta::BaseReader _base;
+  UpdaterDecoder *_decompress;
+  UpdaterDelta *_delta;
+  size_t _output;
+  package_error_t _error;
+  bool _sinkFailed;
+};
+
+#endif /* ESP32UPDATER_PACKAGE_H */
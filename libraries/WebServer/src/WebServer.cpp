@@ -22,8 +22,6 @@
 
 #include <Arduino.h>
 #include <esp32-hal-log.h>
-#include <libb64/cdecode.h>
-#include <libb64/cencode.h>
 #include "esp_random.h"
 #include "NetworkServer.h"
 #include "NetworkClient.h"
@@ -166,15 +164,17 @@ bool WebServer::authenticate(THandlerFunctionAuthCheck fn) {
     authReq = authReq.substring(6);  // length of AuthTypeBasic including the space at the end.
     authReq.trim();
 
-    /* base64 encoded string is always shorter (or equal) in length */
-    char *decoded = (authReq.length() < HTTP_MAX_BASIC_AUTH_LEN) ? new char[authReq.length()] : NULL;
+    size_t decodedLen = base64::decodedLength(authReq.length());
+    char *decoded = (authReq.length() < HTTP_MAX_BASIC_AUTH_LEN) ? new char[decodedLen + 1] : NULL;
     if (decoded) {
       char *p;
-      if (base64_decode_chars(authReq.c_str(), authReq.length(), decoded) && (p = index(decoded, ':')) && p) {
+      int len = base64::decode(authReq, (uint8_t *)decoded, decodedLen);
+      if (len > 0) {
+        decoded[len] = '\0';
+      }
+      if (len > 0 && (p = index(decoded, ':'))) {
         authReq = "";
-        /* Note: rfc7617 guarantees that there will not be an escaped colon in the username itself.
-         * Note:  base64_decode_chars() guarantees a terminating \0
-         */
+        /* Note: rfc7617 guarantees that there will not be an escaped colon in the username itself. */
         *p = '\0';
         char *_username = decoded, *_password = p + 1;
         String params[] = {_password, _srealm};
@@ -687,10 +687,13 @@ void WebServer::send(int code, const char *content_type, const String &content)
   //if(code == 200 && content.length() == 0 && _contentLength == CONTENT_LENGTH_NOT_SET)
   //  _contentLength = CONTENT_LENGTH_UNKNOWN;
   _prepareHeader(header, code, content_type, content.length());
+  // header and content leave in as few TCP segments as possible
+  _currentClient.cork();
   _currentClientWrite(header.c_str(), header.length());
   if (content.length()) {
     sendContent(content);
   }
+  _currentClient.uncork();
 }
 
 void WebServer::send(int code, char *content_type, const String &content) {
@@ -753,6 +756,11 @@ void WebServer::sendContent(const String &content) {
 
 void WebServer::sendContent(const char *content, size_t contentLength) {
   const char *footer = "\r\n";
+  // keep chunk size, data and footer together
+  bool cork = _chunked && !_currentClient.corked();
+  if (cork) {
+    _currentClient.cork();
+  }
   if (_chunked) {
     char *chunkSize = (char *)malloc(19);
     if (chunkSize) {
@@ -768,6 +776,9 @@ void WebServer::sendContent(const char *content, size_t contentLength) {
       _chunked = false;
     }
   }
+  if (cork) {
+    _currentClient.uncork();
+  }
 }
 
 void WebServer::sendContent_P(PGM_P content) {
@@ -0,0 +1,63 @@
+// I2C slave that behaves like a sensor: the master selects a register with the first byte it
+// writes and then reads or writes from there on, all of it served by the I2C interrupt.
+//
+// Registers 0x00-0x03 are read-only: an ID, a version and the uptime in seconds (little endian).
+// Registers 0x04-0x0F are writable settings, the sketch prints them when the master changed them.
+//
+// Try it with a second board running for example:
+//   Wire.beginTransmission(0x55); Wire.write(0x00); Wire.endTransmission(false);
+//   Wire.requestFrom(0x55, 4);  // ID, version, uptime
+
+#include <Arduino.h>
+#include "Wire.h"
+
+#define I2C_DEV_ADDR 0x55
+
+#define REG_ID       0x00
+#define REG_VERSION  0x01
+#define REG_UPTIME   0x02
+#define REG_SETTINGS 0x04
+#define REG_COUNT    0x10
+
+uint8_t regs[REG_COUNT] = {0xE5, 0x01};
+
+volatile bool settingsChanged = false;
+
+// runs in the slave task after the master wrote registers, keep it short
+void onRegisterWrite(uint8_t reg, size_t len) {
+  settingsChanged = true;
+}
+
+void setup() {
+  Serial.begin(115200);
+  Wire.begin((uint8_t)I2C_DEV_ADDR);
+  Wire.onRegisterWrite(onRegisterWrite);
+  if (!Wire.setRegisterMap(regs, sizeof(regs), REG_SETTINGS)) {
+    Serial.println("Register map mode is not available");
+  }
+}
+
+void loop() {
+  static uint32_t lastReport = 0;
+  uint16_t uptime = millis() / 1000;
+  regs[REG_UPTIME] = uptime & 0xFF;
+  regs[REG_UPTIME + 1] = uptime >> 8;
+
+  if (settingsChanged) {
+    settingsChanged = false;
+    Serial.print("Settings:");
+    for (int i = REG_SETTINGS; i < REG_COUNT; i++) {
+      Serial.printf(" %02X", regs[i]);
+    }
+    Serial.println();
+  }
+
+  if (millis() - lastReport >= 5000) {
+    lastReport = millis();
+    i2c_slave_stats_t stats;
+    if (Wire.getSlaveStats(stats)) {
+      Serial.printf("Register reads: %" PRIu32 " writes: %" PRIu32 "\n", stats.reg_reads, stats.reg_writes);
+    }
+  }
+  delay(10);
+}
@@ -48,13 +48,26 @@ TwoWire::TwoWire(uint8_t bus_num)
 #endif
 #if SOC_I2C_SUPPORT_SLAVE
     ,
-    is_slave(false), user_onRequest(nullptr), user_onReceive(nullptr)
+    is_slave(false), user_onRequest(nullptr), user_onReceive(nullptr), user_onRegisterWrite(nullptr)
 #endif /* SOC_I2C_SUPPORT_SLAVE */
+    ,
+    jobQueue(NULL), jobTask(NULL), jobStopTask(NULL)
 {
 }
 
 TwoWire::~TwoWire() {
+  if (jobTask != NULL) {
+    // a NULL job stops the task once the jobs queued before it ran and the bus lock was given back
+    TwoWireJob *stop = NULL;
+    jobStopTask = xTaskGetCurrentTaskHandle();
+    xQueueSend(jobQueue, &stop, portMAX_DELAY);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    jobTask = NULL;
+  }
   end();
+  if (jobQueue != NULL) {
+    vQueueDelete(jobQueue);
+  }
 #if !CONFIG_DISABLE_HAL_LOCKS
   if (lock != NULL) {
     vSemaphoreDelete(lock);
@@ -432,6 +445,17 @@ void TwoWire::beginTransmission(uint8_t address) {
   txLength = 0;
 }
 
+static uint8_t wireError(esp_err_t err) {
+  switch (err) {
+    case ESP_OK:            return 0;
+    case ESP_FAIL:          return 2;
+    case ESP_ERR_NOT_FOUND: return 2;
+    case ESP_ERR_TIMEOUT:   return 5;
+    default:                break;
+  }
+  return 4;
+}
+
 /*
 https://www.arduino.cc/reference/en/language/functions/communication/wire/endtransmission/
 endTransmission() returns:
@@ -465,14 +489,7 @@ uint8_t TwoWire::endTransmission(bool sendStop) {
     //mark as non-stop
     nonStop = true;
   }
-  switch (err) {
-    case ESP_OK:            return 0;
-    case ESP_FAIL:          return 2;
-    case ESP_ERR_NOT_FOUND: return 2;
-    case ESP_ERR_TIMEOUT:   return 5;
-    default:                break;
-  }
-  return 4;
+  return wireError(err);
 }
 
 uint8_t TwoWire::endTransmission() {
@@ -621,12 +638,277 @@ void TwoWire::onRequest(const std::function<void()> &function) {
 #endif
 }
 
+/*
+ * Transaction lists
+ * */
+
+TwoWireJob::TwoWireJob(size_t maxOps, size_t dataSize)
+  : _ops(NULL), _maxOps(0), _count(0), _data(NULL), _dataSize(0), _dataUsed(0), _busy(false), _inCallback(false), _requeued(false), _error(ESP_OK),
+    _callback(nullptr), _done(NULL) {
+  _ops = (i2c_op_t *)calloc(maxOps, sizeof(i2c_op_t));
+  _data = dataSize ? (uint8_t *)malloc(dataSize) : NULL;
+  _done = xSemaphoreCreateBinary();
+  if (_ops == NULL || (dataSize && _data == NULL) || _done == NULL) {
+    log_e("Can't allocate memory for the I2C job");
+    return;
+  }
+  // given while the job is idle, taken by runAsync() until the job task is done with it
+  xSemaphoreGive(_done);
+  _maxOps = maxOps;
+  _dataSize = dataSize;
+}
+
+TwoWireJob::~TwoWireJob() {
+  wait();
+  free(_ops);
+  free(_data);
+  if (_done != NULL) {
+    vSemaphoreDelete(_done);
+  }
+}
+
+uint8_t *TwoWireJob::alloc(size_t len) {
+  if (_dataUsed + len > _dataSize) {
+    log_e("I2C job data is full, %u bytes needed", (unsigned)(_dataUsed + len));
+    return NULL;
+  }
+  uint8_t *p = _data + _dataUsed;
+  _dataUsed += len;
+  return p;
+}
+
+int TwoWireJob::add(uint8_t address, const uint8_t *wbuff, size_t wsize, uint8_t *rbuff, size_t rsize) {
+  if (_busy || _count >= _maxOps) {
+    return -1;
+  }
+  i2c_op_t *op = &_ops[_count];
+  op->address = address;
+  op->wbuff = wbuff;
+  op->wsize = wsize;
+  op->rbuff = rbuff;
+  op->rsize = rsize;
+  op->result = ESP_OK;
+  return _count++;
+}
+
+int TwoWireJob::write(uint8_t address, const uint8_t *data, size_t len) {
+  return add(address, data, len, NULL, 0);
+}
+
+int TwoWireJob::read(uint8_t address, uint8_t *out, size_t len) {
+  return add(address, NULL, 0, out, len);
+}
+
+int TwoWireJob::writeRead(uint8_t address, const uint8_t *data, size_t wlen, uint8_t *out, size_t rlen) {
+  return add(address, data, wlen, out, rlen);
+}
+
+int TwoWireJob::writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+  return writeRegister(address, reg, &value, 1);
+}
+
+int TwoWireJob::writeRegister(uint8_t address, uint8_t reg, const uint8_t *data, size_t len) {
+  if (_busy || _count >= _maxOps) {
+    return -1;
+  }
+  uint8_t *buf = alloc(len + 1);
+  if (buf == NULL) {
+    return -1;
+  }
+  buf[0] = reg;
+  memcpy(buf + 1, data, len);
+  return add(address, buf, len + 1, NULL, 0);
+}
+
+int TwoWireJob::readRegister(uint8_t address, uint8_t reg, uint8_t *out, size_t len) {
+  if (_busy || _count >= _maxOps) {
+    return -1;
+  }
+  uint8_t *buf = alloc(out ? 1 : len + 1);
+  if (buf == NULL) {
+    return -1;
+  }
+  buf[0] = reg;
+  return add(address, buf, 1, out ? out : buf + 1, len);
+}
+
+void TwoWireJob::clear() {
+  if (_busy) {
+    log_e("I2C job is running");
+    return;
+  }
+  _count = 0;
+  _dataUsed = 0;
+  _error = ESP_OK;
+}
+
+bool TwoWireJob::wait(uint32_t timeOutMillis) {
+  if (_done == NULL) {
+    return !_busy;
+  }
+  if (_inCallback) {
+    // called from its own callback, which runs on the job task after the transactions are done
+    return !_requeued;
+  }
+  // the job task gives _done as its last access to the job, so it may be destroyed once this returns
+  TickType_t ticks = (timeOutMillis == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeOutMillis);
+  if (xSemaphoreTake(_done, ticks) != pdTRUE) {
+    return false;
+  }
+  xSemaphoreGive(_done);
+  return true;
+}
+
+esp_err_t TwoWireJob::result(int index) const {
+  if (index < 0 || (size_t)index >= _count) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return _ops[index].result;
+}
+
+const uint8_t *TwoWireJob::data(int index) const {
+  if (index < 0 || (size_t)index >= _count) {
+    return NULL;
+  }
+  return _ops[index].rbuff;
+}
+
+esp_err_t TwoWire::runJob(TwoWireJob &job) {
+#if SOC_I2C_SUPPORT_SLAVE
+  if (is_slave) {
+    log_e("Bus is in Slave Mode");
+    return ESP_FAIL;
+  }
+#endif /* SOC_I2C_SUPPORT_SLAVE */
+#if !CONFIG_DISABLE_HAL_LOCKS
+  if (currentTaskHandle == xTaskGetCurrentTaskHandle()) {
+    log_e("Unfinished Repeated Start transaction");
+    return ESP_ERR_INVALID_STATE;
+  }
+  //acquire lock
+  if (lock == NULL || xSemaphoreTake(lock, portMAX_DELAY) != pdTRUE) {
+    log_e("could not acquire lock");
+    return ESP_FAIL;
+  }
+#endif
+  esp_err_t err = i2cRunOps(num, job._ops, job._count, _timeOutMillis);
+#if !CONFIG_DISABLE_HAL_LOCKS
+  //release lock
+  xSemaphoreGive(lock);
+#endif
+  return err;
+}
+
+uint8_t TwoWire::run(TwoWireJob &job) {
+  if (job._busy) {
+    log_e("I2C job is already running");
+    return 4;
+  }
+  job._error = runJob(job);
+  return wireError(job._error);
+}
+
+void TwoWire::jobTaskHandler(void *arg) {
+  TwoWire *wire = (TwoWire *)arg;
+  TwoWireJob *job = NULL;
+  for (;;) {
+    if (xQueueReceive(wire->jobQueue, &job, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    if (job == NULL) {
+      // jobs that callbacks queued again behind the stop are finished without running
+      while (xQueueReceive(wire->jobQueue, &job, 0) == pdTRUE) {
+        job->_error = ESP_ERR_INVALID_STATE;
+        job->_requeued = false;
+        job->_busy = false;
+        xSemaphoreGive(job->_done);
+      }
+      // ~TwoWire() is waiting, the object must not be touched after the notification
+      xTaskNotifyGive(wire->jobStopTask);
+      vTaskDelete(NULL);
+    }
+    job->_error = wire->runJob(*job);
+    // the job stays busy while the callback runs; queuing it again from there replaces job->_callback
+    TwoWireJob::callback_t callback = std::move(job->_callback);
+    job->_callback = nullptr;
+    if (callback) {
+      job->_inCallback = true;
+      callback(*job);
+      job->_inCallback = false;
+    }
+    if (job->_requeued) {
+      job->_requeued = false;
+      continue;
+    }
+    job->_busy = false;
+    xSemaphoreGive(job->_done);
+  }
+}
+
+bool TwoWire::runAsync(TwoWireJob &job, TwoWireJob::callback_t callback) {
+  // a running job can only be queued again by its own callback
+  bool requeue = job._inCallback && xTaskGetCurrentTaskHandle() == jobTask;
+  if ((job._busy && !requeue) || job._done == NULL) {
+    return false;
+  }
+  if (jobQueue == NULL) {
+    jobQueue = xQueueCreate(WIRE_JOB_QUEUE_LENGTH, sizeof(TwoWireJob *));
+    if (jobQueue == NULL) {
+      log_e("xQueueCreate failed");
+      return false;
+    }
+  }
+  if (jobTask == NULL) {
+    char name[12];
+    snprintf(name, sizeof(name), "wire_job_%u", num);
+    xTaskCreateUniversal(jobTaskHandler, name, WIRE_JOB_TASK_STACK_SIZE, this, WIRE_JOB_TASK_PRIORITY, &jobTask, WIRE_JOB_TASK_RUNNING_CORE);
+    if (jobTask == NULL) {
+      log_e("Could not create the I2C job task");
+      return false;
+    }
+  }
+  TwoWireJob *p = &job;
+  if (!requeue && xSemaphoreTake(job._done, 0) != pdTRUE) {
+    return false;
+  }
+  job._callback = callback;
+  job._busy = true;
+  job._requeued = requeue;
+  if (xQueueSend(jobQueue, &p, 0) != pdTRUE) {
+    log_e("I2C job queue is full");
+    job._callback = nullptr;
+    job._requeued = false;
+    if (!requeue) {
+      job._busy = false;
+      xSemaphoreGive(job._done);
+    }
+    return false;
+  }
+  return true;
+}
+
 #if SOC_I2C_SUPPORT_SLAVE
 
 size_t TwoWire::slaveWrite(const uint8_t *buffer, size_t len) {
   return i2cSlaveWrite(num, buffer, len, _timeOutMillis);
 }
 
+bool TwoWire::setRegisterMap(uint8_t *regs, size_t size, size_t writableFrom) {
+  if (!is_slave) {
+    log_e("Register map requires Slave Mode, call begin(address) first");
+    return false;
+  }
+  return i2cSlaveSetRegisterMap(num, regs, size, writableFrom, onRegisterWriteService, this) == ESP_OK;
+}
+
+void TwoWire::onRegisterWrite(const std::function<void(uint8_t, size_t)> &function) {
+  user_onRegisterWrite = function;
+}
+
+bool TwoWire::getSlaveStats(i2c_slave_stats_t &stats, bool reset) {
+  return i2cSlaveGetStats(num, &stats, reset) == ESP_OK;
+}
+
 void TwoWire::onReceiveService(uint8_t num, uint8_t *inBytes, size_t numBytes, bool stop, void *arg) {
   TwoWire *wire = (TwoWire *)arg;
   if (!wire->user_onReceive) {
@@ -644,6 +926,13 @@ void TwoWire::onReceiveService(uint8_t num, uint8_t *inBytes, size_t numBytes, b
   wire->user_onReceive(numBytes);
 }
 
+void TwoWire::onRegisterWriteService(uint8_t num, uint8_t reg, size_t len, void *arg) {
+  TwoWire *wire = (TwoWire *)arg;
+  if (wire->user_onRegisterWrite) {
+    wire->user_onRegisterWrite(reg, len);
+  }
+}
+
 void TwoWire::onRequestService(uint8_t num, void *arg) {
   TwoWire *wire = (TwoWire *)arg;
   if (!wire->user_onRequest) {
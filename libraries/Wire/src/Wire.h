@@ -37,6 +37,11 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp32-hal-i2c.h"
+#include "esp32-hal-i2c-slave.h"
 #include "HardwareI2C.h"
 #include "Stream.h"
 
@@ -49,6 +54,84 @@
 #define I2C_BUFFER_LENGTH 128  // Default size, if none is set using Wire::setBuffersize(size_t)
 #endif
 
+// Task running the jobs passed to TwoWire::runAsync(), started with the first one
+#ifndef WIRE_JOB_TASK_STACK_SIZE
+#define WIRE_JOB_TASK_STACK_SIZE 2048
+#endif
+#ifndef WIRE_JOB_TASK_PRIORITY
+#define WIRE_JOB_TASK_PRIORITY (configMAX_PRIORITIES - 2)
+#endif
+#ifndef WIRE_JOB_TASK_RUNNING_CORE
+#define WIRE_JOB_TASK_RUNNING_CORE -1
+#endif
+#ifndef WIRE_JOB_QUEUE_LENGTH
+#define WIRE_JOB_QUEUE_LENGTH 8
+#endif
+
+class TwoWire;
+
+/*
+ * A list of transactions built once and run as one job by TwoWire::run() or TwoWire::runAsync(),
+ * which hold the bus once for the whole list and need no copies through the Wire buffers.
+ * Buffers passed in are referenced and can be reused by every run; register numbers and the
+ * values of writeRegister() are copied into the job.
+ */
+class TwoWireJob {
+public:
+  typedef std::function<void(TwoWireJob &)> callback_t;
+
+  TwoWireJob(size_t maxOps = 16, size_t dataSize = 64);
+  ~TwoWireJob();
+  TwoWireJob(const TwoWireJob &) = delete;
+  TwoWireJob &operator=(const TwoWireJob &) = delete;
+
+  // each returns the index of the transaction, -1 if the job is full
+  int write(uint8_t address, const uint8_t *data, size_t len);
+  int read(uint8_t address, uint8_t *out, size_t len);
+  // write, repeated start, read
+  int writeRead(uint8_t address, const uint8_t *data, size_t wlen, uint8_t *out, size_t rlen);
+  int writeRegister(uint8_t address, uint8_t reg, uint8_t value);
+  int writeRegister(uint8_t address, uint8_t reg, const uint8_t *data, size_t len);
+  // out NULL keeps the bytes in the job, see data()
+  int readRegister(uint8_t address, uint8_t reg, uint8_t *out, size_t len);
+  // remove all transactions, not while the job is running
+  void clear();
+
+  size_t count() const {
+    return _count;
+  }
+  bool busy() const {
+    return _busy;
+  }
+  // wait for a job passed to runAsync(), false on timeout
+  bool wait(uint32_t timeOutMillis = portMAX_DELAY);
+  // first error of the last run, ESP_OK if every transaction succeeded
+  esp_err_t error() const {
+    return _error;
+  }
+  esp_err_t result(int index) const;
+  // the bytes read by transaction index
+  const uint8_t *data(int index) const;
+
+private:
+  friend class TwoWire;
+  i2c_op_t *_ops;
+  size_t _maxOps;
+  size_t _count;
+  uint8_t *_data;
+  size_t _dataSize;
+  size_t _dataUsed;
+  volatile bool _busy;
+  bool _inCallback;  // the job task is running the callback
+  bool _requeued;    // the callback queued the job again
+  esp_err_t _error;
+  callback_t _callback;
+  SemaphoreHandle_t _done;
+
+  int add(uint8_t address, const uint8_t *wbuff, size_t wsize, uint8_t *rbuff, size_t rsize);
+  uint8_t *alloc(size_t len);
+};
+
 class TwoWire : public HardwareI2C {
 protected:
   uint8_t num;
@@ -75,12 +158,19 @@ private:
   bool is_slave;
   std::function<void()> user_onRequest;
   std::function<void(int)> user_onReceive;
+  std::function<void(uint8_t, size_t)> user_onRegisterWrite;
   static void onRequestService(uint8_t, void *);
   static void onReceiveService(uint8_t, uint8_t *, size_t, bool, void *);
+  static void onRegisterWriteService(uint8_t, uint8_t, size_t, void *);
 #endif /* SOC_I2C_SUPPORT_SLAVE */
   bool initPins(int sdaPin, int sclPin);
   bool allocateWireBuffer();
   void freeWireBuffer();
+  QueueHandle_t jobQueue;
+  TaskHandle_t jobTask;
+  TaskHandle_t jobStopTask;  // waits in ~TwoWire() until the job task finished the queued jobs
+  esp_err_t runJob(TwoWireJob &job);
+  static void jobTaskHandler(void *arg);
 
 public:
   TwoWire(uint8_t bus_num);
@@ -115,6 +205,12 @@ public:
   void onReceive(const std::function<void(int)> &) override;
   void onRequest(const std::function<void()> &) override;
 
+  // run all transactions of job, returns 0 or the first error with the codes of endTransmission()
+  uint8_t run(TwoWireJob &job);
+  // queue job for the Wire task and return at once; callback runs in that task after the job,
+  // it may pass the job to runAsync() again for periodic polling
+  bool runAsync(TwoWireJob &job, TwoWireJob::callback_t callback = nullptr);
+
   //call setPins() first, so that begin() can be called without arguments from libraries
   bool setPins(int sda, int scl);
 
@@ -139,6 +235,15 @@ public:
 
 #if SOC_I2C_SUPPORT_SLAVE
   size_t slaveWrite(const uint8_t *, size_t);
+
+  // slave mode: answer like a sensor with the registers in regs (up to 256) straight from the
+  // interrupt, without onRequest()/onReceive(); registers below writableFrom are read-only.
+  // Call after begin(address), regs must stay valid until end() or setRegisterMap(NULL, 0)
+  bool setRegisterMap(uint8_t *regs, size_t size, size_t writableFrom = 0);
+  // called with the first register and the number of bytes after the master wrote registers
+  void onRegisterWrite(const std::function<void(uint8_t, size_t)> &);
+  // onRequest() latency and register map counters
+  bool getSlaveStats(i2c_slave_stats_t &stats, bool reset = false);
 #endif /* SOC_I2C_SUPPORT_SLAVE */
 };
 
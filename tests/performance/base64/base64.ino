@@ -0,0 +1,170 @@
+/*
+  base64 codec benchmark.
+
+  Encodes and decodes a RAM buffer with the libb64 state machine the core used
+  before, with the table driven base64 class into a buffer, and with the
+  streaming base64Encoder / base64Decoder writing to a Print in chunks.
+  Reports the throughput in MB of binary data per second and checks that all
+  implementations produce the same result.
+*/
+
+#include <Arduino.h>
+#include <base64.h>
+extern "C" {
+#include "libb64/cdecode.h"
+#include "libb64/cencode.h"
+}
+
+// Test settings
+
+// Number of runs to average
+#define N_RUNS 3
+
+// Size of the binary buffer that is encoded
+#define DATA_SIZE (24 * 1024)
+
+// Number of times the buffer is processed per case
+#define N_REPEAT 16
+
+#define ENCODED_SIZE (((DATA_SIZE + 2) / 3) * 4)
+
+// Discards its output, so only the codec is measured
+class NullPrint : public Print {
+public:
+  size_t write(uint8_t) override {
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    (void)buffer;
+    return size;
+  }
+};
+
+static uint8_t *data_buf = nullptr;
+static char *encoded_buf = nullptr;
+static char *check_buf = nullptr;
+static uint8_t *decoded_buf = nullptr;
+
+static void report(const char *op, const char *impl, uint32_t cost_time) {
+  double rate = (double)DATA_SIZE * N_REPEAT / (cost_time ? cost_time : 1);  // bytes per us = MB/s
+  Serial.printf("%s %s: Rate = %.2f MB/s Time: %lu us\n", op, impl, rate, (unsigned long)cost_time);
+}
+
+/* Encoding */
+
+static size_t encode_libb64(char *out) {
+  base64_encodestate state;
+  base64_init_encodestate(&state);
+  int len = base64_encode_block((const char *)data_buf, DATA_SIZE, out, &state);
+  len += base64_encode_blockend(out + len, &state);
+  out[len] = '\0';
+  return len;
+}
+
+static void run_encode() {
+  NullPrint null_print;
+  uint32_t start_time;
+
+  start_time = micros();
+  for (int i = 0; i < N_REPEAT; i++) {
+    encode_libb64(check_buf);
+  }
+  report("Encode", "libb64", micros() - start_time);
+
+  start_time = micros();
+  for (int i = 0; i < N_REPEAT; i++) {
+    base64::encode(data_buf, DATA_SIZE, encoded_buf, ENCODED_SIZE + 1);
+  }
+  report("Encode", "buffer", micros() - start_time);
+  if (strcmp(encoded_buf, check_buf) != 0) {
+    Serial.println("Error: base64 and libb64 encodings differ");
+  }
+
+  start_time = micros();
+  for (int i = 0; i < N_REPEAT; i++) {
+    base64Encoder encoder(null_print);
+    // in pieces that do not line up with the 3 byte groups, like network reads
+    for (size_t pos = 0; pos < DATA_SIZE; pos += 1000) {
+      encoder.write(data_buf + pos, min((size_t)1000, (size_t)DATA_SIZE - pos));
+    }
+    if (encoder.end() != ENCODED_SIZE) {
+      Serial.println("Error: base64Encoder produced a wrong length");
+    }
+  }
+  report("Encode", "stream", micros() - start_time);
+}
+
+/* Decoding */
+
+static void run_decode() {
+  NullPrint null_print;
+  uint32_t start_time;
+
+  start_time = micros();
+  for (int i = 0; i < N_REPEAT; i++) {
+    base64_decode_chars(encoded_buf, ENCODED_SIZE, (char *)decoded_buf);
+  }
+  report("Decode", "libb64", micros() - start_time);
+
+  memset(decoded_buf, 0, DATA_SIZE);
+  start_time = micros();
+  for (int i = 0; i < N_REPEAT; i++) {
+    base64::decode(encoded_buf, ENCODED_SIZE, decoded_buf, DATA_SIZE);
+  }
+  report("Decode", "buffer", micros() - start_time);
+  if (memcmp(decoded_buf, data_buf, DATA_SIZE) != 0) {
+    Serial.println("Error: base64 decoding differs from the input");
+  }
+
+  start_time = micros();
+  for (int i = 0; i < N_REPEAT; i++) {
+    base64Decoder decoder(null_print);
+    for (size_t pos = 0; pos < ENCODED_SIZE; pos += 1000) {
+      decoder.write((const uint8_t *)encoded_buf + pos, min((size_t)1000, (size_t)ENCODED_SIZE - pos));
+    }
+    if (decoder.end() != DATA_SIZE) {
+      Serial.println("Error: base64Decoder produced a wrong length");
+    }
+  }
+  report("Decode", "stream", micros() - start_time);
+}
+
+/* Main */
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  data_buf = (uint8_t *)malloc(DATA_SIZE);
+  decoded_buf = (uint8_t *)malloc(DATA_SIZE + 1);  // libb64 adds a \0
+  encoded_buf = (char *)malloc(ENCODED_SIZE + 1);
+  check_buf = (char *)malloc(ENCODED_SIZE + 1);
+  if (!data_buf || !decoded_buf || !encoded_buf || !check_buf) {
+    Serial.println("Error: Failed to allocate buffers");
+    return;
+  }
+  for (int i = 0; i < DATA_SIZE; i++) {
+    data_buf[i] = (uint8_t)(i * 31 + (i >> 8));
+  }
+
+  Serial.printf("Runs: %u\n", N_RUNS);
+  Serial.printf("Size: %u\n", DATA_SIZE * N_REPEAT);
+  Serial.flush();
+  for (int i = 0; i < N_RUNS; i++) {
+    Serial.printf("Run %u\n", i);
+    run_encode();
+    run_decode();
+    Serial.flush();
+  }
+
+  free(data_buf);
+  free(decoded_buf);
+  free(encoded_buf);
+  free(check_buf);
+}
+
+void loop() {
+  vTaskDelete(NULL);
+}
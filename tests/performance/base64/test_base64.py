@@ -0,0 +1,80 @@
+import json
+import logging
+import os
+
+from collections import defaultdict
+
+
+def test_base64(dut, request):
+    LOGGER = logging.getLogger(__name__)
+
+    runs_results = []
+
+    # Match "Runs: %d"
+    res = dut.expect(r"Runs: (\d+)", timeout=60)
+    runs = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Number of runs: {}".format(runs))
+    assert runs > 0, "Invalid number of runs"
+
+    # Match "Size: %d"
+    res = dut.expect(r"Size: (\d+)", timeout=60)
+    size = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Bytes processed per case: {}".format(size))
+    assert size > 0, "Invalid size"
+
+    for i in range(runs):
+        # Match "Run %d"
+        res = dut.expect(r"Run (\d+)", timeout=120)
+        run = int(res.group(1).decode("utf-8"))
+        LOGGER.info("Run {}".format(run))
+        assert run == i, "Invalid run number"
+
+        for _ in range(6):
+            # Match "<Encode|Decode> <impl>: Rate = %.2f MB/s Time: %d us" or "Error: %s"
+            res = dut.expect(r"((Encode|Decode) (libb64|buffer|stream): Rate = ([\d.]+) MB/s Time: (\d+) us|Error: .*)", timeout=120)
+            assert res.group(2) is not None, "Error detected in test output: {}".format(res.group(0).decode("utf-8"))
+            op = res.group(2).decode("utf-8").lower()
+            impl = res.group(3).decode("utf-8")
+            rate = float(res.group(4).decode("utf-8"))
+            time = int(res.group(5).decode("utf-8"))
+            assert rate > 0, "Invalid rate"
+            LOGGER.info("{} {}: Rate = {} MB/s. Time = {} us".format(op, impl, rate, time))
+            runs_results.append(((op, impl), (rate, time)))
+
+    # Calculate averages for each operation and implementation
+    sums = defaultdict(lambda: {"rate_sum": 0, "time_sum": 0})
+
+    for (op, impl), (rate, time) in runs_results:
+        sums[(op, impl)]["rate_sum"] += rate
+        sums[(op, impl)]["time_sum"] += time
+
+    # Flatten to canonical metrics list (see .github/CI_README.md)
+    metrics = []
+    for op, impl in sorted(sums):
+        v = sums[(op, impl)]
+        rate_avg = round(v["rate_sum"] / runs, 2)
+        time_avg = round(v["time_sum"] / runs, 2)
+        LOGGER.info("Test: {}-{}: Average rate = {} MB/s. Average time = {} us".format(op, impl, rate_avg, time_avg))
+        metrics.append({"name": "{}_{}_avg_rate".format(op, impl), "value": rate_avg, "unit": "MB/s"})
+        metrics.append({"name": "{}_{}_avg_time".format(op, impl), "value": time_avg, "unit": "us"})
+
+    results = {
+        "test_name": "base64",
+        "runs": runs,
+        "settings": "size={}".format(size),
+        "metrics": metrics,
+    }
+
+    current_folder = os.path.dirname(request.path)
+    os.makedirs(os.path.join(current_folder, dut.app.target), exist_ok=True)
+    file_index = 0
+    report_file = os.path.join(current_folder, dut.app.target, "result_base64" + str(file_index) + ".json")
+    while os.path.exists(report_file):
+        report_file = report_file.replace(str(file_index) + ".json", str(file_index + 1) + ".json")
+        file_index += 1
+
+    with open(report_file, "w+") as f:
+        try:
+            f.write(json.dumps(results))
+        except Exception as e:
+            LOGGER.warning("Failed to write results to file: {}".format(e))
@@ -0,0 +1,139 @@
+/*
+  GPIO toggle benchmark.
+
+  Toggles a pin and shifts bytes out, once through digitalWrite(), which
+  checks the pin on every call, and once through a fast_gpio_t handle, which
+  is checked once and then writes the GPIO registers directly. Reports the
+  operations per second of each case.
+
+  Only the output pins are driven, nothing needs to be connected.
+*/
+
+#include <Arduino.h>
+
+// Test settings
+
+// Number of runs to average
+#define N_RUNS 3
+
+// Toggles or writes per case
+#define N_OPS 1000000
+
+// Bytes shifted out per case
+#define N_BYTES 20000
+
+#define DATA_PIN  4
+#define CLOCK_PIN 5
+
+static const uint8_t port_pins[] = {DATA_PIN, CLOCK_PIN};
+
+static void report(const char *name, uint32_t ops, uint32_t cost_time, const char *unit) {
+  float rate = (float)ops * 1000000.0f / (cost_time ? cost_time : 1);
+  Serial.printf("Case %s: Rate = %.0f %s/s\n", name, rate, unit);
+}
+
+static void run_digital_write() {
+  uint32_t start_time = micros();
+  for (uint32_t i = 0; i < N_OPS / 2; i++) {
+    digitalWrite(DATA_PIN, HIGH);
+    digitalWrite(DATA_PIN, LOW);
+  }
+  report("digitalWrite", N_OPS, micros() - start_time, "toggles");
+}
+
+static void run_fast_write() {
+  fast_gpio_t pin;
+  if (!fastPinInit(&pin, DATA_PIN)) {
+    Serial.println("Error: fastPinInit failed");
+    return;
+  }
+  uint32_t start_time = micros();
+  for (uint32_t i = 0; i < N_OPS / 2; i++) {
+    fastPinWrite(&pin, HIGH);
+    fastPinWrite(&pin, LOW);
+  }
+  report("fastPinWrite", N_OPS, micros() - start_time, "toggles");
+}
+
+static void run_fast_toggle() {
+  fast_gpio_t pin;
+  if (!fastPinInit(&pin, DATA_PIN)) {
+    Serial.println("Error: fastPinInit failed");
+    return;
+  }
+  uint32_t start_time = micros();
+  for (uint32_t i = 0; i < N_OPS; i++) {
+    fastPinToggle(&pin);
+  }
+  report("fastPinToggle", N_OPS, micros() - start_time, "toggles");
+}
+
+static void run_port_write() {
+  fast_gpio_t port;
+  if (!fastPortInit(&port, port_pins, sizeof(port_pins))) {
+    Serial.println("Error: fastPortInit failed");
+    return;
+  }
+  uint32_t start_time = micros();
+  for (uint32_t i = 0; i < N_OPS; i++) {
+    fastPortWrite(&port, 0x3 << 4, i << 4);
+  }
+  report("fastPortWrite", N_OPS, micros() - start_time, "writes");
+}
+
+// shiftOut() as the core implemented it before the fast GPIO handle
+static void shift_out_digital(uint8_t dataPin, uint8_t clockPin, uint8_t val) {
+  for (uint8_t i = 0; i < 8; i++) {
+    digitalWrite(dataPin, !!(val & (1 << (7 - i))));
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+static void run_shift_out_digital() {
+  uint32_t start_time = micros();
+  for (uint32_t i = 0; i < N_BYTES; i++) {
+    shift_out_digital(DATA_PIN, CLOCK_PIN, (uint8_t)i);
+  }
+  report("shiftOut_digital", N_BYTES, micros() - start_time, "bytes");
+}
+
+static void run_shift_out() {
+  uint32_t start_time = micros();
+  for (uint32_t i = 0; i < N_BYTES; i++) {
+    shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, (uint8_t)i);
+  }
+  report("shiftOut", N_BYTES, micros() - start_time, "bytes");
+}
+
+/* Main */
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  for (uint8_t pin : port_pins) {
+    pinMode(pin, OUTPUT);
+  }
+
+  Serial.printf("Runs: %u\n", N_RUNS);
+  Serial.printf("Operations: %u\n", N_OPS);
+  Serial.printf("Bytes: %u\n", N_BYTES);
+  Serial.flush();
+  for (int i = 0; i < N_RUNS; i++) {
+    Serial.printf("Run %u\n", i);
+    run_digital_write();
+    run_fast_write();
+    run_fast_toggle();
+    run_port_write();
+    run_shift_out_digital();
+    run_shift_out();
+    Serial.flush();
+  }
+}
+
+void loop() {
+  vTaskDelete(NULL);
+}
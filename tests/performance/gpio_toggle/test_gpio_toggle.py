@@ -0,0 +1,83 @@
+import json
+import logging
+import os
+
+from collections import defaultdict
+
+N_CASES = 6
+
+
+def test_gpio_toggle(dut, request):
+    LOGGER = logging.getLogger(__name__)
+
+    runs_results = []
+
+    # Match "Runs: %d"
+    res = dut.expect(r"Runs: (\d+)", timeout=60)
+    runs = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Number of runs: {}".format(runs))
+    assert runs > 0, "Invalid number of runs"
+
+    # Match "Operations: %d"
+    res = dut.expect(r"Operations: (\d+)", timeout=60)
+    ops = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Operations per case: {}".format(ops))
+
+    # Match "Bytes: %d"
+    res = dut.expect(r"Bytes: (\d+)", timeout=60)
+    num_bytes = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Bytes per shift case: {}".format(num_bytes))
+
+    for i in range(runs):
+        # Match "Run %d"
+        res = dut.expect(r"Run (\d+)", timeout=120)
+        run = int(res.group(1).decode("utf-8"))
+        LOGGER.info("Run {}".format(run))
+        assert run == i, "Invalid run number"
+
+        for _ in range(N_CASES):
+            # Match "Case <name>: Rate = %.0f <unit>/s" or "Error: %s"
+            res = dut.expect(r"(Case (\w+): Rate = ([\d.]+) (\w+)/s|Error: .*)", timeout=120)
+            assert res.group(2) is not None, "Error detected in test output: {}".format(res.group(0).decode("utf-8"))
+            name = res.group(2).decode("utf-8")
+            rate = float(res.group(3).decode("utf-8"))
+            unit = res.group(4).decode("utf-8")
+            assert rate > 0, "Invalid rate"
+            LOGGER.info("{}: {} {}/s".format(name, rate, unit))
+            runs_results.append((name, rate, unit))
+
+    # Calculate averages for each case
+    sums = defaultdict(float)
+    units = {}
+
+    for name, rate, unit in runs_results:
+        sums[name] += rate
+        units[name] = unit
+
+    # Flatten to canonical metrics list (see .github/CI_README.md)
+    metrics = []
+    for name in sorted(sums):
+        rate_avg = round(sums[name] / runs)
+        LOGGER.info("Test: {}: Average rate = {} {}/s".format(name, rate_avg, units[name]))
+        metrics.append({"name": "{}_avg_rate".format(name), "value": rate_avg, "unit": "{}/s".format(units[name])})
+
+    results = {
+        "test_name": "gpio_toggle",
+        "runs": runs,
+        "settings": "operations={}, bytes={}".format(ops, num_bytes),
+        "metrics": metrics,
+    }
+
+    current_folder = os.path.dirname(request.path)
+    os.makedirs(os.path.join(current_folder, dut.app.target), exist_ok=True)
+    file_index = 0
+    report_file = os.path.join(current_folder, dut.app.target, "result_gpio_toggle" + str(file_index) + ".json")
+    while os.path.exists(report_file):
+        report_file = report_file.replace(str(file_index) + ".json", str(file_index + 1) + ".json")
+        file_index += 1
+
+    with open(report_file, "w+") as f:
+        try:
+            f.write(json.dumps(results))
+        except Exception as e:
+            LOGGER.warning("Failed to write results to file: {}".format(e))
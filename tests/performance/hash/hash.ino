@@ -0,0 +1,189 @@
+/*
+  Hash library benchmark.
+
+  Hashes a RAM buffer with the Hash library builders, once with the hardware
+  backend (SHA peripheral through mbedTLS) and once with the software rounds,
+  and reports the throughput. PBKDF2-HMAC is measured in iterations per second,
+  also without the HMAC midstates ("generic") for comparison.
+*/
+
+#include <Arduino.h>
+#include <SHA1Builder.h>
+#include <SHA2Builder.h>
+#include <SHA3Builder.h>
+#include <PBKDF2_HMACBuilder.h>
+
+// Test settings
+
+// Number of runs to average
+#define N_RUNS 3
+
+// Size of the buffer that is hashed
+#define DATA_SIZE (32 * 1024)
+
+// Number of times the buffer is hashed per case (1 MiB in total)
+#define N_REPEAT 32
+
+// PBKDF2-HMAC iterations per case
+#define N_PBKDF2_ITERATIONS 1000
+
+struct HashCase {
+  const char *name;
+  HashBuilder *builder;
+  // null for builders without a hardware backend
+  void (*setHardware)(HashBuilder *builder, bool enable);
+  bool (*usesHardware)(HashBuilder *builder);
+};
+
+static SHA1Builder sha1;
+static SHA256Builder sha256;
+static SHA512Builder sha512;
+static SHA3_256Builder sha3_256;
+
+template<typename T> static void set_hardware(HashBuilder *builder, bool enable) {
+  static_cast<T *>(builder)->setHardwareAcceleration(enable);
+}
+
+template<typename T> static bool uses_hardware(HashBuilder *builder) {
+  return static_cast<T *>(builder)->usesHardware();
+}
+
+static const HashCase hash_cases[] = {
+  {"SHA-1", &sha1, set_hardware<SHA1Builder>, uses_hardware<SHA1Builder>},
+  {"SHA-256", &sha256, set_hardware<SHA2Builder>, uses_hardware<SHA2Builder>},
+  {"SHA-512", &sha512, set_hardware<SHA2Builder>, uses_hardware<SHA2Builder>},
+  {"SHA3-256", &sha3_256, nullptr, nullptr},
+};
+
+#define N_HASH_CASES (sizeof(hash_cases) / sizeof(hash_cases[0]))
+
+static uint8_t *data_buf = nullptr;
+
+/* Hashing throughput */
+
+// Builders without a hardware backend run the software rounds in both passes
+static void run_hash(const HashCase &tc, const char *impl, bool hardware, uint8_t *digest) {
+  HashBuilder *b = tc.builder;
+  if (tc.setHardware) {
+    tc.setHardware(b, hardware);
+  }
+
+  uint32_t start_time = micros();
+  b->begin();
+  for (int i = 0; i < N_REPEAT; i++) {
+    b->add(data_buf, DATA_SIZE);
+  }
+  b->calculate();
+  uint32_t cost_time = micros() - start_time;
+  b->getBytes(digest);
+
+  bool hw = tc.usesHardware && tc.usesHardware(b);
+  double rate = (double)DATA_SIZE * N_REPEAT / (cost_time ? cost_time : 1);  // bytes per us = MB/s
+  Serial.printf("Hash %s %s: Rate = %.2f MB/s Time: %lu us Backend: %s\n", tc.name, impl, rate, (unsigned long)cost_time, hw ? "hw" : "sw");
+}
+
+/* PBKDF2-HMAC-SHA256 */
+
+// Forwards to a software SHA256Builder without the block level interface, so PBKDF2_HMACBuilder
+// has to hash both HMAC key blocks in every iteration like it did before midstates
+class GenericSHA256 : public HashBuilder {
+public:
+  using HashBuilder::add;
+
+  GenericSHA256() {
+    _sha.setHardwareAcceleration(false);
+  }
+  void begin() override {
+    _sha.begin();
+  }
+  void add(const uint8_t *data, size_t len) override {
+    _sha.add(data, len);
+  }
+  bool addStream(Stream &stream, const size_t maxLen) override {
+    return _sha.addStream(stream, maxLen);
+  }
+  void calculate() override {
+    _sha.calculate();
+  }
+  void getBytes(uint8_t *output) override {
+    _sha.getBytes(output);
+  }
+  void getChars(char *output) override {
+    _sha.getChars(output);
+  }
+  String toString() override {
+    return _sha.toString();
+  }
+  size_t getHashSize() const override {
+    return _sha.getHashSize();
+  }
+  bool usesHardware() const {
+    return false;
+  }
+  void setHardwareAcceleration(bool) {}
+
+private:
+  SHA256Builder _sha;
+};
+
+template<typename T> static void run_pbkdf2(const char *impl, bool hardware) {
+  T sha;
+  sha.setHardwareAcceleration(hardware);
+  PBKDF2_HMACBuilder pbkdf2(&sha, "password", "saltSALTsaltSALT", N_PBKDF2_ITERATIONS);
+
+  uint32_t start_time = micros();
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  uint32_t cost_time = micros() - start_time;
+
+  uint32_t rate = (uint64_t)N_PBKDF2_ITERATIONS * 1000000 / (cost_time ? cost_time : 1);
+  Serial.printf(
+    "PBKDF2 SHA-256 %s: Rate = %lu it/s Time: %lu us Backend: %s\n", impl, (unsigned long)rate, (unsigned long)cost_time, sha.usesHardware() ? "hw" : "sw"
+  );
+}
+
+/* Main */
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  data_buf = (uint8_t *)malloc(DATA_SIZE);
+  if (!data_buf) {
+    Serial.println("Error: Failed to allocate data buffer");
+    return;
+  }
+  for (int i = 0; i < DATA_SIZE; i++) {
+    data_buf[i] = (uint8_t)(i * 31 + (i >> 8));
+  }
+
+  Serial.printf("Runs: %u\n", N_RUNS);
+  Serial.printf("Size: %u\n", DATA_SIZE * N_REPEAT);
+  Serial.printf("Cases: %u\n", (unsigned)N_HASH_CASES);
+  Serial.flush();
+  for (int i = 0; i < N_RUNS; i++) {
+    Serial.printf("Run %u\n", i);
+    for (const HashCase &tc : hash_cases) {
+      uint8_t digest_hw[64];
+      uint8_t digest_sw[64];
+      run_hash(tc, "hw", true, digest_hw);
+      run_hash(tc, "sw", false, digest_sw);
+      if (memcmp(digest_hw, digest_sw, tc.builder->getHashSize()) != 0) {
+        Serial.printf("Error: %s digests of the hardware and software backends differ\n", tc.name);
+      }
+      Serial.flush();
+    }
+    run_pbkdf2<SHA256Builder>("hw", true);
+    run_pbkdf2<SHA256Builder>("sw", false);
+    run_pbkdf2<GenericSHA256>("generic", false);
+    Serial.flush();
+  }
+
+  free(data_buf);
+}
+
+void loop() {
+  vTaskDelete(NULL);
+}
@@ -0,0 +1,109 @@
+import json
+import logging
+import os
+
+from collections import defaultdict
+
+
+def test_hash(dut, request):
+    LOGGER = logging.getLogger(__name__)
+
+    runs_results = []
+
+    # Match "Runs: %d"
+    res = dut.expect(r"Runs: (\d+)", timeout=60)
+    runs = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Number of runs: {}".format(runs))
+    assert runs > 0, "Invalid number of runs"
+
+    # Match "Size: %d"
+    res = dut.expect(r"Size: (\d+)", timeout=60)
+    size = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Bytes hashed per case: {}".format(size))
+    assert size > 0, "Invalid size"
+
+    # Match "Cases: %d"
+    res = dut.expect(r"Cases: (\d+)", timeout=60)
+    cases = int(res.group(1).decode("utf-8"))
+    assert cases > 0, "Invalid number of cases"
+
+    for i in range(runs):
+        # Match "Run %d"
+        res = dut.expect(r"Run (\d+)", timeout=120)
+        run = int(res.group(1).decode("utf-8"))
+        LOGGER.info("Run {}".format(run))
+        assert run == i, "Invalid run number"
+
+        for _ in range(cases * 2):
+            # Match "Hash <algo> <impl>: Rate = %.2f MB/s Time: %d us Backend: <hw|sw>" or "Error: %s"
+            res = dut.expect(
+                r"(Hash ([\w-]+) (hw|sw): Rate = ([\d.]+) MB/s Time: (\d+) us Backend: (hw|sw)|Error: .*)", timeout=120
+            )
+            assert res.group(2) is not None, "Error detected in test output: {}".format(res.group(0).decode("utf-8"))
+            algo = res.group(2).decode("utf-8").lower().replace("-", "")
+            impl = res.group(3).decode("utf-8")
+            rate = float(res.group(4).decode("utf-8"))
+            time = int(res.group(5).decode("utf-8"))
+            backend = res.group(6).decode("utf-8")
+            assert rate > 0, "Invalid rate"
+            LOGGER.info("{} {}: Rate = {} MB/s. Time = {} us. Backend = {}".format(algo, impl, rate, time, backend))
+            runs_results.append(((algo, impl), (rate, time, backend)))
+
+        for _ in range(3):
+            # Match "PBKDF2 SHA-256 <hw|sw|generic>: Rate = %d it/s Time: %d us Backend: <hw|sw>" or "Error: %s"
+            res = dut.expect(
+                r"(PBKDF2 ([\w-]+) (hw|sw|generic): Rate = (\d+) it/s Time: (\d+) us Backend: (hw|sw)|Error: .*)", timeout=120
+            )
+            assert res.group(2) is not None, "Error detected in test output: {}".format(res.group(0).decode("utf-8"))
+            algo = "pbkdf2_" + res.group(2).decode("utf-8").lower().replace("-", "")
+            impl = res.group(3).decode("utf-8")
+            rate = int(res.group(4).decode("utf-8"))
+            time = int(res.group(5).decode("utf-8"))
+            backend = res.group(6).decode("utf-8")
+            assert rate > 0, "Invalid rate"
+            LOGGER.info("{} {}: Rate = {} it/s. Time = {} us. Backend = {}".format(algo, impl, rate, time, backend))
+            runs_results.append(((algo, impl), (rate, time, backend)))
+
+    # Calculate averages for each case and implementation
+    sums = defaultdict(lambda: {"rate_sum": 0, "time_sum": 0, "backend": "sw"})
+
+    for (algo, impl), (rate, time, backend) in runs_results:
+        sums[(algo, impl)]["rate_sum"] += rate
+        sums[(algo, impl)]["time_sum"] += time
+        sums[(algo, impl)]["backend"] = backend
+
+    # Flatten to canonical metrics list (see .github/CI_README.md)
+    metrics = []
+    for algo, impl in sorted(sums):
+        v = sums[(algo, impl)]
+        unit = "it/s" if algo.startswith("pbkdf2") else "MB/s"
+        rate_avg = round(v["rate_sum"] / runs, 2)
+        time_avg = round(v["time_sum"] / runs, 2)
+        LOGGER.info(
+            "Test: {}-{}: Average rate = {} {}. Average time = {} us. Backend = {}".format(
+                algo, impl, rate_avg, unit, time_avg, v["backend"]
+            )
+        )
+        metrics.append({"name": "{}_{}_avg_rate".format(algo, impl), "value": rate_avg, "unit": unit})
+        metrics.append({"name": "{}_{}_avg_time".format(algo, impl), "value": time_avg, "unit": "us"})
+
+    results = {
+        "test_name": "hash",
+        "runs": runs,
+        "settings": "size={}".format(size),
+        "metrics": metrics,
+    }
+
+    current_folder = os.path.dirname(request.path)
+    os.makedirs(os.path.join(current_folder, dut.app.target), exist_ok=True)
+    file_index = 0
+    report_file = os.path.join(current_folder, dut.app.target, "result_hash" + str(file_index) + ".json")
+    while os.path.exists(report_file):
+        report_file = report_file.replace(str(file_index) + ".json", str(file_index + 1) + ".json")
+        file_index += 1
+
+    with open(report_file, "w+") as f:
+        try:
+            f.write(json.dumps(results))
+        except Exception as e:
+            LOGGER.warning("Failed to write results to file: {}".format(e))
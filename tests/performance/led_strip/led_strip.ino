@@ -0,0 +1,140 @@
+/*
+  LED strip benchmark.
+
+  Sends frames to a strip of 600 RGB LEDs, once the way rgbLedWrite() does it,
+  with an array of 24 RMT symbols per LED sent by rmtWrite(), and once with the
+  strip driver, which keeps 3 bytes per LED and generates the symbols while
+  sending. Reports the frame rate when sending back to back, the time the
+  sketch is blocked per frame and the heap used by each implementation.
+
+  Only the LED pin is driven, nothing needs to be connected.
+*/
+
+#include <Arduino.h>
+
+// Test settings
+
+// Number of runs to average
+#define N_RUNS 3
+
+// Frames sent per case
+#define N_FRAMES 60
+
+#define N_LEDS  600
+#define LED_PIN 4
+
+// 10MHz ticks, same timing as rgbLedWrite()
+#define RMT_FREQ 10000000
+
+static rmt_data_t bit0 = {{4, 1, 8, 0}};
+static rmt_data_t bit1 = {{8, 1, 4, 0}};
+
+static inline uint8_t pattern(int frame, int i) {
+  return (uint8_t)(frame * 3 + i);
+}
+
+static void report(const char *impl, uint32_t cost_time, uint32_t blocked, size_t ram) {
+  float fps = (float)N_FRAMES * 1000000.0f / (cost_time ? cost_time : 1);
+  Serial.printf("Show %s: FPS = %.2f Blocked: %lu us RAM: %u bytes\n", impl, fps, (unsigned long)blocked, (unsigned)ram);
+}
+
+static void encode_symbols(rmt_data_t *symbols, int frame) {
+  rmt_data_t *s = symbols;
+  for (int i = 0; i < N_LEDS * 3; i++) {
+    uint8_t v = pattern(frame, i);
+    for (int bit = 7; bit >= 0; bit--) {
+      *s++ = (v & (1 << bit)) ? bit1 : bit0;
+    }
+  }
+}
+
+static void run_symbols() {
+  size_t heap = ESP.getFreeHeap();
+  rmt_data_t *symbols = (rmt_data_t *)malloc(N_LEDS * 24 * sizeof(rmt_data_t));
+  if (!symbols) {
+    Serial.println("Error: Failed to allocate the symbol array");
+    return;
+  }
+  if (!rmtInit(LED_PIN, RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, RMT_FREQ)) {
+    Serial.println("Error: rmtInit failed");
+    free(symbols);
+    return;
+  }
+  size_t ram = heap - ESP.getFreeHeap();
+
+  uint32_t start_time = micros();
+  for (int f = 0; f < N_FRAMES; f++) {
+    encode_symbols(symbols, f);
+    if (!rmtWrite(LED_PIN, symbols, N_LEDS * 24, 1000)) {
+      Serial.println("Error: rmtWrite failed");
+      break;
+    }
+    // latch
+    delayMicroseconds(300);
+  }
+  uint32_t cost_time = micros() - start_time;
+
+  rmtDeinit(LED_PIN);
+  free(symbols);
+  // the sketch is blocked for the whole frame
+  report("symbols", cost_time, cost_time / N_FRAMES, ram);
+}
+
+static void run_strip() {
+  size_t heap = ESP.getFreeHeap();
+  rgb_led_strip_t strip = rgbLedStripBegin(LED_PIN, N_LEDS, LED_COLOR_ORDER_GRB, false);
+  if (!strip) {
+    Serial.println("Error: rgbLedStripBegin failed");
+    return;
+  }
+  size_t ram = heap - ESP.getFreeHeap();
+  rgbLedStripSetBrightness(strip, 128);
+  rgbLedStripSetGamma(strip, 2.2f);
+  uint8_t *pixels = rgbLedStripPixels(strip);
+
+  uint32_t blocked = 0;
+  uint32_t start_time = micros();
+  for (int f = 0; f < N_FRAMES; f++) {
+    // draw the next frame while the previous one is sent
+    for (int i = 0; i < N_LEDS * 3; i++) {
+      pixels[i] = pattern(f, i);
+    }
+    // time the sketch would have for other work, not counted as blocked
+    rgbLedStripWait(strip, 1000);
+    uint32_t t = micros();
+    if (!rgbLedStripShow(strip)) {
+      Serial.println("Error: rgbLedStripShow failed");
+      break;
+    }
+    blocked += micros() - t;
+  }
+  rgbLedStripWait(strip, 1000);
+  uint32_t cost_time = micros() - start_time;
+
+  rgbLedStripEnd(strip);
+  report("strip", cost_time, blocked / N_FRAMES, ram);
+}
+
+/* Main */
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.printf("Runs: %u\n", N_RUNS);
+  Serial.printf("LEDs: %u\n", N_LEDS);
+  Serial.printf("Frames: %u\n", N_FRAMES);
+  Serial.flush();
+  for (int i = 0; i < N_RUNS; i++) {
+    Serial.printf("Run %u\n", i);
+    run_symbols();
+    run_strip();
+    Serial.flush();
+  }
+}
+
+void loop() {
+  vTaskDelete(NULL);
+}
@@ -0,0 +1,90 @@
+import json
+import logging
+import os
+
+from collections import defaultdict
+
+
+def test_led_strip(dut, request):
+    LOGGER = logging.getLogger(__name__)
+
+    runs_results = []
+
+    # Match "Runs: %d"
+    res = dut.expect(r"Runs: (\d+)", timeout=60)
+    runs = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Number of runs: {}".format(runs))
+    assert runs > 0, "Invalid number of runs"
+
+    # Match "LEDs: %d"
+    res = dut.expect(r"LEDs: (\d+)", timeout=60)
+    leds = int(res.group(1).decode("utf-8"))
+    LOGGER.info("LEDs: {}".format(leds))
+    assert leds > 0, "Invalid number of LEDs"
+
+    # Match "Frames: %d"
+    res = dut.expect(r"Frames: (\d+)", timeout=60)
+    frames = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Frames per case: {}".format(frames))
+
+    for i in range(runs):
+        # Match "Run %d"
+        res = dut.expect(r"Run (\d+)", timeout=120)
+        run = int(res.group(1).decode("utf-8"))
+        LOGGER.info("Run {}".format(run))
+        assert run == i, "Invalid run number"
+
+        for _ in range(2):
+            # Match "Show <symbols|strip>: FPS = %.2f Blocked: %d us RAM: %d bytes" or "Error: %s"
+            res = dut.expect(r"(Show (symbols|strip): FPS = ([\d.]+) Blocked: (\d+) us RAM: (\d+) bytes|Error: .*)", timeout=120)
+            assert res.group(2) is not None, "Error detected in test output: {}".format(res.group(0).decode("utf-8"))
+            impl = res.group(2).decode("utf-8")
+            fps = float(res.group(3).decode("utf-8"))
+            blocked = int(res.group(4).decode("utf-8"))
+            ram = int(res.group(5).decode("utf-8"))
+            assert fps > 0, "Invalid frame rate"
+            LOGGER.info("{}: FPS = {}. Blocked = {} us. RAM = {} bytes".format(impl, fps, blocked, ram))
+            runs_results.append((impl, (fps, blocked, ram)))
+
+    # Calculate averages for each implementation
+    sums = defaultdict(lambda: {"fps_sum": 0, "blocked_sum": 0, "ram_sum": 0})
+
+    for impl, (fps, blocked, ram) in runs_results:
+        sums[impl]["fps_sum"] += fps
+        sums[impl]["blocked_sum"] += blocked
+        sums[impl]["ram_sum"] += ram
+
+    # Flatten to canonical metrics list (see .github/CI_README.md)
+    metrics = []
+    for impl in sorted(sums):
+        v = sums[impl]
+        fps_avg = round(v["fps_sum"] / runs, 2)
+        blocked_avg = round(v["blocked_sum"] / runs, 2)
+        ram_avg = round(v["ram_sum"] / runs)
+        LOGGER.info(
+            "Test: {}: Average FPS = {}. Average blocked = {} us. Average RAM = {} bytes".format(impl, fps_avg, blocked_avg, ram_avg)
+        )
+        metrics.append({"name": "{}_avg_fps".format(impl), "value": fps_avg, "unit": "fps"})
+        metrics.append({"name": "{}_avg_blocked".format(impl), "value": blocked_avg, "unit": "us"})
+        metrics.append({"name": "{}_avg_ram".format(impl), "value": ram_avg, "unit": "bytes"})
+
+    results = {
+        "test_name": "led_strip",
+        "runs": runs,
+        "settings": "leds={}, frames={}".format(leds, frames),
+        "metrics": metrics,
+    }
+
+    current_folder = os.path.dirname(request.path)
+    os.makedirs(os.path.join(current_folder, dut.app.target), exist_ok=True)
+    file_index = 0
+    report_file = os.path.join(current_folder, dut.app.target, "result_led_strip" + str(file_index) + ".json")
+    while os.path.exists(report_file):
+        report_file = report_file.replace(str(file_index) + ".json", str(file_index + 1) + ".json")
+        file_index += 1
+
+    with open(report_file, "w+") as f:
+        try:
+            f.write(json.dumps(results))
+        except Exception as e:
+            LOGGER.warning("Failed to write results to file: {}".format(e))
@@ -0,0 +1,158 @@
+/*
+  SPI DMA benchmark.
+
+  Sends 320x240 RGB565 frames in 40 line bands, once with writePixels() which
+  feeds the SPI FIFO from the CPU, and once with queueBytes() from two DMA
+  buffers (double buffering). Reports the sustained throughput and the CPU
+  load of the sending task. The load is measured by counting a fixed piece of
+  work while the transfers run, compared to the same work on an idle bus.
+
+  Only the SCK and MOSI pins are driven, nothing needs to be connected.
+*/
+
+#include <Arduino.h>
+#include <SPI.h>
+
+// Test settings
+
+// Number of runs to average
+#define N_RUNS 3
+
+// Frames sent per case
+#define N_FRAMES 10
+
+#define SPI_FREQ 40000000
+
+#define FRAME_WIDTH  320
+#define FRAME_HEIGHT 240
+#define BAND_LINES   40
+#define BAND_BYTES   (FRAME_WIDTH * BAND_LINES * 2)
+#define N_BANDS      (FRAME_HEIGHT / BAND_LINES)
+
+// Iterations of the work loop between two checks
+#define WORK_CHUNK 64
+
+static uint8_t *band_buf[2] = {nullptr, nullptr};
+static volatile uint32_t bands_done = 0;
+static volatile uint32_t work_sink = 0;
+static float work_per_us = 0;
+
+static void band_done(void *arg) {
+  (void)arg;
+  bands_done = bands_done + 1;
+}
+
+static inline void work() {
+  for (int i = 0; i < WORK_CHUNK; i++) {
+    work_sink = work_sink + 1;
+  }
+}
+
+// Work chunks per microsecond on an idle bus
+static void calibrate() {
+  uint32_t chunks = 0;
+  uint32_t start_time = micros();
+  uint32_t cost_time;
+  while ((cost_time = micros() - start_time) < 100000) {
+    work();
+    chunks++;
+  }
+  work_per_us = (float)chunks / cost_time;
+}
+
+static void report(const char *impl, uint32_t cost_time, float load) {
+  double rate = (double)BAND_BYTES * N_BANDS * N_FRAMES / (cost_time ? cost_time : 1);  // bytes per us = MB/s
+  Serial.printf("Write %s: Rate = %.2f MB/s Time: %lu us CPU: %.1f %%\n", impl, rate, (unsigned long)cost_time, load);
+}
+
+static void run_cpu() {
+  SPI.beginTransaction(SPISettings(SPI_FREQ, MSBFIRST, SPI_MODE0));
+  uint32_t start_time = micros();
+  for (int f = 0; f < N_FRAMES; f++) {
+    for (int b = 0; b < N_BANDS; b++) {
+      SPI.writePixels(band_buf[b & 1], BAND_BYTES);
+    }
+  }
+  uint32_t cost_time = micros() - start_time;
+  SPI.endTransaction();
+  // the task spins on the FIFO the whole time
+  report("cpu", cost_time, 100.0);
+}
+
+static void run_dma() {
+  if (!SPI.beginDMA(BAND_BYTES, 2)) {
+    Serial.println("Error: beginDMA failed");
+    return;
+  }
+  SPI.beginTransaction(SPISettings(SPI_FREQ, MSBFIRST, SPI_MODE0));
+  bands_done = 0;
+  uint32_t queued = 0;
+  uint32_t chunks = 0;
+  uint32_t start_time = micros();
+  for (int f = 0; f < N_FRAMES; f++) {
+    for (int b = 0; b < N_BANDS; b++) {
+      // "render" into the free buffer while the other one is sent
+      while (bands_done + 1 < queued) {
+        work();
+        chunks++;
+      }
+      if (!SPI.queueBytes(band_buf[b & 1], BAND_BYTES, band_done)) {
+        Serial.println("Error: queueBytes failed");
+      }
+      queued++;
+    }
+  }
+  while (bands_done < queued) {
+    work();
+    chunks++;
+  }
+  uint32_t cost_time = micros() - start_time;
+  SPI.endTransaction();
+  SPI.endDMA();
+
+  float idle = chunks / (work_per_us * cost_time);
+  float load = (idle < 1.0f) ? 100.0f * (1.0f - idle) : 0.0f;
+  report("dma", cost_time, load);
+}
+
+/* Main */
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  band_buf[0] = (uint8_t *)SPI.allocDMA(BAND_BYTES);
+  band_buf[1] = (uint8_t *)SPI.allocDMA(BAND_BYTES);
+  if (!band_buf[0] || !band_buf[1]) {
+    Serial.println("Error: Failed to allocate DMA buffers");
+    return;
+  }
+  for (int i = 0; i < BAND_BYTES; i++) {
+    band_buf[0][i] = (uint8_t)i;
+    band_buf[1][i] = (uint8_t)~i;
+  }
+
+  SPI.begin();
+  calibrate();
+
+  Serial.printf("Runs: %u\n", N_RUNS);
+  Serial.printf("Size: %u\n", BAND_BYTES * N_BANDS * N_FRAMES);
+  Serial.printf("Frequency: %u\n", SPI_FREQ);
+  Serial.flush();
+  for (int i = 0; i < N_RUNS; i++) {
+    Serial.printf("Run %u\n", i);
+    run_cpu();
+    run_dma();
+    Serial.flush();
+  }
+
+  SPI.end();
+  SPI.freeDMA(band_buf[0]);
+  SPI.freeDMA(band_buf[1]);
+}
+
+void loop() {
+  vTaskDelete(NULL);
+}
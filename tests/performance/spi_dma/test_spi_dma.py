@@ -0,0 +1,90 @@
+import json
+import logging
+import os
+
+from collections import defaultdict
+
+
+def test_spi_dma(dut, request):
+    LOGGER = logging.getLogger(__name__)
+
+    runs_results = []
+
+    # Match "Runs: %d"
+    res = dut.expect(r"Runs: (\d+)", timeout=60)
+    runs = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Number of runs: {}".format(runs))
+    assert runs > 0, "Invalid number of runs"
+
+    # Match "Size: %d"
+    res = dut.expect(r"Size: (\d+)", timeout=60)
+    size = int(res.group(1).decode("utf-8"))
+    LOGGER.info("Bytes sent per case: {}".format(size))
+    assert size > 0, "Invalid size"
+
+    # Match "Frequency: %d"
+    res = dut.expect(r"Frequency: (\d+)", timeout=60)
+    frequency = int(res.group(1).decode("utf-8"))
+    LOGGER.info("SPI clock: {} Hz".format(frequency))
+
+    for i in range(runs):
+        # Match "Run %d"
+        res = dut.expect(r"Run (\d+)", timeout=120)
+        run = int(res.group(1).decode("utf-8"))
+        LOGGER.info("Run {}".format(run))
+        assert run == i, "Invalid run number"
+
+        for _ in range(2):
+            # Match "Write <cpu|dma>: Rate = %.2f MB/s Time: %d us CPU: %.1f %" or "Error: %s"
+            res = dut.expect(r"(Write (cpu|dma): Rate = ([\d.]+) MB/s Time: (\d+) us CPU: ([\d.]+) %|Error: .*)", timeout=120)
+            assert res.group(2) is not None, "Error detected in test output: {}".format(res.group(0).decode("utf-8"))
+            impl = res.group(2).decode("utf-8")
+            rate = float(res.group(3).decode("utf-8"))
+            time = int(res.group(4).decode("utf-8"))
+            load = float(res.group(5).decode("utf-8"))
+            assert rate > 0, "Invalid rate"
+            LOGGER.info("{}: Rate = {} MB/s. Time = {} us. CPU = {} %".format(impl, rate, time, load))
+            runs_results.append((impl, (rate, time, load)))
+
+    # Calculate averages for each implementation
+    sums = defaultdict(lambda: {"rate_sum": 0, "time_sum": 0, "load_sum": 0})
+
+    for impl, (rate, time, load) in runs_results:
+        sums[impl]["rate_sum"] += rate
+        sums[impl]["time_sum"] += time
+        sums[impl]["load_sum"] += load
+
+    # Flatten to canonical metrics list (see .github/CI_README.md)
+    metrics = []
+    for impl in sorted(sums):
+        v = sums[impl]
+        rate_avg = round(v["rate_sum"] / runs, 2)
+        time_avg = round(v["time_sum"] / runs, 2)
+        load_avg = round(v["load_sum"] / runs, 1)
+        LOGGER.info(
+            "Test: {}: Average rate = {} MB/s. Average time = {} us. Average CPU = {} %".format(impl, rate_avg, time_avg, load_avg)
+        )
+        metrics.append({"name": "{}_avg_rate".format(impl), "value": rate_avg, "unit": "MB/s"})
+        metrics.append({"name": "{}_avg_time".format(impl), "value": time_avg, "unit": "us"})
+        metrics.append({"name": "{}_avg_cpu".format(impl), "value": load_avg, "unit": "%"})
+
+    results = {
+        "test_name": "spi_dma",
+        "runs": runs,
+        "settings": "size={}, frequency={}".format(size, frequency),
+        "metrics": metrics,
+    }
+
+    current_folder = os.path.dirname(request.path)
+    os.makedirs(os.path.join(current_folder, dut.app.target), exist_ok=True)
+    file_index = 0
+    report_file = os.path.join(current_folder, dut.app.target, "result_spi_dma" + str(file_index) + ".json")
+    while os.path.exists(report_file):
+        report_file = report_file.replace(str(file_index) + ".json", str(file_index + 1) + ".json")
+        file_index += 1
+
+    with open(report_file, "w+") as f:
+        try:
+            f.write(json.dumps(results))
+        except Exception as e:
+            LOGGER.warning("Failed to write results to file: {}".format(e))
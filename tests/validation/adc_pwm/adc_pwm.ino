@@ -149,6 +149,78 @@ void test_ledc_fade(void) {
   ledcDetach(LEDC_PIN);
 }
 
+void test_ledc_write_batch(void) {
+  // SIGMADELTA_PIN is free while the LEDC tests run
+  const uint8_t pins[2] = {LEDC_PIN, SIGMADELTA_PIN};
+  TEST_ASSERT_TRUE(ledcAttach(LEDC_PIN, LEDC_FREQ, LEDC_RES));
+  TEST_ASSERT_TRUE(ledcAttach(SIGMADELTA_PIN, LEDC_FREQ, LEDC_RES));
+
+  const uint32_t low[2] = {10, 20};
+  TEST_ASSERT_TRUE(ledcWriteMulti(pins, low, 2));
+  delay(1);
+  TEST_ASSERT_EQUAL(10, ledcRead(LEDC_PIN));
+  TEST_ASSERT_EQUAL(20, ledcRead(SIGMADELTA_PIN));
+
+  // staged duties are not applied before the commit
+  TEST_ASSERT_TRUE(ledcWriteStage(LEDC_PIN, 100));
+  TEST_ASSERT_TRUE(ledcWriteStage(SIGMADELTA_PIN, 200));
+  delay(1);
+  TEST_ASSERT_EQUAL(10, ledcRead(LEDC_PIN));
+  TEST_ASSERT_EQUAL(20, ledcRead(SIGMADELTA_PIN));
+
+  TEST_ASSERT_TRUE(ledcWriteCommit());
+  delay(1);
+  TEST_ASSERT_EQUAL(100, ledcRead(LEDC_PIN));
+  TEST_ASSERT_EQUAL(200, ledcRead(SIGMADELTA_PIN));
+  TEST_ASSERT_FALSE(ledcWriteCommit());
+
+  ledcDetach(SIGMADELTA_PIN);
+  ledcDetach(LEDC_PIN);
+}
+
+static volatile uint32_t scheduled_fades_done = 0;
+
+static void scheduled_fade_done(void *arg) {
+  scheduled_fades_done += (uint32_t)(intptr_t)arg;
+}
+
+void test_ledc_scheduled_fade(void) {
+  TEST_ASSERT_TRUE(ledcAttach(LEDC_PIN, LEDC_FREQ, LEDC_RES));
+  TEST_ASSERT_TRUE(ledcAttach(SIGMADELTA_PIN, LEDC_FREQ, LEDC_RES));
+  scheduled_fades_done = 0;
+
+  TEST_ASSERT_TRUE(ledcScheduleFade(LEDC_PIN, 0, 200, 300, scheduled_fade_done, (void *)1));
+  TEST_ASSERT_TRUE(ledcScheduleFade(SIGMADELTA_PIN, 200, 0, 600, scheduled_fade_done, (void *)2));
+  TEST_ASSERT_TRUE(ledcScheduledFadeRunning(LEDC_PIN));
+
+  // half way through the first fade
+  delay(150);
+  TEST_ASSERT_UINT32_WITHIN(30, 100, ledcRead(LEDC_PIN));
+  TEST_ASSERT_UINT32_WITHIN(30, 150, ledcRead(SIGMADELTA_PIN));
+
+  delay(250);
+  TEST_ASSERT_EQUAL(1, scheduled_fades_done);
+  TEST_ASSERT_FALSE(ledcScheduledFadeRunning(LEDC_PIN));
+  TEST_ASSERT_EQUAL(200, ledcRead(LEDC_PIN));
+
+  // the second fade stops where it is
+  TEST_ASSERT_TRUE(ledcCancelScheduledFade(SIGMADELTA_PIN));
+  uint32_t duty = ledcRead(SIGMADELTA_PIN);
+  delay(300);
+  TEST_ASSERT_EQUAL(duty, ledcRead(SIGMADELTA_PIN));
+  TEST_ASSERT_EQUAL(1, scheduled_fades_done);
+  TEST_ASSERT_FALSE(ledcCancelScheduledFade(SIGMADELTA_PIN));
+
+  // the cancel stopped the last fade, a new one starts the fade timer again
+  TEST_ASSERT_TRUE(ledcScheduleFade(LEDC_PIN, 200, 0, 100, scheduled_fade_done, (void *)4));
+  delay(200);
+  TEST_ASSERT_EQUAL(5, scheduled_fades_done);
+  TEST_ASSERT_EQUAL(0, ledcRead(LEDC_PIN));
+
+  ledcDetach(SIGMADELTA_PIN);
+  ledcDetach(LEDC_PIN);
+}
+
 void test_ledc_tone(void) {
   TEST_ASSERT_TRUE(ledcAttach(LEDC_PIN, LEDC_FREQ, LEDC_RES));
   uint32_t freq = ledcWriteTone(LEDC_PIN, 440);
@@ -193,6 +265,8 @@ void setup() {
   RUN_TEST(test_ledc_read_freq);
   RUN_TEST(test_ledc_change_frequency);
   RUN_TEST(test_ledc_fade);
+  RUN_TEST(test_ledc_write_batch);
+  RUN_TEST(test_ledc_scheduled_fade);
   RUN_TEST(test_ledc_tone);
 #endif
 
@@ -25,6 +25,12 @@ volatile int argInterruptCounter = 0;
 volatile bool argInterruptFlag = false;
 volatile int receivedArg = 0;
 
+// Variables for deferred interrupt test
+volatile int deferredEventCount = 0;
+volatile bool deferredInIsr = false;
+volatile int deferredLevels[8];
+volatile uint32_t deferredCycles[8];
+
 void waitForSyncAck(const String &token = "OK") {
   while (true) {
     String response = Serial.readStringUntil('\n');
@@ -42,6 +48,8 @@ void setUp(void) {
   argInterruptCounter = 0;
   argInterruptFlag = false;
   receivedArg = 0;
+  deferredEventCount = 0;
+  deferredInIsr = false;
 }
 
 void tearDown(void) {}
@@ -213,6 +221,47 @@ void test_interrupt_with_arg(void) {
   waitForSyncAck();
 }
 
+void buttonDeferred(const gpio_event_t *event, void *arg) {
+  int n = deferredEventCount;
+  if (xPortInIsrContext()) {
+    deferredInIsr = true;
+  }
+  if (n < 8 && event->pin == *(int *)arg) {
+    deferredLevels[n] = event->level;
+    deferredCycles[n] = event->cycles;
+  }
+  deferredEventCount = n + 1;
+}
+
+void test_interrupt_deferred(void) {
+  pinMode(BTN, INPUT_PULLUP);
+
+  int pin = BTN;
+  attachInterruptDeferred(digitalPinToInterrupt(BTN), buttonDeferred, &pin, CHANGE);
+  Serial.println("Testing deferred interrupt");
+
+  for (int i = 1; i <= 6; i++) {
+    waitForSyncAck("OK:" + String(i));
+    // the handler runs in the event task, shortly after the edge
+    for (int t = 0; t < 100 && deferredEventCount < i; t++) {
+      delay(1);
+    }
+    TEST_ASSERT_EQUAL(i, deferredEventCount);
+    TEST_ASSERT_FALSE(deferredInIsr);
+    // pressed (odd) pulls the pin LOW, released (even) lets it go HIGH
+    TEST_ASSERT_EQUAL(i % 2 ? LOW : HIGH, deferredLevels[i - 1]);
+    if (i > 1) {
+      TEST_ASSERT_TRUE((int32_t)(deferredCycles[i - 1] - deferredCycles[i - 2]) > 0);
+    }
+    Serial.println(String(i) + " deferred interrupt worked");
+  }
+  TEST_ASSERT_EQUAL(0, gpioGetEventOverruns(true));
+
+  detachInterrupt(digitalPinToInterrupt(BTN));
+  Serial.println("Testing deferred interrupt END");
+  waitForSyncAck();
+}
+
 void test_read_pulldown(void) {
   pinMode(BTN, INPUT_PULLDOWN);
   delay(10);
@@ -262,6 +311,7 @@ void setup() {
 
   RUN_TEST(test_interrupt_change);
   RUN_TEST(test_interrupt_with_arg);
+  RUN_TEST(test_interrupt_deferred);
 
   UNITY_END();
   Serial.println("GPIO test END");
@@ -102,6 +102,22 @@ def test_gpio(dut: Dut, wokwi: Wokwi):
         wokwi.client.serial_write("OK\n")
         LOGGER.info("GPIO interrupt with argument test passed.")
 
+    def test_interrupt_deferred():
+        dut.expect_exact("Testing deferred interrupt")
+
+        for i in range(1, 4):
+            wokwi.client.set_control("btn1", "pressed", 1)
+            wokwi.client.serial_write(f"OK:{i * 2 - 1}\n")
+            dut.expect_exact(f"{i * 2 - 1} deferred interrupt worked")
+
+            wokwi.client.set_control("btn1", "pressed", 0)
+            wokwi.client.serial_write(f"OK:{i * 2}\n")
+            dut.expect_exact(f"{i * 2} deferred interrupt worked")
+
+        dut.expect_exact("Testing deferred interrupt END")
+        wokwi.client.serial_write("OK\n")
+        LOGGER.info("GPIO deferred interrupt test passed.")
+
     def test_read_pulldown():
         dut.expect_exact("BTN read as LOW after pinMode INPUT_PULLDOWN")
         dut.expect_exact("BTN back to HIGH after INPUT_PULLUP")
@@ -132,4 +148,5 @@ def test_gpio(dut: Dut, wokwi: Wokwi):
     test_interrupt_rising()
     test_interrupt_change()
     test_interrupt_with_arg()
+    test_interrupt_deferred()
     LOGGER.info("GPIO test END")
@@ -1,7 +1,8 @@
 /*
  * Validation test for Hash library, MD5Builder, HEXBuilder, and HashBuilder.
  * Uses Unity framework with known-answer test vectors from
- * NIST FIPS 180-4, FIPS 202, RFC 1321, and RFC 6070.
+ * NIST FIPS 180-4, FIPS 202, RFC 1321, RFC 6070 and RFC 7914.
+ * PBKDF2 vectors without an RFC match OpenSSL PKCS5_PBKDF2_HMAC.
  */
 
 #include <Arduino.h>
@@ -569,6 +570,117 @@ void test_pbkdf2_setters(void) {
   TEST_ASSERT_EQUAL_STRING("33044695f8609480da53f5241212296156533fee38da64c2149fcf308c36952c", pbkdf2.toString().c_str());
 }
 
+void test_pbkdf2_sha256_rfc7914(void) {
+  // RFC 7914 section 11, first 32 bytes of the 64 byte key
+  SHA256Builder sha256;
+  PBKDF2_HMACBuilder pbkdf2(&sha256, "passwd", "salt", 1);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc", pbkdf2.toString().c_str());
+}
+
+void test_pbkdf2_sha512_c1(void) {
+  // SHA-512 uses a 128 byte HMAC block
+  SHA512Builder sha512;
+  PBKDF2_HMACBuilder pbkdf2(&sha512, "password", "salt", 1);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING(
+    "867f70cf1ade02cff3752599a3a53dc4af34c7a669815ae5d513554e1c8cf252c02d470a285a0501bad999bfe943c08f050235d7d68b1da55e63f73b60a57fce",
+    pbkdf2.toString().c_str()
+  );
+}
+
+void test_pbkdf2_sha512_c2(void) {
+  SHA512Builder sha512;
+  PBKDF2_HMACBuilder pbkdf2(&sha512, "password", "salt", 2);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING(
+    "e1d9c16aa681708a45f5c7c4e215ceb66e011a2e9f0040713f18aefdb866d53cf76cab2868a39b9f7840edce4fef5a82be67335c77a6068e04112754f27ccf4e",
+    pbkdf2.toString().c_str()
+  );
+}
+
+void test_pbkdf2_sha512_c4096(void) {
+  SHA512Builder sha512;
+  PBKDF2_HMACBuilder pbkdf2(&sha512, "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING(
+    "8c0511f4c6e597c6ac6315d8f0362e225f3c501495ba23b868c005174dc4ee71115b59f9e60cd9532fa33e0f75aefe30225c583a186cd82bd4daea9724a3d3b8",
+    pbkdf2.toString().c_str()
+  );
+}
+
+void test_pbkdf2_sha384_c1(void) {
+  // SHA-384 shares the 128 byte block of SHA-512
+  SHA384Builder sha384;
+  PBKDF2_HMACBuilder pbkdf2(&sha384, "password", "salt", 1);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING(
+    "c0e14f06e49e32d73f9f52ddf1d0c5c7191609233631dadd76a567db42b78676b38fc800cc53ddb642f5c74442e62be4", pbkdf2.toString().c_str()
+  );
+}
+
+void test_pbkdf2_sha3_256_c4096(void) {
+  // SHA3-256 uses its 136 byte rate as the HMAC block (FIPS 202 / NIST SP 800-185)
+  SHA3_256Builder sha3;
+  PBKDF2_HMACBuilder pbkdf2(&sha3, "password", "salt", 4096);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("778b6e237a0f49621549ff70d218d2080756b9fb38d71b5d7ef447fa2254af61", pbkdf2.toString().c_str());
+}
+
+void test_pbkdf2_sha512_legacy_block(void) {
+  // Releases up to 3.3.11 used a 64 byte HMAC block for every algorithm
+  SHA512Builder sha512;
+  PBKDF2_HMACBuilder pbkdf2(&sha512, "password", "salt", 1);
+  pbkdf2.setLegacyBlockSize(true);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING(
+    "07686e421487972c841e5472053ac21f6ee2f7ecd73d89f8ac2a55b26d28916f938e28bd0c7a16946c53b2297f150bba708fb26b80ba3f5ea64e3710ebc16a2f",
+    pbkdf2.toString().c_str()
+  );
+}
+
+void test_pbkdf2_sha256_long_password(void) {
+  // Password longer than the HMAC block is hashed first
+  SHA256Builder sha256;
+  String password = "passwordPASSWORDpassword";
+  PBKDF2_HMACBuilder pbkdf2(&sha256, password + password + password + password, "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("15eaf92a9dbcd409c20d8efc38b2804b3b502797892487512d5321fb5fc879c6", pbkdf2.toString().c_str());
+}
+
+// ==================== Midstates ====================
+
+void test_sha256_clone_midstate(void) {
+  SHA256Builder h;
+  h.begin();
+  h.add("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+  HashBuilder *midstate = h.clone();
+  TEST_ASSERT_NOT_NULL(midstate);
+  TEST_ASSERT_EQUAL(64, (int)h.getBlockSize());
+
+  // Finish the original, then continue a second time from the snapshot
+  h.calculate();
+  String full = h.toString();
+  TEST_ASSERT_TRUE(h.copyStateFrom(*midstate));
+  h.calculate();
+  TEST_ASSERT_EQUAL_STRING(full.c_str(), h.toString().c_str());
+  TEST_ASSERT_EQUAL_STRING("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", full.c_str());
+
+  // States of another algorithm are refused
+  SHA1Builder other;
+  other.begin();
+  TEST_ASSERT_FALSE(h.copyStateFrom(other));
+  delete midstate;
+}
+
 // ==================== SHA-2 padding boundaries ====================
 
 void test_sha256_55bytes(void) {
@@ -718,6 +830,17 @@ void setup() {
   RUN_TEST(test_pbkdf2_sha256_c1);
   RUN_TEST(test_pbkdf2_sha1_c4096);
   RUN_TEST(test_pbkdf2_setters);
+  RUN_TEST(test_pbkdf2_sha256_rfc7914);
+  RUN_TEST(test_pbkdf2_sha512_c1);
+  RUN_TEST(test_pbkdf2_sha512_c2);
+  RUN_TEST(test_pbkdf2_sha512_c4096);
+  RUN_TEST(test_pbkdf2_sha384_c1);
+  RUN_TEST(test_pbkdf2_sha3_256_c4096);
+  RUN_TEST(test_pbkdf2_sha512_legacy_block);
+  RUN_TEST(test_pbkdf2_sha256_long_password);
+
+  // Midstates
+  RUN_TEST(test_sha256_clone_midstate);
 
   // Padding boundaries
   RUN_TEST(test_sha256_55bytes);
@@ -309,6 +309,62 @@ void request_from_undersized_buffer() {
   TEST_ASSERT_EQUAL(I2C_BUFFER_LENGTH, Wire.setBufferSize(I2C_BUFFER_LENGTH));
 }
 
+void run_job() {
+  const uint8_t ram[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+  uint8_t time_regs[7] = {};
+  TwoWireJob job(4, 16);
+
+  // DS1307 RAM starts at register 0x08
+  int w = job.writeRegister(DS1307_ADDR, 0x08, ram, sizeof(ram));
+  int r = job.readRegister(DS1307_ADDR, 0x08, NULL, sizeof(ram));
+  int t = job.readRegister(DS1307_ADDR, 0x00, time_regs, sizeof(time_regs));
+  int missing = job.write(0x13, NULL, 0);  // nothing at this address
+  TEST_ASSERT_EQUAL(4, job.count());
+  TEST_ASSERT_EQUAL(-1, job.read(DS1307_ADDR, time_regs, 1));  // full
+
+  // the missing device fails on its own, the other transactions still run
+  TEST_ASSERT_NOT_EQUAL(0, Wire.run(job));
+  TEST_ASSERT_EQUAL(ESP_OK, job.result(w));
+  TEST_ASSERT_EQUAL(ESP_OK, job.result(r));
+  TEST_ASSERT_EQUAL(ESP_OK, job.result(t));
+  TEST_ASSERT_NOT_EQUAL(ESP_OK, job.result(missing));
+  TEST_ASSERT_EQUAL_MEMORY(ram, job.data(r), sizeof(ram));
+
+  ds1307_get_time(&read_sec, &read_min, &read_hour, &read_day, &read_month, &read_year);
+  TEST_ASSERT_EQUAL(read_min, BCD2DEC(time_regs[1]));
+  TEST_ASSERT_EQUAL(read_day, BCD2DEC(time_regs[4]));
+}
+
+static volatile int job_runs = 0;
+static volatile bool job_busy_in_callback = false;
+
+static void poll_again(TwoWireJob &job) {
+  job_runs = job_runs + 1;
+  job_busy_in_callback = job.busy();
+  if (job_runs < 3) {
+    Wire.runAsync(job, poll_again);
+  }
+}
+
+void run_job_async() {
+  const uint8_t ram[2] = {0x12, 0x34};
+  TwoWireJob write_job(1, 4);
+  write_job.writeRegister(DS1307_ADDR, 0x08, ram, sizeof(ram));
+  TEST_ASSERT_EQUAL(0, Wire.run(write_job));
+
+  // poll the same job three times, queued again from its callback
+  TwoWireJob job(1, 4);
+  int r = job.readRegister(DS1307_ADDR, 0x08, NULL, sizeof(ram));
+  job_runs = 0;
+  TEST_ASSERT_TRUE(Wire.runAsync(job, poll_again));
+  TEST_ASSERT_TRUE(job.wait(1000));
+  TEST_ASSERT_EQUAL(3, job_runs);
+  TEST_ASSERT_TRUE(job_busy_in_callback);  // not released before its callback returned
+  TEST_ASSERT_FALSE(job.busy());
+  TEST_ASSERT_EQUAL(ESP_OK, job.error());
+  TEST_ASSERT_EQUAL_MEMORY(ram, job.data(r), sizeof(ram));
+}
+
 #if SOC_WIFI_SUPPORTED
 void scan_bus_with_wifi() {
   // delete old config
@@ -346,6 +402,8 @@ void setup() {
   RUN_TEST(swap_pins);
   RUN_TEST(test_api);
   RUN_TEST(request_from_undersized_buffer);
+  RUN_TEST(run_job);
+  RUN_TEST(run_job_async);
   UNITY_END();
 }
 
@@ -0,0 +1,157 @@
+/*
+ * I2C Slave Register Map Validation Test -- Master (multi-DUT, generic_multi_device)
+ *
+ * Waits for START, then reads and writes the register map of the slave
+ * board with Unity tests. Afterwards it prints how many register reads and
+ * writes it made, which the orchestrator compares with the statistics of
+ * the slave.
+ *
+ * Pin-to-pin mapping (generic_multi_device): see ../pins_config.h
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <unity.h>
+#include "../pins_config.h"
+
+// transactions the slave has to count: reads end with a STOP, writes carry data after the register
+static uint32_t reg_reads = 0;
+static uint32_t reg_writes = 0;
+
+static bool read_registers(uint8_t reg, uint8_t *out, size_t len) {
+  Wire.beginTransmission(I2C_TEST_ADDR);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) {
+    return false;
+  }
+  size_t n = Wire.requestFrom((uint8_t)I2C_TEST_ADDR, len);
+  reg_reads++;
+  if (n != len) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    out[i] = Wire.read();
+  }
+  return true;
+}
+
+static bool write_registers(uint8_t reg, const uint8_t *data, size_t len) {
+  Wire.beginTransmission(I2C_TEST_ADDR);
+  Wire.write(reg);
+  Wire.write(data, len);
+  bool ok = Wire.endTransmission() == 0;
+  reg_writes++;
+  // the slave stores the bytes on the STOP
+  delay(2);
+  return ok;
+}
+
+static uint8_t read_only_value(uint8_t reg) {
+  return 0xA0 + reg;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_read_only_registers(void) {
+  uint8_t regs[I2C_TEST_RO_COUNT];
+  TEST_ASSERT_TRUE(read_registers(0, regs, sizeof(regs)));
+  for (uint8_t i = 0; i < I2C_TEST_RO_COUNT; i++) {
+    TEST_ASSERT_EQUAL_HEX8(read_only_value(i), regs[i]);
+  }
+}
+
+void test_read_single_register(void) {
+  uint8_t value = 0;
+  TEST_ASSERT_TRUE(read_registers(3, &value, 1));
+  TEST_ASSERT_EQUAL_HEX8(read_only_value(3), value);
+}
+
+void test_write_and_read_back(void) {
+  const uint8_t data[] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+  uint8_t back[sizeof(data)] = {0};
+  TEST_ASSERT_TRUE(write_registers(I2C_TEST_RO_COUNT, data, sizeof(data)));
+  TEST_ASSERT_TRUE(read_registers(I2C_TEST_RO_COUNT, back, sizeof(back)));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(data, back, sizeof(data));
+}
+
+void test_write_single_register(void) {
+  const uint8_t reg = I2C_TEST_REG_COUNT - 8;
+  uint8_t value = 0x5A;
+  uint8_t back = 0;
+  TEST_ASSERT_TRUE(write_registers(reg, &value, 1));
+  TEST_ASSERT_TRUE(read_registers(reg, &back, 1));
+  TEST_ASSERT_EQUAL_HEX8(value, back);
+}
+
+void test_read_only_write_dropped(void) {
+  uint8_t value = 0xFF;
+  uint8_t back = 0;
+  TEST_ASSERT_TRUE(write_registers(1, &value, 1));
+  TEST_ASSERT_TRUE(read_registers(1, &back, 1));
+  TEST_ASSERT_EQUAL_HEX8(read_only_value(1), back);
+}
+
+void test_read_wraps_at_end(void) {
+  const uint8_t data[] = {0xC1, 0xC2};
+  uint8_t back[4] = {0};
+  TEST_ASSERT_TRUE(write_registers(I2C_TEST_REG_COUNT - 2, data, sizeof(data)));
+  TEST_ASSERT_TRUE(read_registers(I2C_TEST_REG_COUNT - 2, back, sizeof(back)));
+  TEST_ASSERT_EQUAL_HEX8(0xC1, back[0]);
+  TEST_ASSERT_EQUAL_HEX8(0xC2, back[1]);
+  TEST_ASSERT_EQUAL_HEX8(read_only_value(0), back[2]);
+  TEST_ASSERT_EQUAL_HEX8(read_only_value(1), back[3]);
+}
+
+void test_write_wraps_at_end(void) {
+  // the write goes on at register 0: the read-only registers drop their bytes, the first writable one stores the last
+  uint8_t data[2 + I2C_TEST_RO_COUNT + 1];
+  uint8_t back[sizeof(data)] = {0};
+  for (uint8_t i = 0; i < sizeof(data); i++) {
+    data[i] = 0xD0 + i;
+  }
+  TEST_ASSERT_TRUE(write_registers(I2C_TEST_REG_COUNT - 2, data, sizeof(data)));
+  TEST_ASSERT_TRUE(read_registers(I2C_TEST_REG_COUNT - 2, back, sizeof(back)));
+  TEST_ASSERT_EQUAL_HEX8(data[0], back[0]);
+  TEST_ASSERT_EQUAL_HEX8(data[1], back[1]);
+  for (uint8_t i = 0; i < I2C_TEST_RO_COUNT; i++) {
+    TEST_ASSERT_EQUAL_HEX8(read_only_value(i), back[2 + i]);
+  }
+  TEST_ASSERT_EQUAL_HEX8(data[sizeof(data) - 1], back[sizeof(back) - 1]);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  if (!Wire.begin(I2C_TEST_SDA, I2C_TEST_SCL, I2C_TEST_FREQUENCY)) {
+    Serial.println("[MASTER] Wire.begin() failed");
+  }
+  Serial.println("[MASTER] Ready");
+
+  // the slave has to be up before the first transaction
+  String cmd;
+  while (cmd != "START") {
+    cmd = Serial.readStringUntil('\n');
+    cmd.trim();
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_read_only_registers);
+  RUN_TEST(test_read_single_register);
+  RUN_TEST(test_write_and_read_back);
+  RUN_TEST(test_write_single_register);
+  RUN_TEST(test_read_only_write_dropped);
+  RUN_TEST(test_read_wraps_at_end);
+  RUN_TEST(test_write_wraps_at_end);
+  UNITY_END();
+
+  Serial.printf("[MASTER] DONE reads=%lu writes=%lu\n", (unsigned long)reg_reads, (unsigned long)reg_writes);
+}
+
+void loop() {
+  vTaskDelete(NULL);
+}
@@ -0,0 +1,39 @@
+/*
+ * Per-target GPIO selection for i2c_slave (generic_multi_device).
+ *
+ * The bus runs over the BCLK<->BCLK and WS<->WS wires of the i2s test
+ * (see ../i2s/pins_config.h), so it needs no extra wiring on the runner.
+ * Master and slave use the same GPIO numbers (pin-to-pin wiring) and
+ * the internal pull-ups.
+ */
+
+#ifndef I2C_SLAVE_PINS_CONFIG_H
+#define I2C_SLAVE_PINS_CONFIG_H
+
+#if CONFIG_IDF_TARGET_ESP32
+#define I2C_TEST_SDA 4
+#define I2C_TEST_SCL 13
+#elif CONFIG_IDF_TARGET_ESP32C5
+#define I2C_TEST_SDA 1
+#define I2C_TEST_SCL 9
+#elif CONFIG_IDF_TARGET_ESP32C6
+#define I2C_TEST_SDA 6
+#define I2C_TEST_SCL 7
+#elif CONFIG_IDF_TARGET_ESP32P4
+#define I2C_TEST_SDA 20
+#define I2C_TEST_SCL 21
+#elif CONFIG_IDF_TARGET_ESP32S2 || CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32H2
+#define I2C_TEST_SDA 4
+#define I2C_TEST_SCL 5
+#else
+#error "i2c_slave: add pins for this target in pins_config.h"
+#endif
+
+#define I2C_TEST_ADDR      0x55
+#define I2C_TEST_FREQUENCY 100000
+
+// register map of the slave: I2C_TEST_RO_COUNT read-only registers holding their index plus 0xA0
+#define I2C_TEST_REG_COUNT 32
+#define I2C_TEST_RO_COUNT  8
+
+#endif /* I2C_SLAVE_PINS_CONFIG_H */
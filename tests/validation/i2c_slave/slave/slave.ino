@@ -0,0 +1,70 @@
+/*
+ * I2C Slave Register Map Validation Test -- Slave (multi-DUT, generic_multi_device)
+ *
+ * Serves a register map of I2C_TEST_REG_COUNT registers from the interrupt,
+ * the first I2C_TEST_RO_COUNT of them read-only. On serial commands it
+ * reports the slave statistics and the register contents.
+ *
+ * Pin-to-pin mapping (generic_multi_device): see ../pins_config.h
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "../pins_config.h"
+
+static uint8_t regs[I2C_TEST_REG_COUNT];
+static volatile uint32_t write_callbacks = 0;
+
+static void on_register_write(uint8_t reg, size_t len) {
+  write_callbacks++;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  for (uint8_t i = 0; i < I2C_TEST_RO_COUNT; i++) {
+    regs[i] = 0xA0 + i;
+  }
+  bool ok = Wire.begin((uint8_t)I2C_TEST_ADDR, I2C_TEST_SDA, I2C_TEST_SCL, I2C_TEST_FREQUENCY);
+  Wire.onRegisterWrite(on_register_write);
+  ok = ok && Wire.setRegisterMap(regs, sizeof(regs), I2C_TEST_RO_COUNT);
+  if (!ok) {
+    Serial.println("[SLAVE] Register map setup failed");
+  }
+
+  Serial.println("[SLAVE] Ready");
+}
+
+void loop() {
+  if (Serial.available()) {
+    String cmd = Serial.readStringUntil('\n');
+    cmd.trim();
+
+    if (cmd == "STATS" || cmd == "STATS_RESET") {
+      i2c_slave_stats_t stats;
+      if (!Wire.getSlaveStats(stats, cmd == "STATS_RESET")) {
+        Serial.println("[SLAVE] STATS failed");
+        return;
+      }
+      Serial.printf(
+        "[SLAVE] STATS reads=%lu writes=%lu requests=%lu dropped=%lu callbacks=%lu\n", (unsigned long)stats.reg_reads, (unsigned long)stats.reg_writes,
+        (unsigned long)stats.requests, (unsigned long)stats.rx_dropped, (unsigned long)write_callbacks
+      );
+    } else if (cmd == "REGS") {
+      Serial.print("[SLAVE] REGS");
+      for (uint8_t i = 0; i < I2C_TEST_REG_COUNT; i++) {
+        Serial.printf(" %02X", regs[i]);
+      }
+      Serial.println();
+    } else if (cmd == "DONE") {
+      Serial.println("[SLAVE] DONE");
+      while (true) {
+        delay(1000);
+      }
+    }
+  }
+  delay(10);
+}
@@ -0,0 +1,52 @@
+import logging
+
+STATS_RE = r"\[SLAVE\] STATS reads=(\d+) writes=(\d+) requests=(\d+) dropped=(\d+) callbacks=(\d+)"
+
+
+def _g(match, n):
+    """Decode a match group to int (pexpect may return bytes)."""
+    v = match.group(n)
+    return int(v.decode() if isinstance(v, bytes) else v)
+
+
+def test_i2c_slave(dut):
+    LOGGER = logging.getLogger(__name__)
+
+    master = dut[0]
+    slave = dut[1]
+
+    LOGGER.info("Waiting for devices to be ready...")
+    master.expect_exact("[MASTER] Ready", timeout=120)
+    slave.expect_exact("[SLAVE] Ready", timeout=120)
+
+    master.write("START")
+    master.expect_unity_test_output(timeout=120)
+    m = master.expect(r"\[MASTER\] DONE reads=(\d+) writes=(\d+)", timeout=10)
+    reads, writes = _g(m, 1), _g(m, 2)
+    LOGGER.info(f"Master made {reads} register reads and {writes} register writes")
+
+    # the counters are written by the interrupt, read them and reset them in one go
+    slave.write("STATS_RESET")
+    m = slave.expect(STATS_RE, timeout=10)
+    assert _g(m, 1) == reads, f"slave counted {_g(m, 1)} register reads, master made {reads}"
+    assert _g(m, 2) == writes, f"slave counted {_g(m, 2)} register writes, master made {writes}"
+    assert _g(m, 3) == 0, "onRequest() must not run in register map mode"
+    assert _g(m, 4) == 0, f"{_g(m, 4)} received bytes dropped"
+    assert _g(m, 5) == writes, f"onRegisterWrite() ran {_g(m, 5)} times for {writes} writes"
+
+    slave.write("STATS")
+    m = slave.expect(STATS_RE, timeout=10)
+    assert (_g(m, 1), _g(m, 2), _g(m, 3), _g(m, 4)) == (0, 0, 0, 0), "counters not reset"
+
+    # the read-only registers are unchanged, the last write ended in the first writable register
+    slave.write("REGS")
+    m = slave.expect(r"\[SLAVE\] REGS((?: [0-9A-F]{2})+)", timeout=10)
+    regs = m.group(1)
+    regs = [int(x, 16) for x in (regs.decode() if isinstance(regs, bytes) else regs).split()]
+    assert regs[:8] == [0xA0 + i for i in range(8)], f"read-only registers changed: {regs[:8]}"
+    assert regs[8] == 0xDA, f"register 8 is {regs[8]:#04x}"
+
+    slave.write("DONE")
+    slave.expect_exact("[SLAVE] DONE", timeout=10)
+
+    LOGGER.info("I2C slave register map test passed!")
@@ -2,7 +2,8 @@
  * OTA Validation Test (unsigned workflow)
  *
  * Covers: HTTPUpdate (download, verify success/failure, MD5 check),
- *         Update API (begin, write, end, abort, error handling),
+ *         Update API (begin, write, end, abort, error handling, pipelined writer,
+ *         compressed and delta packages),
  *         ArduinoOTA (begin/end, hostname, espota upload IPv4/IPv6, with/without auth).
  *
  * WiFi credentials and HTTP server URL are received via serial from pytest.
@@ -22,12 +23,20 @@
 #include <Update.h>
 #include <ArduinoOTA.h>
 #include <unity.h>
+#include "esp_ota_ops.h"
+#include "esp_image_format.h"
 
 #define WIFI_TIMEOUT_MS        15000
 #define IPV6_WAIT_MS           10000
 #define ARDUINO_OTA_PORT       3232
 #define ARDUINO_OTA_TIMEOUT_MS 120000
 
+// Local Update throughput: TCP sized chunks with a simulated receive time per chunk
+#define OTA_TP_SIZE    (512 * 1024)
+#define OTA_TP_CHUNK   1436
+#define OTA_TP_LINK_US 1000
+#define OTA_TP_BUFFERS 3
+
 static String wifi_ssid;
 static String wifi_pass;
 static String server_url;
@@ -177,6 +186,91 @@ void test_update_md5_check(void) {
   Update.abort();
 }
 
+static uint8_t throughputPattern(size_t pos) {
+  return pos == 0 ? ESP_IMAGE_HEADER_MAGIC : (uint8_t)(pos * 31 + 7);
+}
+
+static void printThroughput(const char *name, size_t bytes, uint32_t elapsed_us) {
+  uint32_t kib_s = elapsed_us ? (uint32_t)((uint64_t)bytes * 1000000ULL / 1024 / elapsed_us) : 0;
+  // Pytest collects these lines into the log summary
+  Serial.printf("OTA_THROUGHPUT %s %lu KiB/s\n", name, (unsigned long)kib_s);
+}
+
+// Writes OTA_TP_SIZE bytes of a pattern and returns the elapsed time in us, abort() lets queued sectors finish.
+static uint32_t runUpdateThroughput(const char *name, uint8_t buffers, uint32_t link_us) {
+  static uint8_t chunk[OTA_TP_CHUNK];
+
+  TEST_ASSERT_TRUE(Update.setWriteBuffers(buffers));
+  TEST_ASSERT_TRUE(Update.begin(OTA_TP_SIZE));
+
+  size_t pos = 0;
+  uint32_t start = micros();
+  while (pos < OTA_TP_SIZE) {
+    size_t len = OTA_TP_SIZE - pos;
+    if (len > OTA_TP_CHUNK) {
+      len = OTA_TP_CHUNK;
+    }
+    for (size_t i = 0; i < len; i++) {
+      chunk[i] = throughputPattern(pos + i);
+    }
+    if (link_us) {
+      delayMicroseconds(link_us);
+    }
+    TEST_ASSERT_EQUAL(len, Update.write(chunk, len));
+    pos += len;
+  }
+  TEST_ASSERT_FALSE(Update.hasError());
+  uint32_t wait_us = Update.writeWaitTime();
+  Update.abort();
+  uint32_t elapsed = micros() - start;
+
+  printThroughput(name, OTA_TP_SIZE, elapsed);
+  Serial.printf("%s: %lu ms, producer waited %lu ms\n", name, (unsigned long)(elapsed / 1000), (unsigned long)(wait_us / 1000));
+  return elapsed;
+}
+
+// Every byte after the stashed 16 byte header must have reached flash, in order.
+static void verifyThroughputImage() {
+  static uint8_t sector[SPI_FLASH_SEC_SIZE];
+  const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+  TEST_ASSERT_NOT_NULL(partition);
+  for (size_t offset = 0; offset < OTA_TP_SIZE; offset += sizeof(sector)) {
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_read(partition, offset, sector, sizeof(sector)));
+    for (size_t i = (offset == 0) ? ENCRYPTED_BLOCK_SIZE : 0; i < sizeof(sector); i++) {
+      if (sector[i] != throughputPattern(offset + i)) {
+        Serial.printf("Mismatch at 0x%x: %02x != %02x\n", (unsigned)(offset + i), sector[i], throughputPattern(offset + i));
+        TEST_FAIL_MESSAGE("Pipelined write produced wrong flash contents");
+      }
+    }
+  }
+}
+
+void test_update_set_write_buffers(void) {
+  TEST_ASSERT_FALSE(Update.setWriteBuffers(0));
+  TEST_ASSERT_FALSE(Update.setWriteBuffers(UPDATE_MAX_WRITE_BUFFERS + 1));
+  TEST_ASSERT_TRUE(Update.setWriteBuffers(OTA_TP_BUFFERS));
+  TEST_ASSERT_EQUAL(OTA_TP_BUFFERS, Update.writeBuffers());
+
+  TEST_ASSERT_TRUE(Update.begin(0x100000));
+  // the buffer count cannot change while an update is running
+  TEST_ASSERT_FALSE(Update.setWriteBuffers(1));
+  Update.abort();
+  TEST_ASSERT_FALSE(Update.isRunning());
+
+  TEST_ASSERT_TRUE(Update.setWriteBuffers(1));
+}
+
+void test_update_pipelined_write_throughput(void) {
+  uint32_t sync_us = runUpdateThroughput("update_sync", 1, OTA_TP_LINK_US);
+  uint32_t pipelined_us = runUpdateThroughput("update_pipelined", OTA_TP_BUFFERS, OTA_TP_LINK_US);
+  verifyThroughputImage();
+  runUpdateThroughput("update_pipelined_raw", OTA_TP_BUFFERS, 0);
+  verifyThroughputImage();
+  TEST_ASSERT_TRUE(Update.setWriteBuffers(1));
+
+  Serial.printf("Pipelined speedup: %lu%%\n", (unsigned long)(pipelined_us ? (uint64_t)sync_us * 100 / pipelined_us : 0));
+}
+
 // ==================== ArduinoOTA Tests ====================
 
 void test_arduino_ota_begin_end(void) {
@@ -355,6 +449,73 @@ void test_httpupdate_download(void) {
   TEST_ASSERT_TRUE_MESSAGE(ret == HTTP_UPDATE_OK || ret == HTTP_UPDATE_NO_UPDATES, "HTTPUpdate could not connect to server or download failed");
 }
 
+// Same download through the background writer, a real image must still verify and activate.
+void test_httpupdate_download_pipelined(void) {
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+  TEST_ASSERT_TRUE_MESSAGE(server_url.length() > 0, "No server URL provided");
+
+  static size_t total_bytes;
+  total_bytes = 0;
+  httpUpdate.onProgress([](int progress, int total) {
+    total_bytes = total;
+  });
+
+  NetworkClient client;
+  httpUpdate.rebootOnUpdate(false);
+  TEST_ASSERT_TRUE(Update.setWriteBuffers(OTA_TP_BUFFERS));
+  String url = server_url + "/ota.ino.bin";
+  uint32_t start = micros();
+  HTTPUpdateResult ret = httpUpdate.update(client, url);
+  uint32_t elapsed = micros() - start;
+  Update.setWriteBuffers(1);
+  httpUpdate.onProgress(nullptr);
+
+  TEST_ASSERT_TRUE_MESSAGE(ret == HTTP_UPDATE_OK || ret == HTTP_UPDATE_NO_UPDATES, "Pipelined HTTPUpdate download failed");
+  if (ret == HTTP_UPDATE_OK) {
+    printThroughput("httpupdate_pipelined", total_bytes, elapsed);
+  }
+}
+
+// Packages generated by test_ota.py with tools/ota_package.py, decoded by UpdateClass while writing.
+static HTTPUpdateResult httpUpdatePackage(const char *name) {
+  NetworkClient client;
+  httpUpdate.rebootOnUpdate(false);
+  String url = server_url + "/" + name;
+  HTTPUpdateResult ret = httpUpdate.update(client, url);
+  if (ret == HTTP_UPDATE_FAILED) {
+    Serial.printf("%s: %s\n", name, httpUpdate.getLastErrorString().c_str());
+  }
+  return ret;
+}
+
+void test_httpupdate_download_gzip(void) {
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+  TEST_ASSERT_TRUE_MESSAGE(server_url.length() > 0, "No server URL provided");
+
+  HTTPUpdateResult ret = httpUpdatePackage("ota.ino.gz.upkg");
+  TEST_ASSERT_TRUE_MESSAGE(ret == HTTP_UPDATE_OK || ret == HTTP_UPDATE_NO_UPDATES, "gzip package download failed");
+}
+
+void test_httpupdate_download_heatshrink(void) {
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+  TEST_ASSERT_TRUE_MESSAGE(server_url.length() > 0, "No server URL provided");
+
+  HTTPUpdateResult ret = httpUpdatePackage("ota.ino.hs.upkg");
+  TEST_ASSERT_TRUE_MESSAGE(ret == HTTP_UPDATE_OK || ret == HTTP_UPDATE_NO_UPDATES, "heatshrink package download failed");
+}
+
+void test_httpupdate_download_delta(void) {
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+  TEST_ASSERT_TRUE_MESSAGE(server_url.length() > 0, "No server URL provided");
+
+  HTTPUpdateResult ret = httpUpdatePackage("ota.ino.delta.upkg");
+  if (ret == HTTP_UPDATE_FAILED && httpUpdate.getLastError() == UPDATE_ERROR_DELTA_BASE) {
+    // esptool may rewrite the image header while flashing, then the running image is not the base
+    TEST_IGNORE_MESSAGE("Running image differs from ota.ino.bin");
+  }
+  TEST_ASSERT_TRUE_MESSAGE(ret == HTTP_UPDATE_OK || ret == HTTP_UPDATE_NO_UPDATES, "delta package download failed");
+}
+
 void test_httpupdate_download_ipv6(void) {
 #if !CONFIG_LWIP_IPV6
   TEST_IGNORE_MESSAGE("IPv6 not enabled in this build");
@@ -479,6 +640,8 @@ void setup() {
   RUN_TEST(test_update_begin_abort);
   RUN_TEST(test_update_error_no_begin);
   RUN_TEST(test_update_md5_check);
+  RUN_TEST(test_update_set_write_buffers);
+  RUN_TEST(test_update_pipelined_write_throughput);
   RUN_TEST(test_arduino_ota_begin_end);
   RUN_TEST(test_httpupdate_invalid_url);
   RUN_TEST(test_httpupdate_invalid_url_ipv6);
@@ -492,6 +655,10 @@ void setup() {
   RUN_TEST(test_arduino_ota_ipv6_with_auth);
   RUN_TEST(test_arduino_ota_upload_with_auth);
   RUN_TEST(test_httpupdate_download);
+  RUN_TEST(test_httpupdate_download_pipelined);
+  RUN_TEST(test_httpupdate_download_gzip);
+  RUN_TEST(test_httpupdate_download_heatshrink);
+  RUN_TEST(test_httpupdate_download_delta);
   RUN_TEST(test_httpupdate_download_ipv6);
 
   UNITY_END();
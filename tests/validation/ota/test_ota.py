@@ -15,11 +15,13 @@ from pytest_embedded.unity import UNITY_SUMMARY_LINE_REGEX
 
 ESP32_ROOT = Path(__file__).resolve().parents[3]
 ESPOTA = ESP32_ROOT / "tools" / "espota.py"
+OTA_PACKAGE = ESP32_ROOT / "tools" / "ota_package.py"
 LOGGER = logging.getLogger(__name__)
 
 # IPv4 or IPv6 (may contain ':'); auth is last space-separated token
 ARDUINO_OTA_BEGIN_RE = re.compile(rb"ARDUINO_OTA_BEGIN (\S+) ([0-9]+) (\S+)")
 ARDUINO_OTA_BEGIN_MAPPED_RE = re.compile(rb"ARDUINO_OTA_BEGIN_MAPPED (\S+) ([0-9]+) (\S+)")
+OTA_THROUGHPUT_RE = re.compile(rb"OTA_THROUGHPUT (\S+) ([0-9]+) KiB/s")
 
 
 def _is_ipv6(addr: str) -> bool:
@@ -130,6 +132,23 @@ def _find_firmware(build_dir: Path) -> Path | None:
     return None
 
 
+def _make_packages(firmware: Path) -> None:
+    """Compressed and delta packages of the test image, downloaded by the test_httpupdate_download_* cases."""
+    jobs = {
+        "ota.ino.gz.upkg": ["--compress", "gzip"],
+        "ota.ino.hs.upkg": ["--compress", "heatshrink"],
+        # the DUT runs this very image, so the delta is tiny but exercises patching against the running partition
+        "ota.ino.delta.upkg": ["--compress", "gzip", "--base", str(firmware)],
+    }
+    for name, args in jobs.items():
+        out = firmware.parent / name
+        cmd = [sys.executable, str(OTA_PACKAGE), "--bin", str(firmware), "--out", str(out), *args]
+        result = subprocess.run(cmd, capture_output=True, text=True, timeout=300)
+        if result.returncode != 0:
+            pytest.fail(f"ota_package.py failed for {name}: {result.stdout}{result.stderr}")
+        LOGGER.info("%s", result.stdout.splitlines()[0] if result.stdout else name)
+
+
 def _run_espota(
     dut_ip: str,
     dut_port: int,
@@ -224,6 +243,8 @@ def _expect_unity_with_arduino_ota(dut, firmware: Path, host_ip: str, host_ipv6:
 
         # Unity summary reached — parse cases into the junit report
         log += matched
+        for name, kib_s in OTA_THROUGHPUT_RE.findall(log):
+            LOGGER.info("OTA throughput %s: %s KiB/s", name.decode(), kib_s.decode())
         dut.testsuite.add_unity_test_cases(
             log,
             additional_attrs={
@@ -261,6 +282,7 @@ def test_ota(dut, wifi_ssid, wifi_pass, request):
         ipv6_mode = "NONE"
         LOGGER.warning("Host has no IPv6 support; all IPv6 cases will be ignored")
 
+    _make_packages(firmware)
     serve_dir = firmware.parent
 
     class DualStackHTTPServer(ThreadingTCPServer):
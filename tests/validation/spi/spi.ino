@@ -18,6 +18,8 @@
     setFrequency / getClockDivider
     pinSS
     Stress: 256-byte transfer
+    beginDMA / queueTransfer / queuePixels / waitDMA / endDMA
+    SPIDevice: chip select, settings per device, queue / flush
 */
 
 #include <Arduino.h>
@@ -305,6 +307,186 @@ void test_stress(void) {
   }
 }
 
+static volatile uint32_t dma_done_count = 0;
+
+static void dma_done(void *arg) {
+  (void)arg;
+  dma_done_count = dma_done_count + 1;
+}
+
+void test_queue_transfer(void) {
+  // Prime through DMA, echo through the CPU path: checks the data and that the
+  // registers of the CPU transfers are back after waitDMA().
+  const size_t len = 64;
+  uint8_t *tx = (uint8_t *)SPI.allocDMA(len);
+  uint8_t rx[len];
+  TEST_ASSERT_NOT_NULL(tx);
+  for (size_t i = 0; i < len; i++) {
+    tx[i] = (uint8_t)(0xC0 ^ i);
+  }
+
+  TEST_ASSERT_TRUE(SPI.beginDMA());
+  dma_done_count = 0;
+  digitalWrite(SS, LOW);
+  TEST_ASSERT_TRUE(SPI.queueBytes(tx, len, dma_done));
+  TEST_ASSERT_TRUE(SPI.waitDMA(1000));
+  digitalWrite(SS, HIGH);
+  TEST_ASSERT_EQUAL_UINT32(1, dma_done_count);
+  TEST_ASSERT_EQUAL_UINT8(0, SPI.pendingDMA());
+
+  spi_echo(rx, len);
+  TEST_ASSERT_EQUAL_MEMORY(tx, rx, len);
+
+  // and the other way round: receive the echo through DMA
+  uint8_t *dma_rx = (uint8_t *)SPI.allocDMA(len);
+  TEST_ASSERT_NOT_NULL(dma_rx);
+  spi_prime(tx, len);
+  memset(dma_rx, 0, len);
+  memset(rx, 0, len);
+  digitalWrite(SS, LOW);
+  TEST_ASSERT_TRUE(SPI.queueTransfer(rx, dma_rx, len));
+  TEST_ASSERT_TRUE(SPI.waitDMA(1000));
+  digitalWrite(SS, HIGH);
+  TEST_ASSERT_EQUAL_MEMORY(tx, dma_rx, len);
+
+  SPI.endDMA();
+  SPI.freeDMA(dma_rx);
+  SPI.freeDMA(tx);
+}
+
+void test_queue_pixels(void) {
+  // queuePixels puts the pixels in wire order like writePixels, in pieces of 64 bytes through both
+  // staging buffers, and leaves the buffer of the caller as it is
+  const size_t len = 192;
+  uint8_t pixels[len];
+  uint8_t expected_wire[len];
+  uint8_t rx[len];
+  for (size_t i = 0; i < len; i++) {
+    pixels[i] = (uint8_t)(0x30 + i);
+    expected_wire[i ^ 1] = pixels[i];
+  }
+  uint8_t *buf = (uint8_t *)SPI.allocDMA(len);
+  TEST_ASSERT_NOT_NULL(buf);
+  memcpy(buf, pixels, len);
+
+  TEST_ASSERT_TRUE(SPI.beginDMA(64, 2));
+  digitalWrite(SS, LOW);
+  TEST_ASSERT_TRUE(SPI.queuePixels(buf, len));
+  // like the CPU transfers, endTransaction() waits for the queued transfer
+  SPI.endTransaction();
+  TEST_ASSERT_EQUAL_UINT8(0, SPI.pendingDMA());
+  digitalWrite(SS, HIGH);
+  TEST_ASSERT_EQUAL_MEMORY(pixels, buf, len);
+
+  spi_echo(rx, len);
+  TEST_ASSERT_EQUAL_MEMORY(expected_wire, rx, len);
+
+  SPI.endDMA();
+  SPI.freeDMA(buf);
+}
+
+void test_queue_double_buffer(void) {
+  // 64 byte pieces of each buffer fill both slots, within a transaction.
+  // The echo chip only keeps the last CS transaction, so check the last buffer.
+  const size_t len = 192;
+  uint8_t *buf[2] = {(uint8_t *)SPI.allocDMA(len), (uint8_t *)SPI.allocDMA(len)};
+  uint8_t rx[len];
+  TEST_ASSERT_NOT_NULL(buf[0]);
+  TEST_ASSERT_NOT_NULL(buf[1]);
+
+  TEST_ASSERT_TRUE(SPI.beginDMA(64, 2));
+  dma_done_count = 0;
+  SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
+  for (int i = 0; i < 6; i++) {
+    uint8_t *b = buf[i & 1];
+    // each buffer is its own CS transaction
+    TEST_ASSERT_TRUE(SPI.waitDMA(1000));
+    digitalWrite(SS, HIGH);
+    for (size_t j = 0; j < len; j++) {
+      b[j] = (uint8_t)(i * 16 + j);
+    }
+    digitalWrite(SS, LOW);
+    TEST_ASSERT_TRUE(SPI.queueBytes(b, len, dma_done));
+  }
+  TEST_ASSERT_TRUE(SPI.waitDMA(1000));
+  digitalWrite(SS, HIGH);
+  SPI.endTransaction();
+  // one callback per buffer, not per 64 byte piece
+  TEST_ASSERT_EQUAL_UINT32(6, dma_done_count);
+
+  spi_echo(rx, len);
+  TEST_ASSERT_EQUAL_MEMORY(buf[1], rx, len);
+
+  SPI.endDMA();
+  SPI.freeDMA(buf[0]);
+  SPI.freeDMA(buf[1]);
+}
+
+// ── SPIDevice ──────────────────────────────────────────────────────────────
+
+void test_device_transfer(void) {
+  SPIDevice dev(SPI, SS, SPISettings(1000000, SPI_MSBFIRST, SPI_MODE0), 1);
+  // a second device with other settings, not connected to the echo chip
+  SPIDevice other(SPI, -1, SPISettings(4000000, SPI_LSBFIRST, SPI_MODE0));
+  TEST_ASSERT_TRUE(dev.begin());
+  TEST_ASSERT_TRUE(other.begin());
+
+  const uint8_t tx[4] = {0x12, 0x34, 0x56, 0x78};
+  static const uint8_t zeros[4] = {};
+  uint8_t rx[4] = {};
+
+  // each call selects the device on its own
+  dev.writeBytes(tx, sizeof(tx));
+  other.write(0xFF);
+  dev.transferBytes(zeros, rx, sizeof(rx));
+  TEST_ASSERT_EQUAL_MEMORY(tx, rx, sizeof(tx));
+
+  // MSB first again after the LSB first device used the bus
+  TEST_ASSERT_TRUE(dev.beginTransaction());
+  dev.transfer16(0xA55A);
+  dev.endTransaction();
+  other.write(0xFF);
+  TEST_ASSERT_TRUE(dev.beginTransaction());
+  uint16_t echo = dev.transfer16(0x0000);
+  dev.endTransaction();
+  TEST_ASSERT_EQUAL_HEX16(0xA55A, echo);
+
+  other.end();
+  dev.end();
+}
+
+void test_device_queue(void) {
+  SPIDevice dev(SPI, SS, SPISettings(1000000, SPI_MSBFIRST, SPI_MODE0));
+  TEST_ASSERT_TRUE(dev.begin());
+
+  const uint8_t cmd[2] = {0xC0, 0xDE};
+  const uint8_t data[6] = {1, 2, 3, 4, 5, 6};
+  static const uint8_t zeros[8] = {};
+  uint8_t rx[8] = {};
+
+  // command and data in one chip select, then the echo in the next one
+  TEST_ASSERT_TRUE(dev.queue(cmd, NULL, sizeof(cmd), true));
+  TEST_ASSERT_TRUE(dev.queue(data, NULL, sizeof(data)));
+  TEST_ASSERT_TRUE(dev.queue(zeros, rx, sizeof(rx)));
+  TEST_ASSERT_EQUAL_UINT8(3, dev.queued());
+  TEST_ASSERT_TRUE(dev.flush());
+  TEST_ASSERT_EQUAL_UINT8(0, dev.queued());
+
+  TEST_ASSERT_EQUAL_MEMORY(cmd, rx, sizeof(cmd));
+  TEST_ASSERT_EQUAL_MEMORY(data, rx + sizeof(cmd), sizeof(data));
+
+  // more entries than the queue holds are flushed on the way
+  uint8_t last[4] = {};
+  for (int i = 0; i < SPI_DEVICE_QUEUE_SIZE + 2; i++) {
+    TEST_ASSERT_TRUE(dev.queue(data, NULL, 4));
+  }
+  TEST_ASSERT_TRUE(dev.queue(zeros, last, sizeof(last)));
+  TEST_ASSERT_TRUE(dev.flush());
+  TEST_ASSERT_EQUAL_MEMORY(data, last, sizeof(last));
+
+  dev.end();
+}
+
 // ── entry points ────────────────────────────────────────────────────────────
 
 void setup() {
@@ -329,6 +511,11 @@ void setup() {
   RUN_TEST(test_set_frequency);
   RUN_TEST(test_pin_ss);
   RUN_TEST(test_stress);
+  RUN_TEST(test_queue_transfer);
+  RUN_TEST(test_queue_pixels);
+  RUN_TEST(test_queue_double_buffer);
+  RUN_TEST(test_device_transfer);
+  RUN_TEST(test_device_queue);
   UNITY_END();
 }
 
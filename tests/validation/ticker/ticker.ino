@@ -6,6 +6,8 @@
  * detach() stops callbacks, restart changes the period, re-attach while
  * running, callbacks with typed arguments (attach/once with TArg overload),
  * and large typed arguments (larger than sizeof(void*)).
+ * Timer wheel mode: periodic and one-shot callbacks, ordering of many
+ * one-shots, drift of a periodic Ticker, detach and jitter statistics.
  */
 
 #include <Arduino.h>
@@ -13,6 +15,7 @@
 #include <unity.h>
 
 static Ticker ticker;
+static Ticker wheelTicker(TICKER_WHEEL);
 static volatile int callCount = 0;
 static volatile int argReceived = 0;
 
@@ -26,12 +29,14 @@ static void argCb(int val) {
 
 void setUp(void) {
   ticker.detach();
+  wheelTicker.detach();
   callCount = 0;
   argReceived = 0;
 }
 
 void tearDown(void) {
   ticker.detach();
+  wheelTicker.detach();
 }
 
 // ==================== Initial state ====================
@@ -224,6 +229,98 @@ void test_attach_ms_with_large_arg(void) {
   TEST_ASSERT_EQUAL(600, bigArgSum);
 }
 
+// ==================== Timer wheel ====================
+
+void test_wheel_attach_ms_periodic(void) {
+  wheelTicker.attach_ms(100, countCb);
+  TEST_ASSERT_TRUE(wheelTicker.active());
+  delay(550);
+  wheelTicker.detach();
+  TEST_ASSERT_FALSE(wheelTicker.active());
+  TEST_ASSERT_INT_WITHIN(1, 5, callCount);
+}
+
+void test_wheel_once_ms(void) {
+  wheelTicker.once_ms(100, argCb, (int)42);
+  delay(300);
+  TEST_ASSERT_EQUAL(42, argReceived);
+  TEST_ASSERT_FALSE(wheelTicker.active());
+}
+
+void test_wheel_detach_stops_periodic(void) {
+  wheelTicker.attach_ms(50, countCb);
+  delay(175);
+  wheelTicker.detach();
+  int count_at_detach = callCount;
+  delay(200);
+  TEST_ASSERT_EQUAL(count_at_detach, callCount);
+}
+
+#define WHEEL_ORDER_TICKERS 16
+
+static Ticker orderTickers[WHEEL_ORDER_TICKERS] = {
+  Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL),
+  Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL),
+  Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL), Ticker(TICKER_WHEEL),
+};
+static volatile int orderFired[WHEEL_ORDER_TICKERS];
+static volatile int orderCount = 0;
+
+static void orderCb(int index) {
+  orderFired[orderCount] = index;
+  orderCount = orderCount + 1;
+}
+
+void test_wheel_ordering(void) {
+  orderCount = 0;
+  // scheduled in a scrambled order, ticker i is due after (i + 1) * 20 ms
+  for (int n = 0; n < WHEEL_ORDER_TICKERS; n++) {
+    int i = (n * 7) % WHEEL_ORDER_TICKERS;
+    orderTickers[i].once_ms((i + 1) * 20, orderCb, i);
+  }
+  delay((WHEEL_ORDER_TICKERS + 2) * 20);
+  TEST_ASSERT_EQUAL(WHEEL_ORDER_TICKERS, orderCount);
+  for (int i = 0; i < WHEEL_ORDER_TICKERS; i++) {
+    TEST_ASSERT_EQUAL(i, orderFired[i]);
+  }
+}
+
+static volatile int64_t driftFirst = 0;
+static volatile int64_t driftLast = 0;
+
+static void driftCb(void) {
+  driftLast = esp_timer_get_time();
+  if (callCount == 0) {
+    driftFirst = driftLast;
+  }
+  callCount = callCount + 1;
+}
+
+void test_wheel_drift(void) {
+  // 7 ms is not a multiple of the wheel tick, the rounding must not add up
+  wheelTicker.attach_ms(7, driftCb);
+  delay(1500);
+  wheelTicker.detach();
+  int calls = callCount;
+  TEST_ASSERT_INT_WITHIN(2, 1500 / 7, calls);
+  int64_t expected = (int64_t)(calls - 1) * 7000;
+  TEST_ASSERT_INT_WITHIN(2 * TICKER_WHEEL_RESOLUTION_US, expected, driftLast - driftFirst);
+}
+
+void test_wheel_stats(void) {
+  ticker_wheel_stats_t stats;
+  TEST_ASSERT_TRUE(Ticker::wheelStats(TICKER_WHEEL, &stats, true));
+  wheelTicker.attach_ms(10, countCb);
+  delay(205);
+  wheelTicker.detach();
+  TEST_ASSERT_TRUE(Ticker::wheelStats(TICKER_WHEEL, &stats, true));
+  TEST_ASSERT_EQUAL(callCount, stats.callbacks);
+  TEST_ASSERT_GREATER_THAN(0, stats.wakeups);
+  TEST_ASSERT_LESS_OR_EQUAL(stats.max_late_us, stats.avg_late_us);
+  TEST_ASSERT_TRUE(Ticker::wheelStats(TICKER_WHEEL, &stats, false));
+  TEST_ASSERT_EQUAL(0, stats.callbacks);
+}
+
 void setup() {
   Serial.begin(115200);
   while (!Serial) {
@@ -269,6 +366,14 @@ void setup() {
   RUN_TEST(test_once_ms_with_large_arg);
   RUN_TEST(test_attach_ms_with_large_arg);
 
+  // Timer wheel mode
+  RUN_TEST(test_wheel_attach_ms_periodic);
+  RUN_TEST(test_wheel_once_ms);
+  RUN_TEST(test_wheel_detach_stops_periodic);
+  RUN_TEST(test_wheel_ordering);
+  RUN_TEST(test_wheel_drift);
+  RUN_TEST(test_wheel_stats);
+
   UNITY_END();
 }
 
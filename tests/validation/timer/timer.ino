@@ -211,6 +211,87 @@ void timer_multiple_test(void) {
   timer = timerBegin(TIMER_FREQUENCY);
 }
 
+// ==================== Multiplexed Alarms ====================
+
+static std::atomic<int> alarm_counts[3];
+static int chain_alarm = -1;
+
+void ARDUINO_ISR_ATTR onMultiAlarm(void *arg) {
+  alarm_counts[(int)arg].fetch_add(1, std::memory_order_relaxed);
+}
+
+// reschedules itself from the interrupt, 5 times
+void ARDUINO_ISR_ATTR onChainAlarm(void *arg) {
+  if (alarm_counts[0].fetch_add(1, std::memory_order_relaxed) < 4) {
+    timerScheduleAlarm(timer, chain_alarm, TIMER_FREQUENCY / 100, 0);
+  }
+}
+
+void timer_multi_alarm_test(void) {
+  for (int i = 0; i < 3; i++) {
+    alarm_counts[i] = 0;
+  }
+  int a10 = timerAddAlarm(timer, onMultiAlarm, (void *)0);
+  int a25 = timerAddAlarm(timer, onMultiAlarm, (void *)1);
+  int once = timerAddAlarm(timer, onMultiAlarm, (void *)2);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, a10);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, a25);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, once);
+
+  // the timer interrupt belongs to the alarms now
+  alarm_flag = false;
+  timerAttachInterrupt(timer, &onTimer);
+
+  timerStart(timer);
+  TEST_ASSERT_TRUE(timerScheduleAlarm(timer, a10, TIMER_FREQUENCY / 100, TIMER_FREQUENCY / 100));
+  TEST_ASSERT_TRUE(timerScheduleAlarm(timer, a25, TIMER_FREQUENCY / 40, TIMER_FREQUENCY / 40));
+  TEST_ASSERT_TRUE(timerScheduleAlarm(timer, once, TIMER_FREQUENCY / 20, 0));
+  delay(205);
+  TEST_ASSERT_TRUE(timerCancelAlarm(timer, a10));
+  TEST_ASSERT_TRUE(timerCancelAlarm(timer, a25));
+  TEST_ASSERT_FALSE(timerCancelAlarm(timer, once));
+
+  TEST_ASSERT_INT_WITHIN(1, 20, alarm_counts[0].load(std::memory_order_relaxed));
+  TEST_ASSERT_INT_WITHIN(1, 8, alarm_counts[1].load(std::memory_order_relaxed));
+  TEST_ASSERT_EQUAL(1, alarm_counts[2].load(std::memory_order_relaxed));
+
+  // nothing fires once cancelled
+  int count = alarm_counts[0].load(std::memory_order_relaxed);
+  delay(50);
+  TEST_ASSERT_EQUAL(count, alarm_counts[0].load(std::memory_order_relaxed));
+  TEST_ASSERT_EQUAL(false, alarm_flag);
+
+  timer_alarm_stats_t stats;
+  TEST_ASSERT_TRUE(timerGetAlarmStats(timer, &stats, true));
+  TEST_ASSERT_EQUAL(alarm_counts[0] + alarm_counts[1] + alarm_counts[2], stats.fired);
+  TEST_ASSERT_EQUAL(0, stats.missed);
+  // within 100 us at 4 MHz
+  TEST_ASSERT_LESS_THAN(400, stats.max_latency);
+  TEST_ASSERT_TRUE(timerGetAlarmStats(timer, &stats, false));
+  TEST_ASSERT_EQUAL(0, stats.fired);
+
+  timerRemoveAlarm(timer, a10);
+  timerRemoveAlarm(timer, a25);
+  timerRemoveAlarm(timer, once);
+}
+
+void timer_multi_alarm_isr_test(void) {
+  alarm_counts[0] = 0;
+  chain_alarm = timerAddAlarm(timer, onChainAlarm, NULL);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, chain_alarm);
+
+  timerStart(timer);
+  TEST_ASSERT_TRUE(timerScheduleAlarm(timer, chain_alarm, TIMER_FREQUENCY / 100, 0));
+  delay(100);
+  TEST_ASSERT_EQUAL(5, alarm_counts[0].load(std::memory_order_relaxed));
+  TEST_ASSERT_FALSE(timerCancelAlarm(timer, chain_alarm));
+
+  timer_alarm_stats_t stats;
+  TEST_ASSERT_TRUE(timerGetAlarmStats(timer, &stats, false));
+  TEST_ASSERT_EQUAL(5, stats.fired);
+  timerRemoveAlarm(timer, chain_alarm);
+}
+
 void setup() {
   Serial.begin(115200);
   while (!Serial) {
@@ -225,6 +306,8 @@ void setup() {
   RUN_TEST(timer_auto_reload_test);
   RUN_TEST(timer_stop_start_test);
   RUN_TEST(timer_multiple_test);
+  RUN_TEST(timer_multi_alarm_test);
+  RUN_TEST(timer_multi_alarm_isr_test);
 #if !CONFIG_IDF_TARGET_ESP32
   RUN_TEST(timer_clock_select_test);
 #endif
@@ -3,12 +3,15 @@
  *
  * Covers:
  *   NetworkClientSecure: TLS handshake with CA cert, reject invalid cert,
- *                        setInsecure(), send/receive over TLS
+ *                        setInsecure(), send/receive over TLS,
+ *                        shared NetworkClientSecureConfig
+ *   NetworkClient / NetworkClientSecure: scatter-gather write with cork() / uncork()
  *   HTTPClient: GET (200 + body), POST (echo payload), custom headers,
- *               timeout, HTTPS via NetworkClientSecure
+ *               timeout, HTTPS via NetworkClientSecure, connection pool
  *
  * WiFi credentials and CA certificate PEM are received from the
- * Python test driver via serial. No keys or certs are hardcoded.
+ * Python test driver via serial. No keys or certs are hardcoded, except
+ * for one unrelated self-signed CA that must not be trusted by the server.
  */
 
 #include <Arduino.h>
@@ -23,11 +26,27 @@
 #define TLS_DATA_WAIT_MS  30000
 #define HANDSHAKE_TIMEOUT 30
 #define HTTP_TIMEOUT      30000
+// getHeapUsage() is the drop of the free heap during connect(), other tasks add their allocations
+#define HEAP_USAGE_TOLERANCE 8192
 
 static String wifi_ssid;
 static String wifi_pass;
 static char ca_cert[MAX_CERT_SIZE];
 static size_t ca_cert_len = 0;
+
+// Self-signed CA that did not issue the server certificate, without its key
+static const char other_ca_cert[] =
+  "-----BEGIN CERTIFICATE-----\n"
+  "MIIBkTCCATegAwIBAgIUeogtJbsDZS9pqcl+y5npS4EHErowCgYIKoZIzj0EAwIw\n"
+  "HTEbMBkGA1UEAwwSUG9vbCBUZXN0IE90aGVyIENBMCAXDTI2MTAxOTAxNDMzOFoY\n"
+  "DzIxMjYwOTI1MDE0MzM4WjAdMRswGQYDVQQDDBJQb29sIFRlc3QgT3RoZXIgQ0Ew\n"
+  "WTATBgcqhkjOPQIBBggqhkjOPQMBBwNCAATL61QiJK5kRCgwul4yq3vAbcdzzoEg\n"
+  "fFvizxXqpSEAN7QaSEC+ExeDEXNkZw9vpw9q6gR/4zUSDE0mGlSw2UTHo1MwUTAd\n"
+  "BgNVHQ4EFgQUPVOLBZXoccFa/Mb/017jh40yRkswHwYDVR0jBBgwFoAUPVOLBZXo\n"
+  "ccFa/Mb/017jh40yRkswDwYDVR0TAQH/BAUwAwEB/zAKBggqhkjOPQQDAgNIADBF\n"
+  "AiEApTswbGNMRV850Gtm7RSPB3zGZArp2fopeP1i2UHKohMCIHCiIVqia1R1Pw5h\n"
+  "B0Aww8hnLmWWmuM+s04meG0mof1p\n"
+  "-----END CERTIFICATE-----\n";
 void setUp(void) {}
 void tearDown(void) {}
 
@@ -128,6 +147,107 @@ void test_tls_send_receive(void) {
   TEST_ASSERT_TRUE(line.startsWith("HTTP/1.1 200"));
 }
 
+void test_tls_shared_config(void) {
+  TEST_ASSERT_TRUE_MESSAGE(ca_cert_len > 0, "No CA cert received from test driver");
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+
+  NetworkClientSecureConfig config;
+  config.setCACert(ca_cert);
+  TEST_ASSERT_TRUE(config.begin());
+
+  NetworkClientSecure clientA;
+  NetworkClientSecure clientB;
+  TEST_ASSERT_TRUE(clientA.setSharedConfig(config));
+  TEST_ASSERT_TRUE(clientB.setSharedConfig(config));
+  TEST_ASSERT_EQUAL(3, config.useCount());
+
+  bool okA = tlsConnect(clientA, "postman-echo.com", 443);
+  bool okB = tlsConnect(clientB, "postman-echo.com", 443);
+  bool connected = okA && okB && clientA.connected() && clientB.connected();
+  uint32_t heapA = clientA.getHeapUsage();
+  uint32_t heapB = clientB.getHeapUsage();
+  clientA.stop();
+  clientB.stop();
+
+  // Both clients keep their reference after the config object is released
+  config.end();
+  TEST_ASSERT_FALSE(config.ready());
+
+  TEST_ASSERT_TRUE_MESSAGE(okA && okB, "TLS connect with shared config failed");
+  TEST_ASSERT_TRUE(connected);
+  // the parsed certificates are shared, so the second session needs about as much as the first
+  TEST_ASSERT_UINT32_WITHIN(HEAP_USAGE_TOLERANCE, heapA, heapB);
+}
+
+void test_tcp_writev_cork(void) {
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+
+  NetworkClient client;
+  TEST_ASSERT_TRUE_MESSAGE(client.connect("postman-echo.com", 80, HTTP_TIMEOUT), "TCP connect failed");
+
+  // request line and headers go out in one scatter-gather write
+  const char *line = "GET /get?cork=1 HTTP/1.1\r\n";
+  const char *host = "Host: postman-echo.com\r\n";
+  const char *end = "Connection: close\r\n\r\n";
+  struct iovec iov[3] = {{(void *)line, strlen(line)}, {(void *)host, strlen(host)}, {(void *)end, strlen(end)}};
+  size_t total = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+
+  client.cork();
+  size_t sent = client.writev(iov, 3);
+  uint32_t corkedBytes = client.txBytes();
+  client.uncork();
+
+  unsigned long start = millis();
+  while (!client.available() && millis() - start < TLS_DATA_WAIT_MS) {
+    delay(10);
+  }
+  String status = client.available() ? client.readStringUntil('\n') : String();
+  uint32_t bytes = client.txBytes();
+  client.stop();
+
+  TEST_ASSERT_EQUAL(total, sent);
+  TEST_ASSERT_EQUAL(0, corkedBytes);  // held back until uncork()
+  TEST_ASSERT_EQUAL(total, bytes);
+  TEST_ASSERT_TRUE(status.startsWith("HTTP/1.1 200"));
+}
+
+void test_tls_writev_cork(void) {
+  TEST_ASSERT_TRUE_MESSAGE(ca_cert_len > 0, "No CA cert received from test driver");
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+
+  NetworkClientSecure client;
+  client.setCACert(ca_cert);
+  bool connected = tlsConnect(client, "postman-echo.com", 443);
+  if (!connected) {
+    client.stop();
+    TEST_FAIL_MESSAGE("TLS connect failed");
+    return;
+  }
+
+  // staged as plaintext while corked, then sent as one TLS record
+  const char *line = "GET /get?cork=1 HTTP/1.1\r\n";
+  const char *host = "Host: postman-echo.com\r\n";
+  const char *end = "Connection: close\r\n\r\n";
+  struct iovec iov[3] = {{(void *)line, strlen(line)}, {(void *)host, strlen(host)}, {(void *)end, strlen(end)}};
+  size_t total = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+
+  client.cork();
+  bool corked = client.corked();
+  size_t sent = client.writev(iov, 3);
+  client.uncork();
+
+  unsigned long start = millis();
+  while (!client.available() && millis() - start < TLS_DATA_WAIT_MS) {
+    delay(10);
+  }
+  String status = client.available() ? client.readStringUntil('\n') : String();
+  client.stop();
+
+  TEST_ASSERT_TRUE(corked);
+  TEST_ASSERT_EQUAL(total, sent);
+  TEST_ASSERT_TRUE(status.startsWith("HTTP/1.1 200"));
+}
+
 // ==================== HTTP Client Tests ====================
 
 void test_http_get(void) {
@@ -210,6 +330,161 @@ void test_https_get(void) {
   TEST_ASSERT_EQUAL(200, code);
 }
 
+void test_http_connection_pool(void) {
+  TEST_ASSERT_TRUE_MESSAGE(ca_cert_len > 0, "No CA cert received from test driver");
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+
+  HTTPConnectionPool pool(1, 10000);
+
+  HTTPClient first;
+  first.setConnectionPool(&pool);
+  first.setConnectTimeout(HTTP_TIMEOUT);
+  first.setTimeout(HTTP_TIMEOUT);
+  TEST_ASSERT_TRUE(first.begin("https://postman-echo.com/get", ca_cert));
+  int code1 = first.GET();
+  first.getString();
+  first.end();
+  size_t idle = pool.idleCount();
+
+  // A different HTTPClient picks up the idle connection instead of a new handshake
+  HTTPClient second;
+  second.setConnectionPool(&pool);
+  second.setConnectTimeout(HTTP_TIMEOUT);
+  second.setTimeout(HTTP_TIMEOUT);
+  TEST_ASSERT_TRUE(second.begin("https://postman-echo.com/get", ca_cert));
+  int code2 = second.GET();
+  second.getString();
+  second.end();
+  size_t idle2 = pool.idleCount();
+
+  // A response that was not read leaves the connection mid-body, it is closed instead of pooled
+  HTTPClient third;
+  third.setConnectionPool(&pool);
+  third.setConnectTimeout(HTTP_TIMEOUT);
+  third.setTimeout(HTTP_TIMEOUT);
+  TEST_ASSERT_TRUE(third.begin("https://postman-echo.com/get", ca_cert));
+  int code3 = third.GET();
+  third.end();
+  size_t idle3 = pool.idleCount();
+  pool.clear();
+
+  TEST_ASSERT_EQUAL(200, code1);
+  TEST_ASSERT_EQUAL(200, code2);
+  TEST_ASSERT_EQUAL(200, code3);
+  TEST_ASSERT_EQUAL(1, idle);
+  TEST_ASSERT_EQUAL(1, idle2);
+  TEST_ASSERT_EQUAL(0, idle3);
+  TEST_ASSERT_EQUAL(2, pool.hits());
+  TEST_ASSERT_EQUAL(0, pool.idleCount());
+}
+
+void test_http_pool_cert_contents(void) {
+  TEST_ASSERT_TRUE_MESSAGE(ca_cert_len > 0, "No CA cert received from test driver");
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+
+  HTTPConnectionPool pool(1, 10000);
+  static char cert[MAX_CERT_SIZE];
+  strncpy(cert, ca_cert, sizeof(cert) - 1);
+
+  HTTPClient first;
+  first.setConnectionPool(&pool);
+  first.setConnectTimeout(HTTP_TIMEOUT);
+  first.setTimeout(HTTP_TIMEOUT);
+  TEST_ASSERT_TRUE(first.begin("https://postman-echo.com/get", cert));
+  int code1 = first.GET();
+  first.getString();
+  first.end();
+  size_t idle = pool.idleCount();
+
+  // The same buffer now holds another CA: the session verified with the old one must not be handed out
+  strncpy(cert, other_ca_cert, sizeof(cert) - 1);
+  HTTPClient other;
+  other.setConnectionPool(&pool);
+  other.setConnectTimeout(HTTP_TIMEOUT);
+  other.setTimeout(HTTP_TIMEOUT);
+  TEST_ASSERT_TRUE(other.begin("https://postman-echo.com/get", cert));
+  int code2 = other.GET();
+  other.end();
+  uint32_t hitsOther = pool.hits();
+
+  // The original CA held in a different buffer matches the pooled session again
+  HTTPClient same;
+  same.setConnectionPool(&pool);
+  same.setConnectTimeout(HTTP_TIMEOUT);
+  same.setTimeout(HTTP_TIMEOUT);
+  TEST_ASSERT_TRUE(same.begin("https://postman-echo.com/get", ca_cert));
+  int code3 = same.GET();
+  same.getString();
+  same.end();
+  pool.clear();
+
+  TEST_ASSERT_EQUAL(200, code1);
+  TEST_ASSERT_EQUAL(1, idle);
+  TEST_ASSERT_EQUAL(0, hitsOther);
+  TEST_ASSERT_TRUE_MESSAGE(code2 < 0, "Request trusting another CA must fail the handshake");
+  TEST_ASSERT_EQUAL(200, code3);
+  TEST_ASSERT_EQUAL(1, pool.hits());
+}
+
+void test_http_async(void) {
+  TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
+
+  // One request that completes and one that never connects, driven from the same task
+  HTTPClient ok;
+  ok.setConnectTimeout(HTTP_TIMEOUT);
+  ok.setTimeout(HTTP_TIMEOUT);
+  String body;
+  ok.onAsyncBody([&body](const uint8_t *data, size_t len) {
+    body.concat((const char *)data, len);
+    return true;
+  });
+  TEST_ASSERT_TRUE(ok.begin("http://postman-echo.com/get?async=1"));
+  TEST_ASSERT_TRUE(ok.GETAsync());
+
+  HTTPClient unreachable;
+  unreachable.setConnectTimeout(3000);
+  TEST_ASSERT_TRUE(unreachable.begin("http://192.0.2.1/timeout"));
+  TEST_ASSERT_TRUE(unreachable.GETAsync());
+
+  // https: the TLS handshake runs in poll() as its own state
+  HTTPClient secure;
+  secure.setConnectTimeout(HTTP_TIMEOUT);
+  secure.setTimeout(HTTP_TIMEOUT);
+  TEST_ASSERT_TRUE(secure.begin("https://postman-echo.com/get?async=2", ca_cert));
+  TEST_ASSERT_TRUE(secure.GETAsync());
+  TEST_ASSERT_EQUAL(HTTPC_ASYNC_CONNECTING, secure.asyncState());
+
+  bool sawHandshake = false;
+  unsigned long okDoneAt = 0;
+  unsigned long start = millis();
+  while (millis() - start < HTTP_TIMEOUT * 2) {
+    httpc_async_state_t s1 = ok.poll();
+    httpc_async_state_t s2 = unreachable.poll();
+    httpc_async_state_t s3 = secure.poll();
+    sawHandshake |= s3 == HTTPC_ASYNC_HANDSHAKE;
+    if (!okDoneAt && s1 >= HTTPC_ASYNC_DONE) {
+      okDoneAt = millis() - start;
+    }
+    if (s1 >= HTTPC_ASYNC_DONE && s2 >= HTTPC_ASYNC_DONE && s3 >= HTTPC_ASYNC_DONE) {
+      break;
+    }
+    delay(1);
+  }
+
+  TEST_ASSERT_EQUAL(HTTPC_ASYNC_DONE, ok.asyncState());
+  TEST_ASSERT_EQUAL(200, ok.asyncResult());
+  TEST_ASSERT_TRUE(body.indexOf("async") >= 0);
+  TEST_ASSERT_EQUAL(HTTPC_ASYNC_FAILED, unreachable.asyncState());
+  TEST_ASSERT_EQUAL(HTTPC_ERROR_CONNECTION_REFUSED, unreachable.asyncResult());
+  TEST_ASSERT_TRUE(sawHandshake);
+  TEST_ASSERT_EQUAL(HTTPC_ASYNC_DONE, secure.asyncState());
+  TEST_ASSERT_EQUAL(200, secure.asyncResult());
+  ok.end();
+  unreachable.end();
+  secure.end();
+  Serial.printf("async GET done after %lu ms\n", okDoneAt);
+}
+
 void test_http_timeout(void) {
   TEST_ASSERT_TRUE_MESSAGE(connectWiFi(), "WiFi connect failed");
 
@@ -316,10 +591,16 @@ void setup() {
   RUN_TEST(test_tls_with_ca);
   RUN_TEST(test_tls_insecure);
   RUN_TEST(test_tls_send_receive);
+  RUN_TEST(test_tls_shared_config);
+  RUN_TEST(test_tcp_writev_cork);
+  RUN_TEST(test_tls_writev_cork);
   RUN_TEST(test_http_get);
   RUN_TEST(test_http_post);
   RUN_TEST(test_http_custom_header);
   RUN_TEST(test_https_get);
+  RUN_TEST(test_http_connection_pool);
+  RUN_TEST(test_http_pool_cert_contents);
+  RUN_TEST(test_http_async);
   RUN_TEST(test_http_timeout);
 
   UNITY_END();
@@ -151,6 +151,63 @@ void test_touch_interrtupt(void) {
   TEST_ASSERT_TRUE(touch2detected);
 }
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 5, 0) || SOC_TOUCH_SENSOR_VERSION == 3
+static volatile int scan_presses[2];
+static volatile int scan_releases[2];
+
+static void onScanEvent(const touch_event_t *event, void *arg) {
+  int i = event->pin == TOUCH_GPIOS[0] ? 0 : 1;
+  if (event->pressed) {
+    scan_presses[i]++;
+  } else {
+    scan_releases[i]++;
+  }
+}
+
+void test_touch_scan(void) {
+  touch_channel_state_t states[2];
+  touch_scan_stats_t stats;
+
+  TEST_ASSERT_TRUE(touchScanBegin(TOUCH_GPIOS, 2, 10, onScanEvent, NULL));
+  // let the baselines settle
+  delay(200);
+  TEST_ASSERT_EQUAL(2, touchScanSnapshot(states, 2));
+  TEST_ASSERT_EQUAL(TOUCH_GPIOS[0], states[0].pin);
+  TEST_ASSERT_EQUAL(TOUCH_GPIOS[1], states[1].pin);
+  TEST_ASSERT_FALSE(states[0].pressed);
+  TEST_ASSERT_FALSE(states[1].pressed);
+
+  test_press_fake(touch_list[0]);
+  delay(200);
+  TEST_ASSERT_TRUE(touchScanRead(TOUCH_GPIOS[0], &states[0]));
+  TEST_ASSERT_TRUE(states[0].pressed);
+  TEST_ASSERT_GREATER_THAN(0, states[0].delta);
+  TEST_ASSERT_EQUAL(1, scan_presses[0]);
+  TEST_ASSERT_EQUAL(0, scan_releases[0]);
+#if SOC_TOUCH_SENSOR_VERSION <= 2
+  // the internal capacitor of the ESP32-P4 is shared by all pads
+  TEST_ASSERT_TRUE(touchScanRead(TOUCH_GPIOS[1], &states[1]));
+  TEST_ASSERT_FALSE(states[1].pressed);
+  TEST_ASSERT_EQUAL(0, scan_presses[1]);
+#endif
+
+  test_release_fake(touch_list[0]);
+  delay(200);
+  TEST_ASSERT_TRUE(touchScanRead(TOUCH_GPIOS[0], &states[0]));
+  TEST_ASSERT_FALSE(states[0].pressed);
+  TEST_ASSERT_EQUAL(1, scan_releases[0]);
+
+  TEST_ASSERT_TRUE(touchScanGetStats(&stats, false));
+  TEST_ASSERT_GREATER_OR_EQUAL(50, stats.scans);
+  TEST_ASSERT_GREATER_OR_EQUAL(2, stats.events);
+  TEST_ASSERT_GREATER_THAN(0, stats.max_latency_us);
+  TEST_ASSERT_LESS_THAN(1000, stats.cpu_permille);
+
+  touchScanEnd();
+  TEST_ASSERT_EQUAL(0, touchScanSnapshot(states, 2));
+}
+#endif
+
 void test_touch_errors(void) {
 
   TEST_ASSERT_FALSE(touchRead(NO_TOUCH_GPIO));
@@ -170,6 +227,9 @@ void setup() {
   RUN_TEST(test_touch_read);
   RUN_TEST(test_touch_interrtupt);
   RUN_TEST(test_touch_errors);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 5, 0) || SOC_TOUCH_SENSOR_VERSION == 3
+  RUN_TEST(test_touch_scan);
+#endif
   UNITY_END();
 }
 
@@ -53,6 +53,11 @@
 # Changes
 # 2026-08-03:
 # - Added IPv6 support for invite/auth UDP and TCP listen
+#
+# Changes
+# 2026-10-18:
+# - Added windowed transfer (cumulative ACK every half window) negotiated in the invitation,
+#   devices that do not answer with a window still get the ACK-per-chunk upload
 
 
 from __future__ import print_function
@@ -71,6 +76,11 @@ AUTH = 200
 
 # Constants
 PROGRESS_BAR_LENGTH = 60
+CHUNK_SIZE = 1024
+
+# Windowed transfer protocol
+PROTOCOL_WINDOWED = 2
+DEFAULT_WINDOW = 65536
 
 
 def normalize_ip_literal(addr):
@@ -187,9 +197,9 @@ def send_invitation_and_get_auth_challenge(remote_addr, remote_port, message, lo
 
         sock2.settimeout(TIMEOUT)
         try:
-            # Try to read up to 69 bytes for new protocol (SHA256)
+            # Up to 69 bytes for the SHA256 challenge plus the optional protocol version and window
             # If device sends less (37 bytes), it's using old MD5 protocol
-            data = sock2.recv(69).decode()
+            data = sock2.recv(128).decode()
             sock2.close()
             break
         except:  # noqa: E722
@@ -206,6 +216,56 @@ def send_invitation_and_get_auth_challenge(remote_addr, remote_port, message, lo
     return True, data, None
 
 
+def split_protocol_reply(data):
+    """
+    Split the protocol version and window a windowed device appends to its invitation reply.
+    "OK 2 16384" -> ("OK", 16384), "AUTH <nonce> 2 16384" -> ("AUTH <nonce>", 16384).
+    Replies from older devices are returned unchanged with a window of 0.
+    """
+    tokens = data.split()
+    expected = {"OK": 3, "AUTH": 4}.get(tokens[0] if tokens else "")
+    if expected and len(tokens) == expected and tokens[-2] == str(PROTOCOL_WINDOWED) and tokens[-1].isdigit():
+        return " ".join(tokens[:-2]), int(tokens[-1])
+    return data, 0
+
+
+def upload_windowed(connection, f, content_size, window):
+    """
+    Send the image keeping up to `window` unacknowledged bytes in flight.
+    The device answers with newline terminated cumulative byte counts and "OK" after verifying the image.
+    Returns True if "OK" was already received.
+    """
+    sent = 0
+    acked = 0
+    pending = b""
+    # Whole window sized writes, small segments would be held back by Nagle until the device ACKs them
+    connection.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    while acked < content_size:
+        if sent < content_size and sent - acked < window:
+            chunk = f.read(window - (sent - acked))
+            if chunk:
+                try:
+                    connection.sendall(chunk)
+                except OSError as e:
+                    # The device stops reading after an error, try to fetch the reason it sent before closing
+                    logging.debug("Send failed: %s", str(e))
+                sent += len(chunk)
+                update_progress(sent / float(content_size))
+        data = connection.recv(64)
+        if not data:
+            raise ConnectionError("Connection closed by device after %d of %d bytes" % (acked, content_size))
+        pending += data
+        while b"\n" in pending:
+            line, pending = pending.split(b"\n", 1)
+            line = line.strip()
+            if line.isdigit():
+                acked = max(acked, int(line))
+            elif line:
+                raise ConnectionError("Device error: %s" % line.decode(errors="replace"))
+        logging.debug("Acked %d of %d", acked, content_size)
+    return b"OK" in pending
+
+
 def authenticate(
     remote_addr,
     remote_port,
@@ -295,7 +355,15 @@ def authenticate(
 
 
 def serve(  # noqa: C901
-    remote_addr, local_addr, remote_port, local_port, password, md5_target, filename, command=FLASH
+    remote_addr,
+    local_addr,
+    remote_port,
+    local_port,
+    password,
+    md5_target,
+    filename,
+    command=FLASH,
+    window=DEFAULT_WINDOW,
 ):
     try:
         remote_family, _remote_sockaddr = resolve_endpoint(remote_addr, remote_port, socket.SOCK_DGRAM)
@@ -327,6 +395,9 @@ def serve(  # noqa: C901
         file_md5 = hashlib.md5(f.read()).hexdigest()
     logging.info("Upload size: %d", content_size)
     message = "%d %d %d %s\n" % (command, local_port, content_size, file_md5)
+    if window > 0:
+        # Older devices stop reading at the first newline and ignore this line
+        message += "V%d %d\n" % (PROTOCOL_WINDOWED, window)
 
     # Send invitation and get authentication challenge
     success, data, error = send_invitation_and_get_auth_challenge(
@@ -337,6 +408,7 @@ def serve(  # noqa: C901
         sock.close()
         return 1
 
+    data, window = split_protocol_reply(data)
     if data != "OK":
         if data.startswith("AUTH"):
             nonce = data.split()[1]
@@ -436,6 +508,7 @@ def serve(  # noqa: C901
                             sock.close()
                             return 1
 
+                        data, window = split_protocol_reply(data)
                         if not data.startswith("AUTH"):
                             sys.stderr.write("FAIL\n")
                             logging.error("Expected AUTH challenge for MD5 retry, got: %s", data)
@@ -490,6 +563,8 @@ def serve(  # noqa: C901
             sock.close()
             return 1
 
+    if window:
+        logging.info("Windowed transfer, window: %d", window)
     logging.info("Waiting for device...")
 
     try:
@@ -510,8 +585,19 @@ def serve(  # noqa: C901
                 sys.stderr.write("Uploading")
                 sys.stderr.flush()
             offset = 0
-            while True:
-                chunk = f.read(1024)
+            last_response_contained_ok = False
+            if window:
+                connection.settimeout(10)
+                try:
+                    last_response_contained_ok = upload_windowed(connection, f, content_size, window)
+                except Exception as e:
+                    sys.stderr.write("\n")
+                    logging.error("Error Uploading: %s", str(e))
+                    connection.close()
+                    sock.close()
+                    return 1
+            while not window:
+                chunk = f.read(CHUNK_SIZE)
                 if not chunk:
                     break
                 offset += len(chunk)
@@ -667,6 +753,18 @@ def parse_args(unparsed_args):
         default=10,
     )
 
+    parser.add_argument(
+        "-w",
+        "--window",
+        dest="window",
+        type=int,
+        help=(
+            "Bytes in flight before waiting for an ACK on devices supporting the windowed protocol. "
+            "0 forces the legacy ACK per chunk. Default: %d" % DEFAULT_WINDOW
+        ),
+        default=DEFAULT_WINDOW,
+    )
+
     return parser.parse_args(unparsed_args)
 
 
@@ -703,6 +801,7 @@ def main(args):
         options.md5_target,
         options.image,
         command,
+        options.window,
     )
 
 
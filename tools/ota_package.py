@@ -0,0 +1,459 @@
+#!/usr/bin/env python3
+"""
+OTA Package Tool for ESP32 Arduino
+
+This script turns a firmware binary into a compressed and/or delta OTA package
+that UpdateClass decompresses and patches on the fly while writing to flash.
+
+A delta package only contains the differences to the firmware running on the
+device (the base). The device checks the SHA-256 of the base before applying
+the patch, so the base must be the exact binary that was flashed.
+
+Usage:
+    python ota_package.py --bin firmware.bin --out firmware.upkg
+    python ota_package.py --bin firmware.bin --out firmware.upkg --compress heatshrink
+    python ota_package.py --bin firmware.bin --base running.bin --out firmware.upkg
+    python ota_package.py --verify firmware.upkg --bin firmware.bin [--base running.bin]
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = b"UPKG"
+VERSION = 1
+HEADER_SIZE = 64
+
+COMPRESSION_NONE = 0
+COMPRESSION_GZIP = 1
+COMPRESSION_HEATSHRINK = 2
+COMPRESSIONS = {"none": COMPRESSION_NONE, "gzip": COMPRESSION_GZIP, "heatshrink": COMPRESSION_HEATSHRINK}
+
+FLAG_DELTA = 0x01
+
+OP_COPY = 0
+OP_ADD = 1
+OP_INSERT = 2
+
+# heatshrink parameters, the window costs (1 << window) bytes of RAM on the device
+DEFAULT_WINDOW = 11
+DEFAULT_LOOKAHEAD = 4
+
+# delta matching
+DELTA_BLOCK = 16
+DELTA_INDEX_STEP = 4
+
+
+# ---------------------------------------------------------------------------
+# Header
+# ---------------------------------------------------------------------------
+
+
+def make_header(compression, image_size, window=0, lookahead=0, base=None):
+    flags = FLAG_DELTA if base is not None else 0
+    base_size = len(base) if base is not None else 0
+    base_sha = hashlib.sha256(base).digest() if base is not None else bytes(32)
+    header = struct.pack("<4sBBBBB3xII12x", MAGIC, VERSION, compression, window, lookahead, flags, image_size, base_size)
+    return header + base_sha
+
+
+def parse_header(data):
+    if len(data) < HEADER_SIZE or data[:4] != MAGIC:
+        raise ValueError("Not an OTA package")
+    _magic, version, compression, window, lookahead, flags, image_size, base_size = struct.unpack_from(
+        "<4sBBBBB3xII12x", data
+    )
+    if version != VERSION:
+        raise ValueError(f"Unsupported package version {version}")
+    return {
+        "compression": compression,
+        "window": window,
+        "lookahead": lookahead,
+        "flags": flags,
+        "image_size": image_size,
+        "base_size": base_size,
+        "base_sha256": data[32:64],
+    }
+
+
+# ---------------------------------------------------------------------------
+# Heatshrink (LZSS, MSB first bit stream)
+# ---------------------------------------------------------------------------
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.bits = 0
+
+    def write(self, value, count):
+        self.acc = (self.acc << count) | value
+        self.bits += count
+        while self.bits >= 8:
+            self.bits -= 8
+            self.out.append((self.acc >> self.bits) & 0xFF)
+        self.acc &= (1 << self.bits) - 1
+
+    def finish(self):
+        if self.bits:
+            self.out.append((self.acc << (8 - self.bits)) & 0xFF)
+            self.bits = 0
+            self.acc = 0
+        return bytes(self.out)
+
+
+def heatshrink_compress(data, window=DEFAULT_WINDOW, lookahead=DEFAULT_LOOKAHEAD, max_chain=32):
+    """Greedy LZSS encoder producing a heatshrink compatible stream."""
+    max_offset = 1 << window
+    max_count = 1 << lookahead
+    # a back-reference only pays off if it is shorter than the literals it replaces
+    min_count = max(2, (1 + window + lookahead) // 9 + 1)
+    writer = BitWriter()
+    chains = {}
+    n = len(data)
+    i = 0
+    while i < n:
+        best_len = 0
+        best_off = 0
+        if i + min_count <= n:
+            key = data[i : i + min_count]
+            limit = min(max_count, n - i)
+            for j in reversed(chains.get(key, ())[-max_chain:]):
+                off = i - j
+                if off > max_offset:
+                    break
+                length = min_count
+                while length < limit and data[j + length] == data[i + length]:
+                    length += 1
+                if length > best_len:
+                    best_len = length
+                    best_off = off
+                    if length == limit:
+                        break
+        step = best_len if best_len >= min_count else 1
+        if step > 1:
+            writer.write(0, 1)
+            writer.write(best_off - 1, window)
+            writer.write(best_len - 1, lookahead)
+        else:
+            writer.write(1, 1)
+            writer.write(data[i], 8)
+        for k in range(i, min(i + step, n - min_count + 1)):
+            chains.setdefault(data[k : k + min_count], []).append(k)
+        i += step
+    return writer.finish()
+
+
+def heatshrink_decompress(data, window, lookahead):
+    out = bytearray()
+    acc = 0
+    bits = 0
+    pos = 0
+
+    def read(count):
+        nonlocal acc, bits, pos
+        while bits < count:
+            if pos >= len(data):
+                return None
+            acc = (acc << 8) | data[pos]
+            pos += 1
+            bits += 8
+        bits -= count
+        return (acc >> bits) & ((1 << count) - 1)
+
+    while True:
+        tag = read(1)
+        if tag is None:
+            break
+        if tag:
+            literal = read(8)
+            if literal is None:
+                break
+            out.append(literal)
+        else:
+            index = read(window)
+            count = read(lookahead)
+            if index is None or count is None:
+                break
+            for _ in range(count + 1):
+                src = len(out) - (index + 1)
+                out.append(out[src] if src >= 0 else 0)
+    return bytes(out)
+
+
+# ---------------------------------------------------------------------------
+# Delta
+# ---------------------------------------------------------------------------
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def _match_length(a, ai, b, bi, limit):
+    """Length of the common prefix of a[ai:] and b[bi:], at most limit."""
+    length = 0
+    step = 64
+    while length < limit:
+        n = min(step, limit - length)
+        if a[ai + length : ai + length + n] == b[bi + length : bi + length + n]:
+            length += n
+            continue
+        if n == 1:
+            break
+        step = max(1, n // 2)
+    return length
+
+
+def make_delta(base, new):
+    """
+    Encode new as COPY/ADD/INSERT operations against base.
+
+    Exact matches are found through a hash of DELTA_BLOCK byte blocks of the
+    base, then extended with an ADD while the data still mostly matches (code
+    that moved keeps its shape but the addresses in it change), which leaves
+    runs of small differences that compress well.
+    """
+    index = {}
+    for i in range(0, len(base) - DELTA_BLOCK + 1, DELTA_INDEX_STEP):
+        index.setdefault(base[i : i + DELTA_BLOCK], i)
+
+    patch = bytearray()
+    base_pos = 0
+    literal_start = 0
+    p = 0
+
+    def emit_insert(end):
+        if end > literal_start:
+            patch.extend(varint(((end - literal_start) << 2) | OP_INSERT))
+            patch.extend(new[literal_start:end])
+
+    def emit_base_op(op, offset, length, payload=b""):
+        nonlocal base_pos
+        patch.extend(varint((length << 2) | op))
+        patch.extend(varint(zigzag(offset - base_pos)))
+        patch.extend(payload)
+        base_pos = offset + length
+
+    while p + DELTA_BLOCK <= len(new):
+        i = index.get(new[p : p + DELTA_BLOCK])
+        if i is None:
+            p += 1
+            continue
+        # grow the match backwards into the pending literals
+        while p > literal_start and i > 0 and new[p - 1] == base[i - 1]:
+            p -= 1
+            i -= 1
+        length = _match_length(new, p, base, i, min(len(new) - p, len(base) - i))
+        emit_insert(p)
+        emit_base_op(OP_COPY, i, length)
+        p += length
+        i += length
+
+        # approximate extension: keep going while more bytes match than differ
+        score = best_score = best = k = 0
+        limit = min(len(new) - p, len(base) - i)
+        while k < limit:
+            score += 1 if new[p + k] == base[i + k] else -1
+            k += 1
+            if score > best_score:
+                best_score = score
+                best = k
+            elif score < best_score - DELTA_BLOCK:
+                break
+        if best:
+            diff = bytes((new[p + k] - base[i + k]) & 0xFF for k in range(best))
+            emit_base_op(OP_ADD, i, best, diff)
+            p += best
+        literal_start = p
+
+    emit_insert(len(new))
+    return bytes(patch)
+
+
+def apply_delta(base, patch):
+    out = bytearray()
+    pos = 0
+    base_pos = 0
+
+    def read_varint():
+        nonlocal pos
+        value = 0
+        shift = 0
+        while True:
+            byte = patch[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while pos < len(patch):
+        head = read_varint()
+        op, length = head & 3, head >> 2
+        if op == OP_INSERT:
+            out.extend(patch[pos : pos + length])
+            pos += length
+            continue
+        seek = read_varint()
+        base_pos += (seek >> 1) ^ -(seek & 1)
+        if base_pos < 0 or base_pos + length > len(base):
+            raise ValueError("Patch refers outside of the base image")
+        if op == OP_COPY:
+            out.extend(base[base_pos : base_pos + length])
+        elif op == OP_ADD:
+            out.extend((base[base_pos + k] + patch[pos + k]) & 0xFF for k in range(length))
+            pos += length
+        else:
+            raise ValueError(f"Unknown patch operation {op}")
+        base_pos += length
+    return bytes(out)
+
+
+# ---------------------------------------------------------------------------
+# Package
+# ---------------------------------------------------------------------------
+
+
+def compress(payload, compression, window, lookahead):
+    if compression == COMPRESSION_GZIP:
+        # zlib writes a gzip member without name and with mtime 0, so the output is reproducible
+        compressor = zlib.compressobj(9, zlib.DEFLATED, 16 + zlib.MAX_WBITS)
+        return compressor.compress(payload) + compressor.flush()
+    if compression == COMPRESSION_HEATSHRINK:
+        return heatshrink_compress(payload, window, lookahead)
+    return payload
+
+
+def build_package(image, compression=COMPRESSION_GZIP, base=None, window=DEFAULT_WINDOW, lookahead=DEFAULT_LOOKAHEAD):
+    if compression != COMPRESSION_HEATSHRINK:
+        window = lookahead = 0
+    payload = make_delta(base, image) if base is not None else image
+    header = make_header(compression, len(image), window, lookahead, base)
+    return header + compress(payload, compression, window, lookahead)
+
+
+def unpack_package(package, base=None):
+    """Decode a package the same way UpdateClass does, returns the image."""
+    header = parse_header(package)
+    payload = package[HEADER_SIZE:]
+    if header["compression"] == COMPRESSION_GZIP:
+        payload = zlib.decompress(payload, 16 + zlib.MAX_WBITS)
+    elif header["compression"] == COMPRESSION_HEATSHRINK:
+        payload = heatshrink_decompress(payload, header["window"], header["lookahead"])
+    elif header["compression"] != COMPRESSION_NONE:
+        raise ValueError(f"Unknown compression {header['compression']}")
+    if header["flags"] & FLAG_DELTA:
+        if base is None:
+            raise ValueError("Delta package needs the base image")
+        base = base[: header["base_size"]]
+        if len(base) != header["base_size"] or hashlib.sha256(base).digest() != header["base_sha256"]:
+            raise ValueError("Base image does not match the package")
+        payload = apply_delta(base, payload)
+    # heatshrink pads the last byte, the header has the real size
+    if len(payload) < header["image_size"]:
+        raise ValueError("Package is truncated")
+    return payload[: header["image_size"]]
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="OTA Package Tool for ESP32 Arduino",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  gzip compressed package:
+    python ota_package.py --bin firmware.bin --out firmware.upkg
+
+  heatshrink compressed package (less RAM and CPU on the device):
+    python ota_package.py --bin firmware.bin --out firmware.upkg --compress heatshrink --window 11 --lookahead 4
+
+  Delta package against the firmware running on the device:
+    python ota_package.py --bin firmware.bin --base running.bin --out firmware.upkg
+
+  Check that a package decodes to the firmware:
+    python ota_package.py --verify firmware.upkg --bin firmware.bin --base running.bin
+        """,
+    )
+    parser.add_argument("--bin", metavar="FILE", help="Firmware or filesystem image")
+    parser.add_argument("--out", metavar="FILE", help="Output package")
+    parser.add_argument("--base", metavar="FILE", help="Image running on the device, creates a delta package")
+    parser.add_argument(
+        "--compress", default="gzip", choices=sorted(COMPRESSIONS), help="Payload compression (default: gzip)"
+    )
+    parser.add_argument(
+        "--window", type=int, default=DEFAULT_WINDOW, help=f"heatshrink window bits, 4-15 (default: {DEFAULT_WINDOW})"
+    )
+    parser.add_argument(
+        "--lookahead",
+        type=int,
+        default=DEFAULT_LOOKAHEAD,
+        help=f"heatshrink lookahead bits, 3 to window-1 (default: {DEFAULT_LOOKAHEAD})",
+    )
+    parser.add_argument("--verify", metavar="FILE", help="Decode a package and compare it with --bin")
+
+    args = parser.parse_args()
+
+    if not 4 <= args.window <= 15 or not 3 <= args.lookahead < args.window:
+        print("Error: invalid heatshrink window/lookahead")
+        sys.exit(1)
+
+    base = read_file(args.base) if args.base else None
+
+    if args.verify:
+        if not args.bin:
+            print("Error: --bin required for verification")
+            sys.exit(1)
+        try:
+            image = unpack_package(read_file(args.verify), base)
+        except (ValueError, zlib.error) as e:
+            print(f"✗ Package verification FAILED: {e}")
+            sys.exit(1)
+        if image != read_file(args.bin):
+            print("✗ Package verification FAILED: decoded image differs")
+            sys.exit(1)
+        print(f"✓ Package decodes to {args.bin} ({len(image)} bytes)")
+
+    elif args.bin:
+        if not args.out:
+            print("Error: --out required for packaging")
+            sys.exit(1)
+        image = read_file(args.bin)
+        package = build_package(image, COMPRESSIONS[args.compress], base, args.window, args.lookahead)
+        # never ship a package that does not decode
+        if unpack_package(package, base) != image:
+            print("Error: package self-check failed")
+            sys.exit(1)
+        with open(args.out, "wb") as f:
+            f.write(package)
+        kind = "delta" if base is not None else "full"
+        print(f"{kind} package, {args.compress}: {len(image)} -> {len(package)} bytes ({100 * len(package) / len(image):.1f}%)")
+        print(f"Package saved to: {args.out}")
+
+    else:
+        parser.print_help()
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()